@@ -125,6 +125,8 @@ void BackendCommandTarget::getAllCommands(Array<CommandID>& commands)
 		MenuToolsRecompileScriptsOnReload,
 		MenuToolsCreateToolbarPropertyDefinition,
 		MenuToolsCreateExternalScriptFile,
+		MenuToolsEnableProfiler,
+		MenuToolsShowProfilerResults,
 		MenuToolsResolveMissingSamples,
 		MenuToolsDeleteMissingSamples,
 		MenuToolsUseRelativePaths,
@@ -355,6 +357,12 @@ void BackendCommandTarget::getCommandInfo(CommandID commandID, ApplicationComman
 	case MenuToolsCreateExternalScriptFile:
 		setCommandTarget(result, "Create external script file", true, false, 'X', false);
 		break;
+	case MenuToolsEnableProfiler:
+		setCommandTarget(result, "Enable CPU profiler", true, bpe->getBackendProcessor()->getProcessorProfiler().isEnabled(), 'X', false);
+		break;
+	case MenuToolsShowProfilerResults:
+		setCommandTarget(result, "Show CPU profiler results", true, false, 'X', false);
+		break;
 	case MenuToolsDeleteMissingSamples:
 		setCommandTarget(result, "Delete missing samples", true, false, 'X', false);
 		break;
@@ -501,6 +509,8 @@ bool BackendCommandTarget::perform(const InvocationInfo &info)
 	case MenuToolsRecompileScriptsOnReload: Actions::toggleCompileScriptsOnPresetLoad(bpe); updateCommands(); return true;
 	case MenuToolsCreateToolbarPropertyDefinition:	Actions::createDefaultToolbarJSON(bpe); return true;
 	case MenuToolsCreateExternalScriptFile:	Actions::createExternalScriptFile(bpe); updateCommands(); return true;
+	case MenuToolsEnableProfiler:		Actions::toggleProfiler(bpe); updateCommands(); return true;
+	case MenuToolsShowProfilerResults:	Actions::showProfilerResults(bpe); return true;
     case MenuToolsCheckDuplicate:       Actions::checkDuplicateIds(bpe); return true;
 	case MenuToolsDeleteMissingSamples: Actions::deleteMissingSamples(bpe); return true;
 	case MenuToolsResolveMissingSamples:Actions::resolveMissingSamples(bpe); return true;
@@ -744,6 +754,10 @@ PopupMenu BackendCommandTarget::getMenuForIndex(int topLevelMenuIndex, const Str
 
 		p.addSubMenu("Edit external script files", sub, files.size() != 0);
 
+		p.addSeparator();
+		p.addSectionHeader("Performance");
+		ADD_DESKTOP_ONLY(MenuToolsEnableProfiler);
+		ADD_DESKTOP_ONLY(MenuToolsShowProfilerResults);
 		p.addSeparator();
 		p.addSectionHeader("Sample Management");
 		ADD_DESKTOP_ONLY(MenuToolsResolveMissingSamples);
@@ -1779,6 +1793,40 @@ void BackendCommandTarget::Actions::createExternalScriptFile(BackendProcessorEdi
 	}
 }
 
+void BackendCommandTarget::Actions::toggleProfiler(BackendProcessorEditor * bpe)
+{
+	ProcessorProfiler &profiler = bpe->getBackendProcessor()->getProcessorProfiler();
+
+	profiler.setEnabled(!profiler.isEnabled());
+
+	debugToConsole(bpe->getMainSynthChain(), profiler.isEnabled() ? "CPU profiler enabled" : "CPU profiler disabled");
+}
+
+void BackendCommandTarget::Actions::showProfilerResults(BackendProcessorEditor * bpe)
+{
+	ProcessorProfiler &profiler = bpe->getBackendProcessor()->getProcessorProfiler();
+
+	const var report = profiler.createReport(bpe->getMainSynthChain());
+
+	if ((int)report.getProperty("Callback", var()).getProperty("NumBlocks", 0) == 0)
+	{
+		PresetHandler::showMessageWindow("No profiler results", "Enable the CPU profiler and play some notes first.", PresetHandler::IconType::Warning);
+		return;
+	}
+
+	debugToConsole(bpe->getMainSynthChain(), "CPU profiler results:\n" + ProcessorProfiler::createTextReport(report));
+
+	if (PresetHandler::showYesNoWindow("Save profiler results", "Do you want to save the results as JSON file?"))
+	{
+		FileChooser fc("Save profiler results", File(), "*.json", true);
+
+		if (fc.browseForFileToSave(true))
+		{
+			fc.getResult().replaceWithText(JSON::toString(report));
+		}
+	}
+}
+
 #undef ADD_ALL_PLATFORMS
 #undef ADD_IOS_ONLY
 #undef ADD_DESKTOP_ONLY
@@ -146,6 +146,8 @@ public:
 		MenuToolsRecompileScriptsOnReload,
 		MenuToolsCreateToolbarPropertyDefinition,
 		MenuToolsCreateExternalScriptFile,
+		MenuToolsEnableProfiler,
+		MenuToolsShowProfilerResults,
 		MenuToolsExternalScriptFileOffset,
 		
 		MenuToolsResolveMissingSamples = 0x60000,
@@ -287,6 +289,8 @@ public:
 		static void showMainMenu(BackendProcessorEditor * bpe);
 		static void moveModule(CopyPasteTarget *currentCopyPasteTarget, bool moveUp);
 		static void createExternalScriptFile(BackendProcessorEditor * bpe);
+		static void toggleProfiler(BackendProcessorEditor * bpe);
+		static void showProfilerResults(BackendProcessorEditor * bpe);
 	};
 
 private:
@@ -0,0 +1,449 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licences for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licencing:
+*
+*   http://www.hartinstruments.net/hise/
+*
+*   HISE is based on the JUCE library,
+*   which also must be licenced for commercial applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+HeadlessRenderer::Options::Options() :
+	sampleRate(44100.0),
+	blockSize(512),
+	tailSeconds(2.0),
+	waitForStreaming(true),
+	randomSeed(0x48495345)
+{
+
+}
+
+HeadlessRenderer::Statistics::Statistics() :
+	loadingTime(0.0),
+	renderTime(0.0),
+	numSamples(0),
+	numUnderruns(0),
+	numEvents(0),
+	checksum(14695981039346656037ULL)
+{
+	peakLevels[0] = 0.0f;
+	peakLevels[1] = 0.0f;
+}
+
+double HeadlessRenderer::Statistics::getBlockTimePercentile(double percentile) const
+{
+	if (blockTimes.size() == 0)
+		return 0.0;
+
+	Array<double> sortedTimes(blockTimes);
+	sortedTimes.sort();
+
+	const int index = (int)std::ceil(percentile / 100.0 * (double)sortedTimes.size()) - 1;
+
+	return sortedTimes[jlimit<int>(0, sortedTimes.size() - 1, index)];
+}
+
+var HeadlessRenderer::Statistics::createReport(const Options &options) const
+{
+	const double blockDuration = 1000.0 * (double)options.blockSize / options.sampleRate;
+	const double audioDuration = (double)numSamples / options.sampleRate;
+
+	double sumOfBlockTimes = 0.0;
+	int64 sumOfVoices = 0;
+	int maxVoices = 0;
+
+	for (int i = 0; i < blockTimes.size(); i++)
+		sumOfBlockTimes += blockTimes[i];
+
+	for (int i = 0; i < voiceAmounts.size(); i++)
+	{
+		sumOfVoices += voiceAmounts[i];
+		maxVoices = jmax<int>(maxVoices, voiceAmounts[i]);
+	}
+
+	DynamicObject::Ptr cpu = new DynamicObject();
+
+	// The CPU usage is the render time relative to the duration of the block (in percent)
+	cpu->setProperty("p50", 100.0 * getBlockTimePercentile(50.0) / blockDuration);
+	cpu->setProperty("p90", 100.0 * getBlockTimePercentile(90.0) / blockDuration);
+	cpu->setProperty("p99", 100.0 * getBlockTimePercentile(99.0) / blockDuration);
+	cpu->setProperty("max", 100.0 * getBlockTimePercentile(100.0) / blockDuration);
+	cpu->setProperty("mean", blockTimes.size() > 0 ? 100.0 * sumOfBlockTimes / (double)blockTimes.size() / blockDuration : 0.0);
+
+	DynamicObject::Ptr voices = new DynamicObject();
+
+	voices->setProperty("max", maxVoices);
+	voices->setProperty("mean", voiceAmounts.size() > 0 ? (double)sumOfVoices / (double)voiceAmounts.size() : 0.0);
+
+	Array<var> peaks;
+	peaks.add(Decibels::gainToDecibels(peakLevels[0]));
+	peaks.add(Decibels::gainToDecibels(peakLevels[1]));
+
+	DynamicObject::Ptr report = new DynamicObject();
+
+	report->setProperty("preset", options.presetFile.getFullPathName());
+	report->setProperty("midiFile", options.midiFile.getFullPathName());
+	report->setProperty("outputFile", options.outputFile.getFullPathName());
+	report->setProperty("sampleRate", options.sampleRate);
+	report->setProperty("blockSize", options.blockSize);
+	report->setProperty("deterministic", options.waitForStreaming);
+	report->setProperty("numBlocks", blockTimes.size());
+	report->setProperty("numSamples", numSamples);
+	report->setProperty("numEvents", numEvents);
+	report->setProperty("loadingTime", loadingTime);
+	report->setProperty("renderTime", renderTime);
+	report->setProperty("realtimeFactor", renderTime > 0.0 ? audioDuration / renderTime : 0.0);
+	report->setProperty("cpu", var(cpu));
+	report->setProperty("voices", var(voices));
+	report->setProperty("underruns", numUnderruns);
+	report->setProperty("peakLevels", peaks);
+	report->setProperty("checksum", String::toHexString((int64)checksum));
+
+	return var(report);
+}
+
+HeadlessRenderer::HeadlessRenderer(const Options &options_) :
+	options(options_)
+{
+
+}
+
+HeadlessRenderer::~HeadlessRenderer()
+{
+
+}
+
+HeadlessRenderer::ErrorCodes HeadlessRenderer::render()
+{
+	statistics = Statistics();
+
+	MidiMessageSequence sequence;
+
+	if (!readMidiFile(sequence))
+		return MidiFileIsInvalid;
+
+	options.outputFile.deleteFile();
+
+	ScopedPointer<FileOutputStream> fos = options.outputFile.createOutputStream();
+
+	if (fos == nullptr || fos->failedToOpen())
+		return OutputFileIsInvalid;
+
+	WavAudioFormat wavFormat;
+
+	ScopedPointer<AudioFormatWriter> writer = wavFormat.createWriterFor(fos, options.sampleRate, 2, 24, StringPairArray(), 0);
+
+	if (writer == nullptr)
+		return OutputFileIsInvalid;
+
+	fos.release();
+
+	// Math.random() uses the system random generator
+	Random::getSystemRandom().setSeed(options.randomSeed);
+	WaveSynthKernels::setNoiseSeed(options.randomSeed);
+
+	const double loadingStart = Time::getMillisecondCounterHiRes();
+
+	ScopedPointer<BackendProcessor> processor = new BackendProcessor();
+
+	// The random modulators take their seed from the processor when they are created
+	processor->setRandomSeed(options.randomSeed);
+
+	processor->setNonRealtime(options.waitForStreaming);
+
+	processor->prepareToPlay(options.sampleRate, options.blockSize);
+
+	ProjectHandler &projectHandler = processor->getSampleManager().getProjectHandler();
+
+	const File previousProjectFolder = projectHandler.getWorkDirectory();
+	const File projectFolder = options.presetFile.getParentDirectory().getParentDirectory();
+
+	// Presets outside of a project folder are rendered with the current project, so no project folders are created around them
+	const bool isProjectFolder = projectFolder.getChildFile("project_info.xml").existsAsFile();
+	const bool switchProject = isProjectFolder && previousProjectFolder != projectFolder;
+
+	if (switchProject)
+		projectHandler.setWorkingProject(projectFolder);
+
+	const ErrorCodes loadResult = loadPreset(processor);
+
+	if (loadResult != OK)
+	{
+		if (switchProject)
+			projectHandler.setWorkingProject(previousProjectFolder);
+
+		return loadResult;
+	}
+
+	statistics.loadingTime = (Time::getMillisecondCounterHiRes() - loadingStart) * 0.001;
+
+	// Reset it again so that Math.random() doesn't depend on the amount of random numbers used while loading
+	Random::getSystemRandom().setSeed(options.randomSeed);
+
+	SampleThreadPool *pool = processor->getSampleManager().getGlobalSampleThreadPool();
+
+	pool->resetUnderrunCounters();
+
+	const int blockSize = options.blockSize;
+	const int64 lastEventPosition = sequence.getNumEvents() != 0 ? (int64)(sequence.getEndTime() * options.sampleRate) : 0;
+	const int64 numSamplesToRender = lastEventPosition + (int64)(options.tailSeconds * options.sampleRate);
+	const int numBlocks = (int)((numSamplesToRender + blockSize - 1) / blockSize);
+
+	statistics.blockTimes.ensureStorageAllocated(numBlocks);
+	statistics.voiceAmounts.ensureStorageAllocated(numBlocks);
+
+	AudioSampleBuffer buffer(2, blockSize);
+	MidiBuffer midiBuffer;
+
+	int eventIndex = 0;
+
+	const double renderStart = Time::getMillisecondCounterHiRes();
+
+	for (int i = 0; i < numBlocks; i++)
+	{
+		const int64 blockStart = (int64)i * (int64)blockSize;
+		const int numSamplesInBlock = (int)jmin<int64>(blockSize, numSamplesToRender - blockStart);
+
+		midiBuffer.clear();
+
+		while (eventIndex < sequence.getNumEvents())
+		{
+			const MidiMessage &m = sequence.getEventPointer(eventIndex)->message;
+			const int64 eventPosition = (int64)(m.getTimeStamp() * options.sampleRate);
+
+			if (eventPosition >= blockStart + blockSize)
+				break;
+
+			if (!m.isMetaEvent())
+			{
+				midiBuffer.addEvent(m, (int)(eventPosition - blockStart));
+				statistics.numEvents++;
+			}
+
+			eventIndex++;
+		}
+
+		buffer.clear();
+
+		const int64 startTicks = Time::getHighResolutionTicks();
+
+		{
+			// Hold the callback lock like a host does
+			ScopedLock sl(processor->getCallbackLock());
+
+			processor->processBlock(buffer, midiBuffer);
+		}
+
+		statistics.blockTimes.add(Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - startTicks) * 1000.0);
+		statistics.voiceAmounts.add(processor->getNumActiveVoices());
+
+		if (options.waitForStreaming)
+			waitForStreamingThreads(processor);
+
+		for (int c = 0; c < 2; c++)
+			statistics.peakLevels[c] = jmax<float>(statistics.peakLevels[c], buffer.getMagnitude(c, 0, numSamplesInBlock));
+
+		updateChecksum(buffer, numSamplesInBlock);
+
+		writer->writeFromAudioSampleBuffer(buffer, 0, numSamplesInBlock);
+	}
+
+	statistics.renderTime = (Time::getMillisecondCounterHiRes() - renderStart) * 0.001;
+	statistics.numSamples = numSamplesToRender;
+
+	for (int i = 0; i < pool->getNumWorkers(); i++)
+		statistics.numUnderruns += pool->getNumUnderruns(i);
+
+	writer = nullptr;
+
+	if (switchProject)
+		projectHandler.setWorkingProject(previousProjectFolder);
+
+	return OK;
+}
+
+HeadlessRenderer::ErrorCodes HeadlessRenderer::loadPreset(BackendProcessor *processor)
+{
+	ValueTree v;
+
+	if (options.presetFile.getFileExtension() == ".hip")
+	{
+		FileInputStream fis(options.presetFile);
+
+		if (fis.openedOk())
+			v = ValueTree::readFromStream(fis);
+	}
+	else if (options.presetFile.getFileExtension() == ".xml")
+	{
+		ScopedPointer<XmlElement> xml = XmlDocument::parse(options.presetFile);
+
+		if (xml != nullptr)
+			v = ValueTree::fromXml(*xml);
+	}
+
+	if (!v.isValid() || v.getProperty("Type", var::undefined()).toString() != "SynthChain")
+		return PresetIsInvalid;
+
+	processor->loadPreset(v, nullptr);
+
+	// The samplers preload their samples with threads that are started from the message loop
+	const double timeout = Time::getMillisecondCounterHiRes() + 600000.0;
+
+	while (processor->isBusy())
+	{
+		if (Time::getMillisecondCounterHiRes() > timeout)
+			return PreloadTimeout;
+
+		MessageManager::getInstance()->runDispatchLoopUntil(20);
+	}
+
+	waitForStreamingThreads(processor);
+
+	return OK;
+}
+
+bool HeadlessRenderer::readMidiFile(MidiMessageSequence &sequence) const
+{
+	FileInputStream fis(options.midiFile);
+
+	MidiFile midiFile;
+
+	if (!fis.openedOk() || !midiFile.readFrom(fis))
+		return false;
+
+	midiFile.convertTimestampTicksToSeconds();
+
+	for (int i = 0; i < midiFile.getNumTracks(); i++)
+	{
+		sequence.addSequence(*midiFile.getTrack(i), 0.0, 0.0, midiFile.getLastTimestamp() + 1.0);
+	}
+
+	sequence.sort();
+
+	return true;
+}
+
+void HeadlessRenderer::waitForStreamingThreads(BackendProcessor *processor) const
+{
+	SampleThreadPool *pool = processor->getSampleManager().getGlobalSampleThreadPool();
+
+	const double timeout = Time::getMillisecondCounterHiRes() + 5000.0;
+
+	while (pool->getNumQueuedJobs() > 0 && Time::getMillisecondCounterHiRes() < timeout)
+	{
+		Thread::sleep(1);
+	}
+}
+
+void HeadlessRenderer::updateChecksum(const AudioSampleBuffer &buffer, int numSamples)
+{
+	// FNV-1a over the bits of the samples, so every difference in the output changes the checksum
+	for (int c = 0; c < buffer.getNumChannels(); c++)
+	{
+		const uint8 *data = reinterpret_cast<const uint8*>(buffer.getReadPointer(c));
+		const size_t numBytes = sizeof(float) * (size_t)numSamples;
+
+		for (size_t i = 0; i < numBytes; i++)
+		{
+			statistics.checksum ^= data[i];
+			statistics.checksum *= 1099511628211ULL;
+		}
+	}
+}
+
+HeadlessRenderer::ErrorCodes HeadlessRenderer::renderFromCommandLine(const String &commandLine)
+{
+	String arguments = commandLine.fromFirstOccurrenceOf("render ", false, false);
+
+	StringArray args = StringArray::fromTokens(arguments, true);
+
+	if (args.size() < 3)
+		return MissingArguments;
+
+	Options o;
+
+	o.presetFile = File(args[0].unquoted());
+
+	for (int i = 1; i < args.size(); i++)
+	{
+		const String arg = args[i];
+		const String value = arg.fromFirstOccurrenceOf(":", false, false).unquoted();
+
+		if (arg.startsWith("-m:"))			o.midiFile = File(value);
+		else if (arg.startsWith("-o:"))		o.outputFile = File(value);
+		else if (arg.startsWith("-r:"))		o.reportFile = File(value);
+		else if (arg.startsWith("-sr:"))	o.sampleRate = jlimit<double>(8000.0, 384000.0, value.getDoubleValue());
+		else if (arg.startsWith("-bs:"))	o.blockSize = jlimit<int>(1, 8192, value.getIntValue());
+		else if (arg.startsWith("-tail:"))	o.tailSeconds = jmax<double>(0.0, value.getDoubleValue());
+		else if (arg.startsWith("-seed:"))	o.randomSeed = value.getLargeIntValue();
+		else if (arg == "-nowait")			o.waitForStreaming = false;
+	}
+
+	if (!o.presetFile.existsAsFile())
+		return PresetIsInvalid;
+
+	if (!o.midiFile.existsAsFile())
+		return MidiFileIsInvalid;
+
+	if (o.outputFile == File())
+		return OutputFileIsInvalid;
+
+	CompileExporter::setExportingFromCommandLine();
+
+	std::cout << "Rendering " << o.presetFile.getFileName() << " with " << o.midiFile.getFileName() << "...";
+
+	HeadlessRenderer renderer(o);
+
+	const ErrorCodes result = renderer.render();
+
+	if (result != OK)
+		return result;
+
+	std::cout << "DONE" << std::endl << std::endl;
+
+	const String report = JSON::toString(renderer.getStatistics().createReport(o));
+
+	if (o.reportFile != File())
+		o.reportFile.replaceWithText(report);
+	else
+		std::cout << report << std::endl;
+
+	return OK;
+}
+
+String HeadlessRenderer::getErrorMessage(ErrorCodes code)
+{
+	switch (code)
+	{
+	case OK:					return "OK";
+	case MissingArguments:		return "Missing arguments";
+	case PresetIsInvalid:		return "The preset file is not valid";
+	case MidiFileIsInvalid:		return "The MIDI file can't be read";
+	case OutputFileIsInvalid:	return "The output file can't be written";
+	case PreloadTimeout:		return "The samples couldn't be preloaded";
+	case numErrorCodes:
+	default:					return "Unknown error";
+	}
+}
@@ -0,0 +1,144 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licences for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licencing:
+*
+*   http://www.hartinstruments.net/hise/
+*
+*   HISE is based on the JUCE library,
+*   which also must be licenced for commercial applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+#ifndef HEADLESSRENDERER_H_INCLUDED
+#define HEADLESSRENDERER_H_INCLUDED
+
+/** Renders a preset with a MIDI file without the editor and without an audio device.
+*
+*	This is used by the command line mode ("HISE render") to benchmark presets and to create reference renders that
+*	can be compared between different builds. It creates a BackendProcessor, loads the preset, waits until all samples
+*	are preloaded and then calls processBlock() as fast as possible with the events of the MIDI file.
+*
+*	The render is deterministic: the random generators are seeded with a fixed value and after every block the
+*	renderer waits until the streaming threads have finished their jobs, so the result doesn't depend on the disk
+*	speed (use the -nowait option to measure the streaming underruns of a realtime render instead). For the same
+*	reason the processor is set to non realtime mode, so the convolution waits for its tail workers.
+*/
+class HeadlessRenderer
+{
+public:
+
+	enum ErrorCodes
+	{
+		OK = 0,
+		MissingArguments,
+		PresetIsInvalid,
+		MidiFileIsInvalid,
+		OutputFileIsInvalid,
+		PreloadTimeout,
+		numErrorCodes
+	};
+
+	struct Options
+	{
+		Options();
+
+		File presetFile;
+		File midiFile;
+		File outputFile;
+
+		/** If this is not set, the report will be written to the console. */
+		File reportFile;
+
+		double sampleRate;
+		int blockSize;
+
+		/** The time that is rendered after the last MIDI event. */
+		double tailSeconds;
+
+		/** Waits for the streaming threads after every block. Disable this to simulate a realtime render. */
+		bool waitForStreaming;
+
+		int64 randomSeed;
+	};
+
+	/** The data that is measured during the render. */
+	struct Statistics
+	{
+		Statistics();
+
+		/** Creates the report object that is written as JSON. */
+		var createReport(const Options &options) const;
+
+		/** Returns the value of the sorted block times at the given percentile (0 ... 100). */
+		double getBlockTimePercentile(double percentile) const;
+
+		/** The time it took to render each block in milliseconds. */
+		Array<double> blockTimes;
+
+		Array<int> voiceAmounts;
+
+		double loadingTime;
+		double renderTime;
+
+		int64 numSamples;
+		int numUnderruns;
+		int numEvents;
+
+		float peakLevels[2];
+
+		/** A hash of all rendered samples that changes if a single bit of the output is different. */
+		uint64 checksum;
+	};
+
+	HeadlessRenderer(const Options &options_);
+
+	~HeadlessRenderer();
+
+	/** Loads the preset and renders the MIDI file. */
+	ErrorCodes render();
+
+	const Statistics &getStatistics() const { return statistics; }
+
+	/** Parses the command line arguments, renders the preset and writes the report. */
+	static ErrorCodes renderFromCommandLine(const String &commandLine);
+
+	static String getErrorMessage(ErrorCodes code);
+
+private:
+
+	ErrorCodes loadPreset(BackendProcessor *processor);
+
+	bool readMidiFile(MidiMessageSequence &sequence) const;
+
+	void waitForStreamingThreads(BackendProcessor *processor) const;
+
+	void updateChecksum(const AudioSampleBuffer &buffer, int numSamples);
+
+	Options options;
+	Statistics statistics;
+
+	JUCE_DECLARE_NON_COPYABLE(HeadlessRenderer)
+};
+
+#endif  // HEADLESSRENDERER_H_INCLUDED
@@ -0,0 +1,212 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licences for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licencing:
+*
+*   http://www.hartinstruments.net/hise/
+*
+*   HISE is based on the JUCE library,
+*   which also must be licenced for commercial applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+#include "JuceHeader.h"
+
+class HeadlessRendererUnitTest : public UnitTest
+{
+public:
+
+	HeadlessRendererUnitTest() :
+		UnitTest("Testing the headless renderer")
+	{
+
+	}
+
+	void runTest() override
+	{
+		testSeedSource();
+		testDeterministicRender();
+	}
+
+private:
+
+	struct RenderResult
+	{
+		RenderResult() : errorCode(HeadlessRenderer::numErrorCodes), checksum(0), peakLevel(0.0f) {}
+
+		HeadlessRenderer::ErrorCodes errorCode;
+		uint64 checksum;
+		float peakLevel;
+	};
+
+	void testSeedSource()
+	{
+		beginTest("Testing the random seeds of the processors");
+
+		Array<int64> firstSeeds;
+		Array<int64> secondSeeds;
+
+		createSeeds(firstSeeds, secondSeeds);
+
+		expect(firstSeeds == secondSeeds, "The seeds don't depend on the system random generator or the other processor");
+	}
+
+	/** Draws seeds from two processors with the same seed while the other random generators are used in between. */
+	static void createSeeds(Array<int64> &firstSeeds, Array<int64> &secondSeeds)
+	{
+		ScopedPointer<BackendProcessor> first = new BackendProcessor();
+		ScopedPointer<BackendProcessor> second = new BackendProcessor();
+
+		first->setRandomSeed(1234);
+		second->setRandomSeed(1234);
+
+		for (int i = 0; i < 16; i++)
+		{
+			firstSeeds.add(first->getNextRandomSeed());
+
+			Random::getSystemRandom().nextInt64();
+
+			if (i % 3 == 0)
+				firstSeeds.add(first->getNextRandomSeed());
+			else
+				secondSeeds.add(second->getNextRandomSeed());
+
+			secondSeeds.add(second->getNextRandomSeed());
+		}
+
+		while (secondSeeds.size() < firstSeeds.size())
+			secondSeeds.add(second->getNextRandomSeed());
+
+		while (firstSeeds.size() < secondSeeds.size())
+			firstSeeds.add(first->getNextRandomSeed());
+	}
+
+	void testDeterministicRender()
+	{
+		beginTest("Rendering a preset twice with the same seed");
+
+		const File folder = File::getSpecialLocation(File::tempDirectory).getChildFile("HeadlessRendererTest");
+
+		folder.deleteRecursively();
+		folder.createDirectory();
+
+		const File presetFile = folder.getChildFile("Random.xml");
+		const File midiFile = folder.getChildFile("Notes.mid");
+
+		writePreset(presetFile);
+		writeMidiFile(midiFile);
+
+		const RenderResult first = render(presetFile, midiFile, folder.getChildFile("First.wav"), 1234);
+		const RenderResult second = render(presetFile, midiFile, folder.getChildFile("Second.wav"), 1234);
+		const RenderResult otherSeed = render(presetFile, midiFile, folder.getChildFile("OtherSeed.wav"), 5678);
+
+		folder.deleteRecursively();
+
+		expectEquals<int>(first.errorCode, HeadlessRenderer::OK, "First render");
+		expectEquals<int>(second.errorCode, HeadlessRenderer::OK, "Second render");
+		expectEquals<int>(otherSeed.errorCode, HeadlessRenderer::OK, "Render with another seed");
+
+		expect(first.peakLevel > 0.01f, "The preset is not silent");
+		expect(first.checksum == second.checksum, "Same checksum: " + String::toHexString((int64)first.checksum) + ", " + String::toHexString((int64)second.checksum));
+		expect(first.checksum != otherSeed.checksum, "The seed changes the output");
+	}
+
+	/** Creates a WaveSynth with noise and random modulators and saves it as preset. */
+	static void writePreset(const File &presetFile)
+	{
+		ScopedPointer<BackendProcessor> bp = new BackendProcessor();
+
+		ModulatorSynthChain *chain = bp->getMainSynthChain();
+
+		WaveSynth *synth = new WaveSynth(bp, "Wave", NUM_POLYPHONIC_VOICES);
+
+		synth->setAttribute(WaveSynth::WaveForm2, (float)WaveformComponent::Noise, dontSendNotification);
+		synth->setAttribute(ModulatorSynth::Gain, 0.25f, dontSendNotification);
+
+		chain->getHandler()->add(synth, nullptr);
+
+		ModulatorChain *gainChain = dynamic_cast<ModulatorChain*>(synth->getChildProcessor(ModulatorSynth::GainModulation));
+		ModulatorChain *pitchChain = dynamic_cast<ModulatorChain*>(synth->getChildProcessor(ModulatorSynth::PitchModulation));
+
+		gainChain->getHandler()->add(new RandomModulator(bp, "Random Velocity", NUM_POLYPHONIC_VOICES, Modulation::GainMode), nullptr);
+
+		LfoModulator *lfo = new LfoModulator(bp, "Random LFO", Modulation::PitchMode);
+
+		lfo->setAttribute(LfoModulator::WaveFormType, (float)LfoModulator::Random, dontSendNotification);
+		lfo->setAttribute(LfoModulator::Frequency, 10.0f, dontSendNotification);
+
+		pitchChain->getHandler()->add(lfo, nullptr);
+
+		ScopedPointer<XmlElement> xml = chain->exportAsValueTree().createXml();
+
+		xml->writeToFile(presetFile, String());
+	}
+
+	static void writeMidiFile(const File &midiFile)
+	{
+		MidiMessageSequence sequence;
+
+		sequence.addEvent(MidiMessage::noteOn(1, 60, (uint8)100), 0.0);
+		sequence.addEvent(MidiMessage::noteOn(1, 67, (uint8)70), 240.0);
+		sequence.addEvent(MidiMessage::noteOn(1, 64, (uint8)90), 250.0);
+		sequence.addEvent(MidiMessage::noteOff(1, 60), 960.0);
+		sequence.addEvent(MidiMessage::noteOff(1, 67), 970.0);
+		sequence.addEvent(MidiMessage::noteOff(1, 64), 1200.0);
+
+		MidiFile file;
+
+		file.setTicksPerQuarterNote(960);
+		file.addTrack(sequence);
+
+		midiFile.deleteFile();
+
+		FileOutputStream fos(midiFile);
+
+		file.writeTo(fos);
+	}
+
+	/** The processor of the renderer is deleted before this returns because it redirects the log messages of the test to its console. */
+	static RenderResult render(const File &presetFile, const File &midiFile, const File &outputFile, int64 seed)
+	{
+		HeadlessRenderer::Options options;
+
+		options.presetFile = presetFile;
+		options.midiFile = midiFile;
+		options.outputFile = outputFile;
+		options.blockSize = 256;
+		options.tailSeconds = 0.5;
+		options.randomSeed = seed;
+
+		HeadlessRenderer renderer(options);
+
+		RenderResult result;
+
+		result.errorCode = renderer.render();
+		result.checksum = renderer.getStatistics().checksum;
+		result.peakLevel = jmax<float>(renderer.getStatistics().peakLevels[0], renderer.getStatistics().peakLevels[1]);
+
+		return result;
+	}
+};
+
+static HeadlessRendererUnitTest headlessRendererUnitTest;
@@ -58,3 +58,4 @@
 #include "backend/ProjectTemplate.cpp"
 #include "backend/StandaloneProjectTemplate.cpp"
 #include "backend/CompileExporter.cpp"
+#include "backend/HeadlessRenderer.cpp"
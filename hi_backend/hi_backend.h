@@ -76,6 +76,7 @@ using namespace juce;
 #include "backend/BackendApplicationCommands.h"
 #include "backend/BackendEditor.h"
 #include "backend/CompileExporter.h"
+#include "backend/HeadlessRenderer.h"
 
 
 
@@ -124,6 +124,8 @@ public:
 		Square,
 		Noise,
 		Custom,
+		PolyBlepSaw,
+		PolyBlepSquare,
 		numWaveformTypes
 	};
 
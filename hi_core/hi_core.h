@@ -156,6 +156,15 @@ Set this to 0 to deactivate the safe checks for scripting
 #define ENABLE_SCRIPTING_SAFE_CHECKS 1
 #endif
 
+/** Config: HISE_USE_SCRIPT_BYTECODE
+
+Set this to 1 to compile the script callbacks to bytecode by default instead of executing them by walking the statement tree.
+The bytecode is only about 7% faster in the benchmark of the unit tests, so it is disabled by default.
+*/
+#ifndef HISE_USE_SCRIPT_BYTECODE
+#define HISE_USE_SCRIPT_BYTECODE 0
+#endif
+
 /** Config: ENABLE_ALL_PEAK_METERS
 
 Set this to 0 to deactivate peak collection for any other processor than the main synth chain
@@ -188,6 +197,46 @@ Set this to 0 to deactivate the CPU peak meter.
 #define ENABLE_CPU_MEASUREMENT 1
 #endif
 
+/** Config: HISE_CONTROL_RATE_DIVIDER
+
+The default downsampling factor for envelopes and time variant modulators in every ModulatorChain. Set this to 1 to render all modulators at audio rate.
+*/
+#ifndef HISE_CONTROL_RATE_DIVIDER
+#define HISE_CONTROL_RATE_DIVIDER 1
+#endif
+
+
+/** Config: NUM_STREAMING_THREADS
+
+The number of background threads that stream the samples from disk. Set this to 0 to use a value derived from the number of CPU cores.
+*/
+#ifndef NUM_STREAMING_THREADS
+#define NUM_STREAMING_THREADS 0
+#endif
+
+/** Config: NUM_SAMPLE_LOADING_THREADS
+
+The number of threads that load the preload buffers of a sample map. Set this to 0 to use a value derived from the number of CPU cores.
+*/
+#ifndef NUM_SAMPLE_LOADING_THREADS
+#define NUM_SAMPLE_LOADING_THREADS 0
+#endif
+
+/** Config: HISE_USE_IO_URING
+
+Set this to 0 to read the streamed samples with pread() instead of an io_uring on Linux.
+*/
+#ifndef HISE_USE_IO_URING
+#define HISE_USE_IO_URING 1
+#endif
+
+/** Config: HISE_DEFAULT_PRELOAD_FORMAT
+
+The format of the preload and loop buffers (see StreamingSamplerSound::PreloadFormat). 0 uses float buffers, 1 keeps 16 / 24 bit samples in their native format and 2 stores every sample as 16 bit which halves the memory but is lossy for samples with a higher bit depth.
+*/
+#ifndef HISE_DEFAULT_PRELOAD_FORMAT
+#define HISE_DEFAULT_PRELOAD_FORMAT 0
+#endif
 
 /** Config: USE_HARD_CLIPPER
 
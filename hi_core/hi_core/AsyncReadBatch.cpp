@@ -0,0 +1,499 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licences for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licencing:
+*
+*   http://www.hartinstruments.net/hise/
+*
+*   HISE is based on the JUCE library,
+*   which also must be licenced for commercial applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+#if HI_ASYNC_READ_IO_URING
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#endif
+
+#if JUCE_LINUX
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+namespace AsyncReadHelpers
+{
+
+template <typename SampleType, typename Endianness> void convertInterleaved(const void *source, int numChannels, float *left, float *right, int numSamples)
+{
+	typedef AudioData::Pointer<SampleType, Endianness, AudioData::Interleaved, AudioData::Const> SourceType;
+	typedef AudioData::Pointer<AudioData::Float32, AudioData::NativeEndian, AudioData::NonInterleaved, AudioData::NonConst> DestType;
+
+	DestType(left).convertSamples(SourceType(source, numChannels), numSamples);
+
+	if (numChannels == 2)
+	{
+		DestType(right).convertSamples(SourceType(addBytesToPointer(source, SampleType::bytesPerSample), numChannels), numSamples);
+	}
+	else
+	{
+		FloatVectorOperations::copy(right, left, numSamples);
+	}
+}
+
+/** Gives access to the file position of a MemoryMappedAudioFormatReader. */
+struct ReaderPositionAccess : public MemoryMappedAudioFormatReader
+{
+	static int64 getDataStart(const MemoryMappedAudioFormatReader *reader)
+	{
+		return reader->*(&ReaderPositionAccess::dataChunkStart);
+	}
+
+	static int getBytesPerFrame(const MemoryMappedAudioFormatReader *reader)
+	{
+		return reader->*(&ReaderPositionAccess::bytesPerFrame);
+	}
+};
+
+} // namespace AsyncReadHelpers
+
+// ==================================================================================================== AsyncReadBatch::FileHandle methods
+
+AsyncReadBatch::FileHandle::~FileHandle()
+{
+#if JUCE_LINUX
+	close(fileDescriptor);
+#endif
+}
+
+AsyncReadBatch::FileHandle *AsyncReadBatch::FileHandle::open(const File &f)
+{
+#if JUCE_LINUX
+	const int fileDescriptor = ::open(f.getFullPathName().toRawUTF8(), O_RDONLY | O_CLOEXEC);
+
+	return fileDescriptor != -1 ? new FileHandle(fileDescriptor) : nullptr;
+#else
+	ignoreUnused(f);
+	return nullptr;
+#endif
+}
+
+// ==================================================================================================== AsyncReadBatch::FileLayout methods
+
+int AsyncReadBatch::FileLayout::getBytesPerFrame() const noexcept
+{
+	switch (format)
+	{
+	case Int16LittleEndian:
+	case Int16BigEndian:		return 2 * numChannels;
+	case Int24LittleEndian:
+	case Int24BigEndian:		return 3 * numChannels;
+	case Int32LittleEndian:
+	case Int32BigEndian:
+	case Float32LittleEndian:	return 4 * numChannels;
+	case numSampleFormats:		break;
+	}
+
+	jassertfalse;
+	return 0;
+}
+
+bool AsyncReadBatch::FileLayout::setFormat(int bitsPerSample, bool isFloatingPoint, bool isLittleEndian)
+{
+	if (isFloatingPoint)
+	{
+		format = Float32LittleEndian;
+		return bitsPerSample == 32 && isLittleEndian;
+	}
+
+	switch (bitsPerSample)
+	{
+	case 16: format = isLittleEndian ? Int16LittleEndian : Int16BigEndian; return true;
+	case 24: format = isLittleEndian ? Int24LittleEndian : Int24BigEndian; return true;
+	case 32: format = isLittleEndian ? Int32LittleEndian : Int32BigEndian; return true;
+	default: return false;
+	}
+}
+
+bool AsyncReadBatch::FileLayout::setFromReader(MemoryMappedAudioFormatReader *reader, FileHandle *fileToUse, bool isLittleEndian)
+{
+	file = nullptr;
+
+	if (reader == nullptr || fileToUse == nullptr)
+		return false;
+
+	numChannels = (int)reader->numChannels;
+
+	if (!setFormat((int)reader->bitsPerSample, reader->usesFloatingPointData, isLittleEndian))
+		return false;
+
+	// Don't guess if the reader uses another frame layout (eg. padded samples)
+	if (AsyncReadHelpers::ReaderPositionAccess::getBytesPerFrame(reader) != getBytesPerFrame())
+		return false;
+
+	dataStart = AsyncReadHelpers::ReaderPositionAccess::getDataStart(reader);
+	lengthInSamples = reader->lengthInSamples;
+	file = fileToUse;
+
+	return isValid();
+}
+
+// ==================================================================================================== AsyncReadBatch::IoUring
+
+#if HI_ASYNC_READ_IO_URING
+
+/** A minimal io_uring wrapper that uses the system calls directly (so there is no dependency to liburing). */
+class AsyncReadBatch::IoUring
+{
+public:
+
+	IoUring(unsigned numEntries)
+	{
+		io_uring_params p;
+		zerostruct(p);
+
+		ringFd = (int)syscall(__NR_io_uring_setup, numEntries, &p);
+
+		if (ringFd < 0)
+			return;
+
+		sqRingSize = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+		cqRingSize = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+		sqesSize = p.sq_entries * sizeof(io_uring_sqe);
+
+#ifdef IORING_FEAT_SINGLE_MMAP
+		singleMap = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+#endif
+
+		if (singleMap)
+		{
+			sqRingSize = jmax<size_t>(sqRingSize, cqRingSize);
+			cqRingSize = sqRingSize;
+		}
+
+		sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+		cqRing = singleMap ? sqRing : mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+		sqes = mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+
+		if (sqRing == MAP_FAILED || cqRing == MAP_FAILED || sqes == MAP_FAILED)
+		{
+			release();
+			return;
+		}
+
+		char *sq = static_cast<char*>(sqRing);
+		char *cq = static_cast<char*>(cqRing);
+
+		sqTail = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+		sqMask = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+		sqArray = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+
+		cqHead = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+		cqTail = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+		cqMask = *reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+		cqes = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+
+		numSubmissionEntries = p.sq_entries;
+	}
+
+	~IoUring()
+	{
+		release();
+	}
+
+	bool isValid() const noexcept { return ringFd >= 0; }
+
+	/** Submits the requests and waits until all of them are completed. Returns false if the ring stopped working. */
+	bool submitAndWait(Request *requests, int numRequests)
+	{
+		jassert((unsigned)numRequests <= numSubmissionEntries);
+
+		io_uring_sqe *submissionEntries = static_cast<io_uring_sqe*>(sqes);
+
+		unsigned tail = *sqTail;
+
+		for (int i = 0; i < numRequests; i++)
+		{
+			Request &r = requests[i];
+
+			const unsigned index = tail & sqMask;
+			io_uring_sqe *sqe = submissionEntries + index;
+
+			zeromem(sqe, sizeof(io_uring_sqe));
+
+			ioVectors[i].iov_base = r.data;
+			ioVectors[i].iov_len = (size_t)r.numBytes;
+
+			sqe->opcode = IORING_OP_READV;
+			sqe->fd = r.file->getFileDescriptor();
+			sqe->off = (uint64)r.fileOffset;
+			sqe->addr = (uint64)(pointer_sized_uint)&ioVectors[i];
+			sqe->len = 1;
+			sqe->user_data = (uint64)i;
+
+			sqArray[index] = index;
+			tail++;
+		}
+
+		__atomic_store_n(sqTail, tail, __ATOMIC_RELEASE);
+
+		int numToSubmit = numRequests;
+		int numCompleted = 0;
+
+		while (numCompleted < numRequests)
+		{
+			const int result = (int)syscall(__NR_io_uring_enter, ringFd, numToSubmit, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+
+			if (result < 0)
+			{
+				if (errno == EINTR)
+					continue;
+
+				return false;
+			}
+
+			numToSubmit = jmax<int>(0, numToSubmit - result);
+
+			unsigned head = *cqHead;
+			const unsigned completionTail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+
+			while (head != completionTail)
+			{
+				const io_uring_cqe &cqe = cqes[head & cqMask];
+
+				Request &r = requests[(int)cqe.user_data];
+
+				r.numBytesRead = cqe.res;
+				r.completed = true;
+
+				head++;
+				numCompleted++;
+			}
+
+			__atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+		}
+
+		return true;
+	}
+
+private:
+
+	void release()
+	{
+		if (sqes != nullptr && sqes != MAP_FAILED) munmap(sqes, sqesSize);
+		if (cqRing != nullptr && cqRing != MAP_FAILED && !singleMap) munmap(cqRing, cqRingSize);
+		if (sqRing != nullptr && sqRing != MAP_FAILED) munmap(sqRing, sqRingSize);
+
+		sqes = nullptr;
+		cqRing = nullptr;
+		sqRing = nullptr;
+
+		if (ringFd >= 0) close(ringFd);
+
+		ringFd = -1;
+	}
+
+	int ringFd = -1;
+	bool singleMap = false;
+
+	void *sqRing = nullptr;
+	void *cqRing = nullptr;
+	void *sqes = nullptr;
+
+	size_t sqRingSize = 0;
+	size_t cqRingSize = 0;
+	size_t sqesSize = 0;
+
+	unsigned *sqTail = nullptr;
+	unsigned *sqArray = nullptr;
+	unsigned sqMask = 0;
+
+	unsigned *cqHead = nullptr;
+	unsigned *cqTail = nullptr;
+	unsigned cqMask = 0;
+	io_uring_cqe *cqes = nullptr;
+
+	unsigned numSubmissionEntries = 0;
+
+	iovec ioVectors[MaxNumRequests];
+};
+
+#else
+
+class AsyncReadBatch::IoUring
+{
+public:
+
+	IoUring(unsigned /*numEntries*/) {};
+
+	bool isValid() const noexcept { return false; }
+
+	bool submitAndWait(Request* /*requests*/, int /*numRequests*/) { return false; }
+};
+
+#endif
+
+// ==================================================================================================== AsyncReadBatch methods
+
+AsyncReadBatch::AsyncReadBatch() :
+	stagingPosition(0),
+	numRequests(0)
+{
+#if JUCE_LINUX
+	stagingBuffer.malloc(StagingBufferSize);
+
+	ring = new IoUring(MaxNumRequests);
+
+	if (!ring->isValid())
+		ring = nullptr;
+#endif
+}
+
+AsyncReadBatch::~AsyncReadBatch()
+{
+	ring = nullptr;
+}
+
+bool AsyncReadBatch::isAvailable() const noexcept
+{
+	return stagingBuffer != nullptr;
+}
+
+bool AsyncReadBatch::isFull() const noexcept
+{
+	return numRequests > MaxNumRequests - 8 || (StagingBufferSize - stagingPosition) < StagingBufferSize / 8;
+}
+
+bool AsyncReadBatch::addRead(const FileLayout &layout, int64 startSampleInFile, AudioSampleBuffer &destination, int startSampleInDestination, int numSamples)
+{
+	if (!isAvailable() || !layout.isValid() || numRequests == MaxNumRequests)
+		return false;
+
+	jassert(startSampleInFile >= 0);
+	jassert(destination.getNumChannels() >= 2);
+	jassert(startSampleInDestination + numSamples <= destination.getNumSamples());
+
+	// The samples after the end of the file stay cleared
+	const int numSamplesToRead = (int)jmin<int64>(numSamples, layout.lengthInSamples - startSampleInFile);
+
+	if (numSamplesToRead <= 0)
+		return true;
+
+	const int numBytes = numSamplesToRead * layout.getBytesPerFrame();
+
+	if (stagingPosition + numBytes > StagingBufferSize)
+		return false;
+
+	Request &r = requests[numRequests++];
+
+	// The sound might close its file handles before the batch is submitted,
+	// so the request keeps a reference to the file until it is finished.
+	r.file = layout.file;
+	r.fileOffset = layout.dataStart + startSampleInFile * layout.getBytesPerFrame();
+	r.numBytes = numBytes;
+	r.numBytesRead = 0;
+	r.completed = false;
+	r.data = stagingBuffer + stagingPosition;
+
+	r.format = layout.format;
+	r.numChannels = layout.numChannels;
+	r.left = destination.getWritePointer(0, startSampleInDestination);
+	r.right = destination.getWritePointer(1, startSampleInDestination);
+	r.numSamples = numSamplesToRead;
+
+	// Keep the staging areas aligned
+	stagingPosition += (numBytes + 15) & ~15;
+
+	return true;
+}
+
+void AsyncReadBatch::submitAndWait()
+{
+	if (numRequests == 0)
+		return;
+
+	if (ring != nullptr && !ring->submitAndWait(requests, numRequests))
+	{
+		// Use pread() from now on...
+		jassertfalse;
+		ring = nullptr;
+	}
+
+	for (int i = 0; i < numRequests; i++)
+	{
+		Request &r = requests[i];
+
+		if (!r.completed || r.numBytesRead < r.numBytes)
+			readSynchronously(r);
+
+		convertSamples(r);
+		r.file = nullptr;
+	}
+
+	numRequests = 0;
+	stagingPosition = 0;
+}
+
+void AsyncReadBatch::readSynchronously(Request &r)
+{
+	int numBytesRead = (r.completed && r.numBytesRead > 0) ? r.numBytesRead : 0;
+
+#if JUCE_LINUX
+	while (numBytesRead < r.numBytes)
+	{
+		const ssize_t result = pread(r.file->getFileDescriptor(), r.data + numBytesRead, (size_t)(r.numBytes - numBytesRead), (off_t)(r.fileOffset + numBytesRead));
+
+		if (result < 0 && errno == EINTR)
+			continue;
+
+		if (result <= 0)
+			break;
+
+		numBytesRead += (int)result;
+	}
+#endif
+
+	// Something went wrong, so clear the missing part
+	if (numBytesRead < r.numBytes)
+		zeromem(r.data + numBytesRead, (size_t)(r.numBytes - numBytesRead));
+
+	r.numBytesRead = numBytesRead;
+	r.completed = true;
+}
+
+void AsyncReadBatch::convertSamples(const Request &r)
+{
+	using namespace AsyncReadHelpers;
+
+	switch (r.format)
+	{
+	case Int16LittleEndian:		convertInterleaved<AudioData::Int16, AudioData::LittleEndian>(r.data, r.numChannels, r.left, r.right, r.numSamples); break;
+	case Int24LittleEndian:		convertInterleaved<AudioData::Int24, AudioData::LittleEndian>(r.data, r.numChannels, r.left, r.right, r.numSamples); break;
+	case Int32LittleEndian:		convertInterleaved<AudioData::Int32, AudioData::LittleEndian>(r.data, r.numChannels, r.left, r.right, r.numSamples); break;
+	case Float32LittleEndian:	convertInterleaved<AudioData::Float32, AudioData::LittleEndian>(r.data, r.numChannels, r.left, r.right, r.numSamples); break;
+	case Int16BigEndian:		convertInterleaved<AudioData::Int16, AudioData::BigEndian>(r.data, r.numChannels, r.left, r.right, r.numSamples); break;
+	case Int24BigEndian:		convertInterleaved<AudioData::Int24, AudioData::BigEndian>(r.data, r.numChannels, r.left, r.right, r.numSamples); break;
+	case Int32BigEndian:		convertInterleaved<AudioData::Int32, AudioData::BigEndian>(r.data, r.numChannels, r.left, r.right, r.numSamples); break;
+	case numSampleFormats:		jassertfalse; break;
+	}
+}
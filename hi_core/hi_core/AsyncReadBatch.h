@@ -0,0 +1,199 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licences for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licencing:
+*
+*   http://www.hartinstruments.net/hise/
+*
+*   HISE is based on the JUCE library,
+*   which also must be licenced for commercial applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+#ifndef ASYNCREADBATCH_H_INCLUDED
+#define ASYNCREADBATCH_H_INCLUDED
+
+#if JUCE_LINUX && HISE_USE_IO_URING && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define HI_ASYNC_READ_IO_URING 1
+#endif
+#endif
+
+#ifndef HI_ASYNC_READ_IO_URING
+#define HI_ASYNC_READ_IO_URING 0
+#endif
+
+/** A batch of file reads that are submitted to the operating system at once.
+*
+*	The streaming threads collect the disk reads of multiple SampleLoaders in a batch and submit them together. On Linux
+*	the reads are handed to an io_uring, so the kernel can process all of them in parallel instead of waiting for one page
+*	fault after another. If the io_uring can't be created (old kernel or disabled with HISE_USE_IO_URING), the reads
+*	are performed one after another with pread(). On other platforms the batch is not available and the jobs will read
+*	the data synchronously like before.
+*
+*	The batch is submitted and completed synchronously by the streaming thread that collected it: submitAndWait() blocks
+*	this thread until all reads are finished, but the audio thread never waits for it (it only checks the loader's
+*	buffer state like with the single reads). There is no completion callback because a SampleLoader can't swap its
+*	buffers before its read is done anyway, so the benefit comes from the parallel reads in the kernel, not from
+*	returning early. The file handles are reference counted and every request keeps a reference until it is completed,
+*	so the sound can close its handles at any time after the read was added.
+*/
+class AsyncReadBatch
+{
+public:
+
+	enum
+	{
+		MaxNumRequests = 128,
+		StagingBufferSize = 2 * 1024 * 1024
+	};
+
+	/** The sample format of the raw data in the file. */
+	enum SampleFormat
+	{
+		Int16LittleEndian = 0,
+		Int24LittleEndian,
+		Int32LittleEndian,
+		Float32LittleEndian,
+		Int16BigEndian,
+		Int24BigEndian,
+		Int32BigEndian,
+		numSampleFormats
+	};
+
+	/** A read only file handle that is shared by the layouts of a file and the reads of the batch.
+	*
+	*	The file is opened once and closed when the last reference is released, so adding a read doesn't need a system call.
+	*/
+	class FileHandle : public ReferenceCountedObject
+	{
+	public:
+
+		typedef ReferenceCountedObjectPtr<FileHandle> Ptr;
+
+		~FileHandle();
+
+		/** Opens the file. Returns nullptr if it can't be opened or the platform doesn't support the batch. */
+		static FileHandle *open(const File &f);
+
+		int getFileDescriptor() const noexcept { return fileDescriptor; }
+
+	private:
+
+		FileHandle(int fileDescriptor_) : fileDescriptor(fileDescriptor_) {};
+
+		const int fileDescriptor;
+
+		JUCE_DECLARE_NON_COPYABLE(FileHandle)
+	};
+
+	/** Describes the location and the format of interleaved sample data in a file. */
+	struct FileLayout
+	{
+		FileLayout() :
+			dataStart(0),
+			lengthInSamples(0),
+			numChannels(0),
+			format(Int16LittleEndian)
+		{};
+
+		bool isValid() const noexcept { return file != nullptr && numChannels > 0 && numChannels <= 2; }
+
+		int getBytesPerFrame() const noexcept;
+
+		/** Sets the sample format. Returns false if the format can't be read by the batch. */
+		bool setFormat(int bitsPerSample, bool isFloatingPoint, bool isLittleEndian);
+
+		/** Fills the layout using the file position of a memory mapped reader. */
+		bool setFromReader(MemoryMappedAudioFormatReader *reader, FileHandle *fileToUse, bool isLittleEndian);
+
+		FileHandle::Ptr file;
+		int64 dataStart;
+		int64 lengthInSamples;
+		int numChannels;
+		SampleFormat format;
+	};
+
+	AsyncReadBatch();
+
+	~AsyncReadBatch();
+
+	/** Returns true if the batch can be used on this system. */
+	bool isAvailable() const noexcept;
+
+	/** Returns true if the reads are submitted to an io_uring. */
+	bool usesIoUring() const noexcept { return ring != nullptr; }
+
+	/** Adds a read operation. The samples are written to the destination buffer when the batch is submitted.
+	*
+	*	Returns false if the read does not fit into the batch. In this case you have to read the samples yourself.
+	*/
+	bool addRead(const FileLayout &layout, int64 startSampleInFile, AudioSampleBuffer &destination, int startSampleInDestination, int numSamples);
+
+	/** Returns true if the batch should be submitted before adding more jobs. */
+	bool isFull() const noexcept;
+
+	int getNumRequests() const noexcept { return numRequests; }
+
+	/** Submits all reads, waits until they are finished and converts the samples into the destination buffers.
+	*
+	*	This releases the file handles of the requests.
+	*/
+	void submitAndWait();
+
+private:
+
+	struct Request
+	{
+		FileHandle::Ptr file;
+		int64 fileOffset;
+		int numBytes;
+		int numBytesRead;
+		bool completed;
+		char *data;
+
+		SampleFormat format;
+		int numChannels;
+		float *left;
+		float *right;
+		int numSamples;
+	};
+
+	void readSynchronously(Request &r);
+
+	static void convertSamples(const Request &r);
+
+	class IoUring;
+
+	ScopedPointer<IoUring> ring;
+
+	HeapBlock<char> stagingBuffer;
+	int stagingPosition;
+
+	Request requests[MaxNumRequests];
+	int numRequests;
+
+	JUCE_DECLARE_NON_COPYABLE(AsyncReadBatch)
+};
+
+#endif  // ASYNCREADBATCH_H_INCLUDED
@@ -0,0 +1,348 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licences for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licencing:
+*
+*   http://www.hartinstruments.net/hise/
+*
+*   HISE is based on the JUCE library,
+*   which also must be licenced for commercial applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+
+#include "JuceHeader.h"
+
+/** Reads samples with an AsyncReadBatch (directly and through the streaming thread pool) and compares them with the
+*	data that was written to the files.
+*/
+class AsyncReadBatchUnitTest : public UnitTest
+{
+public:
+
+	AsyncReadBatchUnitTest() :
+		UnitTest("Testing batched sample reads")
+	{
+
+	}
+
+	void runTest() override
+	{
+		AsyncReadBatch batch;
+
+		if (!batch.isAvailable())
+		{
+			beginTest("Skipping the batched reads");
+			logMessage("The batch is not available on this platform");
+			return;
+		}
+
+		logMessage(batch.usesIoUring() ? "Using an io_uring" : "Using pread()");
+
+		directory = File::getSpecialLocation(File::tempDirectory).getChildFile("AsyncReadBatchTest");
+		directory.deleteRecursively();
+		directory.createDirectory();
+
+		testFormats();
+		testClosedHandle();
+		testThreadPool();
+
+		directory.deleteRecursively();
+	}
+
+private:
+
+	enum
+	{
+		NumFramesPerFile = 20000,
+		NumSamplesPerRead = 4096,
+		NumJobs = 48
+	};
+
+	enum FileType
+	{
+		Wav16Stereo = 0,
+		Wav24Mono,
+		WavFloatStereo,
+		Aiff16Stereo,
+		numFileTypes
+	};
+
+	static String getName(int type)
+	{
+		switch (type)
+		{
+		case Wav16Stereo:		return "16 bit stereo WAV";
+		case Wav24Mono:			return "24 bit mono WAV";
+		case WavFloatStereo:	return "32 bit float stereo WAV";
+		case Aiff16Stereo:		return "16 bit stereo AIFF";
+		default:				jassertfalse; return String();
+		}
+	}
+
+	static float getExpectedSample(int channel, int64 position)
+	{
+		return 0.8f * (float)std::sin(0.0123 * (double)position * (double)(channel + 1));
+	}
+
+	static float getTolerance(int type)
+	{
+		switch (type)
+		{
+		case Wav24Mono:			return 1.0e-6f;
+		case WavFloatStereo:	return 0.0f;
+		default:				return 1.0e-4f;
+		}
+	}
+
+	/** Writes a test signal and creates a layout for the file. */
+	AsyncReadBatch::FileLayout createLayout(int type)
+	{
+		const bool isAiff = type == Aiff16Stereo;
+		const int numChannels = type == Wav24Mono ? 1 : 2;
+		const int bitDepth = type == Wav24Mono ? 24 : (type == WavFloatStereo ? 32 : 16);
+
+		const File f = directory.getChildFile("Sample" + String(type) + (isAiff ? ".aif" : ".wav"));
+
+		ScopedPointer<AudioFormat> format = isAiff ? static_cast<AudioFormat*>(new AiffAudioFormat()) : static_cast<AudioFormat*>(new WavAudioFormat());
+
+		if (!f.existsAsFile())
+		{
+			AudioSampleBuffer b(numChannels, NumFramesPerFile);
+
+			for (int c = 0; c < numChannels; c++)
+			{
+				for (int i = 0; i < NumFramesPerFile; i++)
+					b.setSample(c, i, getExpectedSample(c, i));
+			}
+
+			ScopedPointer<AudioFormatWriter> writer = format->createWriterFor(new FileOutputStream(f), 44100.0, numChannels, bitDepth, StringPairArray(), 0);
+
+			writer->writeFromAudioSampleBuffer(b, 0, NumFramesPerFile);
+		}
+
+		ScopedPointer<MemoryMappedAudioFormatReader> reader = format->createMemoryMappedReader(f);
+		AsyncReadBatch::FileHandle::Ptr file = AsyncReadBatch::FileHandle::open(f);
+
+		AsyncReadBatch::FileLayout layout;
+
+		expect(layout.setFromReader(reader, file, !isAiff), "Layout of the " + getName(type));
+
+		return layout;
+	}
+
+	/** Returns the biggest difference to the test signal. Mono files must be copied to the right channel. */
+	static float getMaxError(const AudioSampleBuffer &b, int startSample, int numSamples, int64 positionInFile, int numChannelsInFile)
+	{
+		float maxError = 0.0f;
+
+		for (int c = 0; c < 2; c++)
+		{
+			const int fileChannel = numChannelsInFile == 1 ? 0 : c;
+
+			for (int i = 0; i < numSamples; i++)
+			{
+				const int64 position = positionInFile + i;
+				const float expected = position < NumFramesPerFile ? getExpectedSample(fileChannel, position) : 0.0f;
+
+				maxError = jmax<float>(maxError, std::abs(b.getSample(c, startSample + i) - expected));
+			}
+		}
+
+		return maxError;
+	}
+
+	void testFormats()
+	{
+		beginTest("Testing the sample formats");
+
+		AsyncReadBatch batch;
+
+		const int64 positions[] = { 0, 1, 777, 12345, NumFramesPerFile - 1000 };
+		const int numPositions = numElementsInArray(positions);
+
+		OwnedArray<AudioSampleBuffer> buffers;
+		Array<AsyncReadBatch::FileLayout> layouts;
+
+		for (int type = 0; type < numFileTypes; type++)
+		{
+			layouts.add(createLayout(type));
+
+			for (int p = 0; p < numPositions; p++)
+			{
+				AudioSampleBuffer *b = buffers.add(new AudioSampleBuffer(2, NumSamplesPerRead + 100));
+
+				b->clear();
+
+				// Read into the middle of the buffer like a SampleLoader does with its write position
+				expect(batch.addRead(layouts.getReference(type), positions[p], *b, 100, NumSamplesPerRead), "Adding the read");
+			}
+		}
+
+		expectEquals<int>(batch.getNumRequests(), numFileTypes * numPositions, "Number of requests");
+
+		batch.submitAndWait();
+
+		expectEquals<int>(batch.getNumRequests(), 0, "The batch is empty after the submission");
+
+		for (int type = 0; type < numFileTypes; type++)
+		{
+			const int numChannelsInFile = layouts.getReference(type).numChannels;
+
+			for (int p = 0; p < numPositions; p++)
+			{
+				const AudioSampleBuffer &b = *buffers[type * numPositions + p];
+
+				const float error = getMaxError(b, 100, NumSamplesPerRead, positions[p], numChannelsInFile);
+
+				expect(error <= getTolerance(type), getName(type) + " at " + String(positions[p]) + ": max error " + String(error, 8));
+				expect(b.getMagnitude(0, 100) == 0.0f, getName(type) + ": the samples before the read are untouched");
+			}
+		}
+	}
+
+	void testClosedHandle()
+	{
+		beginTest("Testing a read after the sound closed its file handle");
+
+		AsyncReadBatch batch;
+		AudioSampleBuffer b(2, NumSamplesPerRead);
+
+		b.clear();
+
+		{
+			AsyncReadBatch::FileLayout layout = createLayout(Wav16Stereo);
+
+			expectEquals<int>(layout.file->getReferenceCount(), 1, "The layout owns the only reference");
+
+			batch.addRead(layout, 500, b, 0, NumSamplesPerRead);
+
+			expectEquals<int>(layout.file->getReferenceCount(), 2, "The request shares the handle");
+		}
+
+		batch.submitAndWait();
+
+		const float error = getMaxError(b, 0, NumSamplesPerRead, 500, 2);
+
+		expect(error <= getTolerance(Wav16Stereo), "Max error: " + String(error, 8));
+	}
+
+	/** Reads a block of samples with the batch of the streaming thread. */
+	class ReadJob : public SampleThreadPool::Job
+	{
+	public:
+
+		ReadJob(const AsyncReadBatch::FileLayout &layout_, int64 position_) :
+			Job("Read Job"),
+			layout(layout_),
+			position(position_),
+			buffer(2, NumSamplesPerRead),
+			numBatchedRuns(0),
+			numRuns(0)
+		{
+			buffer.clear();
+		};
+
+		JobStatus runJob() override
+		{
+			numRuns++;
+			return jobHasFinished;
+		}
+
+		bool addToBatch(AsyncReadBatch &batch) override
+		{
+			return batch.addRead(layout, position, buffer, 0, NumSamplesPerRead);
+		}
+
+		JobStatus finishBatchedJob() override
+		{
+			numBatchedRuns++;
+			return jobHasFinished;
+		}
+
+		const AsyncReadBatch::FileLayout layout;
+		const int64 position;
+
+		AudioSampleBuffer buffer;
+
+		std::atomic<int> numBatchedRuns;
+		std::atomic<int> numRuns;
+	};
+
+	void testThreadPool()
+	{
+		beginTest("Testing batched reads of the streaming threads");
+
+		OwnedArray<ReadJob> jobs;
+
+		for (int i = 0; i < NumJobs; i++)
+		{
+			const int type = i % numFileTypes;
+
+			jobs.add(new ReadJob(createLayout(type), (int64)(i * 397) % NumFramesPerFile));
+		}
+
+		{
+			SampleThreadPool pool(2);
+
+			for (int i = 0; i < jobs.size(); i++)
+			{
+				jobs[i]->setDeadline(i * 64);
+				pool.addJob(jobs[i], false);
+			}
+
+			const double timeout = Time::getMillisecondCounterHiRes() + 5000.0;
+
+			while (pool.getNumQueuedJobs() > 0 && Time::getMillisecondCounterHiRes() < timeout)
+				Thread::sleep(1);
+
+			expectEquals<int>(pool.getNumQueuedJobs(), 0, "Pending jobs");
+		}
+
+		int numWrongJobs = 0;
+		int numBatchedRuns = 0;
+		int numRuns = 0;
+
+		for (int i = 0; i < jobs.size(); i++)
+		{
+			ReadJob *j = jobs[i];
+
+			const int type = i % numFileTypes;
+			const float error = getMaxError(j->buffer, 0, NumSamplesPerRead, j->position, j->layout.numChannels);
+
+			if (error > getTolerance(type))
+				numWrongJobs++;
+
+			numBatchedRuns += j->numBatchedRuns.load();
+			numRuns += j->numRuns.load();
+		}
+
+		expectEquals<int>(numBatchedRuns, NumJobs, "Every job was read by a batch");
+		expectEquals<int>(numRuns, 0, "No job was run without the batch");
+		expectEquals<int>(numWrongJobs, 0, "Jobs with wrong samples");
+	}
+
+	File directory;
+};
+
+static AsyncReadBatchUnitTest asyncReadBatchUnitTest;
@@ -0,0 +1,87 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licences for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licencing:
+*
+*   http://www.hartinstruments.net/hise/
+*
+*   HISE is based on the JUCE library,
+*   which also must be licenced for commercial applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+AudioThreadCommandQueue::AudioThreadCommandQueue(int capacity) :
+	commands(capacity)
+{
+}
+
+AudioThreadCommandQueue::~AudioThreadCommandQueue()
+{
+}
+
+bool AudioThreadCommandQueue::push(Function f, void *object, double value, int index, const void *key) noexcept
+{
+	Command c;
+
+	c.function = f;
+	c.object = object;
+	c.key = key;
+	c.value = value;
+	c.index = index;
+
+	return commands.push(c);
+}
+
+int AudioThreadCommandQueue::drain() noexcept
+{
+	int numExecuted = 0;
+
+	Command c;
+
+	for (int i = 0; i < commands.getCapacity(); i++)
+	{
+		// The slot is released before the command is executed so that the command can push new commands.
+		if (!commands.pop(c))
+			break;
+
+		if (c.function != nullptr)
+		{
+			c.function(c.object, c.value, c.index, c.key);
+			numExecuted++;
+		}
+	}
+
+	return numExecuted;
+}
+
+void AudioThreadCommandQueue::cancelCommandsFor(const void *object) noexcept
+{
+	Canceller canceller = { object };
+
+	commands.forEachPending(canceller);
+}
+
+bool AudioThreadCommandQueue::isEmpty() const noexcept
+{
+	return commands.isEmpty();
+}
@@ -0,0 +1,115 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licences for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licencing:
+*
+*   http://www.hartinstruments.net/hise/
+*
+*   HISE is based on the JUCE library,
+*   which also must be licenced for commercial applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+#ifndef AUDIOTHREADCOMMANDQUEUE_H_INCLUDED
+#define AUDIOTHREADCOMMANDQUEUE_H_INCLUDED
+
+/** A bounded lock-free queue that passes parameter changes from other threads to the audio thread.
+*
+*	Setters that used to acquire the main lock to change state that is used during rendering push a command into
+*	this queue instead. The audio thread executes all pending commands at the start of the next block, so the
+*	message thread never blocks the audio callback for a simple parameter change.
+*
+*	This is only meant for changes that can be described by a number and an index. Structural changes (adding or
+*	removing processors, loading files and samples, resizing buffers in prepareToPlay()) still acquire the lock,
+*	because they allocate or need to be visible to the caller immediately.
+*
+*	Any thread can push commands (the slots are claimed with a sequence number per slot, so producers don't need a
+*	lock). There must be only one thread that executes the commands at a time: the MainController drains the queue
+*	while it holds its lock, and the fallback path for a full queue does the same.
+*
+*	A command stores a plain pointer to its target, so a target that is deleted must call cancelCommandsFor()
+*	(again while holding the lock that guards the drain) before it goes away.
+*/
+class AudioThreadCommandQueue
+{
+public:
+
+	/** The function that is executed on the audio thread. The value, index and key are passed from the push() call. */
+	typedef void(*Function)(void *object, double value, int index, const void *key);
+
+	/** Creates a queue. The capacity will be rounded up to the next power of two. */
+	AudioThreadCommandQueue(int capacity=1024);
+
+	~AudioThreadCommandQueue();
+
+	/** Adds a command. This can be called from any thread and returns false if the queue is full.
+	*
+	*	The key is passed on to the function. The queue never dereferences it, so it can be used to identify an object that
+	*	might be deleted before the command is executed.
+	*/
+	bool push(Function f, void *object, double value=0.0, int index=0, const void *key=nullptr) noexcept;
+
+	/** Executes all commands in the order they were pushed and returns the number of executed commands.
+	*
+	*	Only one thread must drain the queue at a time. Commands that are pushed while this is running are executed
+	*	too unless the queue has been filled up once since the call started.
+	*/
+	int drain() noexcept;
+
+	/** Removes all pending commands for the given object. Call this before the object is deleted. */
+	void cancelCommandsFor(const void *object) noexcept;
+
+	/** Checks if there are no pending commands. This is only a snapshot if other threads push commands. */
+	bool isEmpty() const noexcept;
+
+	int getCapacity() const noexcept { return commands.getCapacity(); }
+
+private:
+
+	struct Command
+	{
+		Function function;
+		void *object;
+		const void *key;
+		double value;
+		int index;
+	};
+
+	/** Clears the function of the pending commands for an object. */
+	struct Canceller
+	{
+		void operator()(Command &c) const noexcept
+		{
+			if (c.object == object)
+				c.function = nullptr;
+		}
+
+		const void *object;
+	};
+
+	MultiProducerQueue<Command> commands;
+
+	JUCE_DECLARE_NON_COPYABLE(AudioThreadCommandQueue)
+};
+
+#endif  // AUDIOTHREADCOMMANDQUEUE_H_INCLUDED
@@ -0,0 +1,326 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licences for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licencing:
+*
+*   http://www.hartinstruments.net/hise/
+*
+*   HISE is based on the JUCE library,
+*   which also must be licenced for commercial applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+
+#include "JuceHeader.h"
+
+class AudioThreadCommandQueueUnitTest : public UnitTest
+{
+public:
+
+	AudioThreadCommandQueueUnitTest() :
+		UnitTest("Testing the lock-free audio thread command queue")
+	{
+
+	}
+
+	void runTest() override
+	{
+		testCapacity();
+		testCancelling();
+		testConcurrentProducers();
+		testWorstCaseCallbackTime();
+	}
+
+private:
+
+	enum
+	{
+		NumProducers = 4,
+		NumCommandsPerProducer = 20000,
+		BlockSize = 256
+	};
+
+	/** Stores the last value for every producer and counts ordering errors. */
+	struct Receiver
+	{
+		Receiver()
+		{
+			for (int i = 0; i < NumProducers; i++)
+				lastValues[i] = -1;
+
+			numReceived = 0;
+			numOrderErrors = 0;
+		}
+
+		static void receive(void *object, double value, int index, const void*)
+		{
+			Receiver *r = static_cast<Receiver*>(object);
+
+			const int intValue = (int)value;
+
+			if (intValue != r->lastValues[index] + 1)
+				r->numOrderErrors++;
+
+			r->lastValues[index] = intValue;
+			r->numReceived++;
+		}
+
+		static void count(void *object, double, int, const void*)
+		{
+			static_cast<Receiver*>(object)->numReceived++;
+		}
+
+		int lastValues[NumProducers];
+		int numReceived;
+		int numOrderErrors;
+	};
+
+	class Producer : public Thread
+	{
+	public:
+
+		Producer(AudioThreadCommandQueue &queue_, Receiver &receiver_, int index_) :
+			Thread("Producer " + String(index_)),
+			queue(queue_),
+			receiver(receiver_),
+			index(index_)
+		{};
+
+		void run() override
+		{
+			for (int i = 0; i < NumCommandsPerProducer; i++)
+			{
+				while (!queue.push(Receiver::receive, &receiver, (double)i, index))
+				{
+					if (threadShouldExit())
+						return;
+
+					Thread::sleep(1);
+				}
+			}
+		}
+
+	private:
+
+		AudioThreadCommandQueue &queue;
+		Receiver &receiver;
+		const int index;
+	};
+
+	void testCapacity()
+	{
+		beginTest("Testing a full queue");
+
+		AudioThreadCommandQueue queue(100);
+
+		expectEquals(queue.getCapacity(), 128, "Capacity is rounded up");
+
+		Receiver r;
+
+		for (int i = 0; i < 128; i++)
+			expect(queue.push(Receiver::count, &r), "Push " + String(i));
+
+		expect(!queue.push(Receiver::count, &r), "Full queue rejects commands");
+		expectEquals(queue.drain(), 128, "All commands executed");
+		expect(queue.isEmpty(), "Queue is empty");
+		expect(queue.push(Receiver::count, &r), "Push after drain");
+		expectEquals(queue.drain(), 1, "Wrapped command executed");
+	}
+
+	void testCancelling()
+	{
+		beginTest("Testing cancelled commands");
+
+		AudioThreadCommandQueue queue(64);
+
+		Receiver a, b;
+
+		for (int i = 0; i < 20; i++)
+		{
+			queue.push(Receiver::count, &a);
+			queue.push(Receiver::count, &b);
+		}
+
+		// The key only identifies an object for the function, so it must not be cancelled with it
+		queue.push(Receiver::count, &b, 0.0, 0, &a);
+
+		queue.cancelCommandsFor(&a);
+
+		expectEquals(queue.drain(), 21, "Only the remaining commands are executed");
+		expectEquals(a.numReceived, 0, "Cancelled object");
+		expectEquals(b.numReceived, 21, "Other object");
+	}
+
+	void testConcurrentProducers()
+	{
+		beginTest("Testing concurrent producers");
+
+		AudioThreadCommandQueue queue(256);
+		Receiver r;
+
+		OwnedArray<Producer> producers;
+
+		for (int i = 0; i < NumProducers; i++)
+			producers.add(new Producer(queue, r, i));
+
+		for (int i = 0; i < NumProducers; i++)
+			producers[i]->startThread();
+
+		const int numExpected = NumProducers * NumCommandsPerProducer;
+
+		const double timeout = Time::getMillisecondCounterHiRes() + 20000.0;
+
+		while (r.numReceived < numExpected && Time::getMillisecondCounterHiRes() < timeout)
+		{
+			if (queue.drain() == 0)
+				Thread::sleep(1);
+		}
+
+		for (int i = 0; i < NumProducers; i++)
+			producers[i]->stopThread(1000);
+
+		queue.drain();
+
+		expectEquals(r.numReceived, numExpected, "Every command is executed once");
+		expectEquals(r.numOrderErrors, 0, "Commands of one thread keep their order");
+	}
+
+	/** Simulates the audio callback while another thread changes a parameter every few milliseconds. */
+	class ParameterChanger : public Thread
+	{
+	public:
+
+		ParameterChanger(CriticalSection &lock_, AudioThreadCommandQueue *queue_, float &parameter_) :
+			Thread("Parameter Changer"),
+			lock(lock_),
+			queue(queue_),
+			parameter(parameter_)
+		{};
+
+		static void setParameter(void *object, double value, int, const void*)
+		{
+			*static_cast<float*>(object) = (float)value;
+		}
+
+		void run() override
+		{
+			int counter = 0;
+
+			while (!threadShouldExit())
+			{
+				const double newValue = (double)(counter++ % 100) * 0.01;
+
+				if (queue != nullptr)
+				{
+					// The slow part (eg. recalculating a table) happens without the lock
+					Thread::sleep(2);
+					queue->push(setParameter, &parameter, newValue);
+				}
+				else
+				{
+					ScopedLock sl(lock);
+
+					Thread::sleep(2);
+					setParameter(&parameter, newValue, 0, nullptr);
+				}
+
+				Thread::sleep(1);
+			}
+		}
+
+	private:
+
+		CriticalSection &lock;
+		AudioThreadCommandQueue *queue;
+		float &parameter;
+	};
+
+	double measureWorstCaseCallbackTime(bool useQueue)
+	{
+		CriticalSection lock;
+		AudioThreadCommandQueue queue;
+		float parameter = 0.0f;
+
+		AudioSampleBuffer buffer(2, BlockSize);
+
+		ParameterChanger changer(lock, useQueue ? &queue : nullptr, parameter);
+
+		changer.startThread();
+
+		double worstTime = 0.0;
+		double phase = 0.0;
+
+		for (int block = 0; block < 300; block++)
+		{
+			const double start = Time::getMillisecondCounterHiRes();
+
+			if (useQueue)
+			{
+				queue.drain();
+				renderBlock(buffer, phase, parameter);
+			}
+			else
+			{
+				ScopedLock sl(lock);
+				renderBlock(buffer, phase, parameter);
+			}
+
+			worstTime = jmax<double>(worstTime, Time::getMillisecondCounterHiRes() - start);
+
+			Thread::sleep(1);
+		}
+
+		changer.stopThread(1000);
+
+		return worstTime;
+	}
+
+	static void renderBlock(AudioSampleBuffer &buffer, double &phase, float gain)
+	{
+		float *l = buffer.getWritePointer(0);
+		float *r = buffer.getWritePointer(1);
+
+		for (int i = 0; i < BlockSize; i++)
+		{
+			l[i] = gain * (float)std::sin(phase);
+			r[i] = l[i];
+			phase += 0.01;
+		}
+	}
+
+	void testWorstCaseCallbackTime()
+	{
+		beginTest("Measuring the worst case callback time with a contended lock");
+
+		const double lockTime = measureWorstCaseCallbackTime(false);
+		const double queueTime = measureWorstCaseCallbackTime(true);
+
+		logMessage("Worst case callback with lock: " + String(lockTime, 3) + " ms");
+		logMessage("Worst case callback with command queue: " + String(queueTime, 3) + " ms");
+
+		expect(lockTime > 1.0, "The lock blocks the callback");
+		expect(queueTime < lockTime, "The queue doesn't block the callback");
+	}
+};
+
+static AudioThreadCommandQueueUnitTest audioThreadCommandQueueUnitTest;
@@ -47,7 +47,7 @@ CodeEditorComponent(doc, tok)
 
 Console::Console(BaseDebugArea *area) :
 		AutoPopupDebugComponent(area),
-		overflowProtection(false)
+		clearFlag(false)
 {
 	setName("Console");
 
@@ -273,38 +273,7 @@ void Console::mouseDoubleClick(const MouseEvent& /*e*/)
 	}
 }
 
-void Console::logMessage(const String &t, WarningLevel warningLevel, const Processor *p, Colour c)
-{
-	if(overflowProtection) return;
-
-	else
-	{
-		ScopedLock sl(getLock());
-
-		if(unprintedMessages.size() > 10)
-		{
-			unprintedMessages.push_back(ConsoleMessage(Error, const_cast<Processor*>(p), "Console Overflow"));
-			overflowProtection = true;
-			return;
-		}
-		else
-		{
-			unprintedMessages.push_back(ConsoleMessage(warningLevel, const_cast<Processor*>(p), t));
-		}
-	}
-
-	if (MessageManager::getInstance()->isThisTheMessageThread())
-	{
-		handleAsyncUpdate();
-	}
-	else
-	{
-		triggerAsyncUpdate();
-	}
-};
-
-
-void Console::handleAsyncUpdate()
+void Console::logMessages(const OwnedArray<ConsoleMessageQueue::FormattedMessage> &messages)
 {
 	if (clearFlag)
 	{
@@ -312,31 +281,13 @@ void Console::handleAsyncUpdate()
 		clearFlag = false;
 	}
 
-	std::vector<ConsoleMessage> messagesForThisTime;
-	messagesForThisTime.reserve(10);
-
-	if(unprintedMessages.size() != 0)
-	{
-		ScopedLock sl(getLock());
-		messagesForThisTime.swap(unprintedMessages);
-	}
-	else return;
-
 	String message;
 
-	for(int i = 0; i < messagesForThisTime.size(); i++)
+	for (int i = 0; i < messages.size(); i++)
 	{
-        const Processor* processor = std::get<(int)ConsoleMessageItems::Processor>(messagesForThisTime[i]).get();
-        
-        if(processor == nullptr)
-        {
-            jassertfalse;
-            continue;
-        }
-        
-		message << processor->getId() << ":";
-		message << (std::get<(int)ConsoleMessageItems::WarningLevel>(messagesForThisTime[i]) == WarningLevel::Error ? "! " : " ");
-		message << std::get<(int)ConsoleMessageItems::Message>(messagesForThisTime[i]) << "\n";
+		message << messages[i]->processorId << ":";
+		message << (messages[i]->warningLevel == WarningLevel::Error ? "! " : " ");
+		message << messages[i]->text << "\n";
 	}
 
 	doc->insertText(doc->getNumCharacters(), message);
@@ -344,9 +295,16 @@ void Console::handleAsyncUpdate()
 	int numLinesVisible = jmax<int>(0, doc->getNumLines() - (int)((float)newTextConsole->getHeight() / GLOBAL_MONOSPACE_FONT().getHeight()));
 
 	newTextConsole->scrollToLine(numLinesVisible);
-	overflowProtection = false;
+};
+
 
-	return;
+void Console::handleAsyncUpdate()
+{
+	if (clearFlag)
+	{
+		newTextConsole->getDocument().replaceAllContent("");
+		clearFlag = false;
+	}
 };
 
 Console::ConsoleTokeniser::ConsoleTokeniser()
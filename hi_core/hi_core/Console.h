@@ -76,12 +76,12 @@ public:
 
 	void handleAsyncUpdate();
 
-	/** Adds a new line to the console.
+	/** Adds the messages to the console.
     *
-	*   This can be called in the audio thread. It stores all text in an internal String buffer and writes it periodically
-	*   on the timer callback.
+	*   This must be called on the message thread. Other threads write into the ConsoleMessageQueue of the MainController,
+	*	which calls this method periodically.
 	*/
-	void logMessage(const String &t, WarningLevel warningLevel, const Processor *p, Colour c);
+	void logMessages(const OwnedArray<ConsoleMessageQueue::FormattedMessage> &messages);
 
 private:
 
@@ -114,31 +114,13 @@ private:
 	};
 
 
-	enum class ConsoleMessageItems
-	{
-		WarningLevel = 0,
-		Processor,
-		Message
-	};
-
-	using ConsoleMessage = std::tuple < WarningLevel, const WeakReference<Processor>, String > ;
-
-	const CriticalSection &getLock() const { return lock; }
-
-
-	std::vector<ConsoleMessage> unprintedMessages;
-
 	friend class WeakReference<Console>;
 	WeakReference<Console>::Master masterReference;
-	
-	CriticalSection lock;
 
 	ScopedPointer<CodeDocument> doc;
 	ScopedPointer<ConsoleEditorComponent> newTextConsole;
 	ScopedPointer<CodeTokeniser> tokeniser;
 
-	bool overflowProtection;
-
 	bool clearFlag;
 
 };
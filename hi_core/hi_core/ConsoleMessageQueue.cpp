@@ -0,0 +1,224 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licences for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licencing:
+*
+*   http://www.hartinstruments.net/hise/
+*
+*   HISE is based on the JUCE library,
+*   which also must be licenced for commercial applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+ConsoleMessageQueue::ConsoleMessageQueue(Target *target_, int capacity) :
+	target(target_),
+	pendingMessages(capacity),
+	numDroppedMessages(0),
+	numFilteredMessages(0),
+	numReportedDrops(0),
+	numMutedProcessors(0)
+{
+	for (int i = 0; i < MaxNumMutedProcessors; i++)
+		mutedProcessors[i].store(nullptr);
+
+	if (target != nullptr)
+		startTimer(TimerInterval);
+}
+
+ConsoleMessageQueue::~ConsoleMessageQueue()
+{
+	stopTimer();
+}
+
+bool ConsoleMessageQueue::push(const Processor *p, int warningLevel, const char *format, const var &arg1, const var &arg2, const var &arg3) noexcept
+{
+	if (isProcessorMuted(p))
+	{
+		numFilteredMessages.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	// The caller still holds the arguments, so the copies that are released here never delete anything.
+	PendingMessage m;
+
+	m.format = format;
+	m.warningLevel = warningLevel;
+	m.processorId = p != nullptr ? p->getId() : String();
+	m.setArgument(0, arg1);
+	m.setArgument(1, arg2);
+	m.setArgument(2, arg3);
+
+	// If the message thread is lagging behind, the message is dropped.
+	if (!pendingMessages.push(m, NumPushAttempts))
+	{
+		numDroppedMessages.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	return true;
+}
+
+void ConsoleMessageQueue::popMessages(OwnedArray<FormattedMessage> &messages)
+{
+	// The queue resets the slots when the messages are popped, so the audio thread never deletes a string.
+	PendingMessage m;
+
+	for (int i = 0; i < pendingMessages.getCapacity(); i++)
+	{
+		if (!pendingMessages.pop(m))
+			break;
+
+		var arguments[NumArguments];
+
+		for (int j = 0; j < NumArguments; j++)
+			arguments[j] = m.getArgument(j);
+
+		messages.add(new FormattedMessage(m.processorId, m.warningLevel, formatMessage(m.format, arguments)));
+	}
+
+	const int numDropped = numDroppedMessages.load();
+
+	if (numDropped != numReportedDrops)
+	{
+		messages.add(new FormattedMessage("Console", 1, String(numDropped - numReportedDrops) + " messages were dropped because the console queue was full"));
+		numReportedDrops = numDropped;
+	}
+}
+
+void ConsoleMessageQueue::flush()
+{
+	OwnedArray<FormattedMessage> messages;
+
+	popMessages(messages);
+
+	if (target != nullptr && messages.size() != 0)
+		target->printConsoleMessages(messages);
+}
+
+void ConsoleMessageQueue::setProcessorMuted(const Processor *p, bool shouldBeMuted)
+{
+	if (p == nullptr || shouldBeMuted == isProcessorMuted(p))
+		return;
+
+	for (int i = 0; i < MaxNumMutedProcessors; i++)
+	{
+		if (shouldBeMuted && mutedProcessors[i].load() == nullptr)
+		{
+			mutedProcessors[i].store(p);
+			numMutedProcessors.fetch_add(1);
+			return;
+		}
+		else if (!shouldBeMuted && mutedProcessors[i].load() == p)
+		{
+			mutedProcessors[i].store(nullptr);
+			numMutedProcessors.fetch_sub(1);
+			return;
+		}
+	}
+
+	// You can't mute more processors than that.
+	jassert(!shouldBeMuted);
+}
+
+bool ConsoleMessageQueue::isProcessorMuted(const Processor *p) const noexcept
+{
+	if (p == nullptr || numMutedProcessors.load(std::memory_order_relaxed) == 0)
+		return false;
+
+	for (int i = 0; i < MaxNumMutedProcessors; i++)
+	{
+		if (mutedProcessors[i].load(std::memory_order_relaxed) == p)
+			return true;
+	}
+
+	return false;
+}
+
+void ConsoleMessageQueue::PendingMessage::setArgument(int index, const var &v) noexcept
+{
+	// The text must match var::toString() for these types.
+	if (v.isArray())
+	{
+		referenceTypes[index] = "[Array]";
+		arguments[index] = var();
+	}
+	else if (v.isObject())
+	{
+		referenceTypes[index] = v.isBuffer() ? "Buffer 0x" : "Object 0x";
+		arguments[index] = (int)(pointer_sized_int)v.getObject();
+	}
+	else
+	{
+		referenceTypes[index] = nullptr;
+		arguments[index] = v;
+	}
+}
+
+var ConsoleMessageQueue::PendingMessage::getArgument(int index) const
+{
+	if (referenceTypes[index] == nullptr)
+		return arguments[index];
+
+	if (arguments[index].isVoid())
+		return var(referenceTypes[index]);
+
+	return var(referenceTypes[index] + String::toHexString((int)arguments[index]));
+}
+
+String ConsoleMessageQueue::formatMessage(const char *format, const var *arguments)
+{
+	if (format == nullptr)
+		return arguments[0].toString();
+
+	String text;
+
+	const String formatString = String(CharPointer_UTF8(format));
+
+	String::CharPointerType c = formatString.getCharPointer();
+	String::CharPointerType segmentStart = c;
+
+	while (!c.isEmpty())
+	{
+		if (*c == '%')
+		{
+			const juce_wchar next = *(c + 1);
+			const bool isArgument = next >= '0' && next < '0' + NumArguments;
+
+			if (isArgument || next == '%')
+			{
+				text += String(segmentStart, c);
+				text << (isArgument ? arguments[next - '0'].toString() : "%");
+
+				c += 2;
+				segmentStart = c;
+				continue;
+			}
+		}
+
+		++c;
+	}
+
+	text += String(segmentStart, c);
+
+	return text;
+}
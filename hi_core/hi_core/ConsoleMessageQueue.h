@@ -0,0 +1,173 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licences for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licencing:
+*
+*   http://www.hartinstruments.net/hise/
+*
+*   HISE is based on the JUCE library,
+*   which also must be licenced for commercial applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+#ifndef CONSOLEMESSAGEQUEUE_H_INCLUDED
+#define CONSOLEMESSAGEQUEUE_H_INCLUDED
+
+class Processor;
+
+/** Config: HISE_CONSOLE_QUEUE_SIZE
+
+The number of console messages that can be pending until the message thread picks them up. Further messages are dropped.
+*/
+#ifndef HISE_CONSOLE_QUEUE_SIZE
+#define HISE_CONSOLE_QUEUE_SIZE 1024
+#endif
+
+/** A preallocated queue that passes console messages from any thread to the message thread.
+*
+*	Writing to the console must not block the audio thread, so the producers never lock, allocate or format anything.
+*	A message is a pointer to a format string literal and up to three var arguments. Copying a var (or the ID of the
+*	processor) only increments a reference count, and the conversion to text happens on the message thread, which
+*	also releases the last references. Arrays, objects and buffers are not referenced: the producer can change them
+*	right after the call, so only their type and address are stored, which is all that var::toString() prints.
+*
+*	The queue is a bounded multi-producer ring buffer. If it is full, or a producer loses the race for a slot too often,
+*	the message is dropped and counted, so a tight loop that writes to the console can't stall the audio callback.
+*	A timer drains the queue and passes the formatted messages to the Target.
+*/
+class ConsoleMessageQueue : private Timer
+{
+public:
+
+	enum
+	{
+		NumArguments = 3
+	};
+
+	/** A message that was converted to text by the message thread. */
+	struct FormattedMessage
+	{
+		FormattedMessage() : warningLevel(0) {};
+
+		FormattedMessage(const String &processorId_, int warningLevel_, const String &text_) :
+			processorId(processorId_),
+			warningLevel(warningLevel_),
+			text(text_)
+		{};
+
+		String processorId;
+		int warningLevel;
+		String text;
+	};
+
+	/** Receives the messages on the message thread. */
+	class Target
+	{
+	public:
+
+		virtual ~Target() {};
+
+		virtual void printConsoleMessages(const OwnedArray<FormattedMessage> &messages) = 0;
+	};
+
+	/** Creates a queue with the given capacity (rounded up to a power of two) that drains into the target. */
+	ConsoleMessageQueue(Target *target, int capacity=HISE_CONSOLE_QUEUE_SIZE);
+
+	~ConsoleMessageQueue();
+
+	/** Adds a message to the queue. This can be called from any thread and never blocks.
+	*
+	*	The format must be a string literal (only the pointer is stored). %0, %1 and %2 are replaced with the arguments,
+	*	%% with a percent sign. If the format is nullptr, the first argument is printed as it is.
+	*
+	*	Returns false if the message was dropped or the processor is muted.
+	*/
+	bool push(const Processor *p, int warningLevel, const char *format, const var &arg1=var(), const var &arg2=var(), const var &arg3=var()) noexcept;
+
+	/** Formats all pending messages and sends them to the target. This must be called on the message thread. */
+	void flush();
+
+	/** Formats all pending messages and adds them to the array. This must be called on the message thread. */
+	void popMessages(OwnedArray<FormattedMessage> &messages);
+
+	/** Ignores all messages of the given processor until it is unmuted. This must be called on the message thread. */
+	void setProcessorMuted(const Processor *p, bool shouldBeMuted);
+
+	bool isProcessorMuted(const Processor *p) const noexcept;
+
+	/** Returns the number of messages that were lost because the queue was full. */
+	int getNumDroppedMessages() const noexcept { return numDroppedMessages.load(); }
+
+	/** Returns the number of messages that were skipped because their processor was muted. */
+	int getNumFilteredMessages() const noexcept { return numFilteredMessages.load(); }
+
+	/** Creates the text of the message. */
+	static String formatMessage(const char *format, const var *arguments);
+
+private:
+
+	enum
+	{
+		MaxNumMutedProcessors = 32,
+		NumPushAttempts = 16,
+		TimerInterval = 50
+	};
+
+	struct PendingMessage
+	{
+		PendingMessage() : format(nullptr), warningLevel(0)
+		{
+			for (int i = 0; i < NumArguments; i++)
+				referenceTypes[i] = nullptr;
+		};
+
+		/** Stores the argument or, for arrays, objects and buffers, their type and address. */
+		void setArgument(int index, const var &v) noexcept;
+
+		/** Returns the argument that can be passed to formatMessage(). This must be called on the message thread. */
+		var getArgument(int index) const;
+
+		const char *format;
+		int warningLevel;
+		String processorId;
+		var arguments[NumArguments];
+		const char *referenceTypes[NumArguments];
+	};
+
+	void timerCallback() override { flush(); }
+
+	Target *target;
+
+	MultiProducerQueue<PendingMessage> pendingMessages;
+
+	std::atomic<int> numDroppedMessages;
+	std::atomic<int> numFilteredMessages;
+	int numReportedDrops;
+
+	std::atomic<int> numMutedProcessors;
+	std::atomic<const Processor*> mutedProcessors[MaxNumMutedProcessors];
+
+	JUCE_DECLARE_NON_COPYABLE(ConsoleMessageQueue)
+};
+
+#endif  // CONSOLEMESSAGEQUEUE_H_INCLUDED
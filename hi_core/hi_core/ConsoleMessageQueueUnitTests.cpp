@@ -0,0 +1,265 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licences for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licencing:
+*
+*   http://www.hartinstruments.net/hise/
+*
+*   HISE is based on the JUCE library,
+*   which also must be licenced for commercial applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+
+#include "JuceHeader.h"
+
+class ConsoleMessageQueueUnitTest : public UnitTest
+{
+public:
+
+	ConsoleMessageQueueUnitTest() :
+		UnitTest("Testing the console message queue")
+	{
+
+	}
+
+	void runTest() override
+	{
+		testFormatting();
+		testFullQueue();
+		testReferenceArguments();
+		testMutedProcessors();
+		testConcurrentProducers();
+	}
+
+private:
+
+	enum
+	{
+		NumProducers = 4,
+		NumMessagesPerProducer = 5000
+	};
+
+	class Producer : public Thread
+	{
+	public:
+
+		Producer(ConsoleMessageQueue &queue_, int index_) :
+			Thread("Producer " + String(index_)),
+			queue(queue_),
+			index(index_)
+		{};
+
+		void run() override
+		{
+			for (int i = 0; i < NumMessagesPerProducer; i++)
+			{
+				while (!queue.push(nullptr, 0, "%0 %1", index, i))
+				{
+					if (threadShouldExit())
+						return;
+
+					Thread::sleep(1);
+				}
+			}
+		}
+
+	private:
+
+		ConsoleMessageQueue &queue;
+		const int index;
+	};
+
+	void testFormatting()
+	{
+		beginTest("Testing the formatting");
+
+		var arguments[ConsoleMessageQueue::NumArguments] = { 12, "text", 0.5 };
+
+		expectEquals(ConsoleMessageQueue::formatMessage(nullptr, arguments), String("12"));
+		expectEquals(ConsoleMessageQueue::formatMessage("No arguments", arguments), String("No arguments"));
+		expectEquals(ConsoleMessageQueue::formatMessage("%0: %1 (%2)", arguments), String("12: text (0.5)"));
+		expectEquals(ConsoleMessageQueue::formatMessage("%2%1%0", arguments), String("0.5text12"));
+		expectEquals(ConsoleMessageQueue::formatMessage("100%% %3 %", arguments), String("100% %3 %"));
+	}
+
+	void testFullQueue()
+	{
+		beginTest("Testing a full queue");
+
+		ConsoleMessageQueue queue(nullptr, 6);
+
+		for (int i = 0; i < 8; i++)
+			expect(queue.push(nullptr, 0, nullptr, i), "Push " + String(i));
+
+		expect(!queue.push(nullptr, 0, nullptr, 8), "Full queue drops messages");
+		expect(!queue.push(nullptr, 0, nullptr, 9), "Full queue drops messages");
+		expectEquals(queue.getNumDroppedMessages(), 2);
+
+		OwnedArray<ConsoleMessageQueue::FormattedMessage> messages;
+		queue.popMessages(messages);
+
+		expectEquals(messages.size(), 9, "All messages and the drop notice");
+		expectEquals(messages[0]->text, String("0"));
+		expectEquals(messages[7]->text, String("7"));
+		expectEquals(messages[8]->warningLevel, 1);
+		expect(messages[8]->text.startsWith("2 messages were dropped"), "Drop notice");
+
+		messages.clear();
+
+		expect(queue.push(nullptr, 1, "After %0", "wrapping"), "Push after drain");
+		queue.popMessages(messages);
+
+		expectEquals(messages.size(), 1, "The drops are reported only once");
+		expectEquals(messages[0]->text, String("After wrapping"));
+		expectEquals(messages[0]->warningLevel, 1);
+	}
+
+	void testReferenceArguments()
+	{
+		beginTest("Testing arrays and objects that change after printing");
+
+		ConsoleMessageQueue queue(nullptr, 16);
+
+		Array<var> values;
+		values.add(1);
+		values.add(2);
+
+		var array(values);
+		DynamicObject::Ptr object = new DynamicObject();
+		var objectVar(object.get());
+
+		const String expectedObjectText = objectVar.toString();
+
+		expect(queue.push(nullptr, 0, nullptr, array), "Push array");
+		expect(queue.push(nullptr, 0, "%0 %1", objectVar, array), "Push object");
+
+		expectEquals(object->getReferenceCount(), 2, "The queue doesn't reference the object");
+
+		// Change the array like a script would after printing it.
+		for (int i = 0; i < 1000; i++)
+			array.append(i);
+
+		array.getArray()->clear();
+		array = var();
+		objectVar = var();
+
+		OwnedArray<ConsoleMessageQueue::FormattedMessage> messages;
+		queue.popMessages(messages);
+
+		expectEquals(messages.size(), 2);
+		expectEquals(messages[0]->text, String("[Array]"));
+		expectEquals(messages[1]->text, expectedObjectText + " [Array]");
+	}
+
+	void testMutedProcessors()
+	{
+		beginTest("Testing muted processors");
+
+		ConsoleMessageQueue queue(nullptr, 16);
+
+		// Muted processors are only compared, so any address will do.
+		int dummy[2];
+		const Processor *a = reinterpret_cast<const Processor*>(dummy);
+		const Processor *b = reinterpret_cast<const Processor*>(dummy + 1);
+
+		queue.setProcessorMuted(a, true);
+		queue.setProcessorMuted(b, true);
+
+		expect(queue.isProcessorMuted(a), "a is muted");
+		expect(!queue.push(a, 0, "Ignored"), "Muted message");
+		expectEquals(queue.getNumFilteredMessages(), 1);
+
+		queue.setProcessorMuted(a, false);
+
+		expect(!queue.isProcessorMuted(a), "a is unmuted");
+		expect(queue.isProcessorMuted(b), "b is still muted");
+		expect(!queue.isProcessorMuted(nullptr), "nullptr is never muted");
+
+		OwnedArray<ConsoleMessageQueue::FormattedMessage> messages;
+		queue.popMessages(messages);
+
+		expectEquals(messages.size(), 0, "Nothing was queued");
+		expectEquals(queue.getNumDroppedMessages(), 0);
+	}
+
+	void testConcurrentProducers()
+	{
+		beginTest("Testing concurrent producers");
+
+		ConsoleMessageQueue queue(nullptr, 64);
+
+		OwnedArray<Producer> producers;
+
+		for (int i = 0; i < NumProducers; i++)
+			producers.add(new Producer(queue, i));
+
+		for (int i = 0; i < NumProducers; i++)
+			producers[i]->startThread();
+
+		int lastValues[NumProducers];
+
+		for (int i = 0; i < NumProducers; i++)
+			lastValues[i] = -1;
+
+		const int numExpected = NumProducers * NumMessagesPerProducer;
+		int numReceived = 0;
+		int numOrderErrors = 0;
+
+		OwnedArray<ConsoleMessageQueue::FormattedMessage> messages;
+
+		const double timeout = Time::getMillisecondCounterHiRes() + 20000.0;
+
+		while (numReceived < numExpected && Time::getMillisecondCounterHiRes() < timeout)
+		{
+			messages.clear();
+			queue.popMessages(messages);
+
+			if (messages.size() == 0)
+				Thread::sleep(1);
+
+			for (int i = 0; i < messages.size(); i++)
+			{
+				if (messages[i]->processorId == "Console")
+					continue;
+
+				const int index = messages[i]->text.upToFirstOccurrenceOf(" ", false, false).getIntValue();
+				const int value = messages[i]->text.fromFirstOccurrenceOf(" ", false, false).getIntValue();
+
+				if (value != lastValues[index] + 1)
+					numOrderErrors++;
+
+				lastValues[index] = value;
+				numReceived++;
+			}
+		}
+
+		for (int i = 0; i < NumProducers; i++)
+			producers[i]->stopThread(1000);
+
+		expectEquals(numReceived, numExpected, "All messages received");
+		expectEquals(numOrderErrors, 0, "Messages of a producer keep their order");
+	}
+};
+
+static ConsoleMessageQueueUnitTest consoleMessageQueueUnitTest;
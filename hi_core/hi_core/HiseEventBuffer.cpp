@@ -90,52 +90,92 @@ double HiseEvent::getPitchFactorForEvent() const
 
 HiseEventBuffer::HiseEventBuffer()
 {
-	numUsed = HISE_EVENT_BUFFER_SIZE;
-	clear();
+	// The reserve is allocated by the first call to ensureAllocatedSize(), so only the buffers that are prepared
+	// for the audio thread need the extra memory.
+	buffer.calloc(HISE_EVENT_BUFFER_SIZE);
+	numAllocated = HISE_EVENT_BUFFER_SIZE;
 }
 
 void HiseEventBuffer::clear()
 {
 	if (numUsed != 0)
 	{
-		memset(buffer, 0, numUsed * sizeof(HiseEvent));
+		HiseEvent::clear(buffer, numUsed);
 
 		numUsed = 0;
 	}
 }
 
+void HiseEventBuffer::ensureAllocatedSize(int numEventsToFit)
+{
+	if (numEventsToFit > numAllocated)
+	{
+		HeapBlock<HiseEvent> newBuffer;
+		newBuffer.calloc(numEventsToFit);
+
+		if (numUsed != 0)
+			CopyHelpers::copyEvents(newBuffer, buffer, numUsed);
+
+		buffer.swapWith(newBuffer);
+		numAllocated = numEventsToFit;
+	}
+
+	const int reserveSize = numAllocated * HISE_EVENT_BUFFER_RESERVE_FACTOR;
+
+	if (numReserveAllocated < reserveSize)
+	{
+		reserve.calloc(reserveSize);
+		numReserveAllocated = reserveSize;
+	}
+}
+
+bool HiseEventBuffer::growIntoReserve(int numEventsToFit)
+{
+	if (numEventsToFit > numReserveAllocated)
+		return false;
+
+	CopyHelpers::copyEvents(reserve, buffer, numUsed);
+
+	// The unused slots must be empty, so that the old storage can be used as reserve.
+	HiseEvent::clear(buffer, numUsed);
+
+	buffer.swapWith(reserve);
+	std::swap(numAllocated, numReserveAllocated);
+
+	return true;
+}
+
 void HiseEventBuffer::addEvent(const HiseEvent& hiseEvent)
 {
-	if (numUsed >= HISE_EVENT_BUFFER_SIZE)
+	if (numUsed >= numAllocated && !growIntoReserve(numUsed + 1))
 	{
-		// Buffer full..
-		jassertfalse;
+		numDroppedEvents++;
 		return;
 	}
 
-	if (numUsed == 0)
+	const uint16 messageTimestamp = hiseEvent.getTimeStamp();
+
+	if (numUsed == 0 || buffer[numUsed - 1].getTimeStamp() <= messageTimestamp)
 	{
-		insertEventAtPosition(hiseEvent, 0);
+		insertEventAtPosition(hiseEvent, numUsed);
 		return;
 	}
 
-	jassert(numUsed < HISE_EVENT_BUFFER_SIZE);
+	// Search the first event with a bigger timestamp, so that events with the same timestamp keep their order.
+	int low = 0;
+	int high = numUsed - 1;
 
-    const int numToLookFor = jmin<int>(numUsed, HISE_EVENT_BUFFER_SIZE);
-    
-	for (int i = 0; i < numToLookFor; i++)
+	while (low < high)
 	{
-		const int timestampInBuffer = buffer[i].getTimeStamp();
-		const int messageTimestamp = hiseEvent.getTimeStamp();
+		const int mid = (low + high) / 2;
 
-		if (timestampInBuffer > messageTimestamp)
-		{
-			insertEventAtPosition(hiseEvent, i);
-			return;
-		}
+		if (buffer[mid].getTimeStamp() > messageTimestamp)
+			high = mid;
+		else
+			low = mid + 1;
 	}
 
-	insertEventAtPosition(hiseEvent, numUsed);
+	insertEventAtPosition(hiseEvent, low);
 }
 
 void HiseEventBuffer::addEvent(const MidiMessage& midiMessage, int sampleNumber)
@@ -153,49 +193,89 @@ void HiseEventBuffer::addEvents(const MidiBuffer& otherBuffer)
 	MidiMessage m;
 	int samplePos;
 
-	int index = 0;
-
 	MidiBuffer::Iterator it(otherBuffer);
 
 	while (it.getNextEvent(m, samplePos))
 	{
-		jassert(index < HISE_EVENT_BUFFER_SIZE);
-
 		HiseEvent e(m);
 
 		if (e.isEmpty()) continue;
 
-		e.swapWith(buffer[index]);
+		if (numUsed >= numAllocated && !growIntoReserve(numUsed + 1))
+		{
+			numDroppedEvents++;
+			continue;
+		}
 
-		buffer[index].setTimeStamp((uint16)samplePos);
+		e.swapWith(buffer[numUsed]);
+
+		buffer[numUsed].setTimeStamp((uint16)samplePos);
 
 		numUsed++;
+	}
+}
+
 
-		if (numUsed >= HISE_EVENT_BUFFER_SIZE)
+void HiseEventBuffer::addEvents(const HiseEventBuffer &otherBuffer)
+{
+	jassert(&otherBuffer != this);
+
+	mergeEvents(otherBuffer.buffer, otherBuffer.numUsed);
+}
+
+void HiseEventBuffer::mergeEvents(const HiseEvent* events, int numEvents)
+{
+	if (numEvents == 0) return;
+
+	bool eventsAreSorted = true;
+
+	for (int i = 1; i < numEvents; i++)
+	{
+		if (events[i].getTimeStamp() < events[i - 1].getTimeStamp())
 		{
-			// Buffer full..
-			jassertfalse;
-			return;
+			eventsAreSorted = false;
+			break;
 		}
+	}
 
-		index++;
+	const int numToFit = numUsed + numEvents;
+
+	if (!eventsAreSorted || (numToFit > numAllocated && !growIntoReserve(numToFit)))
+	{
+		// Insert them one by one, which sorts them and counts the events that don't fit anymore.
+		for (int i = 0; i < numEvents; i++)
+			addEvent(events[i]);
+
+		return;
 	}
-}
 
+	if (numUsed == 0 || buffer[numUsed - 1].getTimeStamp() <= events[0].getTimeStamp())
+	{
+		CopyHelpers::copyEvents(buffer + numUsed, events, numEvents);
+		numUsed = numToFit;
+		return;
+	}
 
-void HiseEventBuffer::addEvents(const HiseEventBuffer &otherBuffer)
-{
-	Iterator iter(otherBuffer);
+	// Merge from the back so that every event is only moved once. If the timestamps are equal,
+	// the existing event comes first.
+	int existingIndex = numUsed - 1;
+	int newIndex = numEvents - 1;
+	int targetIndex = numToFit - 1;
 
-	while (HiseEvent* e = iter.getNextEventPointer(false, false))
+	while (newIndex >= 0)
 	{
-		addEvent(*e);
+		if (existingIndex >= 0 && buffer[existingIndex].getTimeStamp() > events[newIndex].getTimeStamp())
+			buffer[targetIndex--] = buffer[existingIndex--];
+		else
+			buffer[targetIndex--] = events[newIndex--];
 	}
+
+	numUsed = numToFit;
 }
 
 HiseEvent HiseEventBuffer::getEvent(int index) const
 {
-	if (index >= 0 && index < HISE_EVENT_BUFFER_SIZE)
+	if (index >= 0 && index < numAllocated)
 	{
 		return buffer[index];
 	}
@@ -217,29 +297,20 @@ void HiseEventBuffer::moveEventsBelow(HiseEventBuffer& targetBuffer, int highest
 {
 	if (numUsed == 0) return;
 
-	HiseEventBuffer::Iterator iter(*this);
+	int numToMove = 0;
 
-	int numCopied = 0;
+	while (numToMove < numUsed && buffer[numToMove].getTimeStamp() < (uint32)highestTimestamp)
+		numToMove++;
 
-	while (HiseEvent* e = iter.getNextEventPointer())
-	{
-		if (e->getTimeStamp() < (uint32)highestTimestamp)
-		{
-			targetBuffer.addEvent(*e);
-			numCopied++;
-		}
-		else
-		{
-			break;
-		}
-	}
+	if (numToMove == 0) return;
 
-	const int numRemaining = numUsed - numCopied;
+	targetBuffer.mergeEvents(buffer, numToMove);
 
-	for (int i = 0; i < numRemaining; i++)
-		buffer[i] = buffer[i + numCopied];
+	const int numRemaining = numUsed - numToMove;
 
-	HiseEvent::clear(buffer + numRemaining, numCopied);
+	std::copy(buffer + numToMove, buffer + numUsed, buffer.getData());
+
+	HiseEvent::clear(buffer + numRemaining, numToMove);
 
 	numUsed = numRemaining;
 }
@@ -262,10 +333,7 @@ void HiseEventBuffer::moveEventsAbove(HiseEventBuffer& targetBuffer, int lowestT
 
 	if (indexOfFirstElementToMove == -1) return;
 
-	for (int i = indexOfFirstElementToMove; i < numUsed; i++)
-	{
-		targetBuffer.addEvent(buffer[i]);
-	}
+	targetBuffer.mergeEvents(buffer + indexOfFirstElementToMove, numUsed - indexOfFirstElementToMove);
 
 	HiseEvent::clear(buffer + indexOfFirstElementToMove, numUsed - indexOfFirstElementToMove);
 
@@ -274,14 +342,26 @@ void HiseEventBuffer::moveEventsAbove(HiseEventBuffer& targetBuffer, int lowestT
 
 void HiseEventBuffer::copyFrom(const HiseEventBuffer& otherBuffer)
 {
-    const int eventsToCopy = jmin<int>(otherBuffer.numUsed, HISE_EVENT_BUFFER_SIZE);
-    
-	memcpy(buffer, otherBuffer.buffer, sizeof(HiseEvent) * eventsToCopy);
-    memset(buffer + eventsToCopy, 0, (HISE_EVENT_BUFFER_SIZE - eventsToCopy) * sizeof(HiseEvent));
+	int eventsToCopy = otherBuffer.numUsed;
+
+	if (eventsToCopy > numAllocated)
+	{
+		if (numReserveAllocated > numAllocated)
+			growIntoReserve(jmin<int>(eventsToCopy, numReserveAllocated));
+
+		if (eventsToCopy > numAllocated)
+		{
+			numDroppedEvents += eventsToCopy - numAllocated;
+			eventsToCopy = numAllocated;
+		}
+	}
     
-	jassert(otherBuffer.numUsed < HISE_EVENT_BUFFER_SIZE);
+	CopyHelpers::copyEvents(buffer, otherBuffer.buffer, eventsToCopy);
 
-	numUsed = otherBuffer.numUsed;
+	if (numUsed > eventsToCopy)
+		HiseEvent::clear(buffer + eventsToCopy, numUsed - eventsToCopy);
+
+	numUsed = eventsToCopy;
 }
 
 
@@ -299,7 +379,7 @@ bool HiseEventBuffer::Iterator::getNextEvent(HiseEvent& b, int &samplePosition,
 		  (skipIgnoredEvents && buffer->buffer[index].isIgnored())))
 	{
 		index++;
-		jassert(index < HISE_EVENT_BUFFER_SIZE);
+		jassert(index < buffer->numAllocated);
 	}
 		
 	if (index < buffer->numUsed)
@@ -330,7 +410,7 @@ const HiseEvent* HiseEventBuffer::Iterator::getNextConstEventPointer(bool skipIg
 		  (skipIgnoredEvents && buffer->buffer[index].isIgnored())))
 	{
 		index++;
-		jassert(index < HISE_EVENT_BUFFER_SIZE);
+		jassert(index < buffer->numAllocated);
 	}
 
 	if (index < buffer->numUsed)
@@ -346,32 +426,102 @@ const HiseEvent* HiseEventBuffer::Iterator::getNextConstEventPointer(bool skipIg
 
 void HiseEventBuffer::insertEventAtPosition(const HiseEvent& e, int positionInBuffer)
 {
-	if (numUsed == 0)
+	jassert(numUsed < numAllocated);
+	jassert(positionInBuffer <= numUsed);
+
+	if (numUsed > positionInBuffer)
 	{
-		buffer[0] = HiseEvent(e);
+		std::copy_backward(buffer + positionInBuffer, buffer + numUsed, buffer + numUsed + 1);
+	}
 
-		numUsed = 1;
+	buffer[positionInBuffer] = HiseEvent(e);
+	numUsed++;
+}
+
+HiseEventScheduler::HiseEventScheduler(int numEventsToAllocate) :
+	numAllocated(numEventsToAllocate)
+{
+	heap.calloc(numAllocated);
+}
 
+void HiseEventScheduler::addEvent(const HiseEvent& e, int64 samplesFromBlockStart)
+{
+	if (numUsed >= numAllocated)
+	{
+		numDroppedEvents++;
 		return;
 	}
 
-	if (numUsed > positionInBuffer)
+	ScheduledEvent newEvent;
+	newEvent.time = currentTime + samplesFromBlockStart;
+	newEvent.sequenceNumber = nextSequenceNumber++;
+	newEvent.e = e;
+
+	// Sift up
+	int index = numUsed++;
+
+	while (index > 0)
 	{
-		for (int i = jmin<int>(numUsed-1, HISE_EVENT_BUFFER_SIZE-2); i >= positionInBuffer; i--)
-		{
-			jassert(i + 1 < HISE_EVENT_BUFFER_SIZE);
+		const int parent = (index - 1) / 2;
 
-			buffer[i + 1] = buffer[i];
-		}
+		if (!isEarlier(newEvent, heap[parent]))
+			break;
+
+		heap[index] = heap[parent];
+		index = parent;
+	}
+
+	heap[index] = newEvent;
+}
+
+void HiseEventScheduler::moveDueEvents(HiseEventBuffer& targetBuffer, int numSamples)
+{
+	const int64 blockEnd = currentTime + numSamples;
+
+	while (numUsed > 0 && heap[0].time < blockEnd)
+	{
+		HiseEvent e(heap[0].e);
+
+		// Events that were scheduled in the past (eg. with a timestamp that was already processed) are played at the block start.
+		e.setTimeStamp((uint16)jmax<int64>(0, heap[0].time - currentTime));
+
+		targetBuffer.addEvent(e);
+
+		removeFirst();
+	}
+}
+
+void HiseEventScheduler::clear()
+{
+	numUsed = 0;
+}
+
+void HiseEventScheduler::removeFirst()
+{
+	jassert(numUsed > 0);
+
+	const ScheduledEvent last = heap[--numUsed];
+
+	// Sift the last element down from the root
+	int index = 0;
+
+	for (;;)
+	{
+		int child = 2 * index + 1;
+
+		if (child >= numUsed)
+			break;
+
+		if (child + 1 < numUsed && isEarlier(heap[child + 1], heap[child]))
+			child++;
+
+		if (!isEarlier(heap[child], last))
+			break;
+
+		heap[index] = heap[child];
+		index = child;
 	}
 
-    if(positionInBuffer < HISE_EVENT_BUFFER_SIZE)
-    {
-        buffer[positionInBuffer] = HiseEvent(e);
-        numUsed++;
-    }
-    else
-    {
-        jassertfalse;
-    }
+	if (numUsed > 0)
+		heap[index] = last;
 }
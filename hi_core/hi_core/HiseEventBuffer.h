@@ -351,8 +351,24 @@ private:
 	
 };
 
+/** The number of events that a HiseEventBuffer can hold before it needs to grow into its reserve. */
 #define HISE_EVENT_BUFFER_SIZE 256
 
+/** The size of the reserve storage relative to the size of a HiseEventBuffer. */
+#define HISE_EVENT_BUFFER_RESERVE_FACTOR 4
+
+/** The number of events that a HiseEventScheduler can hold. */
+#ifndef HISE_EVENT_SCHEDULER_SIZE
+#define HISE_EVENT_SCHEDULER_SIZE 4096
+#endif
+
+/** A buffer of HiseEvents sorted by their timestamp.
+*
+*	The storage for HISE_EVENT_BUFFER_SIZE events is preallocated. Buffers that are used on the audio thread call
+*	ensureAllocatedSize() in prepareToPlay(), which also allocates a reserve storage that is HISE_EVENT_BUFFER_RESERVE_FACTOR
+*	times bigger. If the buffer runs full, it switches to the reserve (this doesn't allocate). If there is no reserve or
+*	it is also full, the event is dropped and counted in getNumDroppedEvents().
+*/
 class HiseEventBuffer
 {
 public:
@@ -490,6 +506,20 @@ public:
 	bool isEmpty() const noexcept{ return numUsed == 0; };
 	int getNumUsed() const { return numUsed; }
 
+	/** Returns the number of events that fit into the buffer without growing into the reserve. */
+	int getNumAllocated() const noexcept { return numAllocated; }
+
+	/** Returns the number of events that were dropped since the last call to resetDroppedEventCounter() because the buffer was full. */
+	int getNumDroppedEvents() const noexcept { return numDroppedEvents; }
+
+	void resetDroppedEventCounter() noexcept { numDroppedEvents = 0; }
+
+	/** Makes sure that the given amount of events fits into the buffer and allocates the reserve for growing on the audio thread.
+	*
+	*	This allocates, so only call it when the buffer isn't used by the audio thread (eg. in prepareToPlay()).
+	*/
+	void ensureAllocatedSize(int numEventsToFit);
+
 	HiseEvent getEvent(int index) const;
 
 	void subtractFromTimeStamps(int delta);
@@ -502,6 +532,7 @@ public:
 	void addEvent(const MidiMessage& midiMessage, int sampleNumber);
 	void addEvents(const MidiBuffer& otherBuffer);
 
+	/** Merges the (sorted) events of the other buffer into this buffer. */
 	void addEvents(const HiseEventBuffer &otherBuffer);
 
 	
@@ -551,13 +582,87 @@ private:
 
 	friend class Iterator;
 
+	/** Switches to the reserve storage if it can hold the given number of events. This doesn't allocate. */
+	bool growIntoReserve(int numEventsToFit);
+
+	/** Merges a sorted array of events that doesn't belong to this buffer. */
+	void mergeEvents(const HiseEvent* events, int numEvents);
+
 	void insertEventAtPosition(const HiseEvent& e, int positionInBuffer);
 
-	HiseEvent buffer[HISE_EVENT_BUFFER_SIZE];
+	HeapBlock<HiseEvent> buffer;
+	HeapBlock<HiseEvent> reserve;
+
+	int numAllocated = 0;
+	int numReserveAllocated = 0;
 
 	int numUsed = 0;
 
-	
+	int numDroppedEvents = 0;
+
+	JUCE_DECLARE_NON_COPYABLE(HiseEventBuffer)
+};
+
+/** A queue for events that are scheduled beyond the current buffer.
+*
+*	The events are stored in a binary min-heap that is ordered by a 64 bit sample time, so they can be scheduled any
+*	amount of time ahead and the work per block only touches the events that are due. Events with the same time
+*	keep the order in which they were added. The storage is preallocated. If the queue is full, the event is dropped
+*	and counted in getNumDroppedEvents().
+*/
+class HiseEventScheduler
+{
+public:
+
+	HiseEventScheduler(int numEventsToAllocate = HISE_EVENT_SCHEDULER_SIZE);
+
+	/** Schedules the event at the given offset from the start of the current block. The timestamp of the event is ignored. */
+	void addEvent(const HiseEvent& e, int64 samplesFromBlockStart);
+
+	/** Moves all events that are due in the current block into the buffer and sets their timestamps relative to the block start. */
+	void moveDueEvents(HiseEventBuffer& targetBuffer, int numSamples);
+
+	/** Advances the time to the start of the next block. Call this after the current block is processed. */
+	void advance(int numSamples) noexcept { currentTime += numSamples; }
+
+	void clear();
+
+	bool isEmpty() const noexcept { return numUsed == 0; }
+
+	int getNumScheduledEvents() const noexcept { return numUsed; }
+
+	/** Returns the number of events that were dropped because the queue was full. */
+	int getNumDroppedEvents() const noexcept { return numDroppedEvents; }
+
+	/** Returns the sample time of the start of the current block. */
+	int64 getCurrentTime() const noexcept { return currentTime; }
+
+private:
+
+	struct ScheduledEvent
+	{
+		int64 time;
+		uint64 sequenceNumber;
+		HiseEvent e;
+	};
+
+	static bool isEarlier(const ScheduledEvent& a, const ScheduledEvent& b) noexcept
+	{
+		return a.time < b.time || (a.time == b.time && a.sequenceNumber < b.sequenceNumber);
+	}
+
+	void removeFirst();
+
+	HeapBlock<ScheduledEvent> heap;
+
+	int numAllocated;
+	int numUsed = 0;
+	int numDroppedEvents = 0;
+
+	int64 currentTime = 0;
+	uint64 nextSequenceNumber = 0;
+
+	JUCE_DECLARE_NON_COPYABLE(HiseEventScheduler)
 };
 
 
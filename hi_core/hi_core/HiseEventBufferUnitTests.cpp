@@ -56,6 +56,11 @@ public:
 		testEventBufferMoveOperations();
 		testEventHandler();
 		testEventBufferStack();
+		testEventBufferGrowth();
+		testEventBufferMerge();
+		testEventBufferSpeed();
+		testEventScheduler();
+		testEventSchedulerSpeed();
 		
 	}
 
@@ -648,6 +653,276 @@ private:
 		}
 	}
 
+	void testEventBufferGrowth()
+	{
+		beginTest("Testing HiseEventBuffer growth and overflow");
+
+		HiseEventBuffer b;
+
+		for (int i = 0; i < HISE_EVENT_BUFFER_SIZE + 10; i++)
+			b.addEvent(generateRandomHiseEvent());
+
+		expectEquals<int>(b.getNumUsed(), HISE_EVENT_BUFFER_SIZE, "No reserve before ensureAllocatedSize()");
+		expectEquals<int>(b.getNumDroppedEvents(), 10, "Dropped events without reserve");
+
+		b.clear();
+		b.resetDroppedEventCounter();
+
+		// This is what prepareToPlay() does
+		b.ensureAllocatedSize(b.getNumAllocated());
+
+		const int numReserved = HISE_EVENT_BUFFER_SIZE * HISE_EVENT_BUFFER_RESERVE_FACTOR;
+
+		for (int i = 0; i < numReserved; i++)
+			b.addEvent(generateRandomHiseEvent());
+
+		expectEquals<int>(b.getNumUsed(), numReserved, "Grows into the reserve");
+		expectEquals<int>(b.getNumDroppedEvents(), 0, "No dropped events");
+		expect(isSorted(b), "Sorted after growing");
+
+		for (int i = 0; i < 100; i++)
+			b.addEvent(generateRandomHiseEvent());
+
+		expectEquals<int>(b.getNumUsed(), numReserved, "Full buffer");
+		expectEquals<int>(b.getNumDroppedEvents(), 100, "Dropped events are counted");
+
+		b.resetDroppedEventCounter();
+		b.ensureAllocatedSize(numReserved + 100);
+
+		for (int i = 0; i < 100; i++)
+			b.addEvent(generateRandomHiseEvent());
+
+		expectEquals<int>(b.getNumUsed(), numReserved + 100, "Fits after ensureAllocatedSize()");
+		expectEquals<int>(b.getNumDroppedEvents(), 0, "No dropped events after ensureAllocatedSize()");
+
+		HiseEventBuffer small;
+
+		small.ensureAllocatedSize(small.getNumAllocated());
+		small.copyFrom(b);
+
+		expectEquals<int>(small.getNumUsed(), numReserved, "Copy grows into the reserve");
+		expectEquals<int>(small.getNumDroppedEvents(), 100, "Dropped events of copyFrom()");
+		expect(small.getEvent(0) == b.getEvent(0), "Copied events");
+	}
+
+	void testEventBufferMerge()
+	{
+		beginTest("Stress testing HiseEventBuffer merging");
+
+		for (int run = 0; run < 200; run++)
+		{
+			HiseEventBuffer b1;
+			HiseEventBuffer b2;
+
+			// The merged events might not fit into the preallocated size
+			b1.ensureAllocatedSize(b1.getNumAllocated());
+
+			Array<HiseEvent> expected;
+
+			const int numFirst = r.nextInt(HISE_EVENT_BUFFER_SIZE);
+			const int numSecond = r.nextInt(HISE_EVENT_BUFFER_SIZE);
+
+			for (int i = 0; i < numFirst; i++)
+				b1.addEvent(generateRandomHiseEvent());
+
+			for (int i = 0; i < numSecond; i++)
+				b2.addEvent(generateRandomHiseEvent());
+
+			HiseEventBuffer::Iterator iter1(b1);
+
+			while (const HiseEvent* e = iter1.getNextConstEventPointer())
+				expected.add(*e);
+
+			HiseEventBuffer::Iterator iter2(b2);
+
+			while (const HiseEvent* e = iter2.getNextConstEventPointer())
+				expected.add(*e);
+
+			// A stable sort of the concatenation is what the merge must produce
+			std::stable_sort(expected.begin(), expected.end(), [](const HiseEvent& a, const HiseEvent& b)
+			{
+				return a.getTimeStamp() < b.getTimeStamp();
+			});
+
+			b1.addEvents(b2);
+
+			expectEquals<int>(b1.getNumUsed(), expected.size(), "Merged size");
+
+			bool equal = true;
+
+			for (int i = 0; i < expected.size(); i++)
+				equal &= b1.getEvent(i) == expected[i];
+
+			expect(equal, "Merged order in run " + String(run));
+		}
+	}
+
+	void testEventBufferSpeed()
+	{
+		beginTest("Measuring HiseEventBuffer insertion");
+
+		const int numEvents = 200;
+		const int numRuns = 2000;
+
+		Array<HiseEvent> events;
+
+		for (int i = 0; i < numEvents; i++)
+			events.add(generateRandomHiseEvent());
+
+		HiseEventBuffer source;
+
+		for (int i = 0; i < numEvents; i++)
+			source.addEvent(events[i]);
+
+		HiseEventBuffer b;
+
+		double start = Time::getMillisecondCounterHiRes();
+
+		for (int run = 0; run < numRuns; run++)
+		{
+			b.clear();
+
+			for (int i = 0; i < numEvents; i++)
+				b.addEvent(events[i]);
+		}
+
+		const double insertTime = Time::getMillisecondCounterHiRes() - start;
+
+		start = Time::getMillisecondCounterHiRes();
+
+		for (int run = 0; run < numRuns; run++)
+		{
+			b.clear();
+			b.addEvents(source);
+			b.addEvents(source);
+		}
+
+		const double mergeTime = Time::getMillisecondCounterHiRes() - start;
+
+		logMessage("Inserting " + String(numEvents) + " unsorted events: " + String(1000.0 * insertTime / (double)numRuns, 2) + " us");
+		logMessage("Merging two sorted buffers with " + String(numEvents) + " events: " + String(1000.0 * mergeTime / (double)numRuns, 2) + " us");
+	}
+
+	void testEventScheduler()
+	{
+		beginTest("Testing HiseEventScheduler");
+
+		const int numEvents = 5000;
+		const int blockSize = 512;
+		const int64 maxTime = 441000; // 10 seconds
+
+		HiseEventScheduler scheduler(numEvents);
+
+		Array<int64> scheduledTimes;
+
+		for (int i = 0; i < numEvents; i++)
+		{
+			// Use a coarse grid so that there are events with the same time.
+			const int64 time = (int64)r.nextInt((int)(maxTime / 64)) * 64;
+
+			HiseEvent e(HiseEvent::Type::NoteOn, 64, 64, 1);
+			e.setEventId((uint16)i);
+
+			scheduler.addEvent(e, time);
+			scheduledTimes.add(time);
+		}
+
+		expectEquals<int>(scheduler.getNumScheduledEvents(), numEvents, "All events scheduled");
+
+		HiseEventBuffer b;
+		b.ensureAllocatedSize(numEvents);
+
+		int numDelivered = 0;
+		bool correctTime = true;
+		bool correctOrder = true;
+
+		int64 lastTime = -1;
+		int lastIndex = -1;
+
+		while (!scheduler.isEmpty())
+		{
+			const int64 blockStart = scheduler.getCurrentTime();
+
+			b.clear();
+			scheduler.moveDueEvents(b, blockSize);
+
+			HiseEventBuffer::Iterator iter(b);
+
+			while (const HiseEvent* e = iter.getNextConstEventPointer())
+			{
+				const int index = (int)e->getEventId();
+				const int64 time = blockStart + (int64)e->getTimeStamp();
+
+				correctTime &= (int)e->getTimeStamp() < blockSize && time == scheduledTimes[index];
+				correctOrder &= time > lastTime || (time == lastTime && index > lastIndex);
+
+				lastTime = time;
+				lastIndex = index;
+				numDelivered++;
+			}
+
+			scheduler.advance(blockSize);
+		}
+
+		expectEquals<int>(numDelivered, numEvents, "All events delivered");
+		expect(correctTime, "Events are delivered at their time");
+		expect(correctOrder, "Events are delivered in order");
+
+		HiseEventScheduler small(16);
+
+		for (int i = 0; i < 20; i++)
+			small.addEvent(generateRandomHiseEvent(), 100000);
+
+		expectEquals<int>(small.getNumScheduledEvents(), 16, "Full scheduler");
+		expectEquals<int>(small.getNumDroppedEvents(), 4, "Dropped events are counted");
+	}
+
+	void testEventSchedulerSpeed()
+	{
+		beginTest("Measuring HiseEventScheduler with 4000 pending events");
+
+		const int numEvents = 4000;
+		const int blockSize = 512;
+
+		HiseEventScheduler scheduler(numEvents);
+		HiseEventBuffer b;
+
+		for (int i = 0; i < numEvents; i++)
+			scheduler.addEvent(generateRandomHiseEvent(), r.nextInt(441000));
+
+		int numBlocks = 0;
+		double maxBlockTime = 0.0;
+
+		const double start = Time::getMillisecondCounterHiRes();
+
+		while (!scheduler.isEmpty())
+		{
+			const double blockStart = Time::getMillisecondCounterHiRes();
+
+			b.clear();
+			scheduler.moveDueEvents(b, blockSize);
+			scheduler.advance(blockSize);
+
+			maxBlockTime = jmax(maxBlockTime, Time::getMillisecondCounterHiRes() - blockStart);
+			numBlocks++;
+		}
+
+		const double totalTime = Time::getMillisecondCounterHiRes() - start;
+
+		logMessage(String(numBlocks) + " blocks: " + String(1000.0 * totalTime / (double)numBlocks, 2) + " us average, " + String(1000.0 * maxBlockTime, 2) + " us worst block");
+	}
+
+	bool isSorted(const HiseEventBuffer& b)
+	{
+		for (int i = 1; i < b.getNumUsed(); i++)
+		{
+			if (b.getEvent(i).getTimeStamp() < b.getEvent(i - 1).getTimeStamp())
+				return false;
+		}
+
+		return true;
+	}
+
 	HiseEvent generateRandomHiseEvent(HiseEvent::Type t = HiseEvent::Type::numTypes)
 	{
 		if (t == HiseEvent::Type::numTypes)
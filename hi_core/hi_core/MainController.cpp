@@ -32,6 +32,7 @@
 
 MainController::MainController():
 	sampleManager(new SampleManager(this)),
+	consoleMessages(this),
 	allNotesOffFlag(false),
 	bufferSize(-1),
 	sampleRate(-1.0),
@@ -42,7 +43,6 @@ MainController::MainController():
 	voiceAmount(0),
 	scrollY(0),
 	mainLookAndFeel(new KnobLookAndFeel()),
-	mainCommandManager(new ApplicationCommandManager()),
 	shownComponents(0),
 	plotter(nullptr),
 	usagePercent(0),
@@ -108,6 +108,18 @@ const CriticalSection & MainController::getLock() const
 	return dynamic_cast<AudioProcessor*>(const_cast<MainController*>(this))->getCallbackLock();
 }
 
+void MainController::callOnAudioThread(AudioThreadCommandQueue::Function f, void *object, double value, int index, const void *key)
+{
+	if (!audioThreadCommands.push(f, object, value, index, key))
+	{
+		ScopedLock sl(getLock());
+
+		// Execute the older commands first so that they don't overwrite this change
+		audioThreadCommands.drain();
+		f(object, value, index, key);
+	}
+}
+
 void MainController::loadPreset(const File &f, Component *mainEditor)
 {
 	clearPreset();
@@ -414,7 +426,9 @@ void MainController::storePlayheadIntoDynamicObject(AudioPlayHead::CurrentPositi
 
 void MainController::processBlockCommon(AudioSampleBuffer &buffer, MidiBuffer &midiMessages)
 {
-    ADD_GLITCH_DETECTOR("MainRoutine");
+    ADD_GLITCH_DETECTOR(nullptr, "MainRoutine");
+
+	ProcessorProfiler::ScopedBlock profiledBlock(processorProfiler);
     
 	ScopedNoDenormals snd;
     
@@ -424,7 +438,7 @@ void MainController::processBlockCommon(AudioSampleBuffer &buffer, MidiBuffer &m
 
 	if (buffer.getNumSamples() != bufferSize.get())
 	{
-		debugError(synthChain, "Block size mismatch (old: " + String(bufferSize.get()) + ", new: " + String(buffer.getNumSamples()));
+		writeFormattedToConsole("Block size mismatch (old: %0, new: %1)", 1, synthChain, bufferSize.get(), buffer.getNumSamples());
 		prepareToPlay(sampleRate, buffer.getNumSamples());
 	}
 
@@ -473,6 +487,14 @@ void MainController::processBlockCommon(AudioSampleBuffer &buffer, MidiBuffer &m
 	handleControllersForMacroKnobs(midiMessages);
 #endif
 
+	if (!audioThreadCommands.isEmpty())
+	{
+		// The host already holds this lock during the callback, so this will never wait.
+		ScopedLock sl(getLock());
+
+		audioThreadCommands.drain();
+	}
+
 	
 #if FRONTEND_IS_PLUGIN
 
@@ -538,6 +560,10 @@ void MainController::prepareToPlay(double sampleRate_, int samplesPerBlock)
 #endif
     
 	multiChannelBuffer.setSize(getMainSynthChain()->getMatrix().getNumDestinationChannels(), samplesPerBlock);
+
+	// Refill the reserve if the buffer has grown on the audio thread
+	masterEventBuffer.ensureAllocatedSize(masterEventBuffer.getNumAllocated());
+
     getMainSynthChain()->prepareToPlay(sampleRate, samplesPerBlock);
 }
 
@@ -688,19 +714,38 @@ bool MainController::checkAndResetMidiInputFlag()
 	return returnValue;
 }
 
-#if USE_BACKEND
-
 void MainController::writeToConsole(const String &message, int warningLevel, const Processor *p, Colour c)
 {
-	CHECK_KEY(this);
+	ignoreUnused(c);
 
-	Console *currentConsole = usePopupConsole ? popupConsole.get() : console.get();
+	consoleMessages.push(p, warningLevel, nullptr, message);
+}
 
-	if (currentConsole != nullptr) currentConsole->logMessage(message, (Console::WarningLevel)warningLevel, p, (p != nullptr && c.isTransparent()) ? p->getColour() : c);
+void MainController::writeFormattedToConsole(const char *format, int warningLevel, const Processor *p, const var &arg1, const var &arg2, const var &arg3)
+{
+#if ENABLE_CONSOLE_OUTPUT
+	consoleMessages.push(p, warningLevel, format, arg1, arg2, arg3);
+#else
+	ignoreUnused(format, warningLevel, p, arg1, arg2, arg3);
+#endif
+}
 
+void MainController::printConsoleMessages(const OwnedArray<ConsoleMessageQueue::FormattedMessage> &messages)
+{
+#if USE_BACKEND
+	Console *currentConsole = usePopupConsole ? popupConsole.get() : console.get();
 
+	if (currentConsole != nullptr) currentConsole->logMessages(messages);
+#else
+	for (int i = 0; i < messages.size(); i++)
+	{
+		Logger::outputDebugString(messages[i]->processorId + ":" + (messages[i]->warningLevel != 0 ? "! " : " ") + messages[i]->text);
+	}
+#endif
 }
 
+#if USE_BACKEND
+
 void MainController::setWatchedScriptProcessor(JavascriptProcessor *p, Component *editor)
 {
 	if (scriptWatchTable.getComponent() != nullptr)
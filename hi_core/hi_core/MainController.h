@@ -40,7 +40,8 @@
 *
 */
 class MainController: public GlobalScriptCompileBroadcaster,
-					  public ThreadWithQuasiModalProgressWindow::Holder
+					  public ThreadWithQuasiModalProgressWindow::Holder,
+					  public ConsoleMessageQueue::Target
 {
 public:
 
@@ -255,10 +256,18 @@ public:
 	AutoSaver &getAutoSaver() { return autoSaver; }
 	const AutoSaver &getAutoSaver() const { return autoSaver; }
 
-#if USE_BACKEND
-	/** Writes to the console. */
+	/** Writes to the console. This can be called from any thread and never blocks. */
 	void writeToConsole(const String &message, int warningLevel, const Processor *p=nullptr, Colour c=Colours::transparentBlack);
-#endif
+
+	/** Writes to the console without creating the text on the calling thread.
+	*
+	*	Use this in the audio callback: the format must be a string literal and %0, %1 and %2 are replaced by the
+	*	arguments on the message thread (see ConsoleMessageQueue::push()).
+	*/
+	void writeFormattedToConsole(const char *format, int warningLevel, const Processor *p, const var &arg1=var(), const var &arg2=var(), const var &arg3=var());
+
+	/** Prints the messages from the console queue into the current console. */
+	void printConsoleMessages(const OwnedArray<ConsoleMessageQueue::FormattedMessage> &messages) override;
 
 	void loadPreset(const File &f, Component *mainEditor=nullptr);
 	void loadPreset(ValueTree &v, Component *mainEditor=nullptr);
@@ -298,6 +307,24 @@ public:
 	/** Returns the uptime in seconds. */
 	double getUptime() const noexcept { return uptime; }
 
+	/** Returns a seed for the random generator of a modulator.
+	*
+	*	The seeds are drawn from a generator that belongs to this instance, so a render with a fixed seed doesn't depend
+	*	on the random numbers that other instances use.
+	*/
+	int64 getNextRandomSeed() noexcept
+	{
+		SpinLock::ScopedLockType sl(seedLock);
+		return seedGenerator.nextInt64();
+	}
+
+	/** Sets the seed of the generator that creates the seeds for the random modulators. This is used for deterministic renders. */
+	void setRandomSeed(int64 newSeed) noexcept
+	{
+		SpinLock::ScopedLockType sl(seedLock);
+		seedGenerator.setSeed(newSeed);
+	}
+
 	/** returns the tempo as bpm. */
 	double getBpm() const noexcept { return bpm.get() > 0.0 ? bpm.get() : 120.0; };
 
@@ -310,9 +337,32 @@ public:
 	/** removes a TempoListener. */
 	void removeTempoListener(TempoListener *t);;
 
-	ApplicationCommandManager *getCommandManager() { return mainCommandManager; };
+	/** Returns the command manager. It is created when it's needed the first time, because it requires a display. */
+	ApplicationCommandManager *getCommandManager()
+	{
+		if (mainCommandManager == nullptr)
+			mainCommandManager = new ApplicationCommandManager();
+
+		return mainCommandManager;
+	};
 
     const CriticalSection &getLock() const;
+
+	/** Returns the queue that passes parameter changes to the audio thread. */
+	AudioThreadCommandQueue &getAudioThreadCommandQueue() { return audioThreadCommands; }
+
+	/** Returns the profiler that measures the render time of every processor. */
+	ProcessorProfiler &getProcessorProfiler() noexcept { return processorProfiler; }
+
+	/** Returns the queue that passes the console messages to the message thread. */
+	ConsoleMessageQueue &getConsoleMessageQueue() noexcept { return consoleMessages; }
+
+	/** Executes the function on the audio thread before the next block is rendered.
+	*
+	*	Use this instead of acquiring the lock for changes that must not happen while a block is rendered. If the
+	*	queue is full, the pending commands and the function are executed right away while holding the lock.
+	*/
+	void callOnAudioThread(AudioThreadCommandQueue::Function f, void *object, double value=0.0, int index=0, const void *key=nullptr);
     
     
     
@@ -573,6 +623,12 @@ private:
 
 	Atomic<int> presetLoadRampFlag;
 
+	AudioThreadCommandQueue audioThreadCommands;
+
+	ProcessorProfiler processorProfiler;
+
+	ConsoleMessageQueue consoleMessages;
+
 	AudioPlayHead::CurrentPositionInfo lastPosInfo;
 	
 	ScopedPointer<ApplicationCommandManager> mainCommandManager;
@@ -607,6 +663,9 @@ private:
 
 	Array<WeakReference<TempoListener>> tempoListeners;
 
+	SpinLock seedLock;
+	Random seedGenerator;
+
 	Atomic<int> usagePercent;
 
 	bool enablePluginParameterUpdate;
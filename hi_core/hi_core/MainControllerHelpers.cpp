@@ -126,20 +126,26 @@ void MidiControllerAutomationHandler::clear()
 
 void MidiControllerAutomationHandler::removeMidiControlledParameter(Processor *interfaceProcessor, int attributeIndex)
 {
-	ScopedLock sl(mc->getLock());
+	const int ccNumber = getMidiControllerNumber(interfaceProcessor, attributeIndex);
 
-	for (int i = 0; i < 128; i++)
+	if (ccNumber != -1)
 	{
-		AutomationData *a = automationData + i;
-
-		if (a->processor == interfaceProcessor && a->attribute == attributeIndex)
-		{
-			*a = AutomationData();
-			break;
-		}
+		mc->callOnAudioThread(removeControllerAssignment, this, (double)attributeIndex, ccNumber, interfaceProcessor);
 	}
+}
 
-	refreshAnyUsedState();
+void MidiControllerAutomationHandler::removeControllerAssignment(void *handler, double attributeIndex, int ccNumber, const void *interfaceProcessor)
+{
+	MidiControllerAutomationHandler *h = static_cast<MidiControllerAutomationHandler*>(handler);
+
+	AutomationData *a = h->automationData + ccNumber;
+
+	// The CC might have been assigned to another parameter since the command was pushed.
+	if (a->processor.get() == interfaceProcessor && a->attribute == (int)attributeIndex)
+	{
+		*a = AutomationData();
+		h->refreshAnyUsedState();
+	}
 }
 
 MidiControllerAutomationHandler::AutomationData::AutomationData() :
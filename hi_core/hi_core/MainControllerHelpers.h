@@ -111,6 +111,8 @@ public:
 	MidiControllerAutomationHandler(MainController *mc_);
 
 	void addMidiControlledParameter(Processor *interfaceProcessor, int attributeIndex, NormalisableRange<double> parameterRange, int macroIndex);
+
+	/** Removes the CC assignment of the given parameter. The change is applied on the audio thread at the start of the next block. */
 	void removeMidiControlledParameter(Processor *interfaceProcessor, int attributeIndex);
 
 	bool isLearningActive() const;
@@ -144,6 +146,9 @@ public:
 
 private:
 
+	/** Clears the assignment of the CC number if it still belongs to the parameter. This is executed on the audio thread. */
+	static void removeControllerAssignment(void *handler, double attributeIndex, int ccNumber, const void *interfaceProcessor);
+
 	// ========================================================================================================
 
 	CriticalSection lock;
@@ -0,0 +1,174 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licences for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licencing:
+*
+*   http://www.hartinstruments.net/hise/
+*
+*   HISE is based on the JUCE library,
+*   which also must be licenced for commercial applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+#ifndef MULTIPRODUCERQUEUE_H_INCLUDED
+#define MULTIPRODUCERQUEUE_H_INCLUDED
+
+/** A bounded lock-free queue with multiple producers and a single consumer.
+*
+*	Every slot has a sequence number that tells the producers and the consumer in which round the slot can be written
+*	or read, so the producers claim a slot with a single compare and swap and never lock. The elements are constructed
+*	when the queue is created and stay in their slots: push() assigns the new element and pop() copies it and resets
+*	the slot to a default constructed element, so the consumer releases the resources of an element (eg. the last
+*	reference of a String) and not the producer.
+*
+*	Only one thread must call pop() or forEachPending() at a time.
+*/
+template <class ElementType> class MultiProducerQueue
+{
+public:
+
+	/** Creates a queue. The capacity will be rounded up to the next power of two. */
+	MultiProducerQueue(int capacity) :
+		mask((size_t)nextPowerOfTwo(jmax<int>(2, capacity)) - 1),
+		enqueuePosition(0),
+		dequeuePosition(0)
+	{
+		cells.malloc(mask + 1);
+
+		for (size_t i = 0; i <= mask; i++)
+		{
+			new (cells + i) Cell();
+			cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	~MultiProducerQueue()
+	{
+		for (size_t i = 0; i <= mask; i++)
+			cells[i].~Cell();
+	}
+
+	/** Adds an element. This can be called from any thread and returns false if the queue is full.
+	*
+	*	If maxNumAttempts is not zero, the element is also dropped if the producer loses the race for a slot that often.
+	*/
+	bool push(const ElementType &newElement, int maxNumAttempts=0) noexcept
+	{
+		size_t position = enqueuePosition.load(std::memory_order_relaxed);
+
+		for (int i = 0; maxNumAttempts == 0 || i < maxNumAttempts; i++)
+		{
+			Cell *cell = cells + (position & mask);
+
+			const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+			const intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+
+			if (difference == 0)
+			{
+				if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					cell->element = newElement;
+					cell->sequence.store(position + 1, std::memory_order_release);
+
+					return true;
+				}
+			}
+			else if (difference < 0)
+			{
+				// The slot still holds an element of the last round, so the queue is full.
+				return false;
+			}
+			else
+			{
+				position = enqueuePosition.load(std::memory_order_relaxed);
+			}
+		}
+
+		return false;
+	}
+
+	/** Removes the oldest element. Returns false if there is no element that has been pushed completely. */
+	bool pop(ElementType &element) noexcept
+	{
+		Cell *cell = cells + (dequeuePosition & mask);
+
+		if (cell->sequence.load(std::memory_order_acquire) != dequeuePosition + 1)
+			return false;
+
+		element = cell->element;
+		cell->element = ElementType();
+
+		cell->sequence.store(dequeuePosition + mask + 1, std::memory_order_release);
+		dequeuePosition++;
+
+		return true;
+	}
+
+	/** Calls the function object with every element that can be popped.
+	*
+	*	This can be used to change the pending elements in place. Elements that are still being written by another thread
+	*	are skipped. Only the thread that pops the elements must call this.
+	*/
+	template <class FunctionType> void forEachPending(FunctionType &f) noexcept
+	{
+		const size_t end = enqueuePosition.load(std::memory_order_acquire);
+
+		for (size_t position = dequeuePosition; position != end; position++)
+		{
+			Cell *cell = cells + (position & mask);
+
+			if (cell->sequence.load(std::memory_order_acquire) == position + 1)
+				f(cell->element);
+		}
+	}
+
+	/** Checks if there are no elements. This is only a snapshot if other threads push elements. */
+	bool isEmpty() const noexcept
+	{
+		return cells[dequeuePosition & mask].sequence.load(std::memory_order_acquire) != dequeuePosition + 1;
+	}
+
+	int getCapacity() const noexcept { return (int)(mask + 1); }
+
+private:
+
+	struct Cell
+	{
+		Cell() : sequence(0), element() {}
+
+		std::atomic<size_t> sequence;
+		ElementType element;
+	};
+
+	HeapBlock<Cell> cells;
+	const size_t mask;
+
+	std::atomic<size_t> enqueuePosition;
+
+	// only accessed by the consumer
+	size_t dequeuePosition;
+
+	JUCE_DECLARE_NON_COPYABLE(MultiProducerQueue)
+};
+
+#endif  // MULTIPRODUCERQUEUE_H_INCLUDED
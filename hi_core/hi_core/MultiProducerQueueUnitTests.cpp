@@ -0,0 +1,266 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licences for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licencing:
+*
+*   http://www.hartinstruments.net/hise/
+*
+*   HISE is based on the JUCE library,
+*   which also must be licenced for commercial applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+
+#include "JuceHeader.h"
+
+class MultiProducerQueueUnitTest : public UnitTest
+{
+public:
+
+	MultiProducerQueueUnitTest() :
+		UnitTest("Testing the lock-free multi producer queue")
+	{
+
+	}
+
+	void runTest() override
+	{
+		testCapacity();
+		testReleasedElements();
+		testPendingElements();
+		testConcurrentProducers();
+	}
+
+private:
+
+	enum
+	{
+		NumProducers = 4,
+		NumElementsPerProducer = 20000
+	};
+
+	struct Element
+	{
+		Element() : producer(-1), value(-1) {}
+
+		Element(int producer_, int value_) : producer(producer_), value(value_) {}
+
+		int producer;
+		int value;
+	};
+
+	class Counter : public ReferenceCountedObject
+	{
+	public:
+
+		typedef ReferenceCountedObjectPtr<Counter> Ptr;
+	};
+
+	class Producer : public Thread
+	{
+	public:
+
+		Producer(MultiProducerQueue<Element> &queue_, int index_) :
+			Thread("Producer " + String(index_)),
+			queue(queue_),
+			index(index_)
+		{};
+
+		void run() override
+		{
+			for (int i = 0; i < NumElementsPerProducer; i++)
+			{
+				while (!queue.push(Element(index, i)))
+				{
+					if (threadShouldExit())
+						return;
+
+					Thread::sleep(1);
+				}
+			}
+		}
+
+	private:
+
+		MultiProducerQueue<Element> &queue;
+		const int index;
+	};
+
+	void testCapacity()
+	{
+		beginTest("Testing a full queue");
+
+		MultiProducerQueue<Element> queue(100);
+
+		expectEquals(queue.getCapacity(), 128, "Capacity is rounded up");
+		expect(queue.isEmpty(), "New queue is empty");
+
+		for (int i = 0; i < 128; i++)
+			expect(queue.push(Element(0, i)), "Push " + String(i));
+
+		expect(!queue.push(Element(0, 128)), "Full queue rejects elements");
+		expect(!queue.push(Element(0, 128), 4), "Full queue rejects elements with limited attempts");
+
+		Element e;
+		int numOrderErrors = 0;
+
+		for (int i = 0; i < 128; i++)
+		{
+			if (!queue.pop(e) || e.value != i)
+				numOrderErrors++;
+		}
+
+		expectEquals(numOrderErrors, 0, "Elements are popped in order");
+		expect(queue.isEmpty(), "Queue is empty");
+		expect(!queue.pop(e), "Empty queue");
+
+		expect(queue.push(Element(1, 200)), "Push after the queue was emptied");
+		expect(queue.pop(e) && e.producer == 1 && e.value == 200, "Wrapped element");
+	}
+
+	void testReleasedElements()
+	{
+		beginTest("Testing that popped elements are released by the consumer");
+
+		MultiProducerQueue<Counter::Ptr> queue(4);
+
+		Counter::Ptr counter = new Counter();
+
+		queue.push(counter);
+
+		expectEquals(counter->getReferenceCount(), 2, "The queue holds a reference");
+
+		{
+			Counter::Ptr popped;
+
+			queue.pop(popped);
+
+			expectEquals(counter->getReferenceCount(), 2, "The slot doesn't hold a reference after pop()");
+		}
+
+		expectEquals(counter->getReferenceCount(), 1, "The popped element is the last reference");
+	}
+
+	/** Sets the value of the pending elements of one producer to -1. */
+	struct Canceller
+	{
+		void operator()(Element &e) const noexcept
+		{
+			if (e.producer == producer)
+				e.value = -1;
+		}
+
+		int producer;
+	};
+
+	void testPendingElements()
+	{
+		beginTest("Testing the pending elements");
+
+		MultiProducerQueue<Element> queue(16);
+
+		Element e;
+
+		// Move the positions so that the pending elements wrap around
+		for (int i = 0; i < 10; i++)
+		{
+			queue.push(Element(0, i));
+			queue.pop(e);
+		}
+
+		for (int i = 0; i < 12; i++)
+			queue.push(Element(i % 2, i));
+
+		Canceller canceller = { 1 };
+
+		queue.forEachPending(canceller);
+
+		int numCancelled = 0;
+		int numOtherElements = 0;
+
+		while (queue.pop(e))
+		{
+			if (e.producer == 1 && e.value == -1)
+				numCancelled++;
+			else if (e.producer == 0 && e.value % 2 == 0)
+				numOtherElements++;
+		}
+
+		expectEquals(numCancelled, 6, "Pending elements of producer 1 are changed");
+		expectEquals(numOtherElements, 6, "Other elements are unchanged");
+	}
+
+	void testConcurrentProducers()
+	{
+		beginTest("Testing concurrent producers");
+
+		MultiProducerQueue<Element> queue(256);
+
+		OwnedArray<Producer> producers;
+
+		for (int i = 0; i < NumProducers; i++)
+			producers.add(new Producer(queue, i));
+
+		for (int i = 0; i < NumProducers; i++)
+			producers[i]->startThread();
+
+		int lastValues[NumProducers];
+
+		for (int i = 0; i < NumProducers; i++)
+			lastValues[i] = -1;
+
+		const int numExpected = NumProducers * NumElementsPerProducer;
+
+		int numReceived = 0;
+		int numOrderErrors = 0;
+
+		const double timeout = Time::getMillisecondCounterHiRes() + 20000.0;
+
+		Element e;
+
+		while (numReceived < numExpected && Time::getMillisecondCounterHiRes() < timeout)
+		{
+			if (!queue.pop(e))
+			{
+				Thread::sleep(1);
+				continue;
+			}
+
+			if (!isPositiveAndBelow(e.producer, (int)NumProducers) || e.value != lastValues[e.producer] + 1)
+				numOrderErrors++;
+			else
+				lastValues[e.producer] = e.value;
+
+			numReceived++;
+		}
+
+		for (int i = 0; i < NumProducers; i++)
+			producers[i]->stopThread(1000);
+
+		expectEquals(numReceived, numExpected, "Every element is popped once");
+		expectEquals(numOrderErrors, 0, "Elements of one thread keep their order");
+		expect(queue.isEmpty(), "Queue is empty");
+	}
+};
+
+static MultiProducerQueueUnitTest multiProducerQueueUnitTest;
@@ -0,0 +1,351 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licences for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licencing:
+*
+*   http://www.hartinstruments.net/hise/
+*
+*   HISE is based on the JUCE library,
+*   which also must be licenced for commercial applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+class ProcessorProfiler::Collector : public Thread
+{
+public:
+
+	Collector(ProcessorProfiler &parent_) :
+		Thread("Processor Profiler"),
+		parent(parent_)
+	{};
+
+	void run() override
+	{
+		while (!threadShouldExit())
+		{
+			parent.collectSamples();
+			wait(20);
+		}
+	}
+
+private:
+
+	ProcessorProfiler &parent;
+};
+
+ProcessorProfiler::ScopedSection::ScopedSection(const Processor *p) noexcept :
+	profiler(nullptr),
+	processor(p),
+	startTicks(0)
+{
+	if (p != nullptr)
+	{
+		ProcessorProfiler &pp = const_cast<MainController*>(p->getMainController())->getProcessorProfiler();
+
+		if (pp.isEnabled())
+		{
+			profiler = &pp;
+			startTicks = Time::getHighResolutionTicks();
+		}
+	}
+}
+
+ProcessorProfiler::ScopedSection::~ScopedSection() noexcept
+{
+	if (profiler != nullptr)
+		profiler->addSample(processor, Time::getHighResolutionTicks() - startTicks);
+}
+
+ProcessorProfiler::ScopedBlock::ScopedBlock(ProcessorProfiler &profiler_) noexcept :
+	profiler(profiler_),
+	startTicks(0)
+{
+	if (profiler.isEnabled())
+	{
+		profiler.blockIndex.fetch_add(1, std::memory_order_relaxed);
+		startTicks = Time::getHighResolutionTicks();
+	}
+}
+
+ProcessorProfiler::ScopedBlock::~ScopedBlock() noexcept
+{
+	// startTicks is zero if the profiler was enabled during this block.
+	if (startTicks != 0 && profiler.isEnabled())
+		profiler.addSample(nullptr, Time::getHighResolutionTicks() - startTicks);
+}
+
+ProcessorProfiler::ProcessorProfiler(int capacity) :
+	samples(capacity),
+	enabled(false),
+	blockIndex(0),
+	numDroppedSamples(0)
+{
+}
+
+ProcessorProfiler::~ProcessorProfiler()
+{
+	enabled.store(false);
+
+	if (collector != nullptr)
+		collector->stopThread(1000);
+}
+
+void ProcessorProfiler::setEnabled(bool shouldBeEnabled)
+{
+	if (shouldBeEnabled == isEnabled())
+		return;
+
+	if (shouldBeEnabled)
+	{
+		reset();
+
+		enabled.store(true);
+
+		if (collector == nullptr)
+			collector = new Collector(*this);
+
+		collector->startThread(3);
+	}
+	else
+	{
+		enabled.store(false);
+
+		collector->stopThread(1000);
+
+		// Pick up the samples of the last blocks so that they appear in the next report.
+		collectSamples();
+	}
+}
+
+void ProcessorProfiler::reset()
+{
+	ScopedLock sl(statisticsLock);
+
+	statisticIndexes.clear();
+	statistics.clear();
+	numDroppedSamples.store(0);
+}
+
+void ProcessorProfiler::removeProcessor(const Processor *p)
+{
+	ScopedLock sl(statisticsLock);
+
+	// The pending samples would add the processor again.
+	collectSamples();
+
+	const pointer_sized_int key = reinterpret_cast<pointer_sized_int>(p);
+
+	if (!statisticIndexes.contains(key))
+		return;
+
+	const int index = statisticIndexes[key];
+	const int lastIndex = statistics.size() - 1;
+
+	// Move the last entry into the gap, so that only its index changes.
+	if (index != lastIndex)
+	{
+		statistics.swap(index, lastIndex);
+		statisticIndexes.set(statistics.getReference(index).key, index);
+	}
+
+	statistics.removeLast();
+	statisticIndexes.remove(key);
+}
+
+void ProcessorProfiler::addSample(const Processor *p, int64 ticks) noexcept
+{
+	Sample sample;
+
+	sample.processor = p;
+	sample.ticks = ticks;
+	sample.blockIndex = blockIndex.load(std::memory_order_relaxed);
+
+	// If the collector is lagging behind, the sample is lost.
+	if (!samples.push(sample))
+		numDroppedSamples.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ProcessorProfiler::collectSamples()
+{
+	ScopedLock sl(statisticsLock);
+
+	Sample sample;
+
+	for (int i = 0; i < samples.getCapacity(); i++)
+	{
+		if (!samples.pop(sample))
+			break;
+
+		const pointer_sized_int key = reinterpret_cast<pointer_sized_int>(sample.processor);
+
+		if (!statisticIndexes.contains(key))
+		{
+			statisticIndexes.set(key, statistics.size());
+			statistics.add(Statistics(key));
+		}
+
+		Statistics &s = statistics.getReference(statisticIndexes[key]);
+
+		// A processor can be rendered multiple times per block (eg. once per voice), so the block time is the sum
+		// of all samples with the same block index.
+		if (s.lastBlock != sample.blockIndex)
+		{
+			s.lastBlock = sample.blockIndex;
+			s.ticksInBlock = 0;
+			s.numBlocks++;
+		}
+
+		s.ticksInBlock += sample.ticks;
+		s.totalTicks += sample.ticks;
+		s.maxTicksPerBlock = jmax<int64>(s.maxTicksPerBlock, s.ticksInBlock);
+	}
+}
+
+bool ProcessorProfiler::hasStatistics(const Processor *p) const
+{
+	ScopedLock sl(statisticsLock);
+
+	return getStatistics(p) != nullptr;
+}
+
+const ProcessorProfiler::Statistics *ProcessorProfiler::getStatistics(const Processor *p) const noexcept
+{
+	const pointer_sized_int key = reinterpret_cast<pointer_sized_int>(p);
+
+	if (!statisticIndexes.contains(key))
+		return nullptr;
+
+	return &statistics.getReference(statisticIndexes[key]);
+}
+
+static double ticksToMilliSeconds(int64 ticks)
+{
+	return Time::highResolutionTicksToSeconds(ticks) * 1000.0;
+}
+
+var ProcessorProfiler::createReport(const Processor *root)
+{
+	ScopedLock sl(statisticsLock);
+
+	DynamicObject::Ptr callback = new DynamicObject();
+
+	int numBlocks = 0;
+
+	if (const Statistics *s = getStatistics(nullptr))
+	{
+		// The whole callback creates exactly one sample per block.
+		numBlocks = s->numBlocks;
+
+		callback->setProperty("AverageMs", ticksToMilliSeconds(s->totalTicks) / (double)jmax<int>(1, numBlocks));
+		callback->setProperty("MaxMs", ticksToMilliSeconds(s->maxTicksPerBlock));
+	}
+
+	callback->setProperty("NumBlocks", numBlocks);
+	callback->setProperty("DroppedSamples", getNumDroppedSamples());
+
+	var report = createNode(root, numBlocks);
+
+	if (DynamicObject *obj = report.getDynamicObject())
+		obj->setProperty("Callback", var(callback));
+
+	return report;
+}
+
+var ProcessorProfiler::createNode(const Processor *p, int numBlocks) const
+{
+	DynamicObject::Ptr node = new DynamicObject();
+
+	node->setProperty("ID", p->getId());
+	node->setProperty("Type", p->getType().toString());
+
+	Array<var> children;
+	double childrenMs = 0.0;
+
+	for (int i = 0; i < p->getNumChildProcessors(); i++)
+	{
+		if (const Processor *child = p->getChildProcessor(i))
+		{
+			var childNode = createNode(child, numBlocks);
+			childrenMs += (double)childNode.getProperty("AverageMs", 0.0);
+			children.add(childNode);
+		}
+	}
+
+	const Statistics *s = getStatistics(p);
+
+	const double divisor = (double)jmax<int>(1, numBlocks);
+
+	// A chain that is not measured itself (eg. the MIDI processor chain) just sums up its children.
+	const double averageMs = s != nullptr ? ticksToMilliSeconds(s->totalTicks) / divisor : childrenMs;
+	const double selfMs = s != nullptr ? jmax<double>(0.0, averageMs - childrenMs) : 0.0;
+	const double maxMs = s != nullptr ? ticksToMilliSeconds(s->maxTicksPerBlock) : 0.0;
+
+	node->setProperty("AverageMs", averageMs);
+	node->setProperty("SelfMs", selfMs);
+	node->setProperty("MaxMs", maxMs);
+	node->setProperty("Children", children);
+
+	return var(node);
+}
+
+static void addNodeToTextReport(String &text, const var &node, int level)
+{
+	const double averageMs = node.getProperty("AverageMs", 0.0);
+
+	// Skip the modules that are not rendered (or not measured) to keep the list short.
+	if (averageMs <= 0.0)
+		return;
+
+	text << String::repeatedString("    ", level);
+	text << node.getProperty("ID", "").toString() << " (" << node.getProperty("Type", "").toString() << "): ";
+	text << String(averageMs, 3) << " ms, self: " << String((double)node.getProperty("SelfMs", 0.0), 3) << " ms";
+	text << ", max: " << String((double)node.getProperty("MaxMs", 0.0), 3) << " ms\n";
+
+	if (const Array<var> *children = node.getProperty("Children", var()).getArray())
+	{
+		for (int i = 0; i < children->size(); i++)
+			addNodeToTextReport(text, children->getUnchecked(i), level + 1);
+	}
+}
+
+String ProcessorProfiler::createTextReport(const var &report)
+{
+	String text;
+
+	const var callback = report.getProperty("Callback", var());
+
+	text << "Audio callback: " << String((double)callback.getProperty("AverageMs", 0.0), 3) << " ms";
+	text << ", max: " << String((double)callback.getProperty("MaxMs", 0.0), 3) << " ms";
+	text << " (" << (int)callback.getProperty("NumBlocks", 0) << " blocks";
+
+	const int numDropped = callback.getProperty("DroppedSamples", 0);
+
+	if (numDropped > 0)
+		text << ", " << numDropped << " samples dropped";
+
+	text << ")\n";
+
+	addNodeToTextReport(text, report, 0);
+
+	return text;
+}
@@ -0,0 +1,179 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licences for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licencing:
+*
+*   http://www.hartinstruments.net/hise/
+*
+*   HISE is based on the JUCE library,
+*   which also must be licenced for commercial applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+#ifndef PROCESSORPROFILER_H_INCLUDED
+#define PROCESSORPROFILER_H_INCLUDED
+
+class Processor;
+
+/** Measures how much time each Processor spends in its audio callbacks.
+*
+*	The measuring points are the ADD_GLITCH_DETECTOR() sites in the rendering code, which create a ScopedSection for
+*	the processor they belong to. If the profiler is disabled, a section only checks a flag, so it is always compiled.
+*
+*	A section pushes its duration into a bounded lock-free queue (the render threads of the RealtimeWorkerPool can
+*	push at the same time as the audio thread). A background thread collects the samples every few milliseconds and
+*	sums them up per processor and per audio block. createReport() then builds a tree with the average total / self
+*	time and the worst block for every processor in the patch.
+*/
+class ProcessorProfiler
+{
+public:
+
+	/** Measures the time until it goes out of scope and adds it to the processor's statistics. */
+	class ScopedSection
+	{
+	public:
+
+		/** Does nothing if the processor is nullptr or the profiler of its MainController is disabled. */
+		ScopedSection(const Processor *p) noexcept;
+
+		~ScopedSection() noexcept;
+
+	private:
+
+		ProcessorProfiler *profiler;
+		const Processor *processor;
+		int64 startTicks;
+
+		JUCE_DECLARE_NON_COPYABLE(ScopedSection)
+	};
+
+	/** Marks the start and end of an audio callback. The whole block is recorded as the root of the tree. */
+	class ScopedBlock
+	{
+	public:
+
+		ScopedBlock(ProcessorProfiler &profiler_) noexcept;
+
+		~ScopedBlock() noexcept;
+
+	private:
+
+		ProcessorProfiler &profiler;
+		int64 startTicks;
+
+		JUCE_DECLARE_NON_COPYABLE(ScopedBlock)
+	};
+
+	ProcessorProfiler(int capacity=16384);
+
+	~ProcessorProfiler();
+
+	/** Starts or stops the collecting thread. Enabling the profiler clears the old statistics. */
+	void setEnabled(bool shouldBeEnabled);
+
+	bool isEnabled() const noexcept { return enabled.load(std::memory_order_relaxed); }
+
+	/** Clears the statistics of all processors. */
+	void reset();
+
+	/** Removes the statistics of the processor.
+	*
+	*	The Processor calls this when it is deleted, so a new processor that is created at the same address doesn't
+	*	show up with the old statistics.
+	*/
+	void removeProcessor(const Processor *p);
+
+	/** Checks if any samples of the processor have been collected. */
+	bool hasStatistics(const Processor *p) const;
+
+	/** Returns the number of samples that were lost because the queue was full. */
+	int getNumDroppedSamples() const noexcept { return numDroppedSamples.load(); }
+
+	/** Creates a tree with the statistics of the given processor and all its children.
+	*
+	*	Every node is an object with the properties "ID", "Type", "AverageMs" (the time per block including the
+	*	children), "SelfMs" (without the children), "MaxMs" (the slowest block) and an array "Children". The
+	*	root object has an additional property "Callback" with the statistics of the whole audio callback.
+	*/
+	var createReport(const Processor *root);
+
+	/** Formats a report from createReport() as indented lines for the console. */
+	static String createTextReport(const var &report);
+
+private:
+
+	class Collector;
+
+	struct Sample
+	{
+		const Processor *processor;
+		int64 ticks;
+		uint32 blockIndex;
+	};
+
+	struct Statistics
+	{
+		Statistics(pointer_sized_int key_=0) : key(key_), lastBlock(0), numBlocks(0), ticksInBlock(0), totalTicks(0), maxTicksPerBlock(0) {};
+
+		pointer_sized_int key;
+		uint32 lastBlock;
+		int numBlocks;
+		int64 ticksInBlock;
+		int64 totalTicks;
+		int64 maxTicksPerBlock;
+	};
+
+	struct PointerHashFunction
+	{
+		int generateHash(pointer_sized_int key, int upperLimit) const noexcept
+		{
+			return (int)(((uint64)key >> 4) % (uint64)upperLimit);
+		}
+	};
+
+	const Statistics *getStatistics(const Processor *p) const noexcept;
+
+	void addSample(const Processor *p, int64 ticks) noexcept;
+
+	/** Moves all pending samples from the queue into the statistics. Only the Collector thread calls this. */
+	void collectSamples();
+
+	var createNode(const Processor *p, int numBlocks) const;
+
+	MultiProducerQueue<Sample> samples;
+
+	std::atomic<bool> enabled;
+	std::atomic<uint32> blockIndex;
+	std::atomic<int> numDroppedSamples;
+
+	CriticalSection statisticsLock;
+	HashMap<pointer_sized_int, int, PointerHashFunction> statisticIndexes;
+	Array<Statistics> statistics;
+
+	ScopedPointer<Collector> collector;
+
+	JUCE_DECLARE_NON_COPYABLE(ProcessorProfiler)
+};
+
+#endif  // PROCESSORPROFILER_H_INCLUDED
@@ -0,0 +1,306 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licences for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licencing:
+*
+*   http://www.hartinstruments.net/hise/
+*
+*   HISE is based on the JUCE library,
+*   which also must be licenced for commercial applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+
+#include "JuceHeader.h"
+
+class ProcessorProfilerUnitTest : public UnitTest
+{
+public:
+
+	ProcessorProfilerUnitTest() :
+		UnitTest("Testing the processor profiler")
+	{
+
+	}
+
+	void runTest() override
+	{
+		testNestedSections();
+		testRemovedProcessors();
+	}
+
+private:
+
+	enum
+	{
+		NumBlocks = 8,
+		SlowBlock = 5
+	};
+
+	/** Waits actively, so that the section lasts at least this long. */
+	static void spin(double milliSeconds)
+	{
+		const int64 end = Time::getHighResolutionTicks() + Time::secondsToHighResolutionTicks(milliSeconds * 0.001);
+
+		while (Time::getHighResolutionTicks() < end)
+		{
+		}
+	}
+
+	/** Measures a parent section with nested child sections like a synth that renders its chains. */
+	class SectionThread : public Thread
+	{
+	public:
+
+		SectionThread(const Processor *parent_, const Processor *child_, int numChildSections_) :
+			Thread("Section Thread"),
+			parent(parent_),
+			child(child_),
+			numChildSections(numChildSections_),
+			childMs(0.0),
+			selfMs(0.0)
+		{};
+
+		void run() override
+		{
+			ProcessorProfiler::ScopedSection parentSection(parent);
+
+			for (int i = 0; i < numChildSections; i++)
+			{
+				ProcessorProfiler::ScopedSection childSection(child);
+				spin(childMs);
+			}
+
+			spin(selfMs);
+		}
+
+		const Processor *parent;
+		const Processor *child;
+		const int numChildSections;
+
+		double childMs;
+		double selfMs;
+	};
+
+	struct NodeValues
+	{
+		NodeValues() : found(false), averageMs(0.0), selfMs(0.0), maxMs(0.0) {}
+
+		NodeValues(const var &node) :
+			found(node.isObject()),
+			averageMs(node.getProperty("AverageMs", 0.0)),
+			selfMs(node.getProperty("SelfMs", 0.0)),
+			maxMs(node.getProperty("MaxMs", 0.0))
+		{}
+
+		bool found;
+		double averageMs;
+		double selfMs;
+		double maxMs;
+	};
+
+	struct ReportValues
+	{
+		ReportValues() : numBlocks(0), numDroppedSamples(0) {}
+
+		int numBlocks;
+		int numDroppedSamples;
+
+		NodeValues synth;
+		NodeValues gainChain;
+		NodeValues effectChain;
+		NodeValues pitchChain;
+	};
+
+	static var findChild(const var &node, const String &id)
+	{
+		if (const Array<var> *children = node.getProperty("Children", var()).getArray())
+		{
+			for (int i = 0; i < children->size(); i++)
+			{
+				if (children->getUnchecked(i).getProperty("ID", "").toString() == id)
+					return children->getUnchecked(i);
+			}
+		}
+
+		return var();
+	}
+
+	void testNestedSections()
+	{
+		beginTest("Testing nested sections from two threads");
+
+		const ReportValues r = profileNestedSections();
+
+		expectEquals(r.numBlocks, (int)NumBlocks, "Number of blocks");
+		expectEquals(r.numDroppedSamples, 0, "No dropped samples");
+
+		expect(r.synth.found && r.gainChain.found && r.effectChain.found && r.pitchChain.found, "The chains are children of the synth");
+
+		// The gain chain is measured twice per block for 0.3ms, so only the sum of both sections can reach 0.6ms
+		expect(r.gainChain.averageMs >= 0.6, "Gain chain average: " + String(r.gainChain.averageMs, 3));
+		expect(r.gainChain.maxMs >= 0.6, "Gain chain max: " + String(r.gainChain.maxMs, 3));
+
+		// The effect chain takes 0.3ms except for one block with 1.5ms
+		expect(r.effectChain.averageMs >= 0.45, "Effect chain average: " + String(r.effectChain.averageMs, 3));
+		expect(r.effectChain.maxMs >= 1.5, "Effect chain max: " + String(r.effectChain.maxMs, 3));
+		expect(r.effectChain.maxMs >= r.effectChain.averageMs, "Max is bigger than the average");
+
+		// Both threads measure the synth, so its total time contains both chains and the self time of both threads
+		expect(r.synth.averageMs >= r.gainChain.averageMs + r.effectChain.averageMs + 0.3, "Synth total: " + String(r.synth.averageMs, 3));
+		expect(std::abs(r.synth.selfMs - (r.synth.averageMs - r.gainChain.averageMs - r.effectChain.averageMs)) < 0.000001, "Self time is the total without the children");
+		expect(r.synth.selfMs >= 0.3, "Synth self time: " + String(r.synth.selfMs, 3));
+
+		expectEquals(r.pitchChain.averageMs, 0.0, "The pitch chain was not measured");
+	}
+
+	/** The processors are deleted before this returns because the BackendProcessor redirects the log messages of the test to its console. */
+	static ReportValues profileNestedSections()
+	{
+		ScopedPointer<BackendProcessor> bp = new BackendProcessor();
+
+		SineSynth *synth = new SineSynth(bp, "Sine", NUM_POLYPHONIC_VOICES);
+
+		bp->getMainSynthChain()->getHandler()->add(synth, nullptr);
+
+		const Processor *gainChain = synth->getChildProcessor(ModulatorSynth::GainModulation);
+		const Processor *effectChain = synth->getChildProcessor(ModulatorSynth::EffectChain);
+		const Processor *pitchChain = synth->getChildProcessor(ModulatorSynth::PitchModulation);
+
+		ProcessorProfiler &profiler = bp->getProcessorProfiler();
+
+		profiler.setEnabled(true);
+
+		SectionThread voiceThread(synth, gainChain, 2);
+		SectionThread effectThread(synth, effectChain, 1);
+
+		voiceThread.childMs = 0.3;
+		voiceThread.selfMs = 0.2;
+		effectThread.selfMs = 0.1;
+
+		for (int i = 0; i < NumBlocks; i++)
+		{
+			ProcessorProfiler::ScopedBlock block(profiler);
+
+			effectThread.childMs = (i == SlowBlock) ? 1.5 : 0.3;
+
+			voiceThread.startThread();
+			effectThread.startThread();
+
+			voiceThread.waitForThreadToExit(5000);
+			effectThread.waitForThreadToExit(5000);
+		}
+
+		profiler.setEnabled(false);
+
+		const var report = profiler.createReport(synth);
+		const var callback = report.getProperty("Callback", var());
+
+		ReportValues r;
+
+		r.numBlocks = callback.getProperty("NumBlocks", 0);
+		r.numDroppedSamples = callback.getProperty("DroppedSamples", 0);
+		r.synth = NodeValues(report);
+		r.gainChain = NodeValues(findChild(report, gainChain->getId()));
+		r.effectChain = NodeValues(findChild(report, effectChain->getId()));
+		r.pitchChain = NodeValues(findChild(report, pitchChain->getId()));
+
+		return r;
+	}
+
+	struct RemovalResult
+	{
+		RemovalResult() : measured(false), removed(false), otherProcessorKept(false), pendingSamplesRemoved(false) {}
+
+		bool measured;
+		bool removed;
+		bool otherProcessorKept;
+		bool pendingSamplesRemoved;
+	};
+
+	void testRemovedProcessors()
+	{
+		beginTest("Testing the statistics of deleted processors");
+
+		const RemovalResult r = profileRemovedProcessors();
+
+		expect(r.measured, "The processor is measured");
+		expect(r.removed, "The statistics are removed with the processor");
+		expect(r.otherProcessorKept, "The other statistics are kept");
+		expect(r.pendingSamplesRemoved, "Samples that were not collected yet are removed too");
+	}
+
+	static RemovalResult profileRemovedProcessors()
+	{
+		ScopedPointer<BackendProcessor> bp = new BackendProcessor();
+
+		ProcessorProfiler &profiler = bp->getProcessorProfiler();
+
+		const Processor *synthChain = bp->getMainSynthChain();
+
+		ScopedPointer<LfoModulator> lfo = new LfoModulator(bp, "LFO", Modulation::GainMode);
+
+		const Processor *lfoPointer = lfo;
+
+		RemovalResult r;
+
+		profiler.setEnabled(true);
+
+		{
+			ProcessorProfiler::ScopedBlock block(profiler);
+			ProcessorProfiler::ScopedSection chainSection(synthChain);
+			ProcessorProfiler::ScopedSection lfoSection(lfo);
+		}
+
+		profiler.setEnabled(false);
+
+		r.measured = profiler.hasStatistics(lfoPointer);
+
+		lfo = nullptr;
+
+		r.removed = !profiler.hasStatistics(lfoPointer);
+		r.otherProcessorKept = profiler.hasStatistics(synthChain);
+
+		profiler.setEnabled(true);
+
+		ScopedPointer<LfoModulator> secondLfo = new LfoModulator(bp, "LFO2", Modulation::GainMode);
+
+		const Processor *secondLfoPointer = secondLfo;
+
+		{
+			ProcessorProfiler::ScopedBlock block(profiler);
+			ProcessorProfiler::ScopedSection lfoSection(secondLfo);
+		}
+
+		// The collector thread waits 20ms between the collections, so the sample is most likely still in the queue
+		secondLfo = nullptr;
+
+		profiler.setEnabled(false);
+
+		r.pendingSamplesRemoved = !profiler.hasStatistics(secondLfoPointer);
+
+		return r;
+	}
+};
+
+static ProcessorProfilerUnitTest processorProfilerUnitTest;
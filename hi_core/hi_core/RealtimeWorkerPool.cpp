@@ -0,0 +1,159 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licences for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licencing:
+*
+*   http://www.hartinstruments.net/hise/
+*
+*   HISE is based on the JUCE library,
+*   which also must be licenced for commercial applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+class RealtimeWorkerPool::Worker : public Thread
+{
+public:
+
+	Worker(RealtimeWorkerPool &parent_, int index) :
+		Thread("Realtime Worker " + String(index + 1)),
+		parent(parent_)
+	{};
+
+	void run() override
+	{
+		while (!threadShouldExit())
+		{
+			wakeUp.wait();
+
+			if (threadShouldExit())
+				break;
+
+			parent.runPendingItems();
+		}
+	}
+
+	/** Wakes up the worker. This doesn't lock, so it can be called from the audio thread. */
+	void wakeUpWorker() noexcept { wakeUp.signal(); }
+
+private:
+
+	RealtimeWorkerPool &parent;
+
+	// The worker is the only thread that waits on this semaphore
+	Semaphore wakeUp;
+};
+
+RealtimeWorkerPool::RealtimeWorkerPool(int numWorkers) :
+	state(0),
+	currentJob(nullptr),
+	numItemsInRun(0),
+	numFinishedItems(0)
+{
+	for (int i = 0; i < numWorkers; i++)
+	{
+		workers.add(new Worker(*this, i));
+		workers.getLast()->startThread(10);
+	}
+}
+
+RealtimeWorkerPool::~RealtimeWorkerPool()
+{
+	for (int i = 0; i < workers.size(); i++)
+	{
+		workers[i]->signalThreadShouldExit();
+		workers[i]->wakeUpWorker();
+	}
+
+	for (int i = 0; i < workers.size(); i++)
+	{
+		workers[i]->stopThread(1000);
+	}
+
+	workers.clear();
+}
+
+void RealtimeWorkerPool::runParallel(Job &job, int numItems)
+{
+	if (numItems <= 0)
+		return;
+
+	if (workers.size() == 0 || numItems == 1)
+	{
+		for (int i = 0; i < numItems; i++)
+			job.runItem(i);
+
+		return;
+	}
+
+	const uint64 nextGeneration = (getGeneration(state.load()) + 1) << 32;
+
+	// Close the old run before the job is replaced, so that a late worker can't claim an index of the new job
+	// with the state of the old generation.
+	state.store(nextGeneration | 0x7FFFFFFF);
+
+	numFinishedItems.store(0);
+	numItemsInRun.store(numItems);
+	currentJob.store(&job);
+
+	state.store(nextGeneration);
+
+	const int numWorkersToWake = jmin<int>(workers.size(), numItems - 1);
+
+	for (int i = 0; i < numWorkersToWake; i++)
+		workers[i]->wakeUpWorker();
+
+	runPendingItems();
+
+	// Every run signals the semaphore exactly once, so this also consumes the signal if this thread finished the last item.
+	runFinished.wait();
+
+	jassert(numFinishedItems.load() == numItems);
+}
+
+bool RealtimeWorkerPool::runPendingItems()
+{
+	bool processedItems = false;
+
+	for (;;)
+	{
+		uint64 s = state.load(std::memory_order_acquire);
+
+		const int numItems = numItemsInRun.load(std::memory_order_acquire);
+		Job *job = currentJob.load(std::memory_order_acquire);
+		const int itemIndex = getItemIndex(s);
+
+		if (job == nullptr || itemIndex >= numItems)
+			return processedItems;
+
+		if (state.compare_exchange_weak(s, s + 1, std::memory_order_acq_rel))
+		{
+			job->runItem(itemIndex);
+
+			// The run can't end before this item is finished, so numItems still belongs to it
+			if (numFinishedItems.fetch_add(1, std::memory_order_acq_rel) + 1 == numItems)
+				runFinished.signal();
+
+			processedItems = true;
+		}
+	}
+}
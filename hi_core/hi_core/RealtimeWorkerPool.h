@@ -0,0 +1,104 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licences for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licencing:
+*
+*   http://www.hartinstruments.net/hise/
+*
+*   HISE is based on the JUCE library,
+*   which also must be licenced for commercial applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+#ifndef REALTIMEWORKERPOOL_H_INCLUDED
+#define REALTIMEWORKERPOOL_H_INCLUDED
+
+/** A fixed set of high priority threads that help the audio thread with independent work items.
+*
+*	Unlike the SampleThreadPool, this pool is not a job queue. The audio thread calls runParallel() with a Job and
+*	the number of items, wakes up the workers and then processes items itself until none are left. Items are claimed
+*	through a single atomic counter that carries a generation tag, so a worker that wakes up late can't pick up an item
+*	of another run.
+*
+*	Every worker sleeps on its own lightweight semaphore. Waking it up is an atomic increment and only enters the kernel
+*	(a futex on Linux) if the worker is really asleep, so the calling thread never takes a mutex. The thread that finishes
+*	the last item signals the calling thread the same way. The join spins for a short time and then sleeps on the
+*	semaphore, so it doesn't burn the core while a worker finishes a long item.
+*
+*	The workers are created in the constructor and are never added or removed while the pool is running. The pool only
+*	runs one job at a time, so it must not be shared between threads that call runParallel() concurrently.
+*/
+class RealtimeWorkerPool
+{
+public:
+
+	/** The work that is distributed across the threads. */
+	class Job
+	{
+	public:
+
+		virtual ~Job() {};
+
+		/** Processes the item with the given index. This will be called exactly once for every index of the run. */
+		virtual void runItem(int itemIndex) = 0;
+	};
+
+	/** Creates a pool with the given amount of worker threads (the calling thread is not included). */
+	RealtimeWorkerPool(int numWorkers);
+
+	~RealtimeWorkerPool();
+
+	/** Calls Job::runItem() for every index from 0 to numItems - 1 and returns after all items are finished.
+	*
+	*	The calling thread processes items too, so this also works (sequentially) if the workers are busy or absent.
+	*/
+	void runParallel(Job &job, int numItems);
+
+	int getNumWorkers() const noexcept { return workers.size(); }
+
+private:
+
+	class Worker;
+
+	/** Claims and runs items of the current generation. Returns true if at least one item was processed. */
+	bool runPendingItems();
+
+	typedef moodycamel::spsc_sema::LightweightSemaphore Semaphore;
+
+	static uint64 getGeneration(uint64 s) noexcept { return s >> 32; }
+	static int getItemIndex(uint64 s) noexcept { return (int)(s & 0x7FFFFFFF); }
+
+	std::atomic<uint64> state;
+	std::atomic<Job*> currentJob;
+	std::atomic<int> numItemsInRun;
+	std::atomic<int> numFinishedItems;
+
+	/** Signalled by the thread that finishes the last item of a run. Only the thread in runParallel() waits on it. */
+	Semaphore runFinished;
+
+	OwnedArray<Worker> workers;
+
+	JUCE_DECLARE_NON_COPYABLE(RealtimeWorkerPool)
+};
+
+#endif  // REALTIMEWORKERPOOL_H_INCLUDED
@@ -0,0 +1,336 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licences for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licencing:
+*
+*   http://www.hartinstruments.net/hise/
+*
+*   HISE is based on the JUCE library,
+*   which also must be licenced for commercial applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+
+#include "JuceHeader.h"
+
+class RealtimeWorkerPoolUnitTest : public UnitTest
+{
+public:
+
+	RealtimeWorkerPoolUnitTest() :
+		UnitTest("Testing parallel rendering with the realtime worker pool")
+	{
+
+	}
+
+	void runTest() override
+	{
+		testEveryItemRunsOnce();
+		testDeterministicSummation();
+		testSynthChainRendering();
+		testScaling();
+	}
+
+private:
+
+	enum
+	{
+		NumChildren = 16,
+		NumVoicesPerChild = 24,
+		BlockSize = 512
+	};
+
+	/** Counts how often each item is processed. */
+	class CountingJob : public RealtimeWorkerPool::Job
+	{
+	public:
+
+		CountingJob()
+		{
+			for (int i = 0; i < 64; i++)
+				counters[i] = 0;
+		}
+
+		void runItem(int itemIndex) override
+		{
+			counters[itemIndex].fetch_add(1);
+		}
+
+		std::atomic<int> counters[64];
+	};
+
+	/** Simulates a chain of synths that render some sine voices into their own buffers. */
+	class SynthChainJob : public RealtimeWorkerPool::Job
+	{
+	public:
+
+		SynthChainJob()
+		{
+			for (int i = 0; i < NumChildren; i++)
+			{
+				childBuffers.add(new AudioSampleBuffer(2, BlockSize));
+				phases.add(0.0);
+			}
+		}
+
+		void runItem(int itemIndex) override
+		{
+			AudioSampleBuffer &b = *childBuffers[itemIndex];
+
+			b.clear();
+
+			float *l = b.getWritePointer(0);
+			float *r = b.getWritePointer(1);
+
+			for (int v = 0; v < NumVoicesPerChild; v++)
+			{
+				const double delta = 0.01 + 0.001 * (double)(itemIndex * NumVoicesPerChild + v);
+				double phase = phases[itemIndex] * (double)(v + 1);
+				const float gain = 1.0f / (float)(v + 1);
+
+				for (int i = 0; i < BlockSize; i++)
+				{
+					const float value = gain * (float)std::sin(phase);
+
+					l[i] += value;
+					r[i] += 0.5f * value;
+
+					phase += delta;
+				}
+			}
+
+			phases.set(itemIndex, phases[itemIndex] + 0.01 * (double)BlockSize);
+		}
+
+		/** Adds the children to the output in a fixed order. */
+		void sum(AudioSampleBuffer &output)
+		{
+			output.clear();
+
+			for (int i = 0; i < NumChildren; i++)
+			{
+				for (int c = 0; c < 2; c++)
+					FloatVectorOperations::add(output.getWritePointer(c), childBuffers[i]->getReadPointer(c), BlockSize);
+			}
+		}
+
+		OwnedArray<AudioSampleBuffer> childBuffers;
+		Array<double> phases;
+	};
+
+	void testEveryItemRunsOnce()
+	{
+		beginTest("Testing that every item is processed exactly once");
+
+		Random r;
+
+		const int workerAmounts[] = { 0, 1, 2, 4, 8 };
+
+		for (int w = 0; w < 5; w++)
+		{
+			const int numWorkers = workerAmounts[w];
+
+			RealtimeWorkerPool pool(numWorkers);
+
+			bool ok = true;
+
+			for (int run = 0; run < 2000; run++)
+			{
+				CountingJob job;
+
+				const int numItems = r.nextInt(Range<int>(1, 64));
+
+				pool.runParallel(job, numItems);
+
+				for (int i = 0; i < 64; i++)
+				{
+					const int expected = i < numItems ? 1 : 0;
+
+					if (job.counters[i].load() != expected)
+						ok = false;
+				}
+			}
+
+			expect(ok, "Items processed once with " + String(numWorkers) + " workers");
+		}
+	}
+
+	void testDeterministicSummation()
+	{
+		beginTest("Testing that the parallel output matches the sequential output");
+
+		SynthChainJob sequentialJob;
+		SynthChainJob parallelJob;
+
+		RealtimeWorkerPool pool(4);
+
+		AudioSampleBuffer sequentialOutput(2, BlockSize);
+		AudioSampleBuffer parallelOutput(2, BlockSize);
+
+		bool identical = true;
+
+		for (int block = 0; block < 32; block++)
+		{
+			for (int i = 0; i < NumChildren; i++)
+				sequentialJob.runItem(i);
+
+			pool.runParallel(parallelJob, NumChildren);
+
+			sequentialJob.sum(sequentialOutput);
+			parallelJob.sum(parallelOutput);
+
+			for (int c = 0; c < 2; c++)
+			{
+				if (memcmp(sequentialOutput.getReadPointer(c), parallelOutput.getReadPointer(c), sizeof(float) * BlockSize) != 0)
+					identical = false;
+			}
+		}
+
+		expect(identical, "Bitwise identical output");
+	}
+
+	/** Creates a processor with some sine synths that play a chord. */
+	static BackendProcessor *createChainProcessor(int numWorkers)
+	{
+		BackendProcessor *bp = new BackendProcessor();
+
+		ModulatorSynthChain *chain = bp->getMainSynthChain();
+
+		for (int i = 0; i < 8; i++)
+		{
+			SineSynth *s = new SineSynth(bp, "Sine" + String(i + 1), NUM_POLYPHONIC_VOICES);
+
+			s->setAttribute(SineSynth::SemiTones, (float)(i - 4), dontSendNotification);
+			s->setAttribute(ModulatorSynth::Gain, 0.1f, dontSendNotification);
+			s->setAttribute(ModulatorSynth::Balance, (float)(i * 20 - 70), dontSendNotification);
+
+			chain->getHandler()->add(s, nullptr);
+		}
+
+		chain->setAttribute(ModulatorSynthChain::NumParallelRenderWorkers, (float)numWorkers, dontSendNotification);
+
+		bp->prepareToPlay(44100.0, BlockSize);
+
+		return bp;
+	}
+
+	static void renderChainBlock(BackendProcessor *bp, AudioSampleBuffer &output, int blockIndex)
+	{
+		MidiBuffer midi;
+
+		if (blockIndex == 0)
+		{
+			midi.addEvent(MidiMessage::noteOn(1, 60, (uint8)100), 0);
+			midi.addEvent(MidiMessage::noteOn(1, 64, (uint8)80), 17);
+			midi.addEvent(MidiMessage::noteOn(1, 67, (uint8)60), 300);
+		}
+		else if (blockIndex == 20)
+		{
+			midi.addEvent(MidiMessage::noteOff(1, 64), 111);
+		}
+
+		output.clear();
+
+		bp->processBlock(output, midi);
+	}
+
+	void testSynthChainRendering()
+	{
+		beginTest("Testing that a parallel synth chain renders the same output as the sequential chain");
+
+		ScopedPointer<BackendProcessor> sequential = createChainProcessor(0);
+		ScopedPointer<BackendProcessor> parallel = createChainProcessor(4);
+
+		expectEquals(sequential->getMainSynthChain()->getNumParallelRenderWorkers(), 0, "Sequential chain");
+		expectEquals(parallel->getMainSynthChain()->getNumParallelRenderWorkers(), 4, "Workers created by the attribute");
+
+		AudioSampleBuffer sequentialOutput(2, BlockSize);
+		AudioSampleBuffer parallelOutput(2, BlockSize);
+
+		bool identical = true;
+		float peak = 0.0f;
+
+		for (int block = 0; block < 32; block++)
+		{
+			renderChainBlock(sequential, sequentialOutput, block);
+			renderChainBlock(parallel, parallelOutput, block);
+
+			peak = jmax<float>(peak, sequentialOutput.getMagnitude(0, BlockSize));
+
+			for (int c = 0; c < 2; c++)
+			{
+				if (memcmp(sequentialOutput.getReadPointer(c), parallelOutput.getReadPointer(c), sizeof(float) * BlockSize) != 0)
+					identical = false;
+			}
+		}
+
+		expect(peak > 0.01f, "The chain produces a signal");
+		expect(identical, "Bitwise identical output");
+
+		ValueTree v = parallel->getMainSynthChain()->exportAsValueTree();
+
+		expectEquals<int>(v.getProperty("NumParallelRenderWorkers"), 4, "The amount of workers is saved");
+	}
+
+	void testScaling()
+	{
+		beginTest("Measuring the CPU scaling");
+
+		const int numBlocks = 400;
+
+		logMessage("Logical CPUs: " + String(SystemStats::getNumCpus()));
+		logMessage(String(NumChildren) + " children with " + String(NumVoicesPerChild) + " voices, " + String(BlockSize) + " samples per block");
+
+		measureRenderTime(0, numBlocks / 4); // warm up
+
+		const double sequentialTime = measureRenderTime(0, numBlocks);
+
+		logMessage("Sequential: " + String(1000.0 * sequentialTime / (double)numBlocks, 3) + " ms per block");
+
+		for (int numWorkers = 1; numWorkers <= 8; numWorkers *= 2)
+		{
+			const double parallelTime = measureRenderTime(numWorkers, numBlocks);
+
+			logMessage(String(numWorkers) + " workers: " + String(1000.0 * parallelTime / (double)numBlocks, 3) + " ms per block, speedup: " + String(sequentialTime / parallelTime, 2) + "x");
+		}
+	}
+
+	double measureRenderTime(int numWorkers, int numBlocks)
+	{
+		RealtimeWorkerPool pool(numWorkers);
+		SynthChainJob job;
+		AudioSampleBuffer output(2, BlockSize);
+
+		const double start = Time::getMillisecondCounterHiRes();
+
+		for (int i = 0; i < numBlocks; i++)
+		{
+			pool.runParallel(job, NumChildren);
+			job.sum(output);
+		}
+
+		return jmax<double>(0.001, (Time::getMillisecondCounterHiRes() - start) * 0.001);
+	}
+};
+
+static RealtimeWorkerPoolUnitTest realtimeWorkerPoolUnitTest;
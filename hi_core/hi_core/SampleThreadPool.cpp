@@ -34,6 +34,341 @@
 
 const String NewSampleThreadPool::errorMessage("HDD overflow");
 
+NewSampleThreadPool::NewSampleThreadPool(int numWorkersToUse)
+{
+	const int numWorkers = numWorkersToUse > 0 ? numWorkersToUse : jlimit<int>(1, 4, SystemStats::getNumCpus() / 2);
+
+	for (int i = 0; i < numWorkers; i++)
+	{
+		workers.add(new Worker(*this, i));
+	}
+
+	for (int i = 0; i < workers.size(); i++)
+	{
+		workers[i]->startThread(9);
+	}
+}
+
+NewSampleThreadPool::~NewSampleThreadPool()
+{
+	for (int i = 0; i < workers.size(); i++)
+	{
+		workers[i]->signalThreadShouldExit();
+		workers[i]->wakeUpWorker();
+
+		if (Job* currentJob = workers[i]->currentlyExecutedJob.load())
+		{
+			currentJob->signalJobShouldExit();
+		}
+	}
+
+	for (int i = 0; i < workers.size(); i++)
+	{
+		workers[i]->stopThread(300);
+	}
+}
+
+void NewSampleThreadPool::addJob(Job* jobToAdd, bool unused)
+{
+	ignoreUnused(unused);
+
+	if (jobToAdd->isQueued())
+	{
+		// The last request of this job hasn't been processed yet.
+#if ENABLE_CONSOLE_OUTPUT
+		Logger::writeToLog(errorMessage);
+		Logger::writeToLog(String(counter.get()));
+#endif
+
+		notifyUnderrun(jobToAdd);
+		return;
+	}
+
+	Worker* w = workers.getFirst();
+
+	for (int i = 1; i < workers.size(); i++)
+	{
+		if (workers[i]->numJobs.load() < w->numJobs.load())
+			w = workers[i];
+	}
+
+	++counter;
+
+	jobToAdd->numSkips = 0;
+	jobToAdd->workerIndex.store(w->index);
+	jobToAdd->queued.store(true);
+
+	w->numJobs++;
+
+	if (!w->jobQueue.push(WeakReference<Job>(jobToAdd)))
+	{
+		// The worker is too far behind, so treat it like a job that missed its deadline.
+		w->numJobs--;
+		jobToAdd->queued.store(false);
+		--counter;
+
+		notifyUnderrun(jobToAdd);
+		return;
+	}
+
+	w->wakeUpWorker();
+}
+
+void NewSampleThreadPool::notifyUnderrun(Job* job)
+{
+	const int index = job->workerIndex.load();
+
+	if (isPositiveAndBelow(index, workers.size()))
+	{
+		++workers[index]->numUnderruns;
+		workers[index]->wakeUpWorker();
+	}
+}
+
+double NewSampleThreadPool::getDiskUsage(int workerIndex) const noexcept
+{
+	jassert(isPositiveAndBelow(workerIndex, workers.size()));
+
+	return isPositiveAndBelow(workerIndex, workers.size()) ? workers[workerIndex]->diskUsage.load() : 0.0;
+}
+
+int NewSampleThreadPool::getNumUnderruns(int workerIndex) const noexcept
+{
+	jassert(isPositiveAndBelow(workerIndex, workers.size()));
+
+	return isPositiveAndBelow(workerIndex, workers.size()) ? workers[workerIndex]->numUnderruns.get() : 0;
+}
+
+void NewSampleThreadPool::resetUnderrunCounters()
+{
+	for (int i = 0; i < workers.size(); i++)
+	{
+		workers[i]->numUnderruns.set(0);
+	}
+}
+
+NewSampleThreadPool::Job* NewSampleThreadPool::stealJob(int thiefIndex)
+{
+	for (int i = 1; i < workers.size(); i++)
+	{
+		Worker* victim = workers[(thiefIndex + i) % workers.size()];
+
+		if (Job* j = victim->takeMostUrgentJob())
+		{
+			j->workerIndex.store(thiefIndex);
+			return j;
+		}
+	}
+
+	return nullptr;
+}
+
+void NewSampleThreadPool::runJob(Worker &w, Job* j)
+{
+#if ENABLE_CPU_MEASUREMENT
+	const int64 lastEndTime = w.endTime;
+	w.startTime = Time::getHighResolutionTicks();
+#endif
+
+	// Wake up the next worker so that it can steal the remaining jobs
+	if (w.numJobs.load() > 0 && workers.size() > 1)
+	{
+		workers[(w.index + 1) % workers.size()]->wakeUpWorker();
+	}
+
+	w.currentlyExecutedJob.store(j);
+
+	if (!runBatchedJobs(w, j))
+	{
+		j->running.store(true);
+
+		const Job::JobStatus status = j->runJob();
+
+		j->running.store(false);
+
+		finishJob(w, j, status);
+	}
+
+	w.currentlyExecutedJob.store(nullptr);
+
+#if ENABLE_CPU_MEASUREMENT
+	w.endTime = Time::getHighResolutionTicks();
+
+	const int64 idleTime = w.startTime - lastEndTime;
+	const int64 busyTime = w.endTime - w.startTime;
+
+	w.diskUsage.store((double)busyTime / (double)(idleTime + busyTime));
+#endif
+}
+
+bool NewSampleThreadPool::runBatchedJobs(Worker &w, Job* firstJob)
+{
+	if (!w.readBatch.isAvailable())
+		return false;
+
+	Job* batchedJobs[MaxBatchSize];
+	int numBatchedJobs = 0;
+
+	Job* j = firstJob;
+
+	while (j != nullptr)
+	{
+		j->running.store(true);
+
+		if (!j->addToBatch(w.readBatch))
+		{
+			j->running.store(false);
+
+			if (j == firstJob)
+				return false;
+
+			// Run it on its own the next time
+			w.addPendingJob(j);
+			break;
+		}
+
+		batchedJobs[numBatchedJobs++] = j;
+
+		if (numBatchedJobs == MaxBatchSize || w.readBatch.isFull())
+			break;
+
+		j = w.takeMostUrgentJob();
+	}
+
+	w.readBatch.submitAndWait();
+
+	for (int i = 0; i < numBatchedJobs; i++)
+	{
+		const Job::JobStatus status = batchedJobs[i]->finishBatchedJob();
+
+		batchedJobs[i]->running.store(false);
+
+		finishJob(w, batchedJobs[i], status);
+	}
+
+	return true;
+}
+
+void NewSampleThreadPool::finishJob(Worker &w, Job* j, Job::JobStatus status)
+{
+	if (status == Job::jobHasFinished)
+	{
+		j->queued.store(false);
+		--counter;
+	}
+	else
+	{
+		w.addPendingJob(j);
+	}
+}
+
+// =============================================================================================================================================== Worker methods
+
+NewSampleThreadPool::Worker::Worker(NewSampleThreadPool &parent_, int index_) :
+	Thread("Sample Loading Thread " + String(index_ + 1)),
+	parent(parent_),
+	index(index_),
+	jobQueue(QueueSize),
+	numJobs(0),
+	currentlyExecutedJob(nullptr),
+	diskUsage(0.0),
+	startTime(0),
+	endTime(0)
+{
+	pendingJobs.ensureStorageAllocated(QueueSize);
+}
+
+void NewSampleThreadPool::Worker::run()
+{
+	while (!threadShouldExit())
+	{
+		fetchNewJobs();
+
+		Job* j = takeMostUrgentJob();
+
+		if (j == nullptr)
+			j = parent.stealJob(index);
+
+		if (j != nullptr)
+		{
+			parent.runJob(*this, j);
+		}
+		else
+		{
+			wakeUp.wait(500000);
+		}
+	}
+}
+
+void NewSampleThreadPool::Worker::fetchNewJobs()
+{
+	WeakReference<Job> newJob;
+
+	ScopedLock sl(pendingLock);
+
+	while (jobQueue.pop(newJob))
+	{
+		pendingJobs.add(newJob);
+	}
+}
+
+NewSampleThreadPool::Job* NewSampleThreadPool::Worker::takeMostUrgentJob()
+{
+	ScopedLock sl(pendingLock);
+
+	int bestIndex = -1;
+	int bestDeadline = 0;
+
+	for (int i = 0; i < pendingJobs.size();)
+	{
+		Job* j = pendingJobs.getReference(i).get();
+
+		if (j == nullptr)
+		{
+			// The job was deleted while it was waiting
+			pendingJobs.remove(i);
+			numJobs--;
+			--parent.counter;
+			continue;
+		}
+
+		// Jobs without a deadline must not be delayed forever
+		const int deadline = j->numSkips >= MaxNumSkips ? INT_MIN : j->getDeadline();
+
+		if (bestIndex == -1 || deadline < bestDeadline)
+		{
+			bestIndex = i;
+			bestDeadline = deadline;
+		}
+
+		i++;
+	}
+
+	if (bestIndex == -1)
+		return nullptr;
+
+	Job* bestJob = pendingJobs.getReference(bestIndex).get();
+
+	pendingJobs.remove(bestIndex);
+	numJobs--;
+
+	for (int i = 0; i < pendingJobs.size(); i++)
+	{
+		if (Job* j = pendingJobs.getReference(i).get())
+			j->numSkips++;
+	}
+
+	return bestJob;
+}
+
+void NewSampleThreadPool::Worker::addPendingJob(Job* j)
+{
+	ScopedLock sl(pendingLock);
+
+	numJobs++;
+	pendingJobs.add(j);
+}
+
 #else
 
 class SampleThreadPool::SampleThreadPoolThread : public Thread
@@ -39,42 +39,49 @@
 
 #if NEW_THREAD_POOL_IMPLEMENTATION
 
-class NewSampleThreadPool : public Thread
+/** A pool of background threads that stream the samples from disk.
+*
+*	Every worker thread has its own lock free queue that is filled from the audio thread (and the render workers of a
+*	parallel ModulatorSynthChain), so adding a job never locks or allocates.
+*	The workers move the jobs from their queue into a list of pending jobs and always run the most urgent job first
+*	(the one with the smallest deadline). If a worker runs out of jobs, it steals the most urgent job from another worker.
+*/
+class NewSampleThreadPool
 {
 public:
 
-	NewSampleThreadPool():
-		Thread("Sample Loading Thread"),
-		jobQueue(2048),
-		currentlyExecutedJob(nullptr),
-		diskUsage(0.0),
-		counter(0)
+	enum
 	{
-		startThread(9);
-		
-	}
+		QueueSize = 2048,
+		MaxNumSkips = 16,
+		MaxBatchSize = 32
+	};
 
-	~NewSampleThreadPool()
-	{
-		if (Job* currentJob = currentlyExecutedJob.load())
-		{
-			currentJob->signalJobShouldExit();
-		}
+	NewSampleThreadPool(int numWorkersToUse=NUM_STREAMING_THREADS);
 
-		stopThread(300);
-	}
-	
+	~NewSampleThreadPool();
 
 	class Job
 	{
 	public:
 
+		enum
+		{
+			NoDeadline = INT_MAX
+		};
+
 		Job(const String &name_) : 
 			name(name_),
 			queued(false),
 			running(false),
-			shouldStop(false)
-		{};
+			shouldStop(false),
+			deadline(NoDeadline),
+			workerIndex(-1),
+			numSkips(0)
+		{
+			// Create the shared pointer of the weak references now, so that adding the job never allocates.
+			masterReference.getSharedPointer(this);
+		};
         
         virtual ~Job() { masterReference.clear(); }
 
@@ -94,6 +101,23 @@ public:
 
 		bool isQueued() const noexcept{ return queued.load(); };
 
+		/** Sets the number of samples that can be played until this job must have finished. 
+		*
+		*	Call this before adding the job to the pool. Jobs without a deadline are run when nothing more urgent is pending.
+		*/
+		void setDeadline(int numSamplesUntilDeadline) noexcept { deadline.store(numSamplesUntilDeadline); }
+
+		int getDeadline() const noexcept { return deadline.load(); }
+
+		/** Override this if the job can add its disk reads to a batch that is submitted together with other jobs.
+		*
+		*	Return false if the job can't be batched this time, it will be run with runJob() instead.
+		*/
+		virtual bool addToBatch(AsyncReadBatch &/*batch*/) { return false; }
+
+		/** This is called after the reads of the batch were performed. */
+		virtual JobStatus finishBatchedJob() { return jobHasFinished; }
+
 	private:
 
 		friend class NewSampleThreadPool;
@@ -107,109 +131,99 @@ public:
 
 		std::atomic<bool> shouldStop;
 
+		std::atomic<int> deadline;
+
+		std::atomic<int> workerIndex;
+
+		int numSkips;
+
 		const String name;
 	};
 
-	double getDiskUsage() const noexcept
-	{
-		return diskUsage.load();
-	}
+	/** Adds a job to the queue of the least busy worker.
+	*
+	*	This is lock free and can be called from the audio thread and from multiple render threads at the same time.
+	*	If the queue of the worker is full, the job is not added and it counts as an underrun.
+	*/
+	void addJob(Job* jobToAdd, bool unused);
 
-	void addJob(Job* jobToAdd, bool unused)
-	{
-		++counter;
-        
-		ignoreUnused(unused);
+	/** Call this if a job couldn't be finished before its deadline. It increases the underrun counter of the worker. */
+	void notifyUnderrun(Job* job);
 
-#if ENABLE_CONSOLE_OUTPUT
-		if (jobToAdd->isQueued())
-		{
-			Logger::writeToLog(errorMessage);
-			Logger::writeToLog(String(counter.get()));
-		}
-#endif
+	int getNumWorkers() const noexcept { return workers.size(); }
 
+	/** Returns the time the worker spent reading from disk relative to the total time (0.0 ... 1.0). */
+	double getDiskUsage(int workerIndex) const noexcept;
 
-		jobToAdd->queued.store(true);
-		jobQueue.enqueue(jobToAdd);
-		
+	/** Returns the number of jobs that missed their deadline on the given worker. */
+	int getNumUnderruns(int workerIndex) const noexcept;
 
-		notify();
-	}
+	void resetUnderrunCounters();
+
+	/** Returns the number of jobs that were added and haven't finished yet. */
+	int getNumQueuedJobs() const noexcept { return counter.get(); }
+
+	static const String errorMessage;
 
-	void run() override
+private:
+
+	typedef moodycamel::spsc_sema::LightweightSemaphore Semaphore;
+
+	class Worker : public Thread
 	{
-		while (!threadShouldExit())
-		{
-			if (WeakReference<Job>* next = jobQueue.peek())
-			{
-                Job* j = next->get();
+	public:
 
-#if ENABLE_CPU_MEASUREMENT
+		Worker(NewSampleThreadPool &parent_, int index_);
 
-				const int64 lastEndTime = endTime;
-				startTime = Time::getHighResolutionTicks();
-#endif
-                
-                if(j != nullptr)
-                {
-                    currentlyExecutedJob.store(j);
-                    
-                    j->running.store(true);
-                    
-                    Job::JobStatus status = j->runJob();
-                    
-                    j->running.store(false);
-                    
-                    if (status == Job::jobHasFinished)
-                    {
-                        jobQueue.pop();
-                        j->queued.store(false);
-                        --counter;
-                    }
-                    
-                    currentlyExecutedJob.store(nullptr);
-                }
-                
-                
-#if ENABLE_CPU_MEASUREMENT
-				endTime = Time::getHighResolutionTicks();
-
-				const int64 idleTime = startTime - lastEndTime;
-				const int64 busyTime = endTime - startTime;
-
-				diskUsage.store((double)busyTime / (double)(idleTime + busyTime));
-#endif
-			}
+		void run() override;
 
-#if 0 // Set this to true to enable defective threading (for debugging purposes)
-			wait(500);
-#else
-            else
-            {
-                wait(500);
-            }
-#endif
-            
-            
-		}
-			
-	}
+		/** Moves the jobs from the lock free queue to the pending list. */
+		void fetchNewJobs();
 
-    Atomic<int> counter;
-    
-	std::atomic<double> diskUsage;
+		/** Removes the most urgent job from the pending list. Returns nullptr if there is no job. */
+		Job* takeMostUrgentJob();
 
-	int64 startTime, endTime;
+		void addPendingJob(Job* j);
 
-	moodycamel::ReaderWriterQueue<WeakReference<Job>> jobQueue;
+		/** Wakes up the worker without locking. */
+		void wakeUpWorker() noexcept { wakeUp.signal(); }
 
-	std::atomic<Job*> currentlyExecutedJob;
+		NewSampleThreadPool &parent;
+		const int index;
 
-	static const String errorMessage;
-};
+		// Any thread can add jobs, only this worker removes them
+		MultiProducerQueue<WeakReference<Job>> jobQueue;
+
+		// The worker is the only thread that waits on this semaphore
+		Semaphore wakeUp;
+
+		CriticalSection pendingLock;
+		Array<WeakReference<Job>> pendingJobs;
+
+		std::atomic<int> numJobs;
+		std::atomic<Job*> currentlyExecutedJob;
+
+		std::atomic<double> diskUsage;
+		Atomic<int> numUnderruns;
+
+		int64 startTime, endTime;
 
+		AsyncReadBatch readBatch;
+	};
+
+	Job* stealJob(int thiefIndex);
+
+	void runJob(Worker &w, Job* j);
+
+	/** Collects more jobs from the worker and submits their reads as one batch. Returns false if the job can't be batched. */
+	bool runBatchedJobs(Worker &w, Job* firstJob);
 
+	void finishJob(Worker &w, Job* j, Job::JobStatus status);
+
+	Atomic<int> counter;
+
+	OwnedArray<Worker> workers;
+};
 
 typedef NewSampleThreadPool SampleThreadPool;
 typedef NewSampleThreadPool::Job SampleThreadPoolJob;
@@ -0,0 +1,170 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licences for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licencing:
+*
+*   http://www.hartinstruments.net/hise/
+*
+*   HISE is based on the JUCE library,
+*   which also must be licenced for commercial applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+
+#include "JuceHeader.h"
+
+/** Adds jobs to the sample streaming pool from multiple threads at once (like the render workers of a parallel
+*	ModulatorSynthChain) and checks that every added job is run.
+*/
+class SampleThreadPoolUnitTest : public UnitTest
+{
+public:
+
+	SampleThreadPoolUnitTest() :
+		UnitTest("Testing the sample streaming thread pool")
+	{
+
+	}
+
+	void runTest() override
+	{
+		testConcurrentProducers();
+	}
+
+private:
+
+	enum
+	{
+		NumProducers = 4,
+		NumJobsPerProducer = 32,
+		NumRounds = 500
+	};
+
+	class CountingJob : public SampleThreadPool::Job
+	{
+	public:
+
+		CountingJob() :
+			Job("Counting Job"),
+			numRuns(0)
+		{};
+
+		JobStatus runJob() override
+		{
+			numRuns++;
+			return jobHasFinished;
+		}
+
+		std::atomic<int> numRuns;
+	};
+
+	/** Adds its jobs again as soon as they are finished. */
+	class Producer : public Thread
+	{
+	public:
+
+		Producer(SampleThreadPool &pool_, int index) :
+			Thread("Producer " + String(index)),
+			pool(pool_),
+			numAddedJobs(0)
+		{
+			for (int i = 0; i < NumJobsPerProducer; i++)
+				jobs.add(new CountingJob());
+		}
+
+		void run() override
+		{
+			for (int round = 0; round < NumRounds; round++)
+			{
+				for (int i = 0; i < jobs.size(); i++)
+				{
+					if (!jobs[i]->isQueued())
+					{
+						jobs[i]->setDeadline(i * 64);
+						pool.addJob(jobs[i], false);
+						numAddedJobs++;
+					}
+				}
+
+				Thread::yield();
+			}
+		}
+
+		int getNumRuns() const
+		{
+			int numRuns = 0;
+
+			for (int i = 0; i < jobs.size(); i++)
+				numRuns += jobs[i]->numRuns.load();
+
+			return numRuns;
+		}
+
+		SampleThreadPool &pool;
+		OwnedArray<CountingJob> jobs;
+		int numAddedJobs;
+	};
+
+	void testConcurrentProducers()
+	{
+		beginTest("Testing jobs that are added from multiple threads");
+
+		// The producers own the jobs, so they must be deleted after the pool
+		OwnedArray<Producer> producers;
+
+		{
+			SampleThreadPool pool(2);
+
+			for (int i = 0; i < NumProducers; i++)
+				producers.add(new Producer(pool, i));
+
+			for (int i = 0; i < producers.size(); i++)
+				producers[i]->startThread();
+
+			for (int i = 0; i < producers.size(); i++)
+				producers[i]->waitForThreadToExit(-1);
+
+			const double timeout = Time::getMillisecondCounterHiRes() + 5000.0;
+
+			while (pool.getNumQueuedJobs() > 0 && Time::getMillisecondCounterHiRes() < timeout)
+				Thread::sleep(1);
+
+			expectEquals<int>(pool.getNumQueuedJobs(), 0, "Pending jobs");
+			expectEquals<int>(pool.getNumUnderruns(0) + pool.getNumUnderruns(1), 0, "Underruns");
+		}
+
+		int numAddedJobs = 0;
+		int numRuns = 0;
+
+		for (int i = 0; i < producers.size(); i++)
+		{
+			numAddedJobs += producers[i]->numAddedJobs;
+			numRuns += producers[i]->getNumRuns();
+		}
+
+		expect(numAddedJobs > NumProducers * NumJobsPerProducer, "Every job was added more than once");
+		expectEquals<int>(numRuns, numAddedJobs, "Every added job was run once");
+	}
+};
+
+static SampleThreadPoolUnitTest sampleThreadPoolUnitTest;
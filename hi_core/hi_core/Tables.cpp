@@ -117,4 +117,31 @@ void Table::fillLookUpTable()
 
 float *MidiTable::getWritePointer() {return data;};
 
+void MidiTable::getValues(const float *inputValues, float *outputValues, int numValues) const noexcept
+{
+	int i = 0;
+
+#if HI_SAMPLER_USE_SSE
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 maxIndex = _mm_set1_ps(127.0f);
+
+	for (; i + 4 <= numValues; i += 4)
+	{
+		// The operand order makes max() return 0 for NaN inputs
+		const __m128 index = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(inputValues + i), maxIndex), zero), maxIndex);
+
+		int indexes[4];
+		_mm_storeu_si128((__m128i*)indexes, _mm_cvttps_epi32(index));
+
+		// SSE2 has no gather, so the table entries are loaded one by one...
+		_mm_storeu_ps(outputValues + i, _mm_set_ps(data[indexes[3]], data[indexes[2]], data[indexes[1]], data[indexes[0]]));
+	}
+#endif
+
+	for (; i < numValues; i++)
+	{
+		outputValues[i] = data[(int)jlimit<float>(0.0f, 127.0f, inputValues[i] * 127.0f)];
+	}
+}
+
 float *SampleLookupTable::getWritePointer() {return data;};
\ No newline at end of file
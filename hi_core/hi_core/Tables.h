@@ -222,6 +222,13 @@ public:
 	/** Allows access to the lookup table*/
 	inline float get(int index) const {return data[index]; };
 
+	/** Maps a block of normalised values (0.0 ... 1.0) through the table.
+	*
+	*	This is the block version of get((int)(value * 127.0f)), so the index is truncated and not interpolated.
+	*	Input values outside the range are clipped. The input and output pointers can be the same.
+	*/
+	void getValues(const float *inputValues, float *outputValues, int numValues) const noexcept;
+
 	
 
 protected:
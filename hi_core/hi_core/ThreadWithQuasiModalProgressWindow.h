@@ -220,6 +220,9 @@ public:
 
 		Overlay *getOverlay() { return overlay.getComponent(); }
 
+		/** Returns true if there are threads that are running or waiting to be started. */
+		bool isBusy() const noexcept { return queue.size() != 0; }
+
         void handleAsyncUpdate()
         {
             ThreadWithQuasiModalProgressWindow *window = queue[0];
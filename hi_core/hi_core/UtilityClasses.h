@@ -234,11 +234,14 @@ private:
 *   ID again. This makes sure you only get one log per glitch (if you have multiple GlitchDetectors in your stack trace, 
 *   they all would fire if a glitch occurred.
 *
-*   You might want to use the macro ADD_GLITCH_DETECTOR(name) (where name is a simple C string literal which will be parsed to a 
+*   You might want to use the macro ADD_GLITCH_DETECTOR(processor, name) (where name is a simple C string literal which will be parsed to a 
 *   static Identifier, because it can be excluded for deployment builds using
 *   
 *       #define USE_GLITCH_DETECTION 0
 *
+*   The macro also adds a ProcessorProfiler::ScopedSection for the processor (which is always compiled). Pass nullptr
+*   if the function is already measured by another section of the same processor.
+*
 *   This macro can be only used once per function scope, but this should be OK...
 */
 class ScopedGlitchDetector
@@ -306,9 +309,9 @@ private:
 
 
 #if USE_GLITCH_DETECTION && !JUCE_DEBUG
-#define ADD_GLITCH_DETECTOR(x) static Identifier glitchId(x); ScopedGlitchDetector sgd(glitchId)
+#define ADD_GLITCH_DETECTOR(processor, x) ProcessorProfiler::ScopedSection scopedProfilerSection(processor); static Identifier glitchId(x); ScopedGlitchDetector sgd(glitchId)
 #else
-#define ADD_GLITCH_DETECTOR(x)
+#define ADD_GLITCH_DETECTOR(processor, x) ProcessorProfiler::ScopedSection scopedProfilerSection(processor)
 #endif
 
 /** A drop in replacement for the ChangeBroadcaster class from JUCE but with weak references.
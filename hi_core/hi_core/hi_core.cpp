@@ -46,7 +46,12 @@ namespace juce
 #include "HI_LookAndFeels.cpp"
 #include "Tables.cpp"
 #include "ExternalFilePool.cpp"
+#include "AsyncReadBatch.cpp"
 #include "SampleThreadPool.cpp"
+#include "RealtimeWorkerPool.cpp"
+#include "AudioThreadCommandQueue.cpp"
+#include "ProcessorProfiler.cpp"
+#include "ConsoleMessageQueue.cpp"
 #include "GlobalScriptCompileBroadcaster.cpp"
 #include "MainControllerHelpers.cpp"
 #include "MainController.cpp"
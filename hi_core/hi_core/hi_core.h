@@ -69,7 +69,13 @@ namespace juce
 #include "ExternalFilePool.h"
 #include "BackgroundThreads.h"
 #include "SettingsWindows.h"
+#include "MultiProducerQueue.h"
+#include "AsyncReadBatch.h"
 #include "SampleThreadPool.h"
+#include "RealtimeWorkerPool.h"
+#include "AudioThreadCommandQueue.h"
+#include "ProcessorProfiler.h"
+#include "ConsoleMessageQueue.h"
 #include "PresetHandler.h"
 #include "GlobalScriptCompileBroadcaster.h"
 #include "MainControllerHelpers.h"
@@ -112,6 +112,7 @@ public:
 	virtual ~Processor()
 	{
 		getMainController()->getMacroManager().removeMacroControlsFor(this);
+		getMainController()->getProcessorProfiler().removeProcessor(this);
 		masterReference.clear();
 		removeAllChangeListeners();	
 	};
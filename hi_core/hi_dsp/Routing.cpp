@@ -438,9 +438,11 @@ void RoutableProcessor::MatrixData::setTargetProcessor(Processor *p)
 
 void RoutableProcessor::MatrixData::setGainValues(float *numMaxChannelValues, bool isSourceValue)
 {
-	ScopedLock sl(getLock());
+	// No lock here: this is called from the render callback, which might run on a worker thread of a parallel
+	// ModulatorSynthChain while the audio thread holds the lock. The arrays are big enough for every channel amount.
+	const int numChannels = jmin<int>(NUM_MAX_CHANNELS, isSourceValue ? numSourceChannels : numDestinationChannels);
 
-	memcpy(isSourceValue ? sourceGainValues : targetGainValues, numMaxChannelValues, (isSourceValue ? numSourceChannels : numDestinationChannels) * sizeof(float));
+	memcpy(isSourceValue ? sourceGainValues : targetGainValues, numMaxChannelValues, numChannels * sizeof(float));
 }
 
 void RoutableProcessor::MatrixData::loadPreset(Presets newPreset)
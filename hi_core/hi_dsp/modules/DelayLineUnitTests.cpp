@@ -0,0 +1,245 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licences for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licencing:
+*
+*   http://www.hartinstruments.net/hise/
+*
+*   HISE is based on the JUCE library,
+*   which also must be licenced for commercial applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+
+#include "JuceHeader.h"
+
+class DelayLineUnitTest : public UnitTest
+{
+public:
+
+	DelayLineUnitTest() :
+		UnitTest("Testing the DelayLine")
+	{
+
+	}
+
+	void runTest() override
+	{
+		testIntegerDelay(100, 64);
+		testIntegerDelay(3, 64);
+		testIntegerDelay(0, 64);
+		testBlocksLargerThanPrepared();
+		testFractionalDelay();
+		testModulatedDelay();
+		testCrossfade();
+		testMaximumDelay();
+	}
+
+private:
+
+	enum
+	{
+		SampleRate = 44100,
+		BlockSize = 64
+	};
+
+	/** Processes the signal in place with the given block size. */
+	static void process(DelayLine &d, AudioSampleBuffer &b, int blockSize)
+	{
+		float *data = b.getWritePointer(0);
+
+		for (int i = 0; i < b.getNumSamples(); i += blockSize)
+		{
+			d.processBlock(data + i, data + i, jmin<int>(blockSize, b.getNumSamples() - i));
+		}
+	}
+
+	static void fillWithSine(AudioSampleBuffer &b, double delayInSamples)
+	{
+		for (int i = 0; i < b.getNumSamples(); i++)
+		{
+			const double t = (double)i - delayInSamples;
+
+			b.setSample(0, i, t >= 0.0 ? (float)std::sin(t * 0.05) : 0.0f);
+		}
+	}
+
+	void testIntegerDelay(int delayTime, int blockSize)
+	{
+		beginTest("Integer delay of " + String(delayTime) + " samples");
+
+		DelayLine d;
+		d.setDelayTimeSamples(delayTime);
+		d.prepareToPlay(SampleRate, blockSize);
+
+		AudioSampleBuffer b(1, 1024);
+		b.clear();
+		b.setSample(0, 5, 1.0f);
+
+		process(d, b, blockSize);
+
+		expectEquals<float>(b.getSample(0, 5 + delayTime), 1.0f, "Impulse at the delayed position");
+		expectEquals<float>(b.getMagnitude(0, 0, 1024), 1.0f, "No other values");
+	}
+
+	void testBlocksLargerThanPrepared()
+	{
+		beginTest("Blocks that are larger than the prepared block size");
+
+		DelayLine d;
+		d.setDelayTimeSamples(10);
+		d.prepareToPlay(SampleRate, 16);
+
+		AudioSampleBuffer b(1, 1000);
+		b.clear();
+		b.setSample(0, 500, 1.0f);
+
+		process(d, b, 1000);
+
+		expectEquals<float>(b.getSample(0, 510), 1.0f, "Impulse at the delayed position");
+	}
+
+	void testFractionalDelay()
+	{
+		beginTest("Fractional delay");
+
+		const double delayTime = 20.37;
+
+		DelayLine d;
+		d.setDelayTimeSamples(delayTime);
+		d.prepareToPlay(SampleRate, BlockSize);
+
+		AudioSampleBuffer b(1, 1024);
+		AudioSampleBuffer expected(1, 1024);
+
+		fillWithSine(b, 0.0);
+		fillWithSine(expected, delayTime);
+
+		process(d, b, BlockSize);
+
+		float maxError = 0.0f;
+
+		for (int i = 100; i < 1024; i++)
+			maxError = jmax<float>(maxError, std::abs(b.getSample(0, i) - expected.getSample(0, i)));
+
+		expect(maxError < 0.0001f, "Interpolation error too high: " + String(maxError));
+	}
+
+	void testModulatedDelay()
+	{
+		beginTest("Modulated delay");
+
+		DelayLine d;
+		d.prepareToPlay(SampleRate, BlockSize);
+
+		AudioSampleBuffer b(1, 1024);
+		AudioSampleBuffer delayTimes(1, 1024);
+
+		fillWithSine(b, 0.0);
+
+		// A slow sweep from 10 to 30 samples
+		for (int i = 0; i < 1024; i++)
+			delayTimes.setSample(0, i, 10.0f + 20.0f * (float)i / 1024.0f);
+
+		float *data = b.getWritePointer(0);
+
+		for (int i = 0; i < 1024; i += BlockSize)
+			d.processBlockWithModulation(data + i, data + i, delayTimes.getReadPointer(0, i), BlockSize);
+
+		float maxError = 0.0f;
+
+		for (int i = 100; i < 1024; i++)
+		{
+			const double t = (double)i - (double)delayTimes.getSample(0, i);
+			maxError = jmax<float>(maxError, std::abs(b.getSample(0, i) - (float)std::sin(t * 0.05)));
+		}
+
+		expect(maxError < 0.0001f, "Interpolation error too high: " + String(maxError));
+	}
+
+	void testCrossfade()
+	{
+		beginTest("Crossfade when the delay time changes");
+
+		DelayLine d;
+		d.setDelayTimeSamples(10);
+		d.setFadeTimeSamples(2 * BlockSize);
+		d.prepareToPlay(SampleRate, BlockSize);
+
+		AudioSampleBuffer b(1, 1024);
+		AudioSampleBuffer expected(1, 1024);
+
+		fillWithSine(b, 0.0);
+		fillWithSine(expected, 10.0);
+
+		float *data = b.getWritePointer(0);
+
+		for (int i = 0; i < 1024; i += BlockSize)
+		{
+			// The second change happens during the first crossfade and must be applied after it.
+			if (i == 512) d.setDelayTimeSamples(30);
+			if (i == 512 + BlockSize) d.setDelayTimeSamples(40);
+
+			d.processBlock(data + i, data + i, BlockSize);
+		}
+
+		for (int i = 100; i < 512; i++)
+			expectWithinAbsoluteError<float>(b.getSample(0, i), expected.getSample(0, i), 0.00001f);
+
+		fillWithSine(expected, 40.0);
+
+		for (int i = 512 + 4 * BlockSize; i < 1024; i++)
+			expectWithinAbsoluteError<float>(b.getSample(0, i), expected.getSample(0, i), 0.00001f);
+
+		float maxStep = 0.0f;
+
+		for (int i = 101; i < 1024; i++)
+			maxStep = jmax<float>(maxStep, std::abs(b.getSample(0, i) - b.getSample(0, i - 1)));
+
+		expect(maxStep < 0.1f, "The crossfade has a discontinuity: " + String(maxStep));
+	}
+
+	void testMaximumDelay()
+	{
+		beginTest("Delay times above the maximum are limited");
+
+		DelayLine d;
+		d.setMaxDelaySeconds(0.01);
+		d.setDelayTimeSeconds(1.0);
+		d.prepareToPlay(SampleRate, BlockSize);
+
+		const int maxDelay = (int)d.getMaxDelaySamples();
+
+		expectEquals<int>(maxDelay, 441);
+
+		AudioSampleBuffer b(1, 2048);
+		b.clear();
+		b.setSample(0, 0, 1.0f);
+
+		process(d, b, BlockSize);
+
+		expectEquals<float>(b.getSample(0, maxDelay), 1.0f, "Impulse at the maximum delay");
+	}
+};
+
+static DelayLineUnitTest delayLineUnitTest;
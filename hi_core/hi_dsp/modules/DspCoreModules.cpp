@@ -0,0 +1,175 @@
+/*
+  ==============================================================================
+
+    DspCoreModules.cpp
+    Created: 10 Jul 2016 1:00:04pm
+    Author:  Christoph
+
+  ==============================================================================
+*/
+
+DelayLine::DelayLine() :
+	targetDelayTime(0.0),
+	fadeTimeSamples(1024),
+	sampleRate(44100.0), // better safe than sorry...
+	maxDelaySeconds(1.5),
+	maxDelaySamples(0.0),
+	mask(0),
+	maxChunkSize(0),
+	writeIndex(0),
+	currentDelayTime(0.0),
+	oldDelayTime(0.0),
+	fadeCounter(-1),
+	fadeLength(1024)
+{
+}
+
+void DelayLine::prepareToPlay(double sampleRate_, int maxBlockSize)
+{
+	sampleRate = sampleRate_;
+
+	maxDelaySamples = jmax<double>(1.0, std::floor(maxDelaySeconds * sampleRate));
+	maxChunkSize = jmax<int>(1, maxBlockSize);
+
+	// The buffer must hold the longest delay plus the chunk that is written before it is read
+	// (and the neighbours for the interpolation).
+	const int bufferSize = nextPowerOfTwo((int)maxDelaySamples + maxChunkSize + 4);
+
+	buffer.calloc(bufferSize);
+	mask = bufferSize - 1;
+
+	writeIndex = 0;
+	fadeCounter = -1;
+
+	currentDelayTime = limitDelayTime(targetDelayTime.load());
+	oldDelayTime = currentDelayTime;
+}
+
+void DelayLine::clear()
+{
+	if (buffer != nullptr)
+		FloatVectorOperations::clear(buffer, mask + 1);
+
+	fadeCounter = -1;
+}
+
+void DelayLine::processBlock(const float *input, float *output, int numSamples) noexcept
+{
+	if (buffer == nullptr)
+	{
+		FloatVectorOperations::clear(output, numSamples);
+		return;
+	}
+
+	if (fadeCounter < 0)
+	{
+		const double newDelayTime = limitDelayTime(targetDelayTime.load());
+
+		if (newDelayTime != currentDelayTime)
+		{
+			oldDelayTime = currentDelayTime;
+			currentDelayTime = newDelayTime;
+
+			fadeLength = fadeTimeSamples.load();
+			fadeCounter = 0;
+		}
+	}
+
+	for (int i = 0; i < numSamples; i += maxChunkSize)
+	{
+		const int numThisTime = jmin<int>(maxChunkSize, numSamples - i);
+
+		processChunk(input + i, output + i, numThisTime);
+	}
+}
+
+void DelayLine::processBlockWithModulation(const float *input, float *output, const float *delayTimesInSamples, int numSamples) noexcept
+{
+	if (buffer == nullptr)
+	{
+		FloatVectorOperations::clear(output, numSamples);
+		return;
+	}
+
+	while (numSamples > 0)
+	{
+		const int numThisTime = jmin<int>(maxChunkSize, numSamples);
+
+		writeChunk(input, numThisTime);
+
+		for (int i = 0; i < numThisTime; i++)
+		{
+			const double delayTime = jlimit<double>(1.0, maxDelaySamples, (double)delayTimesInSamples[i]);
+
+			output[i] = readInterpolated(i, delayTime);
+		}
+
+		writeIndex = (writeIndex + numThisTime) & mask;
+
+		input += numThisTime;
+		output += numThisTime;
+		delayTimesInSamples += numThisTime;
+		numSamples -= numThisTime;
+	}
+}
+
+void DelayLine::processChunk(const float *input, float *output, int numSamples) noexcept
+{
+	// The input is written first, so the output can be the same buffer and a delay shorter than the block still works.
+	writeChunk(input, numSamples);
+
+	int offset = 0;
+
+	while (fadeCounter >= 0 && offset < numSamples)
+	{
+		float oldValue, newValue;
+
+		readChunk(&oldValue, offset, 1, oldDelayTime);
+		readChunk(&newValue, offset, 1, currentDelayTime);
+
+		const float mix = (float)fadeCounter / (float)fadeLength;
+
+		output[offset++] = newValue * mix + oldValue * (1.0f - mix);
+
+		if (++fadeCounter >= fadeLength)
+			fadeCounter = -1;
+	}
+
+	if (offset < numSamples)
+		readChunk(output + offset, offset, numSamples - offset, currentDelayTime);
+
+	writeIndex = (writeIndex + numSamples) & mask;
+}
+
+void DelayLine::writeChunk(const float *input, int numSamples) noexcept
+{
+	const int bufferSize = mask + 1;
+	const int numBeforeWrap = jmin<int>(numSamples, bufferSize - writeIndex);
+
+	FloatVectorOperations::copy(buffer + writeIndex, input, numBeforeWrap);
+
+	if (numBeforeWrap < numSamples)
+		FloatVectorOperations::copy(buffer, input + numBeforeWrap, numSamples - numBeforeWrap);
+}
+
+void DelayLine::readChunk(float *output, int offset, int numSamples, double delayInSamples) const noexcept
+{
+	const int integerDelay = (int)delayInSamples;
+
+	if ((double)integerDelay == delayInSamples)
+	{
+		const int bufferSize = mask + 1;
+		const int readIndex = (writeIndex + offset - integerDelay) & mask;
+		const int numBeforeWrap = jmin<int>(numSamples, bufferSize - readIndex);
+
+		FloatVectorOperations::copy(output, buffer + readIndex, numBeforeWrap);
+
+		if (numBeforeWrap < numSamples)
+			FloatVectorOperations::copy(output + numBeforeWrap, buffer, numSamples - numBeforeWrap);
+	}
+	else
+	{
+		for (int i = 0; i < numSamples; i++)
+			output[i] = readInterpolated(offset + i, delayInSamples);
+	}
+}
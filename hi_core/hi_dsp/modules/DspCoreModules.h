@@ -13,136 +13,122 @@
 
 
 
-#define DELAY_BUFFER_SIZE 65536
-#define DELAY_BUFFER_MASK 65536-1
-
+/** A delay line that processes blocks and supports fractional and modulated delay times.
+*
+*	The delay time can be changed from any thread without a lock: the new value is stored in an atomic variable and
+*	picked up by the audio thread at the start of the next block. A change of the delay time crossfades between the
+*	old and the new read position (a change during a crossfade is applied after the crossfade has finished).
+*
+*	Fractional delay times are read with a 4-point Hermite interpolation. processBlockWithModulation() takes a
+*	delay time for every sample, so it can be used for modulated delays and chorus effects.
+*
+*	The buffer is allocated in prepareToPlay() and holds the maximum delay time plus one block, so call
+*	setMaxDelaySeconds() before prepareToPlay() if you need more than the default of 1.5 seconds.
+*/
 class DelayLine
 {
 public:
 
-	DelayLine() :
-		readIndex(0),
-		oldReadIndex(0),
-		writeIndex(0),
-		lastIgnoredDelayTime(-1),
-		sampleRate(44100.0), // better safe than sorry...
-		currentDelayTime(0),
-		fadeCounter(-1),
-		fadeTimeSamples(1024)
-	{
-		FloatVectorOperations::clear(delayBuffer, DELAY_BUFFER_SIZE);
-	}
+	DelayLine();
 
-	void prepareToPlay(double sampleRate_)
-	{
-		SpinLock::ScopedLockType sl(processLock);
+	/** Sets the longest delay time that can be used. This will be applied with the next call to prepareToPlay(). */
+	void setMaxDelaySeconds(double newMaxDelaySeconds) noexcept { maxDelaySeconds = jmax<double>(0.0, newMaxDelaySeconds); }
 
-		sampleRate = sampleRate_;
-	}
+	/** Allocates and clears the buffer. This must not be called while the delay line is processed. */
+	void prepareToPlay(double sampleRate_, int maxBlockSize);
 
-	void setDelayTimeSeconds(double delayInSeconds)
-	{
-		setDelayTimeSamples((int)(delayInSeconds * sampleRate));
-	}
+	/** Clears the buffer. This must not be called while the delay line is processed. */
+	void clear();
 
-	void setDelayTimeSamples(int delayInSamples)
+	/** Sets the delay time. This can be called from any thread. */
+	void setDelayTimeSeconds(double delayInSeconds) noexcept
 	{
-		SpinLock::ScopedLockType sl(processLock);
-
-		setInternalDelayTime(delayInSamples);
+		setDelayTimeSamples(delayInSeconds * sampleRate);
 	}
 
-	void setFadeTimeSamples(int newFadeTimeInSamples)
+	/** Sets the delay time in (fractional) samples. This can be called from any thread. */
+	void setDelayTimeSamples(double delayInSamples) noexcept
 	{
-		SpinLock::ScopedLockType sl(processLock);
-
-		fadeTimeSamples = newFadeTimeInSamples;
+		targetDelayTime.store(delayInSamples);
 	}
 
-	float getDelayedValue(float inputValue)
+	/** Sets the length of the crossfade that is used when the delay time changes. This can be called from any thread. */
+	void setFadeTimeSamples(int newFadeTimeInSamples) noexcept
 	{
-		SpinLock::ScopedLockType sl(processLock);
-
-		delayBuffer[writeIndex++] = inputValue;
-
-		if (fadeCounter < 0)
-		{
-			const float returnValue = delayBuffer[readIndex++];
-
-			readIndex &= DELAY_BUFFER_MASK;
-			writeIndex &= DELAY_BUFFER_MASK;
-			return returnValue;
-		}
-		else
-		{
-			const float oldValue = delayBuffer[oldReadIndex++];
-			const float newValue = delayBuffer[readIndex++];
+		fadeTimeSamples.store(jmax<int>(1, newFadeTimeInSamples));
+	}
 
-			const float mix = (float)fadeCounter / (float)fadeTimeSamples;
+	/** Returns the longest delay time in samples that the buffer can hold. */
+	double getMaxDelaySamples() const noexcept { return maxDelaySamples; }
 
-			const float returnValue = newValue * mix + oldValue * (1.0f - mix);
+	/** Writes the input into the delay line and the delayed signal into the output. The buffers can be the same. */
+	void processBlock(const float *input, float *output, int numSamples) noexcept;
 
-			oldReadIndex &= DELAY_BUFFER_MASK;
-			readIndex &= DELAY_BUFFER_MASK;
-			writeIndex &= DELAY_BUFFER_MASK;
+	/** Like processBlock(), but uses the delay time (in samples) from the given buffer for every sample.
+	*
+	*	This ignores the delay time that was set with setDelayTimeSamples() and doesn't use a crossfade.
+	*/
+	void processBlockWithModulation(const float *input, float *output, const float *delayTimesInSamples, int numSamples) noexcept;
 
-			fadeCounter++;
+private:
 
-			if (fadeCounter >= fadeTimeSamples)
-			{
-				fadeCounter = -1;
-				if (lastIgnoredDelayTime != 0)
-				{
-					setInternalDelayTime(lastIgnoredDelayTime);
-				}
-			}
+	void processChunk(const float *input, float *output, int numSamples) noexcept;
 
-			return returnValue;
-		}
-	}
+	/** Copies the input into the buffer without advancing the write position. */
+	void writeChunk(const float *input, int numSamples) noexcept;
 
-private:
+	/** Reads the samples that are delayed by the given amount relative to the current write position. */
+	void readChunk(float *output, int offset, int numSamples, double delayInSamples) const noexcept;
 
-	void setInternalDelayTime(int delayInSamples)
+	/** Reads the sample at the position (writeIndex + offset - delayInSamples). The delay must be at least 1 sample. */
+	float readInterpolated(int offset, double delayInSamples) const noexcept
 	{
-		delayInSamples = jmin<int>(delayInSamples, DELAY_BUFFER_SIZE - 1);
+		const int integerDelay = (int)delayInSamples;
+		const float alpha = 1.0f - (float)(delayInSamples - (double)integerDelay);
 
-		if (fadeCounter != -1)
-		{
-			lastIgnoredDelayTime = delayInSamples;
-			return;
-		}
-		else
-		{
-			lastIgnoredDelayTime = 0;
-		}
+		const int i = writeIndex + offset - integerDelay;
 
-		currentDelayTime = delayInSamples;
+		const float ym1 = buffer[(i - 2) & mask];
+		const float y0 = buffer[(i - 1) & mask];
+		const float y1 = buffer[i & mask];
+		const float y2 = buffer[(i + 1) & mask];
 
-		oldReadIndex = readIndex;
+		const float c1 = 0.5f * (y1 - ym1);
+		const float c2 = ym1 - 2.5f * y0 + 2.0f * y1 - 0.5f * y2;
+		const float c3 = 0.5f * (y2 - ym1) + 1.5f * (y0 - y1);
 
-		fadeCounter = 0;
+		return ((c3 * alpha + c2) * alpha + c1) * alpha + y0;
+	}
+
+	double limitDelayTime(double delayInSamples) const noexcept
+	{
+		// Fractional delay times need the next sample for the interpolation.
+		if (delayInSamples < 1.0)
+			return jmax<double>(0.0, (double)roundToInt(delayInSamples));
 
-		readIndex = (writeIndex - delayInSamples) & DELAY_BUFFER_MASK;
+		return jmin<double>(delayInSamples, maxDelaySamples);
 	}
 
-	SpinLock processLock;
+	std::atomic<double> targetDelayTime;
+	std::atomic<int> fadeTimeSamples;
 
-	double maxDelayTime;
-	int currentDelayTime;
 	double sampleRate;
+	double maxDelaySeconds;
+	double maxDelaySamples;
 
-	int lastIgnoredDelayTime;
+	HeapBlock<float> buffer;
+	int mask;
+	int maxChunkSize;
 
-	float delayBuffer[DELAY_BUFFER_SIZE];
-
-	int readIndex;
-	int oldReadIndex;
 	int writeIndex;
 
+	double currentDelayTime;
+	double oldDelayTime;
+
 	int fadeCounter;
+	int fadeLength;
 
-	int fadeTimeSamples;
+	JUCE_DECLARE_NON_COPYABLE(DelayLine)
 };
 
 
@@ -104,9 +104,16 @@ public:
 	{ 
 		if(isBypassed()) return;
 
-        ADD_GLITCH_DETECTOR("Rendering voice effects for" + parentProcessor->getId());
+        ADD_GLITCH_DETECTOR(this, "Rendering voice effects for" + parentProcessor->getId());
         
-		FOR_EACH_VOICE_EFFECT(renderVoice(voiceIndex, b, startSample, numSamples)); 
+		for (int i = 0; i < voiceEffects.size(); ++i)
+		{
+			if (!voiceEffects[i]->isBypassed())
+			{
+				ProcessorProfiler::ScopedSection profiledEffect(voiceEffects[i]);
+				voiceEffects[i]->renderVoice(voiceIndex, b, startSample, numSamples);
+			}
+		}
 	};
 
 	void renderNextBlock(AudioSampleBuffer &buffer, int startSample, int numSamples) override
@@ -140,9 +147,16 @@ public:
 	{
 		if(isBypassed()) return;
 
-        ADD_GLITCH_DETECTOR("Rendering master effects for" + parentProcessor->getId());
+        ADD_GLITCH_DETECTOR(this, "Rendering master effects for" + parentProcessor->getId());
         
-		FOR_EACH_MASTER_EFFECT(renderWholeBuffer(b));
+		for (int i = 0; i < masterEffects.size(); ++i)
+		{
+			if (!masterEffects[i]->isBypassed())
+			{
+				ProcessorProfiler::ScopedSection profiledEffect(masterEffects[i]);
+				masterEffects[i]->renderWholeBuffer(b);
+			}
+		}
 
 #if ENABLE_ALL_PEAK_METERS
 		currentValues.outL = (b.getMagnitude(0, 0, b.getNumSamples()));
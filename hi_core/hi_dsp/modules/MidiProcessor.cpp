@@ -56,6 +56,11 @@ void MidiProcessor::addHiseEventToBuffer(const HiseEvent &m)
 	
 }
 
+void MidiProcessor::addHiseEventToBuffer(const HiseEvent &m, int delayInSamples)
+{
+	ownerSynth->midiProcessorChain->addArtificialEvent(m, delayInSamples);
+}
+
 ProcessorEditorBody *MidiProcessor::createEditor(ProcessorEditor *parentEditor)
 {
 #if USE_BACKEND
@@ -88,9 +93,9 @@ ProcessorEditorBody *MidiProcessorChain::createEditor(ProcessorEditor *parentEdi
 
 
 
-void MidiProcessorChain::addArtificialEvent(const HiseEvent& m)
+void MidiProcessorChain::addArtificialEvent(const HiseEvent& m, int delayInSamples)
 {
-	const int timeStamp = (int)m.getTimeStamp();
+	const int64 timeStamp = (int64)m.getTimeStamp() + (int64)delayInSamples;
 
 	//jassert(m.isArtificial());
 
@@ -98,11 +103,14 @@ void MidiProcessorChain::addArtificialEvent(const HiseEvent& m)
 
 	if (timeStamp > thisBlockSize)
 	{
-		futureEventBuffer.addEvent(m);
+		scheduledEvents.addEvent(m, timeStamp);
 	}
 	else
 	{
-		artificialEvents.addEvent(m);
+		HiseEvent e(m);
+		e.setTimeStamp((uint16)timeStamp);
+
+		artificialEvents.addEvent(e);
 	}
 }
 
@@ -115,7 +123,11 @@ void MidiProcessorChain::renderNextHiseEventBuffer(HiseEventBuffer &buffer, int
 		allNotesOffAtNextBuffer = false;
 	}
 
-	if (buffer.isEmpty() && futureEventBuffer.isEmpty() && artificialEvents.isEmpty()) return;
+	if (buffer.isEmpty() && scheduledEvents.isEmpty() && artificialEvents.isEmpty())
+	{
+		scheduledEvents.advance(numSamples);
+		return;
+	}
 
 	HiseEventBuffer::Iterator it(buffer);
 
@@ -128,11 +140,22 @@ void MidiProcessorChain::renderNextHiseEventBuffer(HiseEventBuffer &buffer, int
 	artificialEvents.clear();
 
 
-	futureEventBuffer.subtractFromTimeStamps(numSamples);
-	futureEventBuffer.moveEventsBelow(buffer, numSamples);
+	scheduledEvents.moveDueEvents(buffer, numSamples);
 
+	// Events that were delayed beyond this block (eg. with Message.delayEvent())
+	buffer.moveEventsAbove(lateEvents, numSamples);
+
+	if (!lateEvents.isEmpty())
+	{
+		HiseEventBuffer::Iterator lateIter(lateEvents);
+
+		while (const HiseEvent* e = lateIter.getNextConstEventPointer())
+			scheduledEvents.addEvent(*e, e->getTimeStamp());
+
+		lateEvents.clear();
+	}
 
-	buffer.moveEventsAbove(futureEventBuffer, numSamples);
+	scheduledEvents.advance(numSamples);
 }
 
 MidiProcessorFactoryType::MidiProcessorFactoryType(Processor *p) :
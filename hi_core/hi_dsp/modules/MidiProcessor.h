@@ -54,6 +54,9 @@ public:
 
 	void addHiseEventToBuffer(const HiseEvent &m);
 
+	/** Adds the event with a delay that is added to its timestamp. Unlike the 16 bit timestamp, the delay can be any length. */
+	void addHiseEventToBuffer(const HiseEvent &m, int delayInSamples);
+
 	Colour getColour() const
     {
         return Colour(0xFFC65638);
@@ -181,7 +184,8 @@ public:
 
 	ProcessorEditorBody *createEditor(ProcessorEditor *parentEditor)  override;
 
-	void addArtificialEvent(const HiseEvent& m);
+	/** Adds an event that is not processed by this chain. The delay is added to the timestamp of the event. */
+	void addArtificialEvent(const HiseEvent& m, int delayInSamples=0);
 
 	void sendAllNoteOffEvent()
 	{
@@ -283,8 +287,9 @@ private:
 
 	OwnedArray<MidiProcessor> processors;
 
-	HiseEventBuffer futureEventBuffer;
+	HiseEventScheduler scheduledEvents;
 	HiseEventBuffer artificialEvents;
+	HiseEventBuffer lateEvents;
 
 };
 
@@ -35,8 +35,14 @@ ModulatorChain::ModulatorChain(MainController *mc, const String &uid, int numVoi
 	Modulation(m),
 	handler(this),
 	parentProcessor(p),
+	blockSize(0),
+	controlRateDivider(HISE_CONTROL_RATE_DIVIDER),
+	requestedControlRateDivider(HISE_CONTROL_RATE_DIVIDER),
+	dividerUpdater(*this),
 	isVoiceStartChain(false)
 {
+	parameterNames.add("ControlRateDivider");
+
 	activeVoices.setRange(0, numVoices, false);
 	setFactoryType(new ModulatorChainFactoryType(numVoices, m, p));
 
@@ -136,6 +142,7 @@ void ModulatorChain::startVoice(int voiceIndex)
 	{
 		envelopeModulators[i]->startVoice(voiceIndex);
 		envelopeModulators[i]->polyManager.setLastStartedVoice(voiceIndex);
+		envelopeModulators[i]->resetControlRateState(voiceIndex);
 	}
 
 	const float startValue = getConstantVoiceValue(voiceIndex);
@@ -164,7 +171,7 @@ void ModulatorChain::renderAllModulatorsAsMonophonic(AudioSampleBuffer &buffer,
 		
 	renderNextBlock(buffer, startSample, numSamples);
 	renderVoice(0, startSample, numSamples);
-	FloatVectorOperations::multiply(buffer.getWritePointer(0, startSample), getVoiceValues(0), numSamples);
+	FloatVectorOperations::multiply(buffer.getWritePointer(0, startSample), getVoiceValues(0) + startSample, numSamples);
 };
 
 void ModulatorChain::prepareToPlay(double sampleRate, int samplesPerBlock)
@@ -175,12 +182,97 @@ void ModulatorChain::prepareToPlay(double sampleRate, int samplesPerBlock)
 	internalVoiceBuffer = AudioSampleBuffer(polyManager.getVoiceAmount(), samplesPerBlock);
 	envelopeTempBuffer = AudioSampleBuffer(1, samplesPerBlock);
 
-	for(int i = 0; i < envelopeModulators.size(); i++) envelopeModulators[i]->prepareToPlay(sampleRate, samplesPerBlock);
-	for(int i = 0; i < variantModulators.size(); i++) variantModulators[i]->prepareToPlay(sampleRate, samplesPerBlock);
+	for(int i = 0; i < envelopeModulators.size(); i++) prepareTimeModulator(envelopeModulators[i], envelopeModulators[i], sampleRate, samplesPerBlock);
+	for(int i = 0; i < variantModulators.size(); i++) prepareTimeModulator(variantModulators[i], variantModulators[i], sampleRate, samplesPerBlock);
 
 	jassert(checkModulatorStructure());
 };
 
+void ModulatorChain::prepareTimeModulator(Modulator *m, TimeModulation *tm, double sampleRate, int samplesPerBlock)
+{
+	tm->setControlRateDivider(tm->supportsControlRate() ? controlRateDivider : 1);
+
+	m->prepareToPlay(sampleRate / (double)tm->getControlRateDivider(), samplesPerBlock);
+}
+
+void ModulatorChain::setControlRateDividerForModulators(int newDivider)
+{
+	newDivider = jlimit<int>(1, 64, newDivider);
+
+	requestedControlRateDivider = newDivider;
+
+	if (newDivider == controlRateDivider)
+		return;
+
+	ScopedLock sl(getMainController()->getLock());
+
+	controlRateDivider = newDivider;
+
+	if (isInitialized())
+	{
+		prepareToPlay(getSampleRate(), blockSize);
+	}
+}
+
+void ModulatorChain::setInternalAttribute(int parameterIndex, float newValue)
+{
+	switch (parameterIndex)
+	{
+	case ControlRateDivider:
+	{
+		requestedControlRateDivider = jlimit<int>(1, 64, (int)newValue);
+
+		if (requestedControlRateDivider == controlRateDivider)
+			return;
+
+		// Preparing the modulators allocates, so this is deferred if the attribute is changed by the audio thread
+		if (MessageManager::getInstance()->isThisTheMessageThread())
+			setControlRateDividerForModulators(requestedControlRateDivider);
+		else
+			dividerUpdater.triggerAsyncUpdate();
+
+		break;
+	}
+	default: jassertfalse;
+	}
+}
+
+float ModulatorChain::getAttribute(int parameterIndex) const
+{
+	switch (parameterIndex)
+	{
+	case ControlRateDivider:	return (float)requestedControlRateDivider;
+	default:					jassertfalse; return -1.0f;
+	}
+}
+
+float ModulatorChain::getDefaultValue(int parameterIndex) const
+{
+	switch (parameterIndex)
+	{
+	case ControlRateDivider:	return (float)HISE_CONTROL_RATE_DIVIDER;
+	default:					jassertfalse; return 1.0f;
+	}
+}
+
+ValueTree ModulatorChain::exportAsValueTree() const
+{
+	ValueTree v = EnvelopeModulator::exportAsValueTree();
+
+	// Only chains that differ from the default store the divider, so existing presets don't change
+	if (requestedControlRateDivider != HISE_CONTROL_RATE_DIVIDER)
+		saveAttribute(ControlRateDivider, "ControlRateDivider");
+
+	return v;
+}
+
+void ModulatorChain::restoreFromValueTree(const ValueTree &v)
+{
+	EnvelopeModulator::restoreFromValueTree(v);
+
+	loadAttributeWithDefault(ControlRateDivider);
+}
+
 float ModulatorChain::calculateNewValue()
 {
 	jassertfalse;
@@ -228,7 +320,7 @@ void ModulatorChain::ModulatorChainHandler::addModulator(Modulator *newModulator
 	{
 		EnvelopeModulator *m = static_cast<EnvelopeModulator*>(newModulator);
 		chain->envelopeModulators.add(m);
-		if(chain->isInitialized()) m->prepareToPlay(chain->getSampleRate(), chain->blockSize);
+		if(chain->isInitialized()) chain->prepareTimeModulator(m, m, chain->getSampleRate(), chain->blockSize);
 	}
 	else if (dynamic_cast<TimeVariantModulator*>(newModulator) != nullptr)
 	{
@@ -236,7 +328,7 @@ void ModulatorChain::ModulatorChainHandler::addModulator(Modulator *newModulator
 		chain->variantModulators.add(m);
 
 		if (chain->isInitialized())
-			m->prepareToPlay(chain->getSampleRate(), chain->blockSize);   
+			chain->prepareTimeModulator(m, m, chain->getSampleRate(), chain->blockSize);
 	}
 	else jassertfalse;
 		
@@ -370,7 +462,7 @@ ProcessorEditorBody *ModulatorChain::createEditor(ProcessorEditor *parentEditor)
 
 void ModulatorChain::renderVoice(int voiceIndex, int startSample, int numSamples)
 {
-    ADD_GLITCH_DETECTOR("Rendering " + getId() + " voices for " + parentProcessor->getId());
+    ADD_GLITCH_DETECTOR(this, "Rendering " + getId() + " voices for " + parentProcessor->getId());
     
 	// Use the internal buffer from timeModulation as working buffer.
 
@@ -437,7 +529,7 @@ void ModulatorChain::renderVoice(int voiceIndex, int startSample, int numSamples
 
 void ModulatorChain::renderNextBlock(AudioSampleBuffer& buffer, int startSample, int numSamples)
 {
-    ADD_GLITCH_DETECTOR("Rendering time varian modulators for " + parentProcessor->getId());
+    ADD_GLITCH_DETECTOR(this, "Rendering time varian modulators for " + parentProcessor->getId());
     
 	jassert (getSampleRate() > 0);
 
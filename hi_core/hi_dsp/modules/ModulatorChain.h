@@ -71,6 +71,12 @@ public:
 
 	class ModulatorChainHandler;
 
+	enum Parameters
+	{
+		ControlRateDivider = 0, ///< **HISE_CONTROL_RATE_DIVIDER** (1 ... 64) | the downsampling factor for the modulators that support control rate
+		numParameters
+	};
+
 	/** Creates a new modulator chain. You have to specify the voice amount and the Modulation::Mode */
 	ModulatorChain(MainController *mc, const String &id, int numVoices, Modulation::Mode m, Processor *p);
 
@@ -148,9 +154,11 @@ public:
 	/** Calls the stopVoice function for all envelope modulators. */
 	void stopVoice(int voiceIndex) override;
 
-	void setInternalAttribute(int, float) override { jassertfalse; }; // nothing to do here!
+	void setInternalAttribute(int parameterIndex, float newValue) override;
 
-	float getAttribute(int) const override { jassertfalse; return -1.0; }; // nothing to do here!
+	float getAttribute(int parameterIndex) const override;
+
+	float getDefaultValue(int parameterIndex) const override;
 
 	/** Iterates all VoiceStartModulators and EnvelopeModulators and stores their values in the internal voice buffer.
 	*
@@ -196,6 +204,20 @@ public:
 	*/
 	void renderAllModulatorsAsMonophonic(AudioSampleBuffer &buffer, int startSample, int numSamples);
 
+	/** Renders the envelopes and time variant modulators at a fraction of the sample rate.
+	*
+	*	Only modulators that support control rate are affected (see TimeModulation::supportsControlRate()), the others
+	*	keep running at audio rate. A divider of 1 renders everything at audio rate. The default is HISE_CONTROL_RATE_DIVIDER.
+	*	This prepares the modulators again, so call it on the message thread or use the ControlRateDivider attribute.
+	*/
+	void setControlRateDividerForModulators(int newDivider);
+
+	int getControlRateDividerForModulators() const noexcept { return controlRateDivider; }
+
+	ValueTree exportAsValueTree() const override;
+
+	void restoreFromValueTree(const ValueTree &v) override;
+
 	/** This class handles the Modulators within the specified ModulatorChain.
 	*
 	*	You can get the handler for each Modulator with ModulatorChain::getHandler().
@@ -269,9 +291,29 @@ public:
 
 private:
 
+	/** Prepares the modulators with the new divider on the message thread if the attribute is changed on another thread. */
+	class AsyncDividerUpdater : public AsyncUpdater
+	{
+	public:
+
+		AsyncDividerUpdater(ModulatorChain &parent_) : parent(parent_) {};
+
+		void handleAsyncUpdate() override
+		{
+			parent.setControlRateDividerForModulators(parent.requestedControlRateDivider);
+		}
+
+	private:
+
+		ModulatorChain &parent;
+	};
+
 	// Checks if the Modulators are initialized correctly and are set to the right voices */
 	bool checkModulatorStructure();
 
+	// Sets the control rate divider of the modulator and prepares it with the reduced sample rate
+	void prepareTimeModulator(Modulator *m, TimeModulation *tm, double sampleRate, int samplesPerBlock);
+
 	BigInteger activeVoices;
 
 	// Saves 4 values of the envelope modulation result for later
@@ -333,6 +375,10 @@ private:
 	Array<Modulator*> allModulators;
 
 	int blockSize;
+
+	int controlRateDivider;
+	int requestedControlRateDivider;
+	AsyncDividerUpdater dividerUpdater;
 	
 	// the values of the envelope of the first voice is stored here to retrieve it at renderNextBlock...
 	float envelopeOutputValue1;
@@ -70,7 +70,8 @@ pitchModulationActive(false)
 	editorStateIdentifiers.add("PitchModulationShown");
 	editorStateIdentifiers.add("EffectChainShown");
 
-	setBalance(0.0f);
+	balance = 0.0f;
+	applyBalance(this, 0.0, 0, nullptr);
 
 	pitchChain->getFactoryType()->setConstrainer(new NoGlobalEnvelopeConstrainer());
 
@@ -82,6 +83,9 @@ pitchModulationActive(false)
 
 ModulatorSynth::~ModulatorSynth()
 {
+	// The owner should have done this before the subclass was destroyed
+	cancelAudioThreadCommands();
+
 	midiProcessorChain = nullptr;
 	gainChain = nullptr;
 	pitchChain = nullptr;
@@ -197,7 +201,7 @@ void ModulatorSynth::synthTimerCallback(uint8 index)
 {
 	if (index >= 0)
 	{
-		ADD_GLITCH_DETECTOR(getId() + " timer callback");
+		ADD_GLITCH_DETECTOR(nullptr, getId() + " timer callback");
 
 		const double thisUptime = getMainController()->getUptime() - (getBlockSize() / getSampleRate());
 		uint16 offsetInBuffer = (uint16)((nextTimerCallbackTimes[index] - thisUptime) * getSampleRate());
@@ -218,7 +222,7 @@ void ModulatorSynth::startSynthTimer(int index, double interval, int timeStamp)
 	{
 		nextTimerCallbackTimes[index] = 0.0;
 		jassertfalse;
-		debugToConsole(this, "Go easy on the timer!");
+		getMainController()->writeFormattedToConsole("Go easy on the timer!", 0, this);
 		return;
 	};
 
@@ -325,7 +329,7 @@ void ModulatorSynth::addProcessorsWhenEmpty()
 
 void ModulatorSynth::renderNextBlockWithModulators(AudioSampleBuffer& outputBuffer, const HiseEventBuffer& inputMidiBuffer)
 {
-    ADD_GLITCH_DETECTOR("Rendering " + getId());
+    ADD_GLITCH_DETECTOR(this, "Rendering " + getId());
     
 	int numSamples = outputBuffer.getNumSamples();
 
@@ -438,7 +442,7 @@ void ModulatorSynth::preVoiceRendering(int startSample, int numThisTime)
 
 void ModulatorSynth::renderVoice(int startSample, int numThisTime)
 {
-    ADD_GLITCH_DETECTOR("Rendering voices for " + getId());
+    ADD_GLITCH_DETECTOR(nullptr, "Rendering voices for " + getId());
     
 	for (int i = voices.size(); --i >= 0;)
 	{
@@ -677,6 +681,8 @@ void ModulatorSynth::prepareToPlay(double newSampleRate, int samplesPerBlock)
 		pitchBuffer = AudioSampleBuffer(1, samplesPerBlock); // should be enough
 		internalBuffer = AudioSampleBuffer(getMatrix().getNumSourceChannels(), samplesPerBlock);
 		gainBuffer = AudioSampleBuffer(1, samplesPerBlock);
+
+		eventBuffer.ensureAllocatedSize(eventBuffer.getNumAllocated());
 		
 
 		for(int i = 0; i < getNumVoices(); i++)
@@ -741,15 +747,32 @@ void ModulatorSynth::numDestinationChannelsChanged()
 
 void ModulatorSynth::setBypassed(bool shouldBeBypassed) noexcept
 {
+	Processor::setBypassed(shouldBeBypassed);
+
+	callOnAudioThread(stopNotesAfterBypassChange);
+}
+
+void ModulatorSynth::cancelAudioThreadCommands()
+{
+	// The commands are executed while the audio thread holds this lock
 	ScopedLock sl(getSynthLock());
+	getMainController()->getAudioThreadCommandQueue().cancelCommandsFor(this);
+}
 
-	Processor::setBypassed(shouldBeBypassed);
+void ModulatorSynth::callOnAudioThread(AudioThreadCommandQueue::Function f, double value, int index)
+{
+	getMainController()->callOnAudioThread(f, this, value, index);
+}
 
-	midiProcessorChain->sendAllNoteOffEvent();
+void ModulatorSynth::stopNotesAfterBypassChange(void *synth, double, int, const void*)
+{
+	ModulatorSynth *s = static_cast<ModulatorSynth*>(synth);
 
-	for (int i = 0; i < getNumInternalChains(); i++)
+	s->midiProcessorChain->sendAllNoteOffEvent();
+
+	for (int i = 0; i < s->getNumInternalChains(); i++)
 	{
-		ModulatorChain *chain = dynamic_cast<ModulatorChain*>(getChildProcessor(i));
+		ModulatorChain *chain = dynamic_cast<ModulatorChain*>(s->getChildProcessor(i));
 
 		if (chain != nullptr)
 		{
@@ -757,7 +780,22 @@ void ModulatorSynth::setBypassed(bool shouldBeBypassed) noexcept
 		}
 	}
 
-	allNotesOff(1, false);
+	s->allNotesOff(1, false);
+}
+
+void ModulatorSynth::setBalance(float newBalance)
+{
+	balance = newBalance;
+
+	callOnAudioThread(applyBalance, (double)newBalance);
+}
+
+void ModulatorSynth::applyBalance(void *synth, double newBalance, int, const void*)
+{
+	ModulatorSynth *s = static_cast<ModulatorSynth*>(synth);
+
+	s->leftBalanceGain = BalanceCalculator::getGainFactorForBalance((float)newBalance * 100.0f, true);
+	s->rightBalanceGain = BalanceCalculator::getGainFactorForBalance((float)newBalance * 100.0f, false);
 }
 
 void ModulatorSynth::disableChain(InternalChains chainToDisable, bool shouldBeDisabled)
@@ -772,15 +810,29 @@ bool ModulatorSynth::isChainDisabled(InternalChains chain) const
 
 void ModulatorSynth::noteOn(const HiseEvent &m)
 {
-    ADD_GLITCH_DETECTOR("Note on callback for " + getId());
+    ADD_GLITCH_DETECTOR(nullptr, "Note on callback for " + getId());
     
     jassert(m.isNoteOn());
 
 	const int midiChannel = m.getChannel();
-	const int midiNoteNumber = m.getNoteNumber();
-	const int transposedMidiNoteNumber = midiNoteNumber + m.getTransposeAmount();
+	const int transposedMidiNoteNumber = m.getNoteNumber() + m.getTransposeAmount();
 	const float velocity = m.getFloatVelocity();
 
+	if (const Array<ModulatorSynthSound*> *candidates = getCandidateSounds(transposedMidiNoteNumber, m.getVelocity()))
+	{
+		for (int i = candidates->size(); --i >= 0;)
+		{
+			ModulatorSynthSound *sound = candidates->getUnchecked(i);
+
+			if (soundCanBePlayed(sound, midiChannel, transposedMidiNoteNumber, velocity))
+			{
+				startVoicesForSound(sound, m);
+			}
+		}
+
+		return;
+	}
+
     for (int i = sounds.size(); --i >= 0;)
     {
 		SynthesiserSound *s = sounds.getUnchecked(i);
@@ -788,46 +840,55 @@ void ModulatorSynth::noteOn(const HiseEvent &m)
 
 		if (soundCanBePlayed(sound, midiChannel, transposedMidiNoteNumber, velocity))
         {
-            // If hitting a note that's still ringing, stop it first (it could be
-            // still playing because of the sustain or sostenuto pedal).
-            for (int j = voices.size(); --j >= 0;)
-            {
-                ModulatorSynthVoice* const voice = static_cast<ModulatorSynthVoice*>(voices.getUnchecked (j));
+			startVoicesForSound(sound, m);
 
-				const bool voiceIsActive = voice->isPlayingChannel(midiChannel) && !voice->isBeingKilled();
+			// Deactivates starting of more than one voice per synth
+			//break;
+        }
+	}
+}
 
-				// if the voiceLimit is reached, kill the voice!
+void ModulatorSynth::startVoicesForSound(ModulatorSynthSound *sound, const HiseEvent &m)
+{
+	const int midiChannel = m.getChannel();
+	const int midiNoteNumber = m.getNoteNumber();
+	const int transposedMidiNoteNumber = midiNoteNumber + m.getTransposeAmount();
 
-				if(voiceIsActive && j >= (voiceLimit - 1)) 
-				{
-					killLastVoice();
-				}
+	// If hitting a note that's still ringing, stop it first (it could be
+	// still playing because of the sustain or sostenuto pedal).
+	for (int j = voices.size(); --j >= 0;)
+	{
+		ModulatorSynthVoice* const voice = static_cast<ModulatorSynthVoice*>(voices.getUnchecked (j));
 
-                else if (voice->getCurrentlyPlayingNote() == midiNoteNumber // Use the untransposed number for detecting repeated notes
-                     && voice->isPlayingChannel (midiChannel))
-				{
-					handleRetriggeredNote(voice);
-				}
-            }
+		const bool voiceIsActive = voice->isPlayingChannel(midiChannel) && !voice->isBeingKilled();
 
-			ModulatorSynthVoice *v = static_cast<ModulatorSynthVoice*>(findFreeVoice (sound, midiChannel, midiNoteNumber, isNoteStealingEnabled()));
+		// if the voiceLimit is reached, kill the voice!
 
-			if( v != nullptr)
-			{
-				const int voiceIndex = v->getVoiceIndex();
+		if(voiceIsActive && j >= (voiceLimit - 1)) 
+		{
+			killLastVoice();
+		}
 
-				jassert(voiceIndex != -1);
+		else if (voice->getCurrentlyPlayingNote() == midiNoteNumber // Use the untransposed number for detecting repeated notes
+				&& voice->isPlayingChannel (midiChannel))
+		{
+			handleRetriggeredNote(voice);
+		}
+	}
 
-				v->setStartUptime(getMainController()->getUptime());
+	ModulatorSynthVoice *v = static_cast<ModulatorSynthVoice*>(findFreeVoice (sound, midiChannel, midiNoteNumber, isNoteStealingEnabled()));
 
-				preStartVoice(voiceIndex, transposedMidiNoteNumber);
+	if( v != nullptr)
+	{
+		const int voiceIndex = v->getVoiceIndex();
 
-				startVoiceWithHiseEvent (v, sound, m);
-			}
+		jassert(voiceIndex != -1);
 
-			// Deactivates starting of more than one voice per synth
-			//break;
-        }
+		v->setStartUptime(getMainController()->getUptime());
+
+		preStartVoice(voiceIndex, transposedMidiNoteNumber);
+
+		startVoiceWithHiseEvent (v, sound, m);
 	}
 }
 
@@ -146,6 +146,12 @@ public:
 	*/
 	virtual void renderNextBlockWithModulators(AudioSampleBuffer& outputAudio, const HiseEventBuffer& inputMidi);
 
+	/** Return false if other synths depend on the output of this synth (or vice versa).
+	*
+	*	A ModulatorSynthChain with parallel rendering enabled renders these synths on the audio thread before the other children.
+	*/
+	virtual bool canBeRenderedInParallel() const { return true; }
+
 	/** This method is called to handle all modulatorchains just before the voice rendering. */
 	virtual void preVoiceRendering(int startSample, int numThisTime);;
 
@@ -224,6 +230,13 @@ public:
 	/** Checks if the message fits the sound, but can be overriden to implement other group start logic. */
 	virtual bool soundCanBePlayed(ModulatorSynthSound *sound, int midiChannel, int midiNoteNumber, float velocity);
 
+	/** Returns a precalculated list of sounds that might fit the given note / velocity or nullptr if all sounds need to be checked.
+	*
+	*	Override this if the synth has a lot of sounds and can narrow down the sounds that are checked in the note on callback.
+	*	The sounds in the list are still checked with soundCanBePlayed().
+	*/
+	virtual const Array<ModulatorSynthSound*> *getCandidateSounds(int /*noteNumber*/, int /*velocity*/) const { return nullptr; }
+
 	void startVoiceWithHiseEvent(ModulatorSynthVoice* voice, SynthesiserSound *sound, const HiseEvent &e);
 
 	/** Same functionality as Synthesiser::noteOn(), but calls calculateVoiceStartValue() if a new voice is started. */
@@ -255,15 +268,7 @@ public:
 	};
 
 	/** sets the balance from -1.0 (left) to 1.0 (right) and applies a equal power pan rule. */
-	void setBalance(float newBalance)
-	{
-		ScopedLock sl(getSynthLock());
-
-		balance = newBalance;
-
-		leftBalanceGain = BalanceCalculator::getGainFactorForBalance((balance * 100.0f), true);
-		rightBalanceGain = BalanceCalculator::getGainFactorForBalance((balance * 100.0f), false);
-	};
+	void setBalance(float newBalance);
 
 	/** Returns the calculated (equal power) pan value for either the left or the right channel. */
 	float getBalance(bool getRightChannelGain) const 
@@ -313,6 +318,13 @@ public:
 	/** Returns the pointer to the calculated pitch buffers for the ModulatorSynthVoice's render callback. */
 	const float *getConstantPitchValues() const { return pitchBuffer.getReadPointer(0);	};
 
+	/** Removes the commands that this synth has pushed to the audio thread and that are not executed yet.
+	*
+	*	Call this before the synth is deleted: the destructor of ModulatorSynth runs after the subclass was destroyed,
+	*	and a command must not be executed on a half-destroyed synth.
+	*/
+	void cancelAudioThreadCommands();
+
 	/** returns the lock the synth is using. */
 	const CriticalSection &getSynthLock() const
 	{
@@ -369,6 +381,13 @@ public:
 
 protected:
 
+	/** Executes the function on the audio thread before the next block is rendered.
+	*
+	*	The object pointer that is passed to the function is this synth as ModulatorSynth*, so cast it back with
+	*	static_cast<ModulatorSynth*>() first. Pending commands are cancelled when the synth is deleted.
+	*/
+	void callOnAudioThread(AudioThreadCommandQueue::Function f, double value=0.0, int index=0);
+
 	bool checkTimerCallback(int timerIndex) const noexcept
 	{
 		return nextTimerCallbackTimes[timerIndex] != 0.0 && (getMainController()->getUptime() > nextTimerCallbackTimes[timerIndex]);
@@ -379,6 +398,15 @@ protected:
 
 private:
 
+	/** Handles retriggered notes & the voice limit and starts a voice for the given sound. */
+	void startVoicesForSound(ModulatorSynthSound *sound, const HiseEvent &m);
+
+	/** Calculates the pan gains for the balance. This is executed on the audio thread. */
+	static void applyBalance(void *synth, double newBalance, int, const void*);
+
+	/** Stops all notes after the bypass state was changed. This is executed on the audio thread. */
+	static void stopNotesAfterBypassChange(void *synth, double, int, const void*);
+
 	// ===================================================================================================================
 
 	Colour iconColour;
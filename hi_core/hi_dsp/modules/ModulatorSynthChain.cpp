@@ -58,7 +58,7 @@ void ModulatorSynthChain::numSourceChannelsChanged()
 
 	ModulatorSynth::numSourceChannelsChanged();
 
-	
+	resizeChildBuffers();
 }
 
 void ModulatorSynthChain::numDestinationChannelsChanged()
@@ -90,9 +90,23 @@ void ModulatorSynthChain::renderNextBlockWithModulators(AudioSampleBuffer &buffe
 {
 	if (isBypassed()) return;
 
-	ADD_GLITCH_DETECTOR(getId() + " rendering");
+	if (getMainController()->getMainSynthChain() == this)
+	{
+		ScopedLock sl(getSynthLock());
 
-	ScopedLock sl(getSynthLock());
+		renderChain(buffer, inputMidiBuffer);
+	}
+	else
+	{
+		// A nested chain is rendered while the main chain holds the lock. If its parent renders the children
+		// in parallel, this is a worker thread and locking would deadlock with the audio thread.
+		renderChain(buffer, inputMidiBuffer);
+	}
+}
+
+void ModulatorSynthChain::renderChain(AudioSampleBuffer &buffer, const HiseEventBuffer &inputMidiBuffer)
+{
+	ADD_GLITCH_DETECTOR(this, getId() + " rendering");
 
 	if (getMainController()->getMainSynthChain() == this && !activeChannels.areAllChannelsEnabled())
 	{
@@ -127,7 +141,14 @@ void ModulatorSynthChain::renderNextBlockWithModulators(AudioSampleBuffer &buffe
 	internalBuffer.setSize(getMatrix().getNumSourceChannels(), numSamples, true, false, true);
 
 	// Process the Synths and add store their output in the internal buffer
-	for (int i = 0; i < synths.size(); i++) if (!synths[i]->isBypassed()) synths[i]->renderNextBlockWithModulators(internalBuffer, eventBuffer);
+	if (renderPool != nullptr && childBuffers.size() >= synths.size())
+	{
+		renderChildSynthsInParallel(numSamples);
+	}
+	else
+	{
+		for (int i = 0; i < synths.size(); i++) if (!synths[i]->isBypassed()) synths[i]->renderNextBlockWithModulators(internalBuffer, eventBuffer);
+	}
 
 	postVoiceRendering(0, numSamples);
 
@@ -179,6 +200,144 @@ void ModulatorSynthChain::renderNextBlockWithModulators(AudioSampleBuffer &buffe
 #endif
 }
 
+void ModulatorSynthChain::renderChildSynthsInParallel(int numSamples)
+{
+	renderedChildren.clearQuick();
+	parallelChildren.clearQuick();
+
+	// The children that can't run in parallel are rendered first, so that the others can use their results
+	for (int i = 0; i < synths.size(); i++)
+	{
+		ModulatorSynth *child = synths[i];
+
+		if (child->isBypassed())
+			continue;
+
+		AudioSampleBuffer &childBuffer = *childBuffers[i];
+
+		childBuffer.setSize(internalBuffer.getNumChannels(), numSamples, true, false, true);
+		childBuffer.clear();
+
+		renderedChildren.add(i);
+
+		if (child->canBeRenderedInParallel())
+			parallelChildren.add(i);
+		else
+			child->renderNextBlockWithModulators(childBuffer, eventBuffer);
+	}
+
+	renderPool->runParallel(childRenderJob, parallelChildren.size());
+
+	// Sum the children in a fixed order so that the result doesn't depend on the thread timing
+	for (int i = 0; i < renderedChildren.size(); i++)
+	{
+		const AudioSampleBuffer &childBuffer = *childBuffers[renderedChildren[i]];
+
+		for (int c = 0; c < internalBuffer.getNumChannels(); c++)
+		{
+			FloatVectorOperations::add(internalBuffer.getWritePointer(c, 0), childBuffer.getReadPointer(c, 0), numSamples);
+		}
+	}
+}
+
+void ModulatorSynthChain::ChildRenderJob::runItem(int itemIndex)
+{
+	const int childIndex = parent.parallelChildren[itemIndex];
+
+	parent.synths[childIndex]->renderNextBlockWithModulators(*parent.childBuffers[childIndex], parent.eventBuffer);
+}
+
+void ModulatorSynthChain::setNumParallelRenderWorkers(int numWorkers)
+{
+	requestedNumWorkers = numWorkers;
+
+	ScopedPointer<RealtimeWorkerPool> newPool = numWorkers > 0 ? new RealtimeWorkerPool(numWorkers) : nullptr;
+
+	{
+		ScopedLock sl(getSynthLock());
+
+		renderPool.swapWith(newPool);
+		resizeChildBuffers();
+	}
+
+	// the old pool is deleted here, outside of the lock
+}
+
+void ModulatorSynthChain::setInternalAttribute(int parameterIndex, float newValue)
+{
+	if (parameterIndex < ModulatorSynth::numModulatorSynthParameters)
+	{
+		ModulatorSynth::setInternalAttribute(parameterIndex, newValue);
+		return;
+	}
+
+	switch (parameterIndex)
+	{
+	case NumParallelRenderWorkers:
+	{
+		requestedNumWorkers = jlimit<int>(0, 16, (int)newValue);
+
+		if (requestedNumWorkers == getNumParallelRenderWorkers())
+			return;
+
+		// Starting the worker threads is not realtime safe, so this is deferred if the attribute is changed by the audio thread
+		if (MessageManager::getInstance()->isThisTheMessageThread())
+			setNumParallelRenderWorkers(requestedNumWorkers);
+		else
+			workerUpdater.triggerAsyncUpdate();
+
+		break;
+	}
+	default: jassertfalse;
+	}
+}
+
+float ModulatorSynthChain::getAttribute(int parameterIndex) const
+{
+	if (parameterIndex < ModulatorSynth::numModulatorSynthParameters)
+		return ModulatorSynth::getAttribute(parameterIndex);
+
+	switch (parameterIndex)
+	{
+	case NumParallelRenderWorkers:	return (float)requestedNumWorkers;
+	default:						jassertfalse; return 0.0f;
+	}
+}
+
+float ModulatorSynthChain::getDefaultValue(int parameterIndex) const
+{
+	if (parameterIndex < ModulatorSynth::numModulatorSynthParameters)
+		return ModulatorSynth::getDefaultValue(parameterIndex);
+
+	switch (parameterIndex)
+	{
+	case NumParallelRenderWorkers:	return 0.0f;
+	default:						jassertfalse; return 0.0f;
+	}
+}
+
+void ModulatorSynthChain::resizeChildBuffers()
+{
+	ScopedLock sl(getSynthLock());
+
+	if (renderPool == nullptr)
+	{
+		childBuffers.clear();
+		return;
+	}
+
+	while (childBuffers.size() < synths.size())
+		childBuffers.add(new AudioSampleBuffer());
+
+	for (int i = 0; i < childBuffers.size(); i++)
+	{
+		childBuffers[i]->setSize(getMatrix().getNumSourceChannels(), internalBuffer.getNumSamples());
+	}
+
+	renderedChildren.ensureStorageAllocated(synths.size());
+	parallelChildren.ensureStorageAllocated(synths.size());
+}
+
 void ModulatorSynthChain::reset()
 {
     this->getHandler()->clear();
@@ -574,7 +733,8 @@ void ModulatorSynthGroup::checkFmState()
 
 void ModulatorSynthGroupVoice::calculateBlock(int startSample, int numSamples)
 {
-	ScopedLock sl(ownerSynth->getSynthLock());
+	// No lock here: the group is rendered by its parent chain, which already holds the synth lock for the block. If the
+	// parent renders its children in parallel, this runs on a worker thread and locking would deadlock with the audio thread.
 
 	// Clear the buffer, since all child voices are added to this so it must be empty.
 	voiceBuffer.clear();
@@ -113,6 +113,12 @@ public:
 
 	};
 
+	enum SpecialParameters
+	{
+		NumParallelRenderWorkers = ModulatorSynth::numModulatorSynthParameters, ///< **0** ... 16 | the amount of threads that render the child synths (0 renders them sequentially)
+		numModulatorSynthChainParameters
+	};
+
 	ModulatorSynthChain(MainController *mc, const String &id, int numVoices_, UndoManager *viewUndoManager = nullptr) :
 		MacroControlBroadcaster(this),
 		ModulatorSynth(mc, id, numVoices_),
@@ -121,7 +127,10 @@ public:
 #endif
 		numVoices(numVoices_),
 		handler(this),
-		vuValue(0.0f)
+		vuValue(0.0f),
+		childRenderJob(*this),
+		requestedNumWorkers(0),
+		workerUpdater(*this)
 	{
 #if USE_BACKEND == 0
 		ignoreUnused(viewUndoManager);
@@ -135,6 +144,8 @@ public:
 
 		editorStateIdentifiers.add("InterfaceShown");
 
+		parameterNames.add("NumParallelRenderWorkers");
+
 		setFactoryType(t);
 
         setEditorState(Processor::EditorState::BodyShown, false);
@@ -155,6 +166,10 @@ public:
 
 	virtual ~ModulatorSynthChain()
 	{
+		cancelAudioThreadCommands();
+
+		renderPool = nullptr;
+
 		getHandler()->clear();
 
 		effectChain = nullptr;
@@ -202,6 +217,8 @@ public:
 		ModulatorSynth::prepareToPlay(newSampleRate, samplesPerBlock);
 
 		for(int i = 0; i < synths.size(); i++) synths[i]->prepareToPlay(newSampleRate, samplesPerBlock);
+
+		resizeChildBuffers();
 	};
 
 	void numSourceChannelsChanged() override;
@@ -226,6 +243,9 @@ public:
 			v.addChild(getMainController()->getMacroManager().getMidiControlAutomationHandler()->exportAsValueTree(), -1, nullptr);
 
         }
+
+		saveAttribute(NumParallelRenderWorkers, "NumParallelRenderWorkers");
+
 		return v;
 	}
 
@@ -242,6 +262,7 @@ public:
 
 		ModulatorSynth::restoreFromValueTree(v);
 
+		loadAttributeWithDefault(NumParallelRenderWorkers);
 		
 #if USE_BACKEND
 		ViewManager::restoreViewsFromValueTree(v);
@@ -279,6 +300,27 @@ public:
 	*/
 	void renderNextBlockWithModulators(AudioSampleBuffer &buffer, const HiseEventBuffer &inputMidiBuffer) override;;
 
+	/** Renders the child synths on a pool of worker threads.
+	*
+	*	Every child renders into its own buffer and the buffers are added to the internal buffer in the order of the
+	*	children, so the output is the same as with sequential rendering. Children that return false in
+	*	ModulatorSynth::canBeRenderedInParallel() are rendered first on the audio thread.
+	*
+	*	The children must not depend on each other, so don't use this if scripts of one child access another child
+	*	or create artificial notes. Pass 0 to render the children sequentially (the default). Call this on the message thread.
+	*	The amount is stored in the NumParallelRenderWorkers attribute, so it can be changed by scripts and is saved in the preset.
+	*/
+	void setNumParallelRenderWorkers(int numWorkers);
+
+	/** Returns the amount of worker threads (0 if the children are rendered sequentially). */
+	int getNumParallelRenderWorkers() const { return renderPool != nullptr ? renderPool->getNumWorkers() : 0; }
+
+	void setInternalAttribute(int parameterIndex, float newValue) override;
+
+	float getAttribute(int parameterIndex) const override;
+
+	float getDefaultValue(int parameterIndex) const override;
+
 	int getVoiceAmount() const {return numVoices;};
 
 	int getNumActiveVoices() const override;
@@ -318,7 +360,12 @@ public:
 		{
 			ScopedLock sl(synth->getMainController()->getLock());
 
-			synth->synths.removeObject(dynamic_cast<ModulatorSynth*>(processorToBeRemoved));
+			ModulatorSynth *m = dynamic_cast<ModulatorSynth*>(processorToBeRemoved);
+
+			if (m != nullptr)
+				m->cancelAudioThreadCommands();
+
+			synth->synths.removeObject(m);
 
 			sendChangeMessage();
 		};
@@ -345,6 +392,9 @@ public:
 		{
 			ScopedLock sl(synth->getMainController()->getLock());
 
+			for (int i = 0; i < synth->synths.size(); i++)
+				synth->synths[i]->cancelAudioThreadCommands();
+
 			synth->synths.clear();
 
 			sendChangeMessage();
@@ -369,6 +419,43 @@ public:
 
 private:
 
+	class ChildRenderJob : public RealtimeWorkerPool::Job
+	{
+	public:
+
+		ChildRenderJob(ModulatorSynthChain &parent_) : parent(parent_) {};
+
+		void runItem(int itemIndex) override;
+
+	private:
+
+		ModulatorSynthChain &parent;
+	};
+
+	/** Creates the worker threads on the message thread if the attribute is changed on another thread. */
+	class AsyncWorkerUpdater : public AsyncUpdater
+	{
+	public:
+
+		AsyncWorkerUpdater(ModulatorSynthChain &parent_) : parent(parent_) {};
+
+		void handleAsyncUpdate() override
+		{
+			parent.setNumParallelRenderWorkers(parent.requestedNumWorkers);
+		}
+
+	private:
+
+		ModulatorSynthChain &parent;
+	};
+
+	/** Renders the block. The main chain calls this while it holds the synth lock. */
+	void renderChain(AudioSampleBuffer &buffer, const HiseEventBuffer &inputMidiBuffer);
+
+	void renderChildSynthsInParallel(int numSamples);
+
+	void resizeChildBuffers();
+
 	HiseEvent::ChannelFilterData activeChannels;
 
 	ModulatorSynthChainHandler handler;
@@ -379,6 +466,14 @@ private:
 
 	OwnedArray<ModulatorSynth> synths;
 
+	ScopedPointer<RealtimeWorkerPool> renderPool;
+	ChildRenderJob childRenderJob;
+	int requestedNumWorkers;
+	AsyncWorkerUpdater workerUpdater;
+	OwnedArray<AudioSampleBuffer> childBuffers;
+	Array<int> renderedChildren;
+	Array<int> parallelChildren;
+
 	ScopedPointer<FactoryType> modulatorSynthFactory;
 
 	ScopedPointer<FactoryType::Constrainer> constrainer;
@@ -513,6 +608,11 @@ public:
 
 	~ModulatorSynthGroup()
 	{
+		cancelAudioThreadCommands();
+
+		for (int i = 0; i < synths.size(); i++)
+			synths[i]->cancelAudioThreadCommands();
+
 		// This must be destroyed before the base class destructor because the MidiProcessor destructors may use some of ModulatorSynthGroup methods...
 		midiProcessorChain = nullptr;
 	};
@@ -744,6 +844,9 @@ public:
 				static_cast<ModulatorSynthGroupVoice*>(group->getVoice(i))->removeChildSynth(m);
 			}
 
+			if (m != nullptr)
+				m->cancelAudioThreadCommands();
+
 			group->synths.removeObject(m);
 
 			group->checkFmState();
@@ -771,6 +874,9 @@ public:
 
 		void clear() override
 		{
+			for (int i = 0; i < group->synths.size(); i++)
+				group->synths[i]->cancelAudioThreadCommands();
+
 			group->synths.clear();
 
 			sendChangeMessage();
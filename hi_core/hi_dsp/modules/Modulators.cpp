@@ -156,6 +156,12 @@ void Modulator::addValueToPlotter(float v) const
 
 void TimeModulation::renderNextBlock(AudioSampleBuffer &buffer, int startSample, int numSamples)
 {
+	if (controlRateDivider > 1)
+	{
+		renderNextBlockAtControlRate(buffer, startSample, numSamples);
+		return;
+	}
+
 	// Save the values for later
 	const int startIndex = startSample;
 	const int samplesToCopy = numSamples;
@@ -190,9 +196,120 @@ void TimeModulation::prepareToModulate(double /*sampleRate*/, int samplesPerBloc
 {
 	internalBuffer = AudioSampleBuffer(1, samplesPerBlock); // should be enough
 
+	if (controlRateDivider > 1)
+	{
+		// The control rate values of a block are calculated at the same position as the audio rate values, so this needs the full size
+		controlRateBuffer = AudioSampleBuffer(1, samplesPerBlock);
+
+		controlRateStates.clearQuick();
+		controlRateStates.insertMultiple(0, ControlRateState(), getNumControlRateVoices());
+	}
+	else
+	{
+		controlRateBuffer.setSize(0, 0);
+		controlRateStates.clear();
+	}
+
 	jassert(isInitialized());
 }
 
+void TimeModulation::setControlRateDivider(int newDivider)
+{
+	controlRateDivider = jlimit<int>(1, 64, newDivider);
+}
+
+void TimeModulation::resetControlRateState(int voiceIndex) noexcept
+{
+	if (isPositiveAndBelow(voiceIndex, controlRateStates.size()))
+		controlRateStates.getReference(voiceIndex) = ControlRateState();
+}
+
+void TimeModulation::renderNextBlockAtControlRate(AudioSampleBuffer &buffer, int startSample, int numSamples)
+{
+	// The modulator was not prepared with the control rate divider.
+	jassert(controlRateStates.size() != 0);
+
+	ControlRateState &s = controlRateStates.getReference(getControlRateVoiceIndex());
+
+	const int divider = controlRateDivider;
+
+	// A new value is calculated whenever the last ramp has ended, and the ramp to this value takes one control period.
+	const int numValues = numSamples > s.samplesLeft ? 1 + (numSamples - 1 - s.samplesLeft) / divider : 0;
+
+	// The values are calculated at the start of this block (and overwritten by the ramp below), so the
+	// audio rate values of the previous blocks in the internal buffer stay intact for getCalculatedValues().
+	if (numValues > 0)
+	{
+		jassert(startSample + numValues <= controlRateBuffer.getNumSamples());
+
+		initializeBuffer(controlRateBuffer, startSample, numValues);
+
+		calculateBlock(startSample, numValues);
+
+		if (shouldUpdatePlotter()) updatePlotter(internalBuffer, startSample, numValues);
+
+		applyTimeModulation(controlRateBuffer, startSample, numValues);
+	}
+
+	const float *targetValues = controlRateBuffer.getReadPointer(0, startSample);
+	float *rampedValues = internalBuffer.getWritePointer(0, startSample);
+
+	const int numRemaining = jmin<int>(s.samplesLeft, numSamples);
+
+	fillRamp(rampedValues, s.value + s.delta, s.delta, numRemaining);
+
+	s.samplesLeft -= numRemaining;
+	s.value = s.samplesLeft == 0 ? s.target : s.value + s.delta * (float)numRemaining;
+
+	int position = numRemaining;
+
+	for (int i = 0; i < numValues; i++)
+	{
+		s.target = targetValues[i];
+
+		if (s.needsReset)
+		{
+			s.value = s.target;
+			s.needsReset = false;
+		}
+
+		s.delta = (s.target - s.value) / (float)divider;
+
+		const int numThisTime = jmin<int>(divider, numSamples - position);
+
+		fillRamp(rampedValues + position, s.value + s.delta, s.delta, numThisTime);
+
+		position += numThisTime;
+
+		s.samplesLeft = divider - numThisTime;
+		s.value = s.samplesLeft == 0 ? s.target : s.value + s.delta * (float)numThisTime;
+	}
+
+	jassert(position == numSamples);
+
+	FloatVectorOperations::multiply(buffer.getWritePointer(0, startSample), rampedValues, numSamples);
+}
+
+void TimeModulation::fillRamp(float *destination, float start, float delta, int numValues) noexcept
+{
+	int i = 0;
+
+#if HI_SAMPLER_USE_SSE
+	const __m128 startValues = _mm_add_ps(_mm_set1_ps(start), _mm_mul_ps(_mm_set1_ps(delta), _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f)));
+	const __m128 deltas = _mm_set1_ps(delta);
+
+	for (; i + 4 <= numValues; i += 4)
+	{
+		_mm_storeu_ps(destination + i, _mm_add_ps(startValues, _mm_mul_ps(deltas, _mm_set1_ps((float)i))));
+	}
+#endif
+
+	for (; i < numValues; i++)
+	{
+		destination[i] = start + delta * (float)i;
+	}
+}
+
 bool TimeModulation::isInitialized() { return getProcessor()->getSampleRate() != -1.0f; };
 
 void TimeModulation::applyGainModulation(float *calculatedModulationValues, float *destinationValues, float fixedIntensity, int numValues) const noexcept
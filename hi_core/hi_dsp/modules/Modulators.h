@@ -309,15 +309,45 @@ public:
 	*/
 	virtual void applyTimeModulation(AudioSampleBuffer &buffer, int startIndex, int samplesToCopy);;
 
-	/** Returns a read pointer to the calculated values. This is used by the global modulator system. */
+	/** Returns a read pointer to the calculated values. This is used by the global modulator system.
+	*
+	*	The values have the intensity applied and are at audio rate for the whole block, even if the modulator is rendered at control rate.
+	*/
 	virtual const float *getCalculatedValues(int /*voiceIndex*/);
 
+	/** Overwrite this and return true if the modulator can be rendered at control rate.
+	*
+	*	A modulator that supports this must calculate all time constants from getSampleRate() (it will be prepared with the
+	*	reduced sample rate) and must produce exactly numSamples values in calculateBlock() for any numSamples.
+	*/
+	virtual bool supportsControlRate() const { return false; }
+
+	/** Sets the factor by which the modulation values are downsampled.
+	*
+	*	If this is bigger than 1, calculateBlock() and applyTimeModulation() only calculate every nth value, and the
+	*	results are linearly interpolated back to audio rate. The ModulatorChain calls this for all its modulators
+	*	that support control rate and prepares them with the reduced sample rate.
+	*/
+	void setControlRateDivider(int newDivider);
+
+	int getControlRateDivider() const noexcept { return controlRateDivider; }
+
+	/** Lets the next control rate value of the voice start without a ramp from the last value. Call this when a voice starts. */
+	void resetControlRateState(int voiceIndex) noexcept;
+
 protected:
 
 	TimeModulation(Modulation::Mode m):
-		Modulation(m)
+		Modulation(m),
+		controlRateDivider(1)
 	{};
 
+	/** Returns the voice index whose interpolation state should be used in renderNextBlock(). */
+	virtual int getControlRateVoiceIndex() const { return 0; }
+
+	/** Returns the number of voices that need their own interpolation state. */
+	virtual int getNumControlRateVoices() const { return 1; }
+
 
 
 	/** Creates the internal buffer with double the size of the expected buffer block size.
@@ -368,6 +398,26 @@ protected:
 
 private:
 
+	struct ControlRateState
+	{
+		ControlRateState() : value(1.0f), target(1.0f), delta(0.0f), samplesLeft(0), needsReset(true) {};
+
+		float value;
+		float target;
+		float delta;
+		int samplesLeft;
+		bool needsReset;
+	};
+
+	/** Calculates the values at control rate and interpolates them into the internal buffer. */
+	void renderNextBlockAtControlRate(AudioSampleBuffer &buffer, int startSample, int numSamples);
+
+	/** Writes numValues of the ramp start + i * delta. */
+	static void fillRamp(float *destination, float start, float delta, int numValues) noexcept;
+
+	int controlRateDivider;
+	AudioSampleBuffer controlRateBuffer;
+	Array<ControlRateState> controlRateStates;
 };
 
 
@@ -762,6 +812,10 @@ public:
 
 protected:
 
+	int getControlRateVoiceIndex() const override { return polyManager.getCurrentVoice(); }
+
+	int getNumControlRateVoices() const override { return polyManager.getVoiceAmount(); }
+
 	virtual bool shouldUpdatePlotter() const override {return polyManager.getCurrentVoice() == polyManager.getLastStartedVoice(); };
 
 
@@ -50,6 +50,7 @@ oneShotEnabled(false),
 crossfadeGroups(false),
 useGlobalFolder(false),
 purged(false),
+interpolationType(StreamingSamplerVoice::Linear),
 numChannels(1),
 deactivateUIUpdate(false)
 {
@@ -66,6 +67,7 @@ deactivateUIUpdate(false)
 	parameterNames.add("OneShot");
 	parameterNames.add("CrossfadeGroups");
 	parameterNames.add("Purged");
+	parameterNames.add("InterpolationType");
 
 	editorStateIdentifiers.add("SampleStartChainShown");
 	editorStateIdentifiers.add("SettingsShown");
@@ -135,6 +137,27 @@ void ModulatorSampler::refreshRRMap()
 	}
 }
 
+void ModulatorSampler::refreshSoundMap()
+{
+	ScopedLock sl(getMainController()->getLock());
+
+	soundMap.clear();
+
+	for (int i = 0; i < sounds.size(); i++)
+	{
+		ModulatorSamplerSound *sound = static_cast<ModulatorSamplerSound*>(sounds.getUnchecked(i).get());
+		sound->setOwnerSampler(this);
+		soundMap.addSound(sound);
+	}
+}
+
+void ModulatorSampler::refreshSoundMapping(ModulatorSamplerSound *sound)
+{
+	ScopedLock sl(getMainController()->getLock());
+
+	soundMap.updateSound(sound);
+}
+
 void ModulatorSampler::setNumChannels(int numNewChannels)
 {
 	numChannels = numNewChannels;
@@ -197,6 +220,7 @@ void ModulatorSampler::restoreFromValueTree(const ValueTree &v)
 
 	loadAttribute(PitchTracking, "PitchTracking");
 	loadAttribute(OneShot, "OneShot");
+	loadAttribute(InterpolationType, "InterpolationType");
 	const int newNumChannels = v.getProperty("NumChannels", 1);
 
 	if (newNumChannels != numChannels)
@@ -250,6 +274,7 @@ ValueTree ModulatorSampler::exportAsValueTree() const
 	saveAttribute(OneShot, "OneShot");
 	saveAttribute(CrossfadeGroups, "CrossfadeGroups");
 	saveAttribute(Purged, "Purged");
+	saveAttribute(InterpolationType, "InterpolationType");
 	v.setProperty("NumChannels", numChannels, nullptr);
 
 	ValueTree channels("channels");
@@ -295,6 +320,7 @@ float ModulatorSampler::getAttribute(int parameterIndex) const
 	case OneShot:			return oneShotEnabled ? 1.0f : 0.0f;
 	case CrossfadeGroups:	return crossfadeGroups ? 1.0f : 0.0f;
 	case Purged:			return purged ? 1.0f : 0.0f;
+	case InterpolationType:	return (float)interpolationType;
 	default:				jassertfalse; return -1.0f;
 	}
 }
@@ -318,6 +344,7 @@ void ModulatorSampler::setInternalAttribute(int parameterIndex, float newValue)
 	case OneShot:			oneShotEnabled = newValue == 1.0f; break;
 	case CrossfadeGroups:	crossfadeGroups = newValue == 1.0f; refreshCrossfadeTables(); break;
 	case Purged:			purgeAllSamples(newValue == 1.0f); break;
+	case InterpolationType:	interpolationType = (StreamingSamplerVoice::InterpolationType)jlimit<int>(0, StreamingSamplerVoice::numInterpolationTypes - 1, (int)newValue); break;
 	default:				jassertfalse; break;
 	}
 }
@@ -376,7 +403,7 @@ void ModulatorSampler::prepareToPlay(double newSampleRate, int samplesPerBlock)
 	{
 		crossfadeBuffer = AudioSampleBuffer(1, samplesPerBlock);
 
-		StreamingSamplerVoice::initTemporaryVoiceBuffer(&temporaryVoiceBuffer, samplesPerBlock);
+		StreamingSamplerVoice::initTemporaryVoiceBuffer(&temporaryVoiceBuffer, samplesPerBlock, numChannels);
 
 		sampleStartChain->prepareToPlay(newSampleRate, samplesPerBlock);
 		crossFadeChain->prepareToPlay(newSampleRate, samplesPerBlock);
@@ -443,6 +470,9 @@ void ModulatorSampler::deleteSound(ModulatorSamplerSound *s)
 
 	s->removeAllChangeListeners();
 
+	soundMap.removeSound(s);
+	s->setOwnerSampler(nullptr);
+
     const int deletedIndex = s->getProperty(ModulatorSamplerSound::ID);
 
 	SynthesiserSound::Ptr refPointer = s;
@@ -473,6 +503,7 @@ void ModulatorSampler::deleteAllSounds()
 	}
 
 
+	soundMap.clear();
 	clearSounds();
 
 	/*
@@ -558,6 +589,12 @@ void ModulatorSampler::setVoiceAmount(int newVoiceAmount)
 		allNotesOff(1, false);
 		clearVoices();
 
+		if (Processor::getSampleRate() != -1.0)
+		{
+			// The multimic voices need two channels per mic position in the temp buffer
+			StreamingSamplerVoice::initTemporaryVoiceBuffer(&temporaryVoiceBuffer, getBlockSize(), numChannels);
+		}
+
 		for (int i = 0; i < voiceAmount; i++)
 		{
 			if (numChannels != 1)
@@ -647,6 +684,9 @@ void ModulatorSampler::addSamplerSound(const ValueTree &description, int index,
 	newSound->setUndoManager(getMainController()->getControlUndoManager());
 	newSound->addChangeListener(sampleMap);
 
+	newSound->setOwnerSampler(this);
+	soundMap.addSound(newSound);
+
 	sendChangeMessage();
 }
 
@@ -669,6 +709,9 @@ void ModulatorSampler::addSamplerSounds(OwnedArray<ModulatorSamplerSound>& monol
 
 		newSound->setUndoManager(getMainController()->getControlUndoManager());
 		newSound->addChangeListener(sampleMap);
+
+		newSound->setOwnerSampler(this);
+		soundMap.addSound(newSound);
 	}
 
 	sendChangeMessage();
@@ -732,6 +775,11 @@ bool ModulatorSampler::soundCanBePlayed(ModulatorSynthSound *sound, int midiChan
 	return true;
 }
 
+const Array<ModulatorSynthSound*> * ModulatorSampler::getCandidateSounds(int noteNumber, int velocity) const
+{
+	return soundMap.getCandidates(noteNumber, velocity);
+}
+
 void ModulatorSampler::handleRetriggeredNote(ModulatorSynthVoice *voice)
 {
 	switch (repeatMode)
@@ -75,6 +75,7 @@ public:
 		OneShot, ///< On, **Off** | plays the whole sample (ignores the note off) if set to enabled.
 		CrossfadeGroups, ///< On, **Off** | if enabled, the groups are played simultanously and can be crossfaded with the X-Fade Modulation Chain
 		Purged, ///< If this is true, all samples of this sampler won't be loaded into memory. Turning this on will load them.
+		InterpolationType, ///< **Linear**, Cubic | the interpolation algorithm that is used for resampling the samples.
 		numModulatorSamplerParameters
 	};
 
@@ -219,6 +220,7 @@ public:
 	void preVoiceRendering(int startSample, int numThisTime) override;
 	void soundsChanged() {};
 	bool soundCanBePlayed(ModulatorSynthSound *sound, int midiChannel, int midiNoteNumber, float velocity) override;;
+	const Array<ModulatorSynthSound*> *getCandidateSounds(int noteNumber, int velocity) const override;
 	void handleRetriggeredNote(ModulatorSynthVoice *voice) override;
 
 	/** Overwrites the base class method and ignores the note off event if Parameters::OneShot is enabled. */
@@ -253,6 +255,7 @@ public:
 	void setRRGroupAmount(int newGroupLimit);
 
 	bool isPitchTrackingEnabled() const {return pitchTrackingEnabled; };
+	StreamingSamplerVoice::InterpolationType getInterpolationType() const noexcept { return interpolationType; };
 	bool isOneShot() const {return oneShotEnabled; };
 
 	CriticalSection &getSamplerLock() {	return lock; }
@@ -280,6 +283,12 @@ public:
 	int getRRGroupsForMessage(int noteNumber, int velocity);
 	void refreshRRMap();
 
+	/** Rebuilds the SoundLookupMap from scratch. Call this if you change the sounds without using addSamplerSound() / deleteSound(). */
+	void refreshSoundMap();
+
+	/** Updates the position of the sound in the SoundLookupMap. This is called automatically when the mapping of a sound changes. */
+	void refreshSoundMapping(ModulatorSamplerSound *sound);
+
 	void purgeAllSamples(bool shouldBePurged)
 	{
 
@@ -523,6 +532,7 @@ private:
 	void refreshCrossfadeTables();
 
 	RoundRobinMap roundRobinMap;
+	SoundLookupMap soundMap;
 
 	bool useGlobalFolder;
 	bool pitchTrackingEnabled;
@@ -534,6 +544,7 @@ private:
 	int currentRRGroupIndex;
 	bool useRoundRobinCycleLogic;
 	RepeatMode repeatMode;
+	StreamingSamplerVoice::InterpolationType interpolationType;
 	int voiceAmount;
 	int preloadScaleFactor;
 
@@ -31,6 +31,148 @@
 */
 
 
+class ParallelSamplePreloader::Worker : public ThreadPoolJob
+{
+public:
+
+	Worker(ParallelSamplePreloader &parent_) :
+		ThreadPoolJob("Sample Preloader"),
+		parent(parent_)
+	{};
+
+	JobStatus runJob() override
+	{
+		parent.preloadPendingSounds();
+
+		return jobHasFinished;
+	}
+
+private:
+
+	ParallelSamplePreloader &parent;
+};
+
+ParallelSamplePreloader::ParallelSamplePreloader(int numThreadsToUse) :
+	numThreads(numThreadsToUse > 0 ? numThreadsToUse : jlimit<int>(1, 8, SystemStats::getNumCpus())),
+	currentPreloadSize(0),
+	currentProgressWindow(nullptr),
+	nextSoundIndex(0),
+	numPreloadedSounds(0),
+	abortLoading(false)
+{}
+
+bool ParallelSamplePreloader::preload(const Array<StreamingSamplerSound*> &soundsToLoad, int preloadSize, ThreadWithQuasiModalProgressWindow *progressWindow)
+{
+	// Sounds from the pool can be used by multiple samples, but they must be loaded only once
+	Array<StreamingSamplerSound*> uniqueSounds(soundsToLoad);
+
+	std::sort(uniqueSounds.begin(), uniqueSounds.end());
+	uniqueSounds.removeRange((int)(std::unique(uniqueSounds.begin(), uniqueSounds.end()) - uniqueSounds.begin()), uniqueSounds.size());
+	uniqueSounds.removeAllInstancesOf(nullptr);
+
+	Array<StreamingSamplerSound*> monolithicSounds;
+
+	fileSounds.clearQuick();
+
+	for (int i = 0; i < uniqueSounds.size(); i++)
+	{
+		if (uniqueSounds[i]->isMonolithic()) monolithicSounds.add(uniqueSounds[i]);
+		else fileSounds.add(uniqueSounds[i]);
+	}
+
+	const int numSounds = uniqueSounds.size();
+	const int numWorkers = jmin<int>(numThreads, fileSounds.size());
+
+	currentPreloadSize = preloadSize;
+	currentProgressWindow = progressWindow;
+	nextSoundIndex.store(0);
+	numPreloadedSounds.store(0);
+
+	if (numWorkers > 0)
+	{
+		ThreadPool workerPool(numWorkers);
+
+		for (int i = 0; i < numWorkers; i++)
+		{
+			workerPool.addJob(new Worker(*this), true);
+		}
+
+		while (workerPool.getNumJobs() > 0)
+		{
+			if (progressWindow != nullptr)
+			{
+				if (progressWindow->threadShouldExit()) signalAbort();
+
+				progressWindow->setProgress(numPreloadedSounds.load() / (double)numSounds);
+			}
+
+			Thread::sleep(20);
+		}
+	}
+
+	for (int i = 0; i < monolithicSounds.size(); i++)
+	{
+		if (progressWindow != nullptr)
+		{
+			if (progressWindow->threadShouldExit()) signalAbort();
+
+			progressWindow->setProgress(numPreloadedSounds.load() / (double)numSounds);
+		}
+
+		if (abortLoading.load()) break;
+
+		if (preloadSound(monolithicSounds[i])) numPreloadedSounds.fetch_add(1);
+	}
+
+	fileSounds.clearQuick();
+	currentProgressWindow = nullptr;
+
+	return !abortLoading.load() && numPreloadedSounds.load() == numSounds;
+}
+
+String ParallelSamplePreloader::getErrorMessage() const
+{
+	ScopedLock sl(errorLock);
+
+	return errorMessage;
+}
+
+bool ParallelSamplePreloader::preloadSound(StreamingSamplerSound *s)
+{
+	if (currentProgressWindow != nullptr) currentProgressWindow->setStatusMessage(s->getFileName(false));
+
+	try
+	{
+		s->setPreloadSize(s->hasActiveState() ? currentPreloadSize : 0, true);
+		s->closeFileHandle();
+
+		return true;
+	}
+	catch (StreamingSamplerSound::LoadingError l)
+	{
+		ScopedLock sl(errorLock);
+
+		if (errorMessage.isEmpty()) errorMessage = "Error at preloading " + l.fileName + ": " + l.errorDescription;
+
+		signalAbort();
+
+		return false;
+	}
+}
+
+void ParallelSamplePreloader::preloadPendingSounds()
+{
+	while (!abortLoading.load())
+	{
+		const int index = nextSoundIndex.fetch_add(1);
+
+		if (index >= fileSounds.size()) return;
+
+		if (preloadSound(fileSounds.getUnchecked(index))) numPreloadedSounds.fetch_add(1);
+	}
+}
+
+
 SoundPreloadThread::SoundPreloadThread(ModulatorSampler *s) :
 ThreadWithQuasiModalProgressWindow("Loading Sample Data", true, true, s->getMainController(), 10000, "Abort loading"),
 sampler(s)
@@ -77,37 +219,40 @@ void SoundPreloadThread::run()
 
 	debugToConsole(sampler, "Changing preload size to " + String(preloadSize) + " samples");
 
+	Array<StreamingSamplerSound*> soundsToLoad;
+
 	for(int i = 0; i < numSoundsToPreload; ++i)
 	{
         if(threadShouldExit()) break;
 
-		setProgress(i / (double)numSoundsToPreload);
+		ModulatorSamplerSound *sound = sampler->getSound(i);
 
-		if (sampler->getSound(i) == nullptr) continue;
+		if (sound == nullptr) continue;
 
-		sampler->getSound(i)->checkFileReference();
+		sound->checkFileReference();
 
 		if (sampler->getNumMicPositions() == 1)
 		{
-			StreamingSamplerSound *s = sampler->getSound(i)->getReferenceToSound();
-			preloadSample(s, preloadSize);
-
+			soundsToLoad.add(sound->getReferenceToSound());
 		}
 		else
 		{
 			for (int j = 0; j < sampler->getNumMicPositions(); j++)
 			{
-                ModulatorSamplerSound *sound = sampler->getSound(i);
+                StreamingSamplerSound *s = sound->getReferenceToSound(j);
                 
-                if(sound != nullptr)
-                {
-                    StreamingSamplerSound *s = sound->getReferenceToSound(j);
-                    
-                    if(s != nullptr) preloadSample(s, preloadSize);
-                }
+                if(s != nullptr) soundsToLoad.add(s);
 			}
 		}
+	}
+
+	ParallelSamplePreloader preloader;
+
+	if (!preloader.preload(soundsToLoad, preloadSize, this) && preloader.getErrorMessage().isNotEmpty())
+	{
+		debugError(sampler, preloader.getErrorMessage());
 
+		signalThreadShouldExit();
 	}
 
 	sampler->setBypassed(false);
@@ -117,34 +262,6 @@ void SoundPreloadThread::run()
 	sampler->getMainController()->getSampleManager().getModulatorSamplerSoundPool()->sendChangeMessage();
 };
 
-void SoundPreloadThread::preloadSample(StreamingSamplerSound * s, const int preloadSize)
-{
-	jassert(s != nullptr);
-
-	String fileName = s->getFileName(false);
-
-	setStatusMessage(fileName);
-
-	try
-	{
-		s->setPreloadSize(s->hasActiveState() ? preloadSize : 0, true);
-		s->closeFileHandle();
-	}
-	catch (StreamingSamplerSound::LoadingError l)
-	{
-		debugError(sampler, "Error at preloading " + l.fileName + ": " + l.errorDescription);
-
-		//sampler->deleteAllSounds();
-
-		//sampler->clearSounds();
-		sampler->setBypassed(false);
-        
-		signalThreadShouldExit();
-
-
-	}
-}
-
 ThumbnailHandler::ThumbnailHandler(const File &directoryToLoad, const StringArray &fileNames, ModulatorSampler *s) :
 ThreadWithQuasiModalProgressWindow("Generating Audio Thumbnails for " + String(fileNames.size()) + " files.", true, true, s->getMainController()),
 fileNamesToLoad(fileNames),
@@ -460,13 +577,49 @@ public:
 
 		addTextEditor("id", sampleMap->getId().toString(), "Sample Map Name");
 
+		StringArray compressionOptions;
+		compressionOptions.add("Uncompressed");
+		compressionOptions.add("Lossless compressed");
+
+		addComboBox("compression", compressionOptions, "Compression");
+
+		StringArray bitDepthOptions;
+		bitDepthOptions.add("16 Bit");
+		bitDepthOptions.add("24 Bit");
+		bitDepthOptions.add("32 Bit float");
+
+		addComboBox("bitDepth", bitDepthOptions, "Bit Depth");
+
 		addBasicComponents(true);
 	}
 
 	void run() override
 	{
+		useCompression = getComboBoxComponent("compression")->getSelectedItemIndex() == 1;
+		sampleFormat = (MonolithFileHeader::SampleFormat)jlimit<int>(0, MonolithFileHeader::numSampleFormats - 1, getComboBoxComponent("bitDepth")->getSelectedItemIndex());
+
+		// Check the options before the sample map is changed
+		if (useCompression && sampleFormat != MonolithFileHeader::Int16)
+		{
+			error = "Lossless compression is only available for 16 bit monoliths";
+			return;
+		}
+
 		sampleMap->setId(getTextEditorContents("id"));
-	
+
+		const SampleMap::SaveMode previousMode = sampleMap->mode;
+		sampleMap->mode = SampleMap::SaveMode::Monolith;
+
+		exportMonolith();
+
+		if (error.isEmpty())
+			sampleMap->changed = false;
+		else
+			sampleMap->mode = previousMode;
+	}
+
+	void exportMonolith()
+	{
 		showStatusMessage("Collecting files");
 
 		filesToWrite = sampleMap->createFileList();
@@ -512,7 +665,7 @@ public:
 
 	void threadFinished() override
 	{
-		if (error.isEmpty())
+		if (error.isNotEmpty())
 		{
 			PresetHandler::showMessageWindow("Error at exporting", error, PresetHandler::IconType::Error);
 		}
@@ -566,14 +719,33 @@ private:
 		outputFile.create();
 		FileOutputStream fos(outputFile);
 		
-		fos.writeBool(isMono);
-
 		showStatusMessage("Exporting Channel " + String(channelIndex+1));
 
 		AudioSampleBuffer buffer(isMono? 1 : 2, (int)largestSample);
+
+		if (useCompression)
+		{
+			MonolithBlockCodec::Writer writer(fos, isMono);
+
+			for (int i = 0; i < channelList->size(); i++)
+			{
+				setProgress((double)i / (double)numSamples);
+
+				ScopedPointer<AudioFormatReader> reader = afm.createReaderFor(channelList->getUnchecked(i));
+				reader->read(&buffer, 0, (int)reader->lengthInSamples, 0, true, true);
+
+				writer.addSamples(buffer, (int)reader->lengthInSamples);
+			}
+
+			writer.finish();
+			return;
+		}
+
+		fos.writeByte((char)MonolithFileHeader::createFlags(isMono, sampleFormat, false));
+
 		MemoryBlock tempBlock;
 				
-		size_t frameSize = sizeof(int16) * (isMono ? 1 : 2);
+		size_t frameSize = MonolithFileHeader::getBytesPerSample(sampleFormat) * (isMono ? 1 : 2);
 
 		tempBlock.setSize(frameSize * largestSample);
 		
@@ -585,8 +757,7 @@ private:
 			reader->read(&buffer, 0, (int)reader->lengthInSamples, 0, true, true);
 			size_t bytesUsed = reader->lengthInSamples * frameSize;
 
-			AudioFormatWriter::WriteHelper<AudioData::Int16, AudioData::Float32, AudioData::LittleEndian>::write(
-				tempBlock.getData(), isMono ? 1 : 2, (const int* const *)buffer.getArrayOfReadPointers(), (int)reader->lengthInSamples);
+			SampleDataConversion::convertFromFloat(sampleFormat, buffer.getArrayOfReadPointers(), isMono ? 1 : 2, tempBlock.getData(), (int)reader->lengthInSamples);
 
 			fos.write(tempBlock.getData(), bytesUsed);	
 		}
@@ -633,6 +804,9 @@ private:
 
 	int64 largestSample;
 
+	bool useCompression = false;
+	MonolithFileHeader::SampleFormat sampleFormat = MonolithFileHeader::Int16;
+
 	ValueTree v;
 	SampleMap* sampleMap;
 	SampleMap::FileList filesToWrite;
@@ -647,13 +821,10 @@ private:
 
 void SampleMap::saveAsMonolith(Component* mainEditor)
 {
-	mode = SaveMode::Monolith;
-
+	// The exporter switches the mode when the options are valid
 	auto m = new MonolithExporter(this);
 
 	m->setModalBaseWindowComponent(mainEditor);
-
-	changed = false;
 }
 
 void SampleMap::loadSamplesFromDirectory(const ValueTree &v)
@@ -921,3 +1092,63 @@ int RoundRobinMap::getRRGroupsForMessage(int noteNumber, int velocity)
 	else return -1;
 	
 }
+
+void SoundLookupMap::clear()
+{
+	for (int i = 0; i < 128; i++)
+	{
+		for (int j = 0; j < NumVelocityBuckets; j++)
+		{
+			cells[i][j].clearQuick();
+		}
+	}
+}
+
+void SoundLookupMap::addSound(ModulatorSamplerSound *sound)
+{
+	const Range<int> noteRange = sound->getNoteRange();
+	const Range<int> veloRange = sound->getVelocityRange();
+
+	MappingData &m = sound->registeredMapping;
+
+	if (noteRange.getStart() < 0 || veloRange.getStart() < 0)
+	{
+		// Not mapped at all (the BigIntegers are empty)
+		m = MappingData(-1, 0, -1, 0, -1, -1);
+		return;
+	}
+
+	m.loKey = jlimit<int>(0, 127, noteRange.getStart());
+	m.hiKey = jlimit<int>(0, 127, noteRange.getEnd() - 1);
+	m.loVel = jlimit<int>(0, 127, veloRange.getStart()) / VelocityBucketSize;
+	m.hiVel = jlimit<int>(0, 127, veloRange.getEnd() - 1) / VelocityBucketSize;
+
+	for (int i = m.loKey; i <= m.hiKey; i++)
+	{
+		for (int j = m.loVel; j <= m.hiVel; j++)
+		{
+			cells[i][j].addIfNotAlreadyThere(sound);
+		}
+	}
+}
+
+void SoundLookupMap::removeSound(ModulatorSamplerSound *sound)
+{
+	const MappingData &m = sound->registeredMapping;
+
+	for (int i = m.loKey; i <= m.hiKey; i++)
+	{
+		for (int j = m.loVel; j <= m.hiVel; j++)
+		{
+			cells[i][j].removeFirstMatchingValue(sound);
+		}
+	}
+
+	sound->registeredMapping = MappingData(-1, 0, -1, 0, -1, -1);
+}
+
+void SoundLookupMap::updateSound(ModulatorSamplerSound *sound)
+{
+	removeSound(sound);
+	addSound(sound);
+}
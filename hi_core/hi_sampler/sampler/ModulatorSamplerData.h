@@ -36,6 +36,67 @@
 class ModulatorSampler;
 class ModulatorSamplerSound;
 
+/** Loads the preload buffers of a list of StreamingSamplerSounds on multiple threads.
+*	@ingroup sampler
+*
+*	Opening and reading the files is the slowest part of loading a big sample map, so the sounds are distributed
+*	across a few worker threads which claim the next sound from an atomic counter. The calling thread waits until all
+*	sounds are loaded and updates the progress window. If the window's thread should exit or a sound can't be loaded,
+*	the workers stop after their current sound.
+*
+*	Monolithic sounds share their file reader, so they are preloaded on the calling thread after the workers are done.
+*	Create a new instance for every loading operation.
+*/
+class ParallelSamplePreloader
+{
+public:
+
+	/** Creates a preloader with the given number of worker threads (0 derives the number from the CPU cores). */
+	ParallelSamplePreloader(int numThreadsToUse = NUM_SAMPLE_LOADING_THREADS);
+
+	/** Preloads every sound in the list and returns false if the loading was aborted or a sound failed to load.
+	*
+	*	Duplicates in the list are skipped. If a progress window is supplied, its progress and status message
+	*	are updated and the loading is aborted when its thread should exit.
+	*/
+	bool preload(const Array<StreamingSamplerSound*> &soundsToLoad, int preloadSize, ThreadWithQuasiModalProgressWindow *progressWindow = nullptr);
+
+	/** Stops the loading after the sounds that are currently loaded. This can be called from any thread. */
+	void signalAbort() noexcept { abortLoading.store(true); }
+
+	/** Returns the error of the first sound that couldn't be loaded or an empty String. */
+	String getErrorMessage() const;
+
+	int getNumPreloadedSounds() const noexcept { return numPreloadedSounds.load(); }
+
+	int getNumThreads() const noexcept { return numThreads; }
+
+private:
+
+	class Worker;
+
+	/** Preloads a single sound and returns false if it couldn't be loaded. */
+	bool preloadSound(StreamingSamplerSound *s);
+
+	/** Claims and loads sounds from the list until it is empty or the loading is aborted. */
+	void preloadPendingSounds();
+
+	const int numThreads;
+
+	Array<StreamingSamplerSound*> fileSounds;
+	int currentPreloadSize;
+	ThreadWithQuasiModalProgressWindow *currentProgressWindow;
+
+	std::atomic<int> nextSoundIndex;
+	std::atomic<int> numPreloadedSounds;
+	std::atomic<bool> abortLoading;
+
+	CriticalSection errorLock;
+	String errorMessage;
+
+	JUCE_DECLARE_NON_COPYABLE(ParallelSamplePreloader)
+};
+
 /** A background thread which loads sample data into the preload buffer of a StreamingSamplerSound
 *	@ingroup sampler
 *
@@ -57,8 +118,6 @@ public:
 	/** preloads either all sounds from the sampler or the list of sounds that was passed in the constructor. */
 	void run() override;
 
-	void preloadSample(StreamingSamplerSound * s, const int preloadSize);
-
 private:
 
 	AlertWindowLookAndFeel laf;
@@ -284,6 +343,8 @@ public:
     
 private:
 
+	friend class MonolithExporter;
+
 	void resolveMissingFiles(ValueTree &treeToUse);
 
 	void loadSamplesFromDirectory(const ValueTree &v);
@@ -331,4 +392,57 @@ private:
 
 };
 
+/** A precalculated lookup table that stores the sounds that can be played for every notenumber / velocity combination.
+*
+*	The ModulatorSampler uses this to narrow down the sounds that are checked in the note on callback, so that a note on
+*	only touches the sounds that are mapped to this key instead of scanning the whole samplemap.
+*
+*	The velocity axis is divided into buckets of VelocityBucketSize, so a candidate list might contain sounds that do not
+*	match the exact velocity or the current round robin group - those are sorted out by ModulatorSampler::soundCanBePlayed().
+*
+*	The map is updated incrementally when a sound is added / removed or its mapping changes. Every method that changes the map
+*	must be called with the main controller lock held, because the audio thread reads the candidate lists in the note on callback.
+*/
+class SoundLookupMap
+{
+public:
+
+	enum
+	{
+		VelocityBucketSize = 8,
+		NumVelocityBuckets = 128 / VelocityBucketSize
+	};
+
+	SoundLookupMap() {};
+
+	/** Removes all sounds from the map. */
+	void clear();
+
+	/** Adds the sound to every cell that is covered by its current mapping. */
+	void addSound(ModulatorSamplerSound *sound);
+
+	/** Removes the sound from every cell it was added to (using the mapping from the time it was added). */
+	void removeSound(ModulatorSamplerSound *sound);
+
+	/** Call this whenever the key / velocity range of a sound has changed. */
+	void updateSound(ModulatorSamplerSound *sound);
+
+	/** Returns the list of sounds that might be played for the given message. This is a O(1) operation. */
+	const Array<ModulatorSynthSound*> *getCandidates(int noteNumber, int velocity) const noexcept
+	{
+		if (isPositiveAndBelow(noteNumber, 128) && isPositiveAndBelow(velocity, 128))
+		{
+			return &cells[noteNumber][velocity / VelocityBucketSize];
+		}
+
+		return nullptr;
+	}
+
+private:
+
+	Array<ModulatorSynthSound*> cells[128][NumVelocityBuckets];
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SoundLookupMap)
+};
+
 #endif  // MODULATORSAMPLERDATA_H_INCLUDED
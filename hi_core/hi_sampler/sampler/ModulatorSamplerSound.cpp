@@ -48,7 +48,9 @@ upperVeloXFadeValue(0),
 lowerVeloXFadeValue(0),
 pan(0),
 purged(false),
-purgeChannels(0)
+purgeChannels(0),
+ownerSampler(nullptr),
+registeredMapping(-1, 0, -1, 0, -1, -1)
 {
 	soundList.add(wrappedSound.get());
 
@@ -73,7 +75,9 @@ upperVeloXFadeValue(0),
 lowerVeloXFadeValue(0),
 pan(0),
 purged(false),
-purgeChannels(0)
+purgeChannels(0),
+ownerSampler(nullptr),
+registeredMapping(-1, 0, -1, 0, -1, -1)
 {
 	soundList.add(wrappedSound.get());
 
@@ -233,56 +237,63 @@ var ModulatorSamplerSound::getProperty(Property p) const
 
 void ModulatorSamplerSound::setProperty(Property p, int newValue, NotificationType notifyEditor/*=sendNotification*/)
 {
-	ScopedLock sl(getLock());
-
-	switch (p)
 	{
-	case ID:			jassertfalse; break;
-	case FileName:		jassertfalse; break;
-	case RootNote:		rootNote = newValue; break;
-	case VeloHigh:	{	int low = jmin(velocityRange.findNextSetBit(0), newValue, 127);
-		velocityRange.clear();
-		velocityRange.setRange(low, newValue - low + 1, true); break; }
-	case VeloLow:	{	int high = jmax(velocityRange.getHighestBit(), newValue, 0);
-		velocityRange.clear();
-		velocityRange.setRange(newValue, high - newValue + 1, true); break; }
-	case KeyHigh:	{	int low = jmin(midiNotes.findNextSetBit(0), newValue, 127);
-		midiNotes.clear();
-		midiNotes.setRange(low, newValue - low + 1, true); break; }
-	case KeyLow:	{	int high = jmax(midiNotes.getHighestBit(), newValue, 0);
-		midiNotes.clear();
-		midiNotes.setRange(newValue, high - newValue + 1, true); break; }
-	case RRGroup:		rrGroup = newValue; break;
-	case Normalized:	isNormalized = newValue == 1; 
-						if (isNormalized && normalizedPeak < 0.0f) calculateNormalizedPeak();
-						break;
-	case Volume:	{	gain.set(Decibels::decibelsToGain((float)newValue));
-		break;
-	}
-	case Pan:		{
-		pan = (int)newValue;
-		leftBalanceGain = BalanceCalculator::getGainFactorForBalance((float)newValue, true);
-		rightBalanceGain = BalanceCalculator::getGainFactorForBalance((float)newValue, false);
-		break;
-	}
-	case Pitch:		{	centPitch = newValue;
-		pitchFactor.set(powf(2.0f, (float)centPitch / 1200.f));
-		break;
-	};
-	case SampleStart:	FOR_EVERY_SOUND(setSampleStart(newValue)); break;
-	case SampleEnd:		FOR_EVERY_SOUND(setSampleEnd(newValue)); break;
-	case SampleStartMod: FOR_EVERY_SOUND(setSampleStartModulation(newValue)); break;
-
-	case LoopEnabled:	FOR_EVERY_SOUND(setLoopEnabled(newValue == 1.0f)); break;
-	case LoopStart:		FOR_EVERY_SOUND(setLoopStart(newValue)); break;
-	case LoopEnd:		FOR_EVERY_SOUND(setLoopEnd(newValue)); break;
-	case LoopXFade:		FOR_EVERY_SOUND(setLoopCrossfade(newValue)); break;
-	case LowerVelocityXFade: lowerVeloXFadeValue = newValue; break;
-	case UpperVelocityXFade: upperVeloXFadeValue = newValue; break;
-	case SampleState:	setPurged(newValue == 1.0f); break;
-	default:			jassertfalse; break;
+		ScopedLock sl(getLock());
+
+		switch (p)
+		{
+		case ID:			jassertfalse; break;
+		case FileName:		jassertfalse; break;
+		case RootNote:		rootNote = newValue; break;
+		case VeloHigh:	{	int low = jmin(velocityRange.findNextSetBit(0), newValue, 127);
+			velocityRange.clear();
+			velocityRange.setRange(low, newValue - low + 1, true); break; }
+		case VeloLow:	{	int high = jmax(velocityRange.getHighestBit(), newValue, 0);
+			velocityRange.clear();
+			velocityRange.setRange(newValue, high - newValue + 1, true); break; }
+		case KeyHigh:	{	int low = jmin(midiNotes.findNextSetBit(0), newValue, 127);
+			midiNotes.clear();
+			midiNotes.setRange(low, newValue - low + 1, true); break; }
+		case KeyLow:	{	int high = jmax(midiNotes.getHighestBit(), newValue, 0);
+			midiNotes.clear();
+			midiNotes.setRange(newValue, high - newValue + 1, true); break; }
+		case RRGroup:		rrGroup = newValue; break;
+		case Normalized:	isNormalized = newValue == 1; 
+							if (isNormalized && normalizedPeak < 0.0f) calculateNormalizedPeak();
+							break;
+		case Volume:	{	gain.set(Decibels::decibelsToGain((float)newValue));
+			break;
+		}
+		case Pan:		{
+			pan = (int)newValue;
+			leftBalanceGain = BalanceCalculator::getGainFactorForBalance((float)newValue, true);
+			rightBalanceGain = BalanceCalculator::getGainFactorForBalance((float)newValue, false);
+			break;
+		}
+		case Pitch:		{	centPitch = newValue;
+			pitchFactor.set(powf(2.0f, (float)centPitch / 1200.f));
+			break;
+		};
+		case SampleStart:	FOR_EVERY_SOUND(setSampleStart(newValue)); break;
+		case SampleEnd:		FOR_EVERY_SOUND(setSampleEnd(newValue)); break;
+		case SampleStartMod: FOR_EVERY_SOUND(setSampleStartModulation(newValue)); break;
+
+		case LoopEnabled:	FOR_EVERY_SOUND(setLoopEnabled(newValue == 1.0f)); break;
+		case LoopStart:		FOR_EVERY_SOUND(setLoopStart(newValue)); break;
+		case LoopEnd:		FOR_EVERY_SOUND(setLoopEnd(newValue)); break;
+		case LoopXFade:		FOR_EVERY_SOUND(setLoopCrossfade(newValue)); break;
+		case LowerVelocityXFade: lowerVeloXFadeValue = newValue; break;
+		case UpperVelocityXFade: upperVeloXFadeValue = newValue; break;
+		case SampleState:	setPurged(newValue == 1.0f); break;
+		default:			jassertfalse; break;
+		}
 	}
 
+	// The sound map is updated outside the sample lock to keep the lock order (main controller lock -> sample lock) intact
+	const bool mappingChanged = p == KeyHigh || p == KeyLow || p == VeloHigh || p == VeloLow;
+
+	if (mappingChanged && ownerSampler != nullptr) ownerSampler->refreshSoundMapping(this);
+
 	if(notifyEditor) sendChangeMessage();
 }
 
@@ -429,6 +440,8 @@ void ModulatorSamplerSound::setMappingData(MappingData newData)
 	midiNotes.clear();
 	midiNotes.setRange(newData.loKey, newData.hiKey - newData.loKey + 1, true);
 	rrGroup = newData.rrGroup;
+
+	if (ownerSampler != nullptr) ownerSampler->refreshSoundMapping(this);
 }
 
 void ModulatorSamplerSound::calculateNormalizedPeak(bool forceScan /*= false*/)
@@ -622,14 +635,15 @@ bool ModulatorSamplerSound::PropertyChange::undo()
 // ====================================================================================================================
 
 ModulatorSamplerSoundPool::ModulatorSamplerSoundPool(MainController *mc_) :
-mc(mc_),
-debugProcessor(nullptr),
 mainAudioProcessor(nullptr),
-numOpenFileHandles(0),
+debugProcessor(nullptr),
+mc(mc_),
+poolIndexIsDirty(false),
+isCurrentlyLoading(false),
+forcePoolSearch(false),
 updatePool(true),
 searchPool(true),
-forcePoolSearch(false),
-isCurrentlyLoading(false)
+numOpenFileHandles(0)
 {
 	afm.registerBasicFormats();
 }
@@ -664,6 +678,7 @@ void ModulatorSamplerSoundPool::deleteSound(ModulatorSamplerSound *soundToDelete
 		if (sound->getReferenceCount() == 2) // one for the array and two for the Synthesiser::Ptr from &delete()
 		{
 			pool.removeObject(sound);
+			poolIndexIsDirty = true;
 		}
 	}
 
@@ -691,7 +706,8 @@ bool ModulatorSamplerSoundPool::loadMonolithicData(const ValueTree &sampleMap, c
 		{
 			String fileName = sample.getProperty("FileName").toString().fromFirstOccurrenceOf("{PROJECT_FOLDER}", false, false);
 			StreamingSamplerSound* sound = new StreamingSamplerSound(hmaf, 0, i);
-			pool.add(sound);
+			sound->setPreloadFormat(preloadFormat);
+			addToPool(sound);
 			sounds.add(new ModulatorSamplerSound(sound, i));
 		}
 		else
@@ -701,7 +717,8 @@ bool ModulatorSamplerSoundPool::loadMonolithicData(const ValueTree &sampleMap, c
 			for (int j = 0; j < sample.getNumChildren(); j++)
 			{
 				StreamingSamplerSound* sound = new StreamingSamplerSound(hmaf, j, i);
-				pool.add(sound);
+				sound->setPreloadFormat(preloadFormat);
+				addToPool(sound);
 				multiMicArray.add(sound);
 			}
 
@@ -723,6 +740,7 @@ void ModulatorSamplerSoundPool::clearUnreferencedSamples()
 		if (pool[i]->getReferenceCount() == 2)
 		{
 			pool.remove(i--);
+			poolIndexIsDirty = true;
 		}
 	}
 
@@ -997,6 +1015,35 @@ size_t ModulatorSamplerSoundPool::getMemoryUsageForAllSamples() const noexcept
 	return memoryUsage;
 }
 
+void ModulatorSamplerSoundPool::setPreloadFormat(StreamingSamplerSound::PreloadFormat newFormat)
+{
+	if (preloadFormat == newFormat)
+		return;
+
+	preloadFormat = newFormat;
+
+	for (int i = 0; i < pool.size(); i++)
+	{
+		StreamingSamplerSound *s = pool[i];
+
+		s->setPreloadFormat(preloadFormat);
+
+		if (s->getNumPreloadedSamples() == 0)
+			continue;
+
+		try
+		{
+			s->setPreloadSize(s->getPreloadSize(), true);
+		}
+		catch (StreamingSamplerSound::LoadingError e)
+		{
+			debugError(mc->getMainSynthChain(), "Error at reloading " + e.fileName + ": " + e.errorDescription);
+		}
+	}
+
+	if (updatePool) sendChangeMessage();
+}
+
 
 
 String ModulatorSamplerSoundPool::getTextForPoolTable(int columnId, int indexInPool)
@@ -1030,16 +1077,14 @@ String ModulatorSamplerSoundPool::getTextForPoolTable(int columnId, int indexInP
 
 void ModulatorSamplerSoundPool::increaseNumOpenFileHandles()
 {
-	numOpenFileHandles++;
+	++numOpenFileHandles;
 
 	if(updatePool) sendChangeMessage();
 }
 
 void ModulatorSamplerSoundPool::decreaseNumOpenFileHandles()
 {
-	numOpenFileHandles--; 
-	
-	if (numOpenFileHandles < 0) numOpenFileHandles = 0;
+	if (--numOpenFileHandles < 0) ++numOpenFileHandles;
 
 	if(updatePool) sendChangeMessage();
 }
@@ -1054,16 +1099,50 @@ bool ModulatorSamplerSoundPool::isFileBeingUsed(int poolIndex)
 	return false;
 }
 
-int ModulatorSamplerSoundPool::getSoundIndexFromPool(int64 hashCode)
+StreamingSamplerSound * ModulatorSamplerSoundPool::getSoundFromPool(int64 hashCode)
 {
-	if (!searchPool) return -1;
+	if (!searchPool) return nullptr;
 
+	if (poolIndexIsDirty) rebuildPoolIndex();
+
+	StreamingSamplerSound *s = poolIndex[hashCode];
+
+	if (s == nullptr || s->getHashCode() == hashCode) return s;
+
+	// The file of this sound was changed without notifying the pool, so the index is stale
+	rebuildPoolIndex();
+
+	return poolIndex[hashCode];
+}
+
+void ModulatorSamplerSoundPool::addToPool(StreamingSamplerSound *s)
+{
+	pool.add(s);
+
+	if (!poolIndexIsDirty && !poolIndex.contains(s->getHashCode()))
+	{
+		poolIndex.set(s->getHashCode(), s);
+	}
+}
+
+void ModulatorSamplerSoundPool::rebuildPoolIndex()
+{
+	poolIndex.clear();
+
+	if (poolIndex.getNumSlots() < pool.size())
+	{
+		poolIndex.remapTable(pool.size());
+	}
+
+	// Iterate in pool order so that the first sound with a given hash wins (like the old linear search)
 	for (int i = 0; i < pool.size(); i++)
 	{
-		if (pool[i]->getHashCode() == hashCode) return i;
+		const int64 hash = pool[i]->getHashCode();
+
+		if (!poolIndex.contains(hash)) poolIndex.set(hash, pool[i]);
 	}
 
-	return -1;
+	poolIndexIsDirty = false;
 }
 
 ModulatorSamplerSound * ModulatorSamplerSoundPool::addSoundWithSingleMic(const ValueTree &soundDescription, int index, bool forceReuse /*= false*/)
@@ -1073,12 +1152,12 @@ ModulatorSamplerSound * ModulatorSamplerSoundPool::addSoundWithSingleMic(const V
 	if (forceReuse)
 	{
         int64 hash = fileName.hashCode64();
-		int i = getSoundIndexFromPool(hash);
+		StreamingSamplerSound *existingSound = getSoundFromPool(hash);
 
-		if (i != -1)
+		if (existingSound != nullptr)
 		{
 			if(updatePool) sendChangeMessage();
-			return new ModulatorSamplerSound(pool[i], index);
+			return new ModulatorSamplerSound(existingSound, index);
 		}
 		else
 		{
@@ -1094,22 +1173,7 @@ ModulatorSamplerSound * ModulatorSamplerSoundPool::addSoundWithSingleMic(const V
         
         const bool searchThisSampleInPool = forcePoolSearch || isDuplicate;
         
-        if(searchThisSampleInPool)
-        {
-            int64 hash = fileName.hashCode64();
-            int i = getSoundIndexFromPool(hash);
-            
-            if (i != -1)
-            {
-                ModulatorSamplerSound *sound = new ModulatorSamplerSound(pool[i], index);
-                if(updatePool) sendChangeMessage();
-                return sound;
-            }
-        }
-        
-		StreamingSamplerSound *s = new StreamingSamplerSound(fileName, this);
-
-		pool.add(s);
+		StreamingSamplerSound *s = getOrCreateSound(fileName, searchThisSampleInPool);
 
 		if(updatePool) sendChangeMessage();
 
@@ -1129,11 +1193,11 @@ ModulatorSamplerSound * ModulatorSamplerSoundPool::addSoundWithMultiMic(const Va
 		if (forceReuse)
 		{
             int64 hash = fileName.hashCode64();
-			int j = getSoundIndexFromPool(hash);
+			StreamingSamplerSound *existingSound = getSoundFromPool(hash);
 
-			jassert(j != -1);
+			jassert(existingSound != nullptr);
 
-			multiMicArray.add(pool[j]);
+			multiMicArray.add(existingSound);
 			if(updatePool) sendChangeMessage();
 		}
 		else
@@ -1144,32 +1208,7 @@ ModulatorSamplerSound * ModulatorSamplerSoundPool::addSoundWithMultiMic(const Va
 
 			const bool searchThisSampleInPool = forcePoolSearch || isDuplicate;
 
-			if (searchThisSampleInPool)
-            {
-                int64 hash = fileName.hashCode64();
-                int j = getSoundIndexFromPool(hash);
-                
-                if (j != -1)
-                {
-                    multiMicArray.add(pool[j]);
-                    continue;
-                }
-				else
-				{
-					StreamingSamplerSound *s = new StreamingSamplerSound(fileName, this);
-
-					multiMicArray.add(s);
-					pool.add(s);
-					continue;
-				}
-            }
-			else
-			{
-				StreamingSamplerSound *s = new StreamingSamplerSound(fileName, this);
-
-				multiMicArray.add(s);
-				pool.add(s);
-			}
+			multiMicArray.add(getOrCreateSound(fileName, searchThisSampleInPool));
 		}
 	}
 
@@ -1178,6 +1217,23 @@ ModulatorSamplerSound * ModulatorSamplerSoundPool::addSoundWithMultiMic(const Va
 	return new ModulatorSamplerSound(multiMicArray, index);
 }
 
+StreamingSamplerSound * ModulatorSamplerSoundPool::getOrCreateSound(const String &fileName, bool searchInPool)
+{
+	if (searchInPool)
+	{
+		StreamingSamplerSound *existingSound = getSoundFromPool(fileName.hashCode64());
+
+		if (existingSound != nullptr) return existingSound;
+	}
+
+	StreamingSamplerSound *s = new StreamingSamplerSound(fileName, this);
+
+	s->setPreloadFormat(preloadFormat);
+	addToPool(s);
+
+	return s;
+}
+
 bool ModulatorSamplerSoundPool::isPoolSearchForced() const
 {
 	return forcePoolSearch;
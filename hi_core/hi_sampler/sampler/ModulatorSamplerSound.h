@@ -269,6 +269,9 @@ public:
 	/** This sets the MIDI related properties without undo / range checks. */
 	void setMappingData(MappingData newData);
 
+	/** Sets the sampler that owns this sound. It will be notified when the mapping changes to update its SoundLookupMap. */
+	void setOwnerSampler(ModulatorSampler *newOwner) noexcept { ownerSampler = newOwner; };
+
 	/** Calculates the gain value that must be applied to normalize the volume of the sample ( 1.0 / peakValue ).
 	*
 	*	It should save calculated value along with the other properties, but if a new sound is added,
@@ -302,7 +305,7 @@ public:
 	{
 		for (int i = 0; i < soundList.size(); i++)
 		{
-			if (!soundList[i]->isPurged() && soundList[i]->getPreloadBuffer().getNumSamples() != 0)
+			if (!soundList[i]->isPurged() && soundList[i]->getNumPreloadedSamples() != 0)
 			{
 				return true;
 			}
@@ -363,6 +366,7 @@ private:
 	// ================================================================================================================
 
 	friend class MultimicMergeDialogWindow;
+	friend class SoundLookupMap;
 	friend class WeakReference<ModulatorSamplerSound>;
 	WeakReference<ModulatorSamplerSound>::Master masterReference;
 
@@ -401,6 +405,11 @@ private:
 
 	BigInteger purgeChannels;
 
+	ModulatorSampler *ownerSampler;
+
+	/** The key / velocity bucket range this sound was added to the owner's SoundLookupMap with. */
+	MappingData registeredMapping;
+
 	// ================================================================================================================
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ModulatorSamplerSound)
@@ -445,6 +454,12 @@ public:
 	/** Decreases the reference count of the wrapped sound in the pool and deletes it if no references are left. */
 	void deleteSound(ModulatorSamplerSound *soundToDelete);;
 
+	/** Returns the sound for the file if it is already in the pool or adds a new sound for it.
+	*
+	*	The file name must be an absolute path. If searchInPool is false, a new sound is always created.
+	*/
+	StreamingSamplerSound *getOrCreateSound(const String &fileName, bool searchInPool);
+
 	bool loadMonolithicData(const ValueTree &sampleMap, const Array<File>& monolithicFiles, OwnedArray<ModulatorSamplerSound> &sounds);
 
     void setUpdatePool(bool shouldBeUpdated)
@@ -478,6 +493,14 @@ public:
 	*/
 	size_t getMemoryUsageForAllSamples() const noexcept;;
 
+	/** Sets the format of the preload and loop buffers of all sounds (see StreamingSamplerSound::setPreloadFormat()).
+	*
+	*	The preload buffers of all loaded sounds are reloaded, so don't call this from the audio thread.
+	*/
+	void setPreloadFormat(StreamingSamplerSound::PreloadFormat newFormat);
+
+	StreamingSamplerSound::PreloadFormat getPreloadFormat() const noexcept { return preloadFormat; }
+
 	String getTextForPoolTable(int columnId, int indexInPool);
 
 	// ================================================================================================================
@@ -504,13 +527,25 @@ public:
 
 	void clearUnreferencedMonoliths();
 
+	/** Marks the hash index of the pool as outdated, so it will be rebuilt at the next lookup.
+	*
+	*	The StreamingSamplerSound calls this when its file is changed, because this changes the hash code of the sound.
+	*/
+	void setPoolIndexDirty() noexcept { poolIndexIsDirty = true; }
+
 private:
 
 	// ================================================================================================================
 
 	ReferenceCountedArray<HiseMonolithAudioFormat> loadedMonoliths;
 
-	int getSoundIndexFromPool(int64 hashCode);
+	/** Returns the sound with the given file hash or nullptr if it is not in the pool (or the pool search is deactivated). */
+	StreamingSamplerSound *getSoundFromPool(int64 hashCode);
+
+	/** Adds the sound to the pool and the hash index. */
+	void addToPool(StreamingSamplerSound *s);
+
+	void rebuildPoolIndex();
 
 	ModulatorSamplerSound *addSoundWithSingleMic(const ValueTree &soundDescription, int index, bool forceReuse = false);
 	ModulatorSamplerSound *addSoundWithMultiMic(const ValueTree &soundDescription, int index, bool forceReuse = false);
@@ -524,12 +559,23 @@ private:
 
 	ReferenceCountedArray<StreamingSamplerSound> pool;
 
+	/** The default hash function of the HashMap truncates the key to a signed int, which overflows for INT_MIN. */
+	struct PoolIndexHashFunction
+	{
+		int generateHash(int64 key, int upperLimit) const noexcept { return (int)((uint64)key % (uint64)upperLimit); }
+	};
+
+	/** Maps the file hash to the first sound in the pool with this hash. Removing sounds only marks it as dirty. */
+	HashMap<int64, StreamingSamplerSound*, PoolIndexHashFunction> poolIndex;
+	bool poolIndexIsDirty;
+
 	bool isCurrentlyLoading;
 	bool forcePoolSearch;
     bool updatePool;
 	bool searchPool;
+	StreamingSamplerSound::PreloadFormat preloadFormat = (StreamingSamplerSound::PreloadFormat)HISE_DEFAULT_PRELOAD_FORMAT;
     
-	int numOpenFileHandles;
+	Atomic<int> numOpenFileHandles;
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ModulatorSamplerSoundPool)
 };
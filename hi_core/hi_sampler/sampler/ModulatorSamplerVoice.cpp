@@ -35,7 +35,7 @@ void ModulatorSamplerVoice::startNote(int midiNoteNumber,
 	SynthesiserSound* s,
 	int /*currentPitchWheelPosition*/)
 {
-    ADD_GLITCH_DETECTOR("start sample playback: ");
+    ADD_GLITCH_DETECTOR(nullptr, "start sample playback: ");
     
     ModulatorSynthVoice::startNote(midiNoteNumber, 0.0f, nullptr, -1);
 
@@ -80,7 +80,7 @@ void ModulatorSamplerVoice::calculateBlock(int startSample, int numSamples)
     const StreamingSamplerSound *sound = wrappedVoice.getLoadedSound();
     jassert(sound != nullptr);
     
-    ADD_GLITCH_DETECTOR("Rendering sample" + sound->getFileName());
+    ADD_GLITCH_DETECTOR(nullptr, "Rendering sample" + sound->getFileName());
     
 	const int startIndex = startSample;
 	const int samplesInBlock = numSamples;
@@ -98,6 +98,7 @@ void ModulatorSamplerVoice::calculateBlock(int startSample, int numSamples)
 	voiceBuffer.clear();
 
 	wrappedVoice.uptimeDelta = uptimeDelta * propertyPitch;
+	wrappedVoice.setInterpolationType(sampler->getInterpolationType());
 
 	wrappedVoice.renderNextBlock(voiceBuffer, startSample, numSamples);
 
@@ -319,23 +320,26 @@ void MultiMicModulatorSamplerVoice::calculateBlock(int startSample, int numSampl
 
 	voiceBuffer.clear();
 
+	jassert(wrappedVoices.size() <= NUM_MIC_POSITIONS);
+
+	bool hasSound[NUM_MIC_POSITIONS];
+
 	for (int i = 0; i < wrappedVoices.size(); i++)
 	{
-		const StreamingSamplerSound *sound = wrappedVoices[i]->getLoadedSound();
-
-		if (sound == nullptr) continue;
+		hasSound[i] = wrappedVoices[i]->getLoadedSound() != nullptr;
 
 		wrappedVoices[i]->setPitchValues(voicePitchValues);
 		wrappedVoices[i]->setPitchCounterForThisBlock(pitchCounter);
 		wrappedVoices[i]->uptimeDelta = uptimeDelta * propertyPitch;
+		wrappedVoices[i]->setInterpolationType(sampler->getInterpolationType());
+	}
 
-		float *leftChannel = voiceBuffer.getWritePointer(2*i);
-		float *rightChannel = voiceBuffer.getWritePointer(2*i + 1);
-		float *channels[2] = { leftChannel, rightChannel };
-
-		AudioSampleBuffer channelBuffer(channels, 2, voiceBuffer.getNumSamples());
+	// The mic positions share the read positions, so they are interpolated together
+	StreamingSamplerVoice::renderVoicesInOnePass(wrappedVoices.getRawDataPointer(), wrappedVoices.size(), voiceBuffer, startSample, numSamples);
 
-		wrappedVoices[i]->renderNextBlock(channelBuffer, startSample, numSamples);
+	for (int i = 0; i < wrappedVoices.size(); i++)
+	{
+		if (!hasSound[i]) continue;
 
 		voiceUptime = wrappedVoices[i]->voiceUptime;
 
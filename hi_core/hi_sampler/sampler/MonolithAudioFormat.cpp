@@ -29,3 +29,843 @@
 *
 *   ===========================================================================
 */
+
+namespace MonolithCodecHelpers
+{
+
+enum
+{
+	SilentChannel = 7,
+	EscapeCode = 31
+};
+
+inline int countLeadingZeros(uint64 value) noexcept
+{
+	if (value == 0) return 64;
+
+#if JUCE_MSVC && JUCE_64BIT
+	unsigned long index;
+	_BitScanReverse64(&index, value);
+	return 63 - (int)index;
+#elif JUCE_MSVC
+	unsigned long index;
+
+	if (_BitScanReverse(&index, (unsigned long)(value >> 32)))
+		return 31 - (int)index;
+
+	_BitScanReverse(&index, (unsigned long)value);
+	return 63 - (int)index;
+#else
+	return __builtin_clzll(value);
+#endif
+}
+
+inline uint32 zigzag(int value) noexcept { return ((uint32)value << 1) ^ (uint32)(value >> 31); }
+
+inline int unzigzag(uint32 value) noexcept { return (int)(value >> 1) ^ -(int)(value & 1); }
+
+class BitWriter
+{
+public:
+
+	BitWriter(OutputStream &output_) :
+		output(output_)
+	{};
+
+	void write(uint32 value, int numBits)
+	{
+		jassert(numBits <= 32);
+
+		buffer = (buffer << numBits) | ((uint64)value & ((1ULL << numBits) - 1));
+		numBitsInBuffer += numBits;
+
+		while (numBitsInBuffer >= 8)
+		{
+			numBitsInBuffer -= 8;
+			output.writeByte((char)(uint8)(buffer >> numBitsInBuffer));
+		}
+	}
+
+	void writeOnes(int numOnes)
+	{
+		while (numOnes > 0)
+		{
+			const int numThisTime = jmin<int>(numOnes, 32);
+			write(0xFFFFFFFF, numThisTime);
+			numOnes -= numThisTime;
+		}
+	}
+
+	void writeRice(uint32 value, int k)
+	{
+		const uint32 q = value >> k;
+
+		if (q < EscapeCode)
+		{
+			writeOnes((int)q);
+			write(0, 1);
+			write(value, k);
+		}
+		else
+		{
+			writeOnes(EscapeCode);
+			write(value, 32);
+		}
+	}
+
+	/** Pads the last byte with zeros. */
+	void flush()
+	{
+		if (numBitsInBuffer > 0)
+			write(0, 8 - numBitsInBuffer);
+	}
+
+private:
+
+	OutputStream &output;
+	uint64 buffer = 0;
+	int numBitsInBuffer = 0;
+};
+
+class BitReader
+{
+public:
+
+	BitReader(const void* data_, size_t numBytes_) :
+		data(static_cast<const uint8*>(data_)),
+		numBytes(numBytes_)
+	{};
+
+	uint32 read(int numBits) noexcept
+	{
+		if (numBits == 0) return 0;
+
+		if (numBitsInCache < numBits)
+		{
+			refill();
+
+			if (numBitsInCache < numBits)
+			{
+				error = true;
+				return 0;
+			}
+		}
+
+		numBitsInCache -= numBits;
+		return (uint32)((cache >> numBitsInCache) & ((1ULL << numBits) - 1));
+	}
+
+	uint32 readRice(int k) noexcept
+	{
+		// Fast path: the whole code word is in the cache
+		if (numBitsInCache < 32)
+			refill();
+
+		if (numBitsInCache > 0)
+		{
+			const int numOnes = countLeadingZeros(~(cache << (64 - numBitsInCache)));
+
+			if (numOnes < EscapeCode && numOnes + 1 + k <= numBitsInCache)
+			{
+				numBitsInCache -= numOnes + 1 + k;
+				return ((uint32)numOnes << k) | (uint32)((cache >> numBitsInCache) & ((1ULL << k) - 1));
+			}
+		}
+
+		int q = 0;
+
+		for (;;)
+		{
+			if (numBitsInCache == 0)
+			{
+				refill();
+
+				if (numBitsInCache == 0)
+				{
+					error = true;
+					return 0;
+				}
+			}
+
+			const uint64 aligned = cache << (64 - numBitsInCache);
+			const int numOnes = jmin<int>(countLeadingZeros(~aligned), numBitsInCache);
+
+			if (q + numOnes >= EscapeCode)
+			{
+				numBitsInCache -= (EscapeCode - q);
+				return read(32);
+			}
+
+			if (numOnes < numBitsInCache)
+			{
+				numBitsInCache -= numOnes + 1;
+				return ((uint32)(q + numOnes) << k) | read(k);
+			}
+
+			q += numOnes;
+			numBitsInCache = 0;
+		}
+	}
+
+	bool hasError() const noexcept { return error; }
+
+private:
+
+	void refill() noexcept
+	{
+		while (numBitsInCache <= 56 && position < numBytes)
+		{
+			cache = (cache << 8) | data[position++];
+			numBitsInCache += 8;
+		}
+	}
+
+	const uint8* data;
+	const size_t numBytes;
+	size_t position = 0;
+
+	uint64 cache = 0;
+	int numBitsInCache = 0;
+
+	bool error = false;
+};
+
+/** Calculates the residual of the fixed predictor with the given order. */
+inline int getResidual(const int* x, int i, int order) noexcept
+{
+	switch (order)
+	{
+	case 0:		return x[i];
+	case 1:		return x[i] - x[i - 1];
+	case 2:		return x[i] - 2 * x[i - 1] + x[i - 2];
+	default:	return x[i] - 3 * x[i - 1] + 3 * x[i - 2] - x[i - 3];
+	}
+}
+
+/** Returns the predictor order with the smallest residuals and its cost. */
+int findBestOrder(const int* x, int numSamples, int64 &cost)
+{
+	int bestOrder = 0;
+	cost = INT64_MAX;
+
+	for (int order = 0; order <= jmin<int>(MonolithBlockCodec::MaxPredictionOrder, numSamples - 1); order++)
+	{
+		int64 sum = 0;
+
+		for (int i = order; i < numSamples; i++)
+			sum += std::abs(getResidual(x, i, order));
+
+		if (sum < cost)
+		{
+			cost = sum;
+			bestOrder = order;
+		}
+	}
+
+	return bestOrder;
+}
+
+int findBestRiceParameter(const uint32* values, int numValues)
+{
+	int bestK = 0;
+	uint64 bestCost = UINT64_MAX;
+
+	for (int k = 0; k < 24; k++)
+	{
+		uint64 cost = (uint64)numValues * (uint64)(k + 1);
+
+		for (int i = 0; i < numValues; i++)
+			cost += jmin<uint32>(values[i] >> k, EscapeCode + 32);
+
+		if (cost < bestCost)
+		{
+			bestCost = cost;
+			bestK = k;
+		}
+	}
+
+	return bestK;
+}
+
+void encodeChannel(const int* x, int numSamples, BitWriter &writer)
+{
+	bool isSilent = true;
+
+	for (int i = 0; i < numSamples; i++)
+	{
+		if (x[i] != 0)
+		{
+			isSilent = false;
+			break;
+		}
+	}
+
+	if (isSilent)
+	{
+		writer.write(SilentChannel, 3);
+		return;
+	}
+
+	int64 cost;
+	const int order = findBestOrder(x, numSamples, cost);
+
+	writer.write((uint32)order, 3);
+
+	for (int i = 0; i < order; i++)
+		writer.write((uint32)x[i], 32);
+
+	uint32 residuals[MonolithBlockCodec::PartitionSize];
+
+	for (int start = order; start < numSamples; start += MonolithBlockCodec::PartitionSize)
+	{
+		const int numThisTime = jmin<int>(MonolithBlockCodec::PartitionSize, numSamples - start);
+
+		for (int i = 0; i < numThisTime; i++)
+			residuals[i] = zigzag(getResidual(x, start + i, order));
+
+		const int k = findBestRiceParameter(residuals, numThisTime);
+
+		writer.write((uint32)k, 5);
+
+		for (int i = 0; i < numThisTime; i++)
+			writer.writeRice(residuals[i], k);
+	}
+}
+
+bool decodeChannel(BitReader &reader, int* x, int numSamples)
+{
+	const int order = (int)reader.read(3);
+
+	if (order == SilentChannel)
+	{
+		zeromem(x, sizeof(int) * (size_t)numSamples);
+		return !reader.hasError();
+	}
+
+	if (order > MonolithBlockCodec::MaxPredictionOrder || order >= jmax<int>(1, numSamples))
+		return false;
+
+	for (int i = 0; i < order; i++)
+		x[i] = (int)reader.read(32);
+
+	for (int start = order; start < numSamples; start += MonolithBlockCodec::PartitionSize)
+	{
+		const int numThisTime = jmin<int>(MonolithBlockCodec::PartitionSize, numSamples - start);
+		const int k = (int)reader.read(5);
+
+		for (int i = start; i < start + numThisTime; i++)
+			x[i] = unzigzag(reader.readRice(k));
+	}
+
+	switch (order)
+	{
+	case 1: for (int i = 1; i < numSamples; i++) x[i] += x[i - 1]; break;
+	case 2: for (int i = 2; i < numSamples; i++) x[i] += 2 * x[i - 1] - x[i - 2]; break;
+	case 3: for (int i = 3; i < numSamples; i++) x[i] += 3 * x[i - 1] - 3 * x[i - 2] + x[i - 3]; break;
+	default: break;
+	}
+
+	return !reader.hasError();
+}
+
+} // namespace MonolithCodecHelpers
+
+// ==================================================================================================== MonolithBlockCodec methods
+
+void MonolithBlockCodec::encodeBlock(const int16* const* channels, int numChannels, int numSamples, OutputStream &output)
+{
+	using namespace MonolithCodecHelpers;
+
+	jassert(numSamples <= BlockSize);
+	jassert(numChannels == 1 || numChannels == 2);
+
+	int left[BlockSize];
+	int right[BlockSize];
+
+	for (int i = 0; i < numSamples; i++)
+		left[i] = channels[0][i];
+
+	BitWriter writer(output);
+
+	if (numChannels == 2)
+	{
+		int side[BlockSize];
+
+		for (int i = 0; i < numSamples; i++)
+		{
+			right[i] = channels[1][i];
+			side[i] = left[i] - right[i];
+		}
+
+		int64 rightCost, sideCost;
+		findBestOrder(right, numSamples, rightCost);
+		findBestOrder(side, numSamples, sideCost);
+
+		const bool useSide = sideCost < rightCost;
+
+		writer.write(useSide ? 1 : 0, 1);
+
+		encodeChannel(left, numSamples, writer);
+		encodeChannel(useSide ? side : right, numSamples, writer);
+	}
+	else
+	{
+		encodeChannel(left, numSamples, writer);
+	}
+
+	writer.flush();
+}
+
+bool MonolithBlockCodec::decodeBlock(const void* data, size_t numBytes, int numChannels, int numSamples, int* const* destination)
+{
+	using namespace MonolithCodecHelpers;
+
+	jassert(numSamples <= BlockSize);
+
+	BitReader reader(data, numBytes);
+
+	const bool useSide = numChannels == 2 && reader.read(1) != 0;
+
+	for (int c = 0; c < numChannels; c++)
+	{
+		if (!decodeChannel(reader, destination[c], numSamples))
+			return false;
+	}
+
+	if (useSide)
+	{
+		int* l = destination[0];
+		int* r = destination[1];
+
+		for (int i = 0; i < numSamples; i++)
+			r[i] = l[i] - r[i];
+	}
+
+	return true;
+}
+
+// ==================================================================================================== MonolithBlockCodec::Writer methods
+
+MonolithBlockCodec::Writer::Writer(OutputStream &output_, bool isMono) :
+	output(output_),
+	numChannels(isMono ? 1 : 2),
+	numPendingSamples(0),
+	lengthInSamples(0)
+{
+	pendingData.calloc(BlockSize * 2);
+
+	output.writeByte((char)MonolithFileHeader::createFlags(isMono, MonolithFileHeader::Int16, true));
+	output.writeInt(BlockSize);
+	output.writeInt64(0); // the length and the index position are written in finish()
+	output.writeInt64(0);
+}
+
+void MonolithBlockCodec::Writer::addSamples(const AudioSampleBuffer &buffer, int numSamples)
+{
+	typedef AudioData::Pointer<AudioData::Float32, AudioData::NativeEndian, AudioData::NonInterleaved, AudioData::Const> SourceType;
+	typedef AudioData::Pointer<AudioData::Int16, AudioData::NativeEndian, AudioData::NonInterleaved, AudioData::NonConst> DestType;
+
+	jassert(buffer.getNumChannels() >= numChannels);
+
+	int offset = 0;
+
+	while (offset < numSamples)
+	{
+		const int numThisTime = jmin<int>(numSamples - offset, BlockSize - numPendingSamples);
+
+		for (int c = 0; c < numChannels; c++)
+		{
+			DestType(pendingData + c * BlockSize + numPendingSamples).convertSamples(SourceType(buffer.getReadPointer(c, offset)), numThisTime);
+		}
+
+		numPendingSamples += numThisTime;
+		offset += numThisTime;
+
+		if (numPendingSamples == BlockSize)
+			flushBlock();
+	}
+
+	lengthInSamples += numSamples;
+}
+
+void MonolithBlockCodec::Writer::flushBlock()
+{
+	if (numPendingSamples == 0)
+		return;
+
+	const int16* channels[2] = { pendingData.getData(), pendingData + BlockSize };
+
+	blockPositions.add(output.getPosition());
+
+	encodeBlock(channels, numChannels, numPendingSamples, output);
+
+	numPendingSamples = 0;
+}
+
+void MonolithBlockCodec::Writer::finish()
+{
+	flushBlock();
+
+	blockPositions.add(output.getPosition());
+
+	const int64 indexPosition = output.getPosition();
+
+	output.writeInt(blockPositions.size() - 1);
+
+	for (int i = 0; i < blockPositions.size(); i++)
+		output.writeInt64(blockPositions[i]);
+
+	const int64 endPosition = output.getPosition();
+
+	output.setPosition(5);
+	output.writeInt64(lengthInSamples);
+	output.writeInt64(indexPosition);
+
+	output.setPosition(endPosition);
+	output.flush();
+}
+
+// ==================================================================================================== CompressedMonolithAudioFormatReader methods
+
+CompressedMonolithAudioFormatReader::CompressedMonolithAudioFormatReader(const File &f, const AudioFormatReader &details) :
+	AudioFormatReader(nullptr, "HISE Compressed Monolith"),
+	blockSize(0),
+	numFileChannels(0)
+{
+	sampleRate = details.sampleRate;
+	bitsPerSample = 16;
+	usesFloatingPointData = false;
+	lengthInSamples = 0;
+	numChannels = 0;
+
+	map = new MemoryMappedFile(f, MemoryMappedFile::readOnly);
+
+	if (map->getData() == nullptr || map->getSize() < MonolithBlockCodec::HeaderSize)
+	{
+		map = nullptr;
+		return;
+	}
+
+	MemoryInputStream header(map->getData(), map->getSize(), false);
+
+	const uint8 flags = (uint8)header.readByte();
+	blockSize = header.readInt();
+	const int64 length = header.readInt64();
+	const int64 indexPosition = header.readInt64();
+
+	if (!MonolithFileHeader::isCompressed(flags) || blockSize <= 0 || blockSize > MonolithBlockCodec::BlockSize ||
+		indexPosition < MonolithBlockCodec::HeaderSize || !header.setPosition(indexPosition))
+	{
+		jassertfalse;
+		map = nullptr;
+		return;
+	}
+
+	const int numBlocks = header.readInt();
+
+	if (numBlocks < 0 || indexPosition + 4 + (int64)(numBlocks + 1) * 8 > (int64)map->getSize() ||
+		(int64)numBlocks * blockSize < length)
+	{
+		jassertfalse;
+		map = nullptr;
+		return;
+	}
+
+	blockPositions.ensureStorageAllocated(numBlocks + 1);
+
+	for (int i = 0; i <= numBlocks; i++)
+		blockPositions.add(header.readInt64());
+
+	numFileChannels = MonolithFileHeader::isMono(flags) ? 1 : 2;
+	numChannels = (unsigned int)numFileChannels;
+	lengthInSamples = length;
+
+	for (int i = 0; i < NumCachedBlocks; i++)
+	{
+		CachedBlock &cache = cachedBlocks[i];
+
+		cache.data.calloc(2 * (size_t)blockSize);
+		cache.channels[0] = cache.data;
+		cache.channels[1] = cache.data + blockSize;
+	}
+}
+
+bool CompressedMonolithAudioFormatReader::decodeBlock(int blockIndex, int numSamplesInBlock, int* const* destination) const
+{
+	const int64 blockPosition = blockPositions.getUnchecked(blockIndex);
+	const size_t blockBytes = (size_t)(blockPositions.getUnchecked(blockIndex + 1) - blockPosition);
+
+	return blockPosition + (int64)blockBytes <= (int64)map->getSize() &&
+		   MonolithBlockCodec::decodeBlock(static_cast<const char*>(map->getData()) + blockPosition, blockBytes, numFileChannels, numSamplesInBlock, destination);
+}
+
+bool CompressedMonolithAudioFormatReader::readSamples(int **destSamples, int numDestChannels, int startOffsetInDestBuffer, int64 startSampleInFile, int numSamples)
+{
+	clearSamplesBeyondAvailableLength(destSamples, numDestChannels, startOffsetInDestBuffer, startSampleInFile, numSamples, lengthInSamples);
+
+	if (!isValid())
+		return false;
+
+	int localData[2][MonolithBlockCodec::BlockSize];
+	int* localChannels[2] = { localData[0], localData[1] };
+
+	while (numSamples > 0)
+	{
+		const int blockIndex = (int)(startSampleInFile / blockSize);
+
+		if (!isPositiveAndBelow(blockIndex, blockPositions.size() - 1))
+			break;
+
+		const int64 blockStart = (int64)blockIndex * blockSize;
+		const int numSamplesInBlock = (int)jmin<int64>(blockSize, lengthInSamples - blockStart);
+		const int offsetInBlock = (int)(startSampleInFile - blockStart);
+		const int numThisTime = jmin<int>(numSamples, numSamplesInBlock - offsetInBlock);
+
+		CachedBlock &cache = cachedBlocks[blockIndex % NumCachedBlocks];
+
+		// If another thread uses this slot, the block is decoded into the local buffer
+		const GenericScopedTryLock<SpinLock> sl(cache.lock);
+
+		int* const* decodedChannels = sl.isLocked() ? cache.channels : localChannels;
+
+		bool ok = sl.isLocked() && cache.blockIndex == blockIndex;
+
+		if (!ok)
+		{
+			ok = decodeBlock(blockIndex, numSamplesInBlock, decodedChannels);
+
+			if (sl.isLocked())
+				cache.blockIndex = ok ? blockIndex : -1;
+		}
+
+		for (int c = 0; c < numDestChannels; c++)
+		{
+			if (int* dest = destSamples[c])
+			{
+				dest += startOffsetInDestBuffer;
+
+				if (ok)
+				{
+					const int* source = decodedChannels[jmin<int>(c, numFileChannels - 1)] + offsetInBlock;
+
+					// The reader returns 32 bit integer samples
+					for (int i = 0; i < numThisTime; i++)
+						dest[i] = source[i] * 65536;
+				}
+				else
+				{
+					jassertfalse;
+					zeromem(dest, sizeof(int) * (size_t)numThisTime);
+				}
+			}
+		}
+
+		startOffsetInDestBuffer += numThisTime;
+		startSampleInFile += numThisTime;
+		numSamples -= numThisTime;
+	}
+
+	return true;
+}
+
+// ==================================================================================================== SampleDataConversion methods
+
+namespace SampleConversionHelpers
+{
+
+typedef AudioData::Pointer<AudioData::Float32, AudioData::NativeEndian, AudioData::NonInterleaved, AudioData::NonConst> FloatDestination;
+typedef AudioData::Pointer<AudioData::Float32, AudioData::NativeEndian, AudioData::NonInterleaved, AudioData::Const> FloatSource;
+
+/** The scalar conversion of one channel (used for the remaining samples of the vectorised loops). */
+template <class SampleType> void convertChannel(const void* source, int numSourceChannels, int channelIndex, float* destination, int numSamples) noexcept
+{
+	typedef AudioData::Pointer<SampleType, AudioData::LittleEndian, AudioData::Interleaved, AudioData::Const> SourcePointer;
+
+	if (destination == nullptr || numSamples <= 0)
+		return;
+
+	SourcePointer s(addBytesToPointer(source, channelIndex * SampleType::bytesPerSample), numSourceChannels);
+	FloatDestination(destination).convertSamples(s, numSamples);
+}
+
+template <class SampleType> void convertScalar(const void* source, int numSourceChannels, float* left, float* right, int startSample, int numSamples) noexcept
+{
+	const int numToConvert = numSamples - startSample;
+	const void* start = addBytesToPointer(source, startSample * numSourceChannels * SampleType::bytesPerSample);
+
+	convertChannel<SampleType>(start, numSourceChannels, 0, left != nullptr ? left + startSample : nullptr, numToConvert);
+
+	if (numSourceChannels == 2)
+		convertChannel<SampleType>(start, numSourceChannels, 1, right != nullptr ? right + startSample : nullptr, numToConvert);
+}
+
+inline int readInt24(const uint8* data) noexcept
+{
+	// Puts the 24 bits into the upper bytes so the sign is correct
+	return (int)(((uint32)data[0] << 8) | ((uint32)data[1] << 16) | ((uint32)data[2] << 24));
+}
+
+void convertInt16(const void* source, int numSourceChannels, float* left, float* right, int numSamples) noexcept
+{
+	int i = 0;
+
+#if HI_SAMPLER_USE_SSE && JUCE_LITTLE_ENDIAN
+	const int16* s = static_cast<const int16*>(source);
+	const __m128 gain = _mm_set1_ps(1.0f / 32768.0f);
+
+	if (numSourceChannels == 1 && left != nullptr)
+	{
+		for (; i + 8 <= numSamples; i += 8)
+		{
+			const __m128i raw = _mm_loadu_si128((const __m128i*)(s + i));
+
+			_mm_storeu_ps(left + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(raw, raw), 16)), gain));
+			_mm_storeu_ps(left + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(raw, raw), 16)), gain));
+		}
+	}
+	else if (numSourceChannels == 2 && left != nullptr && right != nullptr)
+	{
+		for (; i + 4 <= numSamples; i += 4)
+		{
+			const __m128i raw = _mm_loadu_si128((const __m128i*)(s + 2 * i));
+
+			// L0 R0 L1 R1 | L2 R2 L3 R3
+			const __m128 a = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(raw, raw), 16)), gain);
+			const __m128 b = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(raw, raw), 16)), gain);
+
+			_mm_storeu_ps(left + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+			_mm_storeu_ps(right + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+		}
+	}
+#endif
+
+	convertScalar<AudioData::Int16>(source, numSourceChannels, left, right, i, numSamples);
+}
+
+void convertInt24(const void* source, int numSourceChannels, float* left, float* right, int numSamples) noexcept
+{
+	int i = 0;
+
+#if HI_SAMPLER_USE_SSE
+	const uint8* s = static_cast<const uint8*>(source);
+	const __m128 gain = _mm_set1_ps(1.0f / 2147483648.0f);
+
+	if (numSourceChannels == 1 && left != nullptr)
+	{
+		for (; i + 4 <= numSamples; i += 4)
+		{
+			const uint8* d = s + 3 * i;
+			const __m128i raw = _mm_setr_epi32(readInt24(d), readInt24(d + 3), readInt24(d + 6), readInt24(d + 9));
+
+			_mm_storeu_ps(left + i, _mm_mul_ps(_mm_cvtepi32_ps(raw), gain));
+		}
+	}
+	else if (numSourceChannels == 2 && left != nullptr && right != nullptr)
+	{
+		for (; i + 4 <= numSamples; i += 4)
+		{
+			const uint8* d = s + 6 * i;
+			const __m128i l = _mm_setr_epi32(readInt24(d), readInt24(d + 6), readInt24(d + 12), readInt24(d + 18));
+			const __m128i r = _mm_setr_epi32(readInt24(d + 3), readInt24(d + 9), readInt24(d + 15), readInt24(d + 21));
+
+			_mm_storeu_ps(left + i, _mm_mul_ps(_mm_cvtepi32_ps(l), gain));
+			_mm_storeu_ps(right + i, _mm_mul_ps(_mm_cvtepi32_ps(r), gain));
+		}
+	}
+#endif
+
+	convertScalar<AudioData::Int24>(source, numSourceChannels, left, right, i, numSamples);
+}
+
+void convertFloat32(const void* source, int numSourceChannels, float* left, float* right, int numSamples) noexcept
+{
+	int i = 0;
+
+#if JUCE_LITTLE_ENDIAN
+	const float* s = static_cast<const float*>(source);
+
+	if (numSourceChannels == 1 && left != nullptr)
+	{
+		memcpy(left, s, sizeof(float) * (size_t)numSamples);
+		return;
+	}
+
+#if HI_SAMPLER_USE_SSE
+	if (numSourceChannels == 2 && left != nullptr && right != nullptr)
+	{
+		for (; i + 4 <= numSamples; i += 4)
+		{
+			const __m128 a = _mm_loadu_ps(s + 2 * i);
+			const __m128 b = _mm_loadu_ps(s + 2 * i + 4);
+
+			_mm_storeu_ps(left + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+			_mm_storeu_ps(right + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+		}
+	}
+#endif
+#endif
+
+	convertScalar<AudioData::Float32>(source, numSourceChannels, left, right, i, numSamples);
+}
+
+template <class SampleType> void convertFromFloat(const float* const* source, int numChannels, void* destination, int numSamples) noexcept
+{
+	typedef AudioData::Pointer<SampleType, AudioData::LittleEndian, AudioData::Interleaved, AudioData::NonConst> DestPointer;
+
+	for (int c = 0; c < numChannels; c++)
+	{
+		DestPointer d(addBytesToPointer(destination, c * SampleType::bytesPerSample), numChannels);
+		d.convertSamples(FloatSource(source[c]), numSamples);
+	}
+}
+
+} // namespace SampleConversionHelpers
+
+void SampleDataConversion::convertToFloat(MonolithFileHeader::SampleFormat format, const void* source, int numSourceChannels, float* const* destination, int numDestChannels, int numSamples) noexcept
+{
+	using namespace SampleConversionHelpers;
+
+	jassert(numSourceChannels == 1 || numSourceChannels == 2);
+
+	if (numSamples <= 0)
+		return;
+
+	float* left = numDestChannels > 0 ? destination[0] : nullptr;
+	float* right = numDestChannels > 1 ? destination[1] : nullptr;
+
+	float* copyDestination = nullptr;
+
+	if (numSourceChannels == 1)
+	{
+		// Convert into the first valid channel and copy it afterwards
+		if (left == nullptr)
+			std::swap(left, right);
+
+		copyDestination = right;
+		right = nullptr;
+	}
+
+	switch (format)
+	{
+	case MonolithFileHeader::Int24:		convertInt24(source, numSourceChannels, left, right, numSamples); break;
+	case MonolithFileHeader::Float32:	convertFloat32(source, numSourceChannels, left, right, numSamples); break;
+	case MonolithFileHeader::Int16:
+	case MonolithFileHeader::numSampleFormats:
+	default:							convertInt16(source, numSourceChannels, left, right, numSamples); break;
+	}
+
+	if (copyDestination != nullptr && left != nullptr)
+		FloatVectorOperations::copy(copyDestination, left, numSamples);
+}
+
+void SampleDataConversion::convertFromFloat(MonolithFileHeader::SampleFormat format, const float* const* source, int numChannels, void* destination, int numSamples) noexcept
+{
+	switch (format)
+	{
+	case MonolithFileHeader::Int24:		SampleConversionHelpers::convertFromFloat<AudioData::Int24>(source, numChannels, destination, numSamples); break;
+	case MonolithFileHeader::Float32:	SampleConversionHelpers::convertFromFloat<AudioData::Float32>(source, numChannels, destination, numSamples); break;
+	case MonolithFileHeader::Int16:
+	case MonolithFileHeader::numSampleFormats:
+	default:							SampleConversionHelpers::convertFromFloat<AudioData::Int16>(source, numChannels, destination, numSamples); break;
+	}
+}
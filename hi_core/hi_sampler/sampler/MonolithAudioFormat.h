@@ -37,15 +37,106 @@
 
 #define USE_FALLBACK_READERS_FOR_MONOLITH 0
 
+/** The first byte of a monolith file stores the channel amount, the sample format and the compression.
+*
+*	Old monoliths only store the mono flag (as bool), so they are read as 16 bit files.
+*/
+struct MonolithFileHeader
+{
+	enum Flags
+	{
+		MonoFlag = 0x01,
+		CompressedFlag = 0x02,
+		SampleFormatMask = 0x0C
+	};
+
+	/** The format of the uncompressed samples. It is stored in the bits of the SampleFormatMask. */
+	enum SampleFormat
+	{
+		Int16 = 0, ///< 16 bit integer (the default and the only format that can be compressed)
+		Int24, ///< packed 24 bit integer
+		Float32, ///< 32 bit float
+		numSampleFormats
+	};
+
+	static uint8 createFlags(bool isMono, SampleFormat format, bool isCompressed) noexcept
+	{
+		return (uint8)((isMono ? MonoFlag : 0) | (isCompressed ? CompressedFlag : 0) | ((int)format << 2));
+	}
+
+	static bool isMono(uint8 flags) noexcept { return (flags & MonoFlag) != 0; }
+
+	static bool isCompressed(uint8 flags) noexcept { return (flags & CompressedFlag) != 0; }
+
+	static SampleFormat getSampleFormat(uint8 flags) noexcept
+	{
+		const int format = (flags & SampleFormatMask) >> 2;
+
+		// Unknown format (probably written by a newer version)
+		jassert(format < numSampleFormats);
+
+		return format < numSampleFormats ? (SampleFormat)format : Int16;
+	}
+
+	static int getBytesPerSample(SampleFormat format) noexcept
+	{
+		switch (format)
+		{
+		case Int24:		return 3;
+		case Float32:	return 4;
+		case Int16:
+		case numSampleFormats:
+		default:		return 2;
+		}
+	}
+
+	static int getBitsPerSample(SampleFormat format) noexcept { return 8 * getBytesPerSample(format); }
+};
+
+/** Converts interleaved little endian sample data into float buffers.
+*
+*	The monolith readers write the float samples directly into the streaming buffers (they set usesFloatingPointData),
+*	so this is the only conversion step between the file and the voice. The 16 bit and float paths are vectorised
+*	with SSE2 on Intel CPUs, the 24 bit path assembles the integers and vectorises the float conversion.
+*/
+struct SampleDataConversion
+{
+	/** Converts the samples. A destination channel can be nullptr, a mono source is copied to every destination channel. */
+	static void convertToFloat(MonolithFileHeader::SampleFormat format, const void* source, int numSourceChannels, float* const* destination, int numDestChannels, int numSamples) noexcept;
+
+	/** Converts float samples into the interleaved little endian format. */
+	static void convertFromFloat(MonolithFileHeader::SampleFormat format, const float* const* source, int numChannels, void* destination, int numSamples) noexcept;
+
+	/** Calls convertToFloat() with the integer destination of AudioFormatReader::readSamples(). */
+	static void copyToReaderDestination(MonolithFileHeader::SampleFormat format, int* const* destSamples, int startOffsetInDestBuffer, int numDestChannels, const void* source, int numSourceChannels, int numSamples) noexcept
+	{
+		float* destination[2] = { nullptr, nullptr };
+
+		for (int i = 0; i < jmin<int>(2, numDestChannels); i++)
+		{
+			if (destSamples[i] != nullptr)
+				destination[i] = reinterpret_cast<float*>(destSamples[i]) + startOffsetInDestBuffer;
+		}
+
+		convertToFloat(format, source, numSourceChannels, destination, 2, numSamples);
+	}
+};
+
 class MonolithAudioFormatReader : public MemoryMappedAudioFormatReader
 {
 public:
 
 
-	MonolithAudioFormatReader(const File &f, AudioFormatReader &details, int64 start, int64 length, bool isMono):
-		MemoryMappedAudioFormatReader(f, details, start, length, (isMono ? 1 : 2) * sizeof(int16)),
-		numChannels(isMono ? 1 : 2)
-	{}
+	MonolithAudioFormatReader(const File &f, AudioFormatReader &details, int64 start, int64 length, bool isMono, MonolithFileHeader::SampleFormat format_=MonolithFileHeader::Int16):
+		MemoryMappedAudioFormatReader(f, details, start, length, (isMono ? 1 : 2) * MonolithFileHeader::getBytesPerSample(format_)),
+		numChannels(isMono ? 1 : 2),
+		format(format_)
+	{
+		bitsPerSample = MonolithFileHeader::getBitsPerSample(format);
+
+		// The samples are converted to float in readSamples()
+		usesFloatingPointData = true;
+	}
 
 	bool readSamples(int **destSamples, int numDestChannels, int startOffsetInDestBuffer, int64 startSampleInFile, int numSamples) override
 	{
@@ -58,7 +149,7 @@ public:
 			return false;
 		}
 
-		copySampleData (destSamples, startOffsetInDestBuffer, numDestChannels, sampleToPointer (startSampleInFile), numChannels, numSamples);
+		SampleDataConversion::copyToReaderDestination(format, destSamples, startOffsetInDestBuffer, numDestChannels, sampleToPointer (startSampleInFile), numChannels, numSamples);
 
 		return true;
 	}
@@ -74,30 +165,16 @@ public:
 			return;
 		}
 
-		float** dest = &result;
+		float* dest[2] = { result, result + 1 };
 		const void* source = sampleToPointer(sample);
 
-		ReadHelper<AudioData::Float32, AudioData::Int16, AudioData::LittleEndian>::read(dest, 0, 1, source, 2, 1);	
-	}
-
-	static void copySampleData(int* const* destSamples, int startOffsetInDestBuffer, int numDestChannels, const void* sourceData, int numChannels, int numSamples) noexcept
-	{
-		jassert(numDestChannels == numDestChannels);
-
-		if (numChannels == 1)
-		{
-			ReadHelper<AudioData::Int32, AudioData::Int16, AudioData::LittleEndian>::read(destSamples, startOffsetInDestBuffer, 1, sourceData, 1, numSamples);
-			//FloatVectorOperations::copy(reinterpret_cast<float*>(destSamples[1]), reinterpret_cast<float*>(destSamples[0]), numSamples);
-		}
-		else
-		{
-			ReadHelper<AudioData::Int32, AudioData::Int16, AudioData::LittleEndian>::read(destSamples, startOffsetInDestBuffer, numDestChannels, sourceData, 2, numSamples);
-		}
+		SampleDataConversion::convertToFloat(format, source, numChannels, dest, 2, 1);
 	}
 
 private:
 
 	const int numChannels;
+	const MonolithFileHeader::SampleFormat format;
 };
 
 
@@ -105,12 +182,15 @@ class FallbackMonolithAudioFormatReader: public AudioFormatReader
 {
 public:
     
-    FallbackMonolithAudioFormatReader(InputStream* const input, bool isMono):
-      AudioFormatReader(input, "HISE")
+    FallbackMonolithAudioFormatReader(InputStream* const input, bool isMono, MonolithFileHeader::SampleFormat format_=MonolithFileHeader::Int16):
+      AudioFormatReader(input, "HISE"),
+	  format(format_)
     {
         numChannels = isMono ? 1 : 2;
+		bitsPerSample = MonolithFileHeader::getBitsPerSample(format);
+		usesFloatingPointData = true;
         
-        const int bytesPerFrame = sizeof(int16) * numChannels;
+        const int bytesPerFrame = MonolithFileHeader::getBytesPerSample(format) * numChannels;
         
         lengthInSamples = (input->getTotalLength() - 1) / bytesPerFrame;
     };
@@ -125,7 +205,7 @@ public:
         if (numSamples <= 0)
             return true;
         
-        const int bytesPerFrame = sizeof(int16) * numChannels;
+        const int bytesPerFrame = MonolithFileHeader::getBytesPerSample(format) * numChannels;
         
         input->setPosition (1 + startSampleInFile * bytesPerFrame);
         
@@ -143,8 +223,7 @@ public:
                 zeromem (tempBuffer + bytesRead, (size_t) (numThisTime * bytesPerFrame - bytesRead));
             }
             
-            copySampleData (destSamples, startOffsetInDestBuffer, numDestChannels,
-                            tempBuffer, (int) numChannels, numThisTime);
+			SampleDataConversion::copyToReaderDestination(format, destSamples, startOffsetInDestBuffer, numDestChannels, tempBuffer, (int)numChannels, numThisTime);
             
             startOffsetInDestBuffer += numThisTime;
             numSamples -= numThisTime;
@@ -152,23 +231,124 @@ public:
         
         return true;
     }
-    
-    static void copySampleData(int* const* destSamples, int startOffsetInDestBuffer, int numDestChannels, const void* sourceData, int numChannels, int numSamples) noexcept
-    {
-        if (numChannels == 1)
-        {
-            ReadHelper<AudioData::Int32, AudioData::Int16, AudioData::LittleEndian>::read(destSamples, startOffsetInDestBuffer, 1, sourceData, 1, numSamples);
-            
-            if(numDestChannels == 2)
-            {
-                FloatVectorOperations::copy(reinterpret_cast<float*>(destSamples[1]), reinterpret_cast<float*>(destSamples[0]), numSamples);
-            }
-        }
-        else
-        {
-            ReadHelper<AudioData::Int32, AudioData::Int16, AudioData::LittleEndian>::read(destSamples, startOffsetInDestBuffer, numDestChannels, sourceData, 2, numSamples);
-        }
-    }
+
+private:
+
+	const MonolithFileHeader::SampleFormat format;
+};
+
+/** A lossless codec for the compressed monolith format.
+*
+*	The samples are split into blocks that can be decoded independently, so a reader only needs to decode the blocks
+*	that contain the requested range. Every channel of a block uses one of the fixed polynomial predictors (like FLAC)
+*	and stores the residuals with Rice coding. Stereo blocks store the side channel (left - right) instead of the
+*	right channel if it needs less bits.
+*
+*	A compressed monolith file has this layout (all values are little endian):
+*
+*		uint8	flags (see MonolithFileHeader)
+*		int32	block size
+*		int64	length in samples
+*		int64	position of the block index
+*		...		the compressed blocks
+*		int32	number of blocks
+*		int64	file position of every block + the end position of the last block
+*/
+class MonolithBlockCodec
+{
+public:
+
+	enum
+	{
+		BlockSize = 4096,
+		PartitionSize = 256,
+		MaxPredictionOrder = 3,
+		HeaderSize = 21
+	};
+
+	/** Encodes a block of samples and appends it to the output stream. */
+	static void encodeBlock(const int16* const* channels, int numChannels, int numSamples, OutputStream &output);
+
+	/** Decodes a block into the destination buffers (with 16 bit values). Returns false if the data is corrupt. */
+	static bool decodeBlock(const void* data, size_t numBytes, int numChannels, int numSamples, int* const* destination);
+
+	/** Writes a compressed monolith file. */
+	class Writer
+	{
+	public:
+
+		/** Writes the header into the stream. The stream must support setPosition(). */
+		Writer(OutputStream &output, bool isMono);
+
+		/** Converts the samples to 16 bit and encodes every full block. */
+		void addSamples(const AudioSampleBuffer &buffer, int numSamples);
+
+		/** Writes the last block and the block index. */
+		void finish();
+
+	private:
+
+		void flushBlock();
+
+		OutputStream &output;
+		const int numChannels;
+
+		HeapBlock<int16> pendingData;
+		int numPendingSamples;
+
+		int64 lengthInSamples;
+		Array<int64> blockPositions;
+
+		JUCE_DECLARE_NON_COPYABLE(Writer)
+	};
+};
+
+/** Reads a compressed monolith file. It maps the file into memory and decodes only the blocks that are needed.
+*
+*	The last decoded blocks are cached, so reading a block in smaller chunks decodes it only once. The reader is shared by
+*	all samples of the monolith, so a thread that finds the cache slot of its block in use decodes the block into a local
+*	buffer instead of waiting.
+*/
+class CompressedMonolithAudioFormatReader : public AudioFormatReader
+{
+public:
+
+	enum
+	{
+		NumCachedBlocks = 4
+	};
+
+	CompressedMonolithAudioFormatReader(const File &f, const AudioFormatReader &details);
+
+	/** Returns false if the file could not be mapped or the header is corrupt. */
+	bool isValid() const noexcept { return map != nullptr && blockPositions.size() > 1; }
+
+	bool readSamples(int **destSamples, int numDestChannels, int startOffsetInDestBuffer, int64 startSampleInFile, int numSamples) override;
+
+private:
+
+	/** Decodes the block into the destination. Returns false if the data is corrupt. */
+	bool decodeBlock(int blockIndex, int numSamplesInBlock, int* const* destination) const;
+
+	struct CachedBlock
+	{
+		CachedBlock() : blockIndex(-1) {};
+
+		SpinLock lock;
+		int blockIndex;
+		HeapBlock<int> data;
+		int* channels[2];
+	};
+
+	ScopedPointer<MemoryMappedFile> map;
+
+	Array<int64> blockPositions;
+	int blockSize;
+	int numFileChannels;
+
+	CachedBlock cachedBlocks[NumCachedBlocks];
+
+	JUCE_DECLARE_NON_COPYABLE(CompressedMonolithAudioFormatReader)
 };
 
 class HiseMonolithAudioFormat: public AudioFormat,
@@ -186,11 +366,30 @@ public:
 		for (int i = 0; i < monoFiles_.size(); i++)
 		{
 			FileInputStream fis(monoFiles_[i]);
-			isMonoChannel[i] = fis.readBool();
+
+			// Old monoliths store a bool, so the first byte is either 0 or 1
+			const uint8 flags = (uint8)fis.readByte();
+
+			isMonoChannel[i] = MonolithFileHeader::isMono(flags);
+			isCompressedChannel[i] = MonolithFileHeader::isCompressed(flags);
+			sampleFormats[i] = MonolithFileHeader::getSampleFormat(flags);
 			monolithicFiles.push_back(monoFiles_[i]);
 
-            ScopedPointer<FileInputStream> fallbackStream = new FileInputStream(monoFiles_[i]);
-            fallbackReaders.add(new FallbackMonolithAudioFormatReader(fallbackStream.release(), isMonoChannel[i]));
+			if (isCompressedChannel[i])
+			{
+				// The compressed reader doesn't use a stream so it can be used as fallback reader too
+				fallbackReaders.add(new CompressedMonolithAudioFormatReader(monoFiles_[i], dummyReader));
+
+				// The batched reads need raw samples
+				fileHandles.add(nullptr);
+			}
+			else
+			{
+				ScopedPointer<FileInputStream> fallbackStream = new FileInputStream(monoFiles_[i]);
+				fallbackReaders.add(new FallbackMonolithAudioFormatReader(fallbackStream.release(), isMonoChannel[i], sampleFormats[i]));
+
+				fileHandles.add(AsyncReadBatch::FileHandle::open(monoFiles_[i]));
+			}
 		}
 
 		dummyReader.numChannels = 2;
@@ -247,12 +446,19 @@ public:
 		{
 			dummyReader.numChannels = isMonoChannel[i] ? 1 : 2;
 			dummyReader.sampleRate = multiChannelSampleInformation[i][0].sampleRate;
+			dummyReader.bitsPerSample = MonolithFileHeader::getBitsPerSample(sampleFormats[i]);
+
+			if (isCompressedChannel[i])
+			{
+				memoryReaders.add(new CompressedMonolithAudioFormatReader(monolithicFiles[i], dummyReader));
+				continue;
+			}
 
-			const int bytesPerFrame = sizeof(int16) * dummyReader.numChannels;
+			const int bytesPerFrame = MonolithFileHeader::getBytesPerSample(sampleFormats[i]) * dummyReader.numChannels;
 			FileInputStream fis(monolithicFiles[i]);
 			dummyReader.lengthInSamples = (fis.getTotalLength() - 1) / bytesPerFrame;
 
-			ScopedPointer<MonolithAudioFormatReader> reader = new MonolithAudioFormatReader(monolithicFiles[i], dummyReader, 1, fis.getTotalLength() - 1, isMonoChannel[i]);
+			ScopedPointer<MonolithAudioFormatReader> reader = new MonolithAudioFormatReader(monolithicFiles[i], dummyReader, 1, fis.getTotalLength() - 1, isMonoChannel[i], sampleFormats[i]);
 			reader->mapEntireFile();
 			memoryReaders.add(reader.release());
 		}
@@ -364,6 +570,41 @@ public:
     {
         return multiChannelSampleInformation[0][sampleIndex].sampleRate;
     }
+
+	/** Fills the layout for batched reading of the given sample. Returns false if the platform doesn't support it. */
+	bool fillAsyncLayout(int sampleIndex, int channelIndex, AsyncReadBatch::FileLayout &layout) const
+	{
+		layout = AsyncReadBatch::FileLayout();
+
+		if (!isPositiveAndBelow(channelIndex, (int)multiChannelSampleInformation.size()) ||
+			!isPositiveAndBelow(sampleIndex, (int)multiChannelSampleInformation[channelIndex].size()))
+		{
+			return false;
+		}
+
+		const SampleInfo &info = multiChannelSampleInformation[channelIndex][sampleIndex];
+
+		if (isCompressedChannel[channelIndex])
+			return false;
+
+		layout.file = fileHandles[channelIndex];
+		layout.numChannels = isMonoChannel[channelIndex] ? 1 : 2;
+
+		switch (sampleFormats[channelIndex])
+		{
+		case MonolithFileHeader::Int24:		layout.format = AsyncReadBatch::Int24LittleEndian; break;
+		case MonolithFileHeader::Float32:	layout.format = AsyncReadBatch::Float32LittleEndian; break;
+		case MonolithFileHeader::Int16:
+		case MonolithFileHeader::numSampleFormats:
+		default:							layout.format = AsyncReadBatch::Int16LittleEndian; break;
+		}
+
+		// The first byte of a monolith is the header
+		layout.dataStart = 1 + info.start * layout.getBytesPerFrame();
+		layout.lengthInSamples = info.length;
+
+		return layout.isValid();
+	}
     
 	struct SampleInfo
 	{
@@ -398,10 +639,14 @@ public:
 	std::vector<File> monolithicFiles;
 
 	bool isMonoChannel[6];
+	bool isCompressedChannel[6];
+	MonolithFileHeader::SampleFormat sampleFormats[6];
     
-    OwnedArray<FallbackMonolithAudioFormatReader> fallbackReaders;
+    OwnedArray<AudioFormatReader> fallbackReaders;
+
+	OwnedArray<AudioFormatReader> memoryReaders;
 
-	OwnedArray<MonolithAudioFormatReader> memoryReaders;
+	ReferenceCountedArray<AsyncReadBatch::FileHandle> fileHandles;
 };
 
 #endif  // MONOLITHAUDIOFORMAT_H_INCLUDED
@@ -0,0 +1,502 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licences for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licencing:
+*
+*   http://www.hartinstruments.net/hise/
+*
+*   HISE is based on the JUCE library,
+*   which also must be licenced for commercial applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+
+#include "JuceHeader.h"
+
+class MonolithCodecUnitTest : public UnitTest
+{
+public:
+
+	MonolithCodecUnitTest() :
+		UnitTest("Testing compressed monolith codec")
+	{
+
+	}
+
+	void runTest() override
+	{
+		testBlockRoundtrip();
+		testReader();
+		testChunkedReads();
+		testSampleFormats();
+		testDecodingSpeed();
+	}
+
+private:
+
+	enum SignalType
+	{
+		Silence = 0,
+		Sine,
+		Noise,
+		FullScale,
+		numSignalTypes
+	};
+
+	void fillSignal(AudioSampleBuffer &b, SignalType type)
+	{
+		for (int c = 0; c < b.getNumChannels(); c++)
+		{
+			float* d = b.getWritePointer(c);
+
+			for (int i = 0; i < b.getNumSamples(); i++)
+			{
+				switch (type)
+				{
+				case Silence:	d[i] = 0.0f; break;
+				case Sine:		d[i] = 0.7f * std::sin((float)i * 0.01f * (float)(c + 1)) + 0.01f * (r.nextFloat() - 0.5f); break;
+				case Noise:		d[i] = r.nextFloat() * 2.0f - 1.0f; break;
+				case FullScale:	d[i] = (i % 2 == 0) ? 1.0f : -1.0f; break;
+				case numSignalTypes: break;
+				}
+			}
+		}
+	}
+
+	void toInt16(const AudioSampleBuffer &b, HeapBlock<int16> &data)
+	{
+		data.calloc(b.getNumChannels() * b.getNumSamples());
+
+		for (int c = 0; c < b.getNumChannels(); c++)
+		{
+			AudioData::Pointer<AudioData::Int16, AudioData::NativeEndian, AudioData::NonInterleaved, AudioData::NonConst>(data + c * b.getNumSamples()).convertSamples(
+				AudioData::Pointer<AudioData::Float32, AudioData::NativeEndian, AudioData::NonInterleaved, AudioData::Const>(b.getReadPointer(c)), b.getNumSamples());
+		}
+	}
+
+	void testBlockRoundtrip()
+	{
+		beginTest("Testing block roundtrip");
+
+		const int lengths[] = { 1, 3, 17, MonolithBlockCodec::BlockSize };
+
+		for (int numChannels = 1; numChannels <= 2; numChannels++)
+		{
+			for (int type = 0; type < numSignalTypes; type++)
+			{
+				for (int l = 0; l < 4; l++)
+				{
+					const int numSamples = lengths[l];
+
+					AudioSampleBuffer b(numChannels, numSamples);
+					fillSignal(b, (SignalType)type);
+
+					HeapBlock<int16> data;
+					toInt16(b, data);
+
+					const int16* channels[2] = { data.getData(), data + (numChannels - 1) * numSamples };
+
+					MemoryOutputStream mos;
+					MonolithBlockCodec::encodeBlock(channels, numChannels, numSamples, mos);
+
+					HeapBlock<int> decoded;
+					decoded.calloc(2 * numSamples);
+					int* decodedChannels[2] = { decoded.getData(), decoded + numSamples };
+
+					const bool ok = MonolithBlockCodec::decodeBlock(mos.getData(), mos.getDataSize(), numChannels, numSamples, decodedChannels);
+
+					expect(ok, "Decoding block");
+
+					int numErrors = 0;
+
+					for (int c = 0; c < numChannels; c++)
+						for (int i = 0; i < numSamples; i++)
+							numErrors += decodedChannels[c][i] != (int)channels[c][i] ? 1 : 0;
+
+					expectEquals<int>(numErrors, 0, "Lossless roundtrip, type: " + String(type) + ", channels: " + String(numChannels) + ", length: " + String(numSamples));
+				}
+			}
+		}
+	}
+
+	struct DetailsReader : public AudioFormatReader
+	{
+		DetailsReader(bool isMono, int numSamples) :
+			AudioFormatReader(nullptr, "Details")
+		{
+			sampleRate = 44100.0;
+			bitsPerSample = 16;
+			numChannels = isMono ? 1 : 2;
+			lengthInSamples = numSamples;
+		}
+
+		bool readSamples(int**, int, int, int64, int) override { return false; }
+	};
+
+	/** Writes the same signal as compressed and uncompressed monolith. */
+	void writeTestFiles(const File &compressed, const File &uncompressed, const AudioSampleBuffer &b)
+	{
+		compressed.deleteFile();
+		uncompressed.deleteFile();
+
+		{
+			FileOutputStream fos(compressed);
+			MonolithBlockCodec::Writer writer(fos, false);
+
+			// Add the samples in odd chunks to test the block handling of the writer
+			for (int i = 0; i < b.getNumSamples(); i += 10000)
+			{
+				const int numThisTime = jmin<int>(10000, b.getNumSamples() - i);
+				AudioSampleBuffer chunk(const_cast<float**>(b.getArrayOfReadPointers()), 2, i, numThisTime);
+				writer.addSamples(chunk, numThisTime);
+			}
+
+			writer.finish();
+		}
+
+		{
+			FileOutputStream fos(uncompressed);
+			fos.writeBool(false);
+
+			HeapBlock<int16> data;
+			data.calloc(2 * b.getNumSamples());
+
+			for (int c = 0; c < 2; c++)
+			{
+				AudioData::Pointer<AudioData::Int16, AudioData::LittleEndian, AudioData::Interleaved, AudioData::NonConst>(data + c, 2).convertSamples(
+					AudioData::Pointer<AudioData::Float32, AudioData::NativeEndian, AudioData::NonInterleaved, AudioData::Const>(b.getReadPointer(c)), b.getNumSamples());
+			}
+
+			fos.write(data.getData(), 2 * sizeof(int16) * b.getNumSamples());
+		}
+	}
+
+	void testReader()
+	{
+		beginTest("Testing compressed monolith reader");
+
+		const int numSamples = 100000;
+
+		AudioSampleBuffer b(2, numSamples);
+		fillSignal(b, Sine);
+
+		File compressed = File::getSpecialLocation(File::tempDirectory).getChildFile("MonolithTest.compressed");
+		File uncompressed = File::getSpecialLocation(File::tempDirectory).getChildFile("MonolithTest.raw");
+
+		writeTestFiles(compressed, uncompressed, b);
+
+		DetailsReader details(false, numSamples);
+
+		CompressedMonolithAudioFormatReader compressedReader(compressed, details);
+		MonolithAudioFormatReader rawReader(uncompressed, details, 1, uncompressed.getSize() - 1, false);
+		rawReader.mapEntireFile();
+
+		expect(compressedReader.isValid(), "Compressed reader is valid");
+		expectEquals<int64>(compressedReader.lengthInSamples, (int64)numSamples, "Length");
+
+		AudioSampleBuffer b1(2, 9000);
+		AudioSampleBuffer b2(2, 9000);
+
+		for (int i = 0; i < 50; i++)
+		{
+			const int start = r.nextInt(numSamples);
+
+			compressedReader.read(&b1, 0, 9000, start, true, true);
+			rawReader.read(&b2, 0, 9000, start, true, true);
+
+			int numErrors = 0;
+
+			for (int c = 0; c < 2; c++)
+				for (int s = 0; s < 9000; s++)
+					numErrors += b1.getSample(c, s) != b2.getSample(c, s) ? 1 : 0;
+
+			expectEquals<int>(numErrors, 0, "Compressed read at " + String(start));
+		}
+
+		compressed.deleteFile();
+		uncompressed.deleteFile();
+	}
+
+	/** Reads random chunks and compares them with the raw reader. */
+	class ChunkReader : public Thread
+	{
+	public:
+
+		ChunkReader(AudioFormatReader &compressedReader_, AudioFormatReader &rawReader_, int index) :
+			Thread("Chunk Reader " + String(index)),
+			compressedReader(compressedReader_),
+			rawReader(rawReader_),
+			r(index + 1),
+			numErrors(0)
+		{};
+
+		void run() override
+		{
+			AudioSampleBuffer b1(2, 700);
+			AudioSampleBuffer b2(2, 700);
+
+			for (int i = 0; i < 2000; i++)
+			{
+				const int numSamples = 1 + r.nextInt(700);
+				const int start = r.nextInt((int)rawReader.lengthInSamples);
+
+				compressedReader.read(&b1, 0, numSamples, start, true, true);
+				rawReader.read(&b2, 0, numSamples, start, true, true);
+
+				for (int c = 0; c < 2; c++)
+					for (int s = 0; s < numSamples; s++)
+						numErrors += b1.getSample(c, s) != b2.getSample(c, s) ? 1 : 0;
+			}
+		}
+
+		AudioFormatReader &compressedReader;
+		AudioFormatReader &rawReader;
+		Random r;
+		int numErrors;
+	};
+
+	void testChunkedReads()
+	{
+		beginTest("Testing small and concurrent reads of the compressed monolith reader");
+
+		const int numSamples = 50000;
+
+		AudioSampleBuffer b(2, numSamples);
+		fillSignal(b, Noise);
+
+		File compressed = File::getSpecialLocation(File::tempDirectory).getChildFile("MonolithChunkTest.compressed");
+		File uncompressed = File::getSpecialLocation(File::tempDirectory).getChildFile("MonolithChunkTest.raw");
+
+		writeTestFiles(compressed, uncompressed, b);
+
+		DetailsReader details(false, numSamples);
+
+		CompressedMonolithAudioFormatReader compressedReader(compressed, details);
+		MonolithAudioFormatReader rawReader(uncompressed, details, 1, uncompressed.getSize() - 1, false);
+		rawReader.mapEntireFile();
+
+		AudioSampleBuffer b1(2, numSamples);
+		AudioSampleBuffer b2(2, numSamples);
+
+		rawReader.read(&b2, 0, numSamples, 0, true, true);
+
+		const int chunkSizes[] = { 1, 37, 256, 5000 };
+
+		for (int i = 0; i < numElementsInArray(chunkSizes); i++)
+		{
+			b1.clear();
+
+			// Two readers that take turns, so the blocks of both positions are cached at the same time
+			for (int pos = 0; pos < numSamples / 2; pos += chunkSizes[i])
+			{
+				const int numThisTime = jmin<int>(chunkSizes[i], numSamples / 2 - pos);
+
+				compressedReader.read(&b1, pos, numThisTime, pos, true, true);
+				compressedReader.read(&b1, numSamples / 2 + pos, numThisTime, numSamples / 2 + pos, true, true);
+			}
+
+			int numErrors = 0;
+
+			for (int c = 0; c < 2; c++)
+				for (int s = 0; s < numSamples; s++)
+					numErrors += b1.getSample(c, s) != b2.getSample(c, s) ? 1 : 0;
+
+			expectEquals<int>(numErrors, 0, "Reading chunks of " + String(chunkSizes[i]) + " samples");
+		}
+
+		OwnedArray<ChunkReader> readers;
+
+		for (int i = 0; i < 4; i++)
+			readers.add(new ChunkReader(compressedReader, rawReader, i));
+
+		for (int i = 0; i < readers.size(); i++)
+			readers[i]->startThread();
+
+		for (int i = 0; i < readers.size(); i++)
+		{
+			readers[i]->waitForThreadToExit(-1);
+			expectEquals<int>(readers[i]->numErrors, 0, "Errors of thread " + String(i));
+		}
+
+		compressed.deleteFile();
+		uncompressed.deleteFile();
+	}
+
+	void testSampleFormats()
+	{
+		beginTest("Testing 24 bit and float monoliths");
+
+		const int numSamples = 1001;
+
+		for (int f = 0; f < MonolithFileHeader::numSampleFormats; f++)
+		{
+			const MonolithFileHeader::SampleFormat format = (MonolithFileHeader::SampleFormat)f;
+
+			for (int numChannels = 1; numChannels <= 2; numChannels++)
+			{
+				AudioSampleBuffer b(numChannels, numSamples);
+				fillSignal(b, Noise);
+
+				File file = File::getSpecialLocation(File::tempDirectory).getChildFile("MonolithFormatTest.raw");
+				file.deleteFile();
+
+				const int bytesPerFrame = MonolithFileHeader::getBytesPerSample(format) * numChannels;
+
+				{
+					HeapBlock<char> data;
+					data.calloc(bytesPerFrame * numSamples);
+
+					SampleDataConversion::convertFromFloat(format, b.getArrayOfReadPointers(), numChannels, data, numSamples);
+
+					FileOutputStream fos(file);
+					fos.writeByte((char)MonolithFileHeader::createFlags(numChannels == 1, format, false));
+					fos.write(data, bytesPerFrame * numSamples);
+				}
+
+				FileInputStream fis(file);
+
+				expect(MonolithFileHeader::getSampleFormat((uint8)fis.readByte()) == format, "Header format");
+
+				// The float data is stored without loss, the integer formats must match the scalar conversion
+				AudioSampleBuffer expected(numChannels, numSamples);
+				quantise(b, expected, format);
+
+				DetailsReader details(numChannels == 1, numSamples);
+
+				MonolithAudioFormatReader memoryReader(file, details, 1, file.getSize() - 1, numChannels == 1, format);
+				memoryReader.mapEntireFile();
+
+				FallbackMonolithAudioFormatReader fallbackReader(new FileInputStream(file), numChannels == 1, format);
+
+				AudioSampleBuffer b1(2, numSamples);
+				AudioSampleBuffer b2(2, numSamples);
+
+				memoryReader.read(&b1, 0, numSamples, 0, true, true);
+				fallbackReader.read(&b2, 0, numSamples, 0, true, true);
+
+				int numErrors = 0;
+
+				for (int c = 0; c < 2; c++)
+				{
+					for (int i = 0; i < numSamples; i++)
+					{
+						const float e = expected.getSample(jmin<int>(c, numChannels - 1), i);
+
+						numErrors += (b1.getSample(c, i) != e) ? 1 : 0;
+						numErrors += (b2.getSample(c, i) != e) ? 1 : 0;
+					}
+				}
+
+				expectEquals<int>(numErrors, 0, "Format: " + String(f) + ", channels: " + String(numChannels));
+
+				file.deleteFile();
+			}
+		}
+	}
+
+	void quantise(const AudioSampleBuffer &source, AudioSampleBuffer &dest, MonolithFileHeader::SampleFormat format)
+	{
+		typedef AudioData::Pointer<AudioData::Float32, AudioData::NativeEndian, AudioData::NonInterleaved, AudioData::Const> FloatSource;
+		typedef AudioData::Pointer<AudioData::Float32, AudioData::NativeEndian, AudioData::NonInterleaved, AudioData::NonConst> FloatDest;
+
+		for (int c = 0; c < source.getNumChannels(); c++)
+		{
+			HeapBlock<int> temp;
+			temp.calloc(source.getNumSamples());
+
+			if (format == MonolithFileHeader::Int16)
+			{
+				AudioData::Pointer<AudioData::Int16, AudioData::NativeEndian, AudioData::NonInterleaved, AudioData::NonConst>(temp).convertSamples(FloatSource(source.getReadPointer(c)), source.getNumSamples());
+				FloatDest(dest.getWritePointer(c)).convertSamples(AudioData::Pointer<AudioData::Int16, AudioData::NativeEndian, AudioData::NonInterleaved, AudioData::Const>(temp), source.getNumSamples());
+			}
+			else if (format == MonolithFileHeader::Int24)
+			{
+				AudioData::Pointer<AudioData::Int24, AudioData::NativeEndian, AudioData::NonInterleaved, AudioData::NonConst>(temp).convertSamples(FloatSource(source.getReadPointer(c)), source.getNumSamples());
+				FloatDest(dest.getWritePointer(c)).convertSamples(AudioData::Pointer<AudioData::Int24, AudioData::NativeEndian, AudioData::NonInterleaved, AudioData::Const>(temp), source.getNumSamples());
+			}
+			else
+			{
+				dest.copyFrom(c, 0, source, c, 0, source.getNumSamples());
+			}
+		}
+	}
+
+	void testDecodingSpeed()
+	{
+		beginTest("Comparing decoding speed with raw reading");
+
+		const int numSamples = 44100 * 60;
+
+		AudioSampleBuffer b(2, numSamples);
+		fillSignal(b, Sine);
+
+		File compressed = File::getSpecialLocation(File::tempDirectory).getChildFile("MonolithBenchmark.compressed");
+		File uncompressed = File::getSpecialLocation(File::tempDirectory).getChildFile("MonolithBenchmark.raw");
+
+		writeTestFiles(compressed, uncompressed, b);
+
+		DetailsReader details(false, numSamples);
+
+		CompressedMonolithAudioFormatReader compressedReader(compressed, details);
+		MonolithAudioFormatReader rawReader(uncompressed, details, 1, uncompressed.getSize() - 1, false);
+		rawReader.mapEntireFile();
+
+		AudioSampleBuffer streamingBuffer(2, 8192);
+		AudioSampleBuffer smallBuffer(2, 256);
+
+		// Read the whole file with streaming buffer sized chunks (the files will be in the OS cache).
+		const double compressedSeconds = measureReadTime(compressedReader, streamingBuffer, numSamples);
+		const double rawSeconds = measureReadTime(rawReader, streamingBuffer, numSamples);
+
+		// The cached blocks are only decoded once for all small reads
+		const double smallReadSeconds = measureReadTime(compressedReader, smallBuffer, numSamples);
+
+		const double pcmMegabytes = (double)numSamples * 2.0 * sizeof(int16) / (1024.0 * 1024.0);
+
+		logMessage("Compression ratio: " + String((double)compressed.getSize() / (double)uncompressed.getSize(), 3));
+		logMessage("Decoding speed: " + String(pcmMegabytes / compressedSeconds, 1) + " MB/s");
+		logMessage("Decoding speed with 256 sample reads: " + String(pcmMegabytes / smallReadSeconds, 1) + " MB/s");
+		logMessage("Raw reading speed: " + String(pcmMegabytes / rawSeconds, 1) + " MB/s");
+
+		expect(compressed.getSize() < uncompressed.getSize(), "Compressed file is smaller");
+
+		compressed.deleteFile();
+		uncompressed.deleteFile();
+	}
+
+	double measureReadTime(AudioFormatReader &reader, AudioSampleBuffer &buffer, int numSamples)
+	{
+		const double start = Time::getMillisecondCounterHiRes();
+
+		for (int i = 0; i < numSamples; i += buffer.getNumSamples())
+		{
+			reader.read(&buffer, 0, buffer.getNumSamples(), i, true, true);
+		}
+
+		return jmax<double>(0.001, (Time::getMillisecondCounterHiRes() - start) * 0.001);
+	}
+
+	Random r;
+};
+
+static MonolithCodecUnitTest monolithCodecTestInstance;
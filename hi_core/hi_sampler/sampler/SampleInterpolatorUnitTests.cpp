@@ -0,0 +1,231 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licences for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licencing:
+*
+*   http://www.hartinstruments.net/hise/
+*
+*   HISE is based on the JUCE library,
+*   which also must be licenced for commercial applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+
+#include "JuceHeader.h"
+
+class SampleInterpolatorUnitTest : public UnitTest
+{
+public:
+
+	SampleInterpolatorUnitTest() :
+		UnitTest("Testing the sampler resampling kernels")
+	{
+
+	}
+
+	void runTest() override
+	{
+		createInput();
+
+		testLinearMatchesOldLoop(false);
+		testLinearMatchesOldLoop(true);
+		testCubicAccuracy();
+		testSpeed();
+	}
+
+private:
+
+	enum
+	{
+		BlockSize = 512,
+		InputSize = 4096,
+		NumBenchmarkBlocks = 20000
+	};
+
+	void createInput()
+	{
+		input = AudioSampleBuffer(2, InputSize);
+
+		for (int i = 0; i < InputSize; i++)
+		{
+			input.setSample(0, i, 0.8f * (float)std::sin((double)i * 0.01));
+			input.setSample(1, i, 0.8f * (float)std::cos((double)i * 0.013));
+		}
+
+		pitchValues = AudioSampleBuffer(1, BlockSize);
+
+		for (int i = 0; i < BlockSize; i++)
+			pitchValues.setSample(0, i, 1.0f + 0.5f * (float)std::sin((double)i * 0.02));
+	}
+
+	/** The resampling loop of StreamingSamplerVoice::renderNextBlock() before the SampleInterpolator was added. */
+	static void renderWithOldLoop(const float *inL, const float *inR, float *outL, float *outR, float indexInBufferFloat, float uptimeDeltaFloat, const float *pitchData, int numSamples)
+	{
+		while (numSamples > 0)
+		{
+			for (int i = 0; i < 4; i++)
+			{
+				const int pos = int(indexInBufferFloat);
+				const float alpha = indexInBufferFloat - (float)pos;
+				const float invAlpha = 1.0f - alpha;
+
+				*outL++ = (inL[pos] * invAlpha + inL[pos + 1] * alpha);
+				*outR++ = (inR[pos] * invAlpha + inR[pos + 1] * alpha);
+
+				indexInBufferFloat += pitchData != nullptr ? *pitchData++ : uptimeDeltaFloat;
+			}
+
+			numSamples -= 4;
+		}
+	}
+
+	/** The same chunk loop as StreamingSamplerVoice::renderVoicesInOnePass() for a single stereo voice. */
+	static void renderWithInterpolator(const float *inL, const float *inR, float *outL, float *outR, float indexInBufferFloat, float uptimeDeltaFloat, const float *pitchData, int numSamples, bool useCubic)
+	{
+		SampleInterpolator::Positions positions;
+
+		for (int offset = 0; offset < numSamples; offset += SampleInterpolator::ChunkSize)
+		{
+			const int numThisTime = jmin<int>(SampleInterpolator::ChunkSize, numSamples - offset);
+
+			if (pitchData != nullptr)
+				indexInBufferFloat = SampleInterpolator::calculatePositions(positions, indexInBufferFloat, pitchData + offset, numThisTime);
+			else
+				indexInBufferFloat = SampleInterpolator::calculatePositions(positions, indexInBufferFloat, uptimeDeltaFloat, numThisTime);
+
+			if (useCubic)
+			{
+				SampleInterpolator::interpolateCubic(positions, inL, outL + offset);
+				SampleInterpolator::interpolateCubic(positions, inR, outR + offset);
+			}
+			else
+			{
+				SampleInterpolator::interpolateLinear(positions, inL, outL + offset);
+				SampleInterpolator::interpolateLinear(positions, inR, outR + offset);
+			}
+		}
+	}
+
+	void testLinearMatchesOldLoop(bool usePitchData)
+	{
+		beginTest(usePitchData ? "Linear interpolation with pitch modulation" : "Linear interpolation with a fixed pitch");
+
+		AudioSampleBuffer expected(2, BlockSize);
+		AudioSampleBuffer actual(2, BlockSize);
+
+		const float *pitchData = usePitchData ? pitchValues.getReadPointer(0) : nullptr;
+
+		renderWithOldLoop(input.getReadPointer(0, 1), input.getReadPointer(1, 1), expected.getWritePointer(0), expected.getWritePointer(1), 0.37f, 1.2345f, pitchData, BlockSize);
+		renderWithInterpolator(input.getReadPointer(0, 1), input.getReadPointer(1, 1), actual.getWritePointer(0), actual.getWritePointer(1), 0.37f, 1.2345f, pitchData, BlockSize, false);
+
+		float maxError = 0.0f;
+
+		for (int c = 0; c < 2; c++)
+			for (int i = 0; i < BlockSize; i++)
+				maxError = jmax<float>(maxError, std::abs(expected.getSample(c, i) - actual.getSample(c, i)));
+
+		expect(maxError < 0.0001f, "The kernel doesn't match the old loop: " + String(maxError));
+	}
+
+	void testCubicAccuracy()
+	{
+		beginTest("Cubic interpolation is closer to the signal than linear interpolation");
+
+		AudioSampleBuffer linear(2, BlockSize);
+		AudioSampleBuffer cubic(2, BlockSize);
+
+		const float delta = 1.2345f;
+		const float startIndex = 0.37f;
+
+		// The cubic interpolation reads one sample before the read position
+		renderWithInterpolator(input.getReadPointer(0, 1), input.getReadPointer(1, 1), linear.getWritePointer(0), linear.getWritePointer(1), startIndex, delta, nullptr, BlockSize, false);
+		renderWithInterpolator(input.getReadPointer(0, 1), input.getReadPointer(1, 1), cubic.getWritePointer(0), cubic.getWritePointer(1), startIndex, delta, nullptr, BlockSize, true);
+
+		float linearError = 0.0f;
+		float cubicError = 0.0f;
+
+		for (int i = 0; i < BlockSize; i++)
+		{
+			const double position = 1.0 + (double)startIndex + (double)i * (double)delta;
+			const float exact = 0.8f * (float)std::sin(position * 0.01);
+
+			linearError = jmax<float>(linearError, std::abs(linear.getSample(0, i) - exact));
+			cubicError = jmax<float>(cubicError, std::abs(cubic.getSample(0, i) - exact));
+		}
+
+		expect(cubicError < linearError, "Cubic error: " + String(cubicError) + ", linear error: " + String(linearError));
+	}
+
+	void testSpeed()
+	{
+		beginTest("Resampling speed");
+
+		AudioSampleBuffer output(2, BlockSize);
+
+		const float *inL = input.getReadPointer(0, 1);
+		const float *inR = input.getReadPointer(1, 1);
+		float *outL = output.getWritePointer(0);
+		float *outR = output.getWritePointer(1);
+		const float *pitchData = pitchValues.getReadPointer(0);
+
+		// The time that one block of 512 samples may take at 44.1kHz
+		const double blockDuration = (double)BlockSize / 44100.0;
+
+		for (int i = 0; i < 2; i++)
+		{
+			const bool usePitchData = i == 1;
+			const float *p = usePitchData ? pitchData : nullptr;
+			const String mode = usePitchData ? "pitch modulation" : "fixed pitch";
+
+			double start = Time::getMillisecondCounterHiRes();
+
+			for (int j = 0; j < NumBenchmarkBlocks; j++)
+				renderWithOldLoop(inL, inR, outL, outR, 0.37f, 1.0594631f, p, BlockSize);
+
+			const double oldTime = (Time::getMillisecondCounterHiRes() - start) * 0.001 / (double)NumBenchmarkBlocks;
+
+			start = Time::getMillisecondCounterHiRes();
+
+			for (int j = 0; j < NumBenchmarkBlocks; j++)
+				renderWithInterpolator(inL, inR, outL, outR, 0.37f, 1.0594631f, p, BlockSize, false);
+
+			const double linearTime = (Time::getMillisecondCounterHiRes() - start) * 0.001 / (double)NumBenchmarkBlocks;
+
+			start = Time::getMillisecondCounterHiRes();
+
+			for (int j = 0; j < NumBenchmarkBlocks; j++)
+				renderWithInterpolator(inL, inR, outL, outR, 0.37f, 1.0594631f, p, BlockSize, true);
+
+			const double cubicTime = (Time::getMillisecondCounterHiRes() - start) * 0.001 / (double)NumBenchmarkBlocks;
+
+			logMessage(mode + ", old loop: " + String(1000000.0 * oldTime, 2) + " us per voice block (" + String((int)(blockDuration / oldTime)) + " voices per core)");
+			logMessage(mode + ", linear kernel: " + String(1000000.0 * linearTime, 2) + " us per voice block (" + String((int)(blockDuration / linearTime)) + " voices per core)");
+			logMessage(mode + ", cubic kernel: " + String(1000000.0 * cubicTime, 2) + " us per voice block (" + String((int)(blockDuration / cubicTime)) + " voices per core)");
+		}
+	}
+
+	AudioSampleBuffer input;
+	AudioSampleBuffer pitchValues;
+};
+
+static SampleInterpolatorUnitTest sampleInterpolatorTestInstance;
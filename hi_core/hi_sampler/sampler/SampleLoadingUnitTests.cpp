@@ -0,0 +1,248 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licences for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licencing:
+*
+*   http://www.hartinstruments.net/hise/
+*
+*   HISE is based on the JUCE library,
+*   which also must be licenced for commercial applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+
+#include "JuceHeader.h"
+
+class SampleLoadingUnitTest : public UnitTest
+{
+public:
+
+	SampleLoadingUnitTest() :
+		UnitTest("Testing parallel sample map loading")
+	{
+
+	}
+
+	void runTest() override
+	{
+		testPoolIndex();
+		testParallelPreload();
+		testAbort();
+	}
+
+private:
+
+	enum
+	{
+		NumSamplesInMap = 50000,
+		NumFilesOnDisk = 2000,
+		NumFramesPerFile = 4096,
+		PreloadSize = 2048
+	};
+
+	void testPoolIndex()
+	{
+		beginTest("Resolving pool hits through the hash index");
+
+		ModulatorSamplerSoundPool pool(nullptr);
+		pool.setUpdatePool(false);
+
+		const File directory = File::getSpecialLocation(File::tempDirectory).getChildFile("SamplePoolIndexTest");
+
+		Array<StreamingSamplerSound*> sounds;
+
+		double start = Time::getMillisecondCounterHiRes();
+
+		for (int i = 0; i < NumSamplesInMap; i++)
+		{
+			sounds.add(pool.getOrCreateSound(getFileName(directory, i), true));
+		}
+
+		const double addTime = Time::getMillisecondCounterHiRes() - start;
+
+		expectEquals<int>(pool.getNumSoundsInPool(), NumSamplesInMap, "Unique files must create new sounds");
+
+		start = Time::getMillisecondCounterHiRes();
+
+		int numHits = 0;
+
+		for (int i = 0; i < NumSamplesInMap; i++)
+		{
+			if (pool.getOrCreateSound(getFileName(directory, i), true) == sounds[i]) numHits++;
+		}
+
+		const double lookupTime = Time::getMillisecondCounterHiRes() - start;
+
+		expectEquals<int>(numHits, NumSamplesInMap, "Every file must be found in the pool");
+		expectEquals<int>(pool.getNumSoundsInPool(), NumSamplesInMap, "Pool hits must not create new sounds");
+
+		pool.getOrCreateSound(getFileName(directory, 0), false);
+
+		expectEquals<int>(pool.getNumSoundsInPool(), NumSamplesInMap + 1, "A disabled search must create a new sound");
+		expect(pool.getOrCreateSound(getFileName(directory, 0), true) == sounds[0], "The first sound with a hash must win");
+
+		logMessage("Adding " + String(NumSamplesInMap) + " sounds: " + String(addTime, 1) + " ms");
+		logMessage("Resolving " + String(NumSamplesInMap) + " pool hits: " + String(lookupTime, 1) + " ms");
+	}
+
+	void testParallelPreload()
+	{
+		beginTest("Preloading a synthetic 50k sample map");
+
+		const File directory = createFiles();
+
+		ModulatorSamplerSoundPool pool(nullptr);
+		pool.setUpdatePool(false);
+
+		Array<StreamingSamplerSound*> sampleMap;
+
+		double start = Time::getMillisecondCounterHiRes();
+
+		for (int i = 0; i < NumSamplesInMap; i++)
+		{
+			StreamingSamplerSound *s = pool.getOrCreateSound(getFileName(directory, i % NumFilesOnDisk), true);
+			s->checkFileReference();
+			sampleMap.add(s);
+		}
+
+		logMessage("Resolving the sample map: " + String(Time::getMillisecondCounterHiRes() - start, 1) + " ms");
+
+		expectEquals<int>(pool.getNumSoundsInPool(), NumFilesOnDisk, "Wrong number of pool entries");
+
+		double serialTime = 0.0;
+		double parallelTime = 0.0;
+
+		{
+			ParallelSamplePreloader preloader(1);
+
+			start = Time::getMillisecondCounterHiRes();
+			expect(preloader.preload(sampleMap, PreloadSize), "Serial preload failed");
+			serialTime = Time::getMillisecondCounterHiRes() - start;
+
+			expectEquals<int>(preloader.getNumPreloadedSounds(), NumFilesOnDisk, "Duplicates must be loaded once");
+		}
+
+		checkPreloadBuffers(sampleMap);
+
+		{
+			ParallelSamplePreloader preloader(4);
+
+			start = Time::getMillisecondCounterHiRes();
+			expect(preloader.preload(sampleMap, PreloadSize), "Parallel preload failed");
+			parallelTime = Time::getMillisecondCounterHiRes() - start;
+
+			expectEquals<int>(preloader.getNumPreloadedSounds(), NumFilesOnDisk, "Not all sounds were preloaded");
+
+			logMessage("Preloading " + String(NumFilesOnDisk) + " files with 1 thread: " + String(serialTime, 1) + " ms");
+			logMessage("Preloading " + String(NumFilesOnDisk) + " files with " + String(preloader.getNumThreads()) + " threads: " + String(parallelTime, 1) + " ms");
+		}
+
+		checkPreloadBuffers(sampleMap);
+
+		sampleMap.clear();
+		directory.deleteRecursively();
+	}
+
+	void testAbort()
+	{
+		beginTest("Aborting the preload");
+
+		const File directory = createFiles();
+
+		ModulatorSamplerSoundPool pool(nullptr);
+		pool.setUpdatePool(false);
+
+		Array<StreamingSamplerSound*> sounds;
+
+		for (int i = 0; i < NumFilesOnDisk; i++)
+		{
+			StreamingSamplerSound *s = pool.getOrCreateSound(getFileName(directory, i), true);
+			s->checkFileReference();
+			sounds.add(s);
+		}
+
+		ParallelSamplePreloader preloader(4);
+		preloader.signalAbort();
+
+		expect(!preloader.preload(sounds, PreloadSize), "An aborted preload must fail");
+		expectEquals<int>(preloader.getNumPreloadedSounds(), 0, "The workers must not load sounds after an abort");
+		expect(preloader.getErrorMessage().isEmpty(), "An abort is not an error");
+
+		sounds.clear();
+		directory.deleteRecursively();
+	}
+
+	void checkPreloadBuffers(const Array<StreamingSamplerSound*> &sampleMap)
+	{
+		int numWrongSounds = 0;
+
+		for (int i = 0; i < NumFilesOnDisk; i++)
+		{
+			StreamingSamplerSound *s = sampleMap[i];
+
+			if (s->getPreloadSize() != PreloadSize || s->getActualPreloadSize() == 0 || s->isOpened())
+				numWrongSounds++;
+		}
+
+		expectEquals<int>(numWrongSounds, 0, "Preload buffers are missing or files were not closed");
+	}
+
+	File createFiles()
+	{
+		const File directory = File::getSpecialLocation(File::tempDirectory).getChildFile("SampleLoadingTest");
+
+		if (directory.getNumberOfChildFiles(File::findFiles) == NumFilesOnDisk)
+			return directory;
+
+		directory.deleteRecursively();
+		directory.createDirectory();
+
+		AudioSampleBuffer b(2, NumFramesPerFile);
+
+		WavAudioFormat wav;
+
+		for (int i = 0; i < NumFilesOnDisk; i++)
+		{
+			for (int c = 0; c < 2; c++)
+			{
+				for (int j = 0; j < NumFramesPerFile; j++)
+					b.setSample(c, j, 0.5f * std::sin((float)j * 0.001f * (float)(i + 1)));
+			}
+
+			FileOutputStream *fos = new FileOutputStream(File(getFileName(directory, i)));
+
+			ScopedPointer<AudioFormatWriter> writer = wav.createWriterFor(fos, 44100.0, 2, 16, StringPairArray(), 0);
+
+			writer->writeFromAudioSampleBuffer(b, 0, NumFramesPerFile);
+		}
+
+		return directory;
+	}
+
+	static String getFileName(const File &directory, int index)
+	{
+		return directory.getChildFile("Sample_" + String(index) + ".wav").getFullPathName();
+	}
+};
+
+static SampleLoadingUnitTest sampleLoadingTestInstance;
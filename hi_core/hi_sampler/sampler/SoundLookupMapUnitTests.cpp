@@ -0,0 +1,207 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licences for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licencing:
+*
+*   http://www.hartinstruments.net/hise/
+*
+*   HISE is based on the JUCE library,
+*   which also must be licenced for commercial applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+
+#include "JuceHeader.h"
+
+class SoundLookupMapUnitTest : public UnitTest
+{
+public:
+
+	SoundLookupMapUnitTest() :
+		UnitTest("Testing the sampler sound lookup map")
+	{
+
+	}
+
+	void runTest() override
+	{
+		const File sampleFile = createSampleFile();
+
+		testIncrementalUpdate(sampleFile);
+
+		testNoteOnCost(sampleFile, 1000);
+		testNoteOnCost(sampleFile, 10000);
+		testNoteOnCost(sampleFile, 40000);
+
+		sampleFile.deleteFile();
+	}
+
+private:
+
+	enum
+	{
+		NumVelocityLayers = 8,
+		NumNoteOnsPerRun = 2048
+	};
+
+	/** All sounds point to this file, so that checkFileReference() finds an existing file. */
+	File createSampleFile()
+	{
+		File f = File::getSpecialLocation(File::tempDirectory).getChildFile("SoundLookupMapTest.wav");
+
+		f.deleteFile();
+
+		AudioSampleBuffer b(2, 256);
+		b.clear();
+
+		WavAudioFormat wav;
+		ScopedPointer<AudioFormatWriter> writer = wav.createWriterFor(new FileOutputStream(f), 44100.0, 2, 16, StringPairArray(), 0);
+
+		writer->writeFromAudioSampleBuffer(b, 0, b.getNumSamples());
+		writer = nullptr;
+
+		return f;
+	}
+
+	/** Creates a sample map with one key per zone, NumVelocityLayers velocity layers and as many round robin groups as needed. */
+	void createSampleMap(const File &f, int numSounds, ModulatorSamplerSoundPool &pool, ReferenceCountedArray<ModulatorSamplerSound> &sounds, SoundLookupMap &map)
+	{
+		const int numRRGroups = jmax<int>(1, numSounds / (128 * NumVelocityLayers));
+		const int layerSize = 128 / NumVelocityLayers;
+
+		for (int i = 0; i < numSounds; i++)
+		{
+			const int rrGroup = i % numRRGroups + 1;
+			const int zone = i / numRRGroups;
+			const int key = zone % 128;
+			const int layer = (zone / 128) % NumVelocityLayers;
+
+			ModulatorSamplerSound *s = new ModulatorSamplerSound(new StreamingSamplerSound(f.getFullPathName(), &pool), i);
+
+			s->setMappingData(MappingData(key, key, key, layer * layerSize, (layer + 1) * layerSize - 1, rrGroup));
+			s->checkFileReference();
+
+			sounds.add(s);
+			map.addSound(s);
+		}
+	}
+
+	static bool soundMatches(ModulatorSamplerSound *s, int noteNumber, int velocity, int rrGroup)
+	{
+		return s->appliesToNote(noteNumber) && s->appliesToVelocity(velocity) && s->appliesToRRGroup(rrGroup);
+	}
+
+	void testIncrementalUpdate(const File &f)
+	{
+		beginTest("Updating the map when the mapping changes");
+
+		ModulatorSamplerSoundPool pool(nullptr);
+		ReferenceCountedArray<ModulatorSamplerSound> sounds;
+		SoundLookupMap map;
+
+		createSampleMap(f, 128 * NumVelocityLayers, pool, sounds, map);
+
+		ModulatorSamplerSound *s = sounds[60];
+
+		expect(map.getCandidates(60, 5)->contains(s), "Sound not in the map");
+
+		s->setMappingData(MappingData(72, 70, 74, 100, 127, 1));
+		map.updateSound(s);
+
+		expect(!map.getCandidates(60, 5)->contains(s), "The old cell still contains the sound");
+
+		for (int i = 70; i <= 74; i++)
+		{
+			expect(map.getCandidates(i, 100)->contains(s), "The new cell doesn't contain the sound");
+			expect(map.getCandidates(i, 127)->contains(s), "The new cell doesn't contain the sound");
+		}
+
+		map.removeSound(s);
+
+		expect(!map.getCandidates(72, 110)->contains(s), "The sound was not removed");
+	}
+
+	void testNoteOnCost(const File &f, int numSounds)
+	{
+		beginTest("Note on cost with " + String(numSounds) + " sounds");
+
+		ModulatorSamplerSoundPool pool(nullptr);
+		ReferenceCountedArray<ModulatorSamplerSound> sounds;
+		SoundLookupMap map;
+
+		createSampleMap(f, numSounds, pool, sounds, map);
+
+		Random r(numSounds);
+
+		Array<int> noteNumbers;
+		Array<int> velocities;
+
+		for (int i = 0; i < NumNoteOnsPerRun; i++)
+		{
+			noteNumbers.add(r.nextInt(128));
+			velocities.add(r.nextInt(127) + 1);
+		}
+
+		// The old note on: every sound is checked
+		int numScanMatches = 0;
+
+		double start = Time::getMillisecondCounterHiRes();
+
+		for (int i = 0; i < NumNoteOnsPerRun; i++)
+		{
+			for (int j = sounds.size(); --j >= 0;)
+			{
+				if (soundMatches(sounds.getUnchecked(j), noteNumbers[i], velocities[i], 1)) numScanMatches++;
+			}
+		}
+
+		const double scanTime = Time::getMillisecondCounterHiRes() - start;
+
+		// The new note on: only the candidates of the cell are checked
+		int numMapMatches = 0;
+
+		start = Time::getMillisecondCounterHiRes();
+
+		for (int i = 0; i < NumNoteOnsPerRun; i++)
+		{
+			const Array<ModulatorSynthSound*> *candidates = map.getCandidates(noteNumbers[i], velocities[i]);
+
+			for (int j = candidates->size(); --j >= 0;)
+			{
+				if (soundMatches(static_cast<ModulatorSamplerSound*>(candidates->getUnchecked(j)), noteNumbers[i], velocities[i], 1)) numMapMatches++;
+			}
+		}
+
+		const double mapTime = Time::getMillisecondCounterHiRes() - start;
+
+		expectEquals<int>(numMapMatches, numScanMatches, "The map must find the same sounds as the full scan");
+		expect(numScanMatches > 0, "No sound was found");
+
+		const double usPerScan = 1000.0 * scanTime / (double)NumNoteOnsPerRun;
+		const double usPerLookup = 1000.0 * mapTime / (double)NumNoteOnsPerRun;
+
+		logMessage(String(numSounds) + " sounds: full scan " + String(usPerScan, 3) + " us, lookup map " + String(usPerLookup, 3) + " us per note on");
+	}
+};
+
+static SoundLookupMapUnitTest soundLookupMapTestInstance;
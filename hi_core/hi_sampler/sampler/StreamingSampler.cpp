@@ -30,6 +30,119 @@
 *   ===========================================================================
 */
 
+// ==================================================================================================== NativeSampleBuffer methods
+
+void NativeSampleBuffer::setSize(MonolithFileHeader::SampleFormat newFormat, int newNumSamples)
+{
+	format = newFormat;
+	numSamples = 0;
+	gain = getFullScaleGain(format);
+
+	data.free();
+
+	if (newNumSamples > 0)
+	{
+		data.malloc((size_t)newNumSamples * (size_t)getBytesPerFrame());
+		numSamples = newNumSamples;
+	}
+}
+
+void NativeSampleBuffer::createFrom(const AudioSampleBuffer &source, MonolithFileHeader::SampleFormat newFormat, bool normalise)
+{
+	jassert(source.getNumChannels() == 2);
+
+	setSize(newFormat, source.getNumSamples());
+
+	if (normalise && format != MonolithFileHeader::Float32 && numSamples > 0)
+	{
+		const float peak = jmax<float>(source.getMagnitude(0, 0, numSamples), source.getMagnitude(1, 0, numSamples));
+
+		if (peak > 0.0f)
+		{
+			// the peak is mapped to the largest positive integer
+			gain = peak / (1.0f / getFullScaleGain(format) - 1.0f);
+		}
+	}
+
+	copyFrom(source, 0, 0, numSamples);
+}
+
+void NativeSampleBuffer::copyFrom(const AudioSampleBuffer &source, int sourceStartSample, int destStartSample, int numSamplesToCopy) noexcept
+{
+	jassert(source.getNumChannels() == 2);
+	jassert(destStartSample + numSamplesToCopy <= numSamples);
+
+	const float fullScaleGain = getFullScaleGain(format);
+
+	if (gain == fullScaleGain)
+	{
+		const float* sourceChannels[2] = { source.getReadPointer(0, sourceStartSample), source.getReadPointer(1, sourceStartSample) };
+
+		SampleDataConversion::convertFromFloat(format, sourceChannels, 2, data + destStartSample * getBytesPerFrame(), numSamplesToCopy);
+		return;
+	}
+
+	// The conversion expects full scale values, so the normalised samples are scaled in small chunks on the stack
+
+	const float factor = fullScaleGain / gain;
+	const int chunkSize = 256;
+
+	float left[chunkSize];
+	float right[chunkSize];
+	const float* scaledChannels[2] = { left, right };
+
+	for (int offset = 0; offset < numSamplesToCopy; offset += chunkSize)
+	{
+		const int numThisTime = jmin<int>(chunkSize, numSamplesToCopy - offset);
+
+		FloatVectorOperations::multiply(left, source.getReadPointer(0, sourceStartSample + offset), factor, numThisTime);
+		FloatVectorOperations::multiply(right, source.getReadPointer(1, sourceStartSample + offset), factor, numThisTime);
+
+		SampleDataConversion::convertFromFloat(format, scaledChannels, 2, data + (destStartSample + offset) * getBytesPerFrame(), numThisTime);
+	}
+}
+
+void NativeSampleBuffer::copyTo(AudioSampleBuffer &destination, int destStartSample, int sourceStartSample, int numSamplesToCopy) const noexcept
+{
+	jassert(destination.getNumChannels() == 2);
+	jassert(sourceStartSample + numSamplesToCopy <= numSamples);
+
+	float* destChannels[2] = { destination.getWritePointer(0, destStartSample), destination.getWritePointer(1, destStartSample) };
+
+	SampleDataConversion::convertToFloat(format, data + sourceStartSample * getBytesPerFrame(), 2, destChannels, 2, numSamplesToCopy);
+
+	const float fullScaleGain = getFullScaleGain(format);
+
+	if (gain != fullScaleGain)
+	{
+		const float factor = gain / fullScaleGain;
+
+		FloatVectorOperations::multiply(destChannels[0], factor, numSamplesToCopy);
+		FloatVectorOperations::multiply(destChannels[1], factor, numSamplesToCopy);
+	}
+}
+
+float NativeSampleBuffer::getFullScaleGain(MonolithFileHeader::SampleFormat format) noexcept
+{
+	switch (format)
+	{
+	case MonolithFileHeader::Int16:		return 1.0f / 32768.0f;
+	case MonolithFileHeader::Int24:		return 1.0f / 8388608.0f;
+	case MonolithFileHeader::Float32:
+	case MonolithFileHeader::numSampleFormats:
+	default:							return 1.0f;
+	}
+}
+
+MonolithFileHeader::SampleFormat NativeSampleBuffer::getNativeFormat(const AudioFormatReader &reader) noexcept
+{
+	if (reader.bitsPerSample <= 16) return MonolithFileHeader::Int16;
+	if (reader.bitsPerSample <= 24) return MonolithFileHeader::Int24;
+
+	// 32 bit integers don't fit into a float either, so there's nothing to save
+	return MonolithFileHeader::Float32;
+}
+
 // ==================================================================================================== StreamingSamplerSound methods
 
 StreamingSamplerSound::StreamingSamplerSound(const String &fileNameToLoad, ModulatorSamplerSoundPool *pool):
@@ -105,6 +218,7 @@ void StreamingSamplerSound::setPreloadSize(int newPreloadSize, bool forceReload)
 		preloadSize = 0;
 		preloadBuffer = AudioSampleBuffer();
 		preloadBuffer.setSize(2, 0);
+		nativePreloadBuffer.setSize(MonolithFileHeader::Float32, 0);
 		return;
 	}
     
@@ -124,6 +238,7 @@ void StreamingSamplerSound::setPreloadSize(int newPreloadSize, bool forceReload)
 	internalPreloadSize = jmax(preloadSize, internalPreloadSize, 2048);
 
 	preloadBuffer = AudioSampleBuffer();
+	nativePreloadBuffer.setSize(MonolithFileHeader::Float32, 0);
 	
 	try
 	{
@@ -184,13 +299,73 @@ void StreamingSamplerSound::setPreloadSize(int newPreloadSize, bool forceReload)
 	{
 		fileReader.readFromDisk(preloadBuffer, 0, internalPreloadSize, sampleStart + monolithOffset, true);
 	}
+
+	bool normalise = false;
+	const MonolithFileHeader::SampleFormat storageFormat = getStorageFormat(false, normalise);
+
+	// Float samples are already stored in their native format
+	if (storageFormat != MonolithFileHeader::Float32)
+	{
+		try
+		{
+			nativePreloadBuffer.createFrom(preloadBuffer, storageFormat, normalise);
+		}
+		catch (std::bad_alloc e)
+		{
+			nativePreloadBuffer.setSize(MonolithFileHeader::Float32, 0);
+
+			throw StreamingSamplerSound::LoadingError(getFileName(), "Preload error (max memory exceeded).");
+		}
+
+		preloadBuffer = AudioSampleBuffer();
+		preloadBuffer.setSize(2, 0);
+	}
 }
 
+void StreamingSamplerSound::setPreloadFormat(PreloadFormat newFormat)
+{
+	if (preloadFormat == newFormat)
+		return;
+
+	ScopedLock sl(getSampleLock());
 
+	preloadFormat = newFormat;
+
+	if (loopEnabled)
+		loopChanged();
+}
+
+MonolithFileHeader::SampleFormat StreamingSamplerSound::getStorageFormat(bool isProcessed, bool &normalise) const
+{
+	normalise = false;
+
+	if (preloadFormat == FloatPreload)
+		return MonolithFileHeader::Float32;
+
+	AudioFormatReader *reader = fileReader.getReader();
+
+	const MonolithFileHeader::SampleFormat nativeFormat = reader != nullptr ? NativeSampleBuffer::getNativeFormat(*reader) : 
+																			  MonolithFileHeader::Float32;
+
+	if (preloadFormat == NativePreload)
+		return isProcessed ? MonolithFileHeader::Float32 : nativeFormat;
+
+	// The compact format uses the full 16 bit range for samples that don't fit into 16 bit anyway
+	normalise = isProcessed || nativeFormat != MonolithFileHeader::Int16;
+
+	return MonolithFileHeader::Int16;
+}
 
 size_t StreamingSamplerSound::getActualPreloadSize() const
 {
-	return hasActiveState() ? (size_t)(internalPreloadSize *preloadBuffer.getNumChannels()) * sizeof(float) + (size_t)(loopBuffer.getNumSamples() *loopBuffer.getNumChannels()) * sizeof(float) : 0;
+	if (!hasActiveState()) return 0;
+
+	const size_t loopBufferSize = loopBuffer.getSizeInBytes() + smallLoopBuffer.getSizeInBytes();
+
+	if (hasNativePreloadBuffer())
+		return nativePreloadBuffer.getSizeInBytes() + loopBufferSize;
+
+	return (size_t)(internalPreloadSize *preloadBuffer.getNumChannels()) * sizeof(float) + loopBufferSize;
 }
 
 void StreamingSamplerSound::loadEntireSample() { setPreloadSize(-1); }
@@ -379,9 +554,14 @@ void StreamingSamplerSound::loopChanged()
 
 			fileReader.openFileHandles();
 
-			smallLoopBuffer.setSize(2, (int)loopLength);
+			AudioSampleBuffer tempBuffer = AudioSampleBuffer(2, (int)loopLength);
+
+			fileReader.readFromDisk(tempBuffer, 0, loopLength, loopStart, false);
+
+			bool normalise = false;
+			const MonolithFileHeader::SampleFormat storageFormat = getStorageFormat(false, normalise);
 
-			fileReader.readFromDisk(smallLoopBuffer, 0, loopLength, loopStart, false);
+			smallLoopBuffer.createFrom(tempBuffer, storageFormat, normalise);
 
 			closeFileHandle();
 
@@ -389,13 +569,13 @@ void StreamingSamplerSound::loopChanged()
 		else
 		{
 			useSmallLoopBuffer = false;
-			smallLoopBuffer.setSize(2, 0);
+			smallLoopBuffer.setSize(MonolithFileHeader::Float32, 0);
 		}
 
 		if(crossfadeLength != 0)
 		{
-			loopBuffer.setSize(2, (int)crossfadeLength);
-			loopBuffer.clear();
+			AudioSampleBuffer crossfadeBuffer = AudioSampleBuffer(2, (int)crossfadeLength);
+			crossfadeBuffer.clear();
 
 			AudioSampleBuffer tempBuffer = AudioSampleBuffer(2, (int)crossfadeLength);
 
@@ -410,8 +590,8 @@ void StreamingSamplerSound::loopChanged()
 			tempBuffer.applyGainRamp(0, 0, (int)crossfadeLength, 0.0f, 1.0f);
 			tempBuffer.applyGainRamp(1, 0, (int)crossfadeLength, 0.0f, 1.0f);
 
-			FloatVectorOperations::copy(loopBuffer.getWritePointer(0, 0), tempBuffer.getReadPointer(0, 0), (int)crossfadeLength);
-			FloatVectorOperations::copy(loopBuffer.getWritePointer(1, 0), tempBuffer.getReadPointer(1, 0), (int)crossfadeLength);
+			FloatVectorOperations::copy(crossfadeBuffer.getWritePointer(0, 0), tempBuffer.getReadPointer(0, 0), (int)crossfadeLength);
+			FloatVectorOperations::copy(crossfadeBuffer.getWritePointer(1, 0), tempBuffer.getReadPointer(1, 0), (int)crossfadeLength);
 
 			// Calculate the fade out
 			tempBuffer.clear();
@@ -423,8 +603,13 @@ void StreamingSamplerSound::loopChanged()
 			tempBuffer.applyGainRamp(0, 0, (int)crossfadeLength, 1.0f, 0.0f);
 			tempBuffer.applyGainRamp(1, 0, (int)crossfadeLength, 1.0f, 0.0f);
 
-			FloatVectorOperations::add(loopBuffer.getWritePointer(0, 0), tempBuffer.getReadPointer(0, 0), (int)crossfadeLength);
-			FloatVectorOperations::add(loopBuffer.getWritePointer(1, 0), tempBuffer.getReadPointer(1, 0), (int)crossfadeLength);
+			FloatVectorOperations::add(crossfadeBuffer.getWritePointer(0, 0), tempBuffer.getReadPointer(0, 0), (int)crossfadeLength);
+			FloatVectorOperations::add(crossfadeBuffer.getWritePointer(1, 0), tempBuffer.getReadPointer(1, 0), (int)crossfadeLength);
+
+			bool normalise = false;
+			const MonolithFileHeader::SampleFormat storageFormat = getStorageFormat(true, normalise);
+
+			loopBuffer.createFrom(crossfadeBuffer, storageFormat, normalise);
 
 			fileReader.closeFileHandles();
 		}
@@ -447,7 +632,7 @@ float StreamingSamplerSound::calculatePeakValue()
 	return fileReader.calculatePeakValue();
 }
 
-void StreamingSamplerSound::fillSampleBuffer(AudioSampleBuffer &sampleBuffer, int samplesToCopy, int uptime) const
+void StreamingSamplerSound::fillSampleBuffer(AudioSampleBuffer &sampleBuffer, int samplesToCopy, int uptime, AsyncReadBatch *batch) const
 {
 	ScopedLock sl(getSampleLock());
 
@@ -468,15 +653,14 @@ void StreamingSamplerSound::fillSampleBuffer(AudioSampleBuffer &sampleBuffer, in
 			if (indexInLoop < 0)
 			{
 				numSamplesBeforeFirstWrap = loopStart - (uptime+sampleStart);
-				fillInternal(sampleBuffer, numSamplesBeforeFirstWrap, uptime + (int)sampleStart, 0);
+				fillInternal(sampleBuffer, numSamplesBeforeFirstWrap, uptime + (int)sampleStart, 0, batch);
 			}
 			else
 			{
 				numSamplesBeforeFirstWrap = numSamplesInThisLoop;
 				int startSample = indexInLoop;
 
-				FloatVectorOperations::copy(sampleBuffer.getWritePointer(0, 0), smallLoopBuffer.getReadPointer(0, startSample), numSamplesBeforeFirstWrap);
-				FloatVectorOperations::copy(sampleBuffer.getWritePointer(1, 0), smallLoopBuffer.getReadPointer(1, startSample), numSamplesBeforeFirstWrap);
+				smallLoopBuffer.copyTo(sampleBuffer, 0, startSample, numSamplesBeforeFirstWrap);
 			}
 
 			int numSamples = samplesToCopy - numSamplesBeforeFirstWrap;
@@ -486,15 +670,13 @@ void StreamingSamplerSound::fillSampleBuffer(AudioSampleBuffer &sampleBuffer, in
 			{
 				jassert(indexInSampleBuffer < sampleBuffer.getNumSamples());
 
-				FloatVectorOperations::copy(sampleBuffer.getWritePointer(0, indexInSampleBuffer), smallLoopBuffer.getReadPointer(0, 0), loopLength);
-				FloatVectorOperations::copy(sampleBuffer.getWritePointer(1, indexInSampleBuffer), smallLoopBuffer.getReadPointer(1, 0), loopLength);
+				smallLoopBuffer.copyTo(sampleBuffer, indexInSampleBuffer, 0, loopLength);
 
 				numSamples -= (int)loopLength;
 				indexInSampleBuffer += (int)loopLength;
 			}
 
-			FloatVectorOperations::copy(sampleBuffer.getWritePointer(0, indexInSampleBuffer), smallLoopBuffer.getReadPointer(0, 0), numSamples);
-			FloatVectorOperations::copy(sampleBuffer.getWritePointer(1, indexInSampleBuffer), smallLoopBuffer.getReadPointer(1, 0), numSamples);
+			smallLoopBuffer.copyTo(sampleBuffer, indexInSampleBuffer, 0, numSamples);
 		}
 
 		// Loop is smaller than streaming buffers
@@ -506,22 +688,22 @@ void StreamingSamplerSound::fillSampleBuffer(AudioSampleBuffer &sampleBuffer, in
 			int startSample = numSamplesBeforeFirstWrap;
 
 			const int indexToUse = indexInLoop > 0 ? ((int)indexInLoop + (int)loopStart) : uptime + (int)sampleStart;
-			fillInternal(sampleBuffer, numSamplesBeforeFirstWrap, indexToUse, 0);
+			fillInternal(sampleBuffer, numSamplesBeforeFirstWrap, indexToUse, 0, batch);
 
 			while(numSamples > (int)loopLength)
 			{
-				fillInternal(sampleBuffer, (int)loopLength, (int)loopStart, startSample);
+				fillInternal(sampleBuffer, (int)loopLength, (int)loopStart, startSample, batch);
 				numSamples -= (int)loopLength;
 				startSample += (int)loopLength;
 			}
 
-			fillInternal(sampleBuffer, numSamples, (int)loopStart, startSample);
+			fillInternal(sampleBuffer, numSamples, (int)loopStart, startSample, batch);
 		}
 
 		// loop is bigger than streaming buffers and does not get wrapped
 		else if(numSamplesInThisLoop > samplesToCopy)
 		{
-			fillInternal(sampleBuffer, samplesToCopy, (int)(loopStart + indexInLoop));
+			fillInternal(sampleBuffer, samplesToCopy, (int)(loopStart + indexInLoop), 0, batch);
 		}
 
 		// loop is bigger than streaming buffers and needs some wrapping
@@ -530,19 +712,19 @@ void StreamingSamplerSound::fillSampleBuffer(AudioSampleBuffer &sampleBuffer, in
 			const int numSamplesBeforeWrap = numSamplesInThisLoop;
 			const int numSamplesAfterWrap = samplesToCopy - numSamplesBeforeWrap;
 
-			fillInternal(sampleBuffer, numSamplesBeforeWrap, (int)(loopStart + indexInLoop), 0);
-			fillInternal(sampleBuffer, numSamplesAfterWrap, (int)loopStart, numSamplesBeforeWrap);
+			fillInternal(sampleBuffer, numSamplesBeforeWrap, (int)(loopStart + indexInLoop), 0, batch);
+			fillInternal(sampleBuffer, numSamplesAfterWrap, (int)loopStart, numSamplesBeforeWrap, batch);
 		}
 	}
 	else
 	{
 		jassert(((int)sampleStart + uptime + samplesToCopy) <= sampleEnd);
 
-		fillInternal(sampleBuffer, samplesToCopy, uptime + (int)sampleStart);
+		fillInternal(sampleBuffer, samplesToCopy, uptime + (int)sampleStart, 0, batch);
 	}
 };
 
-void StreamingSamplerSound::fillInternal(AudioSampleBuffer &sampleBuffer, int samplesToCopy, int indexInFile, int offsetInBuffer) const
+void StreamingSamplerSound::fillInternal(AudioSampleBuffer &sampleBuffer, int samplesToCopy, int indexInFile, int offsetInBuffer, AsyncReadBatch *batch) const
 {
 	jassert(indexInFile + samplesToCopy <= sampleEnd);
 
@@ -553,7 +735,7 @@ void StreamingSamplerSound::fillInternal(AudioSampleBuffer &sampleBuffer, int sa
 
 		if(numSamplesBeforeCrossfade > 0)
 		{
-			fillInternal(sampleBuffer, numSamplesBeforeCrossfade, indexInFile, 0);
+			fillInternal(sampleBuffer, numSamplesBeforeCrossfade, indexInFile, 0, batch);
 		}
 		
 		const int numSamplesInCrossfade = jmin(samplesToCopy - numSamplesBeforeCrossfade, (int)crossfadeLength);
@@ -562,8 +744,7 @@ void StreamingSamplerSound::fillInternal(AudioSampleBuffer &sampleBuffer, int sa
 		{
 			const int indexInLoopBuffer = jmax(0, indexInFile - crossfadeArea.getStart());
 
-			FloatVectorOperations::copy(sampleBuffer.getWritePointer(0, numSamplesBeforeCrossfade), loopBuffer.getReadPointer(0, indexInLoopBuffer), numSamplesInCrossfade);
-			FloatVectorOperations::copy(sampleBuffer.getWritePointer(1, numSamplesBeforeCrossfade), loopBuffer.getReadPointer(1, indexInLoopBuffer), numSamplesInCrossfade);		
+			loopBuffer.copyTo(sampleBuffer, numSamplesBeforeCrossfade, indexInLoopBuffer, numSamplesInCrossfade);
 		}
 
 		// Should be taken care by higher logic (fillSampleBuffer should wrap the loop)
@@ -578,7 +759,11 @@ void StreamingSamplerSound::fillInternal(AudioSampleBuffer &sampleBuffer, int sa
 
 		jassert(indexInPreloadBuffer >= 0);
 
-		if (indexInPreloadBuffer + samplesToCopy < preloadBuffer.getNumSamples())
+		if (hasNativePreloadBuffer() && indexInPreloadBuffer + samplesToCopy < nativePreloadBuffer.getNumSamples())
+		{
+			nativePreloadBuffer.copyTo(sampleBuffer, offsetInBuffer, indexInPreloadBuffer, samplesToCopy);
+		}
+		else if (indexInPreloadBuffer + samplesToCopy < preloadBuffer.getNumSamples())
 		{
 			FloatVectorOperations::copy(sampleBuffer.getWritePointer(0, offsetInBuffer), preloadBuffer.getReadPointer(0, indexInPreloadBuffer), samplesToCopy);
 			FloatVectorOperations::copy(sampleBuffer.getWritePointer(1, offsetInBuffer), preloadBuffer.getReadPointer(1, indexInPreloadBuffer), samplesToCopy);
@@ -594,7 +779,7 @@ void StreamingSamplerSound::fillInternal(AudioSampleBuffer &sampleBuffer, int sa
 	// Read all samples from disk
 	else
 	{
-		fileReader.readFromDisk(sampleBuffer, offsetInBuffer, samplesToCopy, indexInFile + monolithOffset, true);
+		fileReader.readFromDisk(sampleBuffer, offsetInBuffer, samplesToCopy, indexInFile + monolithOffset, true, batch);
     }
 }
 
@@ -616,6 +801,9 @@ StreamingSamplerSound::FileReader::~FileReader()
 
 	memoryReader = nullptr;
 	normalReader = nullptr;
+
+	asyncLayout = AsyncReadBatch::FileLayout();
+	asyncFile = nullptr;
 }
 
 void StreamingSamplerSound::FileReader::setFile(const String &fileName)
@@ -630,7 +818,12 @@ void StreamingSamplerSound::FileReader::setFile(const String &fileName)
 
 		fileFormatSupportsMemoryReading = fileExtension.contains("wav") || fileExtension.contains("aif");
 
+		const int64 oldHashCode = hashCode;
+
 		hashCode = loadedFile.hashCode64();
+
+		// A sound that is already in the pool was relinked to another file, so the pool index is outdated
+		if (pool != nullptr && oldHashCode != 0 && oldHashCode != hashCode) pool->setPoolIndexDirty();
 	}
 	else
 	{
@@ -717,10 +910,13 @@ void StreamingSamplerSound::FileReader::openFileHandles(NotificationType notifyP
 	}
 	else
 	{
-		jassert(memoryReader == nullptr || normalReader == nullptr);
-
 		ScopedWriteLock sl(fileAccessLock);
 
+		// Another streaming thread might have opened the handles while this one was waiting for the lock
+		if (fileHandlesOpen) return;
+
+		jassert(memoryReader == nullptr || normalReader == nullptr);
+
 		fileHandlesOpen = true;
 
 		memoryReader = nullptr;
@@ -743,6 +939,7 @@ void StreamingSamplerSound::FileReader::openFileHandles(NotificationType notifyP
             
             sampleLength = getMonolithLength();
             
+			monolithicInfo->fillAsyncLayout(monolithicIndex, monolithicChannelIndex, asyncLayout);
 		}
 		else
 		{
@@ -770,6 +967,8 @@ void StreamingSamplerSound::FileReader::openFileHandles(NotificationType notifyP
             
             sampleLength = normalReader != nullptr ? normalReader->lengthInSamples : 0;
             
+			refreshAsyncLayout();
+
 		}
 
 #if USE_BACKEND
@@ -794,24 +993,39 @@ void StreamingSamplerSound::FileReader::closeFileHandles(NotificationType notify
 		memoryReader = nullptr;
 		normalReader = nullptr;
 
+		// Pending batched reads keep their own reference to the file
+		asyncLayout = AsyncReadBatch::FileLayout();
+		asyncFile = nullptr;
+
 		if (monolithicInfo == nullptr && notifyPool == sendNotification) pool->decreaseNumOpenFileHandles();
 	}
 }
 
 
-void StreamingSamplerSound::FileReader::readFromDisk(AudioSampleBuffer &buffer, int startSample, int numSamples, int readerPosition, bool useMemoryMappedReader)
+void StreamingSamplerSound::FileReader::readFromDisk(AudioSampleBuffer &buffer, int startSample, int numSamples, int readerPosition, bool useMemoryMappedReader, AsyncReadBatch *batch)
 {
 	if (!fileHandlesOpen) openFileHandles(sendNotification);
 
     FloatVectorOperations::clear(buffer.getWritePointer(0, startSample), numSamples);
     FloatVectorOperations::clear(buffer.getWritePointer(1, startSample), numSamples);
     
+	if (batch != nullptr)
+	{
+		ScopedReadLock sl(fileAccessLock);
+
+		// The samples will be read when the batch is submitted
+		if (asyncLayout.isValid() && batch->addRead(asyncLayout, readerPosition, buffer, startSample, numSamples))
+			return;
+	}
+
+
+	ScopedReadLock sl(fileAccessLock);
+
 	if (useMemoryMappedReader)
 	{
+		// Reading from the mapped memory doesn't change the reader, so the voices of this sound can do this in parallel
 		if (memoryReader != nullptr && memoryReader->getMappedSection().contains(Range<int64>(readerPosition, readerPosition + numSamples)))
 		{
-			ScopedReadLock sl(fileAccessLock);
-
 			memoryReader->read(&buffer, startSample, numSamples, readerPosition, true, true);
 
 			return;
@@ -820,7 +1034,7 @@ void StreamingSamplerSound::FileReader::readFromDisk(AudioSampleBuffer &buffer,
 	
 	if (normalReader != nullptr)
 	{
-		ScopedReadLock sl(fileAccessLock);
+		ScopedLock readerLock(normalReaderLock);
 
 		normalReader->read(&buffer, startSample, numSamples, readerPosition, true, true);
 	}
@@ -832,6 +1046,33 @@ void StreamingSamplerSound::FileReader::readFromDisk(AudioSampleBuffer &buffer,
 }
 
 
+void StreamingSamplerSound::FileReader::refreshAsyncLayout()
+{
+	asyncLayout = AsyncReadBatch::FileLayout();
+
+	if (memoryReader == nullptr) return;
+
+	if (asyncFile == nullptr) asyncFile = AsyncReadBatch::FileHandle::open(loadedFile);
+
+	if (asyncFile == nullptr) return;
+
+	bool isLittleEndian = true;
+
+	if (loadedFile.getFileExtension().startsWithIgnoreCase(".aif"))
+	{
+		// AIFF files are big endian, but AIFC files can use other encodings so they will be read without the batch
+		FileInputStream fis(loadedFile);
+
+		char formType[4];
+
+		if (!fis.setPosition(8) || fis.read(formType, 4) != 4 || memcmp(formType, "AIFF", 4) != 0) return;
+
+		isLittleEndian = false;
+	}
+
+	asyncLayout.setFromReader(memoryReader, asyncFile, isLittleEndian);
+}
+
 float StreamingSamplerSound::FileReader::calculatePeakValue()
 {
 	float l1, l2, r1, r2;
@@ -898,6 +1139,7 @@ isReadingFromPreloadBuffer(true),
 sampleStartModValue(0),
 readBuffer(nullptr),
 writeBuffer(nullptr),
+compactReadBuffer(nullptr),
 readPointerLeft(nullptr),
 readPointerRight(nullptr),
 diskUsage(0.0),
@@ -937,15 +1179,44 @@ void SampleLoader::startNote(StreamingSamplerSound const *s, int startTime)
 	diskUsage = 0.0;
 
 	sound = s;
+
+	hasHistorySample = false;
 	
 	s->wakeSound();
 
 	sampleStartModValue = (int)startTime;
 
+	const NativeSampleBuffer &nativePreload = s->getNativePreloadBuffer();
+
+	if (s->hasNativePreloadBuffer())
+	{
+		// The voice interpolates 16 bit samples directly and converts the samples of other formats block by block
+		// (see fillVoiceBuffer()), so this works like a float preload buffer and nothing is converted at the note on.
+		compactReadBuffer = &nativePreload;
+		readBuffer = nullptr;
+		writeBuffer = &b1;
+
+		readIndex = startTime;
+		readIndexDouble = (double)startTime;
+
+		readPointerLeft = nullptr;
+		readPointerRight = nullptr;
+
+		isReadingFromPreloadBuffer = true;
+
+		positionInSampleFile = nativePreload.getNumSamples();
+
+		voiceCounterWasIncreased = false;
+
+		requestNewData();
+		return;
+	}
+
 	const AudioSampleBuffer *localReadBuffer = &s->getPreloadBuffer();
 	AudioSampleBuffer *localWriteBuffer = &b1;
 
 	// the read pointer will be pointing directly to the preload buffer of the sample sound
+	compactReadBuffer = nullptr;
 	readBuffer = localReadBuffer;
 	writeBuffer = localWriteBuffer;
 
@@ -966,57 +1237,92 @@ void SampleLoader::startNote(StreamingSamplerSound const *s, int startTime)
 	requestNewData();
 };
 
-StereoChannelData SampleLoader::fillVoiceBuffer(AudioSampleBuffer &voiceBuffer, double numSamples)
+StereoChannelData SampleLoader::fillVoiceBuffer(AudioSampleBuffer &voiceBuffer, double numSamples, bool withHistorySample)
 {
-	const AudioSampleBuffer *localReadBuffer = readBuffer.get();
+	const NativeSampleBuffer *localCompactBuffer = compactReadBuffer.get();
 	AudioSampleBuffer *localWriteBuffer = writeBuffer.get();
 
-	const int numSamplesInBuffer = localReadBuffer->getNumSamples();
+	const int numSamplesInBuffer = getNumSamplesInReadBuffer();
 	const int maxSampleIndexForFillOperation = (int)(readIndexDouble + numSamples)+ 1; // Round up the samples
+	const int index = (int)readIndexDouble;
+
+	// Only 16 bit compact buffers can be read by the voice, the other native formats are converted into the voice buffer.
+	const bool isConvertedBuffer = localCompactBuffer != nullptr && localCompactBuffer->getFormat() != MonolithFileHeader::Int16;
+
+	// The sample before the read index is only accessible if it is in the same buffer
+	const bool canReadDirectly = !isConvertedBuffer && maxSampleIndexForFillOperation < numSamplesInBuffer && (!withHistorySample || index > 0);
 
-	if (maxSampleIndexForFillOperation >= numSamplesInBuffer) // Check because of preloadbuffer style
+	if (!canReadDirectly) // Check because of preloadbuffer style
 	{
-		const int indexBeforeWrap = jmax<int>(0, (int)readIndexDouble);
-		const int numSamplesInFirstBuffer = localReadBuffer->getNumSamples() - indexBeforeWrap;
+		const int historyOffset = withHistorySample ? 1 : 0;
+		const int indexBeforeWrap = jmax<int>(0, index);
+		const int numSamplesNeeded = maxSampleIndexForFillOperation - indexBeforeWrap + 1;
+		const int numSamplesInFirstBuffer = jmin<int>(numSamplesInBuffer - indexBeforeWrap, voiceBuffer.getNumSamples() - historyOffset, numSamplesNeeded);
 
 		jassert(numSamplesInFirstBuffer >= 0);
 
+		if (withHistorySample)
+		{
+			if (indexBeforeWrap == 0 && hasHistorySample)
+			{
+				// The read index is at the start of a new buffer, so the previous sample is the last one of the old buffer
+				voiceBuffer.copyFrom(0, 0, historyBuffer, 0, 0, 1);
+				voiceBuffer.copyFrom(1, 0, historyBuffer, 1, 0, 1);
+			}
+			else
+			{
+				// At the start of the sample there is no previous sample, so the first sample is repeated
+				copyFromReadBuffer(voiceBuffer, 0, jmax<int>(0, indexBeforeWrap - 1), 1);
+			}
+		}
+
 		if (numSamplesInFirstBuffer > 0)
 		{
-			voiceBuffer.copyFrom(0, 0, *localReadBuffer, 0, indexBeforeWrap, numSamplesInFirstBuffer);
-			voiceBuffer.copyFrom(1, 0, *localReadBuffer, 1, indexBeforeWrap, numSamplesInFirstBuffer);
+			copyFromReadBuffer(voiceBuffer, historyOffset, indexBeforeWrap, numSamplesInFirstBuffer);
 		}
 
-		const int offset = numSamplesInFirstBuffer;
-		//remaining = (int)(numSamples)+1 - offset;
+		if (maxSampleIndexForFillOperation >= numSamplesInBuffer)
+		{
+			const int offset = numSamplesInFirstBuffer;
+			//remaining = (int)(numSamples)+1 - offset;
 
-		const int numSamplesAvailableInSecondBuffer = localWriteBuffer->getNumSamples() - offset;
+			const int numSamplesAvailableInSecondBuffer = localWriteBuffer->getNumSamples() - offset;
 
-		if ( (numSamplesAvailableInSecondBuffer > 0) && (numSamplesAvailableInSecondBuffer < localWriteBuffer->getNumSamples()))
-		{
-			const int numSamplesToCopyFromSecondBuffer = jmin<int>(numSamplesAvailableInSecondBuffer, voiceBuffer.getNumSamples() - offset);
+			if ( (numSamplesAvailableInSecondBuffer > 0) && (numSamplesAvailableInSecondBuffer < localWriteBuffer->getNumSamples()))
+			{
+				const int numSamplesToCopyFromSecondBuffer = jmin<int>(numSamplesAvailableInSecondBuffer, voiceBuffer.getNumSamples() - offset - historyOffset);
 
-			voiceBuffer.copyFrom(0, offset, *localWriteBuffer, 0, 0, numSamplesToCopyFromSecondBuffer);
-			voiceBuffer.copyFrom(1, offset, *localWriteBuffer, 1, 0, numSamplesToCopyFromSecondBuffer);
-		}
-		else
-		{
-			// The streaming buffers must be greater than the block size!
-			jassertfalse;
-			FloatVectorOperations::clear(voiceBuffer.getWritePointer(0), voiceBuffer.getNumSamples());
-			FloatVectorOperations::clear(voiceBuffer.getWritePointer(1), voiceBuffer.getNumSamples());
+				voiceBuffer.copyFrom(0, offset + historyOffset, *localWriteBuffer, 0, 0, numSamplesToCopyFromSecondBuffer);
+				voiceBuffer.copyFrom(1, offset + historyOffset, *localWriteBuffer, 1, 0, numSamplesToCopyFromSecondBuffer);
+			}
+			else
+			{
+				// The streaming buffers must be greater than the block size!
+				jassertfalse;
+				FloatVectorOperations::clear(voiceBuffer.getWritePointer(0), voiceBuffer.getNumSamples());
+				FloatVectorOperations::clear(voiceBuffer.getWritePointer(1), voiceBuffer.getNumSamples());
+			}
 		}
 		
 		StereoChannelData returnData;
 
-		returnData.leftChannel = voiceBuffer.getReadPointer(0);
-		returnData.rightChannel = voiceBuffer.getReadPointer(1);
+		returnData.leftChannel = voiceBuffer.getReadPointer(0, historyOffset);
+		returnData.rightChannel = voiceBuffer.getReadPointer(1, historyOffset);
+
+		return returnData;
+	}
+	else if (localCompactBuffer != nullptr)
+	{
+		StereoChannelData returnData;
+
+		returnData.interleavedInt16 = localCompactBuffer->getInt16Data(index);
+		returnData.int16Gain = localCompactBuffer->getGain();
 
 		return returnData;
 	}
 	else
 	{
-		const int index = (int)readIndexDouble;
+		const AudioSampleBuffer *localReadBuffer = readBuffer.get();
 
 		StereoChannelData returnData;
 
@@ -1027,9 +1333,24 @@ StereoChannelData SampleLoader::fillVoiceBuffer(AudioSampleBuffer &voiceBuffer,
 	}
 }
 
+void SampleLoader::copyFromReadBuffer(AudioSampleBuffer &destination, int destStartSample, int sourceStartSample, int numSamples) const noexcept
+{
+	if (const NativeSampleBuffer *localCompactBuffer = compactReadBuffer.get())
+	{
+		localCompactBuffer->copyTo(destination, destStartSample, sourceStartSample, numSamples);
+	}
+	else
+	{
+		const AudioSampleBuffer *localReadBuffer = readBuffer.get();
+
+		destination.copyFrom(0, destStartSample, *localReadBuffer, 0, sourceStartSample, numSamples);
+		destination.copyFrom(1, destStartSample, *localReadBuffer, 1, sourceStartSample, numSamples);
+	}
+}
+
 bool SampleLoader::advanceReadIndex(double delta)
 {
-	const int numSamplesInBuffer = readBuffer.get()->getNumSamples();
+	const int numSamplesInBuffer = getNumSamplesInReadBuffer();
 	readIndexDouble += delta;
 
 	if (readIndexDouble >= numSamplesInBuffer)
@@ -1037,6 +1358,10 @@ bool SampleLoader::advanceReadIndex(double delta)
 		positionInSampleFile += getNumSamplesForStreamingBuffers();
 		readIndexDouble -= (double)numSamplesInBuffer;
 
+		// The read buffer will be refilled after the swap, so keep its last sample for the interpolation
+		copyFromReadBuffer(historyBuffer, 0, numSamplesInBuffer - 1, 1);
+		hasHistorySample = true;
+
 		swapBuffers();
 		const bool queueIsFree = requestNewData();
         
@@ -1048,14 +1373,17 @@ bool SampleLoader::advanceReadIndex(double delta)
 
 bool SampleLoader::requestNewData()
 {
-    ADD_GLITCH_DETECTOR("Requesting new sample data");
+    ADD_GLITCH_DETECTOR(nullptr, "Requesting new sample data");
+
+	// The pool runs the loaders whose read buffer runs out first
+	setDeadline(getNumSamplesInReadBuffer() - (int)readIndexDouble);
 
 #if KILL_VOICES_WHEN_STREAMING_IS_BLOCKED
     if(this->isQueued())
     {
         writeBuffer.get()->clear();
         cancelled = true;
-        backgroundPool->notify();
+        backgroundPool->notifyUnderrun(this);
         return false;
     }
     else
@@ -1099,17 +1427,54 @@ SampleThreadPoolJob::JobStatus SampleLoader::runJob()
     
     writeBufferIsBeingFilled = false;
     
-    const double readStop = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks());
-    const double readTime = (readStop - readStart);
-    const double timeSinceLastCall = readStop - lastCallToRequestData;
-	const float diskUsageThisTime = jmax<float>(diskUsage.get(), (float)(readTime / timeSinceLastCall));
-    diskUsage = diskUsageThisTime;
-    lastCallToRequestData = readStart;
+	updateDiskUsage(readStart);
     
     return SampleThreadPoolJob::JobStatus::jobHasFinished;
 }
 
-void SampleLoader::fillInactiveBuffer()
+bool SampleLoader::addToBatch(AsyncReadBatch &batch)
+{
+	// Let runJob() handle these cases
+	if (cancelled || writeBufferIsBeingFilled)
+		return false;
+
+	batchReadStart = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks());
+
+	writeBufferIsBeingFilled = true;
+
+	const StreamingSamplerSound *localSound = sound.get();
+
+	if (!voiceCounterWasIncreased && localSound != nullptr)
+	{
+		localSound->increaseVoiceCount();
+		voiceCounterWasIncreased = true;
+	}
+
+	fillInactiveBuffer(&batch);
+
+	return true;
+}
+
+SampleThreadPoolJob::JobStatus SampleLoader::finishBatchedJob()
+{
+	writeBufferIsBeingFilled = false;
+
+	updateDiskUsage(batchReadStart);
+
+	return SampleThreadPoolJob::JobStatus::jobHasFinished;
+}
+
+void SampleLoader::updateDiskUsage(double readStart)
+{
+	const double readStop = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks());
+	const double readTime = (readStop - readStart);
+	const double timeSinceLastCall = readStop - lastCallToRequestData;
+	const float diskUsageThisTime = jmax<float>(diskUsage.get(), (float)(readTime / timeSinceLastCall));
+	diskUsage = diskUsageThisTime;
+	lastCallToRequestData = readStart;
+}
+
+void SampleLoader::fillInactiveBuffer(AsyncReadBatch *batch)
 {
 	const StreamingSamplerSound *localSound = sound.get();
 
@@ -1119,14 +1484,14 @@ void SampleLoader::fillInactiveBuffer()
 	{
 		if(localSound->hasEnoughSamplesForBlock(positionInSampleFile + getNumSamplesForStreamingBuffers()))
 		{
-			localSound->fillSampleBuffer(*writeBuffer.get(), getNumSamplesForStreamingBuffers(), (int)positionInSampleFile);
+			localSound->fillSampleBuffer(*writeBuffer.get(), getNumSamplesForStreamingBuffers(), (int)positionInSampleFile, batch);
 		}
 		else if (localSound->hasEnoughSamplesForBlock(positionInSampleFile))
 		{
 			const int numSamplesToFill = (int)localSound->getSampleLength() - positionInSampleFile;
 			const int numSamplesToClear = getNumSamplesForStreamingBuffers() - numSamplesToFill;
 
-			localSound->fillSampleBuffer(*writeBuffer.get(), numSamplesToFill, (int)positionInSampleFile);
+			localSound->fillSampleBuffer(*writeBuffer.get(), numSamplesToFill, (int)positionInSampleFile, batch);
 
 			writeBuffer.get()->clear(numSamplesToFill, numSamplesToClear);
 		}
@@ -1151,6 +1516,7 @@ void SampleLoader::refreshBufferSizes()
 
 		readBuffer = &b1;
 		writeBuffer = &b2;
+		compactReadBuffer = nullptr;
 
 		reset();
 	}
@@ -1171,6 +1537,8 @@ bool SampleLoader::swapBuffers()
 		writeBuffer = &b2;
 	}
 
+	compactReadBuffer = nullptr;
+
 	isReadingFromPreloadBuffer = false;
 	sampleStartModValue = 0;
 
@@ -1225,104 +1593,322 @@ void StreamingSamplerVoice::startNote (int /*midiNoteNumber*/,
 
 void StreamingSamplerVoice::renderNextBlock(AudioSampleBuffer &outputBuffer, int startSample, int numSamples)
 {
-    
-    
-	const StreamingSamplerSound *sound = loader.getLoadedSound();
+	StreamingSamplerVoice *thisVoice = this;
 
-	if(sound != nullptr)
+	renderVoicesInOnePass(&thisVoice, 1, outputBuffer, startSample, numSamples);
+};
+
+void StreamingSamplerVoice::renderVoicesInOnePass(StreamingSamplerVoice **voicesToRender, int numVoicesToRender, AudioSampleBuffer &outputBuffer, int startSample, int numSamples)
+{
+	ADD_GLITCH_DETECTOR(nullptr, "Rendering sampler voices");
+
+	jassert(numVoicesToRender <= NUM_MIC_POSITIONS);
+	jassert(outputBuffer.getNumChannels() >= numVoicesToRender * 2);
+
+	// All voices play the same note, so the first voice with a loaded sound defines the read positions.
+	StreamingSamplerVoice *masterVoice = nullptr;
+
+	const float *inputChannels[NUM_MIC_POSITIONS * 2];
+	float *outputChannels[NUM_MIC_POSITIONS * 2];
+
+	// Voices that read from a compact preload buffer convert the 16 bit samples in the interpolation
+	const int16 *int16InputChannels[NUM_MIC_POSITIONS * 2];
+	float int16Gains[NUM_MIC_POSITIONS * 2];
+	int numChannelsToRender = 0;
+
+	for (int i = 0; i < numVoicesToRender; i++)
 	{
-        ADD_GLITCH_DETECTOR("Rendering sample " + sound->getFileName());
-        
-		const double startAlpha = fmod(voiceUptime, 1.0);
-		
-		jassert(pitchCounter != 0);
+		StreamingSamplerVoice *v = voicesToRender[i];
 
-		AudioSampleBuffer* tempVoiceBuffer = getTemporaryVoiceBuffer();
+		const StreamingSamplerSound *sound = v->loader.getLoadedSound();
+
+		if (sound == nullptr)
+		{
+			v->resetVoice();
+			continue;
+		}
+
+		jassert(v->pitchCounter != 0);
+
+		const bool useCubicInterpolation = v->interpolationType == Cubic;
+
+		AudioSampleBuffer* tempVoiceBuffer = v->getTemporaryVoiceBuffer();
 
 		jassert(tempVoiceBuffer != nullptr);
+		jassert(tempVoiceBuffer->getNumChannels() >= 2 * (i + 1));
 
-		tempVoiceBuffer->clear();
-        
-		// Copy the not resampled values into the voice buffer.
-		StereoChannelData data = loader.fillVoiceBuffer(*tempVoiceBuffer, pitchCounter + startAlpha);
+		// Every voice needs its own channels in the temp buffer because they are interpolated together
+		float *tempChannels[2] = { tempVoiceBuffer->getWritePointer(2 * i), tempVoiceBuffer->getWritePointer(2 * i + 1) };
+		AudioSampleBuffer tempChannelBuffer(tempChannels, 2, tempVoiceBuffer->getNumSamples());
 
-		const float* const inL = data.leftChannel;
-		const float* const inR = data.rightChannel;
-		float* outL = outputBuffer.getWritePointer(0, startSample);
-		float* outR = outputBuffer.getWritePointer(1, startSample);
-		
-		double indexInBuffer = startAlpha;
+		const double startAlpha = fmod(v->voiceUptime, 1.0);
 
-		if (pitchData != nullptr)
-		{
-			pitchData += startSample;
+		// Copy the not resampled values into the voice buffer (the cubic interpolation needs one more sample on both sides).
+		const double numSamplesToFetch = v->pitchCounter + startAlpha + (useCubicInterpolation ? 1.0 : 0.0);
 
-			float indexInBufferFloat = (float)indexInBuffer;
-			
-			while (numSamples > 0)
-			{
-				for (int i = 0; i < 4; i++)
-				{
-					const int pos = int(indexInBufferFloat);
-					const float alpha = indexInBufferFloat - (float)pos;
-					const float invAlpha = 1.0f - alpha;
+		StereoChannelData data = v->loader.fillVoiceBuffer(tempChannelBuffer, numSamplesToFetch, useCubicInterpolation);
 
-					float l = (inL[pos] * invAlpha + inL[pos + 1] * alpha);
-					float r = (inR[pos] * invAlpha + inR[pos + 1] * alpha);
+		inputChannels[numChannelsToRender] = data.leftChannel;
+		inputChannels[numChannelsToRender + 1] = data.rightChannel;
+		int16InputChannels[numChannelsToRender] = data.interleavedInt16;
+		int16InputChannels[numChannelsToRender + 1] = data.interleavedInt16 != nullptr ? data.interleavedInt16 + 1 : nullptr;
+		int16Gains[numChannelsToRender] = data.int16Gain;
+		int16Gains[numChannelsToRender + 1] = data.int16Gain;
+		outputChannels[numChannelsToRender] = outputBuffer.getWritePointer(2 * i, startSample);
+		outputChannels[numChannelsToRender + 1] = outputBuffer.getWritePointer(2 * i + 1, startSample);
+		numChannelsToRender += 2;
 
-					*outL++ = l;
-					*outR++ = r;
+		if (masterVoice == nullptr) masterVoice = v;
+	}
 
-					jassert(r >= -1.0f);
+	if (masterVoice == nullptr) return;
 
-					jassert(*pitchData <= (float)MAX_SAMPLER_PITCH);
+	const float *pitchDataForBlock = masterVoice->pitchData != nullptr ? masterVoice->pitchData + startSample : nullptr;
+	const bool useCubicInterpolation = masterVoice->interpolationType == Cubic;
+	const float uptimeDeltaFloat = (float)masterVoice->uptimeDelta;
 
-					indexInBufferFloat += *pitchData++;
-				}
-				numSamples -= 4;
-			}
+	float indexInBufferFloat = (float)fmod(masterVoice->voiceUptime, 1.0);
+
+	SampleInterpolator::Positions positions;
+
+	for (int offset = 0; offset < numSamples; offset += SampleInterpolator::ChunkSize)
+	{
+		const int numThisTime = jmin<int>(SampleInterpolator::ChunkSize, numSamples - offset);
+
+		if (pitchDataForBlock != nullptr)
+		{
+			indexInBufferFloat = SampleInterpolator::calculatePositions(positions, indexInBufferFloat, pitchDataForBlock + offset, numThisTime);
 		}
 		else
 		{
-			float indexInBufferFloat = (float)indexInBuffer;
-			const float uptimeDeltaFloat = (float)uptimeDelta;
+			indexInBufferFloat = SampleInterpolator::calculatePositions(positions, indexInBufferFloat, uptimeDeltaFloat, numThisTime);
+		}
 
-			while (numSamples > 0)
+		for (int c = 0; c < numChannelsToRender; c++)
+		{
+			if (int16InputChannels[c] != nullptr)
 			{
-				for (int i = 0; i < 4; i++)
+				if (useCubicInterpolation)
 				{
-					const int pos = int(indexInBufferFloat);
-					const float alpha = indexInBufferFloat - (float)pos;
-					const float invAlpha = 1.0f - alpha;
+					SampleInterpolator::interpolateCubic(positions, int16InputChannels[c], int16Gains[c], outputChannels[c] + offset);
+				}
+				else
+				{
+					SampleInterpolator::interpolateLinear(positions, int16InputChannels[c], int16Gains[c], outputChannels[c] + offset);
+				}
+			}
+			else if (useCubicInterpolation)
+			{
+				SampleInterpolator::interpolateCubic(positions, inputChannels[c], outputChannels[c] + offset);
+			}
+			else
+			{
+				SampleInterpolator::interpolateLinear(positions, inputChannels[c], outputChannels[c] + offset);
+			}
+		}
+	}
 
-					float l = (inL[pos] * invAlpha + inL[pos + 1] * alpha);
-					float r = (inR[pos] * invAlpha + inR[pos + 1] * alpha);
+	for (int i = 0; i < numVoicesToRender; i++)
+	{
+		StreamingSamplerVoice *v = voicesToRender[i];
 
-					*outL++ = l;
-					*outR++ = r;
+		const StreamingSamplerSound *sound = v->loader.getLoadedSound();
 
-					indexInBufferFloat += uptimeDeltaFloat;
-				}
-				
-				numSamples -= 4;
-			}
+		if (sound == nullptr) continue;
+
+		v->voiceUptime += v->pitchCounter;
+
+		if (!v->loader.advanceReadIndex(v->pitchCounter))
+		{
+			Logger::writeToLog("Streaming failure with sound " + sound->getFileName());
+			v->resetVoice();
+			continue;
 		}
-		
-		voiceUptime += pitchCounter;
-		
-        if(!loader.advanceReadIndex(pitchCounter))
-        {
-            Logger::writeToLog("Streaming failure with sound " + sound->getFileName());
-            resetVoice();
-            return;
-        }
 
-		const bool enoughSamples = sound->hasEnoughSamplesForBlock((int)(voiceUptime + numSamples * MAX_SAMPLER_PITCH));
+		const bool enoughSamples = sound->hasEnoughSamplesForBlock((int)(v->voiceUptime + numSamples * MAX_SAMPLER_PITCH));
 
-		if(!enoughSamples) resetVoice();
+		if (!enoughSamples) v->resetVoice();
 	}
-    else
-    {
-        resetVoice();
-    }
-};
\ No newline at end of file
+}
+
+// ==================================================================================================== SampleInterpolator methods
+
+float SampleInterpolator::calculatePositions(Positions &p, float startIndex, float delta, int numSamples)
+{
+	jassert(numSamples <= ChunkSize);
+
+	p.numSamples = numSamples;
+
+	int i = 0;
+
+#if HI_SAMPLER_USE_SSE
+	const __m128 deltaVector = _mm_set1_ps(delta);
+	const __m128 four = _mm_set1_ps(4.0f);
+	const __m128 start = _mm_set1_ps(startIndex);
+	__m128 counter = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+
+	for (; i < numSamples - 3; i += 4)
+	{
+		const __m128 index = _mm_add_ps(start, _mm_mul_ps(counter, deltaVector));
+		const __m128i pos = _mm_cvttps_epi32(index);
+
+		_mm_storeu_si128((__m128i*)(p.index + i), pos);
+		_mm_storeu_ps(p.alpha + i, _mm_sub_ps(index, _mm_cvtepi32_ps(pos)));
+
+		counter = _mm_add_ps(counter, four);
+	}
+#endif
+
+	for (; i < numSamples; i++)
+	{
+		const float index = startIndex + (float)i * delta;
+		const int pos = (int)index;
+
+		p.index[i] = pos;
+		p.alpha[i] = index - (float)pos;
+	}
+
+	return startIndex + (float)numSamples * delta;
+}
+
+float SampleInterpolator::calculatePositions(Positions &p, float startIndex, const float *pitchData, int numSamples)
+{
+	jassert(numSamples <= ChunkSize);
+
+	p.numSamples = numSamples;
+
+	float index = startIndex;
+
+	// Every position depends on the previous one, so this loop stays scalar
+	for (int i = 0; i < numSamples; i++)
+	{
+		jassert(pitchData[i] <= (float)MAX_SAMPLER_PITCH);
+
+		const int pos = (int)index;
+
+		p.index[i] = pos;
+		p.alpha[i] = index - (float)pos;
+
+		index += pitchData[i];
+	}
+
+	return index;
+}
+
+void SampleInterpolator::interpolateLinear(const Positions &p, const float *input, float *output)
+{
+	interpolateLinearInternal<float, 1, false>(p, input, 1.0f, output);
+}
+
+void SampleInterpolator::interpolateCubic(const Positions &p, const float *input, float *output)
+{
+	interpolateCubicInternal<float, 1, false>(p, input, 1.0f, output);
+}
+
+void SampleInterpolator::interpolateLinear(const Positions &p, const int16 *input, float gain, float *output)
+{
+	interpolateLinearInternal<int16, 2, true>(p, input, gain, output);
+}
+
+void SampleInterpolator::interpolateCubic(const Positions &p, const int16 *input, float gain, float *output)
+{
+	interpolateCubicInternal<int16, 2, true>(p, input, gain, output);
+}
+
+template <typename SampleType, int Stride, bool ApplyGain>
+void SampleInterpolator::interpolateLinearInternal(const Positions &p, const SampleType *input, float gain, float *output)
+{
+	const int numSamples = p.numSamples;
+	const int *index = p.index;
+	const float *alpha = p.alpha;
+
+	int i = 0;
+
+#if HI_SAMPLER_USE_SSE
+	const __m128 g = _mm_set1_ps(gain);
+
+	for (; i < numSamples - 3; i += 4)
+	{
+		const int *x = index + i;
+
+		const __m128 y0 = _mm_setr_ps((float)input[x[0] * Stride], (float)input[x[1] * Stride], (float)input[x[2] * Stride], (float)input[x[3] * Stride]);
+		const __m128 y1 = _mm_setr_ps((float)input[(x[0] + 1) * Stride], (float)input[(x[1] + 1) * Stride], (float)input[(x[2] + 1) * Stride], (float)input[(x[3] + 1) * Stride]);
+		const __m128 a = _mm_loadu_ps(alpha + i);
+
+		__m128 result = _mm_add_ps(y0, _mm_mul_ps(a, _mm_sub_ps(y1, y0)));
+
+		if (ApplyGain) result = _mm_mul_ps(result, g);
+
+		_mm_storeu_ps(output + i, result);
+	}
+#endif
+
+	for (; i < numSamples; i++)
+	{
+		const int pos = index[i];
+		const float a = alpha[i];
+
+		const float result = (float)input[pos * Stride] * (1.0f - a) + (float)input[(pos + 1) * Stride] * a;
+
+		output[i] = ApplyGain ? result * gain : result;
+	}
+}
+
+template <typename SampleType, int Stride, bool ApplyGain>
+void SampleInterpolator::interpolateCubicInternal(const Positions &p, const SampleType *input, float gain, float *output)
+{
+	const int numSamples = p.numSamples;
+	const int *index = p.index;
+	const float *alpha = p.alpha;
+
+	int i = 0;
+
+#if HI_SAMPLER_USE_SSE
+	const __m128 half = _mm_set1_ps(0.5f);
+	const __m128 oneAndHalf = _mm_set1_ps(1.5f);
+	const __m128 two = _mm_set1_ps(2.0f);
+	const __m128 twoAndHalf = _mm_set1_ps(2.5f);
+	const __m128 g = _mm_set1_ps(gain);
+
+	for (; i < numSamples - 3; i += 4)
+	{
+		const int *x = index + i;
+
+		const __m128 ym1 = _mm_setr_ps((float)input[(x[0] - 1) * Stride], (float)input[(x[1] - 1) * Stride], (float)input[(x[2] - 1) * Stride], (float)input[(x[3] - 1) * Stride]);
+		const __m128 y0 = _mm_setr_ps((float)input[x[0] * Stride], (float)input[x[1] * Stride], (float)input[x[2] * Stride], (float)input[x[3] * Stride]);
+		const __m128 y1 = _mm_setr_ps((float)input[(x[0] + 1) * Stride], (float)input[(x[1] + 1) * Stride], (float)input[(x[2] + 1) * Stride], (float)input[(x[3] + 1) * Stride]);
+		const __m128 y2 = _mm_setr_ps((float)input[(x[0] + 2) * Stride], (float)input[(x[1] + 2) * Stride], (float)input[(x[2] + 2) * Stride], (float)input[(x[3] + 2) * Stride]);
+		const __m128 a = _mm_loadu_ps(alpha + i);
+
+		const __m128 c1 = _mm_mul_ps(half, _mm_sub_ps(y1, ym1));
+		const __m128 c2 = _mm_sub_ps(_mm_add_ps(_mm_sub_ps(ym1, _mm_mul_ps(twoAndHalf, y0)), _mm_mul_ps(two, y1)), _mm_mul_ps(half, y2));
+		const __m128 c3 = _mm_add_ps(_mm_mul_ps(half, _mm_sub_ps(y2, ym1)), _mm_mul_ps(oneAndHalf, _mm_sub_ps(y0, y1)));
+
+		__m128 result = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(c3, a), c2), a), c1), a), y0);
+
+		if (ApplyGain) result = _mm_mul_ps(result, g);
+
+		_mm_storeu_ps(output + i, result);
+	}
+#endif
+
+	for (; i < numSamples; i++)
+	{
+		const int pos = index[i];
+		const float a = alpha[i];
+
+		const float ym1 = (float)input[(pos - 1) * Stride];
+		const float y0 = (float)input[pos * Stride];
+		const float y1 = (float)input[(pos + 1) * Stride];
+		const float y2 = (float)input[(pos + 2) * Stride];
+
+		// 4-point, 3rd-order Hermite (Catmull-Rom)
+		const float c1 = 0.5f * (y1 - ym1);
+		const float c2 = ym1 - 2.5f * y0 + 2.0f * y1 - 0.5f * y2;
+		const float c3 = 0.5f * (y2 - ym1) + 1.5f * (y0 - y1);
+
+		const float result = ((c3 * a + c2) * a + c1) * a + y0;
+
+		output[i] = ApplyGain ? result * gain : result;
+	}
+}
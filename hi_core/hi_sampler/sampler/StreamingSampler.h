@@ -45,8 +45,12 @@ class ModulatorSamplerSoundPool;
 */
 struct StereoChannelData
 {
-	const float *leftChannel;
-	const float *rightChannel;
+	const float *leftChannel = nullptr;
+	const float *rightChannel = nullptr;
+
+	/** If the samples are read directly from a compact preload buffer, this points to the interleaved 16 bit samples. */
+	const int16 *interleavedInt16 = nullptr;
+	float int16Gain = 0.0f;
 };
 
 // ==================================================================================================================================================
@@ -85,6 +89,78 @@ struct StereoChannelData
 #define OVERWRITE_BUFFER_WITH_VOICE_DATA 1
 #endif
 
+// The resampling kernels use SSE2 instructions to interpolate four samples at once. Set this to 0 to use the scalar code path.
+#if JUCE_INTEL && !JUCE_IOS
+#define HI_SAMPLER_USE_SSE 1
+#include <emmintrin.h>
+#else
+#define HI_SAMPLER_USE_SSE 0
+#endif
+
+// ==================================================================================================================================================
+
+/** A stereo sample buffer that stores interleaved samples in a (smaller) integer format.
+*
+*	The StreamingSamplerSound uses this for its preload and loop buffers if it doesn't use the float preload format. A 16 bit 
+*	buffer needs half the memory of a float buffer. The samples are converted when they are copied into the streaming buffers, 
+*	or - for 16 bit buffers - by the interpolation of the voice.
+*
+*	Every buffer has a gain (the float value of one integer step). It is the full scale of the format by default, but it can 
+*	be normalised to the peak of the samples to store quiet samples with more resolution.
+*/
+class NativeSampleBuffer
+{
+public:
+
+	NativeSampleBuffer() {};
+
+	/** Allocates the buffer and resets the gain. This throws std::bad_alloc if there is not enough memory. */
+	void setSize(MonolithFileHeader::SampleFormat newFormat, int newNumSamples);
+
+	/** Allocates the buffer and converts the samples. If normalise is true, the gain is set to the peak of the samples. */
+	void createFrom(const AudioSampleBuffer &source, MonolithFileHeader::SampleFormat newFormat, bool normalise);
+
+	/** Converts the float samples into the native format. */
+	void copyFrom(const AudioSampleBuffer &source, int sourceStartSample, int destStartSample, int numSamplesToCopy) noexcept;
+
+	/** Converts the samples into the float buffer. */
+	void copyTo(AudioSampleBuffer &destination, int destStartSample, int sourceStartSample, int numSamplesToCopy) const noexcept;
+
+	int getNumSamples() const noexcept { return numSamples; }
+
+	size_t getSizeInBytes() const noexcept { return (size_t)numSamples * (size_t)getBytesPerFrame(); }
+
+	MonolithFileHeader::SampleFormat getFormat() const noexcept { return format; }
+
+	/** Returns the float value of one integer step. */
+	float getGain() const noexcept { return gain; }
+
+	/** Returns the interleaved samples of a 16 bit buffer (the right channel is the next value). */
+	const int16* getInt16Data(int sampleIndex) const noexcept
+	{
+		jassert(format == MonolithFileHeader::Int16);
+		jassert(isPositiveAndBelow(sampleIndex, numSamples));
+
+		return reinterpret_cast<const int16*>(data.getData()) + 2 * sampleIndex;
+	}
+
+	/** Returns the format that stores the samples of the reader without loss. */
+	static MonolithFileHeader::SampleFormat getNativeFormat(const AudioFormatReader &reader) noexcept;
+
+private:
+
+	int getBytesPerFrame() const noexcept { return 2 * MonolithFileHeader::getBytesPerSample(format); }
+
+	static float getFullScaleGain(MonolithFileHeader::SampleFormat format) noexcept;
+
+	MonolithFileHeader::SampleFormat format = MonolithFileHeader::Float32;
+	int numSamples = 0;
+	float gain = 1.0f;
+	HeapBlock<uint8, true> data;
+
+	JUCE_DECLARE_NON_COPYABLE(NativeSampleBuffer)
+};
+
 // ==================================================================================================================================================
 
 /** A SamplerSound which provides buffered disk streaming using memory mapped file access and a preloaded sample start. */
@@ -218,6 +294,9 @@ public:
 	*/
 	void setPreloadSize(int newPreloadSizeInSamples, bool forceReload = false);
 
+	/** Returns the preload size that was set with setPreloadSize(). */
+	int getPreloadSize() const noexcept { return preloadSize; }
+
 	/** Returns the size of the preload buffer in bytes. You can use this method to check how much memory the sound uses. It also includes the memory used for the crossfade buffer. */
 	size_t getActualPreloadSize() const;
 
@@ -294,6 +373,41 @@ public:
 		return preloadBuffer;
 	}
 
+	/** Returns the preload buffer in the native format. This is empty if the FloatPreload format is used. */
+	const NativeSampleBuffer &getNativePreloadBuffer() const noexcept { return nativePreloadBuffer; }
+
+	/** Returns true if the preload buffer is stored in the native format (the float preload buffer is empty then). */
+	bool hasNativePreloadBuffer() const noexcept { return nativePreloadBuffer.getNumSamples() != 0; }
+
+	/** Returns the number of preloaded samples (in either format). */
+	int getNumPreloadedSamples() const noexcept { return hasNativePreloadBuffer() ? nativePreloadBuffer.getNumSamples() : preloadBuffer.getNumSamples(); }
+
+	/** The formats for the preload and loop buffers. */
+	enum PreloadFormat
+	{
+		/** Float buffers. */
+		FloatPreload = 0,
+
+		/** The native format of the file (16 / 24 bit). This is lossless, but needs a conversion when the samples are copied into the streaming buffers. */
+		NativePreload,
+
+		/** 16 bit samples with a gain per buffer. The voice reads the preload buffer directly, so this halves the memory
+		*	without an extra copy, but it is lossy for files with a higher bit depth.
+		*/
+		CompactPreload,
+		numPreloadFormats
+	};
+
+	/** Sets the format of the preload and loop buffers.
+	*
+	*	The loop buffers are converted immediately, the preload buffer at the next call to setPreloadSize(). With the NativePreload 
+	*	format, the preload size should be at least twice the streaming buffer size so that the disk reading starts with the same 
+	*	headroom as with a float preload buffer.
+	*/
+	void setPreloadFormat(PreloadFormat newFormat);
+
+	PreloadFormat getPreloadFormat() const noexcept { return preloadFormat; }
+
 	// ==============================================================================================================================================
 
 	/** Scans the file for the max level. */
@@ -344,7 +458,7 @@ private:
 		AudioFormatReader *getReader();
 
 		/** Encapsulates all reading operations. It will use the best available reader type and opens the file handle if it is not open yet. */
-		void readFromDisk(AudioSampleBuffer &buffer, int startSample, int numSamples, int readerPosition, bool useMemoryMappedReader);
+		void readFromDisk(AudioSampleBuffer &buffer, int startSample, int numSamples, int readerPosition, bool useMemoryMappedReader, AsyncReadBatch *batch=nullptr);
 
 		/** Call this method if you want to close the file handle. If voices are playing, it won't close it. */
 		void closeFileHandles(NotificationType notifyPool=sendNotification);
@@ -420,8 +534,10 @@ private:
 		int monolithicChannelIndex = -1;
 		String monolithicName;
 
-		CriticalSection readLock2;
+		/** The normal reader keeps the stream position, so two streaming threads must not use it at the same time. */
+		CriticalSection normalReaderLock;
 
+		/** Guards the readers against being closed while they are used. Memory mapped reads can run in parallel. */
 		ReadWriteLock fileAccessLock;
 
 
@@ -440,6 +556,12 @@ private:
 		ScopedPointer<MemoryMappedAudioFormatReader> memoryReader;
 		ScopedPointer<AudioFormatReader> normalReader;
 		bool fileHandlesOpen;
+
+		/** Opens the file handle for batched reading (WAV or AIFF files only). */
+		void refreshAsyncLayout();
+
+		AsyncReadBatch::FileHandle::Ptr asyncFile;
+		AsyncReadBatch::FileLayout asyncLayout;
 		
         Atomic<int> voiceCount;
 
@@ -460,11 +582,13 @@ private:
 	*
 	*	It copies the samples either from the preload buffer or reads it directly from the file, so don't call this method from the 
 	*	audio thread, but use the SampleLoader class which handles the background thread stuff.
+	*
+	*	If a batch is supplied, the disk reads are added to the batch and the samples are written when the batch is submitted.
 	*/
-	void fillSampleBuffer(AudioSampleBuffer &sampleBuffer, int samplesToCopy, int uptime) const;
+	void fillSampleBuffer(AudioSampleBuffer &sampleBuffer, int samplesToCopy, int uptime, AsyncReadBatch *batch=nullptr) const;
 
 	// used to wrap the read process for looping
-	void fillInternal(AudioSampleBuffer &sampleBuffer, int samplesToCopy, int uptime, int offsetInBuffer=0) const;
+	void fillInternal(AudioSampleBuffer &sampleBuffer, int samplesToCopy, int uptime, int offsetInBuffer=0, AsyncReadBatch *batch=nullptr) const;
 
 
 	// ==============================================================================================================================================
@@ -478,7 +602,16 @@ private:
 	
 	friend class SampleLoader;
 
+	/** Returns the format for the preloaded samples and sets normalise to true if they can't be stored without loss anyway.
+	*
+	*	Processed samples (eg. the loop crossfade) are no longer integers, so the NativePreload format stores them as float.
+	*/
+	MonolithFileHeader::SampleFormat getStorageFormat(bool isProcessed, bool &normalise) const;
+
 	AudioSampleBuffer preloadBuffer;	
+	NativeSampleBuffer nativePreloadBuffer;
+	PreloadFormat preloadFormat = FloatPreload;
+
 	double sampleRate;
 
 	int monolithOffset;
@@ -509,9 +642,9 @@ private:
 
 
 	// contains the precalculated crossfade
-	AudioSampleBuffer loopBuffer;
+	NativeSampleBuffer loopBuffer;
 
-	AudioSampleBuffer smallLoopBuffer;
+	NativeSampleBuffer smallLoopBuffer;
 
 	// ==============================================================================================================================================
 
@@ -561,12 +694,23 @@ public:
 	*/
 	JobStatus runJob() override;
 
+	/** Adds the disk reads for the inactive buffer to the batch of the streaming thread. */
+	bool addToBatch(AsyncReadBatch &batch) override;
+
+	/** Releases the write buffer after the reads of the batch were performed. */
+	JobStatus finishBatchedJob() override;
+
 	size_t getActualStreamingBufferSize() const
 	{
 		return b1.getNumSamples() * 2 * 2;
 	}
 
-	StereoChannelData fillVoiceBuffer(AudioSampleBuffer &voiceBuffer, double numSamples);
+	/** Returns the read pointers for the next block.
+	*
+	*	If the samples are spread across both streaming buffers, they are copied into the voiceBuffer.
+	*	If withHistorySample is true, the sample before the read index is guaranteed to be accessible (at index -1).
+	*/
+	StereoChannelData fillVoiceBuffer(AudioSampleBuffer &voiceBuffer, double numSamples, bool withHistorySample=false);
 
     /** Advances the read index and returns `false` if the streaming thread is blocked. */
 	bool advanceReadIndex(double delta);
@@ -605,9 +749,9 @@ public:
 		{
             jassert(sound != nullptr);
 
+			// The loader might still be running on another worker thread
 			if (loader->isRunning())
 			{
-				jassertfalse;
 				return SampleThreadPoolJob::jobNeedsRunningAgain;
 			}
             
@@ -694,11 +838,24 @@ private:
 		return b1.getNumSamples();
 	}
 
+	/** Returns the size of the preload buffer or streaming buffer that is currently read. */
+	int getNumSamplesInReadBuffer() const noexcept
+	{
+		const NativeSampleBuffer *compactBuffer = compactReadBuffer.get();
+
+		return compactBuffer != nullptr ? compactBuffer->getNumSamples() : readBuffer.get()->getNumSamples();
+	}
+
+	/** Copies samples from the current read buffer (converting them if it is a compact preload buffer). */
+	void copyFromReadBuffer(AudioSampleBuffer &destination, int destStartSample, int sourceStartSample, int numSamples) const noexcept;
+
 	bool requestNewData();
 	
 	bool swapBuffers();
 
-	void fillInactiveBuffer();
+	void fillInactiveBuffer(AsyncReadBatch *batch=nullptr);
+
+	void updateDiskUsage(double readStart);
 	void refreshBufferSizes();
 	// ============================================================================================ member variables
 
@@ -734,6 +891,9 @@ private:
 	Atomic<AudioSampleBuffer const *> readBuffer;
 	Atomic<AudioSampleBuffer *> writeBuffer;
 
+	// If the voice reads directly from a 16 bit preload buffer, this is used instead of the read buffer
+	Atomic<NativeSampleBuffer const *> compactReadBuffer;
+
 	Atomic<const float*> readPointerLeft;
 	Atomic<const float*> readPointerRight;
 
@@ -741,6 +901,7 @@ private:
 
 	Atomic<float> diskUsage;
 	double lastCallToRequestData;
+	double batchReadStart = 0.0;
 
 	// just a pointer to the used pool
 	SampleThreadPool *backgroundPool;
@@ -748,11 +909,65 @@ private:
 	// the internal buffers
 
 	AudioSampleBuffer b1, b2;
+
+	// The last sample of the previous read buffer. The cubic interpolation needs it when the read index is at the start of the next buffer.
+	AudioSampleBuffer historyBuffer = AudioSampleBuffer(2, 1);
+	bool hasHistorySample = false;
     
     bool cancelled = false;
 };
 
 
+/** The resampling kernels that are used by the StreamingSamplerVoice.
+*
+*	The read positions are calculated once for a chunk of samples (either from a fixed pitch factor or from the pitch
+*	modulation values) and then applied to every channel, so multi mic samples only need to calculate them once.
+*	With HI_SAMPLER_USE_SSE the interpolation processes four samples at once.
+*/
+class SampleInterpolator
+{
+public:
+
+	enum
+	{
+		ChunkSize = 64
+	};
+
+	/** A chunk of precalculated read positions. */
+	struct Positions
+	{
+		int index[ChunkSize];
+		float alpha[ChunkSize];
+		int numSamples;
+	};
+
+	/** Calculates the positions for a fixed pitch factor and returns the read index for the next chunk. */
+	static float calculatePositions(Positions &p, float startIndex, float delta, int numSamples);
+
+	/** Calculates the positions using the pitch values for every sample and returns the read index for the next chunk. */
+	static float calculatePositions(Positions &p, float startIndex, const float *pitchData, int numSamples);
+
+	/** Interpolates between two neighbouring samples. */
+	static void interpolateLinear(const Positions &p, const float *input, float *output);
+
+	/** Uses a 4-point Hermite curve. The input must have one valid sample before and two samples after every read position. */
+	static void interpolateCubic(const Positions &p, const float *input, float *output);
+
+	/** Interpolates one channel of interleaved stereo 16 bit samples and multiplies the result with the gain. */
+	static void interpolateLinear(const Positions &p, const int16 *input, float gain, float *output);
+
+	/** Interpolates one channel of interleaved stereo 16 bit samples and multiplies the result with the gain. */
+	static void interpolateCubic(const Positions &p, const int16 *input, float gain, float *output);
+
+private:
+
+	template <typename SampleType, int Stride, bool ApplyGain> 
+	static void interpolateLinearInternal(const Positions &p, const SampleType *input, float gain, float *output);
+
+	template <typename SampleType, int Stride, bool ApplyGain> 
+	static void interpolateCubicInternal(const Positions &p, const SampleType *input, float gain, float *output);
+};
+
 /** A SamplerVoice that streams the data from a StreamingSamplerSound
 *
 *	It uses a SampleLoader object to fetch the data and copies the values into an internal buffer, so you
@@ -765,6 +980,14 @@ public:
 	
 	~StreamingSamplerVoice() {};
 
+	/** The interpolation algorithm that is used for resampling. */
+	enum InterpolationType
+	{
+		Linear = 0, ///< the default interpolation (fast, but with some aliasing for high pitch factors)
+		Cubic, ///< a 4-point Hermite interpolation (about twice as expensive)
+		numInterpolationTypes
+	};
+
 	/** Always returns true. */
 	bool canPlaySound (SynthesiserSound*) { return true; };
 
@@ -791,6 +1014,15 @@ public:
 	/** Adds it's output to the outputBuffer. */
 	void renderNextBlock(AudioSampleBuffer &outputBuffer, int startSample, int numSamples) override;
 
+	/** Renders multiple voices that play the same note (eg. the mic positions of a multimic sample).
+	*
+	*	The read positions are calculated only once and every voice is rendered into the channels [2 * i, 2 * i + 1] of the outputBuffer.
+	*	The temporary voice buffer must have two channels for every voice.
+	*/
+	static void renderVoicesInOnePass(StreamingSamplerVoice **voicesToRender, int numVoicesToRender, AudioSampleBuffer &outputBuffer, int startSample, int numSamples);
+
+	void setInterpolationType(InterpolationType newType) noexcept { interpolationType = newType; };
+
 	/** You can pass a pointer with float values containing pitch information for each sample.
 	*
 	*	The array size should be exactly the number of samples that are calculated in the current renderNextBlock method.
@@ -872,10 +1104,11 @@ public:
 		tvb = buffer;
 	}
 
-	/** Call this once for every sampler. */
-	static void initTemporaryVoiceBuffer(AudioSampleBuffer* bufferToUse, int samplesPerBlock)
+	/** Call this once for every sampler. It needs two channels for every mic position. */
+	static void initTemporaryVoiceBuffer(AudioSampleBuffer* bufferToUse, int samplesPerBlock, int numMicPositions=1)
 	{
-		*bufferToUse = AudioSampleBuffer(2, samplesPerBlock * MAX_SAMPLER_PITCH);
+		// The additional samples are used by the cubic interpolation
+		*bufferToUse = AudioSampleBuffer(2 * numMicPositions, samplesPerBlock * MAX_SAMPLER_PITCH + 4);
 		bufferToUse->clear();
 	}
 
@@ -889,6 +1122,8 @@ private:
 
 	const float *pitchData;
 
+	InterpolationType interpolationType = Linear;
+
 	// This lets the wrapper class access the internal data without annoying get/setters
 	friend class ModulatorSamplerVoice; 
 	friend class MultiMicModulatorSamplerVoice;
@@ -183,6 +183,7 @@ void SamplerBody::SampleEditingActions::checkMicPositionAmountBeforePasting(cons
 		else if (PresetHandler::showYesNoWindow("Different mic amount detected.", "Do you want to replace all existing samples in this sampler?"))
 		{
 			s->clearSounds();
+			s->refreshSoundMap();
 
 			s->setNumChannels(numMics);
 
@@ -437,6 +438,8 @@ public:
 			s->addChangeListener(sampler->getSampleMap());
 		}
 
+		sampler->refreshSoundMap();
+
 		sampler->setBypassed(false);
 
 
@@ -869,6 +872,8 @@ void SamplerBody::SampleEditingActions::extractToSingleMicSamples(SamplerBody *
 			s->addChangeListener(sampler->getSampleMap());
 		}
 
+		sampler->refreshSoundMap();
+
 		sampler->setBypassed(false);
 
 		sampler->sendChangeMessage();
@@ -50,25 +50,43 @@ namespace wdl
 ConvolutionEffect::ConvolutionEffect(MainController *mc, const String &id) :
 MasterEffectProcessor(mc, id),
 AudioSampleProcessor(this),
+rampFlag(false),
+processFlag(true),
+rampIndex(0),
 dryGain(0.0f),
 wetGain(1.0f),
 latency(0),
-isReloading(false),
-rampFlag(false),
-rampIndex(0),
-processFlag(true)
+crossfadeTime((float)CONVOLUTION_CROSSFADE_TIME_MS),
+engineType(WDL),
+impulseBlockSize(0),
+impulseEngineType(WDL),
+impulseChanged(false),
+parentProcessor(dynamic_cast<AudioProcessor*>(mc))
 {
 	parameterNames.add("DryGain");
 	parameterNames.add("WetGain");
 	parameterNames.add("Latency");
 	parameterNames.add("ImpulseLength");
 	parameterNames.add("ProcessInput");
+	parameterNames.add("CrossfadeTime");
+	parameterNames.add("EngineType");
 
 	smoothedGainerWet.setParameter((int)ScriptingDsp::SmoothedGainer::Parameters::FastMode, 1.0f);
 	smoothedGainerDry.setParameter((int)ScriptingDsp::SmoothedGainer::Parameters::FastMode, 1.0f);
 
 	smoothedGainerWet.setParameter((int)ScriptingDsp::SmoothedGainer::Parameters::Gain, 1.0f);
 	smoothedGainerDry.setParameter((int)ScriptingDsp::SmoothedGainer::Parameters::Gain, 0.0f);
+
+	loader = new ImpulseLoader(*this);
+	loader->startThread();
+}
+
+ConvolutionEffect::~ConvolutionEffect()
+{
+	loader->signalThreadShouldExit();
+	loader->wakeUpLoader();
+	loader->stopThread(2000);
+	loader = nullptr;
 }
 
 void ConvolutionEffect::setImpulse()
@@ -77,26 +95,31 @@ void ConvolutionEffect::setImpulse()
 
 	if (getSampleBuffer()->getNumChannels() == 0) return;
 
-	ScopedValueSetter<bool> s(isReloading, true);
+	{
+		ScopedLock sl(impulseLock);
 
-	ScopedLock sl(getImpulseLock());
+		const int numChannels = jmin<int>(2, getSampleBuffer()->getNumChannels());
 
-	convolutionEngine.Reset();
+		impulseData.setSize(numChannels, jmax<int>(0, length));
 
-	impulseBuffer.SetNumChannels(getSampleBuffer()->getNumChannels());
-	const int numSamples = impulseBuffer.SetLength(length);
+		for (int i = 0; i < numChannels; i++)
+		{
+			impulseData.copyFrom(i, 0, *getSampleBuffer(), i, sampleRange.getStart(), impulseData.getNumSamples());
+		}
 
-	float *bufferL = impulseBuffer.impulses[0].Get();
-	float *bufferR = getSampleBuffer()->getNumChannels() > 1 ? impulseBuffer.impulses[1].Get() : bufferL;
+		impulseBlockSize = getBlockSize();
+		impulseEngineType = engineType;
+		impulseChanged = true;
+	}
 
-	FloatVectorOperations::copy(bufferL, getSampleBuffer()->getReadPointer(0, sampleRange.getStart()), numSamples);
-	if (getSampleBuffer()->getNumChannels() > 1)
-	{
-		FloatVectorOperations::copy(bufferR, getSampleBuffer()->getReadPointer(1, sampleRange.getStart()), numSamples);
+	loader->wakeUpLoader();
+}
 
-	}
+bool ConvolutionEffect::isLoadingImpulse() const
+{
+	ScopedLock sl(impulseLock);
 
-	convolutionEngine.SetImpulse(&impulseBuffer, 0, getBlockSize(), 0, 0, getBlockSize());
+	return impulseChanged || engines.hasPendingEngine();
 }
 
 float ConvolutionEffect::getAttribute(int parameterIndex) const
@@ -108,6 +131,8 @@ float ConvolutionEffect::getAttribute(int parameterIndex) const
 	case Latency:		return (float)latency;
 	case ImpulseLength:	return 1.0f;
 	case ProcessInput:	return processFlag ? 1.0f : 0.0f;
+	case CrossfadeTime:	return crossfadeTime;
+	case EngineType:	return (float)engineType;
 	default:			jassertfalse; return 1.0f;
 	}
 }
@@ -129,6 +154,10 @@ void ConvolutionEffect::setInternalAttribute(int parameterIndex, float newValue)
 	case ImpulseLength:	setImpulse();
 		break;
 	case ProcessInput:	enableProcessing(newValue >= 0.5f); break;
+	case CrossfadeTime:	crossfadeTime = jmax<float>(0.0f, newValue); break;
+	case EngineType:	engineType = jlimit<int>(0, numEngineTypes - 1, (int)newValue);
+						setImpulse();
+						break;
 	default:			jassertfalse; return;
 	}
 }
@@ -143,6 +172,9 @@ void ConvolutionEffect::restoreFromValueTree(const ValueTree &v)
 	loadAttribute(ImpulseLength, "ImpulseLength");
 	loadAttribute(ProcessInput, "ProcessInput");
 
+	setAttribute(CrossfadeTime, (float)v.getProperty("CrossfadeTime", CONVOLUTION_CROSSFADE_TIME_MS), sendNotification);
+	setAttribute(EngineType, (float)v.getProperty("EngineType", (int)WDL), sendNotification);
+
 	AudioSampleProcessor::restoreFromValueTree(v);
 }
 
@@ -155,6 +187,8 @@ ValueTree ConvolutionEffect::exportAsValueTree() const
 	saveAttribute(Latency, "Latency");
 	saveAttribute(ImpulseLength, "ImpulseLength");
 	saveAttribute(ProcessInput, "ProcessInput");
+	saveAttribute(CrossfadeTime, "CrossfadeTime");
+	saveAttribute(EngineType, "EngineType");
 
 	AudioSampleProcessor::saveToValueTree(v);
 
@@ -163,27 +197,78 @@ ValueTree ConvolutionEffect::exportAsValueTree() const
 
 void ConvolutionEffect::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
-    ScopedLock sl(getImpulseLock());
-    
 	EffectProcessor::prepareToPlay(sampleRate, samplesPerBlock);
 
 	smoothedGainerWet.prepareToPlay(sampleRate, samplesPerBlock);
 	smoothedGainerDry.prepareToPlay(sampleRate, samplesPerBlock);
 
 	wetBuffer = AudioSampleBuffer(2, samplesPerBlock);
+	fadeBuffer = AudioSampleBuffer(2, samplesPerBlock);
+
+	// The audio callback is not running while the processor is prepared
+	if (engines.getCurrentEngine() != nullptr) engines.getCurrentEngine()->reset();
+	if (engines.getFadingEngine() != nullptr) engines.getFadingEngine()->reset();
+
+	bool blockSizeChanged;
+
+	{
+		ScopedLock sl(impulseLock);
+		blockSizeChanged = impulseBlockSize != samplesPerBlock;
+	}
+
+	// The partitions depend on the block size, so the engine has to be recreated
+	if (blockSizeChanged)
+		setImpulse();
+}
+
+void ConvolutionEffect::swapEngines()
+{
+	const int numFadeSamples = roundFloatToInt(crossfadeTime * 0.001f * (float)getSampleRate());
 
-	convolutionEngine.Reset();
+	// The old engine is deleted by the loader
+	if (engines.swapEngines(numFadeSamples))
+		loader->wakeUpLoader();
+}
+
+void ConvolutionEffect::Engine::reset()
+{
+	if (nonUniform != nullptr)
+		nonUniform->reset();
+	else
+		convolution.Reset();
+}
+
+int ConvolutionEffect::processEngine(Engine &e, float **channels, int numSamples, AudioSampleBuffer &destination, bool isNonRealtime)
+{
+	if (e.nonUniform != nullptr)
+	{
+		e.nonUniform->setNonRealtime(isNonRealtime);
+		e.nonUniform->process(channels, destination.getArrayOfWritePointers(), numSamples);
+		return numSamples;
+	}
+
+	e.convolution.Add(channels, numSamples, 2);
+
+	const int availableSamples = jmin(e.convolution.Avail(numSamples), numSamples);
+
+	if (availableSamples > 0)
+	{
+		FloatVectorOperations::copy(destination.getWritePointer(0), e.convolution.Get()[0], availableSamples);
+		FloatVectorOperations::copy(destination.getWritePointer(1), e.convolution.Get()[1], availableSamples);
+
+		e.convolution.Advance(availableSamples);
+	}
+
+	return availableSamples;
 }
 
 void ConvolutionEffect::applyEffect(AudioSampleBuffer &buffer, int startSample, int numSamples)
 {
-    ADD_GLITCH_DETECTOR("Rendering IR reverb " + getId());
+    ADD_GLITCH_DETECTOR(nullptr, "Rendering IR reverb " + getId());
     
-	ScopedLock sl(getImpulseLock());
-
 	if (startSample != 0)
 	{
-		debugError(this, "Buffer start not 0!");
+		getMainController()->writeFormattedToConsole("Buffer start not 0!", 1, this);
 	}
 
 	float *l = buffer.getWritePointer(0, 0);
@@ -191,9 +276,11 @@ void ConvolutionEffect::applyEffect(AudioSampleBuffer &buffer, int startSample,
 
 	float *channels[2] = { l, r };
 
+	swapEngines();
 
+	Engine *currentEngine = engines.getCurrentEngine();
 
-	if (isReloading || (!processFlag && !rampFlag))
+	if (currentEngine == nullptr || (!processFlag && !rampFlag))
 	{
 		smoothedGainerDry.processBlock(channels, 2, numSamples);
 
@@ -203,19 +290,42 @@ void ConvolutionEffect::applyEffect(AudioSampleBuffer &buffer, int startSample,
 		return;
 	}
 
-	convolutionEngine.Add(channels, numSamples, 2);
+	// An offline render waits for the tail of the NonUniform engine instead of dropping late partitions
+	const bool isNonRealtime = parentProcessor != nullptr && parentProcessor->isNonRealtime();
+
+	const int availableSamples = processEngine(*currentEngine, channels, numSamples, wetBuffer, isNonRealtime);
+
+	if (currentEngine->nonUniform != nullptr)
+	{
+		const int numMissedDeadlines = currentEngine->nonUniform->getNumMissedDeadlines();
+
+		if (numMissedDeadlines != currentEngine->numReportedMissedDeadlines)
+		{
+			currentEngine->numReportedMissedDeadlines = numMissedDeadlines;
+
+			// The console queue is lock free, so this can be written from the audio thread
+			getMainController()->writeFormattedToConsole("The convolution tail is too slow: %0 partitions were dropped", 1, this, numMissedDeadlines);
+		}
+	}
+
+	if (engines.isFading())
+	{
+		const int availableFadeSamples = processEngine(*engines.getFadingEngine(), channels, numSamples, fadeBuffer, isNonRealtime);
+
+		engines.applyCrossfade(wetBuffer.getWritePointer(0), wetBuffer.getWritePointer(1),
+							   fadeBuffer.getReadPointer(0), fadeBuffer.getReadPointer(1),
+							   availableSamples, availableFadeSamples);
+	}
 
 	smoothedGainerDry.processBlock(channels, 2, numSamples);
 
 	currentValues.inL = FloatVectorOperations::findMaximum(l, numSamples);
 	currentValues.inR = FloatVectorOperations::findMaximum(l, numSamples);
 
-	const int availableSamples = jmin(convolutionEngine.Avail(numSamples), numSamples);
-
 	if (availableSamples > 0)
 	{
-		const float *convolutedL = convolutionEngine.Get()[0];
-		const float *convolutedR = convolutionEngine.Get()[1];
+		const float *convolutedL = wetBuffer.getReadPointer(0);
+		const float *convolutedR = wetBuffer.getReadPointer(1);
 
 		currentValues.outL = wetGain * FloatVectorOperations::findMaximum(convolutedL, availableSamples);
 		currentValues.outR = wetGain * FloatVectorOperations::findMaximum(convolutedR, availableSamples);
@@ -224,9 +334,6 @@ void ConvolutionEffect::applyEffect(AudioSampleBuffer &buffer, int startSample,
 		{
 			const int rampingTime = (CONVOLUTION_RAMPING_TIME_MS * (int)getSampleRate()) / 1000;
 
-            
-            
-            
 			for (int i = 0; i < availableSamples; i++)
 			{
                 float rampValue = jlimit<float>(0.0f, 1.0f, (float)rampIndex / (float)rampingTime);
@@ -240,13 +347,14 @@ void ConvolutionEffect::applyEffect(AudioSampleBuffer &buffer, int startSample,
 				rampIndex++;
 			}
 
-			convolutionEngine.Advance(availableSamples);
-
 			if (rampIndex >= rampingTime)
 			{
 				if (!processFlag)
 				{
-					convolutionEngine.Reset();
+					currentEngine->reset();
+
+					if (engines.getFadingEngine() != nullptr)
+						engines.getFadingEngine()->reset();
 				}
 
 				rampFlag = false;
@@ -254,21 +362,91 @@ void ConvolutionEffect::applyEffect(AudioSampleBuffer &buffer, int startSample,
 		}
 		else
 		{
-
-			FloatVectorOperations::copy(wetBuffer.getWritePointer(0), convolutedL, availableSamples);
-			FloatVectorOperations::copy(wetBuffer.getWritePointer(1), convolutedR, availableSamples);
-
 			smoothedGainerWet.processBlock(wetBuffer.getArrayOfWritePointers(), 2, availableSamples);
 
 			FloatVectorOperations::add(l, wetBuffer.getReadPointer(0), availableSamples);
 			FloatVectorOperations::add(r, wetBuffer.getReadPointer(1), availableSamples);
+		}
+	}
+}
+
+ConvolutionEffect::ImpulseLoader::ImpulseLoader(ConvolutionEffect &parent_) :
+	Thread("Convolution Impulse Loader"),
+	parent(parent_)
+{
+
+}
+
+void ConvolutionEffect::ImpulseLoader::run()
+{
+	while (!threadShouldExit())
+	{
+		parent.engines.deleteRetiredEngine();
 
-			convolutionEngine.Advance(availableSamples);
+		if (Engine *e = createEngine())
+		{
+			// If the audio thread didn't pick up the last engine yet, it's replaced by the new one
+			parent.engines.postEngine(e);
 		}
 
+		wakeUp.wait();
+	}
+}
+
+ConvolutionEffect::Engine *ConvolutionEffect::ImpulseLoader::createEngine()
+{
+	AudioSampleBuffer data;
+	int blockSize;
+	int type;
+
+	{
+		ScopedLock sl(parent.impulseLock);
+
+		if (!parent.impulseChanged)
+			return nullptr;
+
+		parent.impulseChanged = false;
+
+		data.makeCopyOf(parent.impulseData);
+		blockSize = parent.impulseBlockSize;
+		type = parent.impulseEngineType;
+	}
+
+	ScopedPointer<Engine> e = new Engine();
+
+	if (type == NonUniform)
+	{
+		e->nonUniform = new NonUniformConvolution();
+		e->nonUniform->setImpulse(data, blockSize);
+	}
+	else
+	{
+		e->impulseBuffer.SetNumChannels(data.getNumChannels());
+		const int numSamples = jmin<int>(e->impulseBuffer.SetLength(data.getNumSamples()), data.getNumSamples());
+
+		for (int i = 0; i < data.getNumChannels(); i++)
+		{
+			FloatVectorOperations::copy(e->impulseBuffer.impulses[i].Get(), data.getReadPointer(i), numSamples);
+		}
+
+		e->convolution.SetImpulse(&e->impulseBuffer, 0, blockSize, 0, 0, blockSize);
+	}
+
+	if (blockSize > 0)
+	{
+		// Run some silence through the engine so that its queues are allocated here and not on the audio thread
+		AudioSampleBuffer silence(2, blockSize);
+		AudioSampleBuffer output(2, blockSize);
 
+		silence.clear();
 
+		for (int i = 0; i < 8; i++)
+			processEngine(*e, silence.getArrayOfWritePointers(), blockSize, output, true);
+
+		e->reset();
 	}
+
+	return e.release();
 }
 
 ProcessorEditorBody *ConvolutionEffect::createEditor(ProcessorEditor *parentEditor)
@@ -291,8 +469,6 @@ void ConvolutionEffect::enableProcessing(bool shouldBeProcessed)
 {
 	if (processFlag != shouldBeProcessed)
 	{
-		ScopedLock sl(getImpulseLock());
-
 		processFlag = shouldBeProcessed;
 
 		rampFlag = true;
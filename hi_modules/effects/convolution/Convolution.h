@@ -34,6 +34,7 @@
 #define CONVOLUTION_H_INCLUDED
 
 #define CONVOLUTION_RAMPING_TIME_MS 30
+#define CONVOLUTION_CROSSFADE_TIME_MS 100
 
 #if JUCE_MSVC
  #pragma warning (push)
@@ -180,12 +181,132 @@ private:
 
 
 
+/** Hands engines that are created on a background thread over to the audio thread and crossfades between them.
+*
+*	The background thread posts a new engine with postEngine(). The audio thread picks it up in swapEngines() and fades
+*	from the old engine to the new one. After the fade the old engine is passed back, and the background thread deletes it
+*	in deleteRetiredEngine(). Both handovers use a single atomic pointer, so neither thread locks or waits for the other.
+*	The audio thread never deletes an engine.
+*/
+template <class EngineType> class CrossfadingEngineSwapper
+{
+public:
+
+	CrossfadingEngineSwapper() :
+		pendingEngine(nullptr),
+		retiredEngine(nullptr),
+		currentEngine(nullptr),
+		fadingEngine(nullptr),
+		fadeIndex(0),
+		numFadeSamples(0)
+	{};
+
+	~CrossfadingEngineSwapper()
+	{
+		delete pendingEngine.exchange(nullptr);
+		delete retiredEngine.exchange(nullptr);
+		delete currentEngine;
+		delete fadingEngine;
+	}
+
+	/** Passes a new engine to the audio thread. If the last engine wasn't picked up yet, it will be deleted. */
+	void postEngine(EngineType *newEngine) { delete pendingEngine.exchange(newEngine); }
+
+	/** Deletes the engine that the audio thread doesn't need anymore. */
+	void deleteRetiredEngine() { delete retiredEngine.exchange(nullptr); }
+
+	/** Returns true if there is an engine that was not yet picked up by the audio thread. */
+	bool hasPendingEngine() const noexcept { return pendingEngine.load() != nullptr; }
+
+	/** Call this on the audio thread before the engines are processed.
+	*
+	*	This passes the old engine back when its fade is finished and picks up a pending engine. Returns true if an engine
+	*	was passed back, so that the background thread can be told to delete it.
+	*/
+	bool swapEngines(int numSamplesToFade) noexcept
+	{
+		bool engineWasRetired = false;
+
+		if (fadingEngine != nullptr && fadeIndex >= numFadeSamples)
+		{
+			EngineType *expected = nullptr;
+
+			// If the background thread hasn't deleted the last engine yet, try again in the next block
+			if (retiredEngine.compare_exchange_strong(expected, fadingEngine))
+			{
+				fadingEngine = nullptr;
+				engineWasRetired = true;
+			}
+		}
+
+		if (fadingEngine == nullptr && pendingEngine.load() != nullptr)
+		{
+			fadingEngine = currentEngine;
+			currentEngine = pendingEngine.exchange(nullptr);
+
+			fadeIndex = 0;
+			numFadeSamples = fadingEngine != nullptr ? jmax<int>(0, numSamplesToFade) : 0;
+		}
+
+		return engineWasRetired;
+	}
+
+	EngineType *getCurrentEngine() noexcept { return currentEngine; }
+
+	/** Returns the old engine until it is passed back to the background thread (this can be after its fade). */
+	EngineType *getFadingEngine() noexcept { return fadingEngine; }
+
+	/** Returns true if the old engine must still be processed for the crossfade. */
+	bool isFading() const noexcept { return fadingEngine != nullptr && fadeIndex < numFadeSamples; }
+
+	/** Fades from the old output to the new output. The result is written to the new output.
+	*
+	*	If the old engine delivered less samples than the new one, the missing samples are treated as silence.
+	*/
+	void applyCrossfade(float *newL, float *newR, const float *oldL, const float *oldR, int numSamples, int numOldSamples) noexcept
+	{
+		for (int i = 0; i < numSamples; i++)
+		{
+			const float newGain = jmin<float>(1.0f, (float)fadeIndex / (float)numFadeSamples);
+			const float oldValueL = i < numOldSamples ? oldL[i] : 0.0f;
+			const float oldValueR = i < numOldSamples ? oldR[i] : 0.0f;
+
+			newL[i] = oldValueL + newGain * (newL[i] - oldValueL);
+			newR[i] = oldValueR + newGain * (newR[i] - oldValueR);
+
+			fadeIndex++;
+		}
+	}
+
+private:
+
+	std::atomic<EngineType*> pendingEngine;
+	std::atomic<EngineType*> retiredEngine;
+
+	// only accessed by the audio thread
+	EngineType *currentEngine;
+	EngineType *fadingEngine;
+	int fadeIndex;
+	int numFadeSamples;
+
+	JUCE_DECLARE_NON_COPYABLE(CrossfadingEngineSwapper)
+};
+
+
+class NonUniformConvolution;
+
 /** @brief A convolution reverb using zero-latency convolution
 *	@ingroup effectTypes
 *
 *	This is a wrapper for the convolution engine found in WDL (the sole MIT licenced convolution engine available)
 *	It is not designed to replace real convolution reverbs (as the CPU usage for impulses > 0.6 seconds is unreasonable),
 *	but your early reflection impulses or other filter impulses will be thankful for this effect.
+*
+*	The impulse response is partitioned on a background thread. The finished engine is handed over to the audio thread
+*	through an atomic pointer and crossfaded with the old engine, so loading an impulse never blocks the audio thread.
+*
+*	With the NonUniform engine type, only the head of the impulse response is convolved on the audio thread and the
+*	tail is calculated on a worker thread (see NonUniformConvolution).
 */
 class ConvolutionEffect: public MasterEffectProcessor,
 						 public AudioSampleProcessor
@@ -203,19 +324,35 @@ public:
 		Latency, ///< you can change the latency (unused)
 		ImpulseLength, ///< the Impulse length (deprecated, use the SampleArea of the AudioSampleBufferComponent to change the impulse response)
 		ProcessInput, ///< if this attribute is set, the engine will fade out in a short time and reset itself.
+		CrossfadeTime, ///< the time in milliseconds for the crossfade between the old and the new impulse response
+		EngineType, ///< the convolution engine that is used (see EngineTypes)
 		numEffectParameters
 	};
 
+	enum EngineTypes
+	{
+		WDL = 0, ///< the WDL engine which convolves the whole impulse on the audio thread
+		NonUniform, ///< the non uniform partitioned engine which calculates the tail on a worker thread
+		numEngineTypes
+	};
+
 	ConvolutionEffect(MainController *mc, const String &id);;
 
+	~ConvolutionEffect();
+
 	
 
 	// ============================================================================================= Convolution methods
 
 	void newFileLoaded() override {	setImpulse(); }
 	void rangeUpdated() override { setImpulse(); }
+
+	/** Copies the current sample range and tells the background thread to create a new engine. This returns immediately. */
 	void setImpulse();
 
+	/** Returns true if there is an impulse response that was not yet picked up by the audio thread. */
+	bool isLoadingImpulse() const;
+
 	// ============================================================================================= MasterEffect methods
 
 	float getAttribute(int parameterIndex) const override;;
@@ -236,32 +373,84 @@ public:
 
 private:
 
-	GainSmoother smoothedGainerWet;
-	GainSmoother smoothedGainerDry;
+	/** A partitioned impulse response that is created on the background thread. */
+	struct Engine
+	{
+		void reset();
 
-	AudioSampleBuffer wetBuffer;
+		wdl::WDL_ImpulseBuffer impulseBuffer;
+		wdl::WDL_ConvolutionEngine_Div convolution;
+
+		ScopedPointer<NonUniformConvolution> nonUniform;
+
+		// the missed deadlines of the NonUniform engine that were already written to the console
+		int numReportedMissedDeadlines = 0;
+	};
+
+	/** Creates the engines and deletes the engines that the audio thread doesn't need anymore.
+	*
+	*	The thread sleeps until a new impulse is set or the audio thread passes an engine back.
+	*/
+	class ImpulseLoader : public Thread
+	{
+	public:
+
+		ImpulseLoader(ConvolutionEffect &parent_);
+
+		void run() override;
+
+		/** Wakes up the thread. This doesn't lock, so it can be called from the audio thread. */
+		void wakeUpLoader() noexcept { wakeUp.signal(); }
+
+	private:
+
+		Engine *createEngine();
+
+		ConvolutionEffect &parent;
+
+		// The loader is the only thread that waits on this semaphore
+		moodycamel::spsc_sema::LightweightSemaphore wakeUp;
+	};
+
+	/** Feeds the input into the engine and copies the available output into the destination. Returns the number of samples. */
+	static int processEngine(Engine &e, float **channels, int numSamples, AudioSampleBuffer &destination, bool isNonRealtime);
 
-	const CriticalSection& getImpulseLock() const { return lock; };
+	void swapEngines();
 
 	void enableProcessing(bool shouldBeProcessed);
 
+	GainSmoother smoothedGainerWet;
+	GainSmoother smoothedGainerDry;
+
+	AudioSampleBuffer wetBuffer;
+	AudioSampleBuffer fadeBuffer;
+
 	bool rampFlag;
 	bool rampUp;
 	bool processFlag;
 	int rampIndex;
 
-	CriticalSection lock;
-
 	bool isUsingPoolData;
 
-	bool isReloading;
-
 	float dryGain;
 	float wetGain;
 	int latency;
+	float crossfadeTime;
+	int engineType;
+
+	// the copy of the impulse response for the background thread (never accessed by the audio thread)
+	CriticalSection impulseLock;
+	AudioSampleBuffer impulseData;
+	int impulseBlockSize;
+	int impulseEngineType;
+	bool impulseChanged;
+
+	CrossfadingEngineSwapper<Engine> engines;
+
+	ScopedPointer<ImpulseLoader> loader;
 
-	wdl::WDL_ImpulseBuffer impulseBuffer;
-	wdl::WDL_ConvolutionEngine_Div convolutionEngine;
+	// used to check if the host renders offline
+	AudioProcessor *parentProcessor;
 };
 
 
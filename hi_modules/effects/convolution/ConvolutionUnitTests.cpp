@@ -0,0 +1,499 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licences for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licencing:
+*
+*   http://www.hartinstruments.net/hise/
+*
+*   HISE is based on the JUCE library,
+*   which also must be licenced for commercial applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+#include "JuceHeader.h"
+
+class ConvolutionUnitTest : public UnitTest
+{
+public:
+
+	ConvolutionUnitTest() :
+		UnitTest("Testing non uniform partitioned convolution")
+	{
+
+	}
+
+	void runTest() override
+	{
+		testAgainstDirectConvolution();
+		testFirstStageOnAudioThread();
+		testResetWithPendingJobs();
+		testEngineSpeed();
+	}
+
+private:
+
+	void fillWithDecayingNoise(AudioSampleBuffer &b, double decaySamples)
+	{
+		for (int c = 0; c < b.getNumChannels(); c++)
+		{
+			float *d = b.getWritePointer(c);
+
+			for (int i = 0; i < b.getNumSamples(); i++)
+				d[i] = (r.nextFloat() * 2.0f - 1.0f) * (float)std::exp(-(double)i / decaySamples);
+		}
+	}
+
+	void testAgainstDirectConvolution()
+	{
+		beginTest("Comparing the output with a direct convolution");
+
+		const int impulseLength = 6000;
+		const int numSamples = 16384;
+		const int maxBlockSize = 64;
+
+		AudioSampleBuffer impulse(2, impulseLength);
+		fillWithDecayingNoise(impulse, 2000.0);
+
+		AudioSampleBuffer input(2, numSamples);
+		fillWithDecayingNoise(input, 1.0e9);
+
+		AudioSampleBuffer output(2, numSamples);
+
+		NonUniformConvolution convolution;
+		convolution.setImpulse(impulse, maxBlockSize);
+		convolution.setNonRealtime(true);
+
+		expect(convolution.getNumStages() > 0, "Tail stages created");
+		expectEquals<int>(convolution.getNumWorkerStages(), convolution.getNumStages() - 1, "The first stage has no worker");
+
+		process(convolution, input, output);
+
+		const float maxError = getMaxError(input, impulse, output);
+
+		expect(maxError < 0.001f, "Maximum error: " + String(maxError));
+		expectEquals<int>(convolution.getNumMissedDeadlines(), 0, "No partition dropped");
+	}
+
+	void testFirstStageOnAudioThread()
+	{
+		beginTest("Testing that the first stage can't miss a deadline");
+
+		// The head ends at 512 samples, so this impulse only needs the first stage
+		const int impulseLength = 2000;
+		const int numSamples = 16384;
+		const int maxBlockSize = 64;
+
+		AudioSampleBuffer impulse(2, impulseLength);
+		fillWithDecayingNoise(impulse, 1000.0);
+
+		AudioSampleBuffer input(2, numSamples);
+		fillWithDecayingNoise(input, 1.0e9);
+
+		AudioSampleBuffer output(2, numSamples);
+
+		// This is a realtime render, so a worker would drop its partitions if it is too late
+		NonUniformConvolution convolution;
+		convolution.setImpulse(impulse, maxBlockSize);
+
+		expectEquals<int>(convolution.getNumStages(), 1, "One tail stage");
+		expectEquals<int>(convolution.getNumWorkerStages(), 0, "No worker thread");
+
+		process(convolution, input, output);
+
+		const float maxError = getMaxError(input, impulse, output);
+
+		expect(maxError < 0.001f, "Maximum error: " + String(maxError));
+		expectEquals<int>(convolution.getNumMissedDeadlines(), 0, "No partition dropped");
+	}
+
+	void testResetWithPendingJobs()
+	{
+		beginTest("Resetting the engine while the workers are busy");
+
+		const int impulseLength = 6000;
+		const int numSamples = 16384;
+		const int maxBlockSize = 64;
+
+		AudioSampleBuffer impulse(2, impulseLength);
+		fillWithDecayingNoise(impulse, 2000.0);
+
+		AudioSampleBuffer input(2, numSamples);
+		fillWithDecayingNoise(input, 1.0e9);
+
+		AudioSampleBuffer output(2, numSamples);
+
+		NonUniformConvolution convolution;
+		convolution.setImpulse(impulse, maxBlockSize);
+
+		// Stop at a partition boundary of every stage, so that the last jobs are still pending when the engine is reset
+		process(convolution, input, output);
+
+		convolution.reset();
+
+		// The old input must not leak into the output after the reset
+		convolution.setNonRealtime(true);
+		output.clear();
+
+		process(convolution, input, output);
+
+		const float maxError = getMaxError(input, impulse, output);
+
+		expect(maxError < 0.001f, "Maximum error after the reset: " + String(maxError));
+	}
+
+	/** Convolves the input with varying block sizes. */
+	static void process(NonUniformConvolution &convolution, AudioSampleBuffer &input, AudioSampleBuffer &output)
+	{
+		const int numSamples = input.getNumSamples();
+		const int blockSizes[] = { 64, 17, 64, 33, 1, 64, 50 };
+		int blockIndex = 0;
+
+		for (int pos = 0; pos < numSamples;)
+		{
+			const int numThisTime = jmin<int>(numSamples - pos, blockSizes[blockIndex++ % 7]);
+
+			float *in[2] = { input.getWritePointer(0, pos), input.getWritePointer(1, pos) };
+			float *out[2] = { output.getWritePointer(0, pos), output.getWritePointer(1, pos) };
+
+			convolution.process(in, out, numThisTime);
+
+			pos += numThisTime;
+		}
+	}
+
+	/** Compares the output with a direct convolution. */
+	static float getMaxError(const AudioSampleBuffer &input, const AudioSampleBuffer &impulse, const AudioSampleBuffer &output)
+	{
+		const int numSamples = input.getNumSamples();
+		const int impulseLength = impulse.getNumSamples();
+
+		float maxError = 0.0f;
+
+		for (int c = 0; c < 2; c++)
+		{
+			const float *x = input.getReadPointer(c);
+			const float *h = impulse.getReadPointer(c);
+			const float *y = output.getReadPointer(c);
+
+			for (int n = 0; n < numSamples; n++)
+			{
+				double expected = 0.0;
+
+				for (int k = jmax<int>(0, n - impulseLength + 1); k <= n; k++)
+					expected += (double)x[k] * (double)h[n - k];
+
+				maxError = jmax<float>(maxError, std::abs((float)expected - y[n]));
+			}
+		}
+
+		return maxError;
+	}
+
+	void testEngineSpeed()
+	{
+		beginTest("Measuring the audio thread time per block");
+
+		const double sampleRate = 44100.0;
+		const int blockSize = 64;
+		const int numBlocks = (int)(2.0 * sampleRate) / blockSize;
+
+		AudioSampleBuffer input(2, blockSize);
+		AudioSampleBuffer output(2, blockSize);
+
+		logMessage("Block size: " + String(blockSize) + ", " + String(numBlocks) + " blocks per measurement");
+
+		const int lengthsInSeconds[] = { 1, 2, 5, 10 };
+
+		for (int i = 0; i < 4; i++)
+		{
+			AudioSampleBuffer impulse(2, (int)(lengthsInSeconds[i] * sampleRate));
+			fillWithDecayingNoise(impulse, sampleRate * (double)lengthsInSeconds[i] / 6.0);
+
+			wdl::WDL_ImpulseBuffer wdlImpulse;
+			wdlImpulse.SetNumChannels(2);
+			wdlImpulse.SetLength(impulse.getNumSamples());
+			FloatVectorOperations::copy(wdlImpulse.impulses[0].Get(), impulse.getReadPointer(0), impulse.getNumSamples());
+			FloatVectorOperations::copy(wdlImpulse.impulses[1].Get(), impulse.getReadPointer(1), impulse.getNumSamples());
+
+			wdl::WDL_ConvolutionEngine_Div wdlEngine;
+			wdlEngine.SetImpulse(&wdlImpulse, 0, blockSize, 0, 0, blockSize);
+
+			NonUniformConvolution nonUniform;
+			nonUniform.setImpulse(impulse, blockSize);
+
+			double wdlTotal = 0.0, wdlMax = 0.0;
+			double nonUniformTotal = 0.0, nonUniformMax = 0.0;
+
+			for (int b = 0; b < numBlocks; b++)
+			{
+				fillWithDecayingNoise(input, 1.0e9);
+
+				float *in[2] = { input.getWritePointer(0), input.getWritePointer(1) };
+				float *out[2] = { output.getWritePointer(0), output.getWritePointer(1) };
+
+				double start = Time::getMillisecondCounterHiRes();
+
+				wdlEngine.Add(in, blockSize, 2);
+				wdlEngine.Advance(jmin(wdlEngine.Avail(blockSize), blockSize));
+
+				const double wdlTime = Time::getMillisecondCounterHiRes() - start;
+
+				start = Time::getMillisecondCounterHiRes();
+
+				nonUniform.process(in, out, blockSize);
+
+				const double nonUniformTime = Time::getMillisecondCounterHiRes() - start;
+
+				wdlTotal += wdlTime;
+				wdlMax = jmax(wdlMax, wdlTime);
+				nonUniformTotal += nonUniformTime;
+				nonUniformMax = jmax(nonUniformMax, nonUniformTime);
+			}
+
+			logMessage(String(lengthsInSeconds[i]) + " s impulse:");
+			logMessage("    WDL:         " + String(1000.0 * wdlTotal / (double)numBlocks, 1) + " us average, " + String(1000.0 * wdlMax, 1) + " us worst block");
+			logMessage("    Non uniform: " + String(1000.0 * nonUniformTotal / (double)numBlocks, 1) + " us average, " + String(1000.0 * nonUniformMax, 1) + " us worst block, " +
+					   String(nonUniform.getNumStages()) + " tail stages, " + String(nonUniform.getNumMissedDeadlines()) + " missed deadlines");
+		}
+	}
+
+	Random r;
+};
+
+static ConvolutionUnitTest convolutionUnitTest;
+
+/** Tests the handover of the engines between the impulse loader and the audio thread. */
+class ConvolutionEngineSwapUnitTest : public UnitTest
+{
+public:
+
+	ConvolutionEngineSwapUnitTest() :
+		UnitTest("Testing the convolution engine handover")
+	{
+
+	}
+
+	void runTest() override
+	{
+		testCrossfade();
+		testConcurrentHandover();
+	}
+
+private:
+
+	/** An engine that outputs a constant value and counts its instances. */
+	struct TestEngine
+	{
+		TestEngine(float value_, std::atomic<int> &numInstances_) :
+			value(value_),
+			numInstances(numInstances_)
+		{
+			numInstances++;
+		}
+
+		~TestEngine()
+		{
+			numInstances--;
+		}
+
+		const float value;
+		std::atomic<int> &numInstances;
+	};
+
+	typedef CrossfadingEngineSwapper<TestEngine> Swapper;
+
+	/** Renders a block of the current engine faded with the old engine into the buffer. */
+	static void renderBlock(Swapper &swapper, AudioSampleBuffer &output, AudioSampleBuffer &oldOutput)
+	{
+		const int numSamples = output.getNumSamples();
+
+		for (int c = 0; c < 2; c++)
+			FloatVectorOperations::fill(output.getWritePointer(c), swapper.getCurrentEngine()->value, numSamples);
+
+		if (swapper.isFading())
+		{
+			for (int c = 0; c < 2; c++)
+				FloatVectorOperations::fill(oldOutput.getWritePointer(c), swapper.getFadingEngine()->value, numSamples);
+
+			swapper.applyCrossfade(output.getWritePointer(0), output.getWritePointer(1), oldOutput.getReadPointer(0), oldOutput.getReadPointer(1), numSamples, numSamples);
+		}
+	}
+
+	void testCrossfade()
+	{
+		beginTest("Testing the crossfade between two engines");
+
+		const int numFadeSamples = 100;
+		const int blockSize = 32;
+
+		std::atomic<int> numInstances(0);
+
+		{
+			Swapper swapper;
+
+			AudioSampleBuffer output(2, blockSize);
+			AudioSampleBuffer oldOutput(2, blockSize);
+
+			swapper.postEngine(new TestEngine(1.0f, numInstances));
+
+			expect(swapper.hasPendingEngine(), "Engine is pending");
+			expect(!swapper.swapEngines(numFadeSamples), "Nothing retired");
+			expect(!swapper.hasPendingEngine(), "Engine was picked up");
+			expect(!swapper.isFading(), "The first engine is not faded in");
+
+			swapper.postEngine(new TestEngine(2.0f, numInstances));
+			swapper.swapEngines(numFadeSamples);
+
+			expectEquals<float>(swapper.getCurrentEngine()->value, 2.0f, "New engine");
+			expect(swapper.isFading(), "Fading");
+
+			int sampleIndex = 0;
+
+			while (swapper.isFading())
+			{
+				renderBlock(swapper, output, oldOutput);
+
+				for (int i = 0; i < blockSize; i++)
+				{
+					const float expected = 1.0f + jmin<float>(1.0f, (float)(sampleIndex + i) / (float)numFadeSamples);
+
+					expectWithinAbsoluteError<float>(output.getSample(0, i), expected, 0.0001f);
+					expectWithinAbsoluteError<float>(output.getSample(1, i), expected, 0.0001f);
+				}
+
+				sampleIndex += blockSize;
+
+				if (swapper.swapEngines(numFadeSamples))
+					expect(sampleIndex >= numFadeSamples, "Retired after the fade");
+			}
+
+			expect(sampleIndex >= numFadeSamples, "The fade took " + String(numFadeSamples) + " samples");
+
+			// The old engine is passed back after its fade and deleted on the loader thread
+			swapper.swapEngines(numFadeSamples);
+			expect(swapper.getFadingEngine() == nullptr, "Old engine was passed back");
+			expectEquals<int>(numInstances.load(), 2, "The audio thread doesn't delete engines");
+
+			swapper.deleteRetiredEngine();
+			expectEquals<int>(numInstances.load(), 1, "Retired engine deleted");
+
+			renderBlock(swapper, output, oldOutput);
+			expectEquals<float>(output.getSample(0, 0), 2.0f, "Output after the fade");
+		}
+
+		expectEquals<int>(numInstances.load(), 0, "All engines deleted");
+	}
+
+	/** Posts new engines and deletes the retired ones like the impulse loader. */
+	class LoaderThread : public Thread
+	{
+	public:
+
+		LoaderThread(Swapper &swapper_, std::atomic<int> &numInstances_, int numEngines_) :
+			Thread("Test Loader"),
+			swapper(swapper_),
+			numInstances(numInstances_),
+			numEngines(numEngines_)
+		{};
+
+		void run() override
+		{
+			for (int i = 1; i <= numEngines; i++)
+			{
+				swapper.deleteRetiredEngine();
+				swapper.postEngine(new TestEngine((float)i, numInstances));
+
+				Thread::sleep(i % 3);
+			}
+		}
+
+		Swapper &swapper;
+		std::atomic<int> &numInstances;
+		const int numEngines;
+	};
+
+	void testConcurrentHandover()
+	{
+		beginTest("Testing the handover while the loader posts new engines");
+
+		const int numEngines = 300;
+		const int blockSize = 16;
+
+		std::atomic<int> numInstances(0);
+
+		{
+			Swapper swapper;
+
+			AudioSampleBuffer output(2, blockSize);
+			AudioSampleBuffer oldOutput(2, blockSize);
+
+			LoaderThread loader(swapper, numInstances, numEngines);
+
+			loader.startThread();
+
+			float lastValue = 0.0f;
+			int numSwaps = 0;
+			bool engineOrderOk = true;
+			bool crossfadeRangeOk = true;
+
+			while (loader.isThreadRunning() || swapper.hasPendingEngine() || swapper.isFading())
+			{
+				swapper.swapEngines(24);
+
+				if (TestEngine *e = swapper.getCurrentEngine())
+				{
+					if (e->value != lastValue)
+					{
+						engineOrderOk &= e->value > lastValue;
+						lastValue = e->value;
+						numSwaps++;
+					}
+
+					// The output must always be between the values of the old and the new engine
+					const float oldValue = swapper.isFading() ? swapper.getFadingEngine()->value : e->value;
+					const float minValue = jmin<float>(e->value, oldValue) - 0.001f;
+					const float maxValue = jmax<float>(e->value, oldValue) + 0.001f;
+
+					renderBlock(swapper, output, oldOutput);
+
+					for (int i = 0; i < blockSize; i++)
+						crossfadeRangeOk &= output.getSample(0, i) >= minValue && output.getSample(0, i) <= maxValue;
+				}
+
+				Thread::yield();
+			}
+
+			expect(engineOrderOk, "Engines are picked up in the order they were posted");
+			expect(crossfadeRangeOk, "The crossfade stays between the old and the new value");
+			expectEquals<float>(lastValue, (float)numEngines, "The last engine is used");
+			expect(numSwaps > 1, "Engines were swapped");
+
+			// At most the current, the fading and a retired engine are alive
+			expect(numInstances.load() <= 3, "Engines are deleted: " + String(numInstances.load()));
+		}
+
+		expectEquals<int>(numInstances.load(), 0, "All engines deleted");
+	}
+};
+
+static ConvolutionEngineSwapUnitTest convolutionEngineSwapUnitTest;
@@ -0,0 +1,553 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licences for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licencing:
+*
+*   http://www.hartinstruments.net/hise/
+*
+*   HISE is based on the JUCE library,
+*   which also must be licenced for commercial applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+/** Calculates the jobs of a single stage.
+*
+*	Every stage has its own thread, so the long FFTs of the big stages can't delay the jobs of the small stages,
+*	which have the earlier deadlines.
+*/
+class NonUniformConvolution::StageWorker : public Thread
+{
+public:
+
+	StageWorker(Stage &stage_, int stageIndex) :
+		Thread("Convolution Tail Stage " + String(stageIndex + 1)),
+		stage(stage_)
+	{};
+
+	void run() override;
+
+	/** Wakes up the thread. This doesn't lock, so it can be called from the audio thread. */
+	void wakeUpWorker() noexcept { wakeUp.signal(); }
+
+private:
+
+	Stage &stage;
+
+	// The worker is the only thread that waits on this semaphore
+	moodycamel::spsc_sema::LightweightSemaphore wakeUp;
+};
+
+class NonUniformConvolution::Stage
+{
+public:
+
+	enum
+	{
+		NumJobs = 4
+	};
+
+	enum JobState
+	{
+		Free = 0, ///< the audio thread can fill the job with the next partition
+		Pending, ///< the job waits for the worker
+		Running, ///< the worker calculates the job
+		Done, ///< the output is ready (and used by the audio thread until the next partition)
+		Abandoned ///< the audio thread didn't wait for the job, so the worker only adds the input to its spectra
+	};
+
+	/** A partition of the input and its output. The audio thread and the worker pass it back and forth through the state. */
+	struct Job
+	{
+		Job(int partitionSize) :
+			input(2, 2 * partitionSize),
+			output(2, partitionSize),
+			state(Free),
+			sequence(0),
+			generation(0)
+		{};
+
+		AudioSampleBuffer input;
+		AudioSampleBuffer output;
+
+		std::atomic<int> state;
+
+		// These are written by the audio thread before the job is released to the worker
+		int64 sequence;
+		int generation;
+	};
+
+	Stage(const AudioSampleBuffer &impulse, int offset, int length, int partitionSize_) :
+		partitionSize(partitionSize_),
+		fftSize(2 * partitionSize_),
+		numPartitions((length + partitionSize_ - 1) / partitionSize_),
+		numImpulseChannels(impulse.getNumChannels()),
+		inputBlock(2, partitionSize_),
+		previousBlock(2, partitionSize_),
+		activeJob(nullptr),
+		lastJob(nullptr),
+		writeIndex(0),
+		sequence(0),
+		generation(0),
+		readIndex(0),
+		nextSequence(0),
+		workerGeneration(-1),
+		spectrumPosition(0)
+	{
+		impulseSpectra.calloc(numImpulseChannels * numPartitions * fftSize);
+		inputSpectra.calloc(2 * numPartitions * fftSize);
+		accumulator.calloc(fftSize);
+
+		for (int i = 0; i < NumJobs; i++)
+			jobs.add(new Job(partitionSize));
+
+		// The inverse FFT is not normalised, so the scaling is applied to the impulse spectra
+		const float scale = 1.0f / (float)fftSize;
+
+		for (int c = 0; c < numImpulseChannels; c++)
+		{
+			for (int p = 0; p < numPartitions; p++)
+			{
+				wdl::WDL_FFT_COMPLEX *spectrum = getImpulseSpectrum(c, p);
+
+				const int start = offset + p * partitionSize;
+				const int numToCopy = jmin<int>(partitionSize, offset + length - start);
+				const float *data = impulse.getReadPointer(c, start);
+
+				for (int i = 0; i < numToCopy; i++)
+					spectrum[i].re = data[i] * scale;
+
+				wdl::WDL_fft(spectrum, fftSize, 0);
+			}
+		}
+
+		reset();
+	}
+
+	~Stage()
+	{
+		if (worker != nullptr)
+		{
+			worker->signalThreadShouldExit();
+			worker->wakeUpWorker();
+			worker->stopThread(1000);
+		}
+
+		worker = nullptr;
+	}
+
+	void startWorker(int stageIndex, int priority)
+	{
+		worker = new StageWorker(*this, stageIndex);
+		worker->startThread(priority);
+	}
+
+	int getPartitionSize() const noexcept { return partitionSize; }
+
+	/** A stage without a worker calculates its jobs on the audio thread when they are submitted, so it never misses a deadline. */
+	bool isCalculatedOnAudioThread() const noexcept { return worker == nullptr; }
+
+	/** Clears the state of the audio thread. This doesn't wait for the worker: the jobs are abandoned and the worker
+	*	clears its spectra when it gets the first job of the new generation.
+	*/
+	void reset()
+	{
+		generation++;
+
+		for (int i = 0; i < NumJobs; i++)
+		{
+			std::atomic<int> &state = jobs[i]->state;
+
+			int s = state.load(std::memory_order_acquire);
+
+			while (s == Pending || s == Running)
+			{
+				if (state.compare_exchange_weak(s, Abandoned, std::memory_order_acq_rel))
+					break;
+			}
+
+			if (s == Done)
+				state.store(Free, std::memory_order_release);
+		}
+
+		activeJob = nullptr;
+		lastJob = nullptr;
+
+		inputBlock.clear();
+		previousBlock.clear();
+
+		position = 0;
+	}
+
+	/** Writes the input into the current partition and adds the output of the active job. */
+	void process(float **input, float **output, int numSamples, NonUniformConvolution &parent)
+	{
+		int offset = 0;
+
+		while (offset < numSamples)
+		{
+			const int numThisTime = jmin<int>(numSamples - offset, partitionSize - position);
+
+			for (int c = 0; c < 2; c++)
+			{
+				FloatVectorOperations::copy(inputBlock.getWritePointer(c, position), input[c] + offset, numThisTime);
+
+				if (activeJob != nullptr)
+					FloatVectorOperations::add(output[c] + offset, activeJob->output.getReadPointer(c, position), numThisTime);
+			}
+
+			offset += numThisTime;
+			position += numThisTime;
+
+			if (position == partitionSize)
+			{
+				activateLastJob(parent);
+				submitJob(parent);
+				position = 0;
+			}
+		}
+	}
+
+	/** Called by the worker thread. Returns true if a job was processed. */
+	bool runNextJob()
+	{
+		Job &job = *jobs[readIndex];
+
+		int expected = Pending;
+		const bool outputIsNeeded = job.state.compare_exchange_strong(expected, Running, std::memory_order_acquire);
+
+		if (!outputIsNeeded && expected != Abandoned)
+			return false;
+
+		if (job.generation != workerGeneration)
+		{
+			// The stage was reset, so the spectra of the old input are cleared
+			zeromem(inputSpectra.getData(), sizeof(wdl::WDL_FFT_COMPLEX) * 2 * numPartitions * fftSize);
+
+			workerGeneration = job.generation;
+			nextSequence = job.sequence;
+		}
+
+		// The partitions that the audio thread had to skip are silent
+		const int numSkipped = (int)jmin<int64>(numPartitions, job.sequence - nextSequence);
+
+		for (int i = 0; i < numSkipped; i++)
+		{
+			spectrumPosition = (spectrumPosition + numPartitions - 1) % numPartitions;
+
+			for (int c = 0; c < 2; c++)
+				zeromem(getInputSpectrum(c, spectrumPosition), sizeof(wdl::WDL_FFT_COMPLEX) * fftSize);
+		}
+
+		nextSequence = job.sequence + 1;
+
+		runJob(job, outputIsNeeded);
+
+		int running = Running;
+
+		if (!outputIsNeeded || !job.state.compare_exchange_strong(running, Done, std::memory_order_acq_rel))
+		{
+			// Nobody waits for this job anymore
+			job.state.store(Free, std::memory_order_release);
+		}
+
+		readIndex = (readIndex + 1) % NumJobs;
+
+		jobFinished.signal();
+
+		return true;
+	}
+
+private:
+
+	/** Uses the output of the job that was submitted one partition ago for the next partition. */
+	void activateLastJob(NonUniformConvolution &parent)
+	{
+		if (activeJob != nullptr)
+			activeJob->state.store(Free, std::memory_order_release);
+
+		activeJob = nullptr;
+
+		if (lastJob == nullptr)
+			return;
+
+		Job &job = *lastJob;
+		lastJob = nullptr;
+
+		if (parent.nonRealtime)
+		{
+			while (job.state.load(std::memory_order_acquire) != Done)
+				jobFinished.wait();
+		}
+
+		int s = job.state.load(std::memory_order_acquire);
+
+		while (s != Done)
+		{
+			// The worker is too late, so the output of this partition is dropped instead of waiting for it
+			if (job.state.compare_exchange_weak(s, Abandoned, std::memory_order_acq_rel))
+			{
+				parent.numMissedDeadlines.fetch_add(1);
+				return;
+			}
+		}
+
+		activeJob = &job;
+	}
+
+	void submitJob(NonUniformConvolution &parent)
+	{
+		Job &job = *jobs[writeIndex];
+
+		if (parent.nonRealtime)
+		{
+			while (job.state.load(std::memory_order_acquire) != Free)
+				jobFinished.wait();
+		}
+
+		if (job.state.load(std::memory_order_acquire) == Free)
+		{
+			for (int c = 0; c < 2; c++)
+			{
+				job.input.copyFrom(c, 0, previousBlock, c, 0, partitionSize);
+				job.input.copyFrom(c, partitionSize, inputBlock, c, 0, partitionSize);
+			}
+
+			job.sequence = sequence;
+			job.generation = generation;
+			job.state.store(Pending, std::memory_order_release);
+
+			if (isCalculatedOnAudioThread())
+				runNextJob();
+			else
+				worker->wakeUpWorker();
+
+			lastJob = &job;
+			writeIndex = (writeIndex + 1) % NumJobs;
+		}
+		else
+		{
+			// The worker is more than a few partitions behind, so this partition is skipped
+			parent.numMissedDeadlines.fetch_add(1);
+		}
+
+		for (int c = 0; c < 2; c++)
+			previousBlock.copyFrom(c, 0, inputBlock, c, 0, partitionSize);
+
+		sequence++;
+	}
+
+	/** Adds the input spectrum of the job to the delay line and calculates the output if it is still needed. */
+	void runJob(Job &job, bool calculateOutput)
+	{
+		spectrumPosition = (spectrumPosition + numPartitions - 1) % numPartitions;
+
+		for (int c = 0; c < 2; c++)
+		{
+			wdl::WDL_FFT_COMPLEX *newSpectrum = getInputSpectrum(c, spectrumPosition);
+			const float *data = job.input.getReadPointer(c);
+
+			for (int i = 0; i < fftSize; i++)
+			{
+				newSpectrum[i].re = data[i];
+				newSpectrum[i].im = 0.0f;
+			}
+
+			wdl::WDL_fft(newSpectrum, fftSize, 0);
+
+			if (!calculateOutput)
+				continue;
+
+			zeromem(accumulator.getData(), sizeof(wdl::WDL_FFT_COMPLEX) * fftSize);
+
+			const int impulseChannel = jmin<int>(c, numImpulseChannels - 1);
+
+			for (int p = 0; p < numPartitions; p++)
+			{
+				wdl::WDL_FFT_COMPLEX *x = getInputSpectrum(c, (spectrumPosition + p) % numPartitions);
+				wdl::WDL_fft_complexmul3(accumulator.getData(), x, getImpulseSpectrum(impulseChannel, p), fftSize);
+			}
+
+			wdl::WDL_fft(accumulator.getData(), fftSize, 1);
+
+			// Overlap-save: the second half is the valid output of this partition
+			float *out = job.output.getWritePointer(c);
+
+			for (int i = 0; i < partitionSize; i++)
+				out[i] = accumulator[partitionSize + i].re;
+		}
+	}
+
+	wdl::WDL_FFT_COMPLEX *getImpulseSpectrum(int channel, int partition) { return impulseSpectra + (channel * numPartitions + partition) * fftSize; }
+	wdl::WDL_FFT_COMPLEX *getInputSpectrum(int channel, int partition) { return inputSpectra + (channel * numPartitions + partition) * fftSize; }
+
+	const int partitionSize;
+	const int fftSize;
+	const int numPartitions;
+	const int numImpulseChannels;
+
+	HeapBlock<wdl::WDL_FFT_COMPLEX> impulseSpectra;
+
+	OwnedArray<Job> jobs;
+
+	// The audio thread is the only thread that waits on this semaphore (and only when rendering offline)
+	moodycamel::spsc_sema::LightweightSemaphore jobFinished;
+
+	// ============================================================================================= audio thread
+
+	AudioSampleBuffer inputBlock;
+	AudioSampleBuffer previousBlock;
+
+	Job *activeJob;
+	Job *lastJob;
+
+	int position;
+	int writeIndex;
+	int64 sequence;
+	int generation;
+
+	// ============================================================================================= worker thread
+
+	HeapBlock<wdl::WDL_FFT_COMPLEX> inputSpectra;
+	HeapBlock<wdl::WDL_FFT_COMPLEX> accumulator;
+
+	int readIndex;
+	int64 nextSequence;
+	int workerGeneration;
+	int spectrumPosition;
+
+	ScopedPointer<StageWorker> worker;
+};
+
+void NonUniformConvolution::StageWorker::run()
+{
+	while (!threadShouldExit())
+	{
+		if (!stage.runNextJob())
+			wakeUp.wait();
+	}
+}
+
+NonUniformConvolution::NonUniformConvolution() :
+	headLength(0),
+	nonRealtime(false),
+	numMissedDeadlines(0)
+{
+	wdl::WDL_fft_init();
+}
+
+NonUniformConvolution::~NonUniformConvolution()
+{
+	stages.clear();
+}
+
+void NonUniformConvolution::setImpulse(const AudioSampleBuffer &impulse, int maxBlockSize)
+{
+	stages.clear();
+
+	const int impulseLength = impulse.getNumSamples();
+	const int numChannels = jlimit<int>(1, 2, impulse.getNumChannels());
+
+	const int blockSize = jmax<int>(MinBlockSize, nextPowerOfTwo(maxBlockSize));
+	int partitionSize = jmin<int>(MaxPartitionSize, blockSize * PartitionSizeFactor);
+
+	headLength = jmin<int>(impulseLength, 2 * partitionSize);
+
+	headImpulse.SetNumChannels(numChannels);
+	headImpulse.SetLength(headLength);
+
+	for (int c = 0; c < numChannels; c++)
+		FloatVectorOperations::copy(headImpulse.impulses[c].Get(), impulse.getReadPointer(c), headLength);
+
+	head.SetImpulse(&headImpulse, 0, maxBlockSize, 0, 0, 0);
+
+	int offset = headLength;
+
+	while (offset < impulseLength)
+	{
+		jassert(offset == 2 * partitionSize);
+
+		const bool isLastStage = partitionSize == MaxPartitionSize;
+		const int stageEnd = isLastStage ? impulseLength : jmin<int>(impulseLength, 2 * partitionSize * PartitionSizeFactor);
+
+		stages.add(new Stage(impulse, offset, stageEnd - offset, partitionSize));
+
+		offset = stageEnd;
+		partitionSize *= PartitionSizeFactor;
+	}
+
+	for (int i = 0; i < stages.size(); i++)
+	{
+		// The first stage has the earliest deadline and the smallest FFT, so it is calculated on the audio thread
+		// unless it is the last stage, which can have any number of partitions.
+		const bool isLastStage = i == stages.size() - 1 && stages[i]->getPartitionSize() == MaxPartitionSize;
+
+		if (i == 0 && !isLastStage)
+			continue;
+
+		// The smaller stages have the earlier deadlines, so their workers get a higher priority
+		stages[i]->startWorker(i, jmax<int>(5, 9 - i));
+	}
+}
+
+int NonUniformConvolution::getNumWorkerStages() const noexcept
+{
+	int numWorkerStages = 0;
+
+	for (int i = 0; i < stages.size(); i++)
+	{
+		if (!stages[i]->isCalculatedOnAudioThread())
+			numWorkerStages++;
+	}
+
+	return numWorkerStages;
+}
+
+void NonUniformConvolution::reset()
+{
+	head.Reset();
+
+	for (int i = 0; i < stages.size(); i++)
+		stages[i]->reset();
+}
+
+void NonUniformConvolution::process(float **input, float **output, int numSamples)
+{
+	head.Add(input, numSamples, 2);
+
+	const int availableSamples = jmin(head.Avail(numSamples), numSamples);
+
+	for (int c = 0; c < 2; c++)
+	{
+		if (availableSamples > 0)
+			FloatVectorOperations::copy(output[c], head.Get()[c], availableSamples);
+
+		if (availableSamples < numSamples)
+			FloatVectorOperations::clear(output[c] + availableSamples, numSamples - availableSamples);
+	}
+
+	if (availableSamples > 0)
+		head.Advance(availableSamples);
+
+	for (int i = 0; i < stages.size(); i++)
+		stages[i]->process(input, output, numSamples, *this);
+}
@@ -0,0 +1,106 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licences for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licencing:
+*
+*   http://www.hartinstruments.net/hise/
+*
+*   HISE is based on the JUCE library,
+*   which also must be licenced for commercial applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+#ifndef NONUNIFORMCONVOLUTION_H_INCLUDED
+#define NONUNIFORMCONVOLUTION_H_INCLUDED
+
+/** A zero latency convolution engine that processes the tail of the impulse response on a worker thread.
+*
+*	The head of the impulse response is convolved on the audio thread by a WDL engine with small partitions. The tail
+*	is split into stages with uniform partitions whose size grows by a factor of four from stage to stage. Each stage
+*	starts at twice its partition size, so a partition that was collected on the audio thread has to be finished
+*	one partition later. The first stage has the earliest deadline and the smallest FFT, so it is calculated on the
+*	audio thread when its partition is complete and can't be late. Every other stage has its own worker thread, and the
+*	smaller stages run at a higher priority. The audio thread never waits for a worker: if a job is not finished in
+*	time, its output is dropped (see getNumMissedDeadlines()). An offline render can call setNonRealtime() to wait
+*	for the workers instead, so the output is always complete.
+*
+*	This is used by the ConvolutionEffect if the EngineType is set to NonUniform.
+*/
+class NonUniformConvolution
+{
+public:
+
+	enum
+	{
+		MinBlockSize = 64,
+		MaxPartitionSize = 16384,
+		PartitionSizeFactor = 4
+	};
+
+	NonUniformConvolution();
+
+	~NonUniformConvolution();
+
+	/** Partitions the impulse response. This allocates memory and calculates the FFTs, so call it on a background thread. */
+	void setImpulse(const AudioSampleBuffer &impulse, int maxBlockSize);
+
+	/** Clears the internal state. */
+	void reset();
+
+	/** Convolves the stereo input and writes the result into the output channels. */
+	void process(float **input, float **output, int numSamples);
+
+	/** If this is enabled, the audio thread waits for the tail jobs instead of dropping them when they are late. */
+	void setNonRealtime(bool shouldWaitForTail) noexcept { nonRealtime = shouldWaitForTail; }
+
+	/** Returns the number of samples that are convolved on the audio thread. */
+	int getHeadLength() const noexcept { return headLength; }
+
+	int getNumStages() const noexcept { return stages.size(); }
+
+	/** Returns the number of tail partitions that were dropped because the worker was too late. */
+	int getNumMissedDeadlines() const noexcept { return numMissedDeadlines.load(); }
+
+	/** Returns the number of stages that are calculated on a worker thread. */
+	int getNumWorkerStages() const noexcept;
+
+private:
+
+	class Stage;
+	class StageWorker;
+
+	wdl::WDL_ImpulseBuffer headImpulse;
+	wdl::WDL_ConvolutionEngine_Div head;
+
+	int headLength;
+
+	OwnedArray<Stage> stages;
+
+	bool nonRealtime;
+
+	std::atomic<int> numMissedDeadlines;
+
+	JUCE_DECLARE_NON_COPYABLE(NonUniformConvolution)
+};
+
+#endif  // NONUNIFORMCONVOLUTION_H_INCLUDED
@@ -30,6 +30,247 @@
 *   ===========================================================================
 */
 
+StereoBiquadCascade::Coefficients::Coefficients() :
+	b0(1.0),
+	b1(0.0),
+	b2(0.0),
+	a1(0.0),
+	a2(0.0)
+{
+}
+
+StereoBiquadCascade::Coefficients::Coefficients(const IIRCoefficients &c) :
+	b0((double)c.coefficients[0]),
+	b1((double)c.coefficients[1]),
+	b2((double)c.coefficients[2]),
+	a1((double)c.coefficients[3]),
+	a2((double)c.coefficients[4])
+{
+}
+
+StereoBiquadCascade::Section::Section() :
+	initialised(false),
+	ramping(false)
+{
+	const Coefficients unity;
+
+	setTargetCoefficients(unity, true);
+	reset();
+
+	// The first real coefficients are used without a ramp.
+	initialised = false;
+}
+
+void StereoBiquadCascade::Section::setTargetCoefficients(const Coefficients &target, bool jumpToTarget) noexcept
+{
+	targets[B0] = target.b0;
+	targets[B1] = target.b1;
+	targets[B2] = target.b2;
+	targets[A1] = target.a1;
+	targets[A2] = target.a2;
+
+	if (jumpToTarget || !initialised)
+	{
+		endRamp();
+		initialised = true;
+	}
+	else
+	{
+		ramping = true;
+	}
+}
+
+void StereoBiquadCascade::Section::reset() noexcept
+{
+	state1[0] = state1[1] = 0.0;
+	state2[0] = state2[1] = 0.0;
+}
+
+void StereoBiquadCascade::Section::startRamp(int numSamples) noexcept
+{
+	const double factor = 1.0 / (double)jmax<int>(1, numSamples);
+
+	for (int i = 0; i < numCoefficients; i++)
+	{
+		const double delta = (targets[i] - coefficients[i][0]) * factor;
+
+		deltas[i][0] = delta;
+		deltas[i][1] = delta;
+	}
+}
+
+void StereoBiquadCascade::Section::endRamp() noexcept
+{
+	// Use the exact target values so that the rounding errors of the ramp don't add up.
+	for (int i = 0; i < numCoefficients; i++)
+	{
+		coefficients[i][0] = targets[i];
+		coefficients[i][1] = targets[i];
+		deltas[i][0] = 0.0;
+		deltas[i][1] = 0.0;
+	}
+
+	ramping = false;
+}
+
+void StereoBiquadCascade::process(Section **sections, int numSections, float *left, float *right, int numSamples) noexcept
+{
+	if (numSections == 0 || numSamples <= 0)
+		return;
+
+	bool anyRamping = false;
+
+	for (int i = 0; i < numSections; i++)
+	{
+		if (sections[i]->ramping)
+		{
+			sections[i]->startRamp(numSamples);
+			anyRamping = true;
+		}
+	}
+
+	if (anyRamping)
+	{
+		processInternal<true>(sections, numSections, left, right, numSamples);
+
+		for (int i = 0; i < numSections; i++)
+		{
+			if (sections[i]->ramping)
+				sections[i]->endRamp();
+		}
+	}
+	else
+	{
+		processInternal<false>(sections, numSections, left, right, numSamples);
+	}
+}
+
+template <bool Ramping> void StereoBiquadCascade::processInternal(Section **sections, int numSections, float *left, float *right, int numSamples) noexcept
+{
+	// The samples are processed in chunks, so that every section can keep its coefficients and state in registers
+	// while it runs over the chunk.
+	enum { ChunkSize = 64 };
+
+	double frames[ChunkSize * 2];
+
+	while (numSamples > 0)
+	{
+		const int numThisTime = jmin<int>(ChunkSize, numSamples);
+
+		for (int i = 0; i < numThisTime; i++)
+		{
+			frames[2 * i] = (double)left[i];
+			frames[2 * i + 1] = (double)right[i];
+		}
+
+		for (int j = 0; j < numSections; j++)
+		{
+			Section &s = *sections[j];
+
+#if HI_SAMPLER_USE_SSE
+
+			__m128d b0 = _mm_loadu_pd(s.coefficients[Section::B0]);
+			__m128d b1 = _mm_loadu_pd(s.coefficients[Section::B1]);
+			__m128d b2 = _mm_loadu_pd(s.coefficients[Section::B2]);
+			__m128d a1 = _mm_loadu_pd(s.coefficients[Section::A1]);
+			__m128d a2 = _mm_loadu_pd(s.coefficients[Section::A2]);
+
+			__m128d s1 = _mm_loadu_pd(s.state1);
+			__m128d s2 = _mm_loadu_pd(s.state2);
+
+			for (int i = 0; i < numThisTime; i++)
+			{
+				const __m128d x = _mm_loadu_pd(frames + 2 * i);
+				const __m128d y = _mm_add_pd(_mm_mul_pd(b0, x), s1);
+
+				s1 = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(b1, x), _mm_mul_pd(a1, y)), s2);
+				s2 = _mm_sub_pd(_mm_mul_pd(b2, x), _mm_mul_pd(a2, y));
+
+				_mm_storeu_pd(frames + 2 * i, y);
+
+				if (Ramping)
+				{
+					b0 = _mm_add_pd(b0, _mm_loadu_pd(s.deltas[Section::B0]));
+					b1 = _mm_add_pd(b1, _mm_loadu_pd(s.deltas[Section::B1]));
+					b2 = _mm_add_pd(b2, _mm_loadu_pd(s.deltas[Section::B2]));
+					a1 = _mm_add_pd(a1, _mm_loadu_pd(s.deltas[Section::A1]));
+					a2 = _mm_add_pd(a2, _mm_loadu_pd(s.deltas[Section::A2]));
+				}
+			}
+
+			_mm_storeu_pd(s.state1, s1);
+			_mm_storeu_pd(s.state2, s2);
+
+			if (Ramping)
+			{
+				_mm_storeu_pd(s.coefficients[Section::B0], b0);
+				_mm_storeu_pd(s.coefficients[Section::B1], b1);
+				_mm_storeu_pd(s.coefficients[Section::B2], b2);
+				_mm_storeu_pd(s.coefficients[Section::A1], a1);
+				_mm_storeu_pd(s.coefficients[Section::A2], a2);
+			}
+
+#else
+
+			for (int k = 0; k < 2; k++)
+			{
+				double b0 = s.coefficients[Section::B0][k];
+				double b1 = s.coefficients[Section::B1][k];
+				double b2 = s.coefficients[Section::B2][k];
+				double a1 = s.coefficients[Section::A1][k];
+				double a2 = s.coefficients[Section::A2][k];
+
+				double s1 = s.state1[k];
+				double s2 = s.state2[k];
+
+				for (int i = 0; i < numThisTime; i++)
+				{
+					const double x = frames[2 * i + k];
+					const double y = b0 * x + s1;
+
+					s1 = b1 * x - a1 * y + s2;
+					s2 = b2 * x - a2 * y;
+
+					frames[2 * i + k] = y;
+
+					if (Ramping)
+					{
+						b0 += s.deltas[Section::B0][k];
+						b1 += s.deltas[Section::B1][k];
+						b2 += s.deltas[Section::B2][k];
+						a1 += s.deltas[Section::A1][k];
+						a2 += s.deltas[Section::A2][k];
+					}
+				}
+
+				s.state1[k] = s1;
+				s.state2[k] = s2;
+
+				if (Ramping)
+				{
+					s.coefficients[Section::B0][k] = b0;
+					s.coefficients[Section::B1][k] = b1;
+					s.coefficients[Section::B2][k] = b2;
+					s.coefficients[Section::A1][k] = a1;
+					s.coefficients[Section::A2][k] = a2;
+				}
+			}
+
+#endif
+		}
+
+		for (int i = 0; i < numThisTime; i++)
+		{
+			left[i] = (float)frames[2 * i];
+			right[i] = (float)frames[2 * i + 1];
+		}
+
+		left += numThisTime;
+		right += numThisTime;
+		numSamples -= numThisTime;
+	}
+}
+
 float CurveEq::getAttribute(int index) const
 {
 	if(index == -1) return 0.0f;
@@ -56,7 +297,7 @@ float CurveEq::getAttribute(int index) const
 	}
 	else
 	{
-		debugError(const_cast<CurveEq*>(this), "Invalid attribute index: " + String(index));
+		const_cast<MainController*>(getMainController())->writeFormattedToConsole("Invalid attribute index: %0", 1, this, index);
 		return 0.0f;
 	}
 
@@ -91,7 +332,7 @@ void CurveEq::setInternalAttribute(int index, float newValue)
 	}
 	else
 	{
-		debugError(this, "Invalid attribute index: " + String(index));
+		getMainController()->writeFormattedToConsole("Invalid attribute index: %0", 1, this, index);
 	}
 }
 
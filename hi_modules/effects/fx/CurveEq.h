@@ -36,6 +36,81 @@
 
 #define FFT_SIZE_FOR_EQ 4096
 
+/** A cascade of biquad sections that processes the left and right channel together.
+*
+*	Every section is a transposed direct form II biquad in double precision. The two channels are the two lanes
+*	of a SSE2 register (if HI_SAMPLER_USE_SSE is enabled). The signal is processed in small chunks, and every
+*	section runs over the whole chunk with its coefficients and state in registers.
+*
+*	If the coefficients of a section change, they are interpolated linearly over the next block. This is stable
+*	because the feedback coefficients of two stable sections always enclose only stable sections.
+*/
+class StereoBiquadCascade
+{
+public:
+
+	/** The normalised coefficients of a biquad section. */
+	struct Coefficients
+	{
+		Coefficients();
+
+		Coefficients(const IIRCoefficients &c);
+
+		double b0, b1, b2, a1, a2;
+	};
+
+	/** The coefficients and the state of one section. Every value is stored for the left and the right channel. */
+	class Section
+	{
+	public:
+
+		Section();
+
+		/** Sets the coefficients that are used after the next block. If there were no coefficients before, or
+		*	jumpToTarget is true, they are used right away.
+		*/
+		void setTargetCoefficients(const Coefficients &target, bool jumpToTarget) noexcept;
+
+		/** Clears the filter state. */
+		void reset() noexcept;
+
+	private:
+
+		friend class StereoBiquadCascade;
+
+		enum CoefficientIndex
+		{
+			B0 = 0,
+			B1,
+			B2,
+			A1,
+			A2,
+			numCoefficients
+		};
+
+		void startRamp(int numSamples) noexcept;
+
+		void endRamp() noexcept;
+
+		double coefficients[numCoefficients][2];
+		double deltas[numCoefficients][2];
+		double targets[numCoefficients];
+
+		double state1[2];
+		double state2[2];
+
+		bool initialised;
+		bool ramping;
+	};
+
+	/** Runs the stereo signal through the sections in place. */
+	static void process(Section **sections, int numSections, float *left, float *right, int numSamples) noexcept;
+
+private:
+
+	template <bool Ramping> static void processInternal(Section **sections, int numSections, float *left, float *right, int numSamples) noexcept;
+};
+
 /** A parametriq equalizer with unlimited bands and FFT display. 
 *	@ingroup effectTypes
 *
@@ -73,6 +148,7 @@ public:
 		numBandParameters
 	};
 
+	/** The parameters of a band. They can be changed from any thread while the audio thread processes the band. */
 	class StereoFilter
 	{
 	public:
@@ -80,127 +156,125 @@ public:
 		StereoFilter():
 			sampleRate(44100.0),
 			frequency(1000.0),
-			gain(1.0),
+			gain(1.0f),
 			q(1.0),
 			type(Peak),
-			enabled(true)
+			enabled(true),
+			version(1),
+			processedVersion(0),
+			resetPending(false)
 		{
-			updateCoefficients();
 		};
 
 		void setEnabled(bool shouldBeEnabled)
 		{
-			SpinLock::ScopedLockType sl(processLock);
-
-			enabled = shouldBeEnabled;
+			enabled.store(shouldBeEnabled);
 		}
 
 		bool isEnabled() const
 		{
-			return enabled;
+			return enabled.load();
 		}
 
 		void setType(int newType)
 		{
-			SpinLock::ScopedLockType sl(processLock);
-
-			type = (FilterType)newType;
-			updateCoefficients();
+			type.store(newType);
+			++version;
 		}
 
-		double getFrequency() const {return frequency; };
+		double getFrequency() const {return frequency.load(); };
 
-		double getGain() const {return (double)gain; };
+		double getGain() const {return (double)gain.load(); };
 
-		double getQ() const { return q; };
+		double getQ() const { return q.load(); };
 
 		void setFrequency(double newFrequency)
 		{
-			SpinLock::ScopedLockType sl(processLock);
-
-			frequency = newFrequency;
-
-			updateCoefficients();
+			frequency.store(newFrequency);
+			++version;
 		};
 
 
 		void setGain(double newGain)
 		{
-			SpinLock::ScopedLockType sl(processLock);
-
-			gain = (float)newGain;
-			updateCoefficients();
+			gain.store((float)newGain);
+			++version;
 		}
 
 		void setQ(double newQ)
 		{
-			SpinLock::ScopedLockType sl(processLock);
-
-			q = newQ;
-			updateCoefficients();
+			q.store(newQ);
+			++version;
 		}
 		
+		/** Changes the samplerate and clears the filter state. Call this only while the audio thread is locked. */
 		void setSampleRate(double newSampleRate)
 		{
-			SpinLock::ScopedLockType sl(processLock);
-
 			sampleRate = newSampleRate;
-			updateCoefficients();
-			leftFilter.reset();
-			rightFilter.reset();
-		}
-
-		void process(AudioSampleBuffer &b, int startSample, int numSamples)
-		{
-			if(!enabled) return;
-
-			SpinLock::ScopedLockType sl(processLock);
-
-			leftFilter.processSamples(b.getWritePointer(0, startSample), numSamples);
-			rightFilter.processSamples(b.getWritePointer(1, startSample), numSamples);
+			resetPending.store(true);
+			++version;
 		}
 
+		/** Calculates the coefficients from the current parameters. */
 		IIRCoefficients getCoefficients() const
 		{
-			return currentCoefficients;
+			const double f = frequency.load();
+			const double qValue = q.load();
+			const float g = gain.load();
+
+			switch(type.load())
+			{
+			case LowPass:		return IIRCoefficients::makeLowPass(sampleRate, f);
+			case HighPass:		return IIRCoefficients::makeHighPass(sampleRate, f);
+			case LowShelf:		return IIRCoefficients::makeLowShelf(sampleRate, f, qValue, g);
+			case HighShelf:		return IIRCoefficients::makeHighShelf(sampleRate, f, qValue, g);
+			case Peak:			return IIRCoefficients::makePeakFilter(sampleRate, f, qValue, g);
+			default:			return IIRCoefficients();
+			}
 		};
 
 		int getFilterType() const
 		{
-			return type;
+			return type.load();
 		}
 
-	private:
-
-		SpinLock processLock;
-
-		void updateCoefficients()
+		/** Picks up the parameter changes and returns the section for the cascade. This is called by the audio thread. */
+		StereoBiquadCascade::Section *getUpdatedSection()
 		{
-			switch(type)
+			const uint32 currentVersion = version.load();
+
+			if (currentVersion != processedVersion)
 			{
-			case LowPass:		currentCoefficients = IIRCoefficients::makeLowPass(sampleRate, frequency); break;
-			case HighPass:		currentCoefficients = IIRCoefficients::makeHighPass(sampleRate, frequency); break;
-			case LowShelf:		currentCoefficients = IIRCoefficients::makeLowShelf(sampleRate, frequency, q, gain); break;
-			case HighShelf:		currentCoefficients = IIRCoefficients::makeHighShelf(sampleRate, frequency, q, gain); break;
-			case Peak:			currentCoefficients = IIRCoefficients::makePeakFilter(sampleRate, frequency, q, gain); break;
-                case numFilterTypes: break;
+				processedVersion = currentVersion;
+
+				const bool shouldReset = resetPending.exchange(false);
+
+				if (shouldReset)
+					section.reset();
+
+				section.setTargetCoefficients(getCoefficients(), shouldReset);
 			}
 
-			leftFilter.setCoefficients(currentCoefficients);
-			rightFilter.setCoefficients(currentCoefficients);
-		};
+			return &section;
+		}
 
-		IIRCoefficients currentCoefficients;
+	private:
 
 		double sampleRate;
-		double frequency;
-		float gain;
-		double q;
-		bool enabled;
-		FilterType type;
-
-		IIRFilter leftFilter;
-		IIRFilter rightFilter;
+
+		std::atomic<double> frequency;
+		std::atomic<float> gain;
+		std::atomic<double> q;
+		std::atomic<int> type;
+		std::atomic<bool> enabled;
+
+		std::atomic<uint32> version;
+		uint32 processedVersion;
+		std::atomic<bool> resetPending;
+
+		StereoBiquadCascade::Section section;
+
+		JUCE_DECLARE_NON_COPYABLE(StereoFilter)
 	};
 
 	CurveEq(MainController *mc, const String &id):
@@ -228,11 +302,16 @@ public:
 
 	void applyEffect(AudioSampleBuffer &buffer, int startSample, int numSamples) override
 	{
+		activeSections.clearQuick();
+
 		for(int i = 0; i < filterBands.size(); i++)
 		{
-			filterBands[i]->process(buffer, startSample, numSamples);
+			if (filterBands[i]->isEnabled())
+				activeSections.add(filterBands[i]->getUpdatedSection());
 		}
 
+		StereoBiquadCascade::process(activeSections.getRawDataPointer(), activeSections.size(), buffer.getWritePointer(0, startSample), buffer.getWritePointer(1, startSample), numSamples);
+
 		if(fftBufferIndex < FFT_SIZE_FOR_EQ)
 		{
 			const int numSamplesToCopy = jmin<int>(numSamples, FFT_SIZE_FOR_EQ - fftBufferIndex);
@@ -275,6 +354,7 @@ public:
 		f->setFrequency(freq);
 
 		filterBands.add(f);
+		activeSections.ensureStorageAllocated(filterBands.size());
 
 		sendChangeMessage();
 	}
@@ -326,9 +406,16 @@ public:
 
 		for(int i = 0; i < numFilters; i++)
 		{
-			filterBands.add(new StereoFilter());
+			StereoFilter *f = new StereoFilter();
+
+			if (getSampleRate() > 0.0)
+				f->setSampleRate(getSampleRate());
+
+			filterBands.add(f);
 		}
 
+		activeSections.ensureStorageAllocated(numFilters);
+
 		for(int i = 0; i < numFilters * numBandParameters; i++)
 		{
 #if HI_USE_BACKWARD_COMPATIBILITY
@@ -393,6 +480,9 @@ private:
 
 	OwnedArray<StereoFilter> filterBands;
 
+	// the enabled sections of the current block (the storage is allocated when a band is added)
+	Array<StereoBiquadCascade::Section*> activeSections;
+
 };
 
 
@@ -84,6 +84,9 @@ public:
 		mc->addTempoListener(this);
 
 		enableConsoleOutput(true);
+
+		leftDelay.setMaxDelaySeconds(3.0);
+		rightDelay.setMaxDelaySeconds(3.0);
 	};
 
 	~DelayEffect()
@@ -196,8 +199,8 @@ public:
 	{
 		EffectProcessor::prepareToPlay(sampleRate, samplesPerBlock);
         
-        leftDelay.prepareToPlay(sampleRate);
-        rightDelay.prepareToPlay(sampleRate);
+        leftDelay.prepareToPlay(sampleRate, samplesPerBlock);
+        rightDelay.prepareToPlay(sampleRate, samplesPerBlock);
         
 		calcDelayTimes();
 
@@ -232,16 +235,18 @@ public:
 		const int sampleIndex = startSample;
 		const int samplesToCopy = numSamples;
 
-		float *inputL = buffer.getWritePointer(0, 0);
-		float *inputR = buffer.getWritePointer(1, 0);
-        
-        while(--numSamples >= 0)
-        {
-            leftDelayFrames.setSample(0, startSample, (float)leftDelay.getDelayedValue(inputL[startSample] + feedbackLeft * leftDelayFrames.getSample(0, startSample)));
-            rightDelayFrames.setSample(0, startSample, (float)rightDelay.getDelayedValue(inputR[startSample] + feedbackRight * rightDelayFrames.getSample(0, startSample)));
-            
-            ++startSample;
-        }
+		float *framesL = leftDelayFrames.getWritePointer(0, sampleIndex);
+		float *framesR = rightDelayFrames.getWritePointer(0, sampleIndex);
+
+		// The frames still contain the delayed signal of the last block, which is fed back into the delay line.
+		FloatVectorOperations::multiply(framesL, feedbackLeft, samplesToCopy);
+		FloatVectorOperations::multiply(framesR, feedbackRight, samplesToCopy);
+
+		FloatVectorOperations::add(framesL, buffer.getReadPointer(0, sampleIndex), samplesToCopy);
+		FloatVectorOperations::add(framesR, buffer.getReadPointer(1, sampleIndex), samplesToCopy);
+
+		leftDelay.processBlock(framesL, framesL, samplesToCopy);
+		rightDelay.processBlock(framesR, framesR, samplesToCopy);
 
         const float dryMix = (mix < 0.5f) ? 1.0f : (2.0f - 2.0f * mix);
         const float wetMix = (mix > 0.5f) ? 1.0f : (2.0f * mix);
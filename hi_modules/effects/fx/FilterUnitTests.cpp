@@ -0,0 +1,592 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licences for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licencing:
+*
+*   http://www.hartinstruments.net/hise/
+*
+*   HISE is based on the JUCE library,
+*   which also must be licenced for commercial applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+
+#include "JuceHeader.h"
+
+class PolyFilterBankUnitTest : public UnitTest
+{
+public:
+
+	PolyFilterBankUnitTest() :
+		UnitTest("Testing polyphonic filter bank")
+	{
+
+	}
+
+	void runTest() override
+	{
+		testAgainstVoiceFilters();
+		testModulatedSweep();
+		testQChange();
+		testSpeed();
+	}
+
+private:
+
+	enum
+	{
+		NumVoices = 128,
+		BlockSize = 512,
+		StepSize = 16
+	};
+
+	static String getModeName(PolyFilterBank::Mode m)
+	{
+		switch (m)
+		{
+		case PolyFilterBank::LowPass:			return "LowPass";
+		case PolyFilterBank::HighPass:			return "HighPass";
+		case PolyFilterBank::StateVariableLP:	return "StateVariableLP";
+		case PolyFilterBank::StateVariableHP:	return "StateVariableHP";
+		case PolyFilterBank::MoogLP:			return "MoogLP";
+		case PolyFilterBank::numModes:
+		default:								return "";
+		}
+	}
+
+	/** Processes one channel like the MonoFilterEffect does (the coefficients are updated for every step). */
+	struct ReferenceFilter
+	{
+		void prepare(PolyFilterBank::Mode m, double sampleRate_, double q_)
+		{
+			mode = m;
+			sampleRate = sampleRate_;
+			q = q_;
+
+			iir.reset();
+			svf.reset();
+			svf.setSamplerate((float)sampleRate);
+			svf.setType(mode == PolyFilterBank::StateVariableHP ? StateVariableFilter::HP : StateVariableFilter::LP);
+			moog.reset();
+			moog.setSampleRate(sampleRate);
+		}
+
+		void process(float *data, double frequency, int numSamples)
+		{
+			switch (mode)
+			{
+			case PolyFilterBank::LowPass:
+				iir.setCoefficients(IIRCoefficients::makeLowPass(sampleRate, frequency));
+				iir.processSamples(data, numSamples);
+				break;
+			case PolyFilterBank::HighPass:
+				iir.setCoefficients(IIRCoefficients::makeHighPass(sampleRate, frequency));
+				iir.processSamples(data, numSamples);
+				break;
+			case PolyFilterBank::StateVariableLP:
+			case PolyFilterBank::StateVariableHP:
+				svf.setCoefficients((float)frequency, (float)q / 10.0f);
+				svf.processSamples(data, numSamples);
+				break;
+			case PolyFilterBank::MoogLP:
+				moog.setCoefficients(frequency, q);
+				moog.processSamples(data, numSamples);
+				break;
+			case PolyFilterBank::numModes:
+			default:
+				break;
+			}
+		}
+
+		PolyFilterBank::Mode mode;
+		double sampleRate;
+		double q;
+
+		IIRFilter iir;
+		StateVariableFilter svf;
+		MoogFilter moog;
+	};
+
+	void fillWithNoise(AudioSampleBuffer &b)
+	{
+		for (int c = 0; c < b.getNumChannels(); c++)
+		{
+			for (int i = 0; i < b.getNumSamples(); i++)
+				b.setSample(c, i, r.nextFloat() * 0.5f - 0.25f);
+		}
+	}
+
+	void testAgainstVoiceFilters()
+	{
+		beginTest("Testing unmodulated filters against the voice filters");
+
+		const double sampleRate = 44100.0;
+		const double q = 2.0;
+		const double frequency = 2000.0;
+
+		for (int m = 0; m < PolyFilterBank::numModes; m++)
+		{
+			const PolyFilterBank::Mode mode = (PolyFilterBank::Mode)m;
+
+			PolyFilterBank bank(2);
+			bank.setSampleRate(sampleRate);
+			bank.setMode(mode);
+			bank.setQ(q);
+
+			ReferenceFilter left, right;
+			left.prepare(mode, sampleRate, q);
+			right.prepare(mode, sampleRate, q);
+
+			AudioSampleBuffer input(2, BlockSize);
+			fillWithNoise(input);
+
+			AudioSampleBuffer expected(input);
+			AudioSampleBuffer actual(input);
+
+			HeapBlock<float> modValues;
+			modValues.malloc(BlockSize);
+			FloatVectorOperations::fill(modValues, 1.0f, BlockSize);
+
+			left.process(expected.getWritePointer(0), frequency, BlockSize);
+			right.process(expected.getWritePointer(1), frequency, BlockSize);
+
+			bank.processVoice(1, actual.getWritePointer(0), actual.getWritePointer(1), modValues, frequency, BlockSize);
+
+			float maxDifference = 0.0f;
+
+			for (int c = 0; c < 2; c++)
+			{
+				for (int i = 0; i < BlockSize; i++)
+					maxDifference = jmax<float>(maxDifference, std::abs(expected.getSample(c, i) - actual.getSample(c, i)));
+			}
+
+			expect(maxDifference < 1.0e-4f, getModeName(mode) + ": Max difference: " + String(maxDifference));
+		}
+	}
+
+	void testModulatedSweep()
+	{
+		beginTest("Testing modulated sweeps");
+
+		for (int m = 0; m < PolyFilterBank::numModes; m++)
+		{
+			const PolyFilterBank::Mode mode = (PolyFilterBank::Mode)m;
+
+			PolyFilterBank bank(1);
+			bank.setSampleRate(44100.0);
+			bank.setMode(mode);
+			bank.setQ(4.0);
+
+			AudioSampleBuffer b(2, BlockSize);
+			HeapBlock<float> modValues;
+			modValues.malloc(BlockSize);
+
+			bool isFinite = true;
+			float peak = 0.0f;
+
+			for (int block = 0; block < 32; block++)
+			{
+				fillWithNoise(b);
+
+				// An envelope that goes from 20 kHz down to 100 Hz
+				for (int i = 0; i < BlockSize; i++)
+					modValues[i] = std::pow(0.005f, (float)(block * BlockSize + i) / (float)(32 * BlockSize));
+
+				bank.processVoice(0, b.getWritePointer(0), b.getWritePointer(1), modValues, 20000.0, BlockSize);
+
+				for (int i = 0; i < BlockSize; i++)
+				{
+					isFinite &= std::isfinite(b.getSample(0, i)) && std::isfinite(b.getSample(1, i));
+					peak = jmax<float>(peak, std::abs(b.getSample(0, i)));
+				}
+			}
+
+			expect(isFinite, getModeName(mode) + ": The sweep is not stable");
+			expect(peak < 8.0f, getModeName(mode) + ": Peak too high: " + String(peak));
+		}
+	}
+
+	void testQChange()
+	{
+		beginTest("Testing that a Q change updates the coefficients of an unmodulated voice");
+
+		const double sampleRate = 44100.0;
+		const double frequency = 1000.0;
+
+		// The biquads don't use the Q value
+		const PolyFilterBank::Mode modes[] = { PolyFilterBank::StateVariableLP, PolyFilterBank::StateVariableHP, PolyFilterBank::MoogLP };
+
+		for (int m = 0; m < 3; m++)
+		{
+			const PolyFilterBank::Mode mode = modes[m];
+
+			PolyFilterBank bank(1);
+			bank.setSampleRate(sampleRate);
+			bank.setMode(mode);
+			bank.setQ(1.0);
+
+			ReferenceFilter left, right;
+			left.prepare(mode, sampleRate, 1.0);
+			right.prepare(mode, sampleRate, 1.0);
+
+			HeapBlock<float> modValues;
+			modValues.malloc(BlockSize);
+			FloatVectorOperations::fill(modValues, 1.0f, BlockSize);
+
+			float maxDifference = 0.0f;
+
+			for (int block = 0; block < 8; block++)
+			{
+				if (block == 1)
+				{
+					bank.setQ(4.0);
+					left.q = 4.0;
+					right.q = 4.0;
+				}
+
+				AudioSampleBuffer expected(2, BlockSize);
+				fillWithNoise(expected);
+				AudioSampleBuffer actual(expected);
+
+				left.process(expected.getWritePointer(0), frequency, BlockSize);
+				right.process(expected.getWritePointer(1), frequency, BlockSize);
+
+				bank.processVoice(0, actual.getWritePointer(0), actual.getWritePointer(1), modValues, frequency, BlockSize);
+
+				// skip the block with the coefficient ramp
+				if (block < 2)
+					continue;
+
+				for (int c = 0; c < 2; c++)
+				{
+					for (int i = 0; i < BlockSize; i++)
+						maxDifference = jmax<float>(maxDifference, std::abs(expected.getSample(c, i) - actual.getSample(c, i)));
+				}
+			}
+
+			expect(maxDifference < 1.0e-3f, getModeName(mode) + ": Max difference after the Q change: " + String(maxDifference));
+		}
+	}
+
+	void testSpeed()
+	{
+		beginTest("Benchmarking filter bank against voice filters");
+
+		const double sampleRate = 44100.0;
+		const int numBlocks = 16;
+
+		AudioSampleBuffer input(2, BlockSize);
+		fillWithNoise(input);
+
+		// Every voice filters fresh input, otherwise the signal would decay into denormals
+		AudioSampleBuffer voiceBuffer(2, BlockSize);
+
+		HeapBlock<float> modValues;
+		modValues.malloc(BlockSize);
+
+		for (int i = 0; i < BlockSize; i++)
+			modValues[i] = 1.0f - 0.9f * (float)i / (float)BlockSize;
+
+		for (int m = 0; m < PolyFilterBank::numModes; m++)
+		{
+			const PolyFilterBank::Mode mode = (PolyFilterBank::Mode)m;
+
+			OwnedArray<ReferenceFilter> references;
+
+			for (int v = 0; v < NumVoices * 2; v++)
+			{
+				references.add(new ReferenceFilter());
+				references.getLast()->prepare(mode, sampleRate, 1.0);
+			}
+
+			PolyFilterBank bank(NumVoices);
+			bank.setSampleRate(sampleRate);
+			bank.setMode(mode);
+
+			// A fast envelope makes the voice effect process the voice in steps of 16 samples
+			const double referenceStart = Time::getMillisecondCounterHiRes();
+
+			for (int block = 0; block < numBlocks; block++)
+			{
+				for (int v = 0; v < NumVoices; v++)
+				{
+					voiceBuffer.makeCopyOf(input);
+
+					for (int i = 0; i < BlockSize; i += StepSize)
+					{
+						const double frequency = jmax<double>(70.0, 10000.0 * modValues[i]);
+
+						references[2 * v]->process(voiceBuffer.getWritePointer(0, i), frequency, StepSize);
+						references[2 * v + 1]->process(voiceBuffer.getWritePointer(1, i), frequency, StepSize);
+					}
+				}
+			}
+
+			const double referenceTime = Time::getMillisecondCounterHiRes() - referenceStart;
+
+			const double bankStart = Time::getMillisecondCounterHiRes();
+
+			for (int block = 0; block < numBlocks; block++)
+			{
+				for (int v = 0; v < NumVoices; v++)
+				{
+					voiceBuffer.makeCopyOf(input);
+
+					bank.processVoice(v, voiceBuffer.getWritePointer(0), voiceBuffer.getWritePointer(1), modValues, 10000.0, BlockSize);
+				}
+			}
+
+			const double bankTime = Time::getMillisecondCounterHiRes() - bankStart;
+
+			logMessage(getModeName(mode) + ": Voice filters: " + String(referenceTime, 2) + " ms, Filter bank: " + String(bankTime, 2) + " ms");
+		}
+	}
+
+	Random r;
+};
+
+static PolyFilterBankUnitTest polyFilterBankTestInstance;
+
+
+class CurveEqCascadeUnitTest : public UnitTest
+{
+public:
+
+	CurveEqCascadeUnitTest() :
+		UnitTest("Testing the CurveEq biquad cascade")
+	{
+
+	}
+
+	void runTest() override
+	{
+		testAgainstIIRFilters();
+		testCoefficientRamp();
+		testSpeed();
+	}
+
+private:
+
+	enum
+	{
+		NumBands = 10,
+		BlockSize = 512
+	};
+
+	/** A band like the CurveEq used to process it: two JUCE filters behind a SpinLock. */
+	struct ReferenceBand
+	{
+		void process(AudioSampleBuffer &b, int numSamples)
+		{
+			SpinLock::ScopedLockType sl(processLock);
+
+			leftFilter.processSamples(b.getWritePointer(0), numSamples);
+			rightFilter.processSamples(b.getWritePointer(1), numSamples);
+		}
+
+		SpinLock processLock;
+		IIRFilter leftFilter;
+		IIRFilter rightFilter;
+	};
+
+	static IIRCoefficients createCoefficients(int bandIndex, double sampleRate)
+	{
+		const double frequency = 40.0 * std::pow(2.0, (double)bandIndex);
+		const float gain = Decibels::decibelsToGain((float)(bandIndex % 3) * 4.0f - 4.0f);
+
+		switch (bandIndex % 5)
+		{
+		case 0:		return IIRCoefficients::makeLowShelf(sampleRate, frequency, 0.7, gain);
+		case 1:		return IIRCoefficients::makeHighShelf(sampleRate, frequency, 0.7, gain);
+		case 2:		return IIRCoefficients::makeHighPass(sampleRate, frequency * 0.5);
+		default:	return IIRCoefficients::makePeakFilter(sampleRate, frequency, 2.0, gain);
+		}
+	}
+
+	void fillWithNoise(AudioSampleBuffer &b)
+	{
+		for (int c = 0; c < b.getNumChannels(); c++)
+		{
+			for (int i = 0; i < b.getNumSamples(); i++)
+				b.setSample(c, i, r.nextFloat() * 0.5f - 0.25f);
+		}
+	}
+
+	void createBands(OwnedArray<ReferenceBand> &references, OwnedArray<StereoBiquadCascade::Section> &sections, Array<StereoBiquadCascade::Section*> &pointers)
+	{
+		for (int i = 0; i < NumBands; i++)
+		{
+			const IIRCoefficients c = createCoefficients(i, 44100.0);
+
+			ReferenceBand *ref = references.add(new ReferenceBand());
+			ref->leftFilter.setCoefficients(c);
+			ref->rightFilter.setCoefficients(c);
+
+			StereoBiquadCascade::Section *s = sections.add(new StereoBiquadCascade::Section());
+			s->setTargetCoefficients(c, true);
+			pointers.add(s);
+		}
+	}
+
+	void testAgainstIIRFilters()
+	{
+		beginTest("Testing the cascade against the JUCE filters");
+
+		OwnedArray<ReferenceBand> references;
+		OwnedArray<StereoBiquadCascade::Section> sections;
+		Array<StereoBiquadCascade::Section*> pointers;
+
+		createBands(references, sections, pointers);
+
+		AudioSampleBuffer input(2, BlockSize);
+		AudioSampleBuffer referenceBuffer(2, BlockSize);
+		AudioSampleBuffer cascadeBuffer(2, BlockSize);
+
+		float maxError = 0.0f;
+
+		for (int block = 0; block < 16; block++)
+		{
+			fillWithNoise(input);
+
+			referenceBuffer.makeCopyOf(input);
+			cascadeBuffer.makeCopyOf(input);
+
+			for (int i = 0; i < NumBands; i++)
+				references[i]->process(referenceBuffer, BlockSize);
+
+			StereoBiquadCascade::process(pointers.getRawDataPointer(), NumBands, cascadeBuffer.getWritePointer(0), cascadeBuffer.getWritePointer(1), BlockSize);
+
+			for (int c = 0; c < 2; c++)
+			{
+				for (int i = 0; i < BlockSize; i++)
+					maxError = jmax<float>(maxError, std::abs(referenceBuffer.getSample(c, i) - cascadeBuffer.getSample(c, i)));
+			}
+		}
+
+		// The cascade calculates in double precision, so there is a small difference to the float filters.
+		expect(maxError < 0.001f, "Difference to JUCE filters too high: " + String(maxError));
+	}
+
+	void testCoefficientRamp()
+	{
+		beginTest("Testing the coefficient ramp");
+
+		const double sampleRate = 44100.0;
+
+		StereoBiquadCascade::Section rampedSection;
+		StereoBiquadCascade::Section jumpingSection;
+
+		StereoBiquadCascade::Section *ramped = &rampedSection;
+		StereoBiquadCascade::Section *jumping = &jumpingSection;
+
+		rampedSection.setTargetCoefficients(IIRCoefficients::makePeakFilter(sampleRate, 1000.0, 4.0, 1.0f), false);
+		jumpingSection.setTargetCoefficients(IIRCoefficients::makePeakFilter(sampleRate, 1000.0, 4.0, 1.0f), false);
+
+		AudioSampleBuffer rampedBuffer(2, BlockSize);
+		AudioSampleBuffer jumpingBuffer(2, BlockSize);
+
+		bool allFinite = true;
+		float maxDifferenceAfterRamp = 0.0f;
+
+		// Sweep a narrow peak through the spectrum and compare with a section that jumps to the same values.
+		for (int block = 0; block < 64; block++)
+		{
+			const double frequency = 20.0 * std::pow(1000.0, (double)block / 63.0);
+			const IIRCoefficients c = IIRCoefficients::makePeakFilter(sampleRate, frequency, 10.0, Decibels::decibelsToGain(18.0f));
+
+			if (block < 32)
+			{
+				rampedSection.setTargetCoefficients(c, false);
+				jumpingSection.setTargetCoefficients(c, true);
+			}
+
+			fillWithNoise(rampedBuffer);
+			jumpingBuffer.makeCopyOf(rampedBuffer);
+
+			StereoBiquadCascade::process(&ramped, 1, rampedBuffer.getWritePointer(0), rampedBuffer.getWritePointer(1), BlockSize);
+			StereoBiquadCascade::process(&jumping, 1, jumpingBuffer.getWritePointer(0), jumpingBuffer.getWritePointer(1), BlockSize);
+
+			for (int i = 0; i < BlockSize; i++)
+			{
+				allFinite &= std::isfinite(rampedBuffer.getSample(0, i)) && std::isfinite(rampedBuffer.getSample(1, i));
+
+				// After the last change both sections have the same coefficients, so the state converges.
+				if (block > 40)
+					maxDifferenceAfterRamp = jmax<float>(maxDifferenceAfterRamp, std::abs(rampedBuffer.getSample(0, i) - jumpingBuffer.getSample(0, i)));
+			}
+		}
+
+		expect(allFinite, "The ramp produced invalid values");
+		expect(maxDifferenceAfterRamp < 0.0001f, "The ramp doesn't end at the target: " + String(maxDifferenceAfterRamp));
+	}
+
+	void testSpeed()
+	{
+		beginTest("Benchmarking the cascade against the JUCE filters");
+
+		const int numBlocks = 2000;
+
+		OwnedArray<ReferenceBand> references;
+		OwnedArray<StereoBiquadCascade::Section> sections;
+		Array<StereoBiquadCascade::Section*> pointers;
+
+		createBands(references, sections, pointers);
+
+		AudioSampleBuffer input(2, BlockSize);
+		AudioSampleBuffer buffer(2, BlockSize);
+
+		fillWithNoise(input);
+
+		const double referenceStart = Time::getMillisecondCounterHiRes();
+
+		for (int block = 0; block < numBlocks; block++)
+		{
+			buffer.makeCopyOf(input);
+
+			for (int i = 0; i < NumBands; i++)
+				references[i]->process(buffer, BlockSize);
+		}
+
+		const double referenceTime = Time::getMillisecondCounterHiRes() - referenceStart;
+
+		const double cascadeStart = Time::getMillisecondCounterHiRes();
+
+		for (int block = 0; block < numBlocks; block++)
+		{
+			buffer.makeCopyOf(input);
+
+			// Change one band in every block to include the cost of the ramp.
+			pointers[block % NumBands]->setTargetCoefficients(createCoefficients(block % NumBands, 44100.0 + (double)(block % 2)), false);
+
+			StereoBiquadCascade::process(pointers.getRawDataPointer(), NumBands, buffer.getWritePointer(0), buffer.getWritePointer(1), BlockSize);
+		}
+
+		const double cascadeTime = Time::getMillisecondCounterHiRes() - cascadeStart;
+
+		logMessage(String((int)NumBands) + " bands: JUCE filters: " + String(referenceTime, 2) + " ms, Cascade: " + String(cascadeTime, 2) + " ms");
+	}
+
+	Random r;
+};
+
+static CurveEqCascadeUnitTest curveEqCascadeTestInstance;
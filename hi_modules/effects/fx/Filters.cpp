@@ -282,6 +282,447 @@ IIRCoefficients MonoFilterEffect::makeResoLowPass(double sampleRate, double cuto
 		c1 * (1.0 - (q * c) + csq));
 }
 
+// ==================================================================================================== PolyFilterBank methods
+
+PolyFilterBank::PolyFilterBank(int numVoices_) :
+	numVoices(numVoices_)
+{
+	voiceStates.calloc(numVoices);
+
+	for (int i = 0; i < numVoices; i++)
+		resetVoice(i);
+}
+
+void PolyFilterBank::setSampleRate(double newSampleRate)
+{
+	sampleRate = newSampleRate;
+
+	for (int i = 0; i < numVoices; i++)
+		resetVoice(i);
+}
+
+void PolyFilterBank::setMode(Mode newMode)
+{
+	if (mode == newMode)
+		return;
+
+	mode = newMode;
+
+	// The states of the different filter types are not compatible
+	for (int i = 0; i < numVoices; i++)
+		resetVoice(i);
+}
+
+void PolyFilterBank::setQ(double newQ) noexcept
+{
+	if (q == newQ)
+		return;
+
+	q = newQ;
+
+	for (int i = 0; i < numVoices; i++)
+		voiceStates[i].coefficientsDirty = true;
+}
+
+void PolyFilterBank::resetVoice(int voiceIndex) noexcept
+{
+	jassert(isPositiveAndBelow(voiceIndex, numVoices));
+
+	VoiceState &v = voiceStates[voiceIndex];
+
+	zeromem(v.state, sizeof(v.state));
+	v.coefficientsInitialised = false;
+}
+
+void PolyFilterBank::processVoice(int voiceIndex, float *left, float *right, const float *frequencyModulationValues, double baseFrequency, int numSamples) noexcept
+{
+	jassert(isPositiveAndBelow(voiceIndex, numVoices));
+
+	VoiceState &v = voiceStates[voiceIndex];
+
+	const double minFrequency = 70.0;
+	const double maxFrequency = sampleRate * 0.49;
+
+	for (int offset = 0; offset < numSamples; offset += SubBlockSize)
+	{
+		const int numThisTime = jmin<int>(SubBlockSize, numSamples - offset);
+
+		// The coefficients reach the value of the last sample in the sub block
+		const double modValue = (double)frequencyModulationValues[offset + numThisTime - 1];
+		const double frequency = jlimit<double>(minFrequency, maxFrequency, std::abs(modValue * baseFrequency));
+
+		float target[numCoefficients];
+		float delta[numCoefficients];
+
+		const bool updateCoefficients = !v.coefficientsInitialised || v.coefficientsDirty || frequency != v.lastFrequency;
+
+		if (updateCoefficients)
+		{
+			calculateCoefficients(frequency, target);
+
+			if (!v.coefficientsInitialised)
+			{
+				memcpy(v.coefficients, target, sizeof(target));
+				v.coefficientsInitialised = true;
+			}
+
+			const float factor = 1.0f / (float)numThisTime;
+
+			for (int i = 0; i < numCoefficients; i++)
+				delta[i] = (target[i] - v.coefficients[i]) * factor;
+
+			v.lastFrequency = frequency;
+			v.coefficientsDirty = false;
+		}
+		else
+		{
+			zeromem(delta, sizeof(delta));
+		}
+
+		float *l = left + offset;
+		float *r = right + offset;
+
+		switch (mode)
+		{
+		case LowPass:
+		case HighPass:			processBiquad(v, delta, l, r, numThisTime); break;
+		case StateVariableLP:	processStateVariable(v, delta, l, r, numThisTime, false); break;
+		case StateVariableHP:	processStateVariable(v, delta, l, r, numThisTime, true); break;
+		case MoogLP:			processMoog(v, delta, l, r, numThisTime); break;
+		case numModes:
+		default:				jassertfalse; break;
+		}
+
+		// Avoid the rounding errors of the interpolation
+		if (updateCoefficients)
+			memcpy(v.coefficients, target, sizeof(target));
+	}
+
+	// Flush denormals once per block
+	for (int c = 0; c < 2; c++)
+	{
+		for (int i = 0; i < numStates; i++)
+		{
+			if (!(v.state[c][i] < -1.0e-8f || v.state[c][i] > 1.0e-8f))
+				v.state[c][i] = 0.0f;
+		}
+	}
+}
+
+void PolyFilterBank::calculateCoefficients(double frequency, float *c) const noexcept
+{
+	switch (mode)
+	{
+	case LowPass:
+	case HighPass:
+	{
+		// Same as IIRCoefficients::makeLowPass() / makeHighPass(), but without the overhead of the double precision
+		const float invQ = 1.4142135f;
+		const float t = tanf(float_Pi * (float)frequency / (float)sampleRate);
+		const float n = mode == LowPass ? 1.0f / t : t;
+		const float nSquared = n * n;
+		const float c1 = 1.0f / (1.0f + invQ * n + nSquared);
+
+		c[0] = c1;
+		c[1] = mode == LowPass ? 2.0f * c1 : -2.0f * c1;
+		c[2] = c1;
+		c[3] = mode == LowPass ? c1 * 2.0f * (1.0f - nSquared) : c1 * 2.0f * (nSquared - 1.0f);
+		c[4] = c1 * (1.0f - invQ * n + nSquared);
+		break;
+	}
+	case StateVariableLP:
+	case StateVariableHP:
+	{
+		// Same as StateVariableFilter::setCoefficients() with the resonance that the MonoFilterEffect uses
+		const float g = tanf(float_Pi * (float)frequency / (float)sampleRate);
+		const float k = 1.0f - 0.99f * (float)q / 10.0f;
+		const float ginv = g / (1.0f + g * (g + k));
+
+		c[0] = ginv;
+		c[1] = 2.0f * (g + k) * ginv;
+		c[2] = g * ginv;
+		c[3] = 2.0f * ginv;
+		c[4] = k;
+		break;
+	}
+	case MoogLP:
+	{
+		// Same as MoogFilter::setCoefficients()
+		const double f = 1.16 * frequency / (0.5 * sampleRate);
+		const double res = jmin<double>(4.0, q / 2.0);
+
+		c[0] = (float)(0.35013 * (f * f) * (f * f));
+		c[1] = (float)(1.0 - f);
+		c[2] = (float)(res * (1.0 - 0.15 * f * f));
+		c[3] = 0.0f;
+		c[4] = 0.0f;
+		break;
+	}
+	case numModes:
+	default:
+		jassertfalse;
+		zeromem(c, sizeof(float) * numCoefficients);
+	}
+}
+
+#if HI_SAMPLER_USE_SSE
+
+// The left and right channel are processed in the first two lanes of a SSE register.
+namespace PolyFilterBankHelpers
+{
+
+static forcedinline __m128 loadFrame(const float *left, const float *right) noexcept
+{
+	return _mm_unpacklo_ps(_mm_load_ss(left), _mm_load_ss(right));
+}
+
+static forcedinline void storeFrame(__m128 frame, float *left, float *right) noexcept
+{
+	_mm_store_ss(left, frame);
+	_mm_store_ss(right, _mm_shuffle_ps(frame, frame, _MM_SHUFFLE(1, 1, 1, 1)));
+}
+
+static forcedinline __m128 loadState(const float(&state)[2][PolyFilterBank::numStates], int index) noexcept
+{
+	return _mm_setr_ps(state[0][index], state[1][index], 0.0f, 0.0f);
+}
+
+static forcedinline void storeState(float(&state)[2][PolyFilterBank::numStates], int index, __m128 value) noexcept
+{
+	state[0][index] = _mm_cvtss_f32(value);
+	state[1][index] = _mm_cvtss_f32(_mm_shuffle_ps(value, value, _MM_SHUFFLE(1, 1, 1, 1)));
+}
+
+} // namespace PolyFilterBankHelpers
+
+#endif
+
+void PolyFilterBank::processBiquad(VoiceState &v, const float *delta, float *left, float *right, int numSamples) noexcept
+{
+#if HI_SAMPLER_USE_SSE
+
+	using namespace PolyFilterBankHelpers;
+
+	__m128 c0 = _mm_set1_ps(v.coefficients[0]), c1 = _mm_set1_ps(v.coefficients[1]), c2 = _mm_set1_ps(v.coefficients[2]);
+	__m128 c3 = _mm_set1_ps(v.coefficients[3]), c4 = _mm_set1_ps(v.coefficients[4]);
+
+	const __m128 d0 = _mm_set1_ps(delta[0]), d1 = _mm_set1_ps(delta[1]), d2 = _mm_set1_ps(delta[2]);
+	const __m128 d3 = _mm_set1_ps(delta[3]), d4 = _mm_set1_ps(delta[4]);
+
+	__m128 s1 = loadState(v.state, 0);
+	__m128 s2 = loadState(v.state, 1);
+
+	// Transposed direct form II (like the IIRFilter class)
+	for (int i = 0; i < numSamples; i++)
+	{
+		c0 = _mm_add_ps(c0, d0); c1 = _mm_add_ps(c1, d1); c2 = _mm_add_ps(c2, d2); c3 = _mm_add_ps(c3, d3); c4 = _mm_add_ps(c4, d4);
+
+		const __m128 x = loadFrame(left + i, right + i);
+		const __m128 y = _mm_add_ps(_mm_mul_ps(c0, x), s1);
+
+		s1 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(c1, x), _mm_mul_ps(c3, y)), s2);
+		s2 = _mm_sub_ps(_mm_mul_ps(c2, x), _mm_mul_ps(c4, y));
+
+		storeFrame(y, left + i, right + i);
+	}
+
+	v.coefficients[0] = _mm_cvtss_f32(c0); v.coefficients[1] = _mm_cvtss_f32(c1); v.coefficients[2] = _mm_cvtss_f32(c2);
+	v.coefficients[3] = _mm_cvtss_f32(c3); v.coefficients[4] = _mm_cvtss_f32(c4);
+
+	storeState(v.state, 0, s1);
+	storeState(v.state, 1, s2);
+
+#else
+
+	float c0 = v.coefficients[0], c1 = v.coefficients[1], c2 = v.coefficients[2], c3 = v.coefficients[3], c4 = v.coefficients[4];
+	float l1 = v.state[0][0], l2 = v.state[0][1];
+	float r1 = v.state[1][0], r2 = v.state[1][1];
+
+	// Transposed direct form II (like the IIRFilter class)
+	for (int i = 0; i < numSamples; i++)
+	{
+		c0 += delta[0]; c1 += delta[1]; c2 += delta[2]; c3 += delta[3]; c4 += delta[4];
+
+		const float inL = left[i];
+		const float inR = right[i];
+
+		const float outL = c0 * inL + l1;
+		const float outR = c0 * inR + r1;
+
+		l1 = c1 * inL - c3 * outL + l2;
+		r1 = c1 * inR - c3 * outR + r2;
+		l2 = c2 * inL - c4 * outL;
+		r2 = c2 * inR - c4 * outR;
+
+		left[i] = outL;
+		right[i] = outR;
+	}
+
+	v.coefficients[0] = c0; v.coefficients[1] = c1; v.coefficients[2] = c2; v.coefficients[3] = c3; v.coefficients[4] = c4;
+	v.state[0][0] = l1; v.state[0][1] = l2;
+	v.state[1][0] = r1; v.state[1][1] = r2;
+
+#endif
+}
+
+void PolyFilterBank::processStateVariable(VoiceState &v, const float *delta, float *left, float *right, int numSamples, bool isHighPass) noexcept
+{
+#if HI_SAMPLER_USE_SSE
+
+	using namespace PolyFilterBankHelpers;
+
+	__m128 g1 = _mm_set1_ps(v.coefficients[0]), g2 = _mm_set1_ps(v.coefficients[1]), g3 = _mm_set1_ps(v.coefficients[2]);
+	__m128 g4 = _mm_set1_ps(v.coefficients[3]), k = _mm_set1_ps(v.coefficients[4]);
+
+	const __m128 d1 = _mm_set1_ps(delta[0]), d2 = _mm_set1_ps(delta[1]), d3 = _mm_set1_ps(delta[2]);
+	const __m128 d4 = _mm_set1_ps(delta[3]), dk = _mm_set1_ps(delta[4]);
+
+	const __m128 two = _mm_set1_ps(2.0f);
+
+	__m128 z0 = loadState(v.state, 0);
+	__m128 s1 = loadState(v.state, 1);
+	__m128 s2 = loadState(v.state, 2);
+
+	for (int i = 0; i < numSamples; i++)
+	{
+		g1 = _mm_add_ps(g1, d1); g2 = _mm_add_ps(g2, d2); g3 = _mm_add_ps(g3, d3); g4 = _mm_add_ps(g4, d4); k = _mm_add_ps(k, dk);
+
+		const __m128 x = loadFrame(left + i, right + i);
+		const __m128 s3 = _mm_sub_ps(_mm_add_ps(x, z0), _mm_mul_ps(two, s2));
+		const __m128 s1z = s1;
+
+		s1 = _mm_add_ps(s1, _mm_sub_ps(_mm_mul_ps(g1, s3), _mm_mul_ps(g2, s1z)));
+		s2 = _mm_add_ps(s2, _mm_add_ps(_mm_mul_ps(g3, s3), _mm_mul_ps(g4, s1z)));
+
+		z0 = x;
+
+		storeFrame(isHighPass ? _mm_sub_ps(_mm_sub_ps(x, _mm_mul_ps(k, s1)), s2) : s2, left + i, right + i);
+	}
+
+	v.coefficients[0] = _mm_cvtss_f32(g1); v.coefficients[1] = _mm_cvtss_f32(g2); v.coefficients[2] = _mm_cvtss_f32(g3);
+	v.coefficients[3] = _mm_cvtss_f32(g4); v.coefficients[4] = _mm_cvtss_f32(k);
+
+	storeState(v.state, 0, z0);
+	storeState(v.state, 1, s1);
+	storeState(v.state, 2, s2);
+
+#else
+
+	float g1 = v.coefficients[0], g2 = v.coefficients[1], g3 = v.coefficients[2], g4 = v.coefficients[3], k = v.coefficients[4];
+
+	float l0z = v.state[0][0], l1 = v.state[0][1], l2 = v.state[0][2];
+	float r0z = v.state[1][0], r1 = v.state[1][1], r2 = v.state[1][2];
+
+	for (int i = 0; i < numSamples; i++)
+	{
+		g1 += delta[0]; g2 += delta[1]; g3 += delta[2]; g4 += delta[3]; k += delta[4];
+
+		const float inL = left[i];
+		const float inR = right[i];
+
+		const float l3 = inL + l0z - 2.0f * l2;
+		const float r3 = inR + r0z - 2.0f * r2;
+
+		const float l1z = l1;
+		const float r1z = r1;
+
+		l1 += g1 * l3 - g2 * l1z;
+		r1 += g1 * r3 - g2 * r1z;
+		l2 += g3 * l3 + g4 * l1z;
+		r2 += g3 * r3 + g4 * r1z;
+
+		l0z = inL;
+		r0z = inR;
+
+		left[i] = isHighPass ? inL - k * l1 - l2 : l2;
+		right[i] = isHighPass ? inR - k * r1 - r2 : r2;
+	}
+
+	v.coefficients[0] = g1; v.coefficients[1] = g2; v.coefficients[2] = g3; v.coefficients[3] = g4; v.coefficients[4] = k;
+	v.state[0][0] = l0z; v.state[0][1] = l1; v.state[0][2] = l2;
+	v.state[1][0] = r0z; v.state[1][1] = r1; v.state[1][2] = r2;
+
+#endif
+}
+
+void PolyFilterBank::processMoog(VoiceState &v, const float *delta, float *left, float *right, int numSamples) noexcept
+{
+#if HI_SAMPLER_USE_SSE
+
+	using namespace PolyFilterBankHelpers;
+
+	__m128 gain = _mm_set1_ps(v.coefficients[0]), invF = _mm_set1_ps(v.coefficients[1]), fb = _mm_set1_ps(v.coefficients[2]);
+
+	const __m128 dGain = _mm_set1_ps(delta[0]), dInvF = _mm_set1_ps(delta[1]), dFb = _mm_set1_ps(delta[2]);
+
+	const __m128 zeroPointThree = _mm_set1_ps(0.3f);
+	const __m128 two = _mm_set1_ps(2.0f);
+
+	__m128 in1 = loadState(v.state, 0), in2 = loadState(v.state, 1), in3 = loadState(v.state, 2), in4 = loadState(v.state, 3);
+	__m128 out1 = loadState(v.state, 4), out2 = loadState(v.state, 5), out3 = loadState(v.state, 6), out4 = loadState(v.state, 7);
+
+	for (int i = 0; i < numSamples; i++)
+	{
+		gain = _mm_add_ps(gain, dGain); invF = _mm_add_ps(invF, dInvF); fb = _mm_add_ps(fb, dFb);
+
+		const __m128 x = _mm_mul_ps(_mm_sub_ps(loadFrame(left + i, right + i), _mm_mul_ps(out4, fb)), gain);
+
+		out1 = _mm_add_ps(_mm_add_ps(x, _mm_mul_ps(zeroPointThree, in1)), _mm_mul_ps(invF, out1));
+		in1 = x;
+		out2 = _mm_add_ps(_mm_add_ps(out1, _mm_mul_ps(zeroPointThree, in2)), _mm_mul_ps(invF, out2));
+		in2 = out1;
+		out3 = _mm_add_ps(_mm_add_ps(out2, _mm_mul_ps(zeroPointThree, in3)), _mm_mul_ps(invF, out3));
+		in3 = out2;
+		out4 = _mm_add_ps(_mm_add_ps(out3, _mm_mul_ps(zeroPointThree, in4)), _mm_mul_ps(invF, out4));
+		in4 = out3;
+
+		storeFrame(_mm_mul_ps(two, out4), left + i, right + i);
+	}
+
+	v.coefficients[0] = _mm_cvtss_f32(gain); v.coefficients[1] = _mm_cvtss_f32(invF); v.coefficients[2] = _mm_cvtss_f32(fb);
+
+	storeState(v.state, 0, in1); storeState(v.state, 1, in2); storeState(v.state, 2, in3); storeState(v.state, 3, in4);
+	storeState(v.state, 4, out1); storeState(v.state, 5, out2); storeState(v.state, 6, out3); storeState(v.state, 7, out4);
+
+#else
+
+
+	float gain = v.coefficients[0], invF = v.coefficients[1], fb = v.coefficients[2];
+
+	float *sl = v.state[0];
+	float *sr = v.state[1];
+
+	float lIn1 = sl[0], lIn2 = sl[1], lIn3 = sl[2], lIn4 = sl[3], lOut1 = sl[4], lOut2 = sl[5], lOut3 = sl[6], lOut4 = sl[7];
+	float rIn1 = sr[0], rIn2 = sr[1], rIn3 = sr[2], rIn4 = sr[3], rOut1 = sr[4], rOut2 = sr[5], rOut3 = sr[6], rOut4 = sr[7];
+
+	for (int i = 0; i < numSamples; i++)
+	{
+		gain += delta[0]; invF += delta[1]; fb += delta[2];
+
+		const float inL = (left[i] - lOut4 * fb) * gain;
+		const float inR = (right[i] - rOut4 * fb) * gain;
+
+		lOut1 = inL + 0.3f * lIn1 + invF * lOut1;		rOut1 = inR + 0.3f * rIn1 + invF * rOut1;
+		lIn1 = inL;										rIn1 = inR;
+		lOut2 = lOut1 + 0.3f * lIn2 + invF * lOut2;		rOut2 = rOut1 + 0.3f * rIn2 + invF * rOut2;
+		lIn2 = lOut1;									rIn2 = rOut1;
+		lOut3 = lOut2 + 0.3f * lIn3 + invF * lOut3;		rOut3 = rOut2 + 0.3f * rIn3 + invF * rOut3;
+		lIn3 = lOut2;									rIn3 = rOut2;
+		lOut4 = lOut3 + 0.3f * lIn4 + invF * lOut4;		rOut4 = rOut3 + 0.3f * rIn4 + invF * rOut4;
+		lIn4 = lOut3;									rIn4 = rOut3;
+
+		left[i] = 2.0f * lOut4;
+		right[i] = 2.0f * rOut4;
+	}
+
+	v.coefficients[0] = gain; v.coefficients[1] = invF; v.coefficients[2] = fb;
+
+	sl[0] = lIn1; sl[1] = lIn2; sl[2] = lIn3; sl[3] = lIn4; sl[4] = lOut1; sl[5] = lOut2; sl[6] = lOut3; sl[7] = lOut4;
+	sr[0] = rIn1; sr[1] = rIn2; sr[2] = rIn3; sr[3] = rIn4; sr[4] = rOut1; sr[5] = rOut2; sr[6] = rOut3; sr[7] = rOut4;
+
+#endif
+}
+
 PolyFilterEffect::PolyFilterEffect(MainController *mc, const String &uid, int numVoices) :
 VoiceEffectProcessor(mc, uid, numVoices),
 mode(MonoFilterEffect::LowPass),
@@ -290,6 +731,7 @@ currentFreq(20000.0),
 currentGain(1.0f),
 gain(1.0f),
 q(1.0),
+filterBank(numVoices),
 freqChain(new ModulatorChain(mc, "Frequency Modulation", numVoices, Modulation::GainMode, this)),
 gainChain(new ModulatorChain(mc, "Gain Modulation", numVoices, Modulation::GainMode, this))
 {
@@ -322,9 +764,10 @@ void PolyFilterEffect::setInternalAttribute(int parameterIndex, float newValue)
 	{
 	case MonoFilterEffect::Gain:		gain = Decibels::decibelsToGain(newValue); break;
 	case MonoFilterEffect::Frequency:	freq = newValue; break;
-	case MonoFilterEffect::Q:			q = newValue; break;
+	case MonoFilterEffect::Q:			q = newValue; filterBank.setQ(q); break;
 	case MonoFilterEffect::Mode:		mode = (MonoFilterEffect::FilterMode)(int)newValue;
 		for (int i = 0; i < voiceFilters.size(); i++) voiceFilters[i]->setMode((int)newValue);
+		if (isFilterBankMode(mode)) filterBank.setMode(getFilterBankMode(mode));
 		break;
         case MonoFilterEffect::Quality: setRenderQuality((int)newValue); break;
 	default:							jassertfalse; return;
@@ -365,6 +808,42 @@ void PolyFilterEffect::prepareToPlay(double sampleRate, int samplesPerBlock)
 	{
 		voiceFilters[i]->prepareToPlay(sampleRate, samplesPerBlock);
 	}
+
+	filterBank.setSampleRate(sampleRate);
+}
+
+IIRCoefficients PolyFilterEffect::getCurrentCoefficients() const
+{
+	if (getSampleRate() > 0.0 && (mode == MonoFilterEffect::LowPass || mode == MonoFilterEffect::HighPass))
+	{
+		// Use the frequency parameter until the first voice was rendered
+		const double lastFrequency = filterBank.getLastFrequency(0);
+		const double frequency = lastFrequency > 0.0 ? lastFrequency : jlimit<double>(20.0, getSampleRate() * 0.49, freq);
+
+		return mode == MonoFilterEffect::LowPass ? IIRCoefficients::makeLowPass(getSampleRate(), frequency) :
+												   IIRCoefficients::makeHighPass(getSampleRate(), frequency);
+	}
+
+	return voiceFilters[0]->getCurrentCoefficients();
+}
+
+bool PolyFilterEffect::isFilterBankMode(MonoFilterEffect::FilterMode m) noexcept
+{
+	return m == MonoFilterEffect::LowPass || m == MonoFilterEffect::HighPass || m == MonoFilterEffect::StateVariableLP ||
+		   m == MonoFilterEffect::StateVariableHP || m == MonoFilterEffect::MoogLP;
+}
+
+PolyFilterBank::Mode PolyFilterEffect::getFilterBankMode(MonoFilterEffect::FilterMode m) noexcept
+{
+	switch (m)
+	{
+	case MonoFilterEffect::HighPass:		return PolyFilterBank::HighPass;
+	case MonoFilterEffect::StateVariableLP:	return PolyFilterBank::StateVariableLP;
+	case MonoFilterEffect::StateVariableHP:	return PolyFilterBank::StateVariableHP;
+	case MonoFilterEffect::MoogLP:			return PolyFilterBank::MoogLP;
+	case MonoFilterEffect::LowPass:
+	default:								return PolyFilterBank::LowPass;
+	}
 }
 
 ProcessorEditorBody *PolyFilterEffect::createEditor(ProcessorEditor *parentEditor)
@@ -394,6 +873,15 @@ void PolyFilterEffect::preVoiceRendering(int voiceIndex, int startSample, int nu
 
 void PolyFilterEffect::applyEffect(int voiceIndex, AudioSampleBuffer &b, int startSample, int numSamples)
 {
+	if (isFilterBankMode(mode))
+	{
+		// The gain has no effect on these filter types
+		const float *freqModValues = freqChain->getVoiceValues(voiceIndex) + startSample;
+
+		filterBank.processVoice(voiceIndex, b.getWritePointer(0, startSample), b.getWritePointer(1, startSample), freqModValues, freq, numSamples);
+		return;
+	}
+
 	const double freqModValue = (double)getCurrentModulationValue(FrequencyChain, voiceIndex, startSample);
 	const double checkFreq = std::abs(freqModValue * freq);
 
@@ -421,6 +909,8 @@ void PolyFilterEffect::startVoice(int voiceIndex, int noteNumber)
 {
 	VoiceEffectProcessor::startVoice(voiceIndex, noteNumber);
 
+	filterBank.resetVoice(voiceIndex);
+
 	if (voiceFilters[voiceIndex]->useStateVariableFilters)
 	{
 		voiceFilters[voiceIndex]->stateFilterL.reset();
@@ -384,6 +384,82 @@ private:
 
 
 
+/** The filter states of all voices of a PolyFilterEffect.
+*
+*	Instead of a MonoFilterEffect per voice, this keeps the states of every voice in one flat array and processes both channels 
+*	in one loop. With HI_SAMPLER_USE_SSE the left and right channel are the first two lanes of a SSE register. The coefficients are calculated every SubBlockSize samples from the frequency modulation values and interpolated
+*	for every sample, so fast envelopes don't cause zipper noise.
+*/
+class PolyFilterBank
+{
+public:
+
+	enum Mode
+	{
+		LowPass = 0,
+		HighPass,
+		StateVariableLP,
+		StateVariableHP,
+		MoogLP,
+		numModes
+	};
+
+	enum
+	{
+		SubBlockSize = 8,
+		numCoefficients = 5,
+		numStates = 8
+	};
+
+	PolyFilterBank(int numVoices);
+
+	void setSampleRate(double newSampleRate);
+
+	/** Changes the filter type and resets all voices. */
+	void setMode(Mode newMode);
+
+	/** Changes the resonance. The voices fade to the new coefficients in their next sub block. */
+	void setQ(double newQ) noexcept;
+
+	/** Clears the filter state of the voice. The next block starts with the coefficients for its first frequency. */
+	void resetVoice(int voiceIndex) noexcept;
+
+	/** Filters the samples of one voice.
+	*
+	*	@param frequencyModulationValues the modulation values for every sample (they are multiplied with the base frequency).
+	*/
+	void processVoice(int voiceIndex, float *left, float *right, const float *frequencyModulationValues, double baseFrequency, int numSamples) noexcept;
+
+	/** Returns the frequency of the last processed sub block of the voice (0 if the voice was never processed). */
+	double getLastFrequency(int voiceIndex) const noexcept { return voiceStates[voiceIndex].lastFrequency; }
+
+private:
+
+	struct VoiceState
+	{
+		float coefficients[numCoefficients];
+		float state[2][numStates];
+		double lastFrequency;
+		bool coefficientsInitialised;
+		bool coefficientsDirty;
+	};
+
+	void calculateCoefficients(double frequency, float *c) const noexcept;
+
+	static void processBiquad(VoiceState &v, const float *delta, float *left, float *right, int numSamples) noexcept;
+	static void processStateVariable(VoiceState &v, const float *delta, float *left, float *right, int numSamples, bool isHighPass) noexcept;
+	static void processMoog(VoiceState &v, const float *delta, float *left, float *right, int numSamples) noexcept;
+
+	Mode mode = LowPass;
+	double q = 1.0;
+	double sampleRate = 44100.0;
+
+	const int numVoices;
+	HeapBlock<VoiceState> voiceStates;
+
+	JUCE_DECLARE_NON_COPYABLE(PolyFilterBank)
+};
+
 class PolyFilterEffect: public VoiceEffectProcessor,
 						public FilterEffect
 {
@@ -430,12 +506,17 @@ public:
 	
 	ProcessorEditorBody *createEditor(ProcessorEditor *parentEditor)  override;
 
-	IIRCoefficients getCurrentCoefficients() const override {return voiceFilters[0]->getCurrentCoefficients();};
+	IIRCoefficients getCurrentCoefficients() const override;
 
 private:
 
 	friend class HarmonicFilter;
 
+	/** Returns true if the mode is processed by the filter bank instead of the voice filters. */
+	static bool isFilterBankMode(MonoFilterEffect::FilterMode m) noexcept;
+
+	static PolyFilterBank::Mode getFilterBankMode(MonoFilterEffect::FilterMode m) noexcept;
+
 	bool changeFlag;
 
 	double currentFreq;
@@ -448,6 +529,8 @@ private:
 
 	OwnedArray<MonoFilterEffect> voiceFilters;
 
+	PolyFilterBank filterBank;
+
 	ScopedPointer<ModulatorChain> freqChain;
 	ScopedPointer<ModulatorChain> gainChain;
 
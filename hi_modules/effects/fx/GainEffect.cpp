@@ -56,6 +56,9 @@ balance(0.0f)
     widthChain->setFactoryType(new TimeVariantModulatorFactoryType(Modulation::GainMode, this));
     delayChain->setFactoryType(new TimeVariantModulatorFactoryType(Modulation::GainMode, this));
 
+	// The delay slider goes up to 500 ms
+	leftDelay.setMaxDelaySeconds(0.5);
+	rightDelay.setMaxDelaySeconds(0.5);
 }
 
 void GainEffect::setInternalAttribute(int parameterIndex, float newValue)
@@ -140,34 +143,17 @@ void GainEffect::applyEffect(AudioSampleBuffer &buffer, int startSample, int num
 	{
 		const float smoothedGain = smoother.smooth(gain);
 
-		if (delay != 0)
-		{
-			l[0] = leftDelay.getDelayedValue(smoothedGain * l[0]);
-			r[0] = rightDelay.getDelayedValue(smoothedGain * r[0]);
-
-			l[1] = leftDelay.getDelayedValue(smoothedGain * l[1]);
-			r[1] = rightDelay.getDelayedValue(smoothedGain * r[1]);
+		l[0] = smoothedGain * l[0];
+		r[0] = smoothedGain * r[0];
 
-			l[2] = leftDelay.getDelayedValue(smoothedGain * l[2]);
-			r[2] = rightDelay.getDelayedValue(smoothedGain * r[2]);
+		l[1] = smoothedGain * l[1];
+		r[1] = smoothedGain * r[1];
 
-			l[3] = leftDelay.getDelayedValue(smoothedGain * l[3]);
-			r[3] = rightDelay.getDelayedValue(smoothedGain * r[3]);
-		}
-		else
-		{
-			l[0] = smoothedGain * l[0];
-			r[0] = smoothedGain * r[0];
+		l[2] = smoothedGain * l[2];
+		r[2] = smoothedGain * r[2];
 
-			l[1] = smoothedGain * l[1];
-			r[1] = smoothedGain * r[1];
-
-			l[2] = smoothedGain * l[2];
-			r[2] = smoothedGain * r[2];
-
-			l[3] = smoothedGain * l[3];
-			r[3] = smoothedGain * r[3];
-		}
+		l[3] = smoothedGain * l[3];
+		r[3] = smoothedGain * r[3];
 
 		l += 4;
 		r += 4;
@@ -175,6 +161,15 @@ void GainEffect::applyEffect(AudioSampleBuffer &buffer, int startSample, int num
 		numSamples -= 4;
 	}
 
+	if (delay != 0)
+	{
+		l = buffer.getWritePointer(0, startIndex);
+		r = buffer.getWritePointer(1, startIndex);
+
+		leftDelay.processBlock(l, l, samplesToCopy);
+		rightDelay.processBlock(r, r, samplesToCopy);
+	}
+
 
 	if (msDecoder.getWidth() != 1.0f)
 	{
@@ -246,11 +241,14 @@ void GainEffect::prepareToPlay(double sampleRate, int samplesPerBlock)
         widthBuffer = AudioSampleBuffer(1, samplesPerBlock);
 		balanceBuffer = AudioSampleBuffer(1, samplesPerBlock);
         
-        leftDelay.prepareToPlay(sampleRate);
-        rightDelay.prepareToPlay(sampleRate);
+        leftDelay.prepareToPlay(sampleRate, samplesPerBlock);
+        rightDelay.prepareToPlay(sampleRate, samplesPerBlock);
         
         leftDelay.setFadeTimeSamples(samplesPerBlock);
         rightDelay.setFadeTimeSamples(samplesPerBlock);
+
+		// The delay time in samples depends on the sample rate.
+		setDelayTime(delay);
         
 		smoother.prepareToPlay(sampleRate);
 		smoother.setSmoothingTime(4.0);
@@ -231,7 +231,7 @@ void HarmonicFilter::startVoice(int voiceIndex, int noteNumber)
 
 void HarmonicFilter::applyEffect(int voiceIndex, AudioSampleBuffer &b, int startSample, int numSamples)
 {
-    ADD_GLITCH_DETECTOR(getId() + " rendering function");
+    ADD_GLITCH_DETECTOR(nullptr, getId() + " rendering function");
     
 	double xModValue;
 
@@ -88,6 +88,7 @@
 #include "effects/fx/GainCollector.cpp"
 #include "effects/convolution/AtkConvolution.cpp"
 #include "effects/convolution/Convolution.cpp"
+#include "effects/convolution/NonUniformConvolution.cpp"
 #include "effects/mda/mdaLimiter.cpp"
 #include "effects/mda/mdaDegrade.cpp"
 #include "effects/fx/Saturator.cpp"
@@ -143,6 +143,7 @@ END_JUCE_MODULE_DECLARATION
 #include "effects/fx/GainCollector.h"
 #include "effects/convolution/AtkConvolution.h"
 #include "effects/convolution/Convolution.h"
+#include "effects/convolution/NonUniformConvolution.h"
 #include "effects/mda/mdaLimiter.h"
 #include "effects/mda/mdaDegrade.h"
 #include "effects/fx/Saturator.h"
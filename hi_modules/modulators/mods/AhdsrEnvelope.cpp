@@ -233,7 +233,7 @@ void AhdsrEnvelope::calculateBlock(int startSample, int numSamples)
 	}
 	else
 	{
-		while (numSamples > 0)
+		while (numSamples >= 4)
 		{
 			for (int i = 0; i < 4; i++)
 			{
@@ -243,6 +243,12 @@ void AhdsrEnvelope::calculateBlock(int startSample, int numSamples)
 
 			numSamples -= 4;
 		}
+
+		while (--numSamples >= 0)
+		{
+			internalBuffer.setSample(0, startSample, calculateNewValue());
+			++startSample;
+		}
 	}
 
 #if ENABLE_ALL_PEAK_METERS
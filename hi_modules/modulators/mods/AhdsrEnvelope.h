@@ -111,6 +111,8 @@ public:
 	void stopVoice(int voiceIndex) override;
 	void reset(int voiceIndex) override;;
 
+	bool supportsControlRate() const override { return true; }
+
 	void calculateBlock(int startSample, int numSamples);;
 
 	void handleHiseEvent(const HiseEvent &e) override;
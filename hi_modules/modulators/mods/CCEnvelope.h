@@ -128,6 +128,8 @@ public:
 	void reset(int voiceIndex) override;
 	bool isPlaying(int voiceIndex) const override;
 
+	bool supportsControlRate() const override { return true; }
+
 	void calculateBlock(int startSample, int numSamples) override;;
 	void handleHiseEvent(const HiseEvent& e);
 	void prepareToPlay(double sampleRate, int samplesPerBlock) override;
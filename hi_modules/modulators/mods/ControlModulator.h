@@ -72,6 +72,8 @@ public:
 	float getAttribute (int parameter_index) const override;
 	void setInternalAttribute (int parameter_index, float newValue) override;
 
+	bool supportsControlRate() const override { return true; }
+
 	void calculateBlock(int startSample, int numSamples) override;;
 	void handleHiseEvent(const HiseEvent &m) override;
 	virtual void prepareToPlay(double sampleRate, int samplesPerBlock) override;;
@@ -0,0 +1,335 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licences for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licencing:
+*
+*   http://www.hartinstruments.net/hise/
+*
+*   HISE is based on the JUCE library,
+*   which also must be licenced for commercial applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+#include "JuceHeader.h"
+
+class ControlRateUnitTest : public UnitTest
+{
+public:
+
+	ControlRateUnitTest() :
+		UnitTest("Testing modulators at control rate")
+	{
+
+	}
+
+	void runTest() override
+	{
+		testAttribute();
+		testAgainstAudioRate();
+		testSpeed();
+	}
+
+private:
+
+	enum
+	{
+		BlockSize = 256,
+		NumBlocks = 48,
+		Divider = 16
+	};
+
+	enum ModulatorType
+	{
+		Ahdsr = 0,
+		Simple,
+		Table,
+		CC,
+		Control,
+		PitchWheel,
+		Lfo,
+		Macro,
+		numModulatorTypes
+	};
+
+	static String getName(int type)
+	{
+		switch (type)
+		{
+		case Ahdsr:			return "AhdsrEnvelope";
+		case Simple:		return "SimpleEnvelope";
+		case Table:			return "TableEnvelope";
+		case CC:			return "CCEnvelope";
+		case Control:		return "ControlModulator";
+		case PitchWheel:	return "PitchwheelModulator";
+		case Lfo:			return "LfoModulator";
+		case Macro:			return "MacroModulator";
+		default:			jassertfalse; return String();
+		}
+	}
+
+	static Modulator *createModulator(MainController *mc, int type)
+	{
+		switch (type)
+		{
+		case Ahdsr:			return new AhdsrEnvelope(mc, "Mod", NUM_POLYPHONIC_VOICES, Modulation::GainMode);
+		case Simple:		return new SimpleEnvelope(mc, "Mod", NUM_POLYPHONIC_VOICES, Modulation::GainMode);
+		case Table:			return new TableEnvelope(mc, "Mod", NUM_POLYPHONIC_VOICES, Modulation::GainMode);
+		case CC:			return new CCEnvelope(mc, "Mod", NUM_POLYPHONIC_VOICES, Modulation::GainMode);
+		case Control:		return new ControlModulator(mc, "Mod", Modulation::GainMode);
+		case PitchWheel:	return new PitchwheelModulator(mc, "Mod", Modulation::GainMode);
+		case Lfo:			return new LfoModulator(mc, "Mod", Modulation::GainMode);
+		case Macro:			return new MacroModulator(mc, "Mod", Modulation::GainMode);
+		default:			jassertfalse; return nullptr;
+		}
+	}
+
+	/** Renders a gain chain with one modulator for a single voice like the ModulatorSynth does. */
+	class ChainRenderer
+	{
+	public:
+
+		ChainRenderer(int type, int divider) :
+			bp(new BackendProcessor()),
+			chain(new ModulatorChain(bp, "Gain Modulation", NUM_POLYPHONIC_VOICES, Modulation::GainMode, bp->getMainSynthChain())),
+			timeVariantValues(1, BlockSize)
+		{
+			chain->getHandler()->add(createModulator(bp, type), nullptr);
+			chain->setAttribute(ModulatorChain::ControlRateDivider, (float)divider, dontSendNotification);
+			chain->prepareToPlay(44100.0, BlockSize);
+		}
+
+		/** Plays a note with some controller and pitch wheel movements. The events are not on a control rate
+		*	period, so the voice is rendered in chunks that start in the middle of a period. */
+		void renderBlock(int blockIndex, float *gainValues)
+		{
+			Array<HiseEvent> events;
+			Array<int> positions;
+
+			switch (blockIndex)
+			{
+			case 0:		addEvent(events, positions, MidiMessage::noteOn(1, 60, (uint8)100), 13);
+						addEvent(events, positions, MidiMessage::controllerEvent(1, 1, 20), 100); break;
+			case 4:		addEvent(events, positions, MidiMessage::pitchWheel(1, 12000), 201); break;
+			case 8:		addEvent(events, positions, MidiMessage::controllerEvent(1, 1, 127), 5); break;
+			case 12:	addEvent(events, positions, MidiMessage::pitchWheel(1, 2000), 99); break;
+			case 20:	addEvent(events, positions, MidiMessage::controllerEvent(1, 1, 0), 171);
+						addEvent(events, positions, MidiMessage::noteOff(1, 60), 211); break;
+			default:	break;
+			}
+
+			if (MacroModulator *macro = dynamic_cast<MacroModulator*>(chain->getHandler()->getProcessor(0)))
+			{
+				if (blockIndex == 10)
+					macro->setAttribute(MacroModulator::MacroValue, 0.3f, dontSendNotification);
+			}
+
+			int startSample = 0;
+
+			for (int i = 0; i < events.size(); i++)
+			{
+				renderChunk(startSample, positions[i] - startSample);
+
+				const HiseEvent &e = events.getReference(i);
+
+				chain->handleHiseEvent(e);
+
+				if (e.isNoteOn())
+					chain->startVoice(0);
+				else if (e.isNoteOff())
+					chain->stopVoice(0);
+
+				startSample = positions[i];
+			}
+
+			renderChunk(startSample, BlockSize - startSample);
+
+			FloatVectorOperations::multiply(gainValues, chain->getVoiceValues(0), timeVariantValues.getReadPointer(0), BlockSize);
+		}
+
+		ModulatorChain *getChain() { return chain; }
+
+	private:
+
+		static void addEvent(Array<HiseEvent> &events, Array<int> &positions, const MidiMessage &m, int position)
+		{
+			events.add(HiseEvent(m));
+			positions.add(position);
+		}
+
+		void renderChunk(int startSample, int numSamples)
+		{
+			if (numSamples <= 0)
+				return;
+
+			chain->renderVoice(0, startSample, numSamples);
+			chain->renderNextBlock(timeVariantValues, startSample, numSamples);
+		}
+
+		ScopedPointer<BackendProcessor> bp;
+		ScopedPointer<ModulatorChain> chain;
+		AudioSampleBuffer timeVariantValues;
+	};
+
+	struct ErrorResult
+	{
+		ErrorResult() : maxError(0.0f), rmsError(0.0f), maxLagError(0.0f) {}
+
+		float maxError;
+		float rmsError;
+
+		/** The distance to the range of the audio rate values from two control periods before to one period after the sample. */
+		float maxLagError;
+	};
+
+	void testAttribute()
+	{
+		beginTest("Testing the ControlRateDivider attribute");
+
+		ChainRenderer r(Ahdsr, Divider);
+
+		ModulatorChain *chain = r.getChain();
+
+		expectEquals(chain->getControlRateDividerForModulators(), (int)Divider, "Divider set by the attribute");
+		expectEquals<int>((int)chain->getAttribute(ModulatorChain::ControlRateDivider), Divider, "Attribute value");
+
+		TimeModulation *envelope = dynamic_cast<TimeModulation*>(chain->getHandler()->getProcessor(0));
+
+		expectEquals(envelope->getControlRateDivider(), (int)Divider, "Divider of the envelope");
+
+		ValueTree v = chain->exportAsValueTree();
+
+		expectEquals<int>(v.getProperty("ControlRateDivider"), Divider, "The divider is saved");
+
+		chain->setAttribute(ModulatorChain::ControlRateDivider, 1.0f, dontSendNotification);
+
+		expectEquals(envelope->getControlRateDivider(), 1, "Audio rate");
+		expect(!chain->exportAsValueTree().hasProperty("ControlRateDivider"), "The default is not saved");
+
+		chain->restoreFromValueTree(v);
+
+		expectEquals(envelope->getControlRateDivider(), (int)Divider, "The divider is restored");
+
+		chain->setAttribute(ModulatorChain::ControlRateDivider, 1000.0f, dontSendNotification);
+
+		expectEquals(chain->getControlRateDividerForModulators(), 64, "The divider is limited");
+	}
+
+	void testAgainstAudioRate()
+	{
+		beginTest("Testing the error against the audio rate modulation");
+
+		for (int type = 0; type < numModulatorTypes; type++)
+		{
+			const ErrorResult r = measureError(type);
+
+			logMessage(getName(type) + ": max error " + String(r.maxError, 6) + ", RMS error " + String(r.rmsError, 6) + ", max error outside of the period range " + String(r.maxLagError, 6));
+
+			// The ramp lags one period behind and the first value after a voice start is one step ahead, so the values must stay
+			// within what the audio rate modulator produces around the sample. Jumps (eg. the first controller value) are ramped
+			// over one period, so the maximum error itself can be as big as the jump. The small tolerance covers the smoothers
+			// and envelope curves that are calculated with fewer steps.
+			expect(r.maxLagError < 0.005f, getName(type) + " error outside of the period range: " + String(r.maxLagError, 6));
+			expect(r.rmsError < 0.05f, getName(type) + " RMS error: " + String(r.rmsError, 6));
+		}
+	}
+
+	/** The processors are deleted before this returns because the BackendProcessor redirects the log messages of the test to its console. */
+	static ErrorResult measureError(int type)
+	{
+		const int numSamples = NumBlocks * BlockSize;
+
+		HeapBlock<float> audioRateValues(numSamples);
+		HeapBlock<float> controlRateValues(numSamples);
+
+		{
+			ChainRenderer audioRate(type, 1);
+			ChainRenderer controlRate(type, Divider);
+
+			for (int block = 0; block < NumBlocks; block++)
+			{
+				audioRate.renderBlock(block, audioRateValues + block * BlockSize);
+				controlRate.renderBlock(block, controlRateValues + block * BlockSize);
+			}
+		}
+
+		ErrorResult r;
+		double errorSum = 0.0;
+
+		for (int i = 0; i < numSamples; i++)
+		{
+			const float error = std::abs(audioRateValues[i] - controlRateValues[i]);
+
+			r.maxError = jmax<float>(r.maxError, error);
+			errorSum += (double)(error * error);
+
+			const int lagStart = jmax<int>(0, i - 2 * Divider);
+			const int lagEnd = jmin<int>(numSamples, i + Divider + 1);
+
+			const Range<float> lagRange = FloatVectorOperations::findMinAndMax(audioRateValues + lagStart, lagEnd - lagStart);
+			const float v = controlRateValues[i];
+
+			const float lagError = v < lagRange.getStart() ? lagRange.getStart() - v : (v > lagRange.getEnd() ? v - lagRange.getEnd() : 0.0f);
+
+			r.maxLagError = jmax<float>(r.maxLagError, lagError);
+		}
+
+		r.rmsError = (float)std::sqrt(errorSum / (double)numSamples);
+
+		return r;
+	}
+
+	void testSpeed()
+	{
+		beginTest("Measuring the modulator speed at control rate");
+
+		const int numBlocks = 2000;
+
+		for (int type = 0; type < numModulatorTypes; type++)
+		{
+			const double audioRateTime = measureRenderTime(type, 1, numBlocks);
+			const double controlRateTime = measureRenderTime(type, Divider, numBlocks);
+
+			logMessage(getName(type) + ": " + String(1000000.0 * audioRateTime / (double)numBlocks, 2) + " us per block at audio rate, " +
+					   String(1000000.0 * controlRateTime / (double)numBlocks, 2) + " us at a divider of " + String((int)Divider) +
+					   ", speedup: " + String(audioRateTime / controlRateTime, 2) + "x");
+		}
+	}
+
+	static double measureRenderTime(int type, int divider, int numBlocks)
+	{
+		ChainRenderer r(type, divider);
+
+		HeapBlock<float> gainValues(BlockSize);
+
+		r.renderBlock(0, gainValues);
+
+		const double start = Time::getMillisecondCounterHiRes();
+
+		for (int block = 1; block < numBlocks; block++)
+			r.renderBlock(block % 20, gainValues);
+
+		return jmax<double>(0.000001, (Time::getMillisecondCounterHiRes() - start) * 0.001);
+	}
+};
+
+static ControlRateUnitTest controlRateUnitTest;
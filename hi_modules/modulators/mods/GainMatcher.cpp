@@ -71,7 +71,7 @@ VoiceStartModulator(mc, id, numVoices, m),
 Modulation(m),
 
 useTable(false),
-generator(Random(Time::currentTimeMillis()))
+generator(mc->getNextRandomSeed())
 {
 	this->enableConsoleOutput(false);
 
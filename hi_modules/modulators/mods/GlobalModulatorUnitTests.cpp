@@ -0,0 +1,366 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licences for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licencing:
+*
+*   http://www.hartinstruments.net/hise/
+*
+*   HISE is based on the JUCE library,
+*   which also must be licenced for commercial applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+#include "JuceHeader.h"
+
+class GlobalModulatorUnitTest : public UnitTest
+{
+public:
+
+	GlobalModulatorUnitTest() :
+		UnitTest("Testing the global time variant modulators")
+	{
+
+	}
+
+	void runTest() override
+	{
+		testTableLookup();
+		testReceivers(false);
+		testReceivers(true);
+		testSpeed();
+	}
+
+private:
+
+	enum
+	{
+		BlockSize = 256,
+		NumBlocks = 24,
+		NumReceivers = 64,
+		Divider = 16
+	};
+
+	/** Renders a global LFO and a gain chain with receivers that are connected to it like the synth chain does.
+	*
+	*	The global modulators are rendered at control rate and the block is split at positions that are not
+	*	on a control rate period, so the receivers read the values in the middle of a period.
+	*/
+	class GlobalRenderer
+	{
+	public:
+
+		GlobalRenderer(bool useTable, float sourceIntensity) :
+			bp(new BackendProcessor()),
+			sourceValues(1, BlockSize),
+			outputValues(1, BlockSize)
+		{
+			ModulatorSynthChain *synthChain = bp->getMainSynthChain();
+
+			GlobalModulatorContainer *container = new GlobalModulatorContainer(bp, "Global", NUM_POLYPHONIC_VOICES);
+
+			synthChain->getHandler()->add(container, nullptr);
+
+			sourceChain = dynamic_cast<ModulatorChain*>(container->getChildProcessor(ModulatorSynth::GainModulation));
+
+			lfo = new LfoModulator(bp, "LFO", Modulation::GainMode);
+			lfo->setAttribute(LfoModulator::Frequency, 7.0f, dontSendNotification);
+			lfo->setIntensity(sourceIntensity);
+
+			sourceChain->getHandler()->add(lfo, nullptr);
+			sourceChain->setAttribute(ModulatorChain::ControlRateDivider, (float)Divider, dontSendNotification);
+
+			// The container updates its list asynchronously...
+			sourceChain->getHandler()->sendSynchronousChangeMessage();
+
+			receiverChain = new ModulatorChain(bp, "Gain Modulation", NUM_POLYPHONIC_VOICES, Modulation::GainMode, synthChain);
+
+			for (int i = 0; i < NumReceivers; i++)
+			{
+				GlobalTimeVariantModulator *receiver = new GlobalTimeVariantModulator(bp, "Receiver" + String(i + 1), Modulation::GainMode);
+
+				receiverChain->getHandler()->add(receiver, nullptr);
+
+				receiver->setAttribute(GlobalTimeVariantModulator::UseTable, useTable ? 1.0f : 0.0f, dontSendNotification);
+				receiver->getTable(0)->addTablePoint(0.3f, 0.1f + 0.01f * (float)i);
+				receiver->connectToGlobalModulator("Global:LFO");
+			}
+
+			bp->prepareToPlay(44100.0, BlockSize);
+			receiverChain->prepareToPlay(44100.0, BlockSize);
+		}
+
+		/** Renders the chunk and stores the source values right after the LFO has calculated them. */
+		void renderChunk(int startSample, int numSamples)
+		{
+			sourceChain->renderNextBlock(sourceValues, startSample, numSamples);
+
+			FloatVectorOperations::copy(sourceValues.getWritePointer(0, startSample), lfo->getCalculatedValues(0) + startSample, numSamples);
+
+			receiverChain->renderNextBlock(outputValues, startSample, numSamples);
+		}
+
+		void renderBlock()
+		{
+			const int splitPositions[] = { 0, 13, 100, 211, BlockSize };
+
+			for (int i = 0; i < 4; i++)
+				renderChunk(splitPositions[i], splitPositions[i + 1] - splitPositions[i]);
+		}
+
+		bool isConnected(int receiverIndex) const
+		{
+			return getReceiver(receiverIndex)->isConnected();
+		}
+
+		const float *getSourceValues() const { return sourceValues.getReadPointer(0); }
+		const float *getOutputValues() const { return outputValues.getReadPointer(0); }
+		const float *getLfoValues() { return lfo->getCalculatedValues(0); }
+
+		const float *getReceiverValues(int receiverIndex) { return getReceiver(receiverIndex)->getCalculatedValues(0); }
+
+		const MidiTable *getReceiverTable(int receiverIndex) const
+		{
+			return dynamic_cast<const MidiTable*>(getReceiver(receiverIndex)->getTable(0));
+		}
+
+	private:
+
+		GlobalTimeVariantModulator *getReceiver(int receiverIndex) const
+		{
+			return dynamic_cast<GlobalTimeVariantModulator*>(receiverChain->getHandler()->getProcessor(receiverIndex));
+		}
+
+		ScopedPointer<BackendProcessor> bp;
+		ScopedPointer<ModulatorChain> receiverChain;
+
+		ModulatorChain *sourceChain;
+		LfoModulator *lfo;
+
+		AudioSampleBuffer sourceValues;
+		AudioSampleBuffer outputValues;
+	};
+
+	struct ReceiverResult
+	{
+		ReceiverResult() : allConnected(true), numSourceErrors(0), numOutputErrors(0), numTableErrors(0) {}
+
+		bool allConnected;
+
+		/** The number of samples where the source values changed after they were read. */
+		int numSourceErrors;
+
+		/** The number of samples where the chain output doesn't match the product of the receiver values. */
+		int numOutputErrors;
+
+		/** The number of table values that don't match the truncating lookup. */
+		int numTableErrors;
+	};
+
+	void testTableLookup()
+	{
+		beginTest("Testing the block lookup of the MidiTable");
+
+		MidiTable table;
+
+		table.addTablePoint(0.2f, 0.7f);
+		table.addTablePoint(0.6f, 0.3f);
+
+		Random r(1234);
+
+		const int numValues = 1031;
+
+		HeapBlock<float> inputValues(numValues + 1);
+		HeapBlock<float> outputValues(numValues + 1);
+
+		for (int i = 0; i < numValues; i++)
+			inputValues[i] = (i < 256) ? (float)i / 255.0f : r.nextFloat();
+
+		inputValues[numValues - 1] = 1.0f;
+
+		int numErrors = 0;
+
+		// Unaligned buffers and odd sizes for the scalar tail
+		for (int offset = 0; offset < 2; offset++)
+		{
+			table.getValues(inputValues.getData() + offset, outputValues.getData() + 1 - offset, numValues - offset);
+
+			for (int i = 0; i < numValues - offset; i++)
+			{
+				if (outputValues[i + 1 - offset] != table.get((int)(inputValues[i + offset] * 127.0f)))
+					numErrors++;
+			}
+		}
+
+		expectEquals(numErrors, 0, "Same values as the per sample lookup");
+
+		float clippedValues[5] = { -0.5f, 1.5f, 0.5f, 0.0f, 1.0f };
+
+		table.getValues(clippedValues, clippedValues, 5);
+
+		expectEquals(clippedValues[0], table.get(0), "Negative values are clipped");
+		expectEquals(clippedValues[1], table.get(127), "Values above 1 are clipped");
+		expectEquals(clippedValues[2], table.get(63), "In place lookup");
+		expectEquals(clippedValues[4], table.get(127), "The last value");
+	}
+
+	void testReceivers(bool useTable)
+	{
+		beginTest(useTable ? "Testing the table lookup of the receivers at control rate" :
+							 "Testing the receivers that read the source values directly at control rate");
+
+		// Without the table, the receivers multiply the source values directly, so a small intensity keeps the product of 64 values audible
+		const ReceiverResult r = checkReceivers(useTable, useTable ? 1.0f : 0.1f);
+
+		expect(r.allConnected, "All receivers are connected");
+		expectEquals(r.numSourceErrors, 0, "The source values of the chunks are not overwritten");
+		expectEquals(r.numOutputErrors, 0, "Chain output");
+
+		if (useTable)
+			expectEquals(r.numTableErrors, 0, "Table values of the receivers");
+	}
+
+	/** The processors are deleted before this returns because the BackendProcessor redirects the log messages of the test to its console. */
+	static ReceiverResult checkReceivers(bool useTable, float sourceIntensity)
+	{
+		ReceiverResult result;
+
+		GlobalRenderer r(useTable, sourceIntensity);
+
+		for (int i = 0; i < NumReceivers; i++)
+			result.allConnected &= r.isConnected(i);
+
+		HeapBlock<float> expectedValues(BlockSize);
+
+		for (int block = 0; block < NumBlocks; block++)
+		{
+			r.renderBlock();
+
+			const float *sourceValues = r.getSourceValues();
+
+			for (int i = 0; i < BlockSize; i++)
+			{
+				if (sourceValues[i] != r.getLfoValues()[i])
+					result.numSourceErrors++;
+			}
+
+			FloatVectorOperations::fill(expectedValues, 1.0f, BlockSize);
+
+			for (int receiverIndex = 0; receiverIndex < NumReceivers; receiverIndex++)
+			{
+				if (useTable)
+				{
+					const MidiTable *table = r.getReceiverTable(receiverIndex);
+					const float *receiverValues = r.getReceiverValues(receiverIndex);
+
+					for (int i = 0; i < BlockSize; i++)
+					{
+						const float tableValue = table->get((int)(sourceValues[i] * 127.0f));
+
+						if (receiverValues[i] != tableValue)
+							result.numTableErrors++;
+
+						expectedValues[i] *= tableValue;
+					}
+				}
+				else
+				{
+					FloatVectorOperations::multiply(expectedValues, sourceValues, BlockSize);
+				}
+			}
+
+			for (int i = 0; i < BlockSize; i++)
+			{
+				if (r.getOutputValues()[i] != expectedValues[i])
+					result.numOutputErrors++;
+			}
+		}
+
+		return result;
+	}
+
+	void testSpeed()
+	{
+		beginTest("Measuring the speed of 64 receivers");
+
+		const int numBlocks = 2000;
+
+		const double directTime = measureRenderTime(false, numBlocks);
+		const double tableTime = measureRenderTime(true, numBlocks);
+
+		logMessage(String(NumReceivers) + " receivers: " + String(1000000.0 * directTime / (double)numBlocks, 2) + " us per block without table, " +
+				   String(1000000.0 * tableTime / (double)numBlocks, 2) + " us per block with table");
+
+		MidiTable table;
+
+		table.addTablePoint(0.3f, 0.8f);
+
+		AudioSampleBuffer inputValues(1, BlockSize);
+		AudioSampleBuffer outputValues(1, BlockSize);
+
+		Random r(42);
+
+		for (int i = 0; i < BlockSize; i++)
+			inputValues.setSample(0, i, r.nextFloat());
+
+		const int numLookups = numBlocks * NumReceivers;
+
+		double start = Time::getMillisecondCounterHiRes();
+
+		for (int i = 0; i < numLookups; i++)
+		{
+			const float *data = inputValues.getReadPointer(0);
+
+			// The per sample lookup of the previous calculateBlock()
+			for (int j = 0; j < BlockSize; j++)
+				outputValues.setSample(0, j, table.get((int)(data[j] * 127.0f)));
+		}
+
+		const double scalarTime = Time::getMillisecondCounterHiRes() - start;
+
+		start = Time::getMillisecondCounterHiRes();
+
+		for (int i = 0; i < numLookups; i++)
+			table.getValues(inputValues.getReadPointer(0), outputValues.getWritePointer(0), BlockSize);
+
+		const double blockTime = jmax<double>(0.000001, Time::getMillisecondCounterHiRes() - start);
+
+		logMessage("Table lookup for " + String(NumReceivers) + " receivers: " + String(1000.0 * scalarTime / (double)numBlocks, 2) + " us per block with the per sample lookup, " +
+				   String(1000.0 * blockTime / (double)numBlocks, 2) + " us per block with MidiTable::getValues(), speedup: " + String(scalarTime / blockTime, 2) + "x");
+	}
+
+	static double measureRenderTime(bool useTable, int numBlocks)
+	{
+		GlobalRenderer r(useTable, 1.0f);
+
+		r.renderBlock();
+
+		const double start = Time::getMillisecondCounterHiRes();
+
+		for (int block = 1; block < numBlocks; block++)
+			r.renderBlock();
+
+		return jmax<double>(0.000001, (Time::getMillisecondCounterHiRes() - start) * 0.001);
+	}
+};
+
+static GlobalModulatorUnitTest globalModulatorUnitTest;
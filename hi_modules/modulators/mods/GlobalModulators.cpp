@@ -33,7 +33,8 @@
 GlobalModulator::GlobalModulator(MainController *mc):
 originalModulator(nullptr),
 connectedContainer(nullptr),
-useTable(false)
+useTable(false),
+slotIndex(-1)
 {
 	table = new MidiTable();
 
@@ -146,9 +147,28 @@ void GlobalModulator::connectToGlobalModulator(const String &itemEntry)
 		}
 
 		jassert(isConnected());
+
+		updateSlotIndex();
 	}
 }
 
+int GlobalModulator::getConnectedSlotIndex()
+{
+	jassert(isConnected());
+
+	if (!getConnectedContainer()->isSlotValid(slotIndex, getOriginalModulator()))
+	{
+		updateSlotIndex();
+	}
+
+	return slotIndex;
+}
+
+void GlobalModulator::updateSlotIndex()
+{
+	slotIndex = isConnected() ? getConnectedContainer()->getSlotIndex(getOriginalModulator()) : -1;
+}
+
 String GlobalModulator::getItemEntryFor(const GlobalModulatorContainer *c, const Processor *p)
 {
 	if (c == nullptr || p == nullptr) return String();
@@ -258,7 +278,11 @@ float GlobalVoiceStartModulator::calculateVoiceStartValue(const HiseEvent &m)
 
 		const int noteNumber = m.getNoteNumber();
 
-		float globalValue = getConnectedContainer()->getConstantVoiceValue(getOriginalModulator(), noteNumber);
+		const int globalSlot = getConnectedSlotIndex();
+
+		if (globalSlot == -1) return 1.0f;
+
+		float globalValue = getConnectedContainer()->getConstantVoiceValueForSlot(globalSlot, noteNumber);
 
 		if (useTable)
 		{
@@ -331,36 +355,28 @@ float GlobalTimeVariantModulator::getAttribute(int parameterIndex) const
 
 void GlobalTimeVariantModulator::calculateBlock(int startSample, int numSamples)
 {
-	if (isConnected())
+	const int globalSlot = isConnected() ? getConnectedSlotIndex() : -1;
+
+	if (globalSlot != -1)
 	{
+		const float *data = getConnectedContainer()->getModulationValuesForSlot(globalSlot, startSample);
+
 		if (useTable)
 		{
-			const float *data = getConnectedContainer()->getModulationValuesForModulator(getOriginalModulator(), startSample);
-
 			const float thisInputValue = data[0];
 
-			int i = 0;
+			float *outputValues = internalBuffer.getWritePointer(0, startSample);
 
-			const int startIndex = startSample;
+			table->getValues(data, outputValues, numSamples);
 
-			while (--numSamples >= 0)
-			{
-				const int tableIndex = (int)(data[i++] * 127.0f);
-
-				internalBuffer.setSample(0, startSample++, table->get(tableIndex));
-			}
-
-			setOutputValue(internalBuffer.getSample(0, startIndex));
+			setOutputValue(outputValues[0]);
 			sendTableIndexChangeMessage(false, table, thisInputValue);
-
 		}
 		else
 		{
-			FloatVectorOperations::copy(internalBuffer.getWritePointer(0, startSample), getConnectedContainer()->getModulationValuesForModulator(getOriginalModulator(), startSample), numSamples);
-			setOutputValue(internalBuffer.getSample(0, startSample));
+			FloatVectorOperations::copy(internalBuffer.getWritePointer(0, startSample), data, numSamples);
+			setOutputValue(data[0]);
 		}
-
-		
 	}
 	else
 	{
@@ -369,3 +385,24 @@ void GlobalTimeVariantModulator::calculateBlock(int startSample, int numSamples)
 	}
 }
 
+void GlobalTimeVariantModulator::renderNextBlock(AudioSampleBuffer &buffer, int startSample, int numSamples)
+{
+	// The values of the original modulator are already clipped and scaled by its intensity, so with full gain
+	// intensity they can be applied without copying them to the internal buffer first.
+	const bool canUseSourceValues = !useTable && getMode() == GainMode && getIntensity() == 1.0f && !isPlotted();
+
+	const int globalSlot = (canUseSourceValues && isConnected()) ? getConnectedSlotIndex() : -1;
+
+	if (globalSlot != -1)
+	{
+		const float *data = getConnectedContainer()->getModulationValuesForSlot(globalSlot, startSample);
+
+		FloatVectorOperations::multiply(buffer.getWritePointer(0, startSample), data, numSamples);
+		setOutputValue(data[0]);
+	}
+	else
+	{
+		TimeVariantModulator::renderNextBlock(buffer, startSample, numSamples);
+	}
+}
+
@@ -73,6 +73,7 @@ public:
 
 	void changeListenerCallback(SafeChangeBroadcaster *)
 	{
+		updateSlotIndex();
 		dynamic_cast<Processor*>(this)->sendSynchronousChangeMessage();
 	}
 
@@ -96,16 +97,28 @@ protected:
 
 	GlobalModulator(MainController *mc);
 
+	/** Returns the slot of the original modulator in the connected container.
+	*
+	*	The slot is resolved when the modulator is connected. If the container has rebuilt its list since then,
+	*	it will be resolved again, so this doesn't search the container as long as the list stays the same.
+	*	Only call this if isConnected() returns true.
+	*/
+	int getConnectedSlotIndex();
+
 	ScopedPointer<MidiTable> table;
 
 	bool useTable;
 
 private:
 
+	void updateSlotIndex();
+
 	WeakReference<Processor> connectedContainer;
 
 	WeakReference<Processor> originalModulator;
 
+	int slotIndex;
+
 };
 
 /** Deactivates Globals (this is used in Global Containers. */
@@ -184,6 +197,9 @@ public:
 
 	void calculateBlock(int startSample, int numSamples) override;
 
+	/** Multiplies the values of the original modulator directly into the buffer if they don't need to be changed. */
+	void renderNextBlock(AudioSampleBuffer &buffer, int startSample, int numSamples) override;
+
 	/** sets the new target value if the controller number matches. */
 	void handleHiseEvent(const HiseEvent &/*m*/) override {};
 
@@ -33,7 +33,7 @@
 LfoModulator::LfoModulator(MainController *mc, const String &id, Modulation::Mode m):
 	TimeVariantModulator(mc, id, m),
 	Modulation(m),
-	frequency(getDefaultValue(Frequency)),
+	frequency(3.0f),
 	run(false),
 	currentValue(1.0f),
 	angleDelta(0.0),
@@ -68,7 +68,7 @@ LfoModulator::LfoModulator(MainController *mc, const String &id, Modulation::Mod
 
 	frequencyUpdater.setManualCountLimit(4096);
 
-	randomGenerator.setSeedRandomly();
+	randomGenerator.setSeed(getMainController()->getNextRandomSeed());
 
 	getMainController()->addTempoListener(this);
 
@@ -295,7 +295,7 @@ void LfoModulator::prepareToPlay(double sampleRate, int samplesPerBlock)
 
 		inputMerger.setManualCountLimit(10);
 
-		randomGenerator.setSeedRandomly();
+		randomGenerator.setSeed(getMainController()->getNextRandomSeed());
 	}
 
 	// Use the block size to ramp the blocks.
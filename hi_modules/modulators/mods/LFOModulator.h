@@ -171,6 +171,8 @@ public:
 	/** sets up the smoothing filter. */
 	virtual void prepareToPlay(double sampleRate, int samplesPerBlock) override;
 
+	bool supportsControlRate() const override { return true; }
+
 	void calculateBlock(int startSample, int numSamples) override
 	{
 #if ENABLE_ALL_PEAK_METERS
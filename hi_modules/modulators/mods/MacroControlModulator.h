@@ -93,6 +93,8 @@ public:
 	/** sets up the smoothing filter. */
 	virtual void prepareToPlay(double sampleRate, int samplesPerBlock) override;;
 
+	bool supportsControlRate() const override { return true; }
+
 	void calculateBlock(int startSample, int numSamples) override;;
 
 	void macroControllerMoved(float newValue);
@@ -35,7 +35,7 @@ RandomModulator::RandomModulator(MainController *mc, const String &id, int numVo
 		Modulation(m),
 		table(new MidiTable()),
 		useTable(false),
-		generator(Random (Time::currentTimeMillis()))
+		generator(mc->getNextRandomSeed())
 {
 	this->enableConsoleOutput(false);
 
@@ -223,7 +223,7 @@ void SimpleEnvelope::calculateBlock(int startSample, int numSamples)
 
 		if (linearMode)
 		{
-			while (numSamples > 0)
+			while (numSamples >= 4)
 			{
 				*out++ = calculateNewValue();
 				*out++ = calculateNewValue();
@@ -232,10 +232,15 @@ void SimpleEnvelope::calculateBlock(int startSample, int numSamples)
 
 				numSamples -= 4;
 			}
+
+			while (--numSamples >= 0)
+			{
+				*out++ = calculateNewValue();
+			}
 		}
 		else
 		{
-			while (numSamples > 0)
+			while (numSamples >= 4)
 			{
 				*out++ = calculateNewExpValue();
 				*out++ = calculateNewExpValue();
@@ -244,6 +249,11 @@ void SimpleEnvelope::calculateBlock(int startSample, int numSamples)
 
 				numSamples -= 4;
 			}
+
+			while (--numSamples >= 0)
+			{
+				*out++ = calculateNewExpValue();
+			}
 		}
 
 		
@@ -104,6 +104,7 @@ public:
 	bool isPlaying(int voiceIndex) const override;
 
 	void prepareToPlay(double sampleRate, int samplesPerBlock) override;
+	bool supportsControlRate() const override { return true; }
 	void calculateBlock(int startSample, int numSamples) override;
 	void handleHiseEvent(const HiseEvent& m) override;
 	
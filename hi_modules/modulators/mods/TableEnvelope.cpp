@@ -235,6 +235,8 @@ float TableEnvelope::calculateNewValue()
 			}
 			else
 			{
+			// Hold the end of the attack table, the last interpolated value depends on the step size
+			state->current_value = attackTable->getLastValue();
 			state->current_state = TableEnvelopeState::SUSTAIN;
 			debugMod(" (voiceIndex = " + String(voiceIndex) + "): ATTACK->SUSTAIN");
 			}
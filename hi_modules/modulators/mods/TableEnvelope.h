@@ -103,6 +103,8 @@ public:
 	
 	void stopVoice(int voiceIndex) override;
 
+	bool supportsControlRate() const override { return true; }
+
 	void calculateBlock(int startSample, int numSamples) override;;
 
 	void reset(int voiceIndex) override
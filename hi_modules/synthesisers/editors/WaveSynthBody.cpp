@@ -50,6 +50,8 @@ WaveSynthBody::WaveSynthBody (ProcessorEditor *p)
     waveFormSelector->addItem (TRANS("Saw"), 3);
     waveFormSelector->addItem (TRANS("Square"), 4);
     waveFormSelector->addItem (TRANS("Noise"), 5);
+    waveFormSelector->addItem (TRANS("Saw (PolyBLEP)"), 7);
+    waveFormSelector->addItem (TRANS("Square (PolyBLEP)"), 8);
     waveFormSelector->addListener (this);
 
     addAndMakeVisible (waveformDisplay = new WaveformComponent());
@@ -114,6 +116,8 @@ WaveSynthBody::WaveSynthBody (ProcessorEditor *p)
     waveFormSelector2->addItem (TRANS("Saw"), 3);
     waveFormSelector2->addItem (TRANS("Square"), 4);
     waveFormSelector2->addItem (TRANS("Noise"), 5);
+    waveFormSelector2->addItem (TRANS("Saw (PolyBLEP)"), 7);
+    waveFormSelector2->addItem (TRANS("Square (PolyBLEP)"), 8);
     waveFormSelector2->addListener (this);
 
     addAndMakeVisible (waveformDisplay2 = new WaveformComponent());
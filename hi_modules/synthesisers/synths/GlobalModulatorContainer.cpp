@@ -61,12 +61,11 @@ float GlobalModulatorContainer::getVoiceStartValueFor(const Processor * /*voiceS
 
 const float * GlobalModulatorContainer::getModulationValuesForModulator(Processor *p, int startIndex, int voiceIndex /*= 0*/)
 {
-	for (int i = 0; i < data.size(); i++)
+	const int slotIndex = getSlotIndex(p);
+
+	if (slotIndex != -1)
 	{
-		if (data[i]->getProcessor() == p)
-		{
-			return data[i]->getModulationValues(startIndex, voiceIndex);
-		}
+		return getModulationValuesForSlot(slotIndex, startIndex, voiceIndex);
 	}
 
 	jassertfalse;
@@ -76,17 +75,31 @@ const float * GlobalModulatorContainer::getModulationValuesForModulator(Processo
 
 float GlobalModulatorContainer::getConstantVoiceValue(Processor *p, int noteNumber)
 {
+	const int slotIndex = getSlotIndex(p);
+
+	if (slotIndex != -1)
+	{
+		return getConstantVoiceValueForSlot(slotIndex, noteNumber);
+	}
+
+	jassertfalse;
+
+	return 1.0f;
+}
+
+int GlobalModulatorContainer::getSlotIndex(const Processor *p) const
+{
+	if (p == nullptr) return -1;
+
 	for (int i = 0; i < data.size(); i++)
 	{
 		if (data[i]->getProcessor() == p)
 		{
-			return data[i]->getConstantVoiceValue(noteNumber);
+			return i;
 		}
 	}
 
-	jassertfalse;
-
-	return 1.0f;
+	return -1;
 }
 
 ProcessorEditorBody* GlobalModulatorContainer::createEditor(ProcessorEditor *parentEditor)
@@ -128,14 +141,6 @@ void GlobalModulatorContainer::preStartVoice(int voiceIndex, int noteNumber)
 void GlobalModulatorContainer::postVoiceRendering(int startSample, int numThisTime)
 {
 	gainChain->renderNextBlock(gainBuffer, startSample, numThisTime);
-
-	for (int i = 0; i < data.size(); i++)
-	{
-		if (data[i]->getType() == GlobalModulator::TimeVariant)
-		{
-			data[i]->saveValuesToBuffer(startSample, numThisTime, 0);
-		}
-	}
 }
 
 void GlobalModulatorContainer::prepareToPlay(double newSampleRate, int samplesPerBlock)
@@ -215,14 +220,9 @@ modulator(modulator_)
 
 }
 
-void GlobalModulatorData::prepareToPlay(double /*sampleRate*/, int blockSize)
+void GlobalModulatorData::prepareToPlay(double /*sampleRate*/, int /*blockSize*/)
 {
-	switch (type)
-	{
-	case GlobalModulator::VoiceStart:	valuesForCurrentBuffer = AudioSampleBuffer(); return;
-	case GlobalModulator::TimeVariant:	valuesForCurrentBuffer = AudioSampleBuffer(1, blockSize);
-    case GlobalModulator::numTypes: break;
-	}
+	// The time variant values are read from the buffer of the modulator, so there is nothing to allocate here.
 }
 
 void GlobalModulatorData::saveValuesToBuffer(int startIndex, int numSamples, int voiceIndex /*= 0*/, int noteNumber/*=-1*/ )
@@ -232,7 +232,7 @@ void GlobalModulatorData::saveValuesToBuffer(int startIndex, int numSamples, int
 	switch (type)
 	{
 	case GlobalModulator::VoiceStart:	jassert(noteNumber != -1);  constantVoiceValues.set(noteNumber, static_cast<VoiceStartModulator*>(modulator.get())->getVoiceStartValue(voiceIndex)); break;
-	case GlobalModulator::TimeVariant:	FloatVectorOperations::copy(valuesForCurrentBuffer.getWritePointer(0, startIndex), static_cast<TimeVariantModulator*>(modulator.get())->getCalculatedValues(0) + startIndex, numSamples); break;
+	case GlobalModulator::TimeVariant:	ignoreUnused(startIndex, numSamples); break;
     case GlobalModulator::numTypes: break;
 	}
 }
@@ -242,7 +242,7 @@ const float * GlobalModulatorData::getModulationValues(int startIndex, int /*voi
 	switch (type)
 	{
 	case GlobalModulator::VoiceStart:	jassertfalse; return nullptr;
-	case GlobalModulator::TimeVariant:	return valuesForCurrentBuffer.getReadPointer(0, startIndex);
+	case GlobalModulator::TimeVariant:	return modulator.get() != nullptr ? static_cast<TimeVariantModulator*>(modulator.get())->getCalculatedValues(0) + startIndex : nullptr;
     case GlobalModulator::numTypes: return nullptr;
 	}
 
@@ -69,6 +69,8 @@ public:
 	/** Sets up the buffers depending on the type of the modulator. */
 	void prepareToPlay(double sampleRate, int blockSize);
 
+	/** Stores the voice start value for the note number. Time variant values are not copied but read directly
+	*	from the modulator in getModulationValues(). */
 	void saveValuesToBuffer(int startIndex, int numSamples, int voiceIndex = 0, int noteNumber=-1);
 	const float *getModulationValues(int startIndex, int voiceIndex = 0);
 	float getConstantVoiceValue(int noteNumber);
@@ -90,7 +92,6 @@ private:
 	GlobalModulator::ModulatorType type;
 
 	int numVoices;
-	AudioSampleBuffer valuesForCurrentBuffer;
 	Array<float> constantVoiceValues;
 };
 
@@ -112,6 +113,33 @@ public:
 	const float *getModulationValuesForModulator(Processor *p, int startIndex, int voiceIndex = 0);
 	float getConstantVoiceValue(Processor *p, int noteNumber);
 
+	/** Returns the index of the slot that holds the values of the given modulator or -1 if it isn't in this container.
+	*
+	*	This searches the list, so the GlobalModulators call it when they connect and then use the slot index.
+	*/
+	int getSlotIndex(const Processor *p) const;
+
+	/** Checks if the slot still belongs to the modulator. This is cheap enough to be called for every block. */
+	bool isSlotValid(int slotIndex, const Processor *p) const noexcept
+	{
+		return isPositiveAndBelow(slotIndex, data.size()) && data.getUnchecked(slotIndex)->getProcessor() == p;
+	}
+
+	/** Returns the values of the time variant modulator in the given slot. The pointer points directly into the buffer
+	*	of the modulator and is valid until the container renders the next block. */
+	const float *getModulationValuesForSlot(int slotIndex, int startIndex, int voiceIndex = 0)
+	{
+		jassert(isPositiveAndBelow(slotIndex, data.size()));
+		return data.getUnchecked(slotIndex)->getModulationValues(startIndex, voiceIndex);
+	}
+
+	/** Returns the value of the voice start modulator in the given slot for the note number. */
+	float getConstantVoiceValueForSlot(int slotIndex, int noteNumber)
+	{
+		jassert(isPositiveAndBelow(slotIndex, data.size()));
+		return data.getUnchecked(slotIndex)->getConstantVoiceValue(noteNumber);
+	}
+
 	ProcessorEditorBody* createEditor(ProcessorEditor *parentEditor) override;
 
 	void changeListenerCallback(SafeChangeBroadcaster *) { refreshList(); }
@@ -125,6 +153,9 @@ public:
 
 	void prepareToPlay(double sampleRate, int samplesPerBlock) override;
 
+	/** The modulation values must be calculated before the other synths of the chain are rendered. */
+	bool canBeRenderedInParallel() const override { return false; }
+
 private:
 
 	friend class GlobalModulatorContainerVoice;
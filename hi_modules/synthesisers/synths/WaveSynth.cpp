@@ -30,9 +30,9 @@
 *   ===========================================================================
 */
 
-float WaveSynthVoice::sinTable[2048];
+float WaveSynthKernels::sinTable[2048];
 
-Random WaveSynthVoice::noiseGenerator = Random();
+Random WaveSynthKernels::noiseGenerator = Random();
 
 ProcessorEditorBody* WaveSynth::createEditor(ProcessorEditor *parentEditor)
 {
@@ -46,6 +46,207 @@ public:
 	bool appliesToVelocity (int /*midiChannel*/) override  { return true; }
 };
 
+/** The oscillator block kernels of the WaveSynthVoice.
+*
+*	Every waveform is a struct with a static process() method that turns a block of phase values in the range [0...1)
+*	into the waveform (in place). The voice first writes the phase ramp of each oscillator into its output channel and
+*	then runs the kernels of the selected waveform pair over the block. The kernel for every combination of waveforms and
+*	for the pitch modulated / unmodulated case is a separate instantiation of processBlock(), which is resolved once when
+*	the waveform changes, so there are no function calls in the per sample loops and the compiler can vectorise them.
+*/
+class WaveSynthKernels
+{
+public:
+
+	typedef void(*BlockFunction)(float *outL, float *outR, double &phaseL, double &phaseR, double deltaL, double deltaR, const float *pitchValues, int numSamples);
+
+	/** Writes the phase of each sample into data and advances the phase accumulator (which is kept in the range [0...1)). */
+	template <bool PitchModulated> static void fillPhase(float *data, double &phase, double delta, const float *pitchValues, int numSamples)
+	{
+		double p = phase;
+
+		for (int i = 0; i < numSamples; i++)
+		{
+			data[i] = (float)p;
+
+			p += PitchModulated ? delta * (double)pitchValues[i] : delta;
+			p -= (double)(int)p;
+		}
+
+		phase = p;
+	}
+
+	struct Sine
+	{
+		template <bool PitchModulated> static void process(float *data, float /*delta*/, const float * /*pitchValues*/, int numSamples)
+		{
+			for (int i = 0; i < numSamples; i++)
+			{
+				const float phase = data[i] * 1024.0f;
+				const int index = (int)phase;
+				const float alpha = phase - (float)index;
+
+				data[i] = (1.0f - alpha) * sinTable[index] + alpha * sinTable[index + 1];
+			}
+		}
+	};
+
+	struct Triangle
+	{
+		template <bool PitchModulated> static void process(float *data, float /*delta*/, const float * /*pitchValues*/, int numSamples)
+		{
+			for (int i = 0; i < numSamples; i++)
+				data[i] = std::abs(4.0f * data[i] - 2.0f) - 1.0f;
+		}
+	};
+
+	struct Saw
+	{
+		template <bool PitchModulated> static void process(float *data, float delta, const float *pitchValues, int numSamples)
+		{
+			for (int i = 0; i < numSamples; i++)
+				data[i] = getBoxFilteredSaw(data[i], PitchModulated ? delta * pitchValues[i] : delta);
+		}
+	};
+
+	struct Square
+	{
+		template <bool PitchModulated> static void process(float *data, float delta, const float *pitchValues, int numSamples)
+		{
+			for (int i = 0; i < numSamples; i++)
+			{
+				const float d = PitchModulated ? delta * pitchValues[i] : delta;
+				const float shiftedPhase = data[i] + 0.5f;
+
+				data[i] = getBoxFilteredSaw(data[i], d) - getBoxFilteredSaw(shiftedPhase >= 1.0f ? shiftedPhase - 1.0f : shiftedPhase, d);
+			}
+		}
+	};
+
+	struct Noise
+	{
+		template <bool PitchModulated> static void process(float *data, float /*delta*/, const float * /*pitchValues*/, int numSamples)
+		{
+			for (int i = 0; i < numSamples; i++)
+				data[i] = noiseGenerator.nextFloat();
+		}
+	};
+
+	/** A naive saw with a polynomial band limited step (PolyBLEP) at the discontinuity. */
+	struct PolyBlepSaw
+	{
+		template <bool PitchModulated> static void process(float *data, float delta, const float *pitchValues, int numSamples)
+		{
+			for (int i = 0; i < numSamples; i++)
+				data[i] = getPolyBlepSaw(data[i], PitchModulated ? delta * pitchValues[i] : delta);
+		}
+	};
+
+	/** A square wave made of two PolyBLEP saws with half a cycle offset. */
+	struct PolyBlepSquare
+	{
+		template <bool PitchModulated> static void process(float *data, float delta, const float *pitchValues, int numSamples)
+		{
+			for (int i = 0; i < numSamples; i++)
+			{
+				const float d = PitchModulated ? delta * pitchValues[i] : delta;
+				const float shiftedPhase = data[i] + 0.5f;
+
+				data[i] = getPolyBlepSaw(data[i], d) - getPolyBlepSaw(shiftedPhase >= 1.0f ? shiftedPhase - 1.0f : shiftedPhase, d);
+			}
+		}
+	};
+
+	/** Renders a block of both oscillators. */
+	template <class LeftOscillator, class RightOscillator, bool PitchModulated>
+	static void processBlock(float *outL, float *outR, double &phaseL, double &phaseR, double deltaL, double deltaR, const float *pitchValues, int numSamples)
+	{
+		fillPhase<PitchModulated>(outL, phaseL, deltaL, pitchValues, numSamples);
+		fillPhase<PitchModulated>(outR, phaseR, deltaR, pitchValues, numSamples);
+
+		LeftOscillator::template process<PitchModulated>(outL, (float)deltaL, pitchValues, numSamples);
+		RightOscillator::template process<PitchModulated>(outR, (float)deltaR, pitchValues, numSamples);
+	}
+
+	/** Returns the kernel for the given waveform pair. Unknown waveforms use the square wave. */
+	static BlockFunction getBlockFunction(WaveformComponent::WaveformType left, WaveformComponent::WaveformType right, bool pitchModulated)
+	{
+		switch (left)
+		{
+		case WaveformComponent::Sine:			return getBlockFunctionWithLeft<Sine>(right, pitchModulated);
+		case WaveformComponent::Triangle:		return getBlockFunctionWithLeft<Triangle>(right, pitchModulated);
+		case WaveformComponent::Saw:			return getBlockFunctionWithLeft<Saw>(right, pitchModulated);
+		case WaveformComponent::Noise:			return getBlockFunctionWithLeft<Noise>(right, pitchModulated);
+		case WaveformComponent::PolyBlepSaw:	return getBlockFunctionWithLeft<PolyBlepSaw>(right, pitchModulated);
+		case WaveformComponent::PolyBlepSquare:	return getBlockFunctionWithLeft<PolyBlepSquare>(right, pitchModulated);
+		default:								return getBlockFunctionWithLeft<Square>(right, pitchModulated);
+		}
+	}
+
+	static float getBoxFilteredSaw(float phase, float kernelSize) noexcept
+	{
+		// Remap phase and kernelSize from [0.0, 1.0] to [-1.0, 1.0]
+		const float k = 2.0f * kernelSize;
+		const float x = 2.0f * phase - 1.0f;
+
+		// Integrate over the kernel and divide with kernelSize. If the kernel wraps around the edge, the integral
+		// contains the jump back to -1.0 (otherwise it simplifies to the centre of the kernel).
+		return (x + k > 1.0f) ? (k - 2.0f) * (2.0f * x + k - 2.0f) / (2.0f * k) : x + 0.5f * k;
+	}
+
+	static float getPolyBlepSaw(float phase, float delta) noexcept
+	{
+		const float t1 = phase / delta;
+		const float t2 = (phase - 1.0f) / delta;
+
+		const float blepAfterJump = t1 + t1 - t1 * t1 - 1.0f;
+		const float blepBeforeJump = t2 * t2 + t2 + t2 + 1.0f;
+
+		const float blep = (phase < delta) ? blepAfterJump : ((phase > 1.0f - delta) ? blepBeforeJump : 0.0f);
+
+		return 2.0f * phase - 1.0f - blep;
+	}
+
+	static void initSinTable()
+	{
+		for (int i = 0; i < 2048; i++)
+		{
+			const float deltaX = (float)i * (2.0f * float_Pi) / 1024.0f;
+			sinTable[i] = sinf(deltaX);
+		}
+	};
+
+	/** Sets the seed of the noise generator that is shared by all WaveSynths. This is used for deterministic renders. */
+	static void setNoiseSeed(int64 seed) { noiseGenerator.setSeed(seed); }
+
+private:
+
+	template <class LeftOscillator> static BlockFunction getBlockFunctionWithLeft(WaveformComponent::WaveformType right, bool pitchModulated)
+	{
+		switch (right)
+		{
+		case WaveformComponent::Sine:			return getBlockFunctionForPair<LeftOscillator, Sine>(pitchModulated);
+		case WaveformComponent::Triangle:		return getBlockFunctionForPair<LeftOscillator, Triangle>(pitchModulated);
+		case WaveformComponent::Saw:			return getBlockFunctionForPair<LeftOscillator, Saw>(pitchModulated);
+		case WaveformComponent::Noise:			return getBlockFunctionForPair<LeftOscillator, Noise>(pitchModulated);
+		case WaveformComponent::PolyBlepSaw:	return getBlockFunctionForPair<LeftOscillator, PolyBlepSaw>(pitchModulated);
+		case WaveformComponent::PolyBlepSquare:	return getBlockFunctionForPair<LeftOscillator, PolyBlepSquare>(pitchModulated);
+		default:								return getBlockFunctionForPair<LeftOscillator, Square>(pitchModulated);
+		}
+	}
+
+	template <class LeftOscillator, class RightOscillator> static BlockFunction getBlockFunctionForPair(bool pitchModulated)
+	{
+		if (pitchModulated) return &processBlock<LeftOscillator, RightOscillator, true>;
+		else				return &processBlock<LeftOscillator, RightOscillator, false>;
+	}
+
+	// Two cycles, so that the interpolation never needs to wrap the index.
+	static float sinTable[2048];
+
+	static Random noiseGenerator;
+};
+
 class WaveSynthVoice: public ModulatorSynthVoice
 {
 public:
@@ -53,12 +254,16 @@ public:
 	WaveSynthVoice(ModulatorSynth *ownerSynth):
 		ModulatorSynthVoice(ownerSynth),
 		octaveTransposeFactor1(1.0),
-		octaveTransposeFactor2(1.0)
+		octaveTransposeFactor2(1.0),
+		uptimeDelta2(0.0),
+		voiceUptime2(0.0),
+		type1(WaveformComponent::Saw),
+		type2(WaveformComponent::Saw)
 	{
 		setWaveForm(WaveformComponent::Saw, true);
 		setWaveForm(WaveformComponent::Saw, false);
 
-		initSinTable(sinTable);
+		WaveSynthKernels::initSinTable();
 		
 	};
 
@@ -95,52 +300,17 @@ public:
 		float *outL = voiceBuffer.getWritePointer(0, startSample);
 		float *outR = voiceBuffer.getWritePointer(1, startSample);
 
+		const double deltaL = uptimeDelta * octaveTransposeFactor1;
+		const double deltaR = uptimeDelta2 * octaveTransposeFactor2;
+
 		if (voicePitchValues != nullptr)
 		{
-			voicePitchValues += startSample;
-
-			while (numSamples > 0)
-			{
-				for (int i = 0; i < 4; i++)
-				{
-					const float currentSample = getLeftSample(voiceUptime, uptimeDelta);
-					const float currentSample2 = getRightSample(voiceUptime2, uptimeDelta2);
-
-					*outL++ = currentSample;
-					*outR++ = currentSample2;
-
-					voiceUptime += (uptimeDelta * *voicePitchValues * octaveTransposeFactor1);
-					voiceUptime2 += (uptimeDelta2 * *voicePitchValues++ * octaveTransposeFactor2);
-
-					
-				}
-
-				numSamples -= 4;
-			}
+			pitchModulatedBlockFunction(outL, outR, voiceUptime, voiceUptime2, deltaL, deltaR, voicePitchValues + startSample, numSamples);
 		}
 		else
 		{
-			while (numSamples > 0)
-			{
-				for (int i = 0; i < 4; i++)
-				{
-					const float currentSample = getLeftSample(voiceUptime, uptimeDelta);
-					const float currentSample2 = getRightSample(voiceUptime2, uptimeDelta2);
-
-					*outL++ = currentSample;
-					*outR++ = currentSample2;
-
-					voiceUptime += (uptimeDelta * octaveTransposeFactor1);
-					voiceUptime2 += (uptimeDelta2 * octaveTransposeFactor2);
-
-					
-				}
-
-				numSamples -= 4;
-			}
+			blockFunction(outL, outR, voiceUptime, voiceUptime2, deltaL, deltaR, nullptr, numSamples);
 		}
-	
-			
 
 		getOwnerSynth()->effectChain->renderVoice(voiceIndex, voiceBuffer, startIndex, samplesToCopy);
 
@@ -148,105 +318,24 @@ public:
 		FloatVectorOperations::multiply(voiceBuffer.getWritePointer(1, startIndex), modValues + startIndex, samplesToCopy);
 	};
 
+	/** Sets the octave factor. This must be called on the audio thread (the WaveSynth does this with a queued command). */
 	void setOctaveTransposeFactor(double newFactor, bool leftFactor)
 	{
-		ScopedLock sl(getOwnerSynth()->getSynthLock());
-
 		if(leftFactor) octaveTransposeFactor1 = newFactor;
 		else octaveTransposeFactor2 = newFactor;
 	}
 
 	void setWaveForm(WaveformComponent::WaveformType type, bool left)
 	{
-		switch(type)
-		{
-		case WaveformComponent::Saw:	left ? (getLeftSample = &getSaw) :
-											   (getRightSample = &getSaw); break;
-		case WaveformComponent::Sine:	left ? (getLeftSample = &getSine) :
-											   (getRightSample = &getSine); break;
-		case WaveformComponent::Triangle:	left ? (getLeftSample = &getTriangle) :
-												   (getRightSample = &getTriangle); break;
-		case WaveformComponent::Noise:	left ? (getLeftSample = &getNoise):
-											   (getRightSample = &getNoise); break;
-		default:						left ? (getLeftSample = &getPulse) :
-											   (getRightSample = &getPulse); break;
-
+		if (left) type1 = type;
+		else type2 = type;
 
-		}
+		blockFunction = WaveSynthKernels::getBlockFunction(type1, type2, false);
+		pitchModulatedBlockFunction = WaveSynthKernels::getBlockFunction(type1, type2, true);
 	}
 
 private:
 
-	static float getSaw(double voiceUptime, double uptimeDelta)
-	{
-		const double phase = fmod(voiceUptime, 1.0);
-		return getBoxFilteredSaw(phase, uptimeDelta);
-	};
-
-	static float getTriangle(double voiceUptime, double /*uptimeDelta*/)
-	{
-		const double phase = fmod(voiceUptime, 1.0) * 4.0;
-
-		return (float)fabs(fmod(phase, 4.0) - 2.0) - 1.0f;
-	};
-
-	static float getNoise(double /*voiceUptime*/, double /*uptimeDelta*/)
-	{
-		return noiseGenerator.nextFloat();
-	}
-
-	static float getPulse(double voiceUptime, double uptimeDelta)
-	{
-		const double pulseWidth = 0.5;
-		const double phase = fmod(voiceUptime, 1.0);
-		return getBoxFilteredSaw(phase, uptimeDelta) - getBoxFilteredSaw(fmod(phase + pulseWidth, 1.0), uptimeDelta);
-	}
-
-	static float getSine(double voiceUptime, double /*uptimeDelta*/)
-	{
-		const double phase = fmod(voiceUptime, 1.0) * 1024.0;
-
-		int index = (int)phase;
-            
-		float v1 = sinTable[index & 2047];
-		float v2 = sinTable[(index +1) & 2047];
-
-		const float alpha = float(phase) - (float)index;
-		const float invAlpha = 1.0f - alpha;
-
-		const float currentSample = invAlpha * v1 + alpha * v2;
-
-		return currentSample;
-	}
-
-	static float getBoxFilteredSaw(double phase, double kernelSize) 
-	{
-		double a, b;
-
-		// Remap phase and kernelSize from [0.0, 1.0] to [-1.0, 1.0]
-		kernelSize *= 2.0;
-		phase = phase * 2.0 - 1.0;
-
-		if (phase + kernelSize > 1.0)
-		{
-			// Kernel wraps around edge of [-1.0, 1.0]
-			a = phase;
-			b = phase + kernelSize - 2.0;
-		}
-		else
-		{
-			// Kernel fits nicely in [-1.0, 1.0]
-			a = phase;
-			b = phase + kernelSize;
-		}
-
-		// Integrate and divide with kernelSize
-		return (float)((b * b - a * a) / (2.0 * kernelSize));
-	};
-
-	float (*getLeftSample)(double, double);
-	float (*getRightSample)(double, double);
-
 	double octaveTransposeFactor1, octaveTransposeFactor2;
 
 	double uptimeDelta2;
@@ -255,19 +344,8 @@ private:
 
 	WaveformComponent::WaveformType type1, type2;
 
-	static float sinTable[2048];
-
-	static Random noiseGenerator;
-
-	static void initSinTable(float *sin)
-	{
-		for(int i = 0; i < 2048; i++)
-		{
-			const float deltaX = (float)i * (2.0f * float_Pi) / 1024.0f;
-			sin[i] = sinf(deltaX);
-
-		}
-	};
+	WaveSynthKernels::BlockFunction blockFunction;
+	WaveSynthKernels::BlockFunction pitchModulatedBlockFunction;
 };
 
 class WaveSynth: public ModulatorSynth
@@ -284,11 +362,11 @@ public:
 	enum SpecialParameters
 	{
 		OctaveTranspose1 = ModulatorSynth::numModulatorSynthParameters, ///< -5 ... **0** ... 5 | The octave transpose factor for the first Oscillator.
-		WaveForm1, ///< Sine, Triangle, **Saw**, Square, Noise | the waveform type
+		WaveForm1, ///< Sine, Triangle, **Saw**, Square, Noise, Saw (PolyBLEP), Square (PolyBLEP) | the waveform type
 		Detune1, ///< -100ct ... **0.0ct** ... 100ct | The pitch detune of the first oscillator in cent (100 cent = 1 semitone).
 		Pan1, ///< -100 ... **0** ... 100 | the stereo panning of the first oscillator
 		OctaveTranspose2, ///< -5 ... **0** ... 5 | the octave transpose factor for the first oscillator
-		WaveForm2, ///< Sine, Triangle, **Saw**, Square, Noise | the waveform type
+		WaveForm2, ///< Sine, Triangle, **Saw**, Square, Noise, Saw (PolyBLEP), Square (PolyBLEP) | the waveform type
 		Detune2, ///< -100ct ... **0ct** ... 100ct | the pitch detune of the first oscillator in cent (100 cent = 1 semitone)
 		Pan2, ///< -100 ... **0** ... 100 | the stereo panning of the first oscillator
 		Mix, ///< 0 ... **50%** ... 100% | the balance between the two oscillators (0% is only the left oscillator, while 100% is the right oscillator). This can be modulated using the Mix Modulation chain (if there are some Modulators, this control will be disabled.
@@ -547,9 +625,16 @@ private:
 
 	void refreshPitchValues(bool left)
 	{
-		for(int i = 0; i < getNumVoices(); i++) 
+		callOnAudioThread(applyPitchValue, getPitchValue(left), left ? 1 : 0);
+	}
+
+	static void applyPitchValue(void *synth, double factor, int left, const void*)
+	{
+		WaveSynth *s = static_cast<WaveSynth*>(static_cast<ModulatorSynth*>(synth));
+
+		for(int i = 0; i < s->getNumVoices(); i++) 
 		{
-			static_cast<WaveSynthVoice*>(getVoice(i))->setOctaveTransposeFactor(getPitchValue(left), left);
+			static_cast<WaveSynthVoice*>(s->getVoice(i))->setOctaveTransposeFactor(factor, left != 0);
 		}
 	}
 
@@ -0,0 +1,265 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licences for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licencing:
+*
+*   http://www.hartinstruments.net/hise/
+*
+*   HISE is based on the JUCE library,
+*   which also must be licenced for commercial applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+#include "JuceHeader.h"
+
+class WaveSynthUnitTest : public UnitTest
+{
+public:
+
+	WaveSynthUnitTest() :
+		UnitTest("Testing WaveSynth oscillator kernels")
+	{
+
+	}
+
+	void runTest() override
+	{
+		WaveSynthKernels::initSinTable();
+
+		testAgainstPerSampleOscillators();
+		testPolyBlepSaw();
+		testSpeed();
+	}
+
+private:
+
+	/** The per sample oscillators that the kernels replace. */
+	struct Reference
+	{
+		static float getSaw(double voiceUptime, double uptimeDelta)
+		{
+			return getBoxFilteredSaw(fmod(voiceUptime, 1.0), uptimeDelta);
+		}
+
+		static float getTriangle(double voiceUptime, double /*uptimeDelta*/)
+		{
+			const double phase = fmod(voiceUptime, 1.0) * 4.0;
+			return (float)fabs(fmod(phase, 4.0) - 2.0) - 1.0f;
+		}
+
+		static float getPulse(double voiceUptime, double uptimeDelta)
+		{
+			const double phase = fmod(voiceUptime, 1.0);
+			return getBoxFilteredSaw(phase, uptimeDelta) - getBoxFilteredSaw(fmod(phase + 0.5, 1.0), uptimeDelta);
+		}
+
+		static float getSine(double voiceUptime, double /*uptimeDelta*/)
+		{
+			return (float)std::sin(2.0 * double_Pi * fmod(voiceUptime, 1.0));
+		}
+
+		static float getBoxFilteredSaw(double phase, double kernelSize)
+		{
+			kernelSize *= 2.0;
+			phase = phase * 2.0 - 1.0;
+
+			const double a = phase;
+			const double b = (phase + kernelSize > 1.0) ? phase + kernelSize - 2.0 : phase + kernelSize;
+
+			return (float)((b * b - a * a) / (2.0 * kernelSize));
+		}
+
+		static void render(float(*f)(double, double), float *data, double &uptime, double delta, const float *pitchValues, int numSamples)
+		{
+			// The kernels use the pitch modulated delta as filter size (the old voice used the unmodulated one).
+			for (int i = 0; i < numSamples; i++)
+			{
+				const double d = delta * (pitchValues != nullptr ? pitchValues[i] : 1.0f);
+
+				data[i] = f(uptime, d);
+				uptime += d;
+			}
+		}
+	};
+
+	float getMaxError(const float *a, const float *b, int numSamples)
+	{
+		float maxError = 0.0f;
+
+		for (int i = 0; i < numSamples; i++)
+			maxError = jmax<float>(maxError, std::abs(a[i] - b[i]));
+
+		return maxError;
+	}
+
+	void testAgainstPerSampleOscillators()
+	{
+		beginTest("Comparing the kernels with the per sample oscillators");
+
+		const int numSamples = 4000;
+
+		HeapBlock<float> pitchValues(numSamples);
+
+		for (int i = 0; i < numSamples; i++)
+			pitchValues[i] = 1.0f + 0.5f * std::sin((float)i * 0.003f);
+
+		HeapBlock<float> expectedL(numSamples), expectedR(numSamples), actualL(numSamples), actualR(numSamples);
+
+		const double deltaL = 0.0123;
+		const double deltaR = 0.0456;
+
+		for (int m = 0; m < 2; m++)
+		{
+			const bool modulated = m == 1;
+			const float *pitch = modulated ? pitchValues.getData() : nullptr;
+			const String suffix = modulated ? " (pitch modulated)" : "";
+
+			double uptimeL = 0.0, uptimeR = 0.0, phaseL = 0.0, phaseR = 0.0;
+
+			Reference::render(&Reference::getSaw, expectedL, uptimeL, deltaL, pitch, numSamples);
+			Reference::render(&Reference::getSine, expectedR, uptimeR, deltaR, pitch, numSamples);
+			WaveSynthKernels::getBlockFunction(WaveformComponent::Saw, WaveformComponent::Sine, modulated)(actualL, actualR, phaseL, phaseR, deltaL, deltaR, pitch, numSamples);
+
+			expect(getMaxError(expectedL, actualL, numSamples) < 0.002f, "Saw" + suffix);
+			expect(getMaxError(expectedR, actualR, numSamples) < 0.002f, "Sine" + suffix);
+
+			uptimeL = uptimeR = phaseL = phaseR = 0.0;
+
+			Reference::render(&Reference::getTriangle, expectedL, uptimeL, deltaL, pitch, numSamples);
+			Reference::render(&Reference::getPulse, expectedR, uptimeR, deltaR, pitch, numSamples);
+			WaveSynthKernels::getBlockFunction(WaveformComponent::Triangle, WaveformComponent::Square, modulated)(actualL, actualR, phaseL, phaseR, deltaL, deltaR, pitch, numSamples);
+
+			expect(getMaxError(expectedL, actualL, numSamples) < 0.002f, "Triangle" + suffix);
+			expect(getMaxError(expectedR, actualR, numSamples) < 0.002f, "Square" + suffix);
+		}
+	}
+
+	void testPolyBlepSaw()
+	{
+		beginTest("Testing the PolyBLEP saw");
+
+		const float delta = 0.01f;
+
+		float maxDeviation = 0.0f;
+		float maxStep = 0.0f;
+		float lastValue = WaveSynthKernels::getPolyBlepSaw(0.0f, delta);
+
+		for (int i = 1; i < 1000; i++)
+		{
+			const float phase = (float)i / 1000.0f;
+			const float value = WaveSynthKernels::getPolyBlepSaw(phase, delta);
+
+			if (phase > delta && phase < 1.0f - delta)
+				maxDeviation = jmax<float>(maxDeviation, std::abs(value - (2.0f * phase - 1.0f)));
+
+			maxStep = jmax<float>(maxStep, std::abs(value - lastValue));
+			lastValue = value;
+		}
+
+		expect(maxDeviation < 0.0001f, "Naive saw outside of the discontinuity");
+
+		// The naive saw jumps by 2.0, the corrected saw spreads the jump over two samples.
+		expect(maxStep < 1.5f, "Smoothed discontinuity: " + String(maxStep));
+	}
+
+	void testSpeed()
+	{
+		beginTest("Measuring 64 voices with two saw oscillators");
+
+		const int numVoices = 64;
+		const int blockSize = 512;
+		const int numBlocks = 200;
+
+		AudioSampleBuffer buffer(2, blockSize);
+		HeapBlock<float> pitchValues(blockSize);
+
+		for (int i = 0; i < blockSize; i++)
+			pitchValues[i] = 1.0f + 0.01f * (float)i / (float)blockSize;
+
+		double uptimes[numVoices * 2];
+		double deltas[numVoices];
+
+		for (int v = 0; v < numVoices; v++)
+			deltas[v] = 0.005 + 0.0001 * (double)v;
+
+		for (int m = 0; m < 2; m++)
+		{
+			const bool modulated = m == 1;
+			const float *pitch = modulated ? pitchValues.getData() : nullptr;
+
+			// the old voice loop: one function pointer call per sample and oscillator
+			float(*getLeftSample)(double, double) = &Reference::getSaw;
+			float(*getRightSample)(double, double) = &Reference::getSaw;
+
+			zeromem(uptimes, sizeof(uptimes));
+
+			double start = Time::getMillisecondCounterHiRes();
+
+			for (int b = 0; b < numBlocks; b++)
+			{
+				for (int v = 0; v < numVoices; v++)
+				{
+					float *outL = buffer.getWritePointer(0);
+					float *outR = buffer.getWritePointer(1);
+
+					double &uptimeL = uptimes[2 * v];
+					double &uptimeR = uptimes[2 * v + 1];
+
+					for (int i = 0; i < blockSize; i++)
+					{
+						outL[i] = getLeftSample(uptimeL, deltas[v]);
+						outR[i] = getRightSample(uptimeR, deltas[v]);
+
+						const double pitchFactor = modulated ? (double)pitch[i] : 1.0;
+
+						uptimeL += deltas[v] * pitchFactor * 1.0;
+						uptimeR += deltas[v] * pitchFactor * 2.0;
+					}
+				}
+			}
+
+			const double perSampleTime = Time::getMillisecondCounterHiRes() - start;
+
+			WaveSynthKernels::BlockFunction f = WaveSynthKernels::getBlockFunction(WaveformComponent::Saw, WaveformComponent::Saw, modulated);
+
+			zeromem(uptimes, sizeof(uptimes));
+
+			start = Time::getMillisecondCounterHiRes();
+
+			for (int b = 0; b < numBlocks; b++)
+			{
+				for (int v = 0; v < numVoices; v++)
+				{
+					f(buffer.getWritePointer(0), buffer.getWritePointer(1), uptimes[2 * v], uptimes[2 * v + 1], deltas[v], deltas[v] * 2.0, pitch, blockSize);
+				}
+			}
+
+			const double kernelTime = Time::getMillisecondCounterHiRes() - start;
+
+			logMessage(String(modulated ? "Pitch modulated: " : "Unmodulated: ") +
+					   "per sample: " + String(perSampleTime, 1) + " ms, kernels: " + String(kernelTime, 1) + " ms, speedup: " + String(perSampleTime / kernelTime, 2) + "x");
+		}
+	}
+};
+
+static WaveSynthUnitTest waveSynthUnitTest;
@@ -877,14 +877,9 @@ public:
 		{
 		case HqMode:
 			{
-				ScopedLock sl(getSynthLock());
-
 				hqMode = newValue == 1.0f;
 
-				for(int i = 0; i < getNumVoices(); i++)
-				{
-					static_cast<WavetableSynthVoice*>(getVoice(i))->setHqMode(hqMode);
-				}
+				callOnAudioThread(applyHqMode, hqMode ? 1.0 : 0.0);
 				break;
 			}
 		default:					jassertfalse;
@@ -896,6 +891,16 @@ public:
 
 private:
 
+	static void applyHqMode(void *synth, double useHqMode, int, const void*)
+	{
+		WavetableSynth *s = static_cast<WavetableSynth*>(static_cast<ModulatorSynth*>(synth));
+
+		for(int i = 0; i < s->getNumVoices(); i++)
+		{
+			static_cast<WavetableSynthVoice*>(s->getVoice(i))->setHqMode(useHqMode == 1.0);
+		}
+	}
+
 	bool hqMode;
 
 	ScopedPointer<SampleLookupTable> gainTable;
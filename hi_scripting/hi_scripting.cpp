@@ -50,12 +50,14 @@
 #include "scripting/engine/JavascriptEngineStatements.cpp"
 #include "scripting/engine/JavascriptEngineOperators.cpp"
 #include "scripting/engine/JavascriptEngineCustom.cpp"
+#include "scripting/engine/JavascriptEngineBytecode.cpp"
 #include "scripting/engine/JavascriptEngineParser.cpp"
 #include "scripting/engine/JavascriptEngineObjects.cpp"
 #include "scripting/engine/JavascriptEngineMathObject.cpp"
 #include "scripting/engine/JavascriptEngineAdditionalMethods.cpp"
 
 #include "scripting/api/XmlApi.cpp"
+#include "scripting/api/ScriptDisplayList.cpp"
 #include "scripting/api/ScriptingApiObjects.cpp"
 #include "scripting/api/ScriptingApi.cpp"
 #include "scripting/api/ScriptingApiWrappers.cpp"
@@ -154,7 +154,7 @@ void JavascriptMidiProcessor::processHiseEvent(HiseEvent &m)
 	}
 	else
 	{
-		ADD_GLITCH_DETECTOR("Processing " + getId() + " script callbacks");
+		ADD_GLITCH_DETECTOR(this, "Processing " + getId() + " script callbacks");
 
 		if (currentMidiMessage != nullptr)
 		{
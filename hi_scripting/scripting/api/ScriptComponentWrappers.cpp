@@ -521,7 +521,8 @@ void ScriptCreatedComponentWrappers::ImageWrapper::mouseCallback(const var &mous
 }
 
 ScriptCreatedComponentWrappers::PanelWrapper::PanelWrapper(ScriptContentComponent *content, ScriptingApi::Content::ScriptPanel *panel, int index) :
-ScriptCreatedComponentWrapper(content, index)
+ScriptCreatedComponentWrapper(content, index),
+scriptPanel(panel)
 {
 	BorderPanel *bp = new BorderPanel();
 
@@ -533,6 +534,8 @@ ScriptCreatedComponentWrapper(content, index)
 
     bp->setOpaque(panel->getScriptObjectProperty(ScriptingApi::Content::ScriptPanel::opaque));
     
+	panel->addCanvasListener(this);
+
 	component = bp;
 }
 
@@ -546,7 +549,9 @@ void ScriptCreatedComponentWrappers::PanelWrapper::updateComponent()
 	bpc->borderColour = GET_OBJECT_COLOUR(textColour);
 	bpc->borderRadius = getScriptComponent()->getScriptObjectProperty(ScriptingApi::Content::ScriptPanel::borderRadius);
 	bpc->borderSize = getScriptComponent()->getScriptObjectProperty(ScriptingApi::Content::ScriptPanel::borderSize);
-	bpc->image = dynamic_cast<ScriptingApi::Content::ScriptPanel*>(getScriptComponent())->getImage();
+	sc->updateCanvas();
+
+	bpc->image = sc->getImage();
 	bpc->isUsingCustomImage = sc->isUsingCustomPaintRoutine();
 	bpc->setPopupMenuItems(sc->getItemList());
 	bpc->setUseRightClickForPopup(sc->getScriptObjectProperty(ScriptingApi::Content::ScriptPanel::PopupOnRightClick));
@@ -587,6 +592,25 @@ ScriptCreatedComponentWrappers::PanelWrapper::~PanelWrapper()
 
 	bpc->removeCallbackListener(this);
 	
+	if (scriptPanel.get() != nullptr)
+	{
+		scriptPanel->removeCanvasListener(this);
+	}
+}
+
+void ScriptCreatedComponentWrappers::PanelWrapper::canvasChanged(const Rectangle<int> &changedArea)
+{
+	BorderPanel *bpc = dynamic_cast<BorderPanel*>(component.get());
+
+	// The BorderPanel shares the image with the canvas, so it just needs to repaint the changed area
+	if (scriptPanel.get() != nullptr && bpc->getLocalBounds() == scriptPanel->getPosition().withZeroOrigin())
+	{
+		bpc->repaint(changedArea);
+	}
+	else
+	{
+		bpc->repaint();
+	}
 }
 
 ScriptCreatedComponentWrappers::SliderPackWrapper::SliderPackWrapper(ScriptContentComponent *content, ScriptingApi::Content::ScriptSliderPack *pack, int index) :
@@ -385,7 +385,8 @@ public:
 
 	class PanelWrapper : public ScriptCreatedComponentWrapper,
                          public MouseCallbackComponent::Listener,
-						 public MouseCallbackComponent::RectangleConstrainer::Listener
+						 public MouseCallbackComponent::RectangleConstrainer::Listener,
+						 public ScriptingApi::Content::ScriptPanel::CanvasListener
 	{
 	public:
 
@@ -398,6 +399,12 @@ public:
 
 		void boundsChanged(const Rectangle<int> &newBounds) override;
 
+		void canvasChanged(const Rectangle<int> &changedArea) override;
+
+	private:
+
+		WeakReference<ScriptingApi::Content::ScriptPanel> scriptPanel;
+
 		JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PanelWrapper)
 	};
 
@@ -0,0 +1,290 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licences for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licencing:
+*
+*   http://www.hartinstruments.net/hise/
+*
+*   HISE is based on the JUCE library,
+*   which also must be licenced for commercial applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+void ScriptDrawAction::perform(Graphics &g, Image &canvas, float scaleFactor) const
+{
+	switch (type)
+	{
+	case FillAll:				g.fillAll(colour); break;
+	case FillRect:				g.fillRect(area); break;
+	case DrawRect:				g.drawRect(area, lineThickness); break;
+	case FillRoundedRectangle:	g.fillRoundedRectangle(area, cornerSize); break;
+	case DrawRoundedRectangle:	g.drawRoundedRectangle(area, cornerSize, lineThickness); break;
+	case DrawHorizontalLine:	g.drawHorizontalLine((int)area.getY(), area.getX(), area.getRight()); break;
+	case DrawLine:				g.drawLine(line, lineThickness); break;
+	case DrawText:
+		g.setFont(font);
+		g.drawText(text, area, Justification::centred);
+		break;
+	case DrawEllipse:			g.drawEllipse(area, lineThickness); break;
+	case FillEllipse:			g.fillEllipse(area); break;
+	case DrawImage:
+		g.drawImage(image, (int)area.getX(), (int)area.getY(), (int)area.getWidth(), (int)area.getHeight(),
+					sourceArea.getX(), sourceArea.getY(), sourceArea.getWidth(), sourceArea.getHeight());
+		break;
+	case DrawDropShadow:
+	{
+		DropShadow shadow;
+
+		shadow.colour = colour;
+		shadow.radius = radius;
+
+		shadow.drawForRectangle(g, area.toNearestInt());
+		break;
+	}
+	case StrokePath:			g.strokePath(path, PathStrokeType(lineThickness)); break;
+	case FillPath:				g.fillPath(path); break;
+	case SetColour:				g.setColour(colour); break;
+	case SetGradientFill:		g.setGradientFill(gradient); break;
+	case SetFont:				g.setFont(font); break;
+	case SetOpacity:			g.setOpacity(opacity); break;
+	case AddDropShadowFromAlpha:
+	{
+		DropShadow shadow;
+
+		shadow.colour = colour;
+		shadow.radius = radius;
+
+		Graphics g2(canvas);
+
+		g2.addTransform(AffineTransform::scale(1.0f / scaleFactor));
+
+		shadow.drawForImage(g2, canvas);
+		break;
+	}
+	case numTypes:
+		jassertfalse;
+		break;
+	}
+}
+
+bool ScriptDrawAction::isSameAs(const ScriptDrawAction &other) const
+{
+	return type == other.type &&
+		   area == other.area &&
+		   line == other.line &&
+		   lineThickness == other.lineThickness &&
+		   cornerSize == other.cornerSize &&
+		   opacity == other.opacity &&
+		   radius == other.radius &&
+		   colour == other.colour &&
+		   gradient == other.gradient &&
+		   font == other.font &&
+		   text == other.text &&
+		   path == other.path &&
+		   image == other.image &&
+		   sourceArea == other.sourceArea;
+}
+
+ScriptDrawAction::Scope ScriptDrawAction::getScope() const noexcept
+{
+	switch (type)
+	{
+	case SetColour:
+	case SetGradientFill:
+	case SetFont:
+	case SetOpacity:				return Scope::State;
+	case FillAll:
+	case AddDropShadowFromAlpha:	return Scope::Canvas;
+	default:						return Scope::Area;
+	}
+}
+
+Rectangle<float> ScriptDrawAction::getBounds() const
+{
+	switch (type)
+	{
+	case DrawRect:
+	case DrawRoundedRectangle:
+	case DrawEllipse:		return area.expanded(lineThickness);
+	case DrawLine:			return Rectangle<float>(line.getStart(), line.getEnd()).expanded(lineThickness);
+	case DrawDropShadow:	return area.expanded((float)radius);
+	case StrokePath:		return path.getBounds().expanded(lineThickness);
+	case FillPath:			return path.getBounds();
+	default:				return area;
+	}
+}
+
+// ====================================================================================================================
+
+ScriptDisplayList::ScriptDisplayList() :
+	canvasScaleFactor(1.0f)
+{}
+
+void ScriptDisplayList::startRecording()
+{
+	recordedActions.clear();
+}
+
+void ScriptDisplayList::addAction(ScriptDrawAction *newAction)
+{
+	recordedActions.add(newAction);
+}
+
+Rectangle<int> ScriptDisplayList::commit(int width, int height, float scaleFactor)
+{
+	const bool newCanvas = prepareCanvas(width, height, scaleFactor);
+
+	bool entireCanvasChanged = newCanvas;
+
+	const Rectangle<float> changedArea = newCanvas ? Rectangle<float>() : getChangedArea(actions, recordedActions, entireCanvasChanged);
+
+	actions.swapWith(recordedActions);
+	recordedActions.clear();
+
+	if (!canvas.isValid())
+		return Rectangle<int>();
+
+	if (entireCanvasChanged)
+	{
+		drawIntoCanvas(canvas.getBounds());
+
+		return Rectangle<int>(0, 0, width, height);
+	}
+
+	if (changedArea.isEmpty())
+		return Rectangle<int>();
+
+	// One pixel more for the antialiased edges
+	const Rectangle<int> pixelArea = (changedArea.expanded(1.0f) * scaleFactor).getSmallestIntegerContainer().getIntersection(canvas.getBounds());
+
+	if (pixelArea.isEmpty())
+		return Rectangle<int>();
+
+	drawIntoCanvas(pixelArea);
+
+	return (pixelArea.toFloat() / scaleFactor).getSmallestIntegerContainer().getIntersection(Rectangle<int>(0, 0, width, height));
+}
+
+void ScriptDisplayList::replay(int width, int height, float scaleFactor)
+{
+	canvas = Image();
+
+	prepareCanvas(width, height, scaleFactor);
+
+	if (canvas.isValid())
+		drawIntoCanvas(canvas.getBounds());
+}
+
+Rectangle<float> ScriptDisplayList::getChangedArea(const OwnedArray<ScriptDrawAction> &oldList, const OwnedArray<ScriptDrawAction> &newList, bool &entireCanvasChanged)
+{
+	Rectangle<float> changedArea;
+
+	bool anythingChanged = false;
+	bool needsEntireCanvas = false;
+
+	// Once a state action differs, all following actions may draw differently even if their parameters are the same
+	bool stateChanged = false;
+
+	const int numActions = jmax<int>(oldList.size(), newList.size());
+
+	for (int i = 0; i < numActions; i++)
+	{
+		const ScriptDrawAction *oldAction = oldList[i];
+		const ScriptDrawAction *newAction = newList[i];
+
+		if (oldAction != nullptr) needsEntireCanvas |= oldAction->needsEntireCanvas();
+		if (newAction != nullptr) needsEntireCanvas |= newAction->needsEntireCanvas();
+
+		const bool isSame = oldAction != nullptr && newAction != nullptr && oldAction->isSameAs(*newAction);
+
+		if (isSame && !stateChanged)
+			continue;
+
+		const ScriptDrawAction *actionsToCheck[2] = { oldAction, newAction };
+
+		for (int j = 0; j < 2; j++)
+		{
+			const ScriptDrawAction *a = actionsToCheck[j];
+
+			if (a == nullptr)
+				continue;
+
+			switch (a->getScope())
+			{
+			case ScriptDrawAction::Scope::State:
+				stateChanged |= !isSame;
+				break;
+			case ScriptDrawAction::Scope::Area:
+				changedArea = changedArea.getUnion(a->getBounds());
+				anythingChanged = true;
+				break;
+			case ScriptDrawAction::Scope::Canvas:
+				entireCanvasChanged = true;
+				return Rectangle<float>();
+			}
+		}
+	}
+
+	if (anythingChanged && needsEntireCanvas)
+	{
+		entireCanvasChanged = true;
+		return Rectangle<float>();
+	}
+
+	return changedArea;
+}
+
+bool ScriptDisplayList::prepareCanvas(int width, int height, float scaleFactor)
+{
+	const int canvasWidth = (int)(scaleFactor * (float)width);
+	const int canvasHeight = (int)(scaleFactor * (float)height);
+
+	if (canvasWidth <= 0 || canvasHeight <= 0)
+	{
+		canvas = Image();
+		return true;
+	}
+
+	if (canvas.isValid() && canvas.getWidth() == canvasWidth && canvas.getHeight() == canvasHeight && canvasScaleFactor == scaleFactor)
+		return false;
+
+	canvas = Image(Image::PixelFormat::ARGB, canvasWidth, canvasHeight, true);
+	canvasScaleFactor = scaleFactor;
+
+	return true;
+}
+
+void ScriptDisplayList::drawIntoCanvas(const Rectangle<int> &pixelArea)
+{
+	canvas.clear(pixelArea);
+
+	Graphics g(canvas);
+
+	g.reduceClipRegion(pixelArea);
+	g.addTransform(AffineTransform::scale(canvasScaleFactor));
+
+	for (int i = 0; i < actions.size(); i++)
+	{
+		actions.getUnchecked(i)->perform(g, canvas, canvasScaleFactor);
+	}
+}
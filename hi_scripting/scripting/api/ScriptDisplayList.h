@@ -0,0 +1,174 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licences for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licencing:
+*
+*   http://www.hartinstruments.net/hise/
+*
+*   HISE is based on the JUCE library,
+*   which also must be licenced for commercial applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+#ifndef SCRIPTDISPLAYLIST_H_INCLUDED
+#define SCRIPTDISPLAYLIST_H_INCLUDED
+
+/** A recorded call of the Graphics API in the paint routine of a ScriptPanel.
+*
+*	The GraphicsObject doesn't draw directly into the panel's image, but appends these actions to a ScriptDisplayList,
+*	which replays them into the canvas. Every action stores all the values that affect its output, so two actions with
+*	the same parameters draw the same pixels (given the same graphics state).
+*/
+struct ScriptDrawAction
+{
+	enum Type
+	{
+		FillAll = 0,
+		FillRect,
+		DrawRect,
+		FillRoundedRectangle,
+		DrawRoundedRectangle,
+		DrawHorizontalLine,
+		DrawLine,
+		DrawText,
+		DrawEllipse,
+		FillEllipse,
+		DrawImage,
+		DrawDropShadow,
+		StrokePath,
+		FillPath,
+		SetColour,
+		SetGradientFill,
+		SetFont,
+		SetOpacity,
+		AddDropShadowFromAlpha,
+		numTypes
+	};
+
+	/** The part of the canvas that is affected by an action. */
+	enum class Scope
+	{
+		State = 0,	///< changes the colour, font or opacity of the following actions
+		Area,		///< draws into the area returned by getBounds()
+		Canvas		///< draws into the whole canvas
+	};
+
+	ScriptDrawAction(Type t) : type(t) {};
+
+	/** Draws the action. The canvas is the image that the Graphics context draws into. */
+	void perform(Graphics &g, Image &canvas, float scaleFactor) const;
+
+	/** Returns true if both actions have the same type and parameters. */
+	bool isSameAs(const ScriptDrawAction &other) const;
+
+	Scope getScope() const noexcept;
+
+	/** Returns the area in panel coordinates that this action draws into (including the line thickness). */
+	Rectangle<float> getBounds() const;
+
+	/** Returns true if the action reads back the canvas, so it can't be replayed into a part of it. */
+	bool needsEntireCanvas() const noexcept { return type == AddDropShadowFromAlpha; }
+
+	Type type;
+
+	Rectangle<float> area;
+	Line<float> line;
+	float lineThickness = 0.0f;
+	float cornerSize = 0.0f;
+	float opacity = 1.0f;
+	int radius = 0;
+
+	Colour colour;
+
+	/** The default constructor of ColourGradient leaves the points uninitialised, which would break isSameAs(). */
+	ColourGradient gradient = ColourGradient(Colour(), 0.0f, 0.0f, Colour(), 0.0f, 0.0f, false);
+
+	Font font;
+	String text;
+	Path path;
+
+	Image image;
+	Rectangle<int> sourceArea;
+};
+
+/** The retained drawing of a ScriptPanel.
+*
+*	The paint routine is recorded into a new list, which is then compared with the list of the last paint call. Only the
+*	area that is covered by changed actions is cleared and redrawn (by replaying the whole list with a clip region), and
+*	the canvas image is reused as long as its size and scale factor stay the same. If the paint routine produces the same
+*	list again, nothing is drawn at all.
+*
+*	All methods must be called from the message thread.
+*/
+class ScriptDisplayList
+{
+public:
+
+	ScriptDisplayList();
+
+	/** Clears the list that the next paint call is recorded into. */
+	void startRecording();
+
+	/** Adds an action to the recorded list and takes ownership of it. */
+	void addAction(ScriptDrawAction *newAction);
+
+	/** Replaces the current list with the recorded list and redraws the changed area of the canvas.
+	*
+	*	Returns the area (in panel coordinates) that was redrawn or an empty rectangle if nothing changed. If the size or
+	*	the scale factor changed, a new canvas image is created and the whole area is returned.
+	*/
+	Rectangle<int> commit(int width, int height, float scaleFactor);
+
+	/** Redraws the current list into a new canvas without recording it again (eg. if the display scale changed). */
+	void replay(int width, int height, float scaleFactor);
+
+	/** Returns the image that the list was drawn into. */
+	Image getCanvas() const { return canvas; }
+
+	float getScaleFactor() const noexcept { return canvasScaleFactor; }
+
+	int getNumActions() const noexcept { return actions.size(); }
+
+	/** Compares the lists and returns the area that needs to be redrawn in panel coordinates.
+	*
+	*	If an action that draws into the whole canvas has changed, entireCanvasChanged is set to true instead.
+	*/
+	static Rectangle<float> getChangedArea(const OwnedArray<ScriptDrawAction> &oldList, const OwnedArray<ScriptDrawAction> &newList, bool &entireCanvasChanged);
+
+private:
+
+	/** Returns true if a new canvas was created. */
+	bool prepareCanvas(int width, int height, float scaleFactor);
+
+	void drawIntoCanvas(const Rectangle<int> &pixelArea);
+
+	OwnedArray<ScriptDrawAction> actions;
+	OwnedArray<ScriptDrawAction> recordedActions;
+
+	Image canvas;
+	float canvasScaleFactor;
+
+	JUCE_DECLARE_NON_COPYABLE(ScriptDisplayList)
+};
+
+#endif  // SCRIPTDISPLAYLIST_H_INCLUDED
@@ -0,0 +1,282 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licences for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licencing:
+*
+*   http://www.hartinstruments.net/hise/
+*
+*   HISE is based on the JUCE library,
+*   which also must be licenced for commercial applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+
+#include "JuceHeader.h"
+
+class ScriptDisplayListUnitTest : public UnitTest
+{
+public:
+
+	ScriptDisplayListUnitTest() :
+		UnitTest("Testing the ScriptPanel display list")
+	{
+
+	}
+
+	void runTest() override
+	{
+		testChangedArea();
+		testPartialRedraw();
+		testCanvasReuse();
+		testRedrawSpeed();
+	}
+
+private:
+
+	enum
+	{
+		Width = 300,
+		Height = 120,
+		NumBars = 24
+	};
+
+	/** Records a meter like panel where every bar has its own value. */
+	void recordMeter(ScriptDisplayList &list, const Array<float> &values, Colour barColour = Colours::white)
+	{
+		list.startRecording();
+
+		ScriptDrawAction *a = new ScriptDrawAction(ScriptDrawAction::SetGradientFill);
+		a->gradient = ColourGradient(Colours::black, 0.0f, 0.0f, Colours::darkgrey, 0.0f, (float)Height, false);
+		list.addAction(a);
+
+		a = new ScriptDrawAction(ScriptDrawAction::FillRoundedRectangle);
+		a->area = Rectangle<float>(0.0f, 0.0f, (float)Width, (float)Height);
+		a->cornerSize = 4.0f;
+		list.addAction(a);
+
+		a = new ScriptDrawAction(ScriptDrawAction::SetColour);
+		a->colour = barColour;
+		list.addAction(a);
+
+		const float barWidth = (float)Width / (float)NumBars;
+
+		for (int i = 0; i < values.size(); i++)
+		{
+			const float barHeight = values[i] * (float)(Height - 10);
+
+			a = new ScriptDrawAction(ScriptDrawAction::FillRect);
+			a->area = Rectangle<float>((float)i * barWidth + 1.5f, (float)Height - 5.0f - barHeight, barWidth - 3.0f, barHeight);
+			list.addAction(a);
+
+			a = new ScriptDrawAction(ScriptDrawAction::DrawEllipse);
+			a->area = Rectangle<float>((float)i * barWidth + 2.0f, (float)Height - 9.0f - barHeight, 4.0f, 4.0f);
+			a->lineThickness = 1.5f;
+			list.addAction(a);
+		}
+
+		a = new ScriptDrawAction(ScriptDrawAction::SetOpacity);
+		a->opacity = 0.5f;
+		list.addAction(a);
+
+		a = new ScriptDrawAction(ScriptDrawAction::DrawLine);
+		a->line = Line<float>(0.0f, values[0] * (float)Height, (float)Width, (float)Height * 0.5f);
+		a->lineThickness = 2.0f;
+		list.addAction(a);
+	}
+
+	Array<float> createValues()
+	{
+		Array<float> values;
+
+		for (int i = 0; i < NumBars; i++)
+			values.add(r.nextFloat());
+
+		return values;
+	}
+
+	void testChangedArea()
+	{
+		beginTest("Finding the changed area");
+
+		ScriptDisplayList list;
+		Array<float> values = createValues();
+
+		recordMeter(list, values);
+		expect(list.commit(Width, Height, 1.0f) == Rectangle<int>(0, 0, Width, Height), "The first commit must draw everything");
+
+		recordMeter(list, values);
+		expect(list.commit(Width, Height, 1.0f).isEmpty(), "An identical list must not draw anything");
+
+		values.set(5, values[5] * 0.5f);
+
+		recordMeter(list, values);
+		const Rectangle<int> changedArea = list.commit(Width, Height, 1.0f);
+
+		const int barWidth = Width / NumBars;
+
+		expect(!changedArea.isEmpty(), "A changed bar must be redrawn");
+		expect(changedArea.getX() >= 4 * barWidth && changedArea.getRight() <= 7 * barWidth, "Only the changed bar must be redrawn: " + changedArea.toString());
+
+		recordMeter(list, values, Colours::red);
+		expect(list.commit(Width, Height, 1.0f).getWidth() >= (NumBars - 1) * barWidth, "A changed colour must redraw all following actions");
+	}
+
+	void testPartialRedraw()
+	{
+		beginTest("Comparing partial redraws with full redraws");
+
+		const float scaleFactors[2] = { 1.0f, 2.0f };
+
+		for (int s = 0; s < 2; s++)
+		{
+			ScriptDisplayList retainedList;
+
+			Array<float> values = createValues();
+
+			int maxDifference = 0;
+
+			for (int frame = 0; frame < 30; frame++)
+			{
+				const int numChangedBars = r.nextInt(3);
+
+				for (int i = 0; i < numChangedBars; i++)
+					values.set(r.nextInt(NumBars), r.nextFloat());
+
+				recordMeter(retainedList, values);
+				retainedList.commit(Width, Height, scaleFactors[s]);
+
+				ScriptDisplayList freshList;
+				recordMeter(freshList, values);
+				freshList.commit(Width, Height, scaleFactors[s]);
+
+				maxDifference = jmax<int>(maxDifference, getMaxDifference(retainedList.getCanvas(), freshList.getCanvas()));
+			}
+
+			// The edge table of a clipped fill can round the coverage at the clip boundary by a few steps
+			expect(maxDifference <= 4, "Partial redraw differs from a full redraw by " + String(maxDifference) + " at scale factor " + String(scaleFactors[s]));
+		}
+	}
+
+	void testCanvasReuse()
+	{
+		beginTest("Reusing the canvas");
+
+		ScriptDisplayList list;
+		Array<float> values = createValues();
+
+		recordMeter(list, values);
+		list.commit(Width, Height, 1.0f);
+
+		const Image firstCanvas = list.getCanvas();
+
+		values.set(0, 0.1f);
+		recordMeter(list, values);
+		list.commit(Width, Height, 1.0f);
+
+		expect(list.getCanvas() == firstCanvas, "The canvas must be reused for the same size");
+
+		recordMeter(list, values);
+		list.commit(Width, Height + 10, 1.0f);
+
+		expect(!(list.getCanvas() == firstCanvas), "A new size needs a new canvas");
+		expectEquals<int>(list.getCanvas().getHeight(), Height + 10);
+
+		list.replay(Width, Height + 10, 2.0f);
+
+		expectEquals<int>(list.getCanvas().getWidth(), 2 * Width, "Replaying must use the new scale factor");
+		expectEquals<int>(list.getNumActions(), 5 + 2 * NumBars, "Replaying must keep the display list");
+
+		list.startRecording();
+		expect(list.commit(0, 0, 1.0f).isEmpty(), "An empty panel must not draw");
+		expect(!list.getCanvas().isValid(), "An empty panel must not have a canvas");
+	}
+
+	void testRedrawSpeed()
+	{
+		beginTest("Measuring the redraw speed of a meter panel");
+
+		const int numFrames = 200;
+
+		ScriptDisplayList retainedList;
+		Array<float> values = createValues();
+
+		double start = Time::getMillisecondCounterHiRes();
+
+		for (int frame = 0; frame < numFrames; frame++)
+		{
+			values.set(frame % NumBars, r.nextFloat());
+
+			recordMeter(retainedList, values);
+			retainedList.commit(Width, Height, 2.0f);
+		}
+
+		const double retainedTime = Time::getMillisecondCounterHiRes() - start;
+
+		start = Time::getMillisecondCounterHiRes();
+
+		for (int frame = 0; frame < numFrames; frame++)
+		{
+			values.set(frame % NumBars, r.nextFloat());
+
+			// This is what the panel did before: a new image and a full redraw for every frame
+			ScriptDisplayList freshList;
+			recordMeter(freshList, values);
+			freshList.commit(Width, Height, 2.0f);
+		}
+
+		const double fullTime = Time::getMillisecondCounterHiRes() - start;
+
+		logMessage("Full redraw: " + String(fullTime / (double)numFrames, 3) + " ms per frame");
+		logMessage("Partial redraw: " + String(retainedTime / (double)numFrames, 3) + " ms per frame");
+
+		expect(retainedTime < fullTime, "The partial redraw should be faster");
+	}
+
+	static int getMaxDifference(const Image &a, const Image &b)
+	{
+		if (a.getWidth() != b.getWidth() || a.getHeight() != b.getHeight())
+			return 255;
+
+		int maxDifference = 0;
+
+		for (int y = 0; y < a.getHeight(); y++)
+		{
+			for (int x = 0; x < a.getWidth(); x++)
+			{
+				const PixelARGB p1 = a.getPixelAt(x, y).getPixelARGB();
+				const PixelARGB p2 = b.getPixelAt(x, y).getPixelARGB();
+
+				maxDifference = jmax<int>(maxDifference, std::abs((int)p1.getAlpha() - (int)p2.getAlpha()));
+				maxDifference = jmax<int>(maxDifference, std::abs((int)p1.getRed() - (int)p2.getRed()));
+				maxDifference = jmax<int>(maxDifference, std::abs((int)p1.getGreen() - (int)p2.getGreen()));
+				maxDifference = jmax<int>(maxDifference, std::abs((int)p1.getBlue() - (int)p2.getBlue()));
+			}
+		}
+
+		return maxDifference;
+	}
+
+	Random r;
+};
+
+static ScriptDisplayListUnitTest scriptDisplayListTestInstance;
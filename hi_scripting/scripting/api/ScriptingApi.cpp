@@ -2053,20 +2053,16 @@ int ScriptingApi::Synth::addNoteOn(int channel, int noteNumber, int velocity, in
 					{
 						HiseEvent m = HiseEvent(HiseEvent::Type::NoteOn, (uint8)noteNumber, (uint8)velocity, (uint8)channel);
 
+						// The delay is passed separately, so it can be longer than the 16 bit timestamp
 						if (sp->getCurrentHiseEvent() != nullptr)
 						{
-							m.setTimeStamp((uint16)sp->getCurrentHiseEvent()->getTimeStamp() + (uint16)timeStampSamples);
+							m.setTimeStamp((uint16)sp->getCurrentHiseEvent()->getTimeStamp());
 						}
-						else
-						{
-							m.setTimeStamp((uint16)timeStampSamples);
-						}
-
 						
 						m.setArtificial();
 
 						sp->getMainController()->getEventHandler().pushArtificialNoteOn(m);
-						sp->addHiseEventToBuffer(m);
+						sp->addHiseEventToBuffer(m, timeStampSamples);
 
 						return m.getEventId();
 					}
@@ -2100,11 +2096,7 @@ void ScriptingApi::Synth::addNoteOff(int channel, int noteNumber, int timeStampS
 
 					if (sp->getCurrentHiseEvent() != nullptr)
 					{
-						m.setTimeStamp((uint16)sp->getCurrentHiseEvent()->getTimeStamp() + (uint16)timeStampSamples);
-					}
-					else
-					{
-						m.setTimeStamp((uint16)timeStampSamples);
+						m.setTimeStamp((uint16)sp->getCurrentHiseEvent()->getTimeStamp());
 					}
 
 					m.setArtificial();
@@ -2113,7 +2105,7 @@ void ScriptingApi::Synth::addNoteOff(int channel, int noteNumber, int timeStampS
 
 					m.setEventId(eventId);
 
-					sp->addHiseEventToBuffer(m);
+					sp->addHiseEventToBuffer(m, timeStampSamples);
 
 				}
 			}
@@ -2140,16 +2132,12 @@ void ScriptingApi::Synth::addController(int channel, int number, int value, int
 						
 						if (sp->getCurrentHiseEvent() != nullptr)
 						{
-							m.setTimeStamp((uint16)sp->getCurrentHiseEvent()->getTimeStamp() + (uint16)timeStampSamples);
-						}
-						else
-						{
-							m.setTimeStamp((uint16)timeStampSamples);
+							m.setTimeStamp((uint16)sp->getCurrentHiseEvent()->getTimeStamp());
 						}
 
 						m.setArtificial();
 
-						sp->addHiseEventToBuffer(m);
+						sp->addHiseEventToBuffer(m, timeStampSamples);
 					}
 					
 				}
@@ -2315,9 +2303,9 @@ startTime(0.0)
 
 void ScriptingApi::Console::print(var x)
 {
-#if USE_BACKEND
-	debugToConsole(getProcessor(), x);
-#endif
+	// The var is converted to text on the message thread, so this doesn't allocate on the audio thread.
+	// Arrays and objects are not referenced by the queue, so the script can change them after this call.
+	getProcessor()->getMainController()->writeFormattedToConsole(nullptr, 0, getProcessor(), x);
 }
 
 void ScriptingApi::Console::stop()
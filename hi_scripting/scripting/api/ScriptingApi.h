@@ -449,13 +449,13 @@ public:
 		/** Returns the attribute of the parent synth. */
 		float getAttribute(int attributeIndex) const;
 
-		/** Adds a note on to the buffer. */
+		/** Adds a note on to the buffer. The timestamp is relative to the current event and can be longer than the buffer. */
 		int addNoteOn(int channel, int noteNumber, int velocity, int timeStampSamples);
 
-		/** Adds a note off to the buffer. */
+		/** Adds a note off to the buffer. The timestamp is relative to the current event and can be longer than the buffer. */
 		void addNoteOff(int channel, int noteNumber, int timeStampSamples);
 
-		/** Adds a controller to the buffer. */
+		/** Adds a controller to the buffer. The timestamp is relative to the current event and can be longer than the buffer. */
 		void addController(int channel, int number, int value, int timeStampSamples);
 
 		/** Sets the internal clock speed. */
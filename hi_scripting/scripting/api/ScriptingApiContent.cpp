@@ -2016,6 +2016,7 @@ ScriptCreatedComponentWrapper * ScriptingApi::Content::ScriptPanel::createCompon
 
 void ScriptingApi::Content::ScriptPanel::repaint()
 {
+	paintRoutineIsDirty.store(true);
 	repainter.triggerAsyncUpdate();
 }
 
@@ -2026,20 +2027,26 @@ void ScriptingApi::Content::ScriptPanel::setPaintRoutine(var paintFunction)
 }
 
 void ScriptingApi::Content::ScriptPanel::internalRepaint()
+{
+	if (paintRoutineIsDirty.exchange(false) || !displayList.getCanvas().isValid())
+		runPaintRoutine();
+	else
+		replayDisplayList();
+}
+
+void ScriptingApi::Content::ScriptPanel::runPaintRoutine()
 {
     const double scaleFactor = Desktop::getInstance().getDisplays().getMainDisplay().scale;
     
-	paintCanvas = Image(Image::PixelFormat::ARGB, (int)(scaleFactor * (double)getScriptObjectProperty(ScriptComponent::Properties::width)), (int)(scaleFactor * (double)getScriptObjectProperty(ScriptComponent::Properties::height)), true);
-
-	Graphics g(paintCanvas);
+	recordedWidth = (int)getScriptObjectProperty(ScriptComponent::Properties::width);
+	recordedHeight = (int)getScriptObjectProperty(ScriptComponent::Properties::height);
 
-	g.addTransform(AffineTransform::scale((float)scaleFactor));
-	
 	var thisObject(this);
 	var arguments = var(graphics);
 	var::NativeFunctionArgs args(thisObject, &arguments, 1);
 
-	graphics->setGraphics(&g, &paintCanvas);
+	displayList.startRecording();
+	graphics->setDisplayList(&displayList);
 
 	Result r = Result::ok();
 
@@ -2052,11 +2059,70 @@ void ScriptingApi::Content::ScriptPanel::internalRepaint()
 		reportScriptError(r.getErrorMessage());
 	}
 
-	graphics->setGraphics(nullptr, nullptr);
+	graphics->setDisplayList(nullptr);
+
+	const Image previousCanvas = displayList.getCanvas();
+
+	const Rectangle<int> changedArea = displayList.commit(recordedWidth, recordedHeight, (float)scaleFactor);
+
+	if (!(displayList.getCanvas() == previousCanvas))
+	{
+		// The wrappers need to fetch the new image
+		sendChangeMessage();
+	}
+	else if (!changedArea.isEmpty())
+	{
+		sendCanvasChangeMessage(changedArea);
+	}
+}
+
+void ScriptingApi::Content::ScriptPanel::replayDisplayList()
+{
+	const float scaleFactor = (float)Desktop::getInstance().getDisplays().getMainDisplay().scale;
+
+	// The canvas already shows the recorded paint call
+	if (scaleFactor == displayList.getScaleFactor())
+		return;
+
+	displayList.replay(recordedWidth, recordedHeight, scaleFactor);
 
+	// The wrappers need to fetch the new image
 	sendChangeMessage();
 }
 
+void ScriptingApi::Content::ScriptPanel::updateCanvas()
+{
+	if (!displayList.getCanvas().isValid())
+		return;
+
+	const int width = (int)getScriptObjectProperty(ScriptComponent::Properties::width);
+	const int height = (int)getScriptObjectProperty(ScriptComponent::Properties::height);
+
+	if (width != recordedWidth || height != recordedHeight)
+	{
+		repaint();
+		return;
+	}
+
+	replayDisplayList();
+}
+
+void ScriptingApi::Content::ScriptPanel::sendCanvasChangeMessage(const Rectangle<int> &changedArea)
+{
+	for (int i = 0; i < canvasListeners.size(); i++)
+	{
+		if (canvasListeners[i].get() != nullptr)
+		{
+			canvasListeners[i]->canvasChanged(changedArea);
+		}
+		else
+		{
+			canvasListeners.remove(i);
+			i--;
+		}
+	}
+}
+
 void ScriptingApi::Content::ScriptPanel::setMouseCallback(var mouseCallbackFunction)
 {
 	mouseRoutine = mouseCallbackFunction;
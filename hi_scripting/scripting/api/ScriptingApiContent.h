@@ -665,7 +665,7 @@ public:
 
 		// ======================================================================================================== API Methods
 
-		/** Triggers a repaint. */
+		/** Calls the paint routine again. Call this whenever something that the paint routine draws has changed. */
 		void repaint();
 
 		/** Sets a paint routine (a function with one parameter). */
@@ -690,11 +690,38 @@ public:
 
 		struct Wrapper;
 
+		/** Gets notified when a part of the panel's canvas was redrawn into the same image. */
+		class CanvasListener
+		{
+		public:
+
+			virtual ~CanvasListener() { masterReference.clear(); };
+
+			/** Called on the message thread with the area in panel coordinates that needs to be repainted. */
+			virtual void canvasChanged(const Rectangle<int> &changedArea) = 0;
+
+		private:
+
+			WeakReference<CanvasListener>::Master masterReference;
+			friend class WeakReference<CanvasListener>;
+		};
+
+		void addCanvasListener(CanvasListener *l) { canvasListeners.addIfNotAlreadyThere(l); }
+		void removeCanvasListener(CanvasListener *l) { canvasListeners.removeAllInstancesOf(l); }
+
+		/** Returns the image that the paint routine was drawn into. The image is reused for subsequent repaints. */
 		Image getImage() const
 		{
-			return paintCanvas;
+			return displayList.getCanvas();
 		}
 
+		/** Brings the canvas up to date with the size and the display scale of the panel.
+		*
+		*	If only the display scale has changed, the recorded paint call is replayed into a new canvas without calling the
+		*	script. A new size invalidates the recording, because the paint routine usually draws relative to the size.
+		*/
+		void updateCanvas();
+
 		bool isUsingCustomPaintRoutine() const { return !paintRoutine.isUndefined(); }
 
 		void mouseCallback(var mouseInformation);
@@ -720,8 +747,15 @@ public:
 
 		WeakReference<ScriptPanel>::Master masterReference;
 
+		/** Calls the paint routine if the panel was invalidated and replays the recorded paint call otherwise. */
 		void internalRepaint();
 
+		void runPaintRoutine();
+
+		void replayDisplayList();
+
+		void sendCanvasChangeMessage(const Rectangle<int> &changedArea);
+
 		struct AsyncControlCallbackSender : public AsyncUpdater
 		{
 			AsyncControlCallbackSender(ScriptPanel* parent_, ProcessorWithScriptingContent* p_) : parent(parent_), p(p_) {};
@@ -759,7 +793,16 @@ public:
 
 		DynamicObject::Ptr customProperties;
 
-		Image paintCanvas;
+		ScriptDisplayList displayList;
+
+		// Set by repaint() (which can be called from any thread) and cleared when the paint routine is called
+		std::atomic<bool> paintRoutineIsDirty { true };
+
+		// The size in panel coordinates that the display list was recorded for
+		int recordedWidth = 0;
+		int recordedHeight = 0;
+
+		Array<WeakReference<CanvasListener>> canvasListeners;
 
 		enum class NamedImageEntries
 		{
@@ -943,78 +943,87 @@ rectangleResult(Result::ok())
 ScriptingObjects::GraphicsObject::~GraphicsObject()
 {
 	parent = nullptr;
-	imageToDraw = nullptr;
-	g = nullptr;
+	displayList = nullptr;
 }
 
 void ScriptingObjects::GraphicsObject::fillAll(int colour)
 {
-	initGraphics();
-	Colour c((uint32)colour);
-
-	g->fillAll(c);
-
-	
+	if (ScriptDrawAction *a = addAction(ScriptDrawAction::FillAll))
+	{
+		a->colour = Colour((uint32)colour);
+	}
 }
 
 void ScriptingObjects::GraphicsObject::fillRect(var area)
 {
-	initGraphics();
-
-	g->fillRect(getRectangleFromVar(area));
+	if (ScriptDrawAction *a = addAction(ScriptDrawAction::FillRect))
+	{
+		a->area = getRectangleFromVar(area);
+	}
 }
 
 void ScriptingObjects::GraphicsObject::drawRect(var area, float borderSize)
 {
-	initGraphics();
-
-	g->drawRect(getRectangleFromVar(area), borderSize);
+	if (ScriptDrawAction *a = addAction(ScriptDrawAction::DrawRect))
+	{
+		a->area = getRectangleFromVar(area);
+		a->lineThickness = borderSize;
+	}
 }
 
 void ScriptingObjects::GraphicsObject::fillRoundedRectangle(var area, float cornerSize)
 {
-	initGraphics();
-
-	g->fillRoundedRectangle(getRectangleFromVar(area), cornerSize);
+	if (ScriptDrawAction *a = addAction(ScriptDrawAction::FillRoundedRectangle))
+	{
+		a->area = getRectangleFromVar(area);
+		a->cornerSize = cornerSize;
+	}
 }
 
 void ScriptingObjects::GraphicsObject::drawRoundedRectangle(var area, float cornerSize, float borderSize)
 {
-	initGraphics();
-
-	g->drawRoundedRectangle(getRectangleFromVar(area), cornerSize, borderSize);
+	if (ScriptDrawAction *a = addAction(ScriptDrawAction::DrawRoundedRectangle))
+	{
+		a->area = getRectangleFromVar(area);
+		a->cornerSize = cornerSize;
+		a->lineThickness = borderSize;
+	}
 }
 
 void ScriptingObjects::GraphicsObject::drawHorizontalLine(int y, float x1, float x2)
 {
-	initGraphics();
-
-	g->drawHorizontalLine(y, x1, x2);
+	if (ScriptDrawAction *a = addAction(ScriptDrawAction::DrawHorizontalLine))
+	{
+		a->area = Rectangle<float>(x1, (float)y, x2 - x1, 1.0f);
+	}
 }
 
 void ScriptingObjects::GraphicsObject::setOpacity(float alphaValue)
 {
-	initGraphics();
-
-	
-
-	g->setOpacity(alphaValue);
+	if (ScriptDrawAction *a = addAction(ScriptDrawAction::SetOpacity))
+	{
+		a->opacity = alphaValue;
+	}
 }
 
 void ScriptingObjects::GraphicsObject::drawLine(float x1, float x2, float y1, float y2, float lineThickness)
 {
-	initGraphics();
-
-	g->drawLine(x1, y1, x2, y2, lineThickness);
+	if (ScriptDrawAction *a = addAction(ScriptDrawAction::DrawLine))
+	{
+		a->line = Line<float>(x1, y1, x2, y2);
+		a->lineThickness = lineThickness;
+	}
 }
 
 void ScriptingObjects::GraphicsObject::setColour(int colour)
 {
-	
 	currentColour = Colour((uint32)colour);
-	g->setColour(currentColour);
-
 	useGradient = false;
+
+	if (ScriptDrawAction *a = addAction(ScriptDrawAction::SetColour))
+	{
+		a->colour = currentColour;
+	}
 }
 
 void ScriptingObjects::GraphicsObject::setFont(String fontName, float fontSize)
@@ -1032,20 +1041,24 @@ void ScriptingObjects::GraphicsObject::setFont(String fontName, float fontSize)
 		currentFont = Font(fontName, fontSize, Font::plain);
 	}
 
-	g->setFont(currentFont);
+	if (ScriptDrawAction *a = addAction(ScriptDrawAction::SetFont))
+	{
+		a->font = currentFont;
+	}
 }
 
 void ScriptingObjects::GraphicsObject::drawText(String text, var area)
 {
-	initGraphics();
-
-	Rectangle<float> r = getRectangleFromVar(area);
-
-	currentFont.setHeightWithoutChangingWidth(r.getHeight());
+	if (ScriptDrawAction *a = addAction(ScriptDrawAction::DrawText))
+	{
+		Rectangle<float> r = getRectangleFromVar(area);
 
-	g->setFont(currentFont);
+		currentFont.setHeightWithoutChangingWidth(r.getHeight());
 
-	g->drawText(text, r, Justification::centred);
+		a->area = r;
+		a->font = currentFont;
+		a->text = text;
+	}
 }
 
 void ScriptingObjects::GraphicsObject::setGradientFill(var gradientData)
@@ -1061,7 +1074,10 @@ void ScriptingObjects::GraphicsObject::setGradientFill(var gradientData)
 
 			useGradient = true;
 
-			g->setGradientFill(currentGradient);
+			if (ScriptDrawAction *a = addAction(ScriptDrawAction::SetGradientFill))
+			{
+				a->gradient = currentGradient;
+			}
 		}
 		else
 		{
@@ -1078,22 +1094,23 @@ void ScriptingObjects::GraphicsObject::setGradientFill(var gradientData)
 
 void ScriptingObjects::GraphicsObject::drawEllipse(var area, float lineThickness)
 {
-	initGraphics();
-
-	g->drawEllipse(getRectangleFromVar(area), lineThickness);
+	if (ScriptDrawAction *a = addAction(ScriptDrawAction::DrawEllipse))
+	{
+		a->area = getRectangleFromVar(area);
+		a->lineThickness = lineThickness;
+	}
 }
 
 void ScriptingObjects::GraphicsObject::fillEllipse(var area)
 {
-	initGraphics();
-
-	g->fillEllipse(getRectangleFromVar(area));
+	if (ScriptDrawAction *a = addAction(ScriptDrawAction::FillEllipse))
+	{
+		a->area = getRectangleFromVar(area);
+	}
 }
 
 void ScriptingObjects::GraphicsObject::drawImage(String imageName, var area, int /*xOffset*/, int yOffset)
 {
-	initGraphics();
-
 	auto sc = dynamic_cast<ScriptingApi::Content::ScriptPanel*>(parent);
 
 	const Image *img = sc->getLoadedImage(imageName);
@@ -1106,7 +1123,12 @@ void ScriptingObjects::GraphicsObject::drawImage(String imageName, var area, int
         {
             const double scaleFactor = (double)img->getWidth() / (double)r.getWidth();
             
-            g->drawImage(*img, (int)r.getX(), (int)r.getY(), (int)r.getWidth(), (int)r.getHeight(), 0, yOffset, (int)img->getWidth(), (int)((double)r.getHeight() * scaleFactor));
+			if (ScriptDrawAction *a = addAction(ScriptDrawAction::DrawImage))
+			{
+				a->image = *img;
+				a->area = Rectangle<float>((float)(int)r.getX(), (float)(int)r.getY(), (float)(int)r.getWidth(), (float)(int)r.getHeight());
+				a->sourceArea = Rectangle<int>(0, yOffset, (int)img->getWidth(), (int)((double)r.getHeight() * scaleFactor));
+			}
         }        
 	}
 	else
@@ -1117,80 +1139,71 @@ void ScriptingObjects::GraphicsObject::drawImage(String imageName, var area, int
 
 void ScriptingObjects::GraphicsObject::drawDropShadow(var area, int colour, int radius)
 {
-	initGraphics();
-
-	DropShadow shadow;
-
-	shadow.colour = Colour((uint32)colour);
-	shadow.radius = radius;
-
-	auto r = getIntRectangleFromVar(area);
-
-	shadow.drawForRectangle(*g, r);
+	if (ScriptDrawAction *a = addAction(ScriptDrawAction::DrawDropShadow))
+	{
+		a->area = getIntRectangleFromVar(area).toFloat();
+		a->colour = Colour((uint32)colour);
+		a->radius = radius;
+	}
 }
 
 void ScriptingObjects::GraphicsObject::drawTriangle(var area, float angle, float lineThickness)
 {
-	initGraphics();
+	if (ScriptDrawAction *a = addAction(ScriptDrawAction::StrokePath))
+	{
+		Path p;
+		p.startNewSubPath(0.5f, 0.0f);
+		p.lineTo(1.0f, 1.0f);
+		p.lineTo(0.0f, 1.0f);
+		p.closeSubPath();
+		p.applyTransform(AffineTransform::rotation(angle));
+		auto r = getRectangleFromVar(area);
+		p.scaleToFit(r.getX(), r.getY(), r.getWidth(), r.getHeight(), false);
 
-	Path p;
-	p.startNewSubPath(0.5f, 0.0f);
-	p.lineTo(1.0f, 1.0f);
-	p.lineTo(0.0f, 1.0f);
-	p.closeSubPath();
-	p.applyTransform(AffineTransform::rotation(angle));
-	auto r = getRectangleFromVar(area);
-	p.scaleToFit(r.getX(), r.getY(), r.getWidth(), r.getHeight(), false);
-	
-	PathStrokeType pst(lineThickness);
-	g->strokePath(p, pst);
+		a->path = p;
+		a->lineThickness = lineThickness;
+	}
 }
 
 void ScriptingObjects::GraphicsObject::fillTriangle(var area, float angle)
 {
-	initGraphics();
-
-	Path p;
-	p.startNewSubPath(0.5f, 0.0f);
-	p.lineTo(1.0f, 1.0f);
-	p.lineTo(0.0f, 1.0f);
-	p.closeSubPath();
-	p.applyTransform(AffineTransform::rotation(angle));
-	auto r = getRectangleFromVar(area);
-	p.scaleToFit(r.getX(), r.getY(), r.getWidth(), r.getHeight(), false);
+	if (ScriptDrawAction *a = addAction(ScriptDrawAction::FillPath))
+	{
+		Path p;
+		p.startNewSubPath(0.5f, 0.0f);
+		p.lineTo(1.0f, 1.0f);
+		p.lineTo(0.0f, 1.0f);
+		p.closeSubPath();
+		p.applyTransform(AffineTransform::rotation(angle));
+		auto r = getRectangleFromVar(area);
+		p.scaleToFit(r.getX(), r.getY(), r.getWidth(), r.getHeight(), false);
 
-	g->fillPath(p);
+		a->path = p;
+	}
 }
 
 void ScriptingObjects::GraphicsObject::addDropShadowFromAlpha(int colour, int radius)
 {
-	initGraphics();
-
-	DropShadow shadow;
-
-	shadow.colour = Colour((uint32)colour);
-	shadow.radius = radius;
-
-
-    const double scaleFactor = Desktop::getInstance().getDisplays().getMainDisplay().scale;
-    
-    Graphics g2(*imageToDraw);
-    
-    g2.addTransform(AffineTransform::scale((float)(1.0 / scaleFactor)));
-    
-	shadow.drawForImage(g2, *imageToDraw);
+	if (ScriptDrawAction *a = addAction(ScriptDrawAction::AddDropShadowFromAlpha))
+	{
+		a->colour = Colour((uint32)colour);
+		a->radius = radius;
+	}
 }
 
 void ScriptingObjects::GraphicsObject::fillPath(var path, var area)
 {
 	if (PathObject* pathObject = dynamic_cast<PathObject*>(path.getObject()))
 	{
-		Path p = pathObject->getPath();
-		Rectangle<float> r = getRectangleFromVar(area);
+		if (ScriptDrawAction *a = addAction(ScriptDrawAction::FillPath))
+		{
+			Path p = pathObject->getPath();
+			Rectangle<float> r = getRectangleFromVar(area);
 
-		p.scaleToFit(r.getX(), r.getY(), r.getWidth(), r.getHeight(), false);
+			p.scaleToFit(r.getX(), r.getY(), r.getWidth(), r.getHeight(), false);
 
-		g->fillPath(p);
+			a->path = p;
+		}
 	}
 }
 
@@ -1212,10 +1225,19 @@ Rectangle<int> ScriptingObjects::GraphicsObject::getIntRectangleFromVar(const va
 	return f;
 }
 
-void ScriptingObjects::GraphicsObject::initGraphics()
+ScriptDrawAction * ScriptingObjects::GraphicsObject::addAction(ScriptDrawAction::Type type)
 {
-	if (g == nullptr) reportScriptError("Graphics not initialised");
+	if (displayList == nullptr)
+	{
+		reportScriptError("Graphics not initialised");
+		return nullptr;
+	}
+
+	ScriptDrawAction *a = new ScriptDrawAction(type);
+
+	displayList->addAction(a);
 
+	return a;
 }
 
 struct ScriptingObjects::ScriptingMessageHolder::Wrapper
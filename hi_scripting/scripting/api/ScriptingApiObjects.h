@@ -682,11 +682,11 @@ public:
 
 		struct Wrapper;
 
-		
-		void setGraphics(Graphics *g_, Image* image_)
+
+		/** Sets the display list that the API calls are recorded into (nullptr outside of the paint routine). */
+		void setDisplayList(ScriptDisplayList *listToRecordInto)
 		{
-			g = g_;
-			imageToDraw = image_;
+			displayList = listToRecordInto;
 		}
 
 	private:
@@ -694,13 +694,12 @@ public:
 		Rectangle<float> getRectangleFromVar(const var &data);
 		Rectangle<int> getIntRectangleFromVar(const var &data);
 
-		void initGraphics();
+		/** Creates an action and adds it to the display list. Returns nullptr if called outside of the paint routine. */
+		ScriptDrawAction *addAction(ScriptDrawAction::Type type);
 
 		Result rectangleResult;
 
-		Image *imageToDraw = nullptr;
-
-		Graphics *g = nullptr;
+		ScriptDisplayList *displayList = nullptr;
 
 		Colour currentColour;
 		Font currentFont;
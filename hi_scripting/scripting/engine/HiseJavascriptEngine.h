@@ -155,6 +155,12 @@ public:
 
 	var executeCallback(int callbackIndex, Result *result);
 
+	/** Enables the bytecode interpreter for the callbacks (this is the default if HISE_USE_SCRIPT_BYTECODE is set).
+	*
+	*	Call this before the script is compiled. If disabled, the callbacks are executed by walking the statement tree.
+	*/
+	void setUseBytecodeForCallbacks(bool shouldUseBytecode);
+
 	inline void setCallbackParameter(int callbackIndex, int parameterIndex, var newValue);
 
 	DebugInformation*getDebugInformation(int index);
@@ -321,6 +327,10 @@ public:
 		struct GlobalVarStatement;		struct GlobalReference;		struct LocalVarStatement;
 		struct LocalReference;			struct LockStatement;	    struct CallbackParameterReference;
 		struct CallbackLocalStatement;  struct CallbackLocalReference;  struct ExternalCFunction;
+
+		// Bytecode
+
+		struct BytecodeProgram;
 		
 
 		// Parser classes
@@ -358,9 +368,11 @@ public:
 
 			Callback(const Identifier &id, int numArgs, double bufferTime_);
 
+			~Callback();
+
 			var perform(RootObject *root);
 
-			void setStatements(BlockStatement *s) noexcept;
+			void setStatements(BlockStatement *s, bool compileBytecode) noexcept;
 
 			bool isDefined() const noexcept{ return isCallbackDefined; }
 
@@ -417,6 +429,7 @@ public:
 		private:
 
 			ScopedPointer<BlockStatement> statements;
+			ScopedPointer<BytecodeProgram> program;
 			double lastExecutionTime;
 			const Identifier callbackName;
 			int numArgs;
@@ -519,6 +532,8 @@ public:
 
 			double callbackTimes[32];
 
+			bool useBytecode = HISE_USE_SCRIPT_BYTECODE != 0;
+
 			static Array<Identifier> hiddenProperties;
 
 			OwnedArray<ExternalFileData> includedFiles;
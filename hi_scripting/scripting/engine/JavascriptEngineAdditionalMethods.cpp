@@ -497,6 +497,17 @@ int HiseJavascriptEngine::RootObject::HiseSpecialData::getExternalCIndex(const I
 }
 
 
+HiseJavascriptEngine::RootObject::Callback::~Callback()
+{
+	program = nullptr;
+	statements = nullptr;
+}
+
+void HiseJavascriptEngine::setUseBytecodeForCallbacks(bool shouldUseBytecode)
+{
+	root->hiseSpecialData.useBytecode = shouldUseBytecode;
+}
+
 var HiseJavascriptEngine::executeCallback(int callbackIndex, Result *result)
 {
 	RootObject::Callback *c = root->hiseSpecialData.callbackNEW[callbackIndex];
@@ -526,10 +537,14 @@ var HiseJavascriptEngine::executeCallback(int callbackIndex, Result *result)
 	return var::undefined();
 }
 
-void HiseJavascriptEngine::RootObject::Callback::setStatements(BlockStatement *s) noexcept
+void HiseJavascriptEngine::RootObject::Callback::setStatements(BlockStatement *s, bool compileBytecode) noexcept
 {
+	program = nullptr;
 	statements = s;
 	isCallbackDefined = s->statements.size() != 0;
+
+	if (compileBytecode)
+		program = BytecodeProgram::compile(s);
 }
 
 
@@ -541,13 +556,16 @@ var HiseJavascriptEngine::RootObject::Callback::perform(RootObject *root)
 
 #if USE_BACKEND
 	const double pre = Time::getMillisecondCounterHiRes();
+#endif
 
-	statements->perform(s, &returnValue);
+	if (program != nullptr && root->hiseSpecialData.useBytecode)
+		program->perform(s, &returnValue);
+	else
+		statements->perform(s, &returnValue);
 
+#if USE_BACKEND
 	const double post = Time::getMillisecondCounterHiRes();
 	lastExecutionTime = post - pre;
-#else
-	statements->perform(s, &returnValue);
 #endif
 
 	return returnValue;
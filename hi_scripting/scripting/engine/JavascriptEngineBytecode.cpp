@@ -0,0 +1,841 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licences for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licencing:
+*
+*   http://www.hartinstruments.net/hise/
+*
+*   HISE is based on the JUCE library,
+*   which also must be licenced for commercial applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+#include <typeinfo>
+
+/** The compiled body of a callback.
+*
+*	The statement tree is lowered into a flat list of instructions which operate on a fixed register file of vars.
+*	The registers are assigned when the callback is compiled and every call creates its register frame on the stack,
+*	so the interpreter neither walks the tree nor allocates (unless the script itself creates strings or objects).
+*	The program itself is not changed by a call, so it can be performed from multiple threads or recursively. Inline functions are expanded at the call site.
+*
+*	Nodes that have no instruction (switch statements, for ... in loops, locked blocks, calls to script objects etc.)
+*	stay in the tree and are called from the program, so every callback can be compiled and behaves like before.
+*/
+struct HiseJavascriptEngine::RootObject::BytecodeProgram
+{
+	enum OpCode
+	{
+		LoadConstant = 0,		///< r[dst] = constants[index]
+		LoadPointer,			///< r[dst] = *pointers[index]
+		StorePointer,			///< *pointers[index] = r[a]
+		SetRegister,			///< root register[index] = r[a]
+		AddRegister,			///< RegisterVarStatement nodes[index] with the value r[a]
+		ToBool,					///< r[dst] = (bool)r[a]
+		Binary,					///< r[dst] = BinaryOperator nodes[index] (r[a], r[b])
+		TypeEquals,				///< r[dst] = r[a] === r[b]
+		TypeNotEquals,			///< r[dst] = r[a] !== r[b]
+		Subscript,				///< r[dst] = r[a][ArraySubscript nodes[index]]
+		Dot,					///< r[dst] = r[a].(DotOperator nodes[index])
+		Assign,					///< Expression nodes[index] = r[a]
+		Evaluate,				///< r[dst] = Expression nodes[index]
+		Perform,				///< performs fallbacks[index] with the return value in r[dst]
+		CallApi,				///< r[dst] = ApiCall nodes[index] with the arguments r[a]...
+		LoadParameter,			///< r[dst] = ParameterReference nodes[index] of the current inline function call
+		EnterInlineFunction,	///< makes the inline function call nodes[index] the current call of its function
+		SetParameter,			///< sets the argument b of the inline function call nodes[index] to r[a]
+		ExitInlineFunction,		///< leaves the inline function call nodes[index] with the return value r[a]
+		CallInlineFunction,		///< r[dst] = performs the body of the entered inline function call nodes[index] (not expanded)
+		Jump,					///< jumps to index
+		JumpIfFalse,			///< jumps to index if r[a] is false
+		JumpIfTrue,				///< jumps to index if r[a] is true
+		CheckTimeout,			///< checks the timeout with the location of nodes[index]
+		SetLocation,			///< sets the current location to nodes[index]
+		Return,					///< returns r[a]
+		Stop,					///< returns without a value
+		numOpCodes
+	};
+
+	/** Compiles the body of a callback. Returns nullptr if the callback can't be compiled. */
+	static BytecodeProgram* compile(BlockStatement* body);
+
+	/** Runs the program. The return value will only be set if the callback hits a return statement. */
+	void perform(const Scope& s, var* returnValue);
+
+	int getNumInstructions() const noexcept { return instructions.size(); }
+
+	int getNumRegisters() const noexcept { return numRegisters; }
+
+private:
+
+	BytecodeProgram() {};
+
+	struct Compiler;
+
+	struct Instruction
+	{
+		uint8 op;
+		uint8 dst;
+		uint8 a;
+		uint8 b;
+		int index;
+	};
+
+	/** A statement which is performed by the tree walker. */
+	struct FallbackStatement
+	{
+		Statement* statement;
+		int returnTarget;
+		int breakTarget;
+		int continueTarget;
+	};
+
+	Array<Instruction> instructions;
+	Array<var> constants;
+	Array<var*> pointers;
+	Array<Statement*> nodes;
+	Array<FallbackStatement> fallbacks;
+
+	int numRegisters = 0;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BytecodeProgram)
+};
+
+
+struct HiseJavascriptEngine::RootObject::BytecodeProgram::Compiler
+{
+	enum
+	{
+		MaxRegisters = 128,
+		MaxInlineDepth = 8
+	};
+
+	/** The targets of return, break and continue statements. */
+	struct JumpContext
+	{
+		int returnLabel;
+		int breakLabel;
+		int continueLabel;
+		int returnRegister;
+	};
+
+	Compiler(BytecodeProgram& p) : program(p) {}
+
+	bool compile(BlockStatement* body)
+	{
+		const int returnRegister = allocate();
+		const int stopLabel = createLabel();
+		const int returnLabel = createLabel();
+
+		JumpContext c = { returnLabel, stopLabel, stopLabel, returnRegister };
+		contexts.add(c);
+
+		compileStatement(body);
+
+		placeLabel(stopLabel);
+		emit(Stop);
+		placeLabel(returnLabel);
+		emit(Return, 0, returnRegister);
+
+		if (!compiledOk)
+			return false;
+
+		for (int i = 0; i < program.instructions.size(); i++)
+		{
+			Instruction& in = program.instructions.getReference(i);
+
+			if (in.op == Jump || in.op == JumpIfFalse || in.op == JumpIfTrue)
+				in.index = labels[in.index];
+		}
+
+		for (int i = 0; i < program.fallbacks.size(); i++)
+		{
+			FallbackStatement& f = program.fallbacks.getReference(i);
+
+			f.returnTarget = labels[f.returnTarget];
+			f.breakTarget = labels[f.breakTarget];
+			f.continueTarget = labels[f.continueTarget];
+		}
+
+		program.numRegisters = numRegisters;
+
+		return true;
+	}
+
+private:
+
+	// ================================================================================================================
+
+	void compileStatement(Statement* st)
+	{
+		// The parser uses empty statements as placeholders (eg. in while loops)
+		if (st == nullptr || typeid(*st) == typeid(Statement))
+			return;
+
+		if (BlockStatement* b = dynamic_cast<BlockStatement*>(st))
+		{
+			if (b->lockStatements.size() != 0)
+			{
+				emitFallback(st);
+				return;
+			}
+
+			for (int i = 0; i < b->statements.size(); i++)
+			{
+#if ENABLE_SCRIPTING_SAFE_CHECKS
+				emit(SetLocation, 0, 0, 0, addNode(b->statements.getUnchecked(i)));
+#endif
+				compileStatement(b->statements.getUnchecked(i));
+			}
+		}
+		else if (IfStatement* is = dynamic_cast<IfStatement*>(st))
+		{
+			const int elseLabel = createLabel();
+			const int endLabel = createLabel();
+
+			const int condition = allocate();
+			compileExpression(is->condition, condition);
+			emitJump(JumpIfFalse, elseLabel, condition);
+			release(condition);
+
+			compileStatement(is->trueBranch);
+			emitJump(Jump, endLabel);
+			placeLabel(elseLabel);
+			compileStatement(is->falseBranch);
+			placeLabel(endLabel);
+		}
+		else if (LoopStatement* ls = dynamic_cast<LoopStatement*>(st))
+		{
+			if (ls->isIterator)
+				emitFallback(st);
+			else
+				compileLoop(ls);
+		}
+		else if (ReturnStatement* rs = dynamic_cast<ReturnStatement*>(st))
+		{
+			compileExpression(rs->returnValue, contexts.getLast().returnRegister);
+			emitJump(Jump, contexts.getLast().returnLabel);
+		}
+		else if (dynamic_cast<BreakStatement*>(st) != nullptr)
+		{
+			emitJump(Jump, contexts.getLast().breakLabel);
+		}
+		else if (dynamic_cast<ContinueStatement*>(st) != nullptr)
+		{
+			emitJump(Jump, contexts.getLast().continueLabel);
+		}
+		else if (CallbackLocalStatement* cls = dynamic_cast<CallbackLocalStatement*>(st))
+		{
+			compileStore(st, cls->initialiser, cls->parentCallback->localProperties.getVarPointer(cls->name));
+		}
+		else if (LocalVarStatement* lvs = dynamic_cast<LocalVarStatement*>(st))
+		{
+			compileStore(st, lvs->initialiser, lvs->parentFunction->localProperties.getVarPointer(lvs->name));
+		}
+		else if (RegisterVarStatement* rvs = dynamic_cast<RegisterVarStatement*>(st))
+		{
+			const int value = allocate();
+			compileExpression(rvs->initialiser, value);
+			emit(AddRegister, 0, value, 0, addNode(st));
+			release(value);
+		}
+		else if (Expression* e = dynamic_cast<Expression*>(st))
+		{
+			const int result = allocate();
+			compileExpression(e, result);
+			release(result);
+		}
+		else
+		{
+			emitFallback(st);
+		}
+	}
+
+	void compileLoop(LoopStatement* ls)
+	{
+		compileStatement(ls->initialiser);
+
+		const int startLabel = createLabel();
+		const int continueLabel = createLabel();
+		const int endLabel = createLabel();
+
+		placeLabel(startLabel);
+
+		if (!ls->isDoLoop)
+			compileCondition(ls->condition, endLabel);
+
+		emit(CheckTimeout, 0, 0, 0, addNode(ls));
+
+		JumpContext c = contexts.getLast();
+		c.breakLabel = endLabel;
+		c.continueLabel = continueLabel;
+
+		contexts.add(c);
+		compileStatement(ls->body);
+		contexts.removeLast();
+
+		if (ls->isDoLoop)
+		{
+			// A continue statement skips the condition of a do loop (like the tree walker does)
+
+			compileStatement(ls->iterator);
+			compileCondition(ls->condition, endLabel);
+			emitJump(Jump, startLabel);
+
+			placeLabel(continueLabel);
+			compileStatement(ls->iterator);
+			emitJump(Jump, startLabel);
+		}
+		else
+		{
+			placeLabel(continueLabel);
+			compileStatement(ls->iterator);
+			emitJump(Jump, startLabel);
+		}
+
+		placeLabel(endLabel);
+	}
+
+	/** Jumps to the label if the condition is false. */
+	void compileCondition(Expression* condition, int falseLabel)
+	{
+		const int result = allocate();
+		compileExpression(condition, result);
+		emitJump(JumpIfFalse, falseLabel, result);
+		release(result);
+	}
+
+	void compileStore(Statement* st, Expression* initialiser, var* target)
+	{
+		if (target == nullptr)
+		{
+			emitFallback(st);
+			return;
+		}
+
+		const int value = allocate();
+		compileExpression(initialiser, value);
+		emit(StorePointer, 0, value, 0, addPointer(target));
+		release(value);
+	}
+
+	// ================================================================================================================
+
+	void compileExpression(Expression* e, int dst)
+	{
+		if (e == nullptr || typeid(*e) == typeid(Expression))
+		{
+			emit(LoadConstant, dst, 0, 0, addConstant(var::undefined()));
+		}
+		else if (LiteralValue* lv = dynamic_cast<LiteralValue*>(e))
+		{
+			emit(LoadConstant, dst, 0, 0, addConstant(lv->value));
+		}
+		else if (ApiConstant* ac = dynamic_cast<ApiConstant*>(e))
+		{
+			emit(LoadConstant, dst, 0, 0, addConstant(ac->value));
+		}
+		else if (RegisterName* rn = dynamic_cast<RegisterName*>(e))
+		{
+			emit(LoadPointer, dst, 0, 0, addPointer(rn->data));
+		}
+		else if (CallbackParameterReference* cpr = dynamic_cast<CallbackParameterReference*>(e))
+		{
+			emit(LoadPointer, dst, 0, 0, addPointer(cpr->data));
+		}
+		else if (CallbackLocalReference* clr = dynamic_cast<CallbackLocalReference*>(e))
+		{
+			emit(LoadPointer, dst, 0, 0, addPointer(clr->data));
+		}
+		else if (LocalReference* lr = dynamic_cast<LocalReference*>(e))
+		{
+			if (var* data = lr->parentFunction->localProperties.getVarPointer(lr->id))
+				emit(LoadPointer, dst, 0, 0, addPointer(data));
+			else
+				emit(Evaluate, dst, 0, 0, addNode(e));
+		}
+		else if (dynamic_cast<InlineFunction::ParameterReference*>(e) != nullptr)
+		{
+			// The parameter can't be bound at compile time because an argument can change the current call of the function
+			emit(LoadParameter, dst, 0, 0, addNode(e));
+		}
+		else if (RegisterAssignment* ra = dynamic_cast<RegisterAssignment*>(e))
+		{
+			compileExpression(ra->source, dst);
+			emit(SetRegister, 0, dst, 0, ra->registerIndex);
+		}
+		else if (Assignment* as = dynamic_cast<Assignment*>(e))
+		{
+			compileExpression(as->newValue, dst);
+			compileAssign(as->target, dst);
+		}
+		else if (PostAssignment* pa = dynamic_cast<PostAssignment*>(e))
+		{
+			compileExpression(pa->target, dst);
+
+			const int newValue = allocate();
+			compileExpression(pa->newValue, newValue);
+			compileAssign(pa->target, newValue);
+			release(newValue);
+		}
+		else if (SelfAssignment* sa = dynamic_cast<SelfAssignment*>(e))
+		{
+			compileExpression(sa->newValue, dst);
+			compileAssign(sa->target, dst);
+		}
+		else if (LogicalAndOp* andOp = dynamic_cast<LogicalAndOp*>(e))
+		{
+			compileLogicalOperator(andOp, dst, JumpIfFalse);
+		}
+		else if (LogicalOrOp* orOp = dynamic_cast<LogicalOrOp*>(e))
+		{
+			compileLogicalOperator(orOp, dst, JumpIfTrue);
+		}
+		else if (TypeEqualsOp* te = dynamic_cast<TypeEqualsOp*>(e))
+		{
+			compileOperands(te, dst, TypeEquals, 0);
+		}
+		else if (TypeNotEqualsOp* tne = dynamic_cast<TypeNotEqualsOp*>(e))
+		{
+			compileOperands(tne, dst, TypeNotEquals, 0);
+		}
+		else if (BinaryOperator* bo = dynamic_cast<BinaryOperator*>(e))
+		{
+			compileOperands(bo, dst, Binary, addNode(e));
+		}
+		else if (ConditionalOp* co = dynamic_cast<ConditionalOp*>(e))
+		{
+			const int falseLabel = createLabel();
+			const int endLabel = createLabel();
+
+			compileExpression(co->condition, dst);
+			emitJump(JumpIfFalse, falseLabel, dst);
+			compileExpression(co->trueBranch, dst);
+			emitJump(Jump, endLabel);
+			placeLabel(falseLabel);
+			compileExpression(co->falseBranch, dst);
+			placeLabel(endLabel);
+		}
+		else if (ArraySubscript* sub = dynamic_cast<ArraySubscript*>(e))
+		{
+			compileExpression(sub->object, dst);
+			emit(Subscript, dst, dst, 0, addNode(e));
+		}
+		else if (DotOperator* dot = dynamic_cast<DotOperator*>(e))
+		{
+			compileExpression(dot->parent, dst);
+			emit(Dot, dst, dst, 0, addNode(e));
+		}
+		else if (ApiCall* call = dynamic_cast<ApiCall*>(e))
+		{
+			compileApiCall(call, dst);
+		}
+		else if (InlineFunction::FunctionCall* ifc = dynamic_cast<InlineFunction::FunctionCall*>(e))
+		{
+			compileInlineFunctionCall(ifc, dst);
+		}
+		else
+		{
+			emit(Evaluate, dst, 0, 0, addNode(e));
+		}
+	}
+
+	void compileAssign(Expression* target, int value)
+	{
+		var* data = nullptr;
+
+		if (RegisterName* rn = dynamic_cast<RegisterName*>(target))
+			data = rn->data;
+		else if (LocalReference* lr = dynamic_cast<LocalReference*>(target))
+			data = lr->parentFunction->localProperties.getVarPointer(lr->id);
+
+		if (data != nullptr)
+			emit(StorePointer, 0, value, 0, addPointer(data));
+		else
+			emit(Assign, 0, value, 0, addNode(target));
+	}
+
+	void compileOperands(BinaryOperatorBase* op, int dst, OpCode opCode, int index)
+	{
+		compileExpression(op->lhs, dst);
+
+		const int rhs = allocate();
+		compileExpression(op->rhs, rhs);
+		emit(opCode, dst, dst, rhs, index);
+		release(rhs);
+	}
+
+	void compileLogicalOperator(BinaryOperatorBase* op, int dst, OpCode shortCircuitJump)
+	{
+		const int endLabel = createLabel();
+
+		compileExpression(op->lhs, dst);
+		emit(ToBool, dst, dst);
+		emitJump(shortCircuitJump, endLabel, dst);
+		compileExpression(op->rhs, dst);
+		emit(ToBool, dst, dst);
+		placeLabel(endLabel);
+	}
+
+	void compileApiCall(ApiCall* call, int dst)
+	{
+		for (int i = 0; i < call->expectedNumArguments; i++)
+		{
+			if (call->argumentList[i] == nullptr)
+			{
+				emit(Evaluate, dst, 0, 0, addNode(call));
+				return;
+			}
+		}
+
+		const int firstArgument = allocate(call->expectedNumArguments);
+
+		for (int i = 0; i < call->expectedNumArguments; i++)
+			compileExpression(call->argumentList[i], firstArgument + i);
+
+		emit(CallApi, dst, firstArgument, 0, addNode(call));
+		release(firstArgument);
+	}
+
+	void compileInlineFunctionCall(InlineFunction::FunctionCall* call, int dst)
+	{
+		InlineFunction::Object* f = call->f.get();
+
+		if (call->parameterExpressions.size() != call->numArgs || call->numArgs > 255)
+		{
+			emit(Evaluate, dst, 0, 0, addNode(call));
+			return;
+		}
+
+		const bool canBeExpanded = getExpandedCall(f) == nullptr &&
+								   expandedCalls.size() < MaxInlineDepth &&
+								   f->body != nullptr &&
+								   f->body->lockStatements.size() == 0;
+
+		const int node = addNode(call);
+
+		// Like the tree walker, enter the call before the arguments are evaluated and pass every argument right away
+		emit(EnterInlineFunction, 0, 0, 0, node);
+
+		for (int i = 0; i < call->numArgs; i++)
+		{
+			compileExpression(call->parameterExpressions.getUnchecked(i), dst);
+			emit(SetParameter, 0, dst, i, node);
+		}
+
+		if (canBeExpanded)
+		{
+			const int exitLabel = createLabel();
+
+			emit(LoadConstant, dst, 0, 0, addConstant(var::undefined()));
+
+			// break and continue statements outside of a loop leave the function like in the tree walker
+			JumpContext c = { exitLabel, exitLabel, exitLabel, dst };
+
+			contexts.add(c);
+			expandedCalls.add(call);
+
+			compileStatement(f->body);
+
+			expandedCalls.removeLast();
+			contexts.removeLast();
+
+			placeLabel(exitLabel);
+			emit(ExitInlineFunction, 0, dst, 0, node);
+		}
+		else
+		{
+			emit(CallInlineFunction, dst, 0, 0, node);
+		}
+	}
+
+	/** Returns the call of the given function which is currently expanded. */
+	InlineFunction::FunctionCall* getExpandedCall(const InlineFunction::Object* f) const
+	{
+		for (int i = expandedCalls.size(); --i >= 0;)
+		{
+			if (expandedCalls.getUnchecked(i)->f.get() == f)
+				return expandedCalls.getUnchecked(i);
+		}
+
+		return nullptr;
+	}
+
+	// ================================================================================================================
+
+	void emit(OpCode op, int dst = 0, int a = 0, int b = 0, int index = 0)
+	{
+		Instruction in = { (uint8)op, (uint8)dst, (uint8)a, (uint8)b, index };
+		program.instructions.add(in);
+	}
+
+	void emitJump(OpCode op, int label, int condition = 0)
+	{
+		emit(op, 0, condition, 0, label);
+	}
+
+	void emitFallback(Statement* st)
+	{
+		const JumpContext& c = contexts.getLast();
+
+		FallbackStatement f = { st, c.returnLabel, c.breakLabel, c.continueLabel };
+		program.fallbacks.add(f);
+
+		emit(Perform, c.returnRegister, 0, 0, program.fallbacks.size() - 1);
+	}
+
+	int createLabel()
+	{
+		labels.add(-1);
+		return labels.size() - 1;
+	}
+
+	void placeLabel(int label)
+	{
+		labels.set(label, program.instructions.size());
+	}
+
+	/** Allocates consecutive registers and returns the first one. Registers are released in reverse order. */
+	int allocate(int numToAllocate = 1)
+	{
+		if (numUsedRegisters + numToAllocate > MaxRegisters)
+		{
+			compiledOk = false;
+			return 0;
+		}
+
+		const int firstRegister = numUsedRegisters;
+		numUsedRegisters += numToAllocate;
+		numRegisters = jmax<int>(numRegisters, numUsedRegisters);
+
+		return firstRegister;
+	}
+
+	void release(int firstRegister)
+	{
+		if (compiledOk)
+			numUsedRegisters = firstRegister;
+	}
+
+	int addConstant(const var& value)
+	{
+		program.constants.add(value);
+		return program.constants.size() - 1;
+	}
+
+	int addPointer(var* data)
+	{
+		const int index = program.pointers.indexOf(data);
+
+		if (index != -1)
+			return index;
+
+		program.pointers.add(data);
+		return program.pointers.size() - 1;
+	}
+
+	int addNode(Statement* node)
+	{
+		program.nodes.add(node);
+		return program.nodes.size() - 1;
+	}
+
+	BytecodeProgram& program;
+
+	Array<int> labels;
+	Array<JumpContext> contexts;
+	Array<InlineFunction::FunctionCall*> expandedCalls;
+
+	int numUsedRegisters = 0;
+	int numRegisters = 0;
+	bool compiledOk = true;
+};
+
+
+HiseJavascriptEngine::RootObject::BytecodeProgram* HiseJavascriptEngine::RootObject::BytecodeProgram::compile(BlockStatement* body)
+{
+	ScopedPointer<BytecodeProgram> p = new BytecodeProgram();
+
+	Compiler c(*p);
+
+	if (c.compile(body))
+		return p.release();
+
+	return nullptr;
+}
+
+
+void HiseJavascriptEngine::RootObject::BytecodeProgram::perform(const Scope& s, var* returnValue)
+{
+	/** The registers of one call. Only the used registers are constructed and they are destroyed when the call
+	*	returns (also if a statement throws an error), so they don't keep objects alive.
+	*/
+	struct RegisterFrame
+	{
+		RegisterFrame(int numRegisters_) :
+			registers(reinterpret_cast<var*>(storage)),
+			numRegisters(numRegisters_)
+		{
+			jassert(numRegisters <= Compiler::MaxRegisters);
+
+			for (int i = 0; i < numRegisters; i++)
+				new (registers + i) var();
+		}
+
+		~RegisterFrame()
+		{
+			for (int i = 0; i < numRegisters; i++)
+				registers[i].~var();
+		}
+
+		var* const registers;
+		const int numRegisters;
+
+		alignas(var) char storage[sizeof(var) * Compiler::MaxRegisters];
+	};
+
+	RegisterFrame frame(numRegisters);
+
+	var* r = frame.registers;
+	const Instruction* code = instructions.getRawDataPointer();
+	const var* k = constants.getRawDataPointer();
+	var* const* p = pointers.getRawDataPointer();
+	Statement* const* n = nodes.getRawDataPointer();
+
+	int pc = 0;
+
+	for (;;)
+	{
+		const Instruction& in = code[pc++];
+
+		switch (in.op)
+		{
+		case LoadConstant:		r[in.dst] = k[in.index]; break;
+		case LoadPointer:		r[in.dst] = *p[in.index]; break;
+		case StorePointer:		*p[in.index] = r[in.a]; break;
+		case SetRegister:		s.root->hiseSpecialData.varRegister.setRegister(in.index, r[in.a]); break;
+		case AddRegister:
+		{
+			const RegisterVarStatement* rvs = static_cast<const RegisterVarStatement*>(n[in.index]);
+			rvs->varRegister->addRegister(rvs->name, r[in.a]);
+			break;
+		}
+		case ToBool:			r[in.dst] = (bool)r[in.a]; break;
+		case Binary:			r[in.dst] = static_cast<const BinaryOperator*>(n[in.index])->getWithValues(r[in.a], r[in.b]); break;
+		case TypeEquals:		r[in.dst] = areTypeEqual(r[in.a], r[in.b]); break;
+		case TypeNotEquals:		r[in.dst] = !areTypeEqual(r[in.a], r[in.b]); break;
+		case Subscript:			r[in.dst] = static_cast<const ArraySubscript*>(n[in.index])->getFromObject(s, r[in.a]); break;
+		case Dot:				r[in.dst] = static_cast<const DotOperator*>(n[in.index])->getFromParent(r[in.a]); break;
+		case Assign:			static_cast<const Expression*>(n[in.index])->assign(s, r[in.a]); break;
+		case Evaluate:			r[in.dst] = static_cast<const Expression*>(n[in.index])->getResult(s); break;
+		case Perform:
+		{
+			const FallbackStatement& f = fallbacks.getReference(in.index);
+
+			switch (f.statement->perform(s, r + in.dst))
+			{
+			case Statement::returnWasHit:	pc = f.returnTarget; break;
+			case Statement::breakWasHit:	pc = f.breakTarget; break;
+			case Statement::continueWasHit:	pc = f.continueTarget; break;
+			case Statement::ok:				break;
+			}
+
+			break;
+		}
+		case CallApi:
+		{
+			const ApiCall* call = static_cast<const ApiCall*>(n[in.index]);
+
+			if (call->apiClass == nullptr)
+				call->location.throwError("API class does not exist");
+
+			r[in.dst] = call->apiClass->callFunction(call->functionIndex, r + in.a, call->expectedNumArguments);
+			break;
+		}
+		case LoadParameter:
+		{
+			const InlineFunction::ParameterReference* pr = static_cast<const InlineFunction::ParameterReference*>(n[in.index]);
+
+			if (pr->f->e == nullptr)
+				pr->location.throwError("Accessing parameter reference outside the function call");
+
+			r[in.dst] = pr->f->e->parameterResults.getUnchecked(pr->index);
+			break;
+		}
+		case EnterInlineFunction:
+		{
+			const InlineFunction::FunctionCall* call = static_cast<const InlineFunction::FunctionCall*>(n[in.index]);
+
+			call->f->setFunctionCall(call);
+			break;
+		}
+		case SetParameter:
+		{
+			const InlineFunction::FunctionCall* call = static_cast<const InlineFunction::FunctionCall*>(n[in.index]);
+
+			call->parameterResults.setUnchecked(in.b, r[in.a]);
+			break;
+		}
+		case ExitInlineFunction:
+		{
+			const InlineFunction::FunctionCall* call = static_cast<const InlineFunction::FunctionCall*>(n[in.index]);
+
+			for (int i = 0; i < call->numArgs; i++)
+				call->parameterResults.setUnchecked(i, var::undefined());
+
+			call->f->lastReturnValue = r[in.a];
+			call->f->setFunctionCall(nullptr);
+			break;
+		}
+		case CallInlineFunction:
+		{
+			const InlineFunction::FunctionCall* call = static_cast<const InlineFunction::FunctionCall*>(n[in.index]);
+
+			const Statement::ResultCode c = call->f->body->perform(s, &call->returnVar);
+
+			for (int i = 0; i < call->numArgs; i++)
+				call->parameterResults.setUnchecked(i, var::undefined());
+
+			call->f->lastReturnValue = call->returnVar;
+			call->f->setFunctionCall(nullptr);
+
+			r[in.dst] = (c == Statement::returnWasHit) ? call->returnVar : var::undefined();
+			break;
+		}
+		case Jump:				pc = in.index; break;
+		case JumpIfFalse:		if (!r[in.a]) pc = in.index; break;
+		case JumpIfTrue:		if (r[in.a]) pc = in.index; break;
+		case CheckTimeout:		s.checkTimeOut(n[in.index]->location); break;
+		case SetLocation:		s.root->currentLocation = &n[in.index]->location; break;
+		case Return:
+		{
+			if (returnValue != nullptr)
+				*returnValue = r[in.a];
+
+			return;
+		}
+		case Stop:				return;
+		default:				jassertfalse; return;
+		}
+	}
+}
@@ -54,8 +54,12 @@ struct HiseJavascriptEngine::RootObject::ArraySubscript : public Expression
 
 	var getResult(const Scope& s) const override
 	{
-		var result = object->getResult(s);
+		return getFromObject(s, object->getResult(s));
+	}
 
+	/** Returns the element of the already evaluated object. */
+	var getFromObject(const Scope& s, const var& result) const
+	{
 		if (VariantBuffer *b = result.getBuffer())
 		{
 			const int i = index->getResult(s);
@@ -140,7 +144,12 @@ struct HiseJavascriptEngine::RootObject::DotOperator : public Expression
 
 	var getResult(const Scope& s) const override
 	{
-		var p(parent->getResult(s));
+		return getFromParent(parent->getResult(s));
+	}
+
+	/** Returns the property of the already evaluated parent. */
+	var getFromParent(const var& p) const
+	{
 		static const Identifier lengthID("length");
 
 		if (child == lengthID)
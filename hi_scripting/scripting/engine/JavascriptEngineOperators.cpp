@@ -23,6 +23,12 @@ struct HiseJavascriptEngine::RootObject::BinaryOperator : public BinaryOperatorB
 	{
 		var a(lhs->getResult(s)), b(rhs->getResult(s));
 
+		return getWithValues(a, b);
+	}
+
+	/** Applies the operator to the already evaluated operands (the bytecode interpreter calls this directly). */
+	var getWithValues(const var& a, const var& b) const
+	{
 		if (isNumericOrUndefined(a) && isNumericOrUndefined(b))
 			return (a.isDouble() || b.isDouble()) ? getWithDoubles(a, b) : getWithInts(a, b);
 
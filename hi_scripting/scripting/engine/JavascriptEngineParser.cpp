@@ -783,7 +783,7 @@ private:
 
 		
 
-		c->setStatements(s.release());
+		c->setStatements(s.release(), hiseSpecialData->useBytecode);
 
 		return new Statement(location);
 	}
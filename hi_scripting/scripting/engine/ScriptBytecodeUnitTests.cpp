@@ -0,0 +1,293 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licences for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licencing:
+*
+*   http://www.hartinstruments.net/hise/
+*
+*   HISE is based on the JUCE library,
+*   which also must be licenced for commercial applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+#include "JuceHeader.h"
+
+
+/** Runs the same callbacks with the tree walker and the bytecode interpreter and compares the results. */
+class ScriptBytecodeUnitTests : public UnitTest
+{
+public:
+
+	ScriptBytecodeUnitTests():
+		UnitTest("Testing the script callback bytecode")
+	{
+		
+	}
+
+	void runTest() override
+	{
+		testLoopsAndRegisters();
+
+		testInlineFunctions();
+
+		testArgumentOrder();
+
+		testBenchmark();
+	}
+
+private:
+
+	void testLoopsAndRegisters()
+	{
+		beginTest("Loops, registers and API calls");
+
+		const String code = "reg counter = 0;\n"
+							"reg sum = 0.0;\n"
+							"reg total = 0;\n"
+							"reg i = 0;\n"
+							"const var values = [3, 1, 4, 1, 5, 9, 2, 6];\n"
+							"\n"
+							"function onNoteOn()\n"
+							"{\n"
+							"	local offset = counter * 0.25;\n"
+							"	counter++;\n"
+							"	total = 0;\n"
+							"\n"
+							"	for (i = 0; i < values.length; i++)\n"
+							"	{\n"
+							"		if (values[i] == 1) continue;\n"
+							"		if (values[i] > 8 && counter > 2) break;\n"
+							"		total += Math.pow(values[i], 2) * 0.5 + offset;\n"
+							"	}\n"
+							"\n"
+							"	sum = sum + Math.max(total, counter) - (counter % 3 == 0 ? 1 : 0);\n"
+							"	return total;\n"
+							"}\n";
+
+		compareResults(code, "[counter, sum, total, i]");
+	}
+
+	void testInlineFunctions()
+	{
+		beginTest("Inline functions and tree walker fallbacks");
+
+		const String code = "reg n = 0;\n"
+							"reg k = 0;\n"
+							"reg text = \"\";\n"
+							"\n"
+							"inline function square(x)\n"
+							"{\n"
+							"	return x * x;\n"
+							"}\n"
+							"\n"
+							"inline function clampedSum(a, b)\n"
+							"{\n"
+							"	local s = square(a) + square(b);\n"
+							"\n"
+							"	for (j = 0; j < 3; j++)\n"
+							"	{\n"
+							"		if (s > 50) return 50;\n"
+							"		s = s + j;\n"
+							"	}\n"
+							"\n"
+							"	return s;\n"
+							"}\n"
+							"\n"
+							"function onNoteOn()\n"
+							"{\n"
+							"	n++;\n"
+							"	k = 0;\n"
+							"\n"
+							"	do\n"
+							"	{\n"
+							"		k++;\n"
+							"		if (k == 2) continue;\n"
+							"	}\n"
+							"	while (k < 4);\n"
+							"\n"
+							"	while (k > 0)\n"
+							"	{\n"
+							"		k -= 1;\n"
+							"		if (k == 1) break;\n"
+							"	}\n"
+							"\n"
+							"	switch (n % 3)\n"
+							"	{\n"
+							"		case 0: text = text + \"a\"; break;\n"
+							"		case 1: text = text + \"b\"; break;\n"
+							"		default: text = text + \"c\";\n"
+							"	}\n"
+							"\n"
+							"	for (v in [1, 2])\n"
+							"		text += v;\n"
+							"\n"
+							"	return clampedSum(n, k + 2) + square(n + 1) + (n > 1 || k < 0) + !(n == 2);\n"
+							"}\n";
+
+		compareResults(code, "[n, k, text]");
+	}
+
+	void testArgumentOrder()
+	{
+		beginTest("Arguments that access the parameters of the called function");
+
+		// The tree walker makes the call the current call of the function before the arguments are evaluated and
+		// passes every argument right away, so the arguments of the recursive call see its own (previous) parameters.
+		const String recursiveCode = "reg n = 0;\n"
+									 "\n"
+									 "inline function chain(a, b)\n"
+									 "{\n"
+									 "	if (a > 3 || b > 3) return a * 10 + b;\n"
+									 "	return chain(1 + a, a);\n"
+									 "}\n"
+									 "\n"
+									 "function onNoteOn()\n"
+									 "{\n"
+									 "	n++;\n"
+									 "	return chain(n, 0);\n"
+									 "}\n";
+
+		compareResults(recursiveCode, "n");
+
+		// A call to the same function in the arguments leaves the function, so the parameters can't be accessed anymore
+		const String nestedCode = "inline function sum(a, b)\n"
+								  "{\n"
+								  "	return a + b;\n"
+								  "}\n"
+								  "\n"
+								  "function onNoteOn()\n"
+								  "{\n"
+								  "	return sum(1, sum(2, 3));\n"
+								  "}\n";
+
+		const String treeWalker = runCallbacks(nestedCode, "0", false);
+
+		expect(treeWalker.contains("Accessing parameter reference outside the function call"), treeWalker);
+		expectEquals<String>(runCallbacks(nestedCode, "0", true), treeWalker, "Bytecode error");
+	}
+
+	void testBenchmark()
+	{
+		beginTest("Callbacks per second");
+
+		const String code = "const var table = [];\n"
+							"reg i = 0;\n"
+							"reg total = 0.0;\n"
+							"\n"
+							"for (i = 0; i < 128; i++)\n"
+							"	table[i] = i * 0.5;\n"
+							"\n"
+							"inline function scale(value)\n"
+							"{\n"
+							"	return Math.min(value, 32.0) * 0.5;\n"
+							"}\n"
+							"\n"
+							"function onNoteOn()\n"
+							"{\n"
+							"	total = 0.0;\n"
+							"\n"
+							"	for (i = 0; i < 128; i++)\n"
+							"	{\n"
+							"		if (i % 2 == 0)\n"
+							"			total += scale(table[i]);\n"
+							"		else\n"
+							"			total -= 0.25;\n"
+							"	}\n"
+							"}\n";
+
+		const int numCallbacks = 2000;
+
+		const double treeWalker = getCallbacksPerSecond(code, false, numCallbacks);
+		const double bytecode = getCallbacksPerSecond(code, true, numCallbacks);
+
+		logMessage("Tree walker: " + String(roundDoubleToInt(treeWalker)) + " callbacks/second");
+		logMessage("Bytecode:    " + String(roundDoubleToInt(bytecode)) + " callbacks/second");
+
+		compareResults(code, "total");
+	}
+
+	// ================================================================================================================
+
+	void compareResults(const String& code, const String& stateExpression)
+	{
+		const String treeWalker = runCallbacks(code, stateExpression, false);
+		const String bytecode = runCallbacks(code, stateExpression, true);
+
+		expect(!treeWalker.startsWith("Error"), treeWalker);
+		expectEquals<String>(bytecode, treeWalker, "Bytecode result");
+	}
+
+	/** Runs the onNoteOn callback a few times and returns the return values and the state after each callback. */
+	static String runCallbacks(const String& code, const String& stateExpression, bool useBytecode)
+	{
+		DynamicObject::Ptr globals = new DynamicObject();
+		HiseJavascriptEngine engine(nullptr);
+
+		engine.registerGlobalStorge(globals);
+		engine.registerCallbackName("onNoteOn", 0, 0.0);
+		engine.setUseBytecodeForCallbacks(useBytecode);
+
+		Result r = engine.execute(code);
+
+		if (!r.wasOk())
+			return "Error: " + r.getErrorMessage();
+
+		String output;
+
+		for (int i = 0; i < 5; i++)
+		{
+			Result cr = Result::ok();
+
+			const var returnValue = engine.executeCallback(0, &cr);
+
+			if (!cr.wasOk())
+				return "Error: " + cr.getErrorMessage();
+
+			output << JSON::toString(returnValue, true) << " " << JSON::toString(engine.evaluate(stateExpression), true) << "\n";
+		}
+
+		return output;
+	}
+
+	static double getCallbacksPerSecond(const String& code, bool useBytecode, int numCallbacks)
+	{
+		DynamicObject::Ptr globals = new DynamicObject();
+		HiseJavascriptEngine engine(nullptr);
+
+		engine.registerGlobalStorge(globals);
+		engine.registerCallbackName("onNoteOn", 0, 0.0);
+		engine.setUseBytecodeForCallbacks(useBytecode);
+		engine.execute(code);
+
+		const double start = Time::getMillisecondCounterHiRes();
+
+		for (int i = 0; i < numCallbacks; i++)
+			engine.executeCallback(0, nullptr);
+
+		const double seconds = (Time::getMillisecondCounterHiRes() - start) * 0.001;
+
+		return (double)numCallbacks / jmax<double>(seconds, 0.000001);
+	}
+};
+
+static ScriptBytecodeUnitTests scriptBytecodeUnitTests;
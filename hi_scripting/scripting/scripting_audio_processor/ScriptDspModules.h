@@ -596,8 +596,8 @@ public:
 		void setParameter(int /*index*/, float newValue) override
 		{
 			delayTimeSamples = newValue;
-			delayL.setDelayTimeSamples((int)newValue);
-			delayR.setDelayTimeSamples((int)newValue);			
+			delayL.setDelayTimeSamples(newValue);
+			delayR.setDelayTimeSamples(newValue);
 		};
 
 		int getNumParameters() const override { return 1; };
@@ -606,41 +606,22 @@ public:
 
 		void prepareToPlay(double sampleRate, int samplesPerBlock) override
 		{
-			delayedBufferL = new VariantBuffer(samplesPerBlock);
-			delayedBufferR = new VariantBuffer(samplesPerBlock);
+			// The delay time is set in samples, so the maximum is the size of the old fixed buffer
+			delayL.setMaxDelaySeconds(65535.0 / sampleRate);
+			delayR.setMaxDelaySeconds(65535.0 / sampleRate);
 
-			delayL.prepareToPlay(sampleRate);
-			delayR.prepareToPlay(sampleRate);
+			delayL.prepareToPlay(sampleRate, samplesPerBlock);
+			delayR.prepareToPlay(sampleRate, samplesPerBlock);
 		}
 
 		void processBlock(float **data, int numChannels, int numSamples) override
 		{
-			if (numChannels == 2)
-			{
-				const float *inL = data[0];
-				const float *inR = data[1];
+			delayL.processBlock(data[0], data[0], numSamples);
 
-				float *l = delayedBufferL->buffer.getWritePointer(0);
-				float *r = delayedBufferR->buffer.getWritePointer(0);
-
-				while (--numSamples >= 0)
-				{
-					*l++ = delayL.getDelayedValue(*inL++);
-					*r++ = delayL.getDelayedValue(*inR++);
-				}
-			}
-			else
+			if (numChannels == 2)
 			{
-				const float *inL = data[0];
-
-				float *l = delayedBufferL->buffer.getWritePointer(0);
-
-				while (--numSamples >= 0)
-				{
-					*l++ = delayL.getDelayedValue(*inL++);
-				}
+				delayR.processBlock(data[1], data[1], numSamples);
 			}
-			
 		}
 		
 	private:
@@ -649,9 +630,6 @@ public:
 		DelayLine delayR;
 
 		float delayTimeSamples = 0.0f;
-
-		VariantBuffer::Ptr delayedBufferL;
-		VariantBuffer::Ptr delayedBufferR;
 	};
 
 	class SignalSmoother : public DspBaseObject
@@ -53,6 +53,22 @@ public:
 			quit();
 			return;
 		}
+		else if (commandLine.startsWith("render"))
+		{
+			HeadlessRenderer::ErrorCodes result = HeadlessRenderer::renderFromCommandLine(commandLine);
+
+			if (result != HeadlessRenderer::OK)
+			{
+				std::cout << std::endl << "==============================================================================" << std::endl;
+				std::cout << "RENDER ERROR: " << HeadlessRenderer::getErrorMessage(result) << std::endl;
+				std::cout << "==============================================================================" << std::endl << std::endl;
+
+				exit((int)result);
+			}
+
+			quit();
+			return;
+		}
 		else if (commandLine.startsWith("--help"))
 		{
 			std::cout << std::endl;
@@ -68,6 +84,18 @@ public:
 			std::cout << "          (Leave empty for standalone export)" << std::endl;
 			std::cout << "-a:{TEXT} sets the architecture ('x86', 'x64', 'x86x64')." << std::endl;
 			std::cout << "          (Leave empty on OSX for Universal binary.)" << std::endl << std::endl;
+			std::cout << "HISE render \"File.hip\" -m:FILE -o:FILE [-r:FILE -sr:RATE -bs:SIZE -tail:SECONDS -seed:NUMBER -nowait]" << std::endl << std::endl;
+			std::cout << "Options: " << std::endl << std::endl;
+			std::cout << "-m:{PATH} the MIDI file that is played" << std::endl;
+			std::cout << "-o:{PATH} the WAV file that is written" << std::endl;
+			std::cout << "-r:{PATH} the JSON file for the report (CPU percentiles, voices, underruns)." << std::endl;
+			std::cout << "          (Leave empty to print the report)" << std::endl;
+			std::cout << "-sr:{NUMBER} the sample rate (default 44100)" << std::endl;
+			std::cout << "-bs:{NUMBER} the block size (default 512)" << std::endl;
+			std::cout << "-tail:{NUMBER} the seconds that are rendered after the last MIDI event (default 2)" << std::endl;
+			std::cout << "-seed:{NUMBER} the seed for the random generators" << std::endl;
+			std::cout << "-nowait   doesn't wait for the streaming threads after each block." << std::endl;
+			std::cout << "          (The output might not be deterministic)" << std::endl << std::endl;
 
 			quit();
 			return;